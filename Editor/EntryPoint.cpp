@@ -3,7 +3,8 @@
 #include <Engine/System/Window.h>
 #include <Engine/System/InputManager.h>
 #include <Engine/Graphics/RenderManager.h>
-#include <Engine/System/Timer.h>
+#include <Engine/System/FixedStep.h>
+#include <Engine/System/JobSystem.h>
 #include <Engine/Game/World.h>
 
 #include <Engine/Graphics/Mesh.h>
@@ -52,6 +53,9 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 		return 2;
 	}
 
+	// before the renderer: shaders are loaded on the workers
+	Job_Initialize();
+
 	if ( renderMan.Initialize( &window ) != 0 ) {
 		return 3;
 	}
@@ -74,6 +78,7 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 
 	inputMan.RegisterCallback( VK_C, true, KEY_MOD_LCONTROL, std::bind( &WorldEditor::CopyNode, &worldEdMan ) );
 	inputMan.RegisterCallback( VK_V, true, KEY_MOD_LCONTROL, std::bind( &WorldEditor::PasteNode, &worldEdMan ) );
+	inputMan.RegisterCallback( VK_B, true, KEY_MOD_LCONTROL, std::bind( &WorldEditor::MergeStaticMeshes, &worldEdMan ) );
 
 	inputMan.RegisterCallback( VK_ESCAPE, true, KEY_MOD_NONE, std::bind( [&]( const float dt ) { PostThreadMessage( GetCurrentThreadId(), WM_QUIT, 0, 0 ); }, std::placeholders::_1 ) );
 	inputMan.RegisterCallback( VK_F1, true, KEY_MOD_NONE, std::bind( &UIManager::Toggle, &uiMan ) );
@@ -96,13 +101,12 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 
 	MSG msg = {};
 
-	timer_t gameLogicTimer = {};
-	Timer_Start( &gameLogicTimer );
+	constexpr double SIMULATION_TICK = 10.0; // 10ms / 100Hz
 
-	constexpr double ref_dt = 10.0;	// 10ms / 100FPS cap (for now)
+	fixedStep_t simulationStep = {};
+	FixedStep_Start( &simulationStep, SIMULATION_TICK );
 
-	double dt			= 0.00;
-	double accumulator	= 0.00;
+	uiMan.SetSimulationMetrics( &simulationStep.metrics );
 
 	while ( 1 ) {
 		while ( PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
@@ -112,6 +116,7 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 			}
 	
 			if ( msg.message == WM_QUIT ) {
+				Job_Shutdown();
 				inputMan.Shutdown();
 				renderMan.Shutdown();
 				Sys_DestroyWindow( &window );
@@ -127,31 +132,33 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 		}
 
 		if ( window.flags & WIN_FLAG_HAS_FOCUS ) {
-			dt = Timer_GetDelta( &gameLogicTimer ); // get delta as ms
+			const double frameTime = FixedStep_BeginFrame( &simulationStep );
+
+			inputMan.Poll( static_cast<float>( frameTime ) );
 
-			if ( dt > 250.0 ) {
-				dt = 250.0;
+			while ( FixedStep_Tick( &simulationStep ) ) {
+				worldEdMan.Frame( static_cast<float>( simulationStep.tickDuration ) );
 			}
 
-			accumulator += dt;
+			const float frameTimeSeconds = static_cast<float>( frameTime * 0.001 );
 
-			inputMan.Poll( static_cast<float>( dt ) );
-				
-			while ( accumulator >= ref_dt ) {
-				worldEdMan.Frame( static_cast<float>( dt ) );
-				accumulator -= dt;
-			}
-			
-			const float	alpha					= static_cast< float >( accumulator / dt ),
-						interpolatedFrametime	= alpha + ( 1.0f - alpha );
+			worldMan.UpdateTransforms();
 
-			renderMan.FrameWorld( interpolatedFrametime, worldEdMan.GetActiveCameraObj(), worldMan.GetActiveArea() );
+			// the editor modifies the world from the main thread; render synchronously
+			renderSnapshot_t* snapshot = renderMan.AcquireSnapshot();
+
+			const worldArea_t* activeArea = worldMan.GetActiveArea();
+			Render_BuildSnapshot( snapshot, worldEdMan.GetActiveCamera(), &activeArea, 1, frameTimeSeconds );
+
+			renderMan.FrameWorld( snapshot );
 
 			if ( uiMan.IsToggled() ) {
-                uiMan.Draw( interpolatedFrametime, worldEdMan.GetActiveCamera() );
+                uiMan.Draw( frameTimeSeconds, worldEdMan.GetActiveCamera() );
             }
 
 			renderMan.Swap();
+
+			Render_ClearSnapshot( snapshot );
 		} else {
 			inputMan.Flush(); // TODO: flush this only once...
 		}
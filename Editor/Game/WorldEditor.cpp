@@ -6,10 +6,13 @@
 #include <Engine/System/InputManager.h>
 #include <Engine/Graphics/Camera.h>
 #include <Engine/Graphics/Mesh.h>
+#include <Engine/Graphics/StaticBatch.h>
 #include <Engine/Graphics/LightManager.h>
 
 #include <Editor/Graphics/UI/UIManager.h>
 
+#include <algorithm>
+
 WorldEditor::WorldEditor()
 	: uiMan( nullptr )
 	, activeWorld( nullptr )
@@ -109,10 +112,8 @@ void WorldEditor::Frame( const float dt )
 
 void WorldEditor::SelectNodeByMouse( const Camera* cam )
 {
-	D3D11_VIEWPORT viewport = {};
-	UINT numOfVP = 1;
-
-    renderContext->deviceContext->RSGetViewports( &numOfVP, &viewport );
+	// back buffer sized; the bound viewport belongs to the render thread
+	const renderViewport_t& viewport = renderContext->viewport;
 
 	POINT cursorPos = {};
 
@@ -131,8 +132,8 @@ void WorldEditor::SelectNodeByMouse( const Camera* cam )
 
 	DirectX::XMFLOAT3 ray =
 	{
-		( ( ( 2.0f * cursorPos.x ) / viewport.Width ) - 1 ) / projMatVec._11,
-		-( ( ( 2.0f * cursorPos.y ) / viewport.Height ) - 1 ) / projMatVec._22,
+		( ( ( 2.0f * cursorPos.x ) / viewport.width ) - 1 ) / projMatVec._11,
+		-( ( ( 2.0f * cursorPos.y ) / viewport.height ) - 1 ) / projMatVec._22,
 		1.0f
 	};
 
@@ -253,18 +254,16 @@ void WorldEditor::RemoveSelectedNode()
         return;
     }
 
+    // pasted copies hold their own references; shared resources go with the last one
     if ( selectedNode->flags & NODE_FLAG_CONTENT_MESH ) {
-        Render_ReleaseMesh( static_cast<mesh_t*>( selectedNode->content ) );
-    } else if ( selectedNode->flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
-        delete static_cast<diskAreaLight_t*>( selectedNode->content );
-    } else if ( selectedNode->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
-        delete static_cast<sphereAreaLight_t*>( selectedNode->content );
-    } else if ( selectedNode->flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
-		delete static_cast<sunLight_t*>( selectedNode->content );
-	} else if ( selectedNode->flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
-		delete static_cast<rectangleAreaLight_t*>( selectedNode->content );
+        Render_ReleaseMesh( renderContext, matMan, static_cast<mesh_t*>( selectedNode->content ) );
+    }
+
+	if ( copyNode == selectedNode ) {
+		copyNode = nullptr;
 	}
 
+	// content memory is returned to the area pools
     activeWorld->RemoveNode( selectedNode->hash );
 
     selectedNode = nullptr;
@@ -272,10 +271,14 @@ void WorldEditor::RemoveSelectedNode()
 
 void WorldEditor::MeshInsertCallback( char* absolutePath )
 {
-    mesh_t* insertedMesh = new mesh_t();
+    mesh_t* insertedMesh = static_cast<mesh_t*>( activeWorld->AllocateContent( NODE_FLAG_CONTENT_MESH ) );
+
+    if ( insertedMesh == nullptr ) {
+        return;
+    }
 
     if ( Render_CreateMeshFromFile( renderContext, matMan, insertedMesh, absolutePath ) != 0 ) {
-        delete insertedMesh;
+        activeWorld->FreeContent( insertedMesh, NODE_FLAG_CONTENT_MESH );
         return;
     }
 
@@ -296,18 +299,93 @@ void WorldEditor::PasteNode()
 		return;
 	}
 
-	areaNode_t* copiedNode = new areaNode_t( *copyNode );
-
-	if ( copiedNode->flags & NODE_FLAG_CONTENT_MESH ) {
-		copiedNode->content = new mesh_t( *static_cast< mesh_t* >( copiedNode->content ) );
-	} else if ( copiedNode->flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
-		copiedNode->content = new diskAreaLight_t( *static_cast< diskAreaLight_t* >( copiedNode->content ) );
-	} else if ( copiedNode->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
-		copiedNode->content = new sphereAreaLight_t( *static_cast< sphereAreaLight_t* >( copiedNode->content ) );
-	} else if ( copiedNode->flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
-		copiedNode->content = new sunLight_t( *static_cast< sunLight_t* >( copiedNode->content ) );
-	} else if ( copiedNode->flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
-		copiedNode->content = new rectangleAreaLight_t( *static_cast< rectangleAreaLight_t* >( copiedNode->content ) );
+	void* copiedContent = activeWorld->AllocateContent( copyNode->flags );
+
+	if ( copiedContent == nullptr ) {
+		return;
+	}
+
+	if ( copyNode->flags & NODE_FLAG_CONTENT_MESH ) {
+		mesh_t* copiedMesh = static_cast< mesh_t* >( copiedContent );
+		transform_t* copiedTransform = copiedMesh->transformation; // each node owns its transform
+
+		*copiedMesh = *static_cast< mesh_t* >( copyNode->content );
+		*copiedTransform = *copiedMesh->transformation;
+		copiedMesh->transformation = copiedTransform;
+
+		// the copy shares the geometry and materials
+		Render_AcquireMesh( renderContext, matMan, copiedMesh );
+	} else if ( copyNode->flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
+		*static_cast< diskAreaLight_t* >( copiedContent ) = *static_cast< diskAreaLight_t* >( copyNode->content );
+	} else if ( copyNode->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
+		*static_cast< sphereAreaLight_t* >( copiedContent ) = *static_cast< sphereAreaLight_t* >( copyNode->content );
+	} else if ( copyNode->flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
+		*static_cast< sunLight_t* >( copiedContent ) = *static_cast< sunLight_t* >( copyNode->content );
+	} else if ( copyNode->flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
+		*static_cast< rectangleAreaLight_t* >( copiedContent ) = *static_cast< rectangleAreaLight_t* >( copyNode->content );
+	}
+
+	areaNode_t* copiedNode = activeWorld->InsertNode( copiedContent, copyNode->flags );
+
+	if ( copiedNode != nullptr ) {
+		strcpy( copiedNode->name, copyNode->name );
+	}
+}
+
+void WorldEditor::MergeStaticMeshes()
+{
+	const worldArea_t* area = activeWorld->GetActiveArea();
+
+	if ( area == nullptr || area->nodes == nullptr ) {
+		return;
+	}
+
+	// meshes attached to the area root are static set dressing (actors own the moving ones)
+	std::vector<areaNode_t*> sourceNodes;
+	std::vector<const mesh_t*> sourceMeshes;
+
+	for ( areaNode_t* node : area->nodes->children ) {
+		if ( ( node->flags & NODE_FLAG_CONTENT_MESH ) && node->children.empty() && Render_IsMergeableMesh( static_cast<const mesh_t*>( node->content ) ) ) {
+			sourceNodes.push_back( node );
+			sourceMeshes.push_back( static_cast<const mesh_t*>( node->content ) );
+		}
+	}
+
+	if ( sourceMeshes.size() < 2 ) {
+		return;
+	}
+
+	mesh_t* mergedMesh = static_cast<mesh_t*>( activeWorld->AllocateContent( NODE_FLAG_CONTENT_MESH ) );
+
+	if ( mergedMesh == nullptr ) {
+		return;
+	}
+
+	if ( Render_MergeStaticMeshes( renderContext, matMan, sourceMeshes.data(), sourceMeshes.size(), mergedMesh ) != 0 ) {
+		Render_ReleaseMesh( renderContext, matMan, mergedMesh );
+		activeWorld->FreeContent( mergedMesh, NODE_FLAG_CONTENT_MESH );
+		return;
 	}
-	activeWorld->GetActiveArea()->nodes->children.push_back( copiedNode );
+
+	// copies hold their own references (see PasteNode): shared geometry goes with the last one
+	for ( areaNode_t* node : sourceNodes ) {
+		if ( node == selectedNode ) {
+			selectedNode = nullptr;
+		}
+
+		if ( node == copyNode ) {
+			copyNode = nullptr;
+		}
+
+		Render_ReleaseMesh( renderContext, matMan, static_cast<mesh_t*>( node->content ) );
+		activeWorld->RemoveNode( node->hash );
+	}
+
+	areaNode_t* mergedNode = activeWorld->InsertNode( mergedMesh, NODE_FLAG_CONTENT_MESH );
+
+	if ( mergedNode != nullptr ) {
+		snprintf( mergedNode->name, sizeof( mergedNode->name ), "static batch (%u pieces)", static_cast<unsigned int>( mergedMesh->pieces.size() ) );
+	}
+
+	uiMan->SetNodeEdit( nullptr ); // avoid dirty object pointer
 }
@@ -30,6 +30,7 @@ public:
     void                    RemoveSelectedNode();
     void                    MeshInsertCallback( char* absolutePath );
 	void					PasteNode();
+	void					MergeStaticMeshes(); // active area; see Render_MergeStaticMeshes
 
 private:
 	UIManager*		        uiMan;
@@ -1,8 +1,7 @@
-#include <d3d11.h>
 #include "Icon.h"
-#include <d3dcompiler.h>
 
 #include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackend.h>
 #include <Engine/Graphics/CBuffer.h>
 #include <Engine/Graphics/Texture.h>
 
@@ -18,53 +17,53 @@ void SurfaceIcon::Destroy()
 
 const int SurfaceIcon::Create( const renderContext_t* context, TextureManager* texMan )
 {
-	HRESULT result = 0;
+	RenderBackend* backend = context->backend;
 
-	ID3D10Blob*		vertexShaderBuffer = nullptr;
-	ID3D10Blob*		pixelShaderBuffer = nullptr;
+	std::vector<uint8_t> vertexShaderBytecode, pixelShaderBytecode;
 
-	D3DReadFileToBlob( L"base_data/shaders/ed_icon_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/ed_icon_ps.cso", &pixelShaderBuffer );
-
-	result = context->device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader );
-	if ( FAILED( result ) ) {
+	if ( !backend->LoadShaderBytecode( L"base_data/shaders/ed_icon_vs.cso", vertexShaderBytecode ) ) {
 		return 1;
 	}
 
-	result = context->device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader );
-	if ( FAILED( result ) ) {
+	if ( !backend->LoadShaderBytecode( L"base_data/shaders/ed_icon_ps.cso", pixelShaderBytecode ) ) {
 		return 2;
 	}
 
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_ANISOTROPIC;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	samplerDesc.MaxAnisotropy = 8;
+	vertexShader = backend->CreateVertexShader( vertexShaderBytecode.data(), vertexShaderBytecode.size() );
+	if ( vertexShader == nullptr ) {
+		return 1;
+	}
+
+	pixelShader = backend->CreatePixelShader( pixelShaderBytecode.data(), pixelShaderBytecode.size() );
+	if ( pixelShader == nullptr ) {
+		return 2;
+	}
 
-	context->device->CreateSamplerState( &samplerDesc, &samplerState );
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_ANISOTROPIC;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+	samplerDesc.maxAnisotropy = 8;
 
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
+	samplerState = backend->CreateSamplerState( samplerDesc );
 
 	Render_CreateCBuffer( context, cbuffer, sizeof( edEntityIcon_t ) );
 
-	D3D11_BLEND_DESC blendStateDesc;
-	ZeroMemory( &blendStateDesc, sizeof( D3D11_BLEND_DESC ) );
-	blendStateDesc.AlphaToCoverageEnable = FALSE;
-	blendStateDesc.IndependentBlendEnable = FALSE;
-	blendStateDesc.RenderTarget[0].BlendEnable = TRUE;
-	blendStateDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
-	blendStateDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
-	blendStateDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-	blendStateDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_SRC_ALPHA;
-	blendStateDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_DEST_ALPHA;
-	blendStateDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-	blendStateDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-	context->device->CreateBlendState( &blendStateDesc, &blendState );
+	renderBlendDesc_t blendStateDesc = {};
+	blendStateDesc.alphaToCoverageEnable = 0;
+	blendStateDesc.independentBlendEnable = 0;
+	blendStateDesc.renderTarget[0].blendEnable = 1;
+	blendStateDesc.renderTarget[0].srcBlend = RENDER_BLEND_SRC_ALPHA;
+	blendStateDesc.renderTarget[0].destBlend = RENDER_BLEND_INV_SRC_ALPHA;
+	blendStateDesc.renderTarget[0].blendOp = RENDER_BLEND_OP_ADD;
+	blendStateDesc.renderTarget[0].srcBlendAlpha = RENDER_BLEND_SRC_ALPHA;
+	blendStateDesc.renderTarget[0].destBlendAlpha = RENDER_BLEND_DEST_ALPHA;
+	blendStateDesc.renderTarget[0].blendOpAlpha = RENDER_BLEND_OP_ADD;
+	blendStateDesc.renderTarget[0].writeMask = RENDER_COLOR_WRITE_ENABLE_ALL;
+	blendState = backend->CreateBlendState( blendStateDesc );
 
     icons[ED_ICON_ERROR] = texMan->GetTexture( context, "base_data/textures/editor/icon_error.dds" );
     icons[ED_ICON_SPHERE_LIGHT] = texMan->GetTexture( context, "base_data/textures/editor/icon_spherelight.dds" );
@@ -77,18 +76,18 @@ const int SurfaceIcon::Create( const renderContext_t* context, TextureManager* t
 void SurfaceIcon::Render( const renderContext_t* context, const edEntityIcon_t& iconPos, const edIcons_t iconId )
 {
 	Render_UploadCBuffer( context, cbuffer, &iconPos, sizeof( edEntityIcon_t ) );
-	context->deviceContext->VSSetConstantBuffers( 6, 1, &cbuffer );
+	context->backend->SetConstantBuffers( RENDER_STAGE_VERTEX, 6, 1, &cbuffer );
 
-	context->deviceContext->VSSetShader( vertexShader, NULL, 0 );
-	context->deviceContext->PSSetShader( pixelShader, NULL, 0 );
+	context->backend->SetVertexShader( vertexShader );
+	context->backend->SetPixelShader( pixelShader );
 
-	context->deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
+	context->backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
 
-	context->deviceContext->PSSetSamplers( 0, 1, &samplerState );
+	context->backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerState );
 
-	context->deviceContext->PSSetShaderResources( 0, 1, &icons[iconId]->view );
+	context->backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &icons[iconId]->view );
 
-	context->deviceContext->OMSetBlendState( blendState, 0, 0xffffffff );
-	context->deviceContext->Draw( 6, 0 );
-	context->deviceContext->OMSetBlendState( NULL, 0, 0xffffffff );
+	context->backend->SetBlendState( blendState );
+	context->backend->Draw( 6, 0 );
+	context->backend->SetBlendState( NULL );
 }
@@ -33,11 +33,11 @@ public:
 	void						Render( const renderContext_t* context, const edEntityIcon_t& iconPos, const edIcons_t iconId = ED_ICON_ERROR );
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
-	ID3D11SamplerState*			samplerState;
-	ID3D11Buffer*				cbuffer;
-	ID3D11BlendState*			blendState;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShader;
+	renderSamplerState_t*		samplerState;
+	renderBuffer_t*				cbuffer;
+	renderBlendState_t*			blendState;
 
 	texture_t*					icons[ED_ICON_COUNT];
 };
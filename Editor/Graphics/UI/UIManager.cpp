@@ -11,9 +11,11 @@
 
 #include <Engine/Graphics/Camera.h>
 #include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackendD3D11.h>
 #include <Engine/Graphics/Mesh.h>
 #include <Engine/Game/World.h>
 #include <Engine/System/Window.h>
+#include <Engine/System/FixedStep.h>
 #include <Engine/Graphics/LightManager.h>
 #include <Engine/Io/AreaFileReaderWriter.h>
 
@@ -21,6 +23,7 @@
 
 UIManager::UIManager()
 	: activeNode( nullptr )
+	, simulationMetrics( nullptr )
 	, activeManipulationMode( 0 )
 	, isToggled( true )
 	, isInputingText( false )
@@ -34,7 +37,9 @@ UIManager::UIManager()
 
 void UIManager::Initialize( const renderContext_t* context, TextureManager* texMan, const window_t* win )
 {
-	ImGui_ImplDX11_Init( win->handle, context->device, context->deviceContext );
+	// the imgui renderer is d3d11 only (so is the editor)
+	const RenderBackendD3D11* backend = static_cast<const RenderBackendD3D11*>( context->backend );
+	ImGui_ImplDX11_Init( win->handle, backend->GetDevice(), backend->GetDeviceContext() );
 
 	ImGui::PushStyleVar( ImGuiStyleVar_WindowPadding, ImVec2( 5, 5 ) );
 	ImGui::PushStyleVar( ImGuiStyleVar_WindowRounding, 0.0f );
@@ -119,8 +124,8 @@ void UIManager::DrawEdPanel( const float dt, const Camera* cam )
 
 					Ed_PanelTransformation( cam, activeManipulationMode, edModel, ( float* )&activeMesh->transformation->translation, ( float* )&activeMesh->transformation->rotation, ( float* )&activeMesh->transformation->scale );
 					
-					activeMesh->transformation->modelMatrix = DirectX::XMLoadFloat4x4( &edModel );
-					activeMesh->transformation->boundingSphere.Transform( activeMesh->transformation->boundingSphere, DirectX::XMMatrixTranspose( activeMesh->transformation->modelMatrix ) );
+					// modelMatrix is written back by the world transform update
+					activeWorld->SetNodeWorldMatrix( activeNode, DirectX::XMLoadFloat4x4( &edModel ) );
 				}
             } else if ( activeNode->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
                 ImGui::TextColored( ImVec4( 0.9f, 0.9f, 0.9f, 1.0f ), "Type: Sphere Light" );
@@ -246,8 +251,16 @@ void UIManager::DrawDebugOverlay( const float dt, const Camera* cam )
     std::string worldPosStr = "WorldPos: " + std::to_string( worldPos[0] ) + ", " + std::to_string( worldPos[1] ) + ", " + std::to_string( worldPos[2] ),              
                 fpsStr = std::to_string( ( int )winSize.x ) + "x" + std::to_string( ( int )winSize.y ) + " | " + std::to_string( ( int )ImGui::GetIO().Framerate ) + " FPS | " + std::to_string( 1000.0f / ImGui::GetIO().Framerate ) + " ms";
 
+    // simulation tick cost and frame pacing
+    std::string tickStr = "";
+    if ( simulationMetrics != nullptr ) {
+        tickStr = "Tick: " + std::to_string( simulationMetrics->tickCostAverage ) + " ms (max " + std::to_string( simulationMetrics->tickCostMax ) + ") x" + std::to_string( simulationMetrics->tickCount )
+                + " | Jitter: " + std::to_string( simulationMetrics->frameTimeJitter ) + " ms | Dropped: " + std::to_string( simulationMetrics->droppedTickCount );
+    }
+
     const ImVec2 fpsCSize = ImGui::CalcTextSize( fpsStr.c_str() );
     const ImVec2 posCSize = ImGui::CalcTextSize( worldPosStr.c_str() );
+    const ImVec2 tickCSize = ImGui::CalcTextSize( tickStr.c_str() );
 
     ImGui::SetNextWindowPos( ImVec2( winSize.x - ( posCSize.x + 15.0f ), 0 ) );
 
@@ -267,6 +280,7 @@ void UIManager::DrawDebugOverlay( const float dt, const Camera* cam )
     const ImU32 col32 = ImColor( ImVec4( 1.0f, 1.0f, 1.0f, 1.0f ) );
     draw_list->AddText( ImVec2( winSize.x - ( fpsCSize.x + 10.0f ), 5 ), col32, fpsStr.c_str() );
     draw_list->AddText( ImVec2( winSize.x - ( posCSize.x + 10.0f ), 20 ), col32, worldPosStr.c_str() );
+    draw_list->AddText( ImVec2( winSize.x - ( tickCSize.x + 10.0f ), 35 ), col32, tickStr.c_str() );
 
     ImGui::End();
 }
@@ -335,7 +349,7 @@ void UIManager::DrawMenuBar( const Camera* cam )
 
             if ( ImGui::BeginMenu( "Lights" ) ) {
 				if ( ImGui::MenuItem( "Sun Light" ) ) {
-					sunLight_t* sunLight = new sunLight_t();
+					sunLight_t* sunLight = static_cast<sunLight_t*>( activeWorld->AllocateContent( NODE_FLAG_CONTENT_SUN_LIGHT ) );
 					sunLight->worldPositionRadius = { worldPos[0] + eyeDir[0] * 2.0f, worldPos[1] + eyeDir[1] * 2.0f, worldPos[2] + eyeDir[2] * 2.0f, 1.0f };
 
 					sunLight->colorAndIntensityLux = { 1.0f, 1.0f, 1.0f, 59800.0f };
@@ -347,7 +361,7 @@ void UIManager::DrawMenuBar( const Camera* cam )
 				}
 
                 if ( ImGui::MenuItem( "Sphere Light" ) ) {
-                    sphereAreaLight_t* areaLight = new sphereAreaLight_t();
+                    sphereAreaLight_t* areaLight = static_cast<sphereAreaLight_t*>( activeWorld->AllocateContent( NODE_FLAG_CONTENT_SPHERE_LIGHT ) );
                     areaLight->worldPositionRadius  = { worldPos[0] + eyeDir[0] * 2.0f, worldPos[1] + eyeDir[1] * 2.0f, worldPos[2] + eyeDir[2] * 2.0f, 1.0f };
                     areaLight->color                = { 1.0f, 0.87f, 0.70f, 75.0f };
 
@@ -358,7 +372,7 @@ void UIManager::DrawMenuBar( const Camera* cam )
                 }
 
                 if ( ImGui::MenuItem( "Disk Light" ) ) {
-                    diskAreaLight_t* areaLight = new diskAreaLight_t();
+                    diskAreaLight_t* areaLight = static_cast<diskAreaLight_t*>( activeWorld->AllocateContent( NODE_FLAG_CONTENT_DISK_LIGHT ) );
                     areaLight->worldPositionRadius = { worldPos[0] + eyeDir[0] * 2.0f, worldPos[1] + eyeDir[1] * 2.0f, worldPos[2] + eyeDir[2] * 2.0f, 1.0f };
                     areaLight->planeNormal = { eyeDir[0], eyeDir[1], eyeDir[2], 1.0f };
                     areaLight->color = { 1.0f, 0.87f, 0.70f, 75.0f };
@@ -370,7 +384,7 @@ void UIManager::DrawMenuBar( const Camera* cam )
                 }
 
 				if ( ImGui::MenuItem( "Rectangle Light" ) ) {
-					rectangleAreaLight_t* areaLight = new rectangleAreaLight_t();
+					rectangleAreaLight_t* areaLight = static_cast<rectangleAreaLight_t*>( activeWorld->AllocateContent( NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) );
 					areaLight->worldPositionRadius = { worldPos[0] + eyeDir[0] * 2.0f, worldPos[1] + eyeDir[1] * 2.0f, worldPos[2] + eyeDir[2] * 2.0f, 1.0f };
 					areaLight->planeNormal = { eyeDir[0], eyeDir[1], eyeDir[2], 1.0f };
 					areaLight->color = { 1.0f, 0.87f, 0.70f, 75.0f };
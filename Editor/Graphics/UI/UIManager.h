@@ -5,6 +5,7 @@ struct window_t;
 struct areaNode_t;
 class Camera;
 class World;
+struct fixedStepMetrics_t;
 
 #include <d3d11.h>
 #include <Editor/Graphics/Surfaces/Icon.h>
@@ -21,6 +22,7 @@ public:
 	inline const bool	IsInputingText() const					{ return isInputingText; }
     inline void         SetNodeEdit( areaNode_t* nodeToEdit )   { activeNode = nodeToEdit; }
     inline void		    SetActiveWorld( World* world )          { activeWorld = world; }
+    inline void         SetSimulationMetrics( const fixedStepMetrics_t* metrics ) { simulationMetrics = metrics; }
     inline void         AddIconToRenderList( const edEntityIcon_t& iconPos, const edIcons_t iconId ) { iconsToRender.push_back( std::make_pair( iconId, iconPos ) ); }
 
 public:
@@ -39,6 +41,7 @@ private:
     World*	                activeWorld;
     areaNode_t*	            activeNode;
     const renderContext_t*	renderContext;
+    const fixedStepMetrics_t* simulationMetrics;
 
 	int			        activeManipulationMode;
 	bool		        isInputingText;
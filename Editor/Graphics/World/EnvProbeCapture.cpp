@@ -1,6 +1,4 @@
-#include <d3d11.h>
 #include "EnvProbeCapture.h"
-#include <d3dcompiler.h>
 
 #include <Engine/Graphics/RenderManager.h>
 #include <Engine/Graphics/RenderContext.h>
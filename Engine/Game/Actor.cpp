@@ -0,0 +1,78 @@
+#include "Shared.h"
+#include "Actor.h"
+#include "World.h"
+
+#include <cstring>
+
+using namespace DirectX;
+
+ActorTransformHistorySystem::ActorTransformHistorySystem()
+	: EntitySystem( Ecs_ComponentMask<actorTransform_t>(), Ecs_ComponentMask<actorPreviousTransform_t>() )
+{
+
+}
+
+void ActorTransformHistorySystem::Update( EntityManager* entityManager, const float )
+{
+	entityManager->ForEachChunk( GetReadMask() | GetWriteMask(), 0, []( entityChunk_t* chunk ) {
+		const actorTransform_t* transforms			= Ecs_GetChunkComponents<actorTransform_t>( chunk );
+		actorPreviousTransform_t* previousTransforms	= Ecs_GetChunkComponents<actorPreviousTransform_t>( chunk );
+
+		for ( uint32_t i = 0; i < chunk->count; ++i ) {
+			previousTransforms[i].translation	= transforms[i].translation;
+			previousTransforms[i].rotation		= transforms[i].rotation;
+			previousTransforms[i].scale			= transforms[i].scale;
+			previousTransforms[i].isValid		= 1;
+		}
+	} );
+}
+
+// the area transform hierarchies are written through actorNode_t: it is declared as written so that the systems
+// reaching them the same way never run concurrently
+ActorTransformSystem::ActorTransformSystem()
+	: EntitySystem( Ecs_ComponentMask<actorPreviousTransform_t>(), Ecs_ComponentMask<actorNode_t, actorTransform_t>() )
+	, interpolationFactor( 1.0f )
+{
+
+}
+
+void ActorTransformSystem::Update( EntityManager* entityManager, const float )
+{
+	const float alpha = interpolationFactor;
+
+	entityManager->ForEachChunk( GetReadMask() | GetWriteMask(), 0, [alpha]( entityChunk_t* chunk ) {
+		actorTransform_t* transforms					= Ecs_GetChunkComponents<actorTransform_t>( chunk );
+		const actorPreviousTransform_t* previousTransforms	= Ecs_GetChunkComponents<actorPreviousTransform_t>( chunk );
+		const actorNode_t* nodes						= Ecs_GetChunkComponents<actorNode_t>( chunk );
+
+		for ( uint32_t i = 0; i < chunk->count; ++i ) {
+			if ( transforms[i].isDirty == 0 || nodes[i].area == nullptr ) {
+				continue;
+			}
+
+			const actorTransform_t& current				= transforms[i];
+			const actorPreviousTransform_t& previous	= previousTransforms[i];
+
+			// the actor stays dirty until the previous state catches up (i.e. it stopped moving)
+			const bool isMoving = previous.isValid != 0
+				&& ( memcmp( &previous.translation, &current.translation, sizeof( XMFLOAT3 ) ) != 0
+				  || memcmp( &previous.rotation, &current.rotation, sizeof( XMFLOAT4 ) ) != 0
+				  || memcmp( &previous.scale, &current.scale, sizeof( XMFLOAT3 ) ) != 0 );
+
+			if ( !isMoving ) {
+				nodes[i].area->transforms.SetLocalTransform( nodes[i].transform, current.translation, current.rotation, current.scale );
+				transforms[i].isDirty = 0;
+				continue;
+			}
+
+			XMFLOAT3 translation, scale;
+			XMFLOAT4 rotation;
+
+			XMStoreFloat3( &translation, XMVectorLerp( XMLoadFloat3( &previous.translation ), XMLoadFloat3( &current.translation ), alpha ) );
+			XMStoreFloat4( &rotation, XMQuaternionSlerp( XMLoadFloat4( &previous.rotation ), XMLoadFloat4( &current.rotation ), alpha ) );
+			XMStoreFloat3( &scale, XMVectorLerp( XMLoadFloat3( &previous.scale ), XMLoadFloat3( &current.scale ), alpha ) );
+
+			nodes[i].area->transforms.SetLocalTransform( nodes[i].transform, translation, rotation, scale );
+		}
+	} );
+}
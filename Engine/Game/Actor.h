@@ -0,0 +1,61 @@
+#pragma once
+
+#include "EntitySystem.h"
+#include "TransformHierarchy.h"
+
+struct worldArea_t;
+
+// content of NODE_FLAG_CONTENT_ACTOR nodes
+struct actor_t
+{
+	entity_t			entity;
+};
+
+// actor components
+struct actorTransform_t
+{
+	DirectX::XMFLOAT3	translation;
+	DirectX::XMFLOAT4	rotation;
+	DirectX::XMFLOAT3	scale;
+	uint32_t			isDirty;		// set by gameplay systems; pushed to the area transform hierarchy
+};
+
+// actorTransform_t at the beginning of the current simulation tick
+struct actorPreviousTransform_t
+{
+	DirectX::XMFLOAT3	translation;
+	DirectX::XMFLOAT4	rotation;
+	DirectX::XMFLOAT3	scale;
+	uint32_t			isValid;		// 0 until the first tick (no interpolation)
+};
+
+struct actorNode_t
+{
+	worldArea_t*		area;
+	transformHandle_t	transform;
+};
+
+// saves the simulation state before the tick updates it; must be the first system of the fixed tick
+class ActorTransformHistorySystem : public EntitySystem
+{
+public:
+					ActorTransformHistorySystem();
+
+	virtual void	Update( EntityManager* entityManager, const float frameTime ) override;
+};
+
+// copies dirty actor transforms into their area hierarchy (see World::UpdateTransforms)
+// runs once per rendered frame; transforms are interpolated between the last two simulation ticks
+class ActorTransformSystem : public EntitySystem
+{
+public:
+	inline void		SetInterpolationFactor( const float alpha ) { interpolationFactor = alpha; }
+
+public:
+					ActorTransformSystem();
+
+	virtual void	Update( EntityManager* entityManager, const float frameTime ) override;
+
+private:
+	float			interpolationFactor;
+};
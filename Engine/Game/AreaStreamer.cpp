@@ -0,0 +1,485 @@
+#include "Shared.h"
+#include "AreaStreamer.h"
+#include "World.h"
+
+#include <Engine/Io/AreaFileReaderWriter.h>
+#include <Engine/Graphics/Mesh.h>
+#include <Engine/System/Log.h>
+
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+AreaStreamer::AreaStreamer()
+	: activeWorld( nullptr )
+	, activeRenderContext( nullptr )
+	, activeMaterialManager( nullptr )
+	, streamingSettings{}
+	, inFlightMemory( 0 )
+	, isShuttingDown( false )
+{
+
+}
+
+AreaStreamer::~AreaStreamer()
+{
+	Shutdown();
+}
+
+const int AreaStreamer::Initialize( World* world, const streamingSettings_t& settings, const char* folder, const renderContext_t* renderContext, MaterialManager* materialManager )
+{
+	if ( world == nullptr || folder == nullptr || settings.areaSize <= 0.0f || ( renderContext != nullptr && materialManager == nullptr ) ) {
+		return 1;
+	}
+
+	if ( world->GetGridWidth() == 0 || world->GetGridHeight() == 0 ) {
+		return 2;
+	}
+
+	activeWorld				= world;
+	activeRenderContext		= renderContext;
+	activeMaterialManager	= materialManager;
+	streamingSettings		= settings;
+	areaFolder				= folder;
+	isShuttingDown			= false;
+
+	if ( activeRenderContext != nullptr ) {
+		activeWorld->SetAreaReleaseCallback( std::bind( &AreaStreamer::ReleaseAreaMeshes, this, std::placeholders::_1 ) );
+	}
+
+	if ( streamingSettings.unloadRadius < streamingSettings.loadRadius ) {
+		streamingSettings.unloadRadius = streamingSettings.loadRadius;
+	}
+
+	areaFileSizes.resize( world->GetGridWidth() * world->GetGridHeight(), 0 );
+	areaPinCounts.resize( world->GetGridWidth() * world->GetGridHeight(), 0 );
+
+	streamingThread = std::thread( &AreaStreamer::StreamingThreadLoop, this );
+
+	return 0;
+}
+
+void AreaStreamer::Shutdown()
+{
+	if ( !streamingThread.joinable() ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( queueLock );
+		isShuttingDown = true;
+
+		for ( loadRequest_t* request : inFlightRequests ) {
+			request->cancelRequest = true;
+		}
+	}
+
+	queueCondition.notify_all();
+	streamingThread.join();
+
+	// the streaming thread is gone; whatever is left can be freed safely
+	for ( loadRequest_t* request : inFlightRequests ) {
+		World::DestroyArea( request->area );
+		delete request;
+	}
+
+	inFlightRequests.clear();
+	pendingRequests.clear();
+	completedRequests.clear();
+	inFlightMemory = 0;
+
+	// the renderer might be gone by the time the world frees its areas
+	if ( activeRenderContext != nullptr ) {
+		activeWorld->SetAreaReleaseCallback( nullptr );
+	}
+}
+
+void AreaStreamer::Update( const float* cameraPosition )
+{
+	if ( activeWorld == nullptr ) {
+		return;
+	}
+
+	const float cameraX = cameraPosition[0],
+				cameraZ = cameraPosition[2];
+
+	ProcessCompletedRequests();
+
+	EvictFarAreas( cameraX, cameraZ );
+	CancelFarRequests( cameraX, cameraZ );
+	QueueNearAreas( cameraX, cameraZ );
+
+	const int cameraAreaX = static_cast<int>( floor( cameraX / streamingSettings.areaSize ) ),
+			  cameraAreaY = static_cast<int>( floor( cameraZ / streamingSettings.areaSize ) );
+
+	if ( cameraAreaX >= 0 && cameraAreaY >= 0 ) {
+		activeWorld->SetActiveArea( static_cast<unsigned char>( cameraAreaX ), static_cast<unsigned char>( cameraAreaY ) );
+	}
+
+	activeWorld->CollectEvictedAreas();
+}
+
+void AreaStreamer::PinArea( const unsigned char x, const unsigned char y )
+{
+	if ( !IsValidArea( x, y ) ) {
+		return;
+	}
+
+	const uint32_t areaIndex = x * activeWorld->GetGridHeight() + y;
+
+	if ( areaPinCounts[areaIndex]++ == 0 ) {
+		pinnedAreas.push_back( areaIndex );
+	}
+}
+
+void AreaStreamer::UnpinArea( const unsigned char x, const unsigned char y )
+{
+	if ( !IsValidArea( x, y ) ) {
+		return;
+	}
+
+	const uint32_t areaIndex = x * activeWorld->GetGridHeight() + y;
+
+	if ( areaPinCounts[areaIndex] == 0 ) {
+		return;
+	}
+
+	// the area goes back to regular (distance based) streaming
+	if ( --areaPinCounts[areaIndex] == 0 ) {
+		pinnedAreas.erase( std::remove( pinnedAreas.begin(), pinnedAreas.end(), areaIndex ), pinnedAreas.end() );
+	}
+}
+
+const bool AreaStreamer::IsAreaPinned( const unsigned char x, const unsigned char y ) const
+{
+	return IsValidArea( x, y ) && areaPinCounts[x * activeWorld->GetGridHeight() + y] > 0;
+}
+
+const bool AreaStreamer::IsAreaUnavailable( const unsigned char x, const unsigned char y ) const
+{
+	if ( !IsValidArea( x, y ) ) {
+		return true;
+	}
+
+	const uint64_t fileSize = areaFileSizes[x * activeWorld->GetGridHeight() + y];
+
+	return fileSize == AREA_FILE_MISSING || fileSize == AREA_FILE_UNREADABLE;
+}
+
+void AreaStreamer::StreamingThreadLoop()
+{
+	while ( 1 ) {
+		loadRequest_t* request = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock( queueLock );
+			queueCondition.wait( lock, [&]() { return isShuttingDown || !pendingRequests.empty(); } );
+
+			if ( isShuttingDown ) {
+				return;
+			}
+
+			// priorities are updated by the main thread each frame; pick the closest area
+			auto closestRequest = std::min_element( pendingRequests.begin(), pendingRequests.end(),
+				[]( const loadRequest_t* a, const loadRequest_t* b ) { return a->distance < b->distance; } );
+
+			request = *closestRequest;
+			pendingRequests.erase( closestRequest );
+		}
+
+		if ( !request->cancelRequest ) {
+			worldArea_t* area = new worldArea_t();
+
+			const int readResult = Io_ReadAreaFile( GetAreaFileName( request->x, request->y ).c_str(), area, &request->cancelRequest );
+
+			if ( readResult == 0 ) {
+				area->xIndice	= request->x;
+				area->yIndice	= request->y;
+				request->area	= area;
+			} else {
+				World::DestroyArea( area );
+			}
+		}
+
+		std::lock_guard<std::mutex> lock( queueLock );
+		completedRequests.push_back( request );
+	}
+}
+
+void AreaStreamer::ProcessCompletedRequests()
+{
+	std::vector<loadRequest_t*> completed;
+
+	{
+		std::lock_guard<std::mutex> lock( queueLock );
+		completed.swap( completedRequests );
+	}
+
+	for ( loadRequest_t* request : completed ) {
+		inFlightRequests.erase( std::remove( inFlightRequests.begin(), inFlightRequests.end(), request ), inFlightRequests.end() );
+		inFlightMemory -= request->estimatedSize;
+
+		if ( request->area != nullptr && !request->cancelRequest ) {
+			CreateAreaMeshes( request->area );
+			activeWorld->PublishArea( request->area );
+		} else {
+			// not cancelled: the file is corrupted (or went away); retrying every frame would not help
+			if ( !request->cancelRequest ) {
+				Log_Printf( "AreaStreamer: failed to read '%s'\n", GetAreaFileName( request->x, request->y ).c_str() );
+				areaFileSizes[request->x * activeWorld->GetGridHeight() + request->y] = AREA_FILE_UNREADABLE;
+			}
+
+			World::DestroyArea( request->area );
+		}
+
+		delete request;
+	}
+}
+
+void AreaStreamer::CreateAreaMeshes( worldArea_t* area )
+{
+	if ( activeRenderContext == nullptr ) {
+		return;
+	}
+
+	// materials can't be loaded from the streaming thread; the mesh files are read here as well
+	area->pools.meshes.ForEach( [this]( mesh_t* mesh ) {
+		// generated meshes (e.g. static batches) can't be rebuilt from a file
+		if ( mesh->fileName.empty() ) {
+			return;
+		}
+
+		if ( Render_CreateMeshFromFile( activeRenderContext, activeMaterialManager, mesh, mesh->fileName.c_str() ) != 0 ) {
+			Log_Printf( "AreaStreamer: failed to load mesh '%s'\n", mesh->fileName.c_str() );
+		}
+	} );
+}
+
+void AreaStreamer::ReleaseAreaMeshes( worldArea_t* area )
+{
+	area->pools.meshes.ForEach( [this]( mesh_t* mesh ) {
+		if ( Render_GetMeshGeometry( mesh ) != nullptr ) {
+			Render_ReleaseMesh( activeRenderContext, activeMaterialManager, mesh );
+		}
+	} );
+}
+
+void AreaStreamer::EvictFarAreas( const float cameraX, const float cameraZ )
+{
+	// copy the list since eviction modifies it
+	const std::vector<worldArea_t*> residentAreas = activeWorld->GetResidentAreas();
+
+	for ( const worldArea_t* area : residentAreas ) {
+		if ( IsAreaPinned( area->xIndice, area->yIndice ) ) {
+			continue;
+		}
+
+		if ( GetAreaDistance( area->xIndice, area->yIndice, cameraX, cameraZ ) > streamingSettings.unloadRadius ) {
+			activeWorld->EvictArea( area->xIndice, area->yIndice );
+		}
+	}
+}
+
+void AreaStreamer::CancelFarRequests( const float cameraX, const float cameraZ )
+{
+	std::lock_guard<std::mutex> lock( queueLock );
+
+	for ( loadRequest_t* request : inFlightRequests ) {
+		if ( IsAreaPinned( request->x, request->y ) ) {
+			request->distance = 0.0f;
+			continue;
+		}
+
+		request->distance = GetAreaDistance( request->x, request->y, cameraX, cameraZ );
+
+		if ( request->distance > streamingSettings.unloadRadius ) {
+			request->cancelRequest = true;
+		}
+	}
+
+	// cancelled requests which have not been picked yet can be completed right away
+	auto cancelledBegin = std::partition( pendingRequests.begin(), pendingRequests.end(), []( const loadRequest_t* request ) { return !request->cancelRequest; } );
+	completedRequests.insert( completedRequests.end(), cancelledBegin, pendingRequests.end() );
+	pendingRequests.erase( cancelledBegin, pendingRequests.end() );
+}
+
+void AreaStreamer::QueueNearAreas( const float cameraX, const float cameraZ )
+{
+	struct candidate_t
+	{
+		unsigned char	x;
+		unsigned char	y;
+		float			distance;
+	};
+
+	std::vector<candidate_t> candidates;
+
+	// pinned areas come first, whatever their distance
+	for ( const uint32_t areaIndex : pinnedAreas ) {
+		const unsigned char areaX = static_cast<unsigned char>( areaIndex / activeWorld->GetGridHeight() ),
+							areaY = static_cast<unsigned char>( areaIndex % activeWorld->GetGridHeight() );
+
+		if ( activeWorld->GetArea( areaX, areaY ) == nullptr && !IsInFlight( areaX, areaY ) ) {
+			candidates.push_back( { areaX, areaY, 0.0f } );
+		}
+	}
+
+	const int radiusInAreas = static_cast<int>( ceil( streamingSettings.loadRadius / streamingSettings.areaSize ) );
+
+	const int cameraAreaX = static_cast<int>( floor( cameraX / streamingSettings.areaSize ) ),
+			  cameraAreaY = static_cast<int>( floor( cameraZ / streamingSettings.areaSize ) );
+
+	const int minX = std::max( 0, cameraAreaX - radiusInAreas ),
+			  maxX = std::min( static_cast<int>( activeWorld->GetGridWidth() ) - 1, cameraAreaX + radiusInAreas ),
+			  minY = std::max( 0, cameraAreaY - radiusInAreas ),
+			  maxY = std::min( static_cast<int>( activeWorld->GetGridHeight() ) - 1, cameraAreaY + radiusInAreas );
+
+	for ( int x = minX; x <= maxX; ++x ) {
+		for ( int y = minY; y <= maxY; ++y ) {
+			const float distance = GetAreaDistance( x, y, cameraX, cameraZ );
+
+			if ( distance > streamingSettings.loadRadius ) {
+				continue;
+			}
+
+			const unsigned char areaX = static_cast<unsigned char>( x ),
+								areaY = static_cast<unsigned char>( y );
+
+			if ( activeWorld->GetArea( areaX, areaY ) != nullptr || IsInFlight( areaX, areaY ) || IsAreaPinned( areaX, areaY ) ) {
+				continue;
+			}
+
+			candidates.push_back( { areaX, areaY, distance } );
+		}
+	}
+
+	if ( candidates.empty() ) {
+		return;
+	}
+
+	std::sort( candidates.begin(), candidates.end(), []( const candidate_t& a, const candidate_t& b ) { return a.distance < b.distance; } );
+
+	std::vector<loadRequest_t*> newRequests;
+
+	for ( const candidate_t& candidate : candidates ) {
+		const uint64_t fileSize = GetAreaFileSize( candidate.x, candidate.y );
+
+		if ( fileSize == AREA_FILE_MISSING || fileSize == AREA_FILE_UNREADABLE ) {
+			continue;
+		}
+
+		// rough estimate: the in-memory representation is bigger than the file itself
+		const uint64_t estimatedSize = sizeof( worldArea_t ) + fileSize * 8;
+
+		bool fitsInBudget = true;
+		while ( activeWorld->GetMemoryUsage() + inFlightMemory + estimatedSize > streamingSettings.memoryBudget ) {
+			if ( !EvictFarthestArea( cameraX, cameraZ, candidate.distance ) ) {
+				fitsInBudget = false;
+				break;
+			}
+
+			// evicted areas still count until nobody references them anymore
+			activeWorld->CollectEvictedAreas();
+		}
+
+		// candidates are sorted by distance; there is no point to try the farthest ones
+		if ( !fitsInBudget ) {
+			break;
+		}
+
+		loadRequest_t* request	= new loadRequest_t();
+		request->x				= candidate.x;
+		request->y				= candidate.y;
+		request->distance		= candidate.distance;
+		request->estimatedSize	= estimatedSize;
+		request->cancelRequest	= false;
+		request->area			= nullptr;
+
+		inFlightRequests.push_back( request );
+		inFlightMemory += estimatedSize;
+
+		newRequests.push_back( request );
+	}
+
+	if ( !newRequests.empty() ) {
+		{
+			std::lock_guard<std::mutex> lock( queueLock );
+			pendingRequests.insert( pendingRequests.end(), newRequests.begin(), newRequests.end() );
+		}
+
+		queueCondition.notify_one();
+	}
+}
+
+const bool AreaStreamer::EvictFarthestArea( const float cameraX, const float cameraZ, const float candidateDistance )
+{
+	const worldArea_t*	farthestArea		= nullptr;
+	float				farthestDistance	= candidateDistance;
+
+	for ( const worldArea_t* area : activeWorld->GetResidentAreas() ) {
+		if ( area == activeWorld->GetActiveArea() || IsAreaPinned( area->xIndice, area->yIndice ) ) {
+			continue;
+		}
+
+		const float distance = GetAreaDistance( area->xIndice, area->yIndice, cameraX, cameraZ );
+
+		// never evict something closer than what we are trying to load
+		if ( distance > farthestDistance ) {
+			farthestDistance	= distance;
+			farthestArea		= area;
+		}
+	}
+
+	if ( farthestArea == nullptr ) {
+		return false;
+	}
+
+	activeWorld->EvictArea( farthestArea->xIndice, farthestArea->yIndice );
+
+	return true;
+}
+
+float AreaStreamer::GetAreaDistance( const int x, const int y, const float cameraX, const float cameraZ ) const
+{
+	const float areaCenterX = ( static_cast<float>( x ) + 0.5f ) * streamingSettings.areaSize,
+				areaCenterZ = ( static_cast<float>( y ) + 0.5f ) * streamingSettings.areaSize;
+
+	const float dx = areaCenterX - cameraX,
+				dz = areaCenterZ - cameraZ;
+
+	return sqrt( dx * dx + dz * dz );
+}
+
+uint64_t AreaStreamer::GetAreaFileSize( const unsigned char x, const unsigned char y )
+{
+	uint64_t& fileSize = areaFileSizes[x * activeWorld->GetGridHeight() + y];
+
+	if ( fileSize == 0 ) {
+		std::ifstream fileStream( GetAreaFileName( x, y ), std::ios::binary | std::ios::ate );
+
+		fileSize = ( fileStream.is_open() ) ? static_cast<uint64_t>( fileStream.tellg() ) : AREA_FILE_MISSING;
+	}
+
+	return fileSize;
+}
+
+std::string AreaStreamer::GetAreaFileName( const unsigned char x, const unsigned char y ) const
+{
+	return areaFolder + "/area_" + std::to_string( x ) + "_" + std::to_string( y ) + ".area";
+}
+
+const bool AreaStreamer::IsInFlight( const unsigned char x, const unsigned char y ) const
+{
+	for ( const loadRequest_t* request : inFlightRequests ) {
+		if ( request->x == x && request->y == y ) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const bool AreaStreamer::IsValidArea( const unsigned char x, const unsigned char y ) const
+{
+	return activeWorld != nullptr && x < activeWorld->GetGridWidth() && y < activeWorld->GetGridHeight();
+}
\ No newline at end of file
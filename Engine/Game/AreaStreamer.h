@@ -0,0 +1,102 @@
+#pragma once
+
+struct worldArea_t;
+struct renderContext_t;
+class World;
+class MaterialManager;
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <atomic>
+#include <string>
+
+struct streamingSettings_t
+{
+	float			areaSize;		// world units covered by a single area (X and Z axis)
+	float			loadRadius;		// areas closer than this are paged in
+	float			unloadRadius;	// areas further than this are paged out (keep it > loadRadius to avoid ping-pong)
+	uint64_t		memoryBudget;	// hard cap (in bytes) for resident + evicted + in flight areas
+};
+
+// pages world areas in and out around the camera
+// area files are read on a dedicated thread; publishing/eviction always happen on the main thread
+// pinned areas are loaded first and stay resident wherever the camera is (see StateManager)
+// mesh geometry is created when an area gets published, and released when it gets freed; without a render context
+// (e.g. headless runs), meshes only have their file name and bounds
+class AreaStreamer
+{
+public:
+	inline uint64_t		GetInFlightMemory() const	{ return inFlightMemory; }
+	inline std::size_t	GetInFlightCount() const	{ return inFlightRequests.size(); }
+
+public:
+					AreaStreamer();
+					AreaStreamer( AreaStreamer& ) = delete;
+					~AreaStreamer();
+
+	const int		Initialize( World* world, const streamingSettings_t& settings, const char* areaFolder, const renderContext_t* renderContext = nullptr, MaterialManager* materialManager = nullptr );
+	void			Shutdown();
+	void			Update( const float* cameraPosition );
+
+	// pins are counted; an area stays pinned until every PinArea call has been matched
+	void			PinArea( const unsigned char x, const unsigned char y );
+	void			UnpinArea( const unsigned char x, const unsigned char y );
+	const bool		IsAreaPinned( const unsigned char x, const unsigned char y ) const;
+
+	// the area file is missing or could not be read; such areas are never requested again
+	const bool		IsAreaUnavailable( const unsigned char x, const unsigned char y ) const;
+
+private:
+	struct loadRequest_t
+	{
+		unsigned char		x;
+		unsigned char		y;
+		float				distance;		// priority; closest areas are loaded first
+		uint64_t			estimatedSize;
+		std::atomic<bool>	cancelRequest;
+		worldArea_t*		area;			// null if the load failed or has been cancelled
+	};
+
+	static constexpr uint64_t AREA_FILE_MISSING		= ~0ull;
+	static constexpr uint64_t AREA_FILE_UNREADABLE	= ~1ull;	// Io_ReadAreaFile failed
+
+private:
+	World*						activeWorld;
+	const renderContext_t*		activeRenderContext;	// null if the geometry is not needed
+	MaterialManager*			activeMaterialManager;
+	streamingSettings_t			streamingSettings;
+	std::string					areaFolder;
+
+	std::vector<uint64_t>		areaFileSizes;		// 0 if unknown yet; AREA_FILE_MISSING/UNREADABLE if there is nothing to load
+	std::vector<uint32_t>		areaPinCounts;
+	std::vector<uint32_t>		pinnedAreas;		// x * gridHeight + y of every area with a pin count > 0
+	std::vector<loadRequest_t*>	inFlightRequests;	// main thread only
+	uint64_t					inFlightMemory;
+
+	// shared with the streaming thread
+	std::mutex					queueLock;
+	std::condition_variable		queueCondition;
+	std::vector<loadRequest_t*>	pendingRequests;
+	std::vector<loadRequest_t*>	completedRequests;
+	bool						isShuttingDown;
+
+	std::thread					streamingThread;
+
+private:
+	void			StreamingThreadLoop();
+	void			ProcessCompletedRequests();
+	void			CreateAreaMeshes( worldArea_t* area );
+	void			ReleaseAreaMeshes( worldArea_t* area );
+	void			EvictFarAreas( const float cameraX, const float cameraZ );
+	void			CancelFarRequests( const float cameraX, const float cameraZ );
+	void			QueueNearAreas( const float cameraX, const float cameraZ );
+	const bool		EvictFarthestArea( const float cameraX, const float cameraZ, const float candidateDistance );
+
+	float			GetAreaDistance( const int x, const int y, const float cameraX, const float cameraZ ) const;
+	uint64_t		GetAreaFileSize( const unsigned char x, const unsigned char y );
+	std::string		GetAreaFileName( const unsigned char x, const unsigned char y ) const;
+	const bool		IsInFlight( const unsigned char x, const unsigned char y ) const;
+	const bool		IsValidArea( const unsigned char x, const unsigned char y ) const;
+};
@@ -0,0 +1,311 @@
+#include "Shared.h"
+#include "EntityManager.h"
+
+#include <Engine/System/Platform.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace
+{
+	struct componentInfo_t
+	{
+		uint32_t	size;
+		uint32_t	alignment;
+	};
+
+	std::mutex			g_ComponentRegistryLock;
+	componentInfo_t		g_ComponentInfos[MAX_COMPONENT_COUNT] = {};
+	componentId_t		g_ComponentCount = 0;
+
+	inline uint32_t GetEntityIndex( const entity_t entity )
+	{
+		return static_cast<uint32_t>( entity & 0xFFFFFFFF );
+	}
+
+	inline uint32_t GetEntityGeneration( const entity_t entity )
+	{
+		return static_cast<uint32_t>( entity >> 32 );
+	}
+
+	inline uint32_t AlignOffset( const uint32_t offset, const uint32_t alignment )
+	{
+		return ( offset + alignment - 1 ) & ~( alignment - 1 );
+	}
+}
+
+componentId_t Ecs_RegisterComponent( const uint32_t size, const uint32_t alignment )
+{
+	std::lock_guard<std::mutex> lock( g_ComponentRegistryLock );
+
+	if ( g_ComponentCount >= MAX_COMPONENT_COUNT ) {
+		// not recoverable; component masks are 64 bits wide
+		abort();
+	}
+
+	g_ComponentInfos[g_ComponentCount] = { size, alignment };
+
+	return g_ComponentCount++;
+}
+
+EntityManager::EntityManager()
+	: entityCount( 0 )
+{
+
+}
+
+EntityManager::~EntityManager()
+{
+	for ( archetype_t* archetype : archetypes ) {
+		for ( entityChunk_t* chunk : archetype->chunks ) {
+			Sys_AlignedFree( chunk->data );
+			delete chunk;
+		}
+
+		delete archetype;
+	}
+
+	archetypes.clear();
+	archetypesByMask.clear();
+}
+
+entity_t EntityManager::CreateEntity( const componentMask_t components )
+{
+	uint32_t index = 0;
+
+	if ( !freeIndices.empty() ) {
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	} else {
+		index = static_cast<uint32_t>( records.size() );
+		records.push_back( { nullptr, nullptr, 0, 0 } );
+	}
+
+	entityRecord_t& record = records[index];
+	const entity_t entity = ( static_cast<entity_t>( record.generation ) << 32 ) | index;
+
+	PushEntity( GetOrCreateArchetype( components ), entity, record );
+
+	entityCount++;
+
+	return entity;
+}
+
+void EntityManager::DestroyEntity( const entity_t entity )
+{
+	if ( !IsAlive( entity ) ) {
+		return;
+	}
+
+	const uint32_t index = GetEntityIndex( entity );
+	entityRecord_t& record = records[index];
+
+	PopEntity( record );
+
+	record.archetype = nullptr;
+	record.chunk = nullptr;
+	record.generation++; // invalidates dangling handles
+
+	freeIndices.push_back( index );
+	entityCount--;
+}
+
+const bool EntityManager::IsAlive( const entity_t entity ) const
+{
+	const uint32_t index = GetEntityIndex( entity );
+
+	return entity != ENTITY_INVALID
+		&& index < records.size()
+		&& records[index].archetype != nullptr
+		&& records[index].generation == GetEntityGeneration( entity );
+}
+
+void EntityManager::AddComponents( const entity_t entity, const componentMask_t components )
+{
+	if ( !IsAlive( entity ) ) {
+		return;
+	}
+
+	MoveEntity( entity, records[GetEntityIndex( entity )].archetype->mask | components );
+}
+
+void EntityManager::RemoveComponents( const entity_t entity, const componentMask_t components )
+{
+	if ( !IsAlive( entity ) ) {
+		return;
+	}
+
+	MoveEntity( entity, records[GetEntityIndex( entity )].archetype->mask & ~components );
+}
+
+const componentMask_t EntityManager::GetComponentMask( const entity_t entity ) const
+{
+	return IsAlive( entity ) ? records[GetEntityIndex( entity )].archetype->mask : 0;
+}
+
+void* EntityManager::GetComponent( const entity_t entity, const componentId_t component ) const
+{
+	if ( !IsAlive( entity ) || component >= MAX_COMPONENT_COUNT ) {
+		return nullptr;
+	}
+
+	const entityRecord_t& record = records[GetEntityIndex( entity )];
+	const uint32_t offset = record.archetype->componentOffsets[component];
+
+	if ( offset == ~0u ) {
+		return nullptr;
+	}
+
+	return record.chunk->data + offset + record.row * record.archetype->componentSizes[component];
+}
+
+void EntityManager::CollectChunks( const componentMask_t required, const componentMask_t excluded, std::vector<entityChunk_t*>& chunks ) const
+{
+	ForEachChunk( required, excluded, [&chunks]( entityChunk_t* chunk ) { chunks.push_back( chunk ); } );
+}
+
+archetype_t* EntityManager::GetOrCreateArchetype( const componentMask_t components )
+{
+	auto it = archetypesByMask.find( components );
+
+	if ( it != archetypesByMask.end() ) {
+		return it->second;
+	}
+
+	archetype_t* archetype = new archetype_t();
+	archetype->mask			= components;
+	archetype->entityCount	= 0;
+
+	uint32_t bytesPerEntity = sizeof( entity_t ), arrayCount = 1;
+
+	for ( componentId_t id = 0; id < MAX_COMPONENT_COUNT; ++id ) {
+		archetype->componentOffsets[id]	= ~0u;
+		archetype->componentSizes[id]	= 0;
+
+		if ( components & ( 1ull << id ) ) {
+			bytesPerEntity += g_ComponentInfos[id].size;
+			arrayCount++;
+		}
+	}
+
+	// keep room to start every array on a cache line
+	// an entity too large for a chunk gets a chunk of its own, sized to fit
+	const uint32_t usableSize = CHUNK_SIZE - arrayCount * CHUNK_ALIGNMENT;
+	archetype->chunkCapacity = std::max( 1u, usableSize / bytesPerEntity );
+
+	uint32_t offset = AlignOffset( archetype->chunkCapacity * static_cast<uint32_t>( sizeof( entity_t ) ), CHUNK_ALIGNMENT );
+
+	for ( componentId_t id = 0; id < MAX_COMPONENT_COUNT; ++id ) {
+		if ( components & ( 1ull << id ) ) {
+			archetype->componentOffsets[id]	= offset;
+			archetype->componentSizes[id]	= g_ComponentInfos[id].size;
+
+			offset = AlignOffset( offset + archetype->chunkCapacity * g_ComponentInfos[id].size, CHUNK_ALIGNMENT );
+		}
+	}
+
+	archetype->chunkSize = ( offset > CHUNK_SIZE ) ? offset : CHUNK_SIZE;
+
+	archetypes.push_back( archetype );
+	archetypesByMask[components] = archetype;
+
+	return archetype;
+}
+
+void EntityManager::PushEntity( archetype_t* archetype, const entity_t entity, entityRecord_t& record )
+{
+	entityChunk_t* chunk = archetype->chunks.empty() ? nullptr : archetype->chunks.back();
+
+	if ( chunk == nullptr || chunk->count == chunk->capacity ) {
+		chunk = new entityChunk_t();
+		chunk->archetype	= archetype;
+		chunk->data			= static_cast<uint8_t*>( Sys_AlignedAlloc( archetype->chunkSize, CHUNK_ALIGNMENT ) );
+		chunk->count		= 0;
+		chunk->capacity		= archetype->chunkCapacity;
+
+		archetype->chunks.push_back( chunk );
+	}
+
+	const uint32_t row = chunk->count++;
+
+	reinterpret_cast<entity_t*>( chunk->data )[row] = entity;
+
+	for ( componentId_t id = 0; id < MAX_COMPONENT_COUNT; ++id ) {
+		if ( archetype->mask & ( 1ull << id ) ) {
+			memset( chunk->data + archetype->componentOffsets[id] + row * archetype->componentSizes[id], 0, archetype->componentSizes[id] );
+		}
+	}
+
+	record.archetype	= archetype;
+	record.chunk		= chunk;
+	record.row			= row;
+
+	archetype->entityCount++;
+}
+
+void EntityManager::PopEntity( entityRecord_t& record )
+{
+	archetype_t* archetype		= record.archetype;
+	entityChunk_t* lastChunk	= archetype->chunks.back();
+
+	const uint32_t lastRow = lastChunk->count - 1;
+
+	// fill the hole with the last entity of the archetype (keeps every chunk but the last one full)
+	if ( lastChunk != record.chunk || lastRow != record.row ) {
+		const entity_t movedEntity = Ecs_GetChunkEntities( lastChunk )[lastRow];
+
+		reinterpret_cast<entity_t*>( record.chunk->data )[record.row] = movedEntity;
+
+		for ( componentId_t id = 0; id < MAX_COMPONENT_COUNT; ++id ) {
+			if ( archetype->mask & ( 1ull << id ) ) {
+				const uint32_t offset = archetype->componentOffsets[id], size = archetype->componentSizes[id];
+				memcpy( record.chunk->data + offset + record.row * size, lastChunk->data + offset + lastRow * size, size );
+			}
+		}
+
+		entityRecord_t& movedRecord = records[GetEntityIndex( movedEntity )];
+		movedRecord.chunk	= record.chunk;
+		movedRecord.row		= record.row;
+	}
+
+	lastChunk->count--;
+
+	if ( lastChunk->count == 0 ) {
+		Sys_AlignedFree( lastChunk->data );
+		delete lastChunk;
+
+		archetype->chunks.pop_back();
+	}
+
+	archetype->entityCount--;
+}
+
+void EntityManager::MoveEntity( const entity_t entity, const componentMask_t components )
+{
+	entityRecord_t& record = records[GetEntityIndex( entity )];
+
+	archetype_t* previousArchetype = record.archetype;
+	archetype_t* nextArchetype = GetOrCreateArchetype( components );
+
+	if ( previousArchetype == nextArchetype ) {
+		return;
+	}
+
+	entityRecord_t previousRecord = record;
+	PushEntity( nextArchetype, entity, record );
+
+	// copy components shared by both archetypes
+	const componentMask_t sharedComponents = previousArchetype->mask & nextArchetype->mask;
+
+	for ( componentId_t id = 0; id < MAX_COMPONENT_COUNT; ++id ) {
+		if ( sharedComponents & ( 1ull << id ) ) {
+			const uint32_t size = nextArchetype->componentSizes[id];
+
+			memcpy( record.chunk->data + nextArchetype->componentOffsets[id] + record.row * size,
+					previousRecord.chunk->data + previousArchetype->componentOffsets[id] + previousRecord.row * size,
+					size );
+		}
+	}
+
+	PopEntity( previousRecord );
+}
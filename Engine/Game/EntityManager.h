@@ -0,0 +1,154 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+
+using entity_t			= uint64_t;	// 0-31 : index; 32-63 : generation
+using componentMask_t	= uint64_t;	// one bit per component type
+using componentId_t		= uint32_t;
+
+static constexpr entity_t		ENTITY_INVALID			= ~0ull;
+static constexpr componentId_t	MAX_COMPONENT_COUNT		= 64;
+
+// assigns an id to a component type (thread safe; ids depend on first use order)
+componentId_t	Ecs_RegisterComponent( const uint32_t size, const uint32_t alignment );
+
+template<typename T>
+struct Component
+{
+	// chunks move components around with memcpy
+	static_assert( std::is_trivially_copyable<T>::value, "components must be trivially copyable" );
+
+	static componentId_t GetId()
+	{
+		static const componentId_t id = Ecs_RegisterComponent( sizeof( T ), alignof( T ) );
+		return id;
+	}
+
+	static componentMask_t GetMask()
+	{
+		return 1ull << GetId();
+	}
+};
+
+template<typename... T>
+componentMask_t Ecs_ComponentMask()
+{
+	const componentMask_t masks[] = { 0ull, Component<T>::GetMask()... };
+
+	componentMask_t mask = 0;
+	for ( const componentMask_t componentMask : masks ) {
+		mask |= componentMask;
+	}
+
+	return mask;
+}
+
+struct archetype_t;
+
+// block holding entities of a single archetype (CHUNK_SIZE bytes, unless a single entity does not fit)
+// layout: entity ids, then one array per component (each array starts on a cache line)
+struct entityChunk_t
+{
+	archetype_t*	archetype;
+	uint8_t*		data;
+	uint32_t		count;
+	uint32_t		capacity;
+};
+
+struct archetype_t
+{
+	componentMask_t					mask;
+	uint32_t						chunkCapacity;
+	uint32_t						chunkSize;								// bytes; CHUNK_SIZE, or the size of a single entity if larger
+	uint32_t						componentOffsets[MAX_COMPONENT_COUNT];	// offset of each component array in a chunk; ~0 if absent
+	uint32_t						componentSizes[MAX_COMPONENT_COUNT];
+	std::vector<entityChunk_t*>		chunks;									// every chunk is full, except the last one
+	uint64_t						entityCount;
+};
+
+template<typename T>
+T* Ecs_GetChunkComponents( const entityChunk_t* chunk )
+{
+	const uint32_t offset = chunk->archetype->componentOffsets[Component<T>::GetId()];
+	return ( offset == ~0u ) ? nullptr : reinterpret_cast<T*>( chunk->data + offset );
+}
+
+inline const entity_t* Ecs_GetChunkEntities( const entityChunk_t* chunk )
+{
+	return reinterpret_cast<const entity_t*>( chunk->data );
+}
+
+// archetype based entity storage
+// entities sharing the same set of components are packed together in chunks; queries iterate matching chunks linearly
+// structural changes (create, destroy, add/remove components) must not happen while systems are running
+class EntityManager
+{
+public:
+	static constexpr uint32_t	CHUNK_SIZE			= 16 * 1024;
+	static constexpr uint32_t	CHUNK_ALIGNMENT		= 64; // cache line
+
+public:
+	inline std::size_t		GetEntityCount() const		{ return entityCount; }
+	inline std::size_t		GetArchetypeCount() const	{ return archetypes.size(); }
+
+public:
+							EntityManager();
+							EntityManager( EntityManager& ) = delete;
+							~EntityManager();
+
+	entity_t				CreateEntity( const componentMask_t components );
+	void					DestroyEntity( const entity_t entity );
+	const bool				IsAlive( const entity_t entity ) const;
+
+	void					AddComponents( const entity_t entity, const componentMask_t components );
+	void					RemoveComponents( const entity_t entity, const componentMask_t components );
+	const componentMask_t	GetComponentMask( const entity_t entity ) const;
+
+	void*					GetComponent( const entity_t entity, const componentId_t component ) const;
+
+	template<typename T>
+	T* GetComponent( const entity_t entity ) const
+	{
+		return static_cast<T*>( GetComponent( entity, Component<T>::GetId() ) );
+	}
+
+	// chunks holding every component of 'required' and none of 'excluded'
+	void					CollectChunks( const componentMask_t required, const componentMask_t excluded, std::vector<entityChunk_t*>& chunks ) const;
+
+	template<typename Func>
+	void ForEachChunk( const componentMask_t required, const componentMask_t excluded, Func func ) const
+	{
+		for ( const archetype_t* archetype : archetypes ) {
+			if ( ( archetype->mask & required ) != required || ( archetype->mask & excluded ) != 0 ) {
+				continue;
+			}
+
+			for ( entityChunk_t* chunk : archetype->chunks ) {
+				func( chunk );
+			}
+		}
+	}
+
+private:
+	struct entityRecord_t
+	{
+		archetype_t*	archetype;
+		entityChunk_t*	chunk;
+		uint32_t		row;
+		uint32_t		generation;
+	};
+
+	std::vector<entityRecord_t>						records;
+	std::vector<uint32_t>							freeIndices;
+	std::vector<archetype_t*>						archetypes;
+	std::unordered_map<componentMask_t, archetype_t*>	archetypesByMask;
+	std::size_t										entityCount;
+
+private:
+	archetype_t*			GetOrCreateArchetype( const componentMask_t components );
+	void					PushEntity( archetype_t* archetype, const entity_t entity, entityRecord_t& record );
+	void					PopEntity( entityRecord_t& record );
+	void					MoveEntity( const entity_t entity, const componentMask_t components );
+};
@@ -0,0 +1,96 @@
+#include "Shared.h"
+#include "EntitySystem.h"
+
+#include <Engine/System/JobSystem.h>
+
+#include <algorithm>
+
+namespace
+{
+	inline bool HasConflict( const EntitySystem* a, const EntitySystem* b )
+	{
+		return ( a->GetWriteMask() & ( b->GetReadMask() | b->GetWriteMask() ) ) != 0
+			|| ( b->GetWriteMask() & a->GetReadMask() ) != 0;
+	}
+}
+
+SystemScheduler::SystemScheduler()
+{
+
+}
+
+SystemScheduler::~SystemScheduler()
+{
+	systems.clear();
+	phases.clear();
+}
+
+void SystemScheduler::AddSystem( EntitySystem* system )
+{
+	if ( system == nullptr ) {
+		return;
+	}
+
+	systems.push_back( system );
+
+	BuildPhases();
+}
+
+void SystemScheduler::Update( EntityManager* entityManager, const float frameTime )
+{
+	struct systemJob_t
+	{
+		EntitySystem*	system;
+		EntityManager*	entityManager;
+		float			frameTime;
+	};
+
+	std::vector<systemJob_t>	systemJobs;
+	std::vector<jobDesc_t>		jobs;
+
+	for ( std::vector<EntitySystem*>& phase : phases ) {
+		if ( phase.size() == 1 ) {
+			phase[0]->Update( entityManager, frameTime );
+			continue;
+		}
+
+		systemJobs.resize( phase.size() );
+		jobs.resize( phase.size() );
+
+		for ( std::size_t i = 0; i < phase.size(); ++i ) {
+			systemJobs[i] = { phase[i], entityManager, frameTime };
+
+			jobs[i].function	= []( void* data ) {
+				systemJob_t* job = static_cast<systemJob_t*>( data );
+				job->system->Update( job->entityManager, job->frameTime );
+			};
+			jobs[i].data		= &systemJobs[i];
+		}
+
+		jobCounter_t phaseCounter;
+		Job_Submit( jobs.data(), static_cast<uint32_t>( jobs.size() ), &phaseCounter );
+		Job_Wait( &phaseCounter );
+	}
+}
+
+void SystemScheduler::BuildPhases()
+{
+	phases.clear();
+
+	// a system runs after every previously registered system it conflicts with
+	std::vector<std::size_t> systemPhases( systems.size(), 0 );
+
+	for ( std::size_t i = 0; i < systems.size(); ++i ) {
+		for ( std::size_t j = 0; j < i; ++j ) {
+			if ( HasConflict( systems[i], systems[j] ) ) {
+				systemPhases[i] = std::max( systemPhases[i], systemPhases[j] + 1 );
+			}
+		}
+
+		if ( systemPhases[i] >= phases.size() ) {
+			phases.resize( systemPhases[i] + 1 );
+		}
+
+		phases[systemPhases[i]].push_back( systems[i] );
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "EntityManager.h"
+
+#include <vector>
+
+// a system updates every entity matching its components
+// read/write masks are used to figure out which systems can run concurrently
+class EntitySystem
+{
+public:
+	inline componentMask_t	GetReadMask() const		{ return readMask; }
+	inline componentMask_t	GetWriteMask() const	{ return writeMask; }
+
+public:
+	virtual					~EntitySystem() {}
+	virtual void			Update( EntityManager* entityManager, const float frameTime ) = 0;
+
+protected:
+							EntitySystem( const componentMask_t readComponents, const componentMask_t writeComponents )
+								: readMask( readComponents )
+								, writeMask( writeComponents )
+							{
+
+							}
+
+private:
+	componentMask_t			readMask;
+	componentMask_t			writeMask;
+};
+
+// runs systems in registration order; systems without conflicting accesses are grouped in phases and run in parallel
+class SystemScheduler
+{
+public:
+	inline std::size_t		GetPhaseCount() const	{ return phases.size(); }
+
+public:
+							SystemScheduler();
+							SystemScheduler( SystemScheduler& ) = delete;
+							~SystemScheduler();
+
+	void					AddSystem( EntitySystem* system );
+	void					Update( EntityManager* entityManager, const float frameTime );
+
+private:
+	std::vector<EntitySystem*>				systems;
+	std::vector<std::vector<EntitySystem*>>	phases;
+
+private:
+	void					BuildPhases();
+};
@@ -1,3 +1,387 @@
 #include "Shared.h"
-#include "World.h"
+#include "StateManager.h"
+#include "AreaStreamer.h"
 
+#include <Engine/Graphics/Texture.h>
+#include <Engine/System/Log.h>
+
+#include <algorithm>
+#include <utility>
+
+StateManager::StateManager()
+	: activeWorld( nullptr )
+	, activeStreamer( nullptr )
+	, activeRenderContext( nullptr )
+	, activeTextureManager( nullptr )
+	, pendingTransition( STATE_TRANSITION_NONE )
+	, preload( nullptr )
+	, loadingPreload( nullptr )
+	, isShuttingDown( false )
+{
+
+}
+
+StateManager::~StateManager()
+{
+	Shutdown();
+}
+
+const int StateManager::Initialize( World* world, AreaStreamer* areaStreamer, const renderContext_t* renderContext, TextureManager* textureManager )
+{
+	if ( world == nullptr ) {
+		return 1;
+	}
+
+	activeWorld				= world;
+	activeStreamer			= areaStreamer;
+	activeRenderContext		= renderContext;
+	activeTextureManager	= ( renderContext != nullptr ) ? textureManager : nullptr;
+	isShuttingDown			= false;
+
+	if ( activeTextureManager != nullptr ) {
+		preloadThread = std::thread( &StateManager::PreloadThreadLoop, this );
+	}
+
+	return 0;
+}
+
+void StateManager::Shutdown()
+{
+	if ( activeWorld == nullptr ) {
+		return;
+	}
+
+	while ( !stack.empty() ) {
+		stack.back().state->OnExit( activeWorld );
+		UnpinAreas( stack.back().dependencies );
+		ReleaseTextures( stack.back().textures );
+
+		stack.pop_back();
+	}
+
+	pendingTransition = STATE_TRANSITION_NONE;
+	ReleasePreload( true );
+
+	if ( preloadThread.joinable() ) {
+		{
+			std::lock_guard<std::mutex> lock( queueLock );
+			isShuttingDown = true;
+		}
+
+		queueCondition.notify_all();
+		preloadThread.join();
+	}
+
+	activeWorld				= nullptr;
+	activeStreamer			= nullptr;
+	activeRenderContext		= nullptr;
+	activeTextureManager	= nullptr;
+}
+
+void StateManager::Preload( GameState* state )
+{
+	if ( activeWorld == nullptr || state == nullptr ) {
+		return;
+	}
+
+	if ( preload != nullptr && preload->state == state ) {
+		return;
+	}
+
+	ReleasePreload( true );
+
+	preload						= new preload_t();
+	preload->state				= state;
+	preload->loadedTextureCount	= 0;
+	preload->failedTextureCount	= 0;
+	preload->cancelRequest		= false;
+
+	state->GetDependencies( preload->dependencies );
+	preload->textures.resize( preload->dependencies.textures.size(), nullptr );
+
+	// the streamer picks pinned areas first on its next update
+	PinAreas( preload->dependencies );
+
+	if ( activeTextureManager == nullptr || preload->dependencies.textures.empty() ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( queueLock );
+		pendingPreloads.push_back( preload );
+	}
+
+	queueCondition.notify_one();
+}
+
+const float StateManager::GetPreloadProgress() const
+{
+	if ( preload == nullptr ) {
+		return 1.0f;
+	}
+
+	const stateDependencies_t& dependencies = preload->dependencies;
+
+	std::size_t dependencyCount = 0, residentCount = 0;
+
+	if ( activeStreamer != nullptr ) {
+		dependencyCount += dependencies.areas.size();
+
+		for ( const stateArea_t& area : dependencies.areas ) {
+			if ( IsAreaSettled( area ) ) {
+				residentCount++;
+			}
+		}
+	}
+
+	if ( activeTextureManager != nullptr ) {
+		dependencyCount += dependencies.textures.size();
+		residentCount += preload->loadedTextureCount.load( std::memory_order_acquire );
+	}
+
+	return ( dependencyCount == 0 ) ? 1.0f : static_cast<float>( residentCount ) / static_cast<float>( dependencyCount );
+}
+
+const uint32_t StateManager::GetPreloadFailureCount() const
+{
+	if ( preload == nullptr ) {
+		return 0;
+	}
+
+	uint32_t failureCount = preload->failedTextureCount.load( std::memory_order_acquire );
+
+	if ( activeStreamer != nullptr ) {
+		for ( const stateArea_t& area : preload->dependencies.areas ) {
+			if ( activeStreamer->IsAreaUnavailable( area.x, area.y ) ) {
+				failureCount++;
+			}
+		}
+	}
+
+	return failureCount;
+}
+
+void StateManager::PushState( GameState* state )
+{
+	if ( state == nullptr ) {
+		return;
+	}
+
+	Preload( state );
+	pendingTransition = STATE_TRANSITION_PUSH;
+}
+
+void StateManager::SwitchState( GameState* state )
+{
+	if ( state == nullptr ) {
+		return;
+	}
+
+	Preload( state );
+	pendingTransition = STATE_TRANSITION_SWITCH;
+}
+
+void StateManager::PopState()
+{
+	// the preload (if any) is kept; it might be pushed later
+	pendingTransition = STATE_TRANSITION_POP;
+}
+
+void StateManager::Frame()
+{
+	if ( pendingTransition == STATE_TRANSITION_NONE ) {
+		return;
+	}
+
+	// the current state keeps running until the next one is ready
+	if ( pendingTransition != STATE_TRANSITION_POP && !IsPreloadComplete() ) {
+		return;
+	}
+
+	CompleteTransition();
+}
+
+void StateManager::Update( const float tickDuration )
+{
+	GameState* activeState = GetActiveState();
+
+	if ( activeState != nullptr ) {
+		activeState->Update( tickDuration );
+	}
+}
+
+void StateManager::PreloadThreadLoop()
+{
+	while ( 1 ) {
+		preload_t* loadingRequest = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock( queueLock );
+			queueCondition.wait( lock, [&]() { return isShuttingDown || !pendingPreloads.empty(); } );
+
+			if ( isShuttingDown ) {
+				return;
+			}
+
+			loadingRequest = pendingPreloads.front();
+			pendingPreloads.erase( pendingPreloads.begin() );
+
+			loadingPreload = loadingRequest;
+		}
+
+		for ( std::size_t i = 0; i < loadingRequest->dependencies.textures.size(); ++i ) {
+			if ( loadingRequest->cancelRequest ) {
+				break;
+			}
+
+			// the reference is handed over to the stack entry of the state (see CompleteTransition); the state gets the
+			// texture back instantly once active
+			loadingRequest->textures[i] = activeTextureManager->GetTexture( activeRenderContext, loadingRequest->dependencies.textures[i].c_str() );
+
+			if ( loadingRequest->textures[i] == nullptr ) {
+				loadingRequest->failedTextureCount.fetch_add( 1, std::memory_order_relaxed );
+			}
+
+			loadingRequest->loadedTextureCount.fetch_add( 1, std::memory_order_release );
+		}
+
+		std::lock_guard<std::mutex> lock( queueLock );
+		loadingPreload = nullptr;
+
+		if ( loadingRequest->cancelRequest ) {
+			ReleaseTextures( loadingRequest->textures );
+			delete loadingRequest;
+		}
+	}
+}
+
+void StateManager::ReleasePreload( const bool unpinAreas )
+{
+	if ( preload == nullptr ) {
+		return;
+	}
+
+	if ( unpinAreas ) {
+		UnpinAreas( preload->dependencies );
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( queueLock );
+
+		auto pendingPreload = std::find( pendingPreloads.begin(), pendingPreloads.end(), preload );
+
+		if ( pendingPreload != pendingPreloads.end() ) {
+			pendingPreloads.erase( pendingPreload );
+			delete preload;
+		} else if ( loadingPreload == preload ) {
+			// still in use; the preload thread releases its textures and frees it
+			preload->cancelRequest = true;
+		} else {
+			ReleaseTextures( preload->textures );
+			delete preload;
+		}
+	}
+
+	preload = nullptr;
+}
+
+const bool StateManager::IsPreloadComplete() const
+{
+	if ( preload == nullptr ) {
+		return false;
+	}
+
+	if ( activeTextureManager != nullptr && preload->loadedTextureCount.load( std::memory_order_acquire ) < preload->dependencies.textures.size() ) {
+		return false;
+	}
+
+	if ( activeStreamer != nullptr ) {
+		for ( const stateArea_t& area : preload->dependencies.areas ) {
+			if ( !IsAreaSettled( area ) ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+const bool StateManager::IsAreaSettled( const stateArea_t& area ) const
+{
+	const worldArea_t* worldArea = activeWorld->GetArea( area.x, area.y );
+
+	// a missing area would never show up; the state is entered without it
+	return ( worldArea != nullptr && worldArea->state == AREA_STATE_RESIDENT ) || activeStreamer->IsAreaUnavailable( area.x, area.y );
+}
+
+void StateManager::CompleteTransition()
+{
+	const stateTransitionType_t transition = pendingTransition;
+	pendingTransition = STATE_TRANSITION_NONE;
+
+	if ( transition == STATE_TRANSITION_POP || transition == STATE_TRANSITION_SWITCH ) {
+		if ( !stack.empty() ) {
+			stack.back().state->OnExit( activeWorld );
+			UnpinAreas( stack.back().dependencies );
+			ReleaseTextures( stack.back().textures );
+
+			stack.pop_back();
+		}
+
+		if ( transition == STATE_TRANSITION_POP ) {
+			if ( !stack.empty() ) {
+				stack.back().state->OnResume();
+			}
+
+			return;
+		}
+	} else if ( !stack.empty() ) {
+		stack.back().state->OnSuspend();
+	}
+
+	const uint32_t failureCount = GetPreloadFailureCount();
+
+	if ( failureCount != 0 ) {
+		Log_Printf( "StateManager: entering a state with %u of its %u dependencies missing\n", failureCount, static_cast<uint32_t>( preload->dependencies.areas.size() + preload->dependencies.textures.size() ) );
+	}
+
+	// area pins and texture references are handed over to the stack entry
+	stack.push_back( { preload->state, preload->dependencies, std::move( preload->textures ) } );
+	preload->textures.clear();
+	ReleasePreload( false );
+
+	stack.back().state->OnEnter( activeWorld );
+}
+
+void StateManager::PinAreas( const stateDependencies_t& dependencies )
+{
+	if ( activeStreamer == nullptr ) {
+		return;
+	}
+
+	for ( const stateArea_t& area : dependencies.areas ) {
+		activeStreamer->PinArea( area.x, area.y );
+	}
+}
+
+void StateManager::UnpinAreas( const stateDependencies_t& dependencies )
+{
+	if ( activeStreamer == nullptr ) {
+		return;
+	}
+
+	for ( const stateArea_t& area : dependencies.areas ) {
+		activeStreamer->UnpinArea( area.x, area.y );
+	}
+}
+
+void StateManager::ReleaseTextures( std::vector<texture_t*>& textures )
+{
+	for ( texture_t* texture : textures ) {
+		if ( texture != nullptr ) {
+			activeTextureManager->ReleaseTexture( activeRenderContext, texture );
+		}
+	}
+
+	textures.clear();
+}
@@ -1,2 +1,134 @@
 #pragma once
 
+#include "World.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <string>
+
+struct renderContext_t;
+class TextureManager;
+class AreaStreamer;
+struct texture_t;
+
+struct stateArea_t
+{
+	unsigned char	x;
+	unsigned char	y;
+};
+
+// what a state needs to be resident before it becomes active
+struct stateDependencies_t
+{
+	std::vector<stateArea_t>	areas;		// pinned in the streamer as long as the state is on the stack
+	std::vector<std::string>	textures;	// loaded through the texture manager; referenced as long as the state is on the stack
+};
+
+// a game state (menu, loading screen, in-game, editor, ...)
+// states are owned by the caller and must outlive their stay on the stack
+class GameState
+{
+public:
+	virtual					~GameState() {}
+
+	virtual void			GetDependencies( stateDependencies_t& /*dependencies*/ ) const {}
+
+	virtual void			OnEnter( World* /*world*/ ) {}
+	virtual void			OnExit( World* /*world*/ ) {}
+	virtual void			OnSuspend() {}							// another state has been pushed on top
+	virtual void			OnResume() {}							// the state on top has been popped
+
+	virtual void			Update( const float tickDuration ) = 0;	// fixed tick; only the top state is updated
+};
+
+enum stateTransitionType_t
+{
+	STATE_TRANSITION_NONE = 0,
+	STATE_TRANSITION_PUSH,
+	STATE_TRANSITION_SWITCH,	// pop + push
+	STATE_TRANSITION_POP,
+};
+
+// game state stack
+// the dependencies of the next state are loaded in the background while the current state keeps running;
+// push/switch transitions complete once every dependency is settled: resident, or known to be missing (no blocking load screen)
+class StateManager
+{
+public:
+	inline GameState*	GetActiveState() const			{ return stack.empty() ? nullptr : stack.back().state; }
+	inline std::size_t	GetStateCount() const			{ return stack.size(); }
+	inline const bool	IsTransitionPending() const		{ return pendingTransition != STATE_TRANSITION_NONE; }
+
+public:
+						StateManager();
+						StateManager( StateManager& ) = delete;
+						~StateManager();
+
+	// streamer and texture manager are optional (area/texture dependencies are ignored without them)
+	const int			Initialize( World* world, AreaStreamer* areaStreamer, const renderContext_t* renderContext, TextureManager* textureManager );
+	void				Shutdown();
+
+	// starts loading the dependencies of 'state' ahead of a transition; replaces the previous preload
+	void				Preload( GameState* state );
+	const float			GetPreloadProgress() const; // [0..1]; 1 if nothing is being preloaded
+	const uint32_t		GetPreloadFailureCount() const; // dependencies which will never be resident (missing or unreadable files)
+
+	// transitions are deferred until the next Frame() call (and until the preload is complete for push/switch)
+	void				PushState( GameState* state );
+	void				SwitchState( GameState* state );
+	void				PopState();
+
+	void				Frame();								// main thread, once per frame
+	void				Update( const float tickDuration );		// ticks the active state
+
+private:
+	struct stackEntry_t
+	{
+		GameState*				state;
+		stateDependencies_t		dependencies;
+		std::vector<texture_t*>	textures;			// references taken by the preload; null for failed loads
+	};
+
+	struct preload_t
+	{
+		GameState*				state;
+		stateDependencies_t		dependencies;
+		std::vector<texture_t*>	textures;			// one per dependency; written by the preload thread
+		std::atomic<uint32_t>	loadedTextureCount;	// failed loads are counted too
+		std::atomic<uint32_t>	failedTextureCount;
+		std::atomic<bool>		cancelRequest;
+	};
+
+private:
+	World*						activeWorld;
+	AreaStreamer*				activeStreamer;
+	const renderContext_t*		activeRenderContext;
+	TextureManager*				activeTextureManager;
+
+	std::vector<stackEntry_t>	stack;
+
+	stateTransitionType_t		pendingTransition;
+	preload_t*					preload;			// null if nothing is being preloaded
+
+	// shared with the preload thread
+	std::mutex					queueLock;
+	std::condition_variable		queueCondition;
+	std::vector<preload_t*>		pendingPreloads;
+	preload_t*					loadingPreload;		// freed by the preload thread if cancelled meanwhile
+	bool						isShuttingDown;
+
+	std::thread					preloadThread;
+
+private:
+	void				PreloadThreadLoop();
+	void				ReleasePreload( const bool unpinAreas );
+	const bool			IsPreloadComplete() const;
+	const bool			IsAreaSettled( const stateArea_t& area ) const;
+	void				CompleteTransition();
+	void				PinAreas( const stateDependencies_t& dependencies );
+	void				UnpinAreas( const stateDependencies_t& dependencies );
+	void				ReleaseTextures( std::vector<texture_t*>& textures );
+};
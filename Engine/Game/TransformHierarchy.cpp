@@ -0,0 +1,442 @@
+#include "Shared.h"
+#include "TransformHierarchy.h"
+
+#include <Engine/System/JobSystem.h>
+
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr uint32_t DENSE_INDEX_INVALID = ~0u;
+}
+
+TransformHierarchy::TransformHierarchy()
+	: levelCount( 0 )
+	, deadNodeCount( 0 )
+	, updatedCount( 0 )
+	, isLayoutDirty( false )
+{
+
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+
+}
+
+transformHandle_t TransformHierarchy::Allocate( const transformHandle_t parent )
+{
+	if ( parent != TRANSFORM_HANDLE_INVALID && !IsValid( parent ) ) {
+		return TRANSFORM_HANDLE_INVALID;
+	}
+
+	transformHandle_t handle = TRANSFORM_HANDLE_INVALID;
+
+	if ( !freeHandles.empty() ) {
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+	} else {
+		handle = static_cast<transformHandle_t>( handleToDense.size() );
+
+		handleToDense.push_back( DENSE_INDEX_INVALID );
+		parents.push_back( TRANSFORM_HANDLE_INVALID );
+		firstChildren.push_back( TRANSFORM_HANDLE_INVALID );
+		nextSiblings.push_back( TRANSFORM_HANDLE_INVALID );
+	}
+
+	// appended at the end for now; moved to its breadth first slot on the next update
+	const uint32_t denseIndex = static_cast<uint32_t>( denseHandles.size() );
+
+	denseHandles.push_back( handle );
+	denseParents.push_back( DENSE_INDEX_INVALID );
+	childBegin.push_back( 0 );
+	childEnd.push_back( 0 );
+	depths.push_back( 0 );
+	dirtyStates.push_back( DIRTY_STATE_CLEAN );
+	localTranslations.push_back( XMFLOAT3( 0.0f, 0.0f, 0.0f ) );
+	localRotations.push_back( XMFLOAT4( 0.0f, 0.0f, 0.0f, 1.0f ) );
+	localScales.push_back( XMFLOAT3( 1.0f, 1.0f, 1.0f ) );
+	localBounds.push_back( BoundingSphere( XMFLOAT3( 0.0f, 0.0f, 0.0f ), 0.0f ) );
+	worldMatrices.push_back( XMMatrixIdentity() );
+	worldBounds.push_back( BoundingSphere( XMFLOAT3( 0.0f, 0.0f, 0.0f ), 0.0f ) );
+	worldMatrixOutputs.push_back( nullptr );
+
+	handleToDense[handle]	= denseIndex;
+	parents[handle]			= parent;
+	firstChildren[handle]	= TRANSFORM_HANDLE_INVALID;
+	nextSiblings[handle]	= TRANSFORM_HANDLE_INVALID;
+
+	if ( parent != TRANSFORM_HANDLE_INVALID ) {
+		nextSiblings[handle]	= firstChildren[parent];
+		firstChildren[parent]	= handle;
+	}
+
+	isLayoutDirty = true;
+	MarkDirty( denseIndex );
+
+	return handle;
+}
+
+void TransformHierarchy::Free( const transformHandle_t handle )
+{
+	if ( !IsValid( handle ) ) {
+		return;
+	}
+
+	Unlink( handle );
+
+	// release the subtree (children first; Free unlinks them from 'handle')
+	while ( firstChildren[handle] != TRANSFORM_HANDLE_INVALID ) {
+		Free( firstChildren[handle] );
+	}
+
+	const uint32_t denseIndex = handleToDense[handle];
+
+	denseHandles[denseIndex]		= TRANSFORM_HANDLE_INVALID;
+	worldMatrixOutputs[denseIndex]	= nullptr;
+
+	handleToDense[handle]	= DENSE_INDEX_INVALID;
+	parents[handle]			= TRANSFORM_HANDLE_INVALID;
+
+	freeHandles.push_back( handle );
+
+	deadNodeCount++;
+	isLayoutDirty = true;
+}
+
+void TransformHierarchy::SetParent( const transformHandle_t handle, const transformHandle_t parent )
+{
+	if ( !IsValid( handle ) || parent == handle || parents[handle] == parent ) {
+		return;
+	}
+
+	if ( parent != TRANSFORM_HANDLE_INVALID ) {
+		if ( !IsValid( parent ) ) {
+			return;
+		}
+
+		// refuse to create a cycle (parent is part of handle subtree)
+		for ( transformHandle_t ancestor = parents[parent]; ancestor != TRANSFORM_HANDLE_INVALID; ancestor = parents[ancestor] ) {
+			if ( ancestor == handle ) {
+				return;
+			}
+		}
+	}
+
+	Unlink( handle );
+
+	parents[handle] = parent;
+
+	if ( parent != TRANSFORM_HANDLE_INVALID ) {
+		nextSiblings[handle]	= firstChildren[parent];
+		firstChildren[parent]	= handle;
+	}
+
+	isLayoutDirty = true;
+	MarkDirty( handleToDense[handle] );
+}
+
+const bool TransformHierarchy::IsValid( const transformHandle_t handle ) const
+{
+	return handle < handleToDense.size() && handleToDense[handle] != DENSE_INDEX_INVALID;
+}
+
+void TransformHierarchy::SetLocalTransform( const transformHandle_t handle, const XMFLOAT3& translation, const XMFLOAT4& rotation, const XMFLOAT3& scale )
+{
+	if ( !IsValid( handle ) ) {
+		return;
+	}
+
+	const uint32_t denseIndex = handleToDense[handle];
+
+	localTranslations[denseIndex]	= translation;
+	localRotations[denseIndex]		= rotation;
+	localScales[denseIndex]			= scale;
+
+	MarkDirty( denseIndex );
+}
+
+void TransformHierarchy::SetLocalMatrix( const transformHandle_t handle, const XMMATRIX& matrix )
+{
+	if ( !IsValid( handle ) ) {
+		return;
+	}
+
+	XMVECTOR scale = {}, rotation = {}, translation = {};
+
+	if ( !XMMatrixDecompose( &scale, &rotation, &translation, matrix ) ) {
+		return;
+	}
+
+	const uint32_t denseIndex = handleToDense[handle];
+
+	XMStoreFloat3( &localTranslations[denseIndex], translation );
+	XMStoreFloat4( &localRotations[denseIndex], rotation );
+	XMStoreFloat3( &localScales[denseIndex], scale );
+
+	MarkDirty( denseIndex );
+}
+
+void TransformHierarchy::SetWorldMatrix( const transformHandle_t handle, const XMMATRIX& matrix )
+{
+	if ( !IsValid( handle ) ) {
+		return;
+	}
+
+	const transformHandle_t parent = parents[handle];
+
+	if ( parent == TRANSFORM_HANDLE_INVALID ) {
+		SetLocalMatrix( handle, matrix );
+		return;
+	}
+
+	const XMMATRIX inverseParentWorld = XMMatrixInverse( nullptr, worldMatrices[handleToDense[parent]] );
+	SetLocalMatrix( handle, XMMatrixMultiply( matrix, inverseParentWorld ) );
+}
+
+void TransformHierarchy::SetLocalBounds( const transformHandle_t handle, const BoundingSphere& bounds )
+{
+	if ( !IsValid( handle ) ) {
+		return;
+	}
+
+	const uint32_t denseIndex = handleToDense[handle];
+
+	localBounds[denseIndex] = bounds;
+	MarkDirty( denseIndex );
+}
+
+void TransformHierarchy::BindWorldMatrixOutput( const transformHandle_t handle, XMMATRIX* output )
+{
+	if ( !IsValid( handle ) ) {
+		return;
+	}
+
+	const uint32_t denseIndex = handleToDense[handle];
+
+	worldMatrixOutputs[denseIndex] = output;
+	MarkDirty( denseIndex );
+}
+
+const XMMATRIX& TransformHierarchy::GetWorldMatrix( const transformHandle_t handle ) const
+{
+	return worldMatrices[handleToDense[handle]];
+}
+
+const BoundingSphere& TransformHierarchy::GetWorldBounds( const transformHandle_t handle ) const
+{
+	return worldBounds[handleToDense[handle]];
+}
+
+void TransformHierarchy::Update()
+{
+	updatedCount = 0;
+
+	if ( isLayoutDirty ) {
+		RebuildLayout();
+	}
+
+	if ( dirtyNodes.empty() ) {
+		return;
+	}
+
+	if ( levels.size() < levelCount ) {
+		levels.resize( levelCount );
+	}
+
+	// bucket explicitly dirty nodes per depth
+	for ( const transformHandle_t handle : dirtyNodes ) {
+		if ( !IsValid( handle ) ) {
+			continue; // freed after being marked
+		}
+
+		const uint32_t denseIndex = handleToDense[handle];
+
+		// a recycled handle might have been pushed twice
+		if ( dirtyStates[denseIndex] != DIRTY_STATE_MARKED ) {
+			continue;
+		}
+
+		dirtyStates[denseIndex] = DIRTY_STATE_QUEUED;
+		levels[depths[denseIndex]].push_back( denseIndex );
+	}
+
+	dirtyNodes.clear();
+
+	// a level only depends on the previous one; nodes of a same level can be updated in any order (or concurrently)
+	for ( std::size_t level = 0; level < levelCount; ++level ) {
+		std::vector<uint32_t>& workList = levels[level];
+
+		if ( workList.empty() ) {
+			continue;
+		}
+
+		// keep memory accesses (mostly) linear
+		std::sort( workList.begin(), workList.end() );
+
+		UpdateLevel( workList.data(), workList.size() );
+
+		const bool hasNextLevel = ( level + 1 < levelCount );
+
+		for ( const uint32_t denseIndex : workList ) {
+			if ( hasNextLevel ) {
+				for ( uint32_t child = childBegin[denseIndex]; child < childEnd[denseIndex]; ++child ) {
+					if ( dirtyStates[child] == DIRTY_STATE_CLEAN ) {
+						dirtyStates[child] = DIRTY_STATE_QUEUED;
+						levels[level + 1].push_back( child );
+					}
+				}
+			}
+
+			dirtyStates[denseIndex] = DIRTY_STATE_CLEAN;
+		}
+
+		updatedCount += workList.size();
+		workList.clear();
+	}
+}
+
+void TransformHierarchy::MarkDirty( const uint32_t denseIndex )
+{
+	if ( dirtyStates[denseIndex] != DIRTY_STATE_CLEAN ) {
+		return;
+	}
+
+	dirtyStates[denseIndex] = DIRTY_STATE_MARKED;
+	dirtyNodes.push_back( denseHandles[denseIndex] );
+}
+
+void TransformHierarchy::Unlink( const transformHandle_t handle )
+{
+	const transformHandle_t parent = parents[handle];
+
+	if ( parent == TRANSFORM_HANDLE_INVALID ) {
+		return;
+	}
+
+	transformHandle_t* link = &firstChildren[parent];
+
+	while ( *link != TRANSFORM_HANDLE_INVALID && *link != handle ) {
+		link = &nextSiblings[*link];
+	}
+
+	if ( *link == handle ) {
+		*link = nextSiblings[handle];
+	}
+
+	nextSiblings[handle]	= TRANSFORM_HANDLE_INVALID;
+	parents[handle]			= TRANSFORM_HANDLE_INVALID;
+}
+
+void TransformHierarchy::RebuildLayout()
+{
+	const std::size_t liveNodeCount = denseHandles.size() - deadNodeCount;
+
+	// breadth first traversal; roots first (in handle order), then each node children
+	std::vector<transformHandle_t> order;
+	order.reserve( liveNodeCount );
+
+	for ( transformHandle_t handle = 0; handle < handleToDense.size(); ++handle ) {
+		if ( handleToDense[handle] != DENSE_INDEX_INVALID && parents[handle] == TRANSFORM_HANDLE_INVALID ) {
+			order.push_back( handle );
+		}
+	}
+
+	std::vector<uint32_t>	newParents( liveNodeCount, DENSE_INDEX_INVALID ),
+							newChildBegin( liveNodeCount, 0 ),
+							newChildEnd( liveNodeCount, 0 );
+	std::vector<uint16_t>	newDepths( liveNodeCount, 0 );
+
+	uint16_t maxDepth = 0;
+
+	for ( std::size_t i = 0; i < order.size(); ++i ) {
+		const transformHandle_t handle = order[i];
+
+		newChildBegin[i] = static_cast<uint32_t>( order.size() );
+
+		for ( transformHandle_t child = firstChildren[handle]; child != TRANSFORM_HANDLE_INVALID; child = nextSiblings[child] ) {
+			const std::size_t childIndex = order.size();
+
+			newParents[childIndex]	= static_cast<uint32_t>( i );
+			newDepths[childIndex]	= newDepths[i] + 1;
+			maxDepth				= std::max( maxDepth, newDepths[childIndex] );
+
+			order.push_back( child );
+		}
+
+		newChildEnd[i] = static_cast<uint32_t>( order.size() );
+	}
+
+	// permute per node data
+	std::vector<uint8_t>			newDirtyStates( liveNodeCount );
+	std::vector<XMFLOAT3>			newTranslations( liveNodeCount ), newScales( liveNodeCount );
+	std::vector<XMFLOAT4>			newRotations( liveNodeCount );
+	std::vector<BoundingSphere>		newLocalBounds( liveNodeCount ), newWorldBounds( liveNodeCount );
+	std::vector<XMMATRIX>			newWorldMatrices( liveNodeCount );
+	std::vector<XMMATRIX*>			newOutputs( liveNodeCount );
+
+	for ( std::size_t i = 0; i < order.size(); ++i ) {
+		const uint32_t oldIndex = handleToDense[order[i]];
+
+		newDirtyStates[i]	= dirtyStates[oldIndex];
+		newTranslations[i]	= localTranslations[oldIndex];
+		newRotations[i]		= localRotations[oldIndex];
+		newScales[i]		= localScales[oldIndex];
+		newLocalBounds[i]	= localBounds[oldIndex];
+		newWorldMatrices[i] = worldMatrices[oldIndex];
+		newWorldBounds[i]	= worldBounds[oldIndex];
+		newOutputs[i]		= worldMatrixOutputs[oldIndex];
+	}
+
+	for ( std::size_t i = 0; i < order.size(); ++i ) {
+		handleToDense[order[i]] = static_cast<uint32_t>( i );
+	}
+
+	denseHandles.swap( order );
+	denseParents.swap( newParents );
+	childBegin.swap( newChildBegin );
+	childEnd.swap( newChildEnd );
+	depths.swap( newDepths );
+	dirtyStates.swap( newDirtyStates );
+	localTranslations.swap( newTranslations );
+	localRotations.swap( newRotations );
+	localScales.swap( newScales );
+	localBounds.swap( newLocalBounds );
+	worldMatrices.swap( newWorldMatrices );
+	worldBounds.swap( newWorldBounds );
+	worldMatrixOutputs.swap( newOutputs );
+
+	levelCount		= ( liveNodeCount == 0 ) ? 0 : ( static_cast<std::size_t>( maxDepth ) + 1 );
+	deadNodeCount	= 0;
+	isLayoutDirty	= false;
+}
+
+void TransformHierarchy::UpdateLevel( const uint32_t* indices, const std::size_t indiceCount )
+{
+	// nodes of a level never write to each other; split the level in contiguous batches
+	Job_ParallelFor( 0, static_cast<uint32_t>( indiceCount ), PARALLEL_BATCH_SIZE, [this, indices]( const uint32_t begin, const uint32_t end ) {
+		UpdateNodes( indices + begin, end - begin );
+	} );
+}
+
+void TransformHierarchy::UpdateNodes( const uint32_t* indices, const std::size_t indiceCount )
+{
+	for ( std::size_t i = 0; i < indiceCount; ++i ) {
+		const uint32_t denseIndex = indices[i];
+
+		const XMMATRIX localMatrix = XMMatrixScalingFromVector( XMLoadFloat3( &localScales[denseIndex] ) )
+								   * XMMatrixRotationQuaternion( XMLoadFloat4( &localRotations[denseIndex] ) )
+								   * XMMatrixTranslationFromVector( XMLoadFloat3( &localTranslations[denseIndex] ) );
+
+		const uint32_t parentIndex = denseParents[denseIndex];
+
+		worldMatrices[denseIndex] = ( parentIndex == DENSE_INDEX_INVALID ) ? localMatrix : XMMatrixMultiply( localMatrix, worldMatrices[parentIndex] );
+		localBounds[denseIndex].Transform( worldBounds[denseIndex], worldMatrices[denseIndex] );
+
+		if ( worldMatrixOutputs[denseIndex] != nullptr ) {
+			*worldMatrixOutputs[denseIndex] = worldMatrices[denseIndex];
+		}
+	}
+}
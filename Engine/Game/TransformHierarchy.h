@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
+
+#include <vector>
+
+using transformHandle_t = uint32_t;
+
+static constexpr transformHandle_t TRANSFORM_HANDLE_INVALID = ~0u;
+
+// local TRS + world matrix/bounds for every node of a world area
+// nodes are stored breadth first (SoA) so that a parent is always updated before its children, and children of a node are contiguous
+// only nodes flagged as dirty (and their subtrees) are recomputed during Update
+class TransformHierarchy
+{
+public:
+	inline std::size_t	GetNodeCount() const		{ return denseHandles.size() - deadNodeCount; }
+	inline std::size_t	GetUpdatedCount() const		{ return updatedCount; }
+
+public:
+							TransformHierarchy();
+							TransformHierarchy( TransformHierarchy& ) = delete;
+							~TransformHierarchy();
+
+	transformHandle_t		Allocate( const transformHandle_t parent = TRANSFORM_HANDLE_INVALID );
+	void					Free( const transformHandle_t handle ); // frees the whole subtree
+	void					SetParent( const transformHandle_t handle, const transformHandle_t parent );
+	const bool				IsValid( const transformHandle_t handle ) const;
+
+	void					SetLocalTransform( const transformHandle_t handle, const DirectX::XMFLOAT3& translation, const DirectX::XMFLOAT4& rotation, const DirectX::XMFLOAT3& scale );
+	void					SetLocalMatrix( const transformHandle_t handle, const DirectX::XMMATRIX& matrix );
+	void					SetWorldMatrix( const transformHandle_t handle, const DirectX::XMMATRIX& matrix ); // relative to the parent world matrix (as of the last update)
+	void					SetLocalBounds( const transformHandle_t handle, const DirectX::BoundingSphere& bounds );
+
+	// the world matrix is copied to 'output' each time the node is updated (e.g. mesh_t transformation); null to unbind
+	void					BindWorldMatrixOutput( const transformHandle_t handle, DirectX::XMMATRIX* output );
+
+	const DirectX::XMMATRIX&		GetWorldMatrix( const transformHandle_t handle ) const;
+	const DirectX::BoundingSphere&	GetWorldBounds( const transformHandle_t handle ) const;
+
+	void					Update();
+
+private:
+	static constexpr uint32_t	PARALLEL_BATCH_SIZE = 2048; // nodes per job (levels smaller than this are updated on the calling thread)
+
+	enum dirtyState_t : uint8_t
+	{
+		DIRTY_STATE_CLEAN = 0,
+		DIRTY_STATE_MARKED,		// waiting for the next update
+		DIRTY_STATE_QUEUED,		// in a level work list
+	};
+
+	// sparse (per handle)
+	std::vector<uint32_t>				handleToDense;
+	std::vector<transformHandle_t>		parents;
+	std::vector<transformHandle_t>		firstChildren;
+	std::vector<transformHandle_t>		nextSiblings;
+	std::vector<transformHandle_t>		freeHandles;
+
+	// dense (breadth first order once the layout is rebuilt)
+	std::vector<transformHandle_t>		denseHandles;	// TRANSFORM_HANDLE_INVALID for dead nodes
+	std::vector<uint32_t>				denseParents;
+	std::vector<uint32_t>				childBegin;
+	std::vector<uint32_t>				childEnd;
+	std::vector<uint16_t>				depths;
+	std::vector<uint8_t>				dirtyStates;
+	std::vector<DirectX::XMFLOAT3>		localTranslations;
+	std::vector<DirectX::XMFLOAT4>		localRotations;
+	std::vector<DirectX::XMFLOAT3>		localScales;
+	std::vector<DirectX::BoundingSphere> localBounds;
+	std::vector<DirectX::XMMATRIX>		worldMatrices;
+	std::vector<DirectX::BoundingSphere> worldBounds;
+	std::vector<DirectX::XMMATRIX*>		worldMatrixOutputs;
+
+	std::vector<transformHandle_t>		dirtyNodes;
+	std::vector<std::vector<uint32_t>>	levels;			// per depth work lists (reused between updates)
+	std::size_t							levelCount;
+	std::size_t							deadNodeCount;
+	std::size_t							updatedCount;
+	bool								isLayoutDirty;
+
+private:
+	void					MarkDirty( const uint32_t denseIndex );
+	void					Unlink( const transformHandle_t handle );
+	void					RebuildLayout();
+	void					UpdateLevel( const uint32_t* indices, const std::size_t indiceCount );
+	void					UpdateNodes( const uint32_t* indices, const std::size_t indiceCount );
+};
@@ -2,16 +2,151 @@
 #include "World.h"
 
 #include <Engine/System/MurmurHash2_64.h>
+#include <Engine/Graphics/Mesh.h>
+#include <Engine/Graphics/LightManager.h>
+
+#include <algorithm>
+
+namespace
+{
+	// pooled size of a node content (see worldArea_t::memoryUsage)
+	uint64_t GetContentSize( const uint64_t flags )
+	{
+		if ( flags & NODE_FLAG_CONTENT_MESH ) {
+			return sizeof( mesh_t ) + sizeof( transform_t );
+		} else if ( flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
+			return sizeof( sphereAreaLight_t );
+		} else if ( flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
+			return sizeof( diskAreaLight_t );
+		} else if ( flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
+			return sizeof( rectangleAreaLight_t );
+		} else if ( flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
+			return sizeof( sunLight_t );
+		} else if ( flags & NODE_FLAG_CONTENT_ACTOR ) {
+			return sizeof( actor_t );
+		}
+
+		return 0;
+	}
+
+	void FreeAreaContent( worldArea_t* area, EntityManager* entityManager, void* content, const uint64_t flags )
+	{
+		if ( content == nullptr ) {
+			return;
+		}
+
+		areaPools_t& pools = area->pools;
+		area->memoryUsage -= GetContentSize( flags );
+
+		if ( flags & NODE_FLAG_CONTENT_MESH ) {
+			mesh_t* mesh = static_cast<mesh_t*>( content );
+
+			pools.meshTransforms.Free( mesh->transformation );
+			pools.meshes.Free( mesh );
+		} else if ( flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
+			pools.sphereLights.Free( static_cast<sphereAreaLight_t*>( content ) );
+		} else if ( flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
+			pools.diskLights.Free( static_cast<diskAreaLight_t*>( content ) );
+		} else if ( flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
+			pools.rectangleLights.Free( static_cast<rectangleAreaLight_t*>( content ) );
+		} else if ( flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
+			pools.sunLights.Free( static_cast<sunLight_t*>( content ) );
+		} else if ( flags & NODE_FLAG_CONTENT_ACTOR ) {
+			actor_t* actor = static_cast<actor_t*>( content );
+
+			entityManager->DestroyEntity( actor->entity );
+			pools.actors.Free( actor );
+		}
+	}
+
+	void ReleaseNode( worldArea_t* area, EntityManager* entityManager, areaNode_t* node )
+	{
+		for ( areaNode_t* child : node->children ) {
+			ReleaseNode( area, entityManager, child );
+		}
+
+		FreeAreaContent( area, entityManager, node->content, node->flags );
+		area->pools.nodes.Free( node );
+		area->memoryUsage -= sizeof( areaNode_t );
+	}
+}
+
+worldArea_t::worldArea_t()
+	: nodes( nullptr )
+	, xIndice( 0 )
+	, yIndice( 0 )
+	, state( AREA_STATE_UNLOADED )
+	, memoryUsage( sizeof( worldArea_t ) + sizeof( areaNode_t ) ) // root node
+	, refCount( 0 )
+{
+	nodes = pools.nodes.Allocate(); // populate the world with at least one node
+}
+
+worldArea_t::~worldArea_t()
+{
+	// pools release nodes and content in bulk
+	nodes = nullptr;
+}
 
 World::World()
 	: currentArea( nullptr )
+	, areas( nullptr )
+	, gridWidth( 0 )
+	, gridHeight( 0 )
 {
 
 }
 
+World::~World()
+{
+	for ( worldArea_t* area : residentAreas ) {
+		ReleaseActors( area );
+		DestroyArea( area );
+	}
+
+	for ( worldArea_t* area : evictedAreas ) {
+		ReleaseActors( area );
+		DestroyArea( area );
+	}
+
+	if ( areas != nullptr ) {
+		for ( int x = 0; x < gridWidth; ++x ) {
+			delete[] areas[x];
+		}
+
+		delete[] areas;
+	}
+
+	residentAreas.clear();
+	evictedAreas.clear();
+}
+
 void World::CreateEmptyArea()
 {
 	currentArea = new worldArea_t();
+	currentArea->state = AREA_STATE_RESIDENT;
+
+	residentAreas.push_back( currentArea );
+
+	if ( areas != nullptr && areas[0][0] == nullptr ) {
+		areas[0][0] = currentArea;
+	}
+}
+
+void World::CreateGrid( const unsigned char width, const unsigned char height )
+{
+	if ( areas != nullptr || width == 0 || height == 0 ) {
+		return;
+	}
+
+	gridWidth	= width;
+	gridHeight	= height;
+
+	areas = new worldArea_t**[gridWidth];
+
+	for ( int x = 0; x < gridWidth; ++x ) {
+		areas[x] = new worldArea_t*[gridHeight]();
+	}
 }
 
 void World::LoadAreaFromFile( const char* fileName )
@@ -19,36 +154,250 @@ void World::LoadAreaFromFile( const char* fileName )
 
 }
 
-areaNode_t* World::InsertNode( void* content, const uint64_t flags, const areaNode_t* parent )
+void* World::AllocateContent( const uint64_t flags )
+{
+	if ( currentArea == nullptr ) {
+		return nullptr;
+	}
+
+	if ( !( flags & NODE_FLAG_CONTENT_ACTOR ) ) {
+		return AllocateAreaContent( currentArea, flags );
+	}
+
+	currentArea->memoryUsage += GetContentSize( flags );
+
+	actor_t* actor = currentArea->pools.actors.Allocate();
+	actor->entity = entityManager.CreateEntity( Ecs_ComponentMask<actorTransform_t, actorPreviousTransform_t, actorNode_t>() );
+
+	actorTransform_t* transform = entityManager.GetComponent<actorTransform_t>( actor->entity );
+	transform->rotation	= DirectX::XMFLOAT4( 0.0f, 0.0f, 0.0f, 1.0f );
+	transform->scale	= DirectX::XMFLOAT3( 1.0f, 1.0f, 1.0f );
+	transform->isDirty	= 1;
+
+	actorNode_t* node = entityManager.GetComponent<actorNode_t>( actor->entity );
+	node->area		= currentArea;
+	node->transform	= TRANSFORM_HANDLE_INVALID; // bound on insert
+
+	return actor;
+}
+
+void World::FreeContent( void* content, const uint64_t flags )
+{
+	if ( currentArea == nullptr ) {
+		return;
+	}
+
+	FreeAreaContent( currentArea, &entityManager, content, flags );
+}
+
+areaNode_t* World::InsertNode( void* content, const uint64_t flags, areaNode_t* parent )
 {
 	if ( currentArea == nullptr || currentArea->nodes == nullptr || content == nullptr ) {
 		return nullptr;
 	}
 
+	if ( parent == nullptr ) {
+		parent = currentArea->nodes;
+	}
+
     const nodeHash hashKey = *static_cast<uint64_t*>( content ) ^ flags;
 
-	if ( parent == nullptr ) {
-		areaNode_t* newNode = new areaNode_t();
-		newNode->content	= content;
-        newNode->hash    = MurmurHash64A( &hashKey, sizeof( nodeHash ), 0xB );
-		newNode->flags	= flags;
-		newNode->parent	= currentArea->nodes;
+	areaNode_t* newNode = AllocateNode( currentArea, parent );
+	newNode->content	= content;
+    newNode->hash    = MurmurHash64A( &hashKey, sizeof( nodeHash ), 0xB );
+	newNode->flags	= flags;
 
-		currentArea->nodes->children.push_back( newNode );
+	if ( flags & NODE_FLAG_CONTENT_MESH ) {
+		transform_t* meshTransform = static_cast<mesh_t*>( content )->transformation;
 
-		return newNode;
-	}
+		currentArea->transforms.SetWorldMatrix( newNode->transform, meshTransform->modelMatrix );
+		currentArea->transforms.SetLocalBounds( newNode->transform, meshTransform->boundingSphere );
+		currentArea->transforms.BindWorldMatrixOutput( newNode->transform, &meshTransform->modelMatrix );
+	} else if ( flags & NODE_FLAG_CONTENT_ACTOR ) {
+		actorNode_t* actorNode = entityManager.GetComponent<actorNode_t>( static_cast<actor_t*>( content )->entity );
 
+		if ( actorNode != nullptr ) {
+			actorNode->transform = newNode->transform;
+		}
+	}
 
-	return nullptr;
+	return newNode;
 }
 
 void World::RemoveNode( nodeHash hash ) 
 {
     for ( auto it = currentArea->nodes->children.begin(); it != currentArea->nodes->children.end(); it++ ) {
         if ( ( *it )->hash == hash ) {
+			areaNode_t* node = *it;
+
            currentArea->nodes->children.erase( it );
+
+			currentArea->transforms.Free( node->transform );
+			ReleaseNode( currentArea, &entityManager, node );
             return;
         }
     }
 }
+
+void World::SetNodeWorldMatrix( const areaNode_t* node, const DirectX::XMMATRIX& worldMatrix )
+{
+	if ( currentArea == nullptr || node == nullptr ) {
+		return;
+	}
+
+	currentArea->transforms.SetWorldMatrix( node->transform, worldMatrix );
+}
+
+void World::UpdateTransforms()
+{
+	for ( worldArea_t* area : residentAreas ) {
+		area->transforms.Update();
+	}
+}
+
+void World::PublishArea( worldArea_t* area )
+{
+	if ( area == nullptr || areas == nullptr || area->xIndice >= gridWidth || area->yIndice >= gridHeight ) {
+		DestroyArea( area );
+		return;
+	}
+
+	worldArea_t*& slot = areas[area->xIndice][area->yIndice];
+
+	// should not happen (the streamer never requests a resident area twice); keep the resident one
+	if ( slot != nullptr ) {
+		DestroyArea( area );
+		return;
+	}
+
+	area->state = AREA_STATE_RESIDENT;
+	slot = area;
+
+	residentAreas.push_back( area );
+}
+
+void World::EvictArea( const unsigned char x, const unsigned char y )
+{
+	worldArea_t* area = GetArea( x, y );
+
+	if ( area == nullptr || area == currentArea ) {
+		return;
+	}
+
+	areas[x][y] = nullptr;
+
+	residentAreas.erase( std::remove( residentAreas.begin(), residentAreas.end(), area ), residentAreas.end() );
+
+	// the area might still be in use by someone (renderer, editor, ...); defer its destruction
+	area->state = AREA_STATE_PENDING_UNLOAD;
+	evictedAreas.push_back( area );
+}
+
+void World::SetActiveArea( const unsigned char x, const unsigned char y )
+{
+	worldArea_t* area = GetArea( x, y );
+
+	if ( area != nullptr ) {
+		currentArea = area;
+	}
+}
+
+void World::CollectEvictedAreas()
+{
+	auto it = evictedAreas.begin();
+
+	while ( it != evictedAreas.end() ) {
+		if ( ( *it )->refCount.load( std::memory_order_acquire ) <= 0 ) {
+			if ( areaReleaseCallback ) {
+				areaReleaseCallback( *it );
+			}
+
+			ReleaseActors( *it );
+			DestroyArea( *it );
+			it = evictedAreas.erase( it );
+		} else {
+			++it;
+		}
+	}
+}
+
+uint64_t World::GetMemoryUsage() const
+{
+	uint64_t memoryUsage = 0;
+
+	for ( const worldArea_t* area : residentAreas ) {
+		memoryUsage += area->memoryUsage;
+	}
+
+	// evicted areas are still in memory until they get collected
+	for ( const worldArea_t* area : evictedAreas ) {
+		memoryUsage += area->memoryUsage;
+	}
+
+	return memoryUsage;
+}
+
+void World::AcquireArea( const worldArea_t* area )
+{
+	if ( area != nullptr ) {
+		const_cast<worldArea_t*>( area )->refCount.fetch_add( 1, std::memory_order_relaxed );
+	}
+}
+
+void World::ReleaseArea( const worldArea_t* area )
+{
+	if ( area != nullptr ) {
+		const_cast<worldArea_t*>( area )->refCount.fetch_sub( 1, std::memory_order_release );
+	}
+}
+
+void* World::AllocateAreaContent( worldArea_t* area, const uint64_t flags )
+{
+	areaPools_t& pools = area->pools;
+	area->memoryUsage += GetContentSize( flags );
+
+	if ( flags & NODE_FLAG_CONTENT_MESH ) {
+		mesh_t* mesh = pools.meshes.Allocate();
+		mesh->transformation = pools.meshTransforms.Allocate();
+		mesh->transformation->modelMatrix = DirectX::XMMatrixIdentity();
+
+		return mesh;
+	} else if ( flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
+		return pools.sphereLights.Allocate();
+	} else if ( flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
+		return pools.diskLights.Allocate();
+	} else if ( flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
+		return pools.rectangleLights.Allocate();
+	} else if ( flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
+		return pools.sunLights.Allocate();
+	}
+
+	return nullptr;
+}
+
+areaNode_t* World::AllocateNode( worldArea_t* area, areaNode_t* parent )
+{
+	areaNode_t* node = area->pools.nodes.Allocate();
+	node->parent	= parent;
+	area->memoryUsage += sizeof( areaNode_t );
+	node->transform	= area->transforms.Allocate( ( parent != nullptr ) ? parent->transform : TRANSFORM_HANDLE_INVALID );
+
+	if ( parent != nullptr ) {
+		parent->children.push_back( node );
+	}
+
+	return node;
+}
+
+void World::ReleaseActors( worldArea_t* area )
+{
+	// entities live outside of the area pools
+	area->pools.actors.ForEach( [this]( actor_t* actor ) {
+		entityManager.DestroyEntity( actor->entity );
+	} );
+}
+
+void World::DestroyArea( worldArea_t* area )
+{
+	delete area;
+}
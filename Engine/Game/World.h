@@ -1,8 +1,20 @@
 #pragma once
 
+#include "TransformHierarchy.h"
+#include "Actor.h"
+
+#include <Engine/System/PoolAllocator.h>
+
 #include <vector>
+#include <atomic>
+#include <functional>
 
 struct mesh_t;
+struct transform_t;
+struct sphereAreaLight_t;
+struct diskAreaLight_t;
+struct rectangleAreaLight_t;
+struct sunLight_t;
 
 enum areaNodeFlag_t
 {
@@ -28,6 +40,7 @@ struct areaNode_t
         , hash( 0 )
 		, flags( NODE_FLAG_EMPTY_NODE )
 		, parent( nullptr )
+		, transform( TRANSFORM_HANDLE_INVALID )
         , name( "???" )
 	{
 
@@ -37,44 +50,115 @@ struct areaNode_t
     nodeHash                    hash;       // random hash assigned during world insert; equals 0 if unset and/or bad node
 	uint64_t					flags;		// 0-7 : content bits
 	areaNode_t*					parent;		// null if none
+	transformHandle_t			transform;	// see worldArea_t::transforms; invalid for the area root
     char						name[128];
 	std::vector<areaNode_t*>	children;	// null if none
 };
 
+enum areaState_t
+{
+	AREA_STATE_UNLOADED			= 0,
+	AREA_STATE_LOADING,						// queued or being read by the streaming thread
+	AREA_STATE_RESIDENT,
+	AREA_STATE_PENDING_UNLOAD,				// evicted; freed once nobody references it anymore
+};
+
+// per area storage for nodes and their content; released in one shot with the area
+struct areaPools_t
+{
+	PoolAllocator<areaNode_t>			nodes;
+	PoolAllocator<mesh_t>				meshes;
+	PoolAllocator<transform_t>			meshTransforms;
+	PoolAllocator<sphereAreaLight_t>	sphereLights;
+	PoolAllocator<diskAreaLight_t>		diskLights;
+	PoolAllocator<rectangleAreaLight_t>	rectangleLights;
+	PoolAllocator<sunLight_t>			sunLights;
+	PoolAllocator<actor_t>				actors;
+};
+
 // a area is a piece of the world
 struct worldArea_t
 {
-	worldArea_t()
-	{
-		nodes = new areaNode_t(); // populate the world with at least one node
-	}
-
-	areaNode_t*		nodes;
-	unsigned char	xIndice;
-	unsigned char	yIndice;
+						worldArea_t();
+						worldArea_t( worldArea_t& ) = delete;
+						~worldArea_t();
+
+	areaNode_t*			nodes;
+	unsigned char		xIndice;
+	unsigned char		yIndice;
+	areaState_t			state;
+	uint64_t			memoryUsage;	// estimated size in bytes (nodes + content)
+	std::atomic<int>	refCount;		// external references (renderer, editor, ...); an area can't be freed while > 0
+	TransformHierarchy	transforms;		// node transforms (mirrors the node tree)
+	areaPools_t			pools;			// owns nodes and content (see World::AllocateContent)
 };
 
 // aka scenemanager, worldmanager or any fancy name you could think of
 class World
 {
 public:
-	const worldArea_t*	GetActiveArea() const { return currentArea; }
+	const worldArea_t*					GetActiveArea() const				{ return currentArea; }
+	const std::vector<worldArea_t*>&	GetResidentAreas() const			{ return residentAreas; }
+	unsigned char						GetGridWidth() const				{ return gridWidth; }
+	unsigned char						GetGridHeight() const				{ return gridHeight; }
+	EntityManager*						GetEntityManager()					{ return &entityManager; }
+
+	worldArea_t*						GetArea( const unsigned char x, const unsigned char y ) const
+	{
+		return ( areas != nullptr && x < gridWidth && y < gridHeight ) ? areas[x][y] : nullptr;
+	}
 
 public:
 					World();
-					World( World& )	= default;
-					~World()		= default;
+					World( World& )	= delete;
+					~World();
 
 	void			CreateEmptyArea();
+	void			CreateGrid( const unsigned char width, const unsigned char height );
 
 	void			LoadWorldFromFile( const char* fileName ) {}
 	void			LoadAreaFromFile( const char* fileName );
     
-    areaNode_t*     InsertNode( void* content, const uint64_t flags, const areaNode_t* parent = nullptr );
-    void            RemoveNode( nodeHash hash );
+	// content is allocated from (and owned by) the active area; flags must contain a single content bit
+	void*			AllocateContent( const uint64_t flags );
+	void			FreeContent( void* content, const uint64_t flags );
+
+    areaNode_t*     InsertNode( void* content, const uint64_t flags, areaNode_t* parent = nullptr );
+    void            RemoveNode( nodeHash hash ); // releases the node subtree and its content (gpu resources excepted)
+	void			SetNodeWorldMatrix( const areaNode_t* node, const DirectX::XMMATRIX& worldMatrix );
+	void			UpdateTransforms();
+
+	// streaming interface (see AreaStreamer); main thread only
+	void			PublishArea( worldArea_t* area );
+	void			EvictArea( const unsigned char x, const unsigned char y );
+	void			SetActiveArea( const unsigned char x, const unsigned char y );
+	void			CollectEvictedAreas();
+	uint64_t		GetMemoryUsage() const;
+
+	// called right before an evicted area is freed (e.g. to release the gpu resources of its meshes); null to unset
+	void			SetAreaReleaseCallback( const std::function<void( worldArea_t* )>& callback ) { areaReleaseCallback = callback; }
+
+	// unlike AllocateContent, any thread as long as the area is not published yet (e.g. Io_ReadAreaFile); actors excepted
+	static void*		AllocateAreaContent( worldArea_t* area, const uint64_t flags );
+	static areaNode_t*	AllocateNode( worldArea_t* area, areaNode_t* parent );
+	static void		AcquireArea( const worldArea_t* area );
+	static void		ReleaseArea( const worldArea_t* area );
+	static void		DestroyArea( worldArea_t* area );
 
 private:
-	worldArea_t*	currentArea;
+	worldArea_t*				currentArea;
+
+	worldArea_t***				areas; // id0 => X index (h axis); id1 => Z index (v axis)
+	unsigned char				gridWidth;
+	unsigned char				gridHeight;
 
-	worldArea_t**	areas; // id0 => X index (h axis); id1 => Z index (v axis)
+	std::vector<worldArea_t*>	residentAreas;
+	std::vector<worldArea_t*>	evictedAreas;	// waiting for their refcount to drop to zero
+
+	EntityManager				entityManager;	// actors of every area
+
+	std::function<void( worldArea_t* )>	areaReleaseCallback;
+
+private:
+	void						ReleaseActors( worldArea_t* area );
 };
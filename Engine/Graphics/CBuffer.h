@@ -1,9 +1,9 @@
 #pragma once
 
 struct renderContext_t;
-struct ID3D11Buffer;
+struct renderBuffer_t;
 
-using CBuffer = ID3D11Buffer*;
+using CBuffer = renderBuffer_t*;
 
 const bool Render_CreateCBuffer( const renderContext_t* context, CBuffer& cbuffer, const unsigned int bufferSize );
 const bool Render_UploadCBuffer( const renderContext_t* context, CBuffer cbuffer, const void* rawDataPtr,
@@ -0,0 +1,283 @@
+#include "Shared.h"
+#include "CBufferRing.h"
+#include "RenderContext.h"
+#include "RenderBackend.h"
+#include "StateCache.h"
+
+CBufferRing::CBufferRing()
+	: buffer( nullptr )
+	, useOffsets( false )
+	, canMapNoOverwrite( false )
+	, isDiscardRequired( true )
+	, mappedData( nullptr )
+	, frameOffset( 0 )
+	, frameSize( 0 )
+	, frameHead( 0 )
+	, frameFence( 0 )
+{
+
+}
+
+const bool CBufferRing::Create( const renderContext_t* context, const uint32_t capacity )
+{
+	useOffsets			= context->backend->SupportsConstantBufferRanges();
+	canMapNoOverwrite	= !useOffsets || context->backend->SupportsNoOverwriteConstantBufferMaps();
+
+	return CreateBuffer( context, capacity );
+}
+
+void CBufferRing::Destroy()
+{
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	RELEASE( buffer )
+
+	for ( frameFence_t& pendingFence : pendingFences ) {
+		RELEASE( pendingFence.query )
+	}
+
+	for ( renderQuery_t*& query : freeQueries ) {
+		RELEASE( query )
+	}
+
+	for ( auto& copyTarget : copyTargets ) {
+		RELEASE( copyTarget.second )
+	}
+
+	pendingFences.clear();
+	freeQueries.clear();
+	copyTargets.clear();
+	frameBindings.clear();
+
+	allocator.Reset();
+}
+
+const bool CBufferRing::BeginFrame( const renderContext_t* context, const uint32_t size )
+{
+	frameOffset	= 0;
+	frameSize	= GetAlignedSize( size );
+	frameHead	= 0;
+
+	frameBindings.clear();
+
+	RetireCompletedFrames( context );
+
+	if ( frameSize == 0 ) {
+		return true;
+	}
+
+	// keep room for the frames in flight; otherwise the ring would be discarded every frame
+	if ( frameSize * MAX_FRAMES_IN_FLIGHT > allocator.GetCapacity() ) {
+		uint32_t capacity = ( allocator.GetCapacity() != 0 ) ? static_cast<uint32_t>( allocator.GetCapacity() ) : ALIGNMENT;
+
+		while ( capacity < frameSize * MAX_FRAMES_IN_FLIGHT ) {
+			capacity <<= 1;
+		}
+
+		if ( !CreateBuffer( context, capacity ) ) {
+			frameSize = 0;
+			return false;
+		}
+	}
+
+	renderMap_t mapType = RENDER_MAP_WRITE_NO_OVERWRITE;
+	std::size_t offset = ( canMapNoOverwrite && !isDiscardRequired ) ? allocator.Allocate( frameSize ) : RingAllocator::INVALID_OFFSET;
+
+	if ( offset == RingAllocator::INVALID_OFFSET ) {
+		// the driver renames the buffer; frames in flight keep reading the previous copy
+		allocator.Reset();
+		offset = allocator.Allocate( frameSize );
+
+		mapType				= RENDER_MAP_WRITE_DISCARD;
+		isDiscardRequired	= false;
+	}
+
+	mappedData = static_cast<uint8_t*>( context->backend->MapBuffer( buffer, mapType ) );
+
+	if ( mappedData == nullptr ) {
+		frameSize = 0;
+		return false;
+	}
+
+	frameOffset	= static_cast<uint32_t>( offset );
+
+	return true;
+}
+
+cbufferSlice_t CBufferRing::Upload( const void* data, const uint32_t size )
+{
+	const uint32_t alignedSize = GetAlignedSize( size );
+
+	if ( mappedData == nullptr || frameHead + alignedSize > frameSize ) {
+		return { 0, 0 };
+	}
+
+	const uint32_t offset = frameOffset + frameHead;
+	memcpy( mappedData + offset, data, size );
+
+	frameHead += alignedSize;
+
+	return { offset, alignedSize };
+}
+
+void CBufferRing::EndFrame( const renderContext_t* context )
+{
+	if ( mappedData != nullptr ) {
+		context->backend->UnmapBuffer( buffer );
+		mappedData = nullptr;
+	}
+
+	allocator.EndFrame( ++frameFence );
+
+	renderQuery_t* query = nullptr;
+
+	if ( !freeQueries.empty() ) {
+		query = freeQueries.back();
+		freeQueries.pop_back();
+	} else {
+		query = context->backend->CreateQuery( RENDER_QUERY_EVENT );
+	}
+
+	if ( query == nullptr ) {
+		// no way to know when the gpu is done with this frame
+		isDiscardRequired = true;
+		return;
+	}
+
+	context->backend->EndQuery( query );
+	pendingFences.push_back( { frameFence, query } );
+}
+
+void CBufferRing::BindVS( const renderContext_t* context, const uint32_t slot, const cbufferSlice_t& slice )
+{
+	Bind( context, SHADER_STAGE_VERTEX, slot, slice );
+}
+
+void CBufferRing::BindPS( const renderContext_t* context, const uint32_t slot, const cbufferSlice_t& slice )
+{
+	Bind( context, SHADER_STAGE_PIXEL, slot, slice );
+}
+
+void CBufferRing::Rebind( const renderContext_t* context ) const
+{
+	for ( const cbufferBinding_t& binding : frameBindings ) {
+		BindRange( context, binding );
+	}
+}
+
+void CBufferRing::Bind( const renderContext_t* context, const shaderStage_t stage, const uint32_t slot, const cbufferSlice_t& slice )
+{
+	if ( slice.size == 0 ) {
+		return;
+	}
+
+	// copies happen here, on the immediate context, before any recorded command list is executed
+	const cbufferBinding_t binding = ( useOffsets )
+		? cbufferBinding_t{ stage, slot, buffer, slice.offset / 16, slice.size / 16 }
+		: cbufferBinding_t{ stage, slot, CopyToTarget( context, stage, slot, slice ), 0, 0 };
+
+	BindRange( context, binding );
+	frameBindings.push_back( binding );
+}
+
+void CBufferRing::BindRange( const renderContext_t* context, const cbufferBinding_t& binding )
+{
+	StateCache* stateCache = context->stateCache;
+
+	if ( binding.constantCount != 0 ) {
+		if ( binding.stage == SHADER_STAGE_VERTEX ) {
+			stateCache->SetVSConstantBufferRange( binding.slot, binding.buffer, binding.firstConstant, binding.constantCount );
+		} else {
+			stateCache->SetPSConstantBufferRange( binding.slot, binding.buffer, binding.firstConstant, binding.constantCount );
+		}
+	} else {
+		if ( binding.stage == SHADER_STAGE_VERTEX ) {
+			stateCache->SetVSConstantBuffer( binding.slot, binding.buffer );
+		} else {
+			stateCache->SetPSConstantBuffer( binding.slot, binding.buffer );
+		}
+	}
+}
+
+const bool CBufferRing::CreateBuffer( const renderContext_t* context, const uint32_t capacity )
+{
+	RELEASE( buffer )
+
+	const uint32_t alignedCapacity = GetAlignedSize( capacity );
+
+	// a 11.0 runtime caps constant buffers to 64KB; the ring is only a copy source there
+	const uint32_t bindFlags = ( useOffsets ) ? RENDER_BIND_CONSTANT_BUFFER : RENDER_BIND_VERTEX_BUFFER;
+
+	const renderBufferDesc_t ringDesc = {
+		alignedCapacity,				// uint32_t size
+		RENDER_USAGE_DYNAMIC,			// renderUsage_t usage
+		bindFlags,						// uint32_t bindFlags
+		RENDER_CPU_ACCESS_WRITE,		// uint32_t cpuAccessFlags
+		0,								// uint32_t miscFlags
+		0,								// uint32_t structureStride
+	};
+
+	buffer = context->backend->CreateBuffer( ringDesc, nullptr );
+
+	if ( buffer == nullptr ) {
+		allocator.Initialize( 0, ALIGNMENT );
+		return false;
+	}
+
+	allocator.Initialize( alignedCapacity, ALIGNMENT );
+	isDiscardRequired = true;
+
+	return true;
+}
+
+void CBufferRing::RetireCompletedFrames( const renderContext_t* context )
+{
+	uint64_t completedFence = 0;
+
+	while ( !pendingFences.empty() ) {
+		int32_t isDone = 0;
+
+		// never flush; an unfinished frame simply keeps its part of the ring
+		if ( !context->backend->GetQueryData( pendingFences.front().query, &isDone, sizeof( int32_t ) ) || !isDone ) {
+			break;
+		}
+
+		completedFence = pendingFences.front().fence;
+
+		freeQueries.push_back( pendingFences.front().query );
+		pendingFences.pop_front();
+	}
+
+	if ( completedFence != 0 ) {
+		allocator.Retire( completedFence );
+	}
+}
+
+renderBuffer_t* CBufferRing::CopyToTarget( const renderContext_t* context, const shaderStage_t stage, const uint32_t slot, const cbufferSlice_t& slice )
+{
+	const uint32_t targetKey = ( ( slice.size / ALIGNMENT ) << 5 ) | ( stage << 4 ) | ( slot & 0xF );
+
+	renderBuffer_t*& target = copyTargets[targetKey];
+
+	if ( target == nullptr ) {
+		const renderBufferDesc_t targetDesc = {
+			slice.size,						// uint32_t size
+			RENDER_USAGE_DEFAULT,			// renderUsage_t usage
+			RENDER_BIND_CONSTANT_BUFFER,	// uint32_t bindFlags
+			0,								// uint32_t cpuAccessFlags
+			0,								// uint32_t miscFlags
+			0,								// uint32_t structureStride
+		};
+
+		target = context->backend->CreateBuffer( targetDesc, nullptr );
+
+		if ( target == nullptr ) {
+			return nullptr;
+		}
+	}
+
+	// the whole target is overwritten; partial constant buffer updates require 11.1 as well
+	context->backend->CopyBufferRegion( target, 0, buffer, slice.offset, slice.size );
+
+	return target;
+}
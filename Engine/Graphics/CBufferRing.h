@@ -0,0 +1,103 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <Engine/System/RingAllocator.h>
+
+#include "RenderTypes.h"
+
+struct renderContext_t;
+
+// part of the frame constant ring; offset and size are multiples of CBufferRing::ALIGNMENT
+struct cbufferSlice_t
+{
+	uint32_t	offset;
+	uint32_t	size;	// 0 if the upload failed
+};
+
+// frame scoped constant upload ring
+// one large dynamic buffer is mapped once per frame (BeginFrame), sub-allocated linearly and unmapped by EndFrame
+// frames are fenced with event queries; the ring is only discarded when it wraps onto a frame still in flight
+// slices are bound with offsets when the backend supports constant buffer ranges (d3d 11.1); otherwise each bind copies the slice
+// into a small cbuffer owned by the ring (one per stage, slot and size)
+class CBufferRing
+{
+public:
+	static constexpr uint32_t	ALIGNMENT = 256; // *SetConstantBuffers1 offsets are multiples of 16 constants
+
+public:
+	static inline uint32_t		GetAlignedSize( const uint32_t size )	{ return ( size + ALIGNMENT - 1 ) & ~( ALIGNMENT - 1 ); }
+	inline const bool		UsesOffsets() const					{ return useOffsets; }
+
+public:
+							CBufferRing();
+							CBufferRing( CBufferRing& ) = delete;
+							~CBufferRing() = default;
+
+	const bool				Create( const renderContext_t* context, const uint32_t capacity );
+	void					Destroy();
+
+	// frameSize is the sum of the aligned sizes uploaded during the frame; the ring grows if needed
+	const bool				BeginFrame( const renderContext_t* context, const uint32_t frameSize );
+	cbufferSlice_t			Upload( const void* data, const uint32_t size );
+	void					EndFrame( const renderContext_t* context );
+
+	// slices can only be bound once the frame has ended (the ring is unmapped)
+	void					BindVS( const renderContext_t* context, const uint32_t slot, const cbufferSlice_t& slice );
+	void					BindPS( const renderContext_t* context, const uint32_t slot, const cbufferSlice_t& slice );
+
+	// repeats the binds of the frame on another context (see CommandRecorder); thread safe, nothing is copied
+	void					Rebind( const renderContext_t* context ) const;
+
+private:
+	static constexpr uint32_t	MAX_FRAMES_IN_FLIGHT = 3;
+
+	enum shaderStage_t
+	{
+		SHADER_STAGE_VERTEX = 0,
+		SHADER_STAGE_PIXEL,
+	};
+
+	struct frameFence_t
+	{
+		uint64_t			fence;
+		renderQuery_t*		query;
+	};
+
+	struct cbufferBinding_t
+	{
+		shaderStage_t		stage;
+		uint32_t			slot;
+		renderBuffer_t*		buffer;
+		uint32_t			firstConstant;
+		uint32_t			constantCount;	// 0: whole buffer (copy target)
+	};
+
+private:
+	renderBuffer_t*			buffer;
+	RingAllocator			allocator;
+	bool					useOffsets;
+	bool					canMapNoOverwrite;
+	bool					isDiscardRequired;	// first map after (re)creation
+
+	uint8_t*				mappedData;
+	uint32_t				frameOffset;	// frame block in the ring
+	uint32_t				frameSize;
+	uint32_t				frameHead;		// linear allocation inside the frame block
+
+	uint64_t							frameFence;
+	std::deque<frameFence_t>			pendingFences;
+	std::vector<renderQuery_t*>			freeQueries;
+
+	std::unordered_map<uint32_t, renderBuffer_t*>	copyTargets; // fallback when offsets are not supported
+	std::vector<cbufferBinding_t>				frameBindings;
+
+private:
+	const bool				CreateBuffer( const renderContext_t* context, const uint32_t capacity );
+	void					RetireCompletedFrames( const renderContext_t* context );
+	renderBuffer_t*			CopyToTarget( const renderContext_t* context, const shaderStage_t stage, const uint32_t slot, const cbufferSlice_t& slice );
+	void					Bind( const renderContext_t* context, const shaderStage_t stage, const uint32_t slot, const cbufferSlice_t& slice );
+	static void				BindRange( const renderContext_t* context, const cbufferBinding_t& binding );
+};
@@ -1,6 +1,7 @@
 #include "Shared.h"
 #include "Camera.h"
 #include "RenderContext.h"
+#include "RenderBackend.h"
 
 Camera::Camera()
 	: worldPos{}
@@ -22,6 +23,15 @@ Camera::~Camera()
 	RELEASE( cbuffer )
 }
 
+void Camera::GetShaderMatrices( camCbuffer_t* data ) const
+{
+	data->viewProjection	= viewMatrix * projectionMatrix;
+	data->inverseView		= DirectX::XMMatrixInverse( nullptr, viewMatrix );
+	data->inverseProjection	= DirectX::XMMatrixInverse( nullptr, projectionMatrix );
+
+	data->position = DirectX::XMLoadFloat3( &worldPos );
+}
+
 static constexpr float FREECAM_MOVESPEED_THRESHOLD = 100.0f;
 
 FreeCamera::FreeCamera()
@@ -151,8 +161,8 @@ void FreeCamera::Update( long mouseDx, long mouseDy, float frameTime )
 
 void FreeCamera::SetActive( const renderContext_t* context )
 {
-	context->deviceContext->VSSetConstantBuffers( 0, 1, &cbuffer );
-	context->deviceContext->PSSetConstantBuffers( 0, 1, &cbuffer );
+	context->backend->SetConstantBuffers( RENDER_STAGE_VERTEX, 0, 1, &cbuffer );
+	context->backend->SetConstantBuffers( RENDER_STAGE_PIXEL, 0, 1, &cbuffer );
 
 	UpdateMatrices( context );
 }
@@ -224,11 +234,7 @@ void FreeCamera::MoveRight( float frameTime )
 
 void FreeCamera::UpdateMatrices( const renderContext_t* context )
 {
-	matrices.viewProjection = viewMatrix * projectionMatrix;
-	matrices.inverseView = DirectX::XMMatrixInverse( nullptr, viewMatrix );
-	matrices.inverseProjection = DirectX::XMMatrixInverse( nullptr, projectionMatrix );
-	
-	matrices.position = DirectX::XMLoadFloat3( &worldPos );
+	GetShaderMatrices( &matrices );
 
 	Render_UploadCBuffer( context, cbuffer, &matrices, sizeof( camCbuffer_t ) );
 }
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <d3d11.h>
 #include "CBuffer.h"
 #include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
 
@@ -40,6 +39,8 @@ public:
 					Camera();
 	virtual			~Camera();
 
+	void			GetShaderMatrices( camCbuffer_t* data ) const; // cpu copy of the camera cbuffer content
+
 	virtual const bool	Create( const renderContext_t* context, const float aspectRatio, const float fov, const float nearPlane, const float farPlane ) = 0;
 	virtual void	Update( long mouseDx, long mouseDy, float frameTime ) = 0;
 
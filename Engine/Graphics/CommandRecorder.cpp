@@ -0,0 +1,73 @@
+#include "Shared.h"
+#include "CommandRecorder.h"
+
+CommandRecorder::CommandRecorder()
+	: chunkCount( 0 )
+	, chunkContexts{}
+{
+
+}
+
+const bool CommandRecorder::Create( const renderContext_t* context, const uint32_t maxChunkCount )
+{
+	Destroy();
+
+	const uint32_t requestedCount = ( maxChunkCount < MAX_CHUNK_COUNT ) ? maxChunkCount : MAX_CHUNK_COUNT;
+
+	for ( uint32_t chunk = 0; chunk < requestedCount; ++chunk ) {
+		// everything but the command side is shared with the submitting context
+		renderContext_t& chunkContext = chunkContexts[chunk];
+		chunkContext = *context;
+
+		chunkContext.backBuffer	= nullptr;
+		chunkContext.backend	= context->backend->CreateDeferredBackend();
+
+		if ( chunkContext.backend == nullptr ) {
+			chunkContext = {};
+			break;
+		}
+
+		stateCaches[chunk].Initialize( chunkContext.backend );
+		chunkContext.stateCache = &stateCaches[chunk];
+
+		chunkCount++;
+	}
+
+	// whatever could be created is used; without any chunk, everything is recorded inline
+	return chunkCount == requestedCount;
+}
+
+void CommandRecorder::Destroy()
+{
+	for ( uint32_t chunk = 0; chunk < chunkCount; ++chunk ) {
+		renderContext_t& chunkContext = chunkContexts[chunk];
+
+		delete chunkContext.backend;
+		chunkContext = {};
+	}
+
+	chunkCount = 0;
+}
+
+stateCacheCounters_t CommandRecorder::ConsumeCounters()
+{
+	stateCacheCounters_t total = {};
+
+	for ( uint32_t chunk = 0; chunk < chunkCount; ++chunk ) {
+		const stateCacheCounters_t& counters = stateCaches[chunk].GetCounters();
+
+		total.submittedCalls	+= counters.submittedCalls;
+		total.filteredCalls		+= counters.filteredCalls;
+		total.issuedCalls		+= counters.issuedCalls;
+
+		stateCaches[chunk].ResetCounters();
+	}
+
+	return total;
+}
+
+const uint32_t CommandRecorder::GetUsedChunkCount( const uint32_t itemCount ) const
+{
+	const uint32_t neededCount = itemCount / MIN_ITEMS_PER_CHUNK;
+	return ( neededCount < chunkCount ) ? neededCount : chunkCount;
+}
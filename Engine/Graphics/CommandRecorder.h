@@ -0,0 +1,80 @@
+#pragma once
+
+#include "RenderContext.h"
+#include "RenderBackend.h"
+#include "StateCache.h"
+
+#include <Engine/System/JobSystem.h>
+
+// parallel command recording
+// a list of items (e.g. draw batches) is split in ordered chunks; each chunk is recorded by a job on its own context
+// (deferred context, or a null backend stream when there is no device) then executed in order by the submitting thread
+// the chunk count only depends on the item count, so the merged stream is the same whatever the number of workers
+// render thread only
+class CommandRecorder
+{
+public:
+	static constexpr uint32_t	MAX_CHUNK_COUNT		= 8;
+	static constexpr uint32_t	MIN_ITEMS_PER_CHUNK	= 64; // below that, recording a command list costs more than it saves
+
+public:
+	inline uint32_t				GetMaxChunkCount() const	{ return chunkCount; }
+
+public:
+								CommandRecorder();
+								CommandRecorder( CommandRecorder& ) = delete;
+								~CommandRecorder() = default;
+
+	// one deferred backend per chunk (see RenderBackend::CreateDeferredBackend), of the same kind as the context one
+	const bool					Create( const renderContext_t* context, const uint32_t maxChunkCount );
+	void						Destroy();
+
+	// record( chunkContext, begin, end ) is called once per chunk, in parallel
+	// each chunk starts from the default device state: record must bind everything it relies on (targets, viewport, cbuffers, ...)
+	// with a single chunk, record runs inline on the submitting context
+	template<typename Func>
+	void						Record( const renderContext_t* context, const uint32_t itemCount, const Func& record );
+
+	stateCacheCounters_t		ConsumeCounters(); // chunk state caches since the previous call
+
+private:
+	uint32_t					chunkCount;
+	renderContext_t				chunkContexts[MAX_CHUNK_COUNT];
+	StateCache					stateCaches[MAX_CHUNK_COUNT];
+
+private:
+	const uint32_t				GetUsedChunkCount( const uint32_t itemCount ) const;
+};
+
+template<typename Func>
+void CommandRecorder::Record( const renderContext_t* context, const uint32_t itemCount, const Func& record )
+{
+	const uint32_t usedChunkCount = GetUsedChunkCount( itemCount );
+
+	if ( usedChunkCount <= 1 ) {
+		record( context, 0, itemCount );
+		return;
+	}
+
+	const uint32_t chunkSize = ( itemCount + usedChunkCount - 1 ) / usedChunkCount;
+
+	Job_ParallelFor( 0, usedChunkCount, 1, [this, itemCount, chunkSize, &record]( const uint32_t chunkBegin, const uint32_t chunkEnd ) {
+		for ( uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk ) {
+			const renderContext_t* chunkContext = &chunkContexts[chunk];
+
+			const uint32_t begin	= chunk * chunkSize;
+			const uint32_t end		= ( begin + chunkSize < itemCount ) ? begin + chunkSize : itemCount;
+
+			// the deferred context has been reset by the previous FinishCommandList
+			chunkContext->stateCache->Invalidate();
+
+			record( chunkContext, begin, end );
+			chunkContext->backend->FinishCommandList();
+		}
+	} );
+
+	// merged in order; the state of the submitting context is kept
+	for ( uint32_t chunk = 0; chunk < usedChunkCount; ++chunk ) {
+		context->backend->ExecuteCommandList( chunkContexts[chunk].backend );
+	}
+}
@@ -0,0 +1,77 @@
+#include "Shared.h"
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution()
+	: settings{ 16.0f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f }
+	, scale( 1.0f )
+	, appliedScale( 1.0f )
+	, filteredFrameTime( 0.0f )
+	, previousError( 0.0f )
+	, previousDelta( 0.0f )
+	, sampleCount( 0 )
+{
+
+}
+
+void DynamicResolution::Initialize( const dynamicResolutionSettings_t& controllerSettings )
+{
+	settings = controllerSettings;
+
+	settings.maxScale	= std::min( std::max( settings.maxScale, 0.0f ), 1.0f );
+	settings.minScale	= std::min( std::max( settings.minScale, 0.0f ), settings.maxScale );
+	settings.smoothing	= std::min( std::max( settings.smoothing, 0.0f ), 1.0f );
+
+	Reset();
+}
+
+void DynamicResolution::Reset()
+{
+	scale				= settings.maxScale;
+	appliedScale		= settings.maxScale;
+	filteredFrameTime	= 0.0f;
+	previousError		= 0.0f;
+	previousDelta		= 0.0f;
+	sampleCount			= 0;
+}
+
+float DynamicResolution::Update( const float frameTime )
+{
+	if ( !( frameTime > 0.0f ) || settings.targetFrameTime <= 0.0f ) {
+		return appliedScale;
+	}
+
+	filteredFrameTime = ( sampleCount == 0 ) ? frameTime : filteredFrameTime + settings.smoothing * ( frameTime - filteredFrameTime );
+
+	// positive: headroom, the scale can grow
+	const float error = ( settings.targetFrameTime - filteredFrameTime ) / settings.targetFrameTime;
+
+	// the first sample has no history: only the integral term acts
+	const float delta = ( sampleCount == 0 ) ? 0.0f : error - previousError;
+	const float deltaChange = ( sampleCount <= 1 ) ? 0.0f : delta - previousDelta;
+
+	scale += settings.proportionalGain * delta + settings.integralGain * error + settings.derivativeGain * deltaChange;
+	scale = std::min( std::max( scale, settings.minScale ), settings.maxScale );
+
+	previousError = error;
+	previousDelta = delta;
+	sampleCount++;
+
+	appliedScale = Quantize( scale );
+
+	return appliedScale;
+}
+
+float DynamicResolution::Quantize( const float value ) const
+{
+	if ( settings.scaleStep <= 0.0f ) {
+		return value;
+	}
+
+	// never below the min scale nor above the max one, even if they are not multiples of the step
+	const float quantized = std::floor( value / settings.scaleStep + 0.5f ) * settings.scaleStep;
+
+	return std::min( std::max( quantized, settings.minScale ), settings.maxScale );
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+struct dynamicResolutionSettings_t
+{
+	float		targetFrameTime;	// ms; gpu budget
+	float		minScale;
+	float		maxScale;			// at most 1: the targets are sized from the back buffer (so is the depth buffer)
+	float		scaleStep;			// the applied scale is a multiple of it; 0: continuous
+	float		smoothing;			// ]0..1]; weight of a new frame time in the filtered one (1: no filtering)
+	float		proportionalGain;	// scale change per change of the relative budget headroom
+	float		integralGain;		// scale change per frame and relative headroom
+	float		derivativeGain;
+};
+
+// render scale controller: a pid on the relative headroom of the gpu frame time ( budget - time ) / budget
+// incremental (velocity) form: the output is clamped to the scale bounds without integral windup
+// pure function of the frame times it is fed; no clock, no randomness (replayable from a trace, see Headless)
+class DynamicResolution
+{
+public:
+	inline float		GetScale() const			{ return appliedScale; } // quantized, within the bounds
+	inline float		GetFilteredFrameTime() const { return filteredFrameTime; } // ms
+	inline uint64_t		GetSampleCount() const		{ return sampleCount; }
+
+public:
+						DynamicResolution();
+						DynamicResolution( DynamicResolution& ) = delete;
+						~DynamicResolution() = default;
+
+	void				Initialize( const dynamicResolutionSettings_t& controllerSettings );
+	void				Reset(); // back to the max scale
+
+	float				Update( const float frameTime ); // ms, one sample per rendered frame; returns the new scale
+
+private:
+	dynamicResolutionSettings_t	settings;
+
+	float				scale;				// controller output, not quantized
+	float				appliedScale;
+	float				filteredFrameTime;
+	float				previousError;
+	float				previousDelta;		// previousError - the error before it
+	uint64_t			sampleCount;
+
+private:
+	float				Quantize( const float value ) const;
+};
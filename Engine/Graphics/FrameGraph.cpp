@@ -0,0 +1,368 @@
+#include "Shared.h"
+#include "FrameGraph.h"
+#include "RenderBackend.h"
+
+#include <Engine/System/Log.h>
+
+#include <algorithm>
+
+namespace
+{
+	uint32_t GetBytesPerPixel( const renderFormat_t format )
+	{
+		switch ( format ) {
+		case RENDER_FORMAT_R32G32B32A32_FLOAT:
+			return 16;
+
+		case RENDER_FORMAT_R16G16B16A16_FLOAT:
+		case RENDER_FORMAT_R32G32_FLOAT:
+			return 8;
+
+		case RENDER_FORMAT_R8_UNORM:
+			return 1;
+
+		case RENDER_FORMAT_R16_FLOAT:
+			return 2;
+
+		default:
+			// rgba8, r11g11b10, r32, d24s8, ...
+			return 4;
+		}
+	}
+
+	// typed formats of the views of a (typeless) depth texture
+	void GetDepthViewFormats( const renderFormat_t format, renderFormat_t& depthFormat, renderFormat_t& shaderFormat )
+	{
+		switch ( format ) {
+		case RENDER_FORMAT_R32_TYPELESS:
+			depthFormat		= RENDER_FORMAT_D32_FLOAT;
+			shaderFormat	= RENDER_FORMAT_R32_FLOAT;
+			break;
+
+		case RENDER_FORMAT_R16_TYPELESS:
+			depthFormat		= RENDER_FORMAT_D16_UNORM;
+			shaderFormat	= RENDER_FORMAT_R16_UNORM;
+			break;
+
+		default:
+			depthFormat		= RENDER_FORMAT_D24_UNORM_S8_UINT;
+			shaderFormat	= RENDER_FORMAT_R24_UNORM_X8_TYPELESS;
+			break;
+		}
+	}
+
+	const bool CreatePhysicalTarget( RenderBackend* backend, const frameGraphTargetDesc_t& desc, renderTarget_t* target )
+	{
+		const bool isDepth			= ( desc.bindFlags & RENDER_BIND_DEPTH_STENCIL ) != 0;
+		const bool isMultisampled	= desc.sampleCount > 1;
+
+		const renderTextureDesc_t textureDesc = {
+			RENDER_TEXTURE_DIMENSION_2D,
+			desc.width,
+			desc.height,
+			1,
+			1,
+			1,
+			desc.format,
+			desc.sampleCount,
+			RENDER_USAGE_DEFAULT,
+			desc.bindFlags,
+			0,
+			0,
+		};
+
+		target->texture = backend->CreateTexture( textureDesc );
+
+		if ( target->texture == nullptr ) {
+			return false;
+		}
+
+		const renderViewDimension_t viewDimension = ( isMultisampled ) ? RENDER_VIEW_DIMENSION_TEXTURE2DMS : RENDER_VIEW_DIMENSION_TEXTURE2D;
+
+		renderFormat_t depthFormat = desc.format, shaderFormat = desc.format;
+
+		if ( isDepth ) {
+			GetDepthViewFormats( desc.format, depthFormat, shaderFormat );
+
+			renderViewDesc_t depthStencilViewDesc = {};
+			depthStencilViewDesc.format		= depthFormat;
+			depthStencilViewDesc.dimension	= viewDimension;
+
+			target->depthView = backend->CreateDepthStencilView( target->texture, &depthStencilViewDesc );
+
+			if ( target->depthView == nullptr ) {
+				return false;
+			}
+		} else if ( desc.bindFlags & RENDER_BIND_RENDER_TARGET ) {
+			renderViewDesc_t renderTargetViewDesc = {};
+			renderTargetViewDesc.format		= desc.format;
+			renderTargetViewDesc.dimension	= viewDimension;
+
+			target->view = backend->CreateRenderTargetView( target->texture, &renderTargetViewDesc );
+
+			if ( target->view == nullptr ) {
+				return false;
+			}
+		}
+
+		if ( desc.bindFlags & RENDER_BIND_SHADER_RESOURCE ) {
+			renderViewDesc_t shaderResourceViewDesc = {};
+			shaderResourceViewDesc.format		= shaderFormat;
+			shaderResourceViewDesc.dimension	= viewDimension;
+			shaderResourceViewDesc.mipLevels	= 1;
+
+			target->ressource = backend->CreateShaderResourceView( target->texture, &shaderResourceViewDesc );
+
+			if ( target->ressource == nullptr ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+FrameGraph::FrameGraph()
+	: unaliasedSize( 0 )
+	, aliasedSize( 0 )
+{
+
+}
+
+void FrameGraph::Reset()
+{
+	passes.clear();
+	resources.clear();
+	plan.clear();
+	physicals.clear();
+
+	unaliasedSize	= 0;
+	aliasedSize		= 0;
+}
+
+void FrameGraph::Release()
+{
+	Reset();
+	realized.clear();
+}
+
+frameGraphResource_t FrameGraph::CreateTarget( const char* name, const frameGraphTargetDesc_t& desc, const bool isPersistent )
+{
+	resources.push_back( { name, desc, isPersistent } );
+
+	return static_cast<frameGraphResource_t>( resources.size() - 1 );
+}
+
+uint32_t FrameGraph::AddPass( const char* name, execute_t execute )
+{
+	passes.push_back( { name, std::move( execute ), {}, {} } );
+
+	return static_cast<uint32_t>( passes.size() - 1 );
+}
+
+void FrameGraph::Read( const uint32_t pass, const frameGraphResource_t resource )
+{
+	passes[pass].reads.push_back( resource );
+}
+
+void FrameGraph::Write( const uint32_t pass, const frameGraphResource_t resource )
+{
+	passes[pass].writes.push_back( resource );
+}
+
+const bool FrameGraph::Compile( const uint32_t backBufferWidth, const uint32_t backBufferHeight )
+{
+	const uint32_t resourceCount = GetResourceCount(),
+				   passCount = GetPassCount();
+
+	plan.resize( resourceCount );
+	physicals.clear();
+
+	unaliasedSize	= 0;
+	aliasedSize		= 0;
+
+	for ( frameGraphResource_t resource = 0; resource < resourceCount; ++resource ) {
+		const frameGraphTargetDesc_t& desc = resources[resource].desc;
+		frameGraphResourcePlan_t& resourcePlan = plan[resource];
+
+		resourcePlan.firstPass		= FRAME_GRAPH_UNUSED_PASS;
+		resourcePlan.lastPass		= FRAME_GRAPH_UNUSED_PASS;
+		resourcePlan.physicalIndex	= FRAME_GRAPH_INVALID_RESOURCE;
+
+		resourcePlan.desc			= desc;
+		resourcePlan.desc.width		= ( desc.width != 0 ) ? desc.width : std::max( backBufferWidth >> desc.sizeShift, 1u );
+		resourcePlan.desc.height	= ( desc.height != 0 ) ? desc.height : std::max( backBufferHeight >> desc.sizeShift, 1u );
+		resourcePlan.desc.sizeShift	= 0;
+	}
+
+	// passes are declared in execution order: a lifetime spans from the first to the last pass using the target
+	for ( uint32_t pass = 0; pass < passCount; ++pass ) {
+		for ( const frameGraphResource_t resource : passes[pass].reads ) {
+			frameGraphResourcePlan_t& resourcePlan = plan[resource];
+
+			// persistent targets hold the previous frame content
+			if ( resourcePlan.firstPass == FRAME_GRAPH_UNUSED_PASS && !resources[resource].isPersistent ) {
+				Log_Printf( "FrameGraph: '%s' (%ux%u) is read by '%s' before being written\n", resources[resource].name, resourcePlan.desc.width, resourcePlan.desc.height, passes[pass].name );
+				return false;
+			}
+
+			resourcePlan.firstPass	= std::min( resourcePlan.firstPass, pass );
+			resourcePlan.lastPass	= pass;
+		}
+
+		for ( const frameGraphResource_t resource : passes[pass].writes ) {
+			frameGraphResourcePlan_t& resourcePlan = plan[resource];
+
+			resourcePlan.firstPass	= std::min( resourcePlan.firstPass, pass );
+			resourcePlan.lastPass	= pass;
+		}
+	}
+
+	// targets by first use; each one takes the first free physical texture with the same desc
+	std::vector<frameGraphResource_t> allocationOrder;
+	allocationOrder.reserve( resourceCount );
+
+	for ( frameGraphResource_t resource = 0; resource < resourceCount; ++resource ) {
+		if ( plan[resource].firstPass != FRAME_GRAPH_UNUSED_PASS ) {
+			allocationOrder.push_back( resource );
+		}
+	}
+
+	std::stable_sort( allocationOrder.begin(), allocationOrder.end(), [this]( const frameGraphResource_t left, const frameGraphResource_t right ) {
+		return plan[left].firstPass < plan[right].firstPass;
+	} );
+
+	for ( const frameGraphResource_t resource : allocationOrder ) {
+		frameGraphResourcePlan_t& resourcePlan = plan[resource];
+		const bool isPersistent = resources[resource].isPersistent;
+
+		unaliasedSize += Render_GetTargetSize( resourcePlan.desc );
+
+		if ( !isPersistent ) {
+			for ( uint32_t physicalIndex = 0; physicalIndex < physicals.size(); ++physicalIndex ) {
+				physical_t& physical = physicals[physicalIndex];
+
+				if ( !physical.isPersistent && physical.lastPass < resourcePlan.firstPass && Render_IsSameTargetDesc( physical.desc, resourcePlan.desc ) ) {
+					physical.lastPass = resourcePlan.lastPass;
+					resourcePlan.physicalIndex = physicalIndex;
+					break;
+				}
+			}
+		}
+
+		if ( resourcePlan.physicalIndex == FRAME_GRAPH_INVALID_RESOURCE ) {
+			// persistent targets are alive for the whole frame (and the next one)
+			physicals.push_back( { resourcePlan.desc, ( isPersistent ) ? FRAME_GRAPH_UNUSED_PASS : resourcePlan.lastPass, isPersistent } );
+			resourcePlan.physicalIndex = static_cast<uint32_t>( physicals.size() - 1 );
+
+			aliasedSize += Render_GetTargetSize( resourcePlan.desc );
+		}
+	}
+
+	return true;
+}
+
+const bool FrameGraph::Validate() const
+{
+	const uint32_t resourceCount = GetResourceCount();
+
+	for ( frameGraphResource_t left = 0; left < resourceCount; ++left ) {
+		const frameGraphResourcePlan_t& leftPlan = plan[left];
+
+		if ( leftPlan.firstPass == FRAME_GRAPH_UNUSED_PASS ) {
+			continue;
+		}
+
+		if ( leftPlan.physicalIndex >= physicals.size() || !Render_IsSameTargetDesc( leftPlan.desc, physicals[leftPlan.physicalIndex].desc ) ) {
+			return false;
+		}
+
+		for ( frameGraphResource_t right = left + 1; right < resourceCount; ++right ) {
+			const frameGraphResourcePlan_t& rightPlan = plan[right];
+
+			if ( rightPlan.firstPass == FRAME_GRAPH_UNUSED_PASS || rightPlan.physicalIndex != leftPlan.physicalIndex ) {
+				continue;
+			}
+
+			const bool isOverlapping = leftPlan.firstPass <= rightPlan.lastPass && rightPlan.firstPass <= leftPlan.lastPass;
+
+			if ( isOverlapping || resources[left].isPersistent || resources[right].isPersistent ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+const bool FrameGraph::Realize( RenderBackend* backend )
+{
+	const uint32_t physicalCount = GetPhysicalCount();
+
+	realized.resize( physicalCount );
+
+	for ( uint32_t physicalIndex = 0; physicalIndex < physicalCount; ++physicalIndex ) {
+		realizedTarget_t& realizedTarget = realized[physicalIndex];
+		const frameGraphTargetDesc_t& desc = physicals[physicalIndex].desc;
+
+		if ( realizedTarget.target != nullptr && Render_IsSameTargetDesc( realizedTarget.desc, desc ) ) {
+			continue;
+		}
+
+		// the previous texture (if any) is released here
+		realizedTarget.desc		= desc;
+		realizedTarget.target	= std::unique_ptr<renderTarget_t>( new renderTarget_t() );
+
+		if ( !CreatePhysicalTarget( backend, desc, realizedTarget.target.get() ) ) {
+			Log_Printf( "FrameGraph: failed to create the texture of '%s' (%ux%u, format %u, %u samples)\n", GetPhysicalName( physicalIndex ), desc.width, desc.height, static_cast<uint32_t>( desc.format ), desc.sampleCount );
+
+			realizedTarget.target.reset();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FrameGraph::Execute() const
+{
+	for ( const pass_t& pass : passes ) {
+		if ( pass.execute ) {
+			pass.execute( this );
+		}
+	}
+}
+
+const char* FrameGraph::GetPhysicalName( const uint32_t physicalIndex ) const
+{
+	// the first target aliased on it
+	for ( frameGraphResource_t resource = 0; resource < GetResourceCount(); ++resource ) {
+		if ( plan[resource].physicalIndex == physicalIndex ) {
+			return resources[resource].name;
+		}
+	}
+
+	return "unknown";
+}
+
+const renderTarget_t* FrameGraph::GetTarget( const frameGraphResource_t resource ) const
+{
+	const uint32_t physicalIndex = plan[resource].physicalIndex;
+
+	return ( physicalIndex < realized.size() ) ? realized[physicalIndex].target.get() : nullptr;
+}
+
+const bool Render_IsSameTargetDesc( const frameGraphTargetDesc_t& left, const frameGraphTargetDesc_t& right )
+{
+	return left.width == right.width
+		&& left.height == right.height
+		&& left.sizeShift == right.sizeShift
+		&& left.format == right.format
+		&& left.sampleCount == right.sampleCount
+		&& left.bindFlags == right.bindFlags;
+}
+
+uint64_t Render_GetTargetSize( const frameGraphTargetDesc_t& desc )
+{
+	return static_cast<uint64_t>( desc.width ) * desc.height * desc.sampleCount * GetBytesPerPixel( desc.format );
+}
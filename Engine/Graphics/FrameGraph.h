@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Texture.h"
+
+class RenderBackend;
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+using frameGraphResource_t = uint32_t;
+
+constexpr frameGraphResource_t	FRAME_GRAPH_INVALID_RESOURCE	= ~0u;
+constexpr uint32_t				FRAME_GRAPH_UNUSED_PASS			= ~0u;
+
+struct frameGraphTargetDesc_t
+{
+	uint32_t		width;			// 0: back buffer width >> sizeShift
+	uint32_t		height;			// 0: back buffer height >> sizeShift
+	uint32_t		sizeShift;
+	renderFormat_t	format;			// typeless for depth targets; views get the matching typed formats
+	uint32_t		sampleCount;
+	uint32_t		bindFlags;		// RENDER_BIND_RENDER_TARGET or RENDER_BIND_DEPTH_STENCIL (| RENDER_BIND_SHADER_RESOURCE)
+};
+
+struct frameGraphResourcePlan_t
+{
+	uint32_t				firstPass;		// FRAME_GRAPH_UNUSED_PASS if no pass uses the resource
+	uint32_t				lastPass;
+	uint32_t				physicalIndex;
+	frameGraphTargetDesc_t	desc;			// resolved against the back buffer size (sizeShift is 0)
+};
+
+// render passes declare the targets they read and write; the graph derives their lifetimes from the pass order,
+// then gives targets with disjoint lifetimes and identical descs the same physical texture
+// d3d11 has no placed resources: aliasing is done by sharing textures rather than heap memory
+// transient targets hold garbage when their pass starts (clear them); persistent targets keep their content between frames and are never shared
+// declaring and compiling only touches the cpu; Realize creates the textures
+class FrameGraph
+{
+public:
+	using execute_t = std::function<void( const FrameGraph* graph )>;
+
+public:
+	inline uint32_t							GetPassCount() const							{ return static_cast<uint32_t>( passes.size() ); }
+	inline uint32_t							GetResourceCount() const						{ return static_cast<uint32_t>( resources.size() ); }
+	inline uint32_t							GetPhysicalCount() const						{ return static_cast<uint32_t>( physicals.size() ); }
+	inline const frameGraphResourcePlan_t&	GetPlan( const frameGraphResource_t resource ) const { return plan[resource]; }
+	inline uint64_t							GetUnaliasedSize() const						{ return unaliasedSize; } // bytes, every target on its own
+	inline uint64_t							GetAliasedSize() const							{ return aliasedSize; }
+
+public:
+									FrameGraph();
+									FrameGraph( FrameGraph& ) = delete;
+									~FrameGraph() = default;
+
+	void							Reset(); // passes and resources; realized textures are kept for the next Realize
+	void							Release();
+
+	frameGraphResource_t			CreateTarget( const char* name, const frameGraphTargetDesc_t& desc, const bool isPersistent = false );
+	uint32_t						AddPass( const char* name, execute_t execute ); // passes run in declaration order
+	void							Read( const uint32_t pass, const frameGraphResource_t resource );
+	void							Write( const uint32_t pass, const frameGraphResource_t resource );
+
+	// lifetimes and aliasing plan; fails if a transient target is read before being written
+	const bool						Compile( const uint32_t backBufferWidth, const uint32_t backBufferHeight );
+	const bool						Validate() const; // no physical texture shared by overlapping lifetimes nor different descs
+
+	// (re)creates the physical textures whose desc changed since the previous call (e.g. on resize)
+	const bool						Realize( RenderBackend* backend );
+	void							Execute() const;
+
+	const renderTarget_t*			GetTarget( const frameGraphResource_t resource ) const;
+
+private:
+	struct pass_t
+	{
+		const char*							name;
+		execute_t							execute;
+		std::vector<frameGraphResource_t>	reads;
+		std::vector<frameGraphResource_t>	writes;
+	};
+
+	struct resource_t
+	{
+		const char*				name;
+		frameGraphTargetDesc_t	desc;
+		bool					isPersistent;
+	};
+
+	struct physical_t
+	{
+		frameGraphTargetDesc_t	desc;
+		uint32_t				lastPass;
+		bool					isPersistent;
+	};
+
+	struct realizedTarget_t
+	{
+		frameGraphTargetDesc_t				desc;
+		std::unique_ptr<renderTarget_t>		target;
+	};
+
+private:
+	std::vector<pass_t>						passes;
+	std::vector<resource_t>					resources;
+
+	std::vector<frameGraphResourcePlan_t>	plan;		// by resource
+	std::vector<physical_t>					physicals;
+	std::vector<realizedTarget_t>			realized;	// by physical index
+	uint64_t								unaliasedSize;
+	uint64_t								aliasedSize;
+private:
+	const char*								GetPhysicalName( const uint32_t physicalIndex ) const; // for logs
+};
+
+const bool	Render_IsSameTargetDesc( const frameGraphTargetDesc_t& left, const frameGraphTargetDesc_t& right );
+uint64_t	Render_GetTargetSize( const frameGraphTargetDesc_t& desc ); // bytes, resolved desc
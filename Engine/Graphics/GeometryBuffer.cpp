@@ -0,0 +1,313 @@
+#include "Shared.h"
+#include "GeometryBuffer.h"
+#include "RenderContext.h"
+#include "RenderBackend.h"
+#include "Mesh.h"
+
+#include <unordered_map>
+
+namespace
+{
+	const bool CreateGeometryBuffer( const renderContext_t* context, const uint32_t size, const uint32_t bindFlags, renderBuffer_t** buffer )
+	{
+		const renderBufferDesc_t bufferDesc = {
+			size,																			// uint32_t			size
+			RENDER_USAGE_DEFAULT,															// renderUsage_t	usage
+			bindFlags,																		// uint32_t			bindFlags
+			0,																				// uint32_t			cpuAccessFlags
+			0,																				// uint32_t			miscFlags
+			0,																				// uint32_t			structureStride
+		};
+
+		*buffer = context->backend->CreateBuffer( bufferDesc, nullptr );
+
+		return *buffer != nullptr;
+	}
+
+	// the device is free threaded: staging buffers can be created by the loading threads
+	const bool CreateStagingBuffer( const renderContext_t* context, const DirectX::XMFLOAT3* positions, const vertexAttributes_t* attributes, const uint32_t vertexCount, const unsigned int* indices, const uint32_t indiceCount, renderBuffer_t** buffer )
+	{
+		const uint32_t	positionSize	= vertexCount * sizeof( DirectX::XMFLOAT3 ),
+						attributeSize	= vertexCount * sizeof( vertexAttributes_t ),
+						indiceSize		= indiceCount * sizeof( unsigned int );
+
+		std::vector<uint8_t> content( positionSize + attributeSize + indiceSize );
+		memcpy( content.data(), positions, positionSize );
+		memcpy( content.data() + positionSize, attributes, attributeSize );
+		memcpy( content.data() + positionSize + attributeSize, indices, indiceSize );
+
+		const renderBufferDesc_t stagingDesc = {
+			static_cast<uint32_t>( content.size() ),										// uint32_t			size
+			RENDER_USAGE_STAGING,															// renderUsage_t	usage
+			0,																				// uint32_t			bindFlags
+			RENDER_CPU_ACCESS_WRITE,														// uint32_t			cpuAccessFlags
+			0,																				// uint32_t			miscFlags
+			0,																				// uint32_t			structureStride
+		};
+
+		*buffer = context->backend->CreateBuffer( stagingDesc, content.data() );
+
+		return *buffer != nullptr;
+	}
+
+	void CopyStagedRange( const renderContext_t* context, renderBuffer_t* buffer, const uint32_t first, const uint32_t count, const uint32_t stride, renderBuffer_t* stagingBuffer, const uint32_t stagingOffset )
+	{
+		context->backend->CopyBufferRegion( buffer, first * stride, stagingBuffer, stagingOffset, count * stride );
+	}
+
+	// a buffer can't be both the source and the destination of overlapping copies: moves read from a snapshot
+	const bool CreateScratchCopy( const renderContext_t* context, renderBuffer_t* buffer, renderBuffer_t** scratchBuffer )
+	{
+		*scratchBuffer = context->backend->CreateBuffer( buffer->desc, nullptr );
+
+		if ( *scratchBuffer == nullptr ) {
+			return false;
+		}
+
+		context->backend->CopyResource( *scratchBuffer, buffer );
+
+		return true;
+	}
+
+	void CopyMoves( const renderContext_t* context, renderBuffer_t* buffer, renderBuffer_t* scratchBuffer, const std::vector<tlsfMove_t>& moves, const uint32_t stride )
+	{
+		for ( const tlsfMove_t& move : moves ) {
+			context->backend->CopyBufferRegion( buffer, move.to * stride, scratchBuffer, move.from * stride, move.size * stride );
+		}
+	}
+}
+
+GeometryBuffer::GeometryBuffer()
+	: positionBuffer( nullptr )
+	, attributeBuffer( nullptr )
+	, indiceBuffer( nullptr )
+	, hasHoles( false )
+	, hasRejected( false )
+{
+
+}
+
+const bool GeometryBuffer::Create( const renderContext_t* context, const uint32_t vertexCapacity, const uint32_t indiceCapacity )
+{
+	if ( !CreateGeometryBuffer( context, vertexCapacity * sizeof( DirectX::XMFLOAT3 ), RENDER_BIND_VERTEX_BUFFER, &positionBuffer )
+	  || !CreateGeometryBuffer( context, vertexCapacity * sizeof( vertexAttributes_t ), RENDER_BIND_VERTEX_BUFFER, &attributeBuffer )
+	  || !CreateGeometryBuffer( context, indiceCapacity * sizeof( unsigned int ), RENDER_BIND_INDEX_BUFFER, &indiceBuffer ) ) {
+		Destroy();
+		return false;
+	}
+
+	vertexAllocator.Initialize( vertexCapacity );
+	indiceAllocator.Initialize( indiceCapacity );
+
+	return true;
+}
+
+void GeometryBuffer::Destroy()
+{
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	RELEASE( positionBuffer )
+	RELEASE( attributeBuffer )
+	RELEASE( indiceBuffer )
+
+	vertexAllocator.Initialize( 0 );
+	indiceAllocator.Initialize( 0 );
+
+	for ( stagedUpload_t& stagedUpload : stagedUploads ) {
+		RELEASE( stagedUpload.stagingBuffer )
+	}
+
+	ranges.clear();
+	freeRanges.clear();
+	stagedUploads.clear();
+	hasHoles	= false;
+	hasRejected	= false;
+}
+
+geometryRange_t* GeometryBuffer::Allocate( const renderContext_t* context, const DirectX::XMFLOAT3* positions, const vertexAttributes_t* attributes, const uint32_t vertexCount, const unsigned int* indices, const uint32_t indiceCount )
+{
+	if ( positionBuffer == nullptr || vertexCount == 0 || indiceCount == 0 ) {
+		return nullptr;
+	}
+
+	// staged outside of the lock; wasted if the ranges do not fit
+	renderBuffer_t* stagingBuffer = nullptr;
+	if ( !CreateStagingBuffer( context, positions, attributes, vertexCount, indices, indiceCount, &stagingBuffer ) ) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock( rangeLock );
+
+	const uint32_t firstVertex	= vertexAllocator.Allocate( vertexCount ),
+			   firstIndex	= indiceAllocator.Allocate( indiceCount );
+
+	if ( firstVertex == TlsfAllocator::INVALID_OFFSET || firstIndex == TlsfAllocator::INVALID_OFFSET ) {
+		vertexAllocator.Free( firstVertex );
+		indiceAllocator.Free( firstIndex );
+
+		stagingBuffer->Release();
+
+		// the holes might add up to enough space; the ranges can't move while the frame may be recording, let Compact do it
+		hasRejected = hasHoles;
+		return nullptr;
+	}
+
+	geometryRange_t* range = nullptr;
+
+	if ( !freeRanges.empty() ) {
+		range = freeRanges.back();
+		freeRanges.pop_back();
+	} else {
+		ranges.emplace_back();
+		range = &ranges.back();
+	}
+
+	*range = { firstVertex, vertexCount, firstIndex, indiceCount, 1 };
+
+	stagedUploads.push_back( { range, stagingBuffer } );
+
+	return range;
+}
+
+void GeometryBuffer::Acquire( geometryRange_t* range )
+{
+	if ( range != nullptr ) {
+		std::lock_guard<std::mutex> lock( rangeLock );
+		range->refCount++;
+	}
+}
+
+void GeometryBuffer::Free( geometryRange_t* range )
+{
+	if ( range == nullptr ) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock( rangeLock );
+
+	if ( range->vertexCount == 0 || --range->refCount > 0 ) {
+		return;
+	}
+
+	vertexAllocator.Free( range->firstVertex );
+	indiceAllocator.Free( range->firstIndex );
+
+	// freed before the render thread got to it (e.g. a cancelled load)
+	for ( auto it = stagedUploads.begin(); it != stagedUploads.end(); ++it ) {
+		if ( it->range == range ) {
+			it->stagingBuffer->Release();
+			stagedUploads.erase( it );
+			break;
+		}
+	}
+
+	*range = {};
+	freeRanges.push_back( range );
+
+	hasHoles = true;
+}
+
+const geometryRange_t GeometryBuffer::GetRange( const geometryRange_t* range )
+{
+	std::lock_guard<std::mutex> lock( rangeLock );
+	return *range;
+}
+
+void GeometryBuffer::Upload( const renderContext_t* context )
+{
+	std::lock_guard<std::mutex> lock( rangeLock );
+
+	// offsets are read now: compactions done before the upload moved nothing but garbage
+	for ( const stagedUpload_t& stagedUpload : stagedUploads ) {
+		const geometryRange_t* range = stagedUpload.range;
+
+		const uint32_t positionSize		= range->vertexCount * sizeof( DirectX::XMFLOAT3 ),
+				   attributeSize	= range->vertexCount * sizeof( vertexAttributes_t );
+
+		CopyStagedRange( context, positionBuffer, range->firstVertex, range->vertexCount, sizeof( DirectX::XMFLOAT3 ), stagedUpload.stagingBuffer, 0 );
+		CopyStagedRange( context, attributeBuffer, range->firstVertex, range->vertexCount, sizeof( vertexAttributes_t ), stagedUpload.stagingBuffer, positionSize );
+		CopyStagedRange( context, indiceBuffer, range->firstIndex, range->indiceCount, sizeof( unsigned int ), stagedUpload.stagingBuffer, positionSize + attributeSize );
+
+		stagedUpload.stagingBuffer->Release();
+	}
+
+	stagedUploads.clear();
+}
+
+void GeometryBuffer::Compact( const renderContext_t* context, const float maxFragmentation )
+{
+	std::lock_guard<std::mutex> lock( rangeLock );
+
+	if ( !hasHoles ) {
+		return;
+	}
+
+	if ( !hasRejected && vertexAllocator.GetFragmentation() <= maxFragmentation && indiceAllocator.GetFragmentation() <= maxFragmentation ) {
+		return;
+	}
+
+	CompactLocked( context );
+}
+
+const bool GeometryBuffer::CompactLocked( const renderContext_t* context )
+{
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	// the snapshots are taken first: nothing moves if there is no memory left for them
+	renderBuffer_t* scratchBuffers[3] = { nullptr, nullptr, nullptr };
+
+	if ( !CreateScratchCopy( context, positionBuffer, &scratchBuffers[0] )
+	  || !CreateScratchCopy( context, attributeBuffer, &scratchBuffers[1] )
+	  || !CreateScratchCopy( context, indiceBuffer, &scratchBuffers[2] ) ) {
+		for ( renderBuffer_t*& scratchBuffer : scratchBuffers ) {
+			RELEASE( scratchBuffer )
+		}
+
+		return false;
+	}
+
+	std::vector<tlsfMove_t> vertexMoves, indiceMoves;
+
+	vertexAllocator.Defragment( vertexMoves );
+	indiceAllocator.Defragment( indiceMoves );
+
+	CopyMoves( context, positionBuffer, scratchBuffers[0], vertexMoves, sizeof( DirectX::XMFLOAT3 ) );
+	CopyMoves( context, attributeBuffer, scratchBuffers[1], vertexMoves, sizeof( vertexAttributes_t ) );
+	CopyMoves( context, indiceBuffer, scratchBuffers[2], indiceMoves, sizeof( unsigned int ) );
+
+	for ( renderBuffer_t*& scratchBuffer : scratchBuffers ) {
+		RELEASE( scratchBuffer )
+	}
+
+	hasHoles	= false;
+	hasRejected	= false;
+
+	// patch the live ranges; freed ones have no vertices
+	std::unordered_map<uint32_t, uint32_t> vertexOffsets, indiceOffsets;
+
+	for ( const tlsfMove_t& move : vertexMoves ) {
+		vertexOffsets[move.from] = move.to;
+	}
+
+	for ( const tlsfMove_t& move : indiceMoves ) {
+		indiceOffsets[move.from] = move.to;
+	}
+
+	for ( geometryRange_t& range : ranges ) {
+		if ( range.vertexCount == 0 ) {
+			continue;
+		}
+
+		const auto vertexOffset = vertexOffsets.find( range.firstVertex );
+		if ( vertexOffset != vertexOffsets.end() ) {
+			range.firstVertex = vertexOffset->second;
+		}
+
+		const auto indiceOffset = indiceOffsets.find( range.firstIndex );
+		if ( indiceOffset != indiceOffsets.end() ) {
+			range.firstIndex = indiceOffset->second;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <Engine/System/TlsfAllocator.h>
+
+#include "RenderTypes.h"
+
+namespace DirectX { struct XMFLOAT3; }
+
+struct renderContext_t;
+struct vertexAttributes_t;
+
+// vertices and indices of a mesh in the shared geometry buffers
+// indices are relative to firstVertex (drawn with it as base vertex); offsets change when the buffers are compacted
+struct geometryRange_t
+{
+	uint32_t	firstVertex;
+	uint32_t	vertexCount;
+	uint32_t	firstIndex;
+	uint32_t	indiceCount;
+	uint32_t	refCount;		// meshes sharing the range (copies)
+};
+
+// shared position, attribute and index buffers; meshes get ranges of them, so consecutive meshes draw without rebinding the input assembler
+// vertices (both streams) and indices are sub-allocated by their own tlsf allocator
+// allocations can come from any thread (e.g. the streaming one): their content is staged and copied by the render thread (see Upload)
+// freeing a range leaves a hole; once the holes make up enough of the free space, Compact packs the ranges
+// again on the gpu (through a scratch copy) and patches them in place: meshes keep their range pointer
+class GeometryBuffer
+{
+public:
+	inline renderBuffer_t*			GetPositionBuffer() const	{ return positionBuffer; }
+	inline renderBuffer_t*			GetAttributeBuffer() const	{ return attributeBuffer; }
+	inline renderBuffer_t*			GetIndiceBuffer() const		{ return indiceBuffer; }
+	inline const TlsfAllocator&		GetVertexAllocator() const	{ return vertexAllocator; }
+	inline const TlsfAllocator&		GetIndiceAllocator() const	{ return indiceAllocator; }
+
+public:
+									GeometryBuffer();
+									GeometryBuffer( GeometryBuffer& ) = delete;
+									~GeometryBuffer() = default;
+
+	const bool						Create( const renderContext_t* context, const uint32_t vertexCapacity, const uint32_t indiceCapacity );
+	void							Destroy();
+
+	// the content is copied to a staging buffer; null if the geometry does not fit (the caller creates buffers of its own)
+	// never moves other ranges: the space left in the holes is only reclaimed by the next Compact
+	geometryRange_t*				Allocate( const renderContext_t* context, const DirectX::XMFLOAT3* positions, const vertexAttributes_t* attributes, const uint32_t vertexCount, const unsigned int* indices, const uint32_t indiceCount );
+	void							Acquire( geometryRange_t* range );
+	void							Free( geometryRange_t* range ); // the range is freed with its last reference
+	const geometryRange_t			GetRange( const geometryRange_t* range ); // copy of the offsets, consistent with a concurrent Compact
+
+	// copies the staged allocations to their ranges; render thread, at the start of a frame (before Compact and any draw)
+	void							Upload( const renderContext_t* context );
+
+	// packs the ranges if the holes left by frees (e.g. unloaded areas) fragment the free space past maxFragmentation
+	// (or if an allocation was rejected while the holes would have had room for it)
+	// must run between frames: draws read their range offsets while recording
+	void							Compact( const renderContext_t* context, const float maxFragmentation );
+
+private:
+	// the three streams of an allocation, back to back (positions, attributes, indices)
+	struct stagedUpload_t
+	{
+		geometryRange_t*			range;
+		renderBuffer_t*				stagingBuffer;
+	};
+
+private:
+	renderBuffer_t*					positionBuffer;
+	renderBuffer_t*					attributeBuffer;
+	renderBuffer_t*					indiceBuffer;
+
+	std::mutex						rangeLock;
+	TlsfAllocator					vertexAllocator;	// in vertices
+	TlsfAllocator					indiceAllocator;	// in indices
+	std::deque<geometryRange_t>		ranges;				// stable addresses
+	std::vector<geometryRange_t*>	freeRanges;
+	std::vector<stagedUpload_t>		stagedUploads;
+	bool							hasHoles;			// something was freed since the last compaction
+	bool							hasRejected;		// an allocation did not fit since the last compaction
+
+private:
+	const bool						CompactLocked( const renderContext_t* context );
+};
@@ -0,0 +1,110 @@
+#include "Shared.h"
+#include "GpuTimer.h"
+#include "RenderContext.h"
+#include "RenderBackend.h"
+
+GpuTimer::GpuTimer()
+	: frames{}
+	, beginCount( 0 )
+	, readCount( 0 )
+	, isMeasuring( false )
+{
+
+}
+
+const bool GpuTimer::Create( const renderContext_t* context )
+{
+	RenderBackend* backend = context->backend;
+
+	for ( frameQueries_t& frame : frames ) {
+		frame.disjoint	= backend->CreateQuery( RENDER_QUERY_TIMESTAMP_DISJOINT );
+		frame.begin		= backend->CreateQuery( RENDER_QUERY_TIMESTAMP );
+		frame.end		= backend->CreateQuery( RENDER_QUERY_TIMESTAMP );
+
+		if ( frame.disjoint == nullptr || frame.begin == nullptr || frame.end == nullptr ) {
+			Destroy();
+			return false;
+		}
+	}
+
+	beginCount	= 0;
+	readCount	= 0;
+	isMeasuring	= false;
+
+	return true;
+}
+
+void GpuTimer::Destroy()
+{
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	for ( frameQueries_t& frame : frames ) {
+		RELEASE( frame.disjoint )
+		RELEASE( frame.begin )
+		RELEASE( frame.end )
+	}
+
+	beginCount	= 0;
+	readCount	= 0;
+	isMeasuring	= false;
+}
+
+void GpuTimer::Begin( RenderBackend* backend )
+{
+	// every query set in flight (or not created): this frame goes unmeasured
+	if ( beginCount - readCount >= FRAME_COUNT || frames[0].disjoint == nullptr ) {
+		return;
+	}
+
+	const frameQueries_t& frame = frames[beginCount % FRAME_COUNT];
+
+	backend->BeginQuery( frame.disjoint );
+	backend->EndQuery( frame.begin );
+
+	isMeasuring = true;
+}
+
+void GpuTimer::End( RenderBackend* backend )
+{
+	if ( !isMeasuring ) {
+		return;
+	}
+
+	const frameQueries_t& frame = frames[beginCount % FRAME_COUNT];
+
+	backend->EndQuery( frame.end );
+	backend->EndQuery( frame.disjoint );
+
+	beginCount++;
+	isMeasuring = false;
+}
+
+const bool GpuTimer::Poll( RenderBackend* backend, double& frameTime )
+{
+	while ( readCount != beginCount ) {
+		const frameQueries_t& frame = frames[readCount % FRAME_COUNT];
+
+		renderQueryTimestampDisjoint_t disjointData = {};
+
+		// ended last: once it is available, so are the timestamps
+		if ( !backend->GetQueryData( frame.disjoint, &disjointData, sizeof( disjointData ) ) ) {
+			return false;
+		}
+
+		readCount++;
+
+		uint64_t beginTime = 0, endTime = 0;
+
+		if ( disjointData.disjoint
+		  || !backend->GetQueryData( frame.begin, &beginTime, sizeof( uint64_t ) )
+		  || !backend->GetQueryData( frame.end, &endTime, sizeof( uint64_t ) ) ) {
+			continue;
+		}
+
+		frameTime = static_cast<double>( endTime - beginTime ) * 1000.0 / static_cast<double>( disjointData.frequency );
+
+		return true;
+	}
+
+	return false;
+}
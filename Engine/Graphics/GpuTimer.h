@@ -0,0 +1,42 @@
+#pragma once
+
+#include "RenderTypes.h"
+
+class RenderBackend;
+struct renderContext_t;
+
+// gpu duration of frames, measured with timestamp queries on the immediate backend
+// results are read back a few frames later and never flush; a frame is not measured if every query set is still in flight
+class GpuTimer
+{
+public:
+						GpuTimer();
+						GpuTimer( GpuTimer& ) = delete;
+						~GpuTimer() = default;
+
+	const bool			Create( const renderContext_t* context );
+	void				Destroy();
+
+	void				Begin( RenderBackend* backend );
+	void				End( RenderBackend* backend );
+
+	// oldest measured frame not read yet; false if it is still in flight (or if none is pending)
+	// frames measured while the gpu clock changed are dropped
+	const bool			Poll( RenderBackend* backend, double& frameTime );
+
+private:
+	static constexpr uint32_t	FRAME_COUNT = 4;
+
+	struct frameQueries_t
+	{
+		renderQuery_t*	disjoint;
+		renderQuery_t*	begin;
+		renderQuery_t*	end;
+	};
+
+private:
+	frameQueries_t		frames[FRAME_COUNT];
+	uint32_t			beginCount;		// frames begun (and ended)
+	uint32_t			readCount;		// frames read back
+	bool				isMeasuring;	// between Begin and End
+};
@@ -1,51 +1,47 @@
 #include "Shared.h"
 #include "LightManager.h"
 #include "RenderContext.h"
+#include "RenderSnapshot.h"
 
-#include <Engine/Game/World.h>
+#include <algorithm>
 
-bool LightManager::Initialize( const renderContext_t* context )
+bool LightManager::Initialize()
 {
-	Render_CreateCBuffer( context, cbuffer, sizeof( lightManData_t ) );
-	Render_UploadCBuffer( context, cbuffer, &lightManData_t, sizeof( lightManData_t ) );
-
-	context->deviceContext->PSSetConstantBuffers( 3, 1, &cbuffer );
+	memset( &lightManData_t, 0, sizeof( lightManData_t ) );
 
 	return true;
 }
 
-void LightManager::Update( const renderContext_t* context, const worldArea_t* activeArea, const bool isNight )
+cbufferSlice_t LightManager::Update( CBufferRing* cbufferRing, const renderSnapshot_t* snapshot, const bool isNight )
 {
 	memset( &lightManData_t, 0, sizeof( lightManData_t ) ); // TODO: flushing the cbuffer each time isnt a great idea... a partital rebuild would be nice in the future
 
-	IterateScene( activeArea->nodes );
+	// the cbuffer has a fixed amount of slots per light type
+	constexpr std::size_t MAX_LIGHT_COUNT = 12;
 
-	lightManData_t.lightTypeCount.w = ( isNight ) ? 1.0f : 3.0f;
+	const std::size_t sphereLightCount	= std::min( snapshot->sphereLights.size(), MAX_LIGHT_COUNT ),
+					  diskLightCount	= std::min( snapshot->diskLights.size(), MAX_LIGHT_COUNT ),
+					  rectLightCount	= std::min( snapshot->rectangleLights.size(), MAX_LIGHT_COUNT );
 
-	// update cbuffer data
-	Render_UploadCBuffer( context, cbuffer, &lightManData_t, sizeof( lightManData_t ) );
-}
+	std::copy( snapshot->sphereLights.begin(), snapshot->sphereLights.begin() + sphereLightCount, lightManData_t.sphereAreaLights );
+	std::copy( snapshot->diskLights.begin(), snapshot->diskLights.begin() + diskLightCount, lightManData_t.diskAreaLights );
+	std::copy( snapshot->rectangleLights.begin(), snapshot->rectangleLights.begin() + rectLightCount, lightManData_t.rectAreaLights );
 
-void LightManager::IterateScene( areaNode_t* curNode )
-{
-	for ( areaNode_t* node : curNode->children ) {
-		if ( node->flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
-			lightManData_t.diskAreaLights[lightManData_t.lightTypeCount.y++] = *static_cast<diskAreaLight_t*>( node->content );
-		} else if ( node->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
-			lightManData_t.sphereAreaLights[lightManData_t.lightTypeCount.x++] = *static_cast<sphereAreaLight_t*>( node->content );
-		} else if ( node->flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
-			lightManData_t.rectAreaLights[lightManData_t.lightTypeCount.z++] = *static_cast<rectangleAreaLight_t*>( node->content );
-		} else if ( node->flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
-			SetSun( *static_cast<sunLight_t*>( node->content ) );
-		}
-
-		if ( node->children.size() > 0 ) {
-			IterateScene( node );
-		}
+	lightManData_t.lightTypeCount.x = static_cast<int>( sphereLightCount );
+	lightManData_t.lightTypeCount.y = static_cast<int>( diskLightCount );
+	lightManData_t.lightTypeCount.z = static_cast<int>( rectLightCount );
+
+	if ( snapshot->hasSun ) {
+		SetSun( snapshot->sun );
 	}
+
+	lightManData_t.lightTypeCount.w = ( isNight ) ? 1.0f : 3.0f;
+
+	// update cbuffer data
+	return cbufferRing->Upload( &lightManData_t, sizeof( lightManData_t ) );
 }
 
-void LightManager::SetSun( const sunLight_t& sunInfos )
+void LightManager::SetSun( const renderSun_t& sunInfos )
 {
 	// compute sun direction from spherical coordinates
 	const float vAngle = asin( sunInfos.sphericalThetaGammaAndPADDING.y );
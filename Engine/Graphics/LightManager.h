@@ -2,7 +2,7 @@
 
 struct renderContext_t;
 
-#include "CBuffer.h"
+#include "CBufferRing.h"
 #include "RenderContext.h"
 #include "Texture.h"
 #include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
@@ -45,18 +45,21 @@ struct sunLight_t // CPU struct required to generate GPU data
 	renderTarget_t		cascadeAtlas;
 };
 
-struct worldArea_t;
-struct areaNode_t;
+struct renderSnapshot_t;
+struct renderSun_t;
 
 class LightManager
 {
+public:
+	static inline uint32_t	GetCBufferSize() { return sizeof( LightCBuffer_t ); }
+
 public:
 			LightManager()					= default;
 			LightManager( LightManager& )	= delete;
 			~LightManager()					= default;
 
-	bool	Initialize( const renderContext_t* context );
-	void	Update( const renderContext_t* context, const worldArea_t* activeArea, const bool isNight ); // only called on world update; no need to update it per frame!
+	bool			Initialize();
+	cbufferSlice_t	Update( CBufferRing* cbufferRing, const renderSnapshot_t* snapshot, const bool isNight ); // the slice is bound to PS slot 3 by the caller
 
 private:
 	struct LightCBuffer_t
@@ -71,9 +74,6 @@ private:
 		rectangleAreaLight_t rectAreaLights[12];
 	} lightManData_t;
 
-	CBuffer cbuffer;
-
 private:
-	void	SetSun( const sunLight_t& sunInfos );
-	void	IterateScene( areaNode_t* curNode );
+	void	SetSun( const renderSun_t& sunInfos );
 };
@@ -1,12 +1,14 @@
 #include "Shared.h"
-#include <d3d11.h>
 #include "Texture.h"
 #include "Material.h"
 #include "RenderContext.h"
+#include "RenderBackend.h"
 #include "CBuffer.h"
+#include "StateCache.h"
+#include "ShaderLibrary.h"
+#include "ReleaseQueue.h"
 
 #include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
-#include <Engine/ThirdParty/DirectXTK/Inc/DDSTextureLoader.h>
 #include <Engine/Io/DictionaryReader.h>
 
 #include <cctype>
@@ -26,6 +28,7 @@ material_t* MaterialManager::GetMaterial( const char* matPath )
 	auto it = content.find( matHashcode );
 
 	if ( it != content.end() ) {
+		it->second->refCount++;
 		return it->second.get();
 	}
 
@@ -39,32 +42,81 @@ material_t* MaterialManager::GetMaterial( const char* matPath )
 		return nullptr;
 	}
 
+	content[matHashcode]->sortId	= nextSortId++;
+	content[matHashcode]->hashcode	= matHashcode;
+	content[matHashcode]->refCount	= 1;
+
 	return content[matHashcode].get();
 }
 
-void Render_BindUIMaterial( ID3D11DeviceContext* devContext, const material_t* mat )
+void MaterialManager::AcquireMaterial( material_t* material )
 {
-	devContext->PSSetShaderResources( 0, 1, &mat->albedo->view );
-	devContext->PSSetConstantBuffers( 1, 1, &mat->cbuffer );
+	if ( material != nullptr ) {
+		material->refCount++;
+	}
 }
 
-void Render_BindOpaqueMaterial( ID3D11DeviceContext* devContext, const material_t* mat )
+void MaterialManager::ReleaseMaterial( material_t* material )
 {
-	if ( mat->albedo != nullptr ) devContext->PSSetShaderResources( 0, 1, &mat->albedo->view );
-	if ( mat->normal != nullptr ) devContext->PSSetShaderResources( 1, 1, &mat->normal->view );
-	if ( mat->ambientOcclusion != nullptr ) devContext->PSSetShaderResources( 2, 1, &mat->ambientOcclusion->view );
-	if ( mat->metalness != nullptr ) devContext->PSSetShaderResources( 3, 1, &mat->metalness->view );
-	if ( mat->roughness != nullptr ) devContext->PSSetShaderResources( 4, 1, &mat->roughness->view );
-	if ( mat->alpha != nullptr ) devContext->PSSetShaderResources( 9, 1, &mat->alpha->view );
-
-	devContext->PSSetConstantBuffers( 1, 1, &mat->cbuffer );
+	if ( material == nullptr || --material->refCount > 0 ) {
+		return;
+	}
+
+	auto it = content.find( material->hashcode );
+
+	if ( it == content.end() || it->second.get() != material ) {
+		return;
+	}
+
+	material_t* releasedMaterial = it->second.release();
+	content.erase( it );
+
+	// snapshots in flight might still draw with it
+	const renderContext_t* context = renderContext;
+	TextureManager* texMan = textureManager;
+
+	Render_QueueRelease( context, [context, texMan, releasedMaterial]() {
+		Render_ReleaseMaterial( context, texMan, releasedMaterial );
+		delete releasedMaterial;
+	} );
 }
 
-void Render_BindAlphaTestedMaterial( ID3D11DeviceContext* devContext, const material_t* mat )
+void Render_BindUIMaterial( RenderBackend* backend, const material_t* mat )
 {
-	Render_BindOpaqueMaterial( devContext, mat );
+	backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &mat->albedo->view );
+	backend->SetConstantBuffers( RENDER_STAGE_PIXEL, 1, 1, &mat->cbuffer );
+}
 
-	if ( mat->alpha != nullptr ) devContext->PSSetShaderResources( 5, 1, &mat->alpha->view );
+void Render_BindOpaqueMaterial( RenderBackend* backend, const material_t* mat )
+{
+	if ( mat->albedo != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &mat->albedo->view );
+	if ( mat->normal != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 1, 1, &mat->normal->view );
+	if ( mat->ambientOcclusion != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 2, 1, &mat->ambientOcclusion->view );
+	if ( mat->metalness != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 3, 1, &mat->metalness->view );
+	if ( mat->roughness != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 4, 1, &mat->roughness->view );
+	if ( mat->alpha != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 9, 1, &mat->alpha->view );
+
+	backend->SetConstantBuffers( RENDER_STAGE_PIXEL, 1, 1, &mat->cbuffer );
+}
+
+void Render_BindOpaqueMaterial( StateCache* stateCache, const material_t* mat )
+{
+	// slots 0-4 are coalesced by the cache; unchanged textures are not rebound
+	if ( mat->albedo != nullptr ) stateCache->SetPSShaderResource( 0, mat->albedo->view );
+	if ( mat->normal != nullptr ) stateCache->SetPSShaderResource( 1, mat->normal->view );
+	if ( mat->ambientOcclusion != nullptr ) stateCache->SetPSShaderResource( 2, mat->ambientOcclusion->view );
+	if ( mat->metalness != nullptr ) stateCache->SetPSShaderResource( 3, mat->metalness->view );
+	if ( mat->roughness != nullptr ) stateCache->SetPSShaderResource( 4, mat->roughness->view );
+	if ( mat->alpha != nullptr ) stateCache->SetPSShaderResource( 9, mat->alpha->view );
+
+	stateCache->SetPSConstantBuffer( 1, mat->cbuffer );
+}
+
+void Render_BindAlphaTestedMaterial( RenderBackend* backend, const material_t* mat )
+{
+	Render_BindOpaqueMaterial( backend, mat );
+
+	if ( mat->alpha != nullptr ) backend->SetShaderResources( RENDER_STAGE_PIXEL, 5, 1, &mat->alpha->view );
 }
 
 namespace
@@ -136,6 +188,11 @@ namespace
 	}
 }
 
+uint32_t Render_GetShaderPermutation( const material_t* mat )
+{
+	return ( mat->surfType == SURF_OPAQUE ) ? ( mat->colorData.flags & MAT_PERMUTATION_FLAGS_MASK ) : 0;
+}
+
 int Render_CreateMaterialFromFile( const renderContext_t* context, TextureManager* texMan, material_t* mat, const char* fileName )
 {
 	dictionary_t dico = {};
@@ -189,18 +246,24 @@ int Render_CreateMaterialFromFile( const renderContext_t* context, TextureManage
 	Render_CreateCBuffer( context, mat->cbuffer, sizeof( mat->colorData ) );
 	Render_UploadCBuffer( context, mat->cbuffer, &mat->colorData, sizeof( mat->colorData ) );
 
+	// materials sharing flags share the permutation; compiled (or read from the disk cache) on first use
+	if ( mat->surfType == SURF_OPAQUE && context->shaders != nullptr ) {
+		mat->pixelShader = context->shaders->GetPixelShaderPermutation( L"opaque_ps.hlsl", Render_GetShaderPermutation( mat ) );
+	}
+
 	return 0;
 }
 
-void Render_ReleaseMaterial( material_t* mat )
+void Render_ReleaseMaterial( const renderContext_t* context, TextureManager* texMan, material_t* mat )
 {
-	#define MAT_RELEASE( obj ) if ( obj != nullptr ) { delete obj; obj = nullptr; }
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	for ( texture_t* texture : { mat->albedo, mat->normal, mat->ambientOcclusion, mat->metalness, mat->roughness, mat->alpha } ) {
+		texMan->ReleaseTexture( context, texture );
+	}
 
-	//MAT_RELEASE( mat->albedo )
-	//MAT_RELEASE( mat->normal )
-	//MAT_RELEASE( mat->ambientOcclusion )
-	//MAT_RELEASE( mat->metalness )
-	//MAT_RELEASE( mat->roughness )
+	RELEASE( mat->cbuffer )
 
+	// the permutation is owned by the shader library
 	memset( mat, 0, sizeof( material_t ) );
 }
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
+#include "RenderTypes.h"
 
 #include <memory>
 #include <map>
 
 struct texture_t;
+class TextureManager;
 struct renderContext_t;
+class StateCache;
+class RenderBackend;
 
 enum surfType_t
 {
@@ -33,9 +37,13 @@ enum matFlag_t
 
 using matFlags_t = unsigned int;
 
+// flags resolved at shader compile time (all of them for now); see opaque_ps.hlsl
+constexpr matFlags_t MAT_PERMUTATION_FLAGS_MASK = 0x7F;
+
 struct material_t
 {
 	surfType_t	surfType;			// 4
+	uint32_t	sortId;				// 4 // assigned by the material manager; see Render_BuildSortKey
 
 	texture_t*	albedo;				// 8
 	texture_t*	normal;				// 8
@@ -44,7 +52,8 @@ struct material_t
 	texture_t*	roughness;			// 8
 	texture_t*	alpha;				// 8
 
-	ID3D11Buffer*	cbuffer;
+	renderBuffer_t*			cbuffer;
+	renderPixelShader_t*	pixelShader;	// permutation for the material flags; null uses the generic shader of the surface
 
 	struct {
 		DirectX::XMFLOAT3	diffuseColor;
@@ -52,12 +61,18 @@ struct material_t
 		DirectX::XMFLOAT3	reflectivity;
 		matFlags_t			flags;
 	} colorData;
+
+	uint64_t	hashcode;			// path hash; key in the material manager
+	int32_t		refCount;			// see MaterialManager
 };
 
+// materials are shared and counted: every GetMaterial (or AcquireMaterial) must be matched by a ReleaseMaterial; the last
+// release removes the material from the cache and queues its destruction (see ReleaseQueue), textures included
+// main thread only
 class MaterialManager
 {
 public:
-	inline void	Flush() { content.clear(); }
+	inline void	Flush() { content.clear(); } // drops every material; shutdown only
 
 public:
 	MaterialManager() = default;
@@ -65,18 +80,22 @@ public:
 	~MaterialManager() = default;
 
 	void		Initialize( const renderContext_t* context, TextureManager* texMan );
-	material_t*	GetMaterial( const char* matPath );
+	material_t*	GetMaterial( const char* matPath ); // acquired; null if the file can't be loaded
+	void		AcquireMaterial( material_t* material );
+	void		ReleaseMaterial( material_t* material );
 
 private:
 	std::map<uint64_t, std::unique_ptr<material_t>> content;
 
 	const renderContext_t*  renderContext;
 	TextureManager*			textureManager;
+	uint32_t				nextSortId = 1;
 };
 
 // static_assert( sizeof( material_t ) == 56, "material_t is NOT cache friendly" );
 
-void	Render_BindOpaqueMaterial( ID3D11DeviceContext* devContext, const material_t* mat );
-void	Render_BindOpaqueMaterial( ID3D11DeviceContext* devContext, const material_t* mesh );
+void	Render_BindOpaqueMaterial( RenderBackend* backend, const material_t* mat );
+void	Render_BindOpaqueMaterial( StateCache* stateCache, const material_t* mat );
+uint32_t	Render_GetShaderPermutation( const material_t* mat ); // also the shader field of the sort key
 int		Render_CreateMaterialFromFile( const renderContext_t* context, TextureManager* texMan, material_t* mat, const char* fileName );
-void	Render_ReleaseMaterial( material_t* mat );
+void	Render_ReleaseMaterial( const renderContext_t* context, TextureManager* texMan, material_t* mat );
@@ -1,14 +1,17 @@
 #include "Shared.h"
-#include <d3d11.h>
 #include "Mesh.h"
 
 #include "RenderContext.h"
+#include "RenderBackend.h"
+#include "StateCache.h"
+#include "ReleaseQueue.h"
 
 #include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
 #include <Engine/Io/SmallGeometryFileReader.h>
 #include <Engine/Graphics/Texture.h>
 #include <Engine/Graphics/Material.h>
 
+// interleaved layout of the geometry files; split into the mesh streams at load
 struct defaultVertexLayout_t
 {
 	DirectX::XMFLOAT3 position;
@@ -18,60 +21,101 @@ struct defaultVertexLayout_t
 	DirectX::XMFLOAT3 bitangent;
 };
 
-void Render_BindMesh( const renderContext_t* context, mesh_t* mesh )
+namespace
 {
-	unsigned int stride = sizeof( defaultVertexLayout_t );
-	unsigned int offset = 0;
+	const bool CreateImmutableBuffer( const renderContext_t* context, const void* content, const uint32_t size, const uint32_t bindFlags, renderBuffer_t** buffer )
+	{
+		const renderBufferDesc_t bufferDesc = {
+			size,																			// uint32_t			size
+			RENDER_USAGE_DEFAULT,															// renderUsage_t	usage
+			bindFlags,																		// uint32_t			bindFlags
+			0,																				// uint32_t			cpuAccessFlags
+			0,																				// uint32_t			miscFlags
+			0,																				// uint32_t			structureStride
+		};
+
+		*buffer = context->backend->CreateBuffer( bufferDesc, content );
+
+		return *buffer != nullptr;
+	}
+}
+
+void Render_BindMesh( const renderContext_t* context, const mesh_t* mesh )
+{
+	context->stateCache->SetVertexBuffer( mesh->positionBuffer, sizeof( DirectX::XMFLOAT3 ), 0 );
+	context->stateCache->SetAttributeBuffer( mesh->attributeBuffer, sizeof( vertexAttributes_t ), 0 );
+	context->stateCache->SetIndexBuffer( mesh->indiceBuffer, RENDER_FORMAT_R32_UINT, 0 );
+	context->stateCache->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+}
 
-	context->deviceContext->IASetVertexBuffers( 0, 1, &mesh->vertexBuffer, &stride, &offset );
-	context->deviceContext->IASetIndexBuffer( mesh->indiceBuffer, DXGI_FORMAT_R32_UINT, 0 );
-	context->deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+void Render_BindMeshPositions( const renderContext_t* context, const mesh_t* mesh )
+{
+	// whatever is bound on the attribute slot is ignored by position only layouts
+	context->stateCache->SetVertexBuffer( mesh->positionBuffer, sizeof( DirectX::XMFLOAT3 ), 0 );
+	context->stateCache->SetIndexBuffer( mesh->indiceBuffer, RENDER_FORMAT_R32_UINT, 0 );
+	context->stateCache->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+}
+
+int Render_CreateMeshBuffers( const renderContext_t* context, mesh_t* mesh, const DirectX::XMFLOAT3* positions, const vertexAttributes_t* attributes, const unsigned int vertexCount, const unsigned int* indices, const unsigned int indiceCount )
+{
+	mesh->vertexCount = vertexCount;
+	mesh->indiceCount = indiceCount;
+
+	mesh->geometryRange = context->geometry->Allocate( context, positions, attributes, vertexCount, indices, indiceCount );
+
+	if ( mesh->geometryRange != nullptr ) {
+		mesh->positionBuffer	= context->geometry->GetPositionBuffer();
+		mesh->attributeBuffer	= context->geometry->GetAttributeBuffer();
+		mesh->indiceBuffer		= context->geometry->GetIndiceBuffer();
+		return 0;
+	}
+
+	// too large for what is left of the shared buffers
+	if ( !CreateImmutableBuffer( context, positions, vertexCount * sizeof( DirectX::XMFLOAT3 ), RENDER_BIND_VERTEX_BUFFER, &mesh->positionBuffer ) ) {
+		return 1;
+	}
+
+	if ( !CreateImmutableBuffer( context, attributes, vertexCount * sizeof( vertexAttributes_t ), RENDER_BIND_VERTEX_BUFFER, &mesh->attributeBuffer ) ) {
+		return 1;
+	}
+
+	if ( !CreateImmutableBuffer( context, indices, indiceCount * sizeof( unsigned int ), RENDER_BIND_INDEX_BUFFER, &mesh->indiceBuffer ) ) {
+		return 2;
+	}
+
+	return 0;
 }
 
 int Render_CreateMeshFromFile( const renderContext_t* context, MaterialManager* matMan, mesh_t* mesh, const char* fileName )
 {
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	
 	mesh_load_data_t data = {};
 	if ( Io_ReadSmallGeometryFile( fileName, data ) != 0 ) {
 		return 1;
 	}
 
-	vertexBufferDesc.Usage					= D3D11_USAGE_DEFAULT;
-	vertexBufferDesc.ByteWidth				= data.vboSize;
-	vertexBufferDesc.BindFlags				= D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags			= 0;
-	vertexBufferDesc.MiscFlags				= 0;
-	vertexBufferDesc.StructureByteStride	= 0;
+	// split the interleaved vertices into the position and attribute streams
+	const uint32_t vertexCount = data.vboSize / sizeof( defaultVertexLayout_t );
+	const defaultVertexLayout_t* vertices = reinterpret_cast<const defaultVertexLayout_t*>( data.vbo );
 
-	vertexData.pSysMem			= data.vbo;
-	vertexData.SysMemPitch		= 0;
-	vertexData.SysMemSlicePitch = 0;
+	std::vector<DirectX::XMFLOAT3> positions( vertexCount );
+	std::vector<vertexAttributes_t> attributes( vertexCount );
 
-	if ( FAILED( context->device->CreateBuffer( &vertexBufferDesc, &vertexData, &mesh->vertexBuffer ) ) ) {
-		return 2;
+	for ( uint32_t i = 0; i < vertexCount; ++i ) {
+		positions[i] = vertices[i].position;
+		attributes[i] = { vertices[i].normal, vertices[i].uvCoord, vertices[i].tangent, vertices[i].bitangent };
 	}
 
-	indexBufferDesc.Usage				= D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth			= data.iboSize;
-	indexBufferDesc.BindFlags			= D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags		= 0;
-	indexBufferDesc.MiscFlags			= 0;
-	indexBufferDesc.StructureByteStride	= 0;
-
-	indexData.pSysMem			= data.ibo;
-	indexData.SysMemPitch		= 0;
-	indexData.SysMemSlicePitch	= 0;
+	const int bufferStatus = Render_CreateMeshBuffers( context, mesh, positions.data(), attributes.data(), vertexCount, reinterpret_cast<const unsigned int*>( data.ibo ), data.iboSize / sizeof( unsigned int ) );
+	if ( bufferStatus != 0 ) {
+		return 1 + bufferStatus;
+	}
 
-	if ( FAILED( context->device->CreateBuffer( &indexBufferDesc, &indexData, &mesh->indiceBuffer ) ) ) {
-		return 3;
+	if ( mesh->transformation == nullptr ) {
+		mesh->transformation = new transform_t(); // not owned by a world area
 	}
 
-	mesh->indiceCount = data.iboSize / sizeof( unsigned int );
-	mesh->vertexCount = data.vboSize / sizeof( defaultVertexLayout_t );
+	mesh->fileName = fileName; // saved with the world areas (see Io_WriteAreaFile)
 
-	mesh->transformation = new transform_t();
 	mesh->transformation->modelMatrix = DirectX::XMMatrixIdentity();
 	DirectX::BoundingSphere::CreateFromPoints( mesh->transformation->boundingSphere, mesh->indiceCount, ( DirectX::XMFLOAT3* )data.vbo, sizeof( defaultVertexLayout_t ) );
 
@@ -83,8 +127,11 @@ int Render_CreateMeshFromFile( const renderContext_t* context, MaterialManager*
 			continue; // cant load material (incomplete or smthing like that)
 		}
 
+		// one reference per submesh
 		for ( submeshEntry_t& sme : data.submeshesToLoad ) {
 			if ( sme.matHashcode == matToLoad.first ) {
+				matMan->AcquireMaterial( mat );
+
 				submesh_t subMesh = {
 					mat,
 					new transform_t(),
@@ -101,6 +148,8 @@ int Render_CreateMeshFromFile( const renderContext_t* context, MaterialManager*
 				mesh->subMeshes.push_back( subMesh );
 			}
 		}
+
+		matMan->ReleaseMaterial( mat );
 	}
 
 	delete data.vbo;
@@ -109,12 +158,55 @@ int Render_CreateMeshFromFile( const renderContext_t* context, MaterialManager*
 	return 0;
 }
 
-void Render_ReleaseMesh( mesh_t* mesh )
+void Render_AcquireMesh( const renderContext_t* context, MaterialManager* matMan, const mesh_t* mesh )
+{
+	if ( mesh->geometryRange != nullptr ) {
+		context->geometry->Acquire( mesh->geometryRange );
+	} else {
+		for ( renderBuffer_t* buffer : { mesh->positionBuffer, mesh->attributeBuffer, mesh->indiceBuffer } ) {
+			if ( buffer != nullptr ) {
+				buffer->AddRef();
+			}
+		}
+	}
+
+	for ( const submesh_t& subMesh : mesh->subMeshes ) {
+		matMan->AcquireMaterial( subMesh.material );
+	}
+}
+
+void Render_ReleaseMesh( const renderContext_t* context, MaterialManager* matMan, mesh_t* mesh )
 {
-	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+	for ( const submesh_t& subMesh : mesh->subMeshes ) {
+		matMan->ReleaseMaterial( subMesh.material );
+	}
+
+	// snapshots in flight might still draw the mesh; the range could be handed to another mesh (or compacted) meanwhile
+	GeometryBuffer* geometry = context->geometry;
+	geometryRange_t* geometryRange = mesh->geometryRange;
+	renderBuffer_t* buffers[3] = { mesh->positionBuffer, mesh->attributeBuffer, mesh->indiceBuffer };
 
-	RELEASE( mesh->vertexBuffer )
-	RELEASE( mesh->indiceBuffer )
+	Render_QueueRelease( context, [geometry, geometryRange, buffers]() {
+		if ( geometryRange != nullptr ) {
+			geometry->Free( geometryRange );
+			return;
+		}
 
-	memset( mesh, 0, sizeof( mesh_t ) );
+		for ( renderBuffer_t* buffer : buffers ) {
+			if ( buffer != nullptr ) {
+				buffer->Release();
+			}
+		}
+	} );
+
+	// the transform belongs to whoever allocated the mesh (e.g. the area pools; see World::FreeContent)
+	mesh->positionBuffer	= nullptr;
+	mesh->attributeBuffer	= nullptr;
+	mesh->indiceBuffer		= nullptr;
+	mesh->geometryRange		= nullptr;
+	mesh->vertexCount		= 0;
+	mesh->indiceCount		= 0;
+
+	mesh->subMeshes.clear();
+	mesh->pieces.clear();
 }
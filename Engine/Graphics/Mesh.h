@@ -5,7 +5,9 @@ struct renderContext_t;
 class TextureManager;
 
 #include "Material.h"
+#include "GeometryBuffer.h"
 #include <vector>
+#include <string>
 
 struct transform_t 
 {
@@ -29,10 +31,33 @@ struct submesh_t
 	unsigned int		__PADDING__;	// 4
 };
 
+// slot 1 vertex
+struct vertexAttributes_t
+{
+	DirectX::XMFLOAT3 normal;
+	DirectX::XMFLOAT2 uvCoord;
+	DirectX::XMFLOAT3 tangent;
+	DirectX::XMFLOAT3 bitangent;
+};
+
+// a source submesh merged into a static batch (see Render_MergeStaticMeshes)
+struct meshPiece_t
+{
+	DirectX::BoundingSphere	boundingSphere;	// world space
+	unsigned int			iboOffset;
+	unsigned int			indiceCount;
+};
+
+// vertices are split in two streams: depth only passes (e.g. shadows) fetch positions only
+//	slot 0: position (12 bytes)
+//	slot 1: normal, uv, tangent, binormal (44 bytes)
+// meshes live in a range of the shared geometry buffers when it has room (see GeometryBuffer); the buffers are then not owned
 struct mesh_t
 {
-	ID3D11Buffer*			vertexBuffer;	// 8
-	ID3D11Buffer*			indiceBuffer;	// 8
+	renderBuffer_t*			positionBuffer;		// 8
+	renderBuffer_t*			attributeBuffer;	// 8
+	renderBuffer_t*			indiceBuffer;		// 8
+	geometryRange_t*		geometryRange;		// 8 // null if the mesh owns its buffers
 
 	int						vertexCount;	// 4
 	int						indiceCount;	// 4
@@ -40,8 +65,24 @@ struct mesh_t
 	transform_t*			transformation; // 8
 
 	std::vector<submesh_t>	subMeshes;
+	std::vector<meshPiece_t>	pieces;		// merged static meshes only; by ibo offset (submesh ranges are made of pieces)
+
+	std::string				fileName;	// see Render_CreateMeshFromFile; empty for generated meshes (e.g. static batches)
 };
 
-void	Render_BindMesh( const renderContext_t* context, mesh_t* mesh );
+// offsets of the mesh in its buffers; submesh draws add them to their own
+inline uint32_t	Render_GetMeshFirstIndex( const mesh_t* mesh )	{ return ( mesh->geometryRange != nullptr ) ? mesh->geometryRange->firstIndex : 0; }
+inline int32_t		Render_GetMeshBaseVertex( const mesh_t* mesh )	{ return ( mesh->geometryRange != nullptr ) ? static_cast<int32_t>( mesh->geometryRange->firstVertex ) : 0; }
+
+// identifies the geometry of a mesh; copies share it (see WorldEditor::PasteNode)
+inline const void* Render_GetMeshGeometry( const mesh_t* mesh )	{ return ( mesh->geometryRange != nullptr ) ? static_cast<const void*>( mesh->geometryRange ) : mesh->positionBuffer; }
+
+void	Render_BindMesh( const renderContext_t* context, const mesh_t* mesh );
+void	Render_BindMeshPositions( const renderContext_t* context, const mesh_t* mesh ); // depth only passes
+int		Render_CreateMeshBuffers( const renderContext_t* context, mesh_t* mesh, const DirectX::XMFLOAT3* positions, const vertexAttributes_t* attributes, const unsigned int vertexCount, const unsigned int* indices, const unsigned int indiceCount );
 int		Render_CreateMeshFromFile( const renderContext_t* context, MaterialManager* matMan, mesh_t* mesh, const char* fileName );
-void	Render_ReleaseMesh( mesh_t* mesh );
+
+// copies of a mesh share its geometry and materials (see WorldEditor::PasteNode); each copy holds references on them
+// the geometry is released with its last reference, once no snapshot in flight can draw it anymore (see ReleaseQueue)
+void	Render_AcquireMesh( const renderContext_t* context, MaterialManager* matMan, const mesh_t* mesh );
+void	Render_ReleaseMesh( const renderContext_t* context, MaterialManager* matMan, mesh_t* mesh );
@@ -0,0 +1,170 @@
+#include "Shared.h"
+#include "PipelineStateCache.h"
+#include "ShaderLibrary.h"
+
+#include <Engine/System/Log.h>
+#include <Engine/System/MurmurHash2_64.h>
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	constexpr unsigned int HASH_SEED = 0xB;
+
+	// the descriptors have no padding (see RenderTypes.h); their bytes are the key
+	template<typename T>
+	uint64_t HashDesc( const T& desc )
+	{
+		return MurmurHash64A( &desc, static_cast<int>( sizeof( T ) ), HASH_SEED );
+	}
+
+	uint64_t HashPath( const wchar_t* path )
+	{
+		return MurmurHash64A( path, static_cast<int>( wcslen( path ) * sizeof( wchar_t ) ), HASH_SEED );
+	}
+
+	template<typename T>
+	void AppendKey( std::string& key, const T& value )
+	{
+		key.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+	}
+
+	// failures are not cached; every caller of a broken descriptor gets it logged
+	template<typename T, typename CreateFunc>
+	T* FindOrCreate( std::unordered_map<uint64_t, T*>& content, const uint64_t hashcode, const char* objectName, CreateFunc create )
+	{
+		auto it = content.find( hashcode );
+
+		if ( it != content.end() ) {
+			return it->second;
+		}
+
+		T* object = create();
+
+		if ( object == nullptr ) {
+			Log_Printf( "PipelineStateCache: failed to create %s %016llx\n", objectName, static_cast<unsigned long long>( hashcode ) );
+			return nullptr;
+		}
+
+		content.emplace( hashcode, object );
+
+		return object;
+	}
+
+	template<typename T>
+	void ReleaseAll( std::unordered_map<uint64_t, T*>& content )
+	{
+		for ( auto& entry : content ) {
+			entry.second->Release();
+		}
+
+		content.clear();
+	}
+}
+
+PipelineStateCache::PipelineStateCache()
+	: backend( nullptr )
+	, shaders( nullptr )
+{
+
+}
+
+PipelineStateCache::~PipelineStateCache()
+{
+	Clear();
+}
+
+void PipelineStateCache::Initialize( RenderBackend* renderBackend, ShaderLibrary* shaderLibrary )
+{
+	Clear();
+
+	backend	= renderBackend;
+	shaders	= shaderLibrary;
+}
+
+void PipelineStateCache::Clear()
+{
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	ReleaseAll( blendStates );
+	ReleaseAll( rasterizerStates );
+	ReleaseAll( depthStencilStates );
+	ReleaseAll( samplerStates );
+	ReleaseAll( inputLayouts );
+}
+
+renderBlendState_t* PipelineStateCache::GetBlendState( const renderBlendDesc_t& desc )
+{
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	return FindOrCreate( blendStates, HashDesc( desc ), "blend state", [&]() {
+		return backend->CreateBlendState( desc );
+	} );
+}
+
+renderRasterizerState_t* PipelineStateCache::GetRasterizerState( const renderRasterizerDesc_t& desc )
+{
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	return FindOrCreate( rasterizerStates, HashDesc( desc ), "rasterizer state", [&]() {
+		return backend->CreateRasterizerState( desc );
+	} );
+}
+
+renderDepthStencilState_t* PipelineStateCache::GetDepthStencilState( const renderDepthStencilDesc_t& desc )
+{
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	return FindOrCreate( depthStencilStates, HashDesc( desc ), "depth stencil state", [&]() {
+		return backend->CreateDepthStencilState( desc );
+	} );
+}
+
+renderSamplerState_t* PipelineStateCache::GetSamplerState( const renderSamplerDesc_t& desc )
+{
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	return FindOrCreate( samplerStates, HashDesc( desc ), "sampler state", [&]() {
+		return backend->CreateSamplerState( desc );
+	} );
+}
+
+renderInputLayout_t* PipelineStateCache::GetInputLayout( const renderInputElementDesc_t* elements, const uint32_t elementCount, const wchar_t* vertexShaderPath )
+{
+	// semantic names are hashed by value; the pointers usually are string literals from different modules
+	std::string key;
+	AppendKey( key, HashPath( vertexShaderPath ) );
+
+	for ( uint32_t i = 0; i < elementCount; ++i ) {
+		const renderInputElementDesc_t& element = elements[i];
+
+		key.append( element.semanticName, strlen( element.semanticName ) + 1 );
+
+		AppendKey( key, element.semanticIndex );
+		AppendKey( key, element.format );
+		AppendKey( key, element.inputSlot );
+		AppendKey( key, element.alignedByteOffset );
+		AppendKey( key, element.inputSlotClass );
+		AppendKey( key, element.instanceDataStepRate );
+	}
+
+	const uint64_t layoutHashcode = MurmurHash64A( key.data(), static_cast<int>( key.size() ), HASH_SEED );
+
+	// the library has its own lock
+	const std::vector<uint8_t>* bytecode = shaders->GetBytecode( vertexShaderPath );
+
+	if ( bytecode == nullptr ) {
+		return nullptr;
+	}
+
+	// mismatches with the shader signature are reported by the debug layer
+	char layoutName[256];
+	snprintf( layoutName, sizeof( layoutName ), "input layout of '%ls'", vertexShaderPath );
+
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	return FindOrCreate( inputLayouts, layoutHashcode, layoutName, [&]() {
+		return backend->CreateInputLayout( elements, elementCount, bytecode->data(), bytecode->size() );
+	} );
+}
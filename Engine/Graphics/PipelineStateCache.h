@@ -0,0 +1,41 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+#include <mutex>
+#include <unordered_map>
+
+class ShaderLibrary;
+
+// device state objects shared by every pass; keyed by a hash of their descriptor
+// objects are created once, owned by the cache and released by Clear() (callers must not Release them)
+// thread safe; lookups are done at pass creation, not per draw
+class PipelineStateCache
+{
+public:
+								PipelineStateCache();
+								PipelineStateCache( PipelineStateCache& ) = delete;
+								~PipelineStateCache();
+
+	void						Initialize( RenderBackend* backend, ShaderLibrary* shaderLibrary );
+	void						Clear();
+
+	renderBlendState_t*			GetBlendState( const renderBlendDesc_t& desc );
+	renderRasterizerState_t*	GetRasterizerState( const renderRasterizerDesc_t& desc );
+	renderDepthStencilState_t*	GetDepthStencilState( const renderDepthStencilDesc_t& desc );
+	renderSamplerState_t*		GetSamplerState( const renderSamplerDesc_t& desc );
+
+	// validated against the vertex shader bytecode kept by the shader library
+	renderInputLayout_t*		GetInputLayout( const renderInputElementDesc_t* elements, const uint32_t elementCount, const wchar_t* vertexShaderPath );
+
+private:
+	RenderBackend*												backend;
+	ShaderLibrary*												shaders;
+	std::mutex													contentLock;
+
+	std::unordered_map<uint64_t, renderBlendState_t*>			blendStates;
+	std::unordered_map<uint64_t, renderRasterizerState_t*>		rasterizerStates;
+	std::unordered_map<uint64_t, renderDepthStencilState_t*>	depthStencilStates;
+	std::unordered_map<uint64_t, renderSamplerState_t*>			samplerStates;
+	std::unordered_map<uint64_t, renderInputLayout_t*>			inputLayouts;
+};
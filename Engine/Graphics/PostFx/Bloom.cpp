@@ -1,202 +1,140 @@
 #include "Shared.h"
-#include <d3d11.h>
 #include "Bloom.h"
-#include <d3dcompiler.h>
 
 #include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackend.h>
+#include <Engine/Graphics/PipelineStateCache.h>
+#include <Engine/Graphics/ShaderLibrary.h>
 #include "GaussianBlur.h"
 
 BloomPass::BloomPass()
-	: pingPong( false )
-	, finalRenderTarget( nullptr )
+	: vertexShader( nullptr )
+	, pixelShader( nullptr )
+	, linearSamplerState( nullptr )
+	, sourceTarget( FRAME_GRAPH_INVALID_RESOURCE )
 {
 
 }
 
 void BloomPass::Destroy()
 {
-	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+	// owned by the shader library and the pipeline state cache; targets by the frame graph
+	vertexShader		= nullptr;
+	pixelShader			= nullptr;
+	linearSamplerState	= nullptr;
 }
 
-int BloomPass::Create( const renderContext_t* renderContext, const int winWidth, const int winHeight )
+int BloomPass::Create( const renderContext_t* renderContext )
 {
-	D3D11_RENDER_TARGET_VIEW_DESC   renderTargetViewDesc;
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DMS;
-	renderTargetViewDesc.Texture2D.MipSlice = 0;
-	renderTargetViewDesc.Texture3D.MipSlice = 0;
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
-	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DMS;
-	shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
-	shaderResourceViewDesc.Texture2D.MipLevels = -1;
-	shaderResourceViewDesc.Texture3D.MostDetailedMip = 0;
-	shaderResourceViewDesc.Texture3D.MipLevels = -1;
-
-	baseWidth = winWidth;
-	baseHeight = winHeight;
-
-	D3D11_TEXTURE2D_DESC mainRtDesc = {
-		static_cast<UINT>( winWidth ),
-		static_cast<UINT>( winHeight ),
-		1,
-		1,
-		DXGI_FORMAT_R16G16B16A16_FLOAT,
-		{																					// DXGI_SAMPLE_DESC SampleDesc
-			4,																				//		UINT Count
-			0,																				//		UINT Quality
-		},
-		D3D11_USAGE_DEFAULT,
-		D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
-		0,
-		0,
-	};
-
-	renderTargetViewDesc.Format = mainRtDesc.Format;
-	shaderResourceViewDesc.Format = mainRtDesc.Format;
-
-	if ( FAILED( renderContext->device->CreateTexture2D( &mainRtDesc, nullptr, &renderTargetMS.tex2D ) ) ) {
-		return 3;
-	}
-
-	if ( FAILED( renderContext->device->CreateRenderTargetView( renderTargetMS.tex2D, &renderTargetViewDesc, &renderTargetMS.view ) ) ) {
-		return 3;
+	vertexShader = renderContext->shaders->GetVertexShader( L"base_data/shaders/postfx_vs.cso" );
+	if ( vertexShader == nullptr ) {
+		return 1;
 	}
 
-	if ( FAILED( renderContext->device->CreateShaderResourceView( renderTargetMS.tex2D, &shaderResourceViewDesc, &renderTargetMS.ressource ) ) ) {
-		return 3;
+	pixelShader = renderContext->shaders->GetPixelShader( L"base_data/shaders/downsample_ps.cso" );
+	if ( pixelShader == nullptr ) {
+		return 2;
 	}
 
-	mainRtDesc.SampleDesc.Count = 1;
-
-	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-
-	for ( int i = 0; i < 6; ++i ) {
-		if ( FAILED( renderContext->device->CreateTexture2D( &mainRtDesc, nullptr, &renderTargets[i][0].tex2D ) ) ) {
-			return 3;
-		}
-
-		if ( FAILED( renderContext->device->CreateRenderTargetView( renderTargets[i][0].tex2D, &renderTargetViewDesc, &renderTargets[i][0].view ) ) ) {
-			return 3;
-		}
-
-		if ( FAILED( renderContext->device->CreateShaderResourceView( renderTargets[i][0].tex2D, &shaderResourceViewDesc, &renderTargets[i][0].ressource ) ) ) {
-			return 3;
-		}
-
-		if ( FAILED( renderContext->device->CreateTexture2D( &mainRtDesc, nullptr, &renderTargets[i][1].tex2D ) ) ) {
-			return 3;
-		}
-
-		if ( FAILED( renderContext->device->CreateRenderTargetView( renderTargets[i][1].tex2D, &renderTargetViewDesc, &renderTargets[i][1].view ) ) ) {
-			return 3;
-		}
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_MIN_MAG_POINT_MIP_LINEAR;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.mipLODBias = 0.0f;
+	samplerDesc.maxAnisotropy = 1;
+	samplerDesc.comparisonFunc = RENDER_COMPARISON_ALWAYS;
+	samplerDesc.borderColor[0] = 0;
+	samplerDesc.borderColor[1] = 0;
+	samplerDesc.borderColor[2] = 0;
+	samplerDesc.borderColor[3] = 0;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+
+	// same sampler as the gaussian blur; shared through the cache
+	linearSamplerState = renderContext->pipelineStates->GetSamplerState( samplerDesc );
 
-		if ( FAILED( renderContext->device->CreateShaderResourceView( renderTargets[i][1].tex2D, &shaderResourceViewDesc, &renderTargets[i][1].ressource ) ) ) {
-			return 3;
-		}
+	return 0;
+}
 
-		mainRtDesc.Width >>= 1;
-		mainRtDesc.Height >>= 1;
-	}
+frameGraphResource_t BloomPass::AddToGraph( FrameGraph* graph, const renderContext_t* renderContext, const frameGraphResource_t source, GaussianBlur* gaussianBlurPass )
+{
+	sourceTarget = source;
 
-	finalRenderTarget = &renderTargets[0][1];
-	finalRenderTargetResolve = &renderTargets[0][0];
+	const uint32_t bloomPass = graph->AddPass( "bloom", [this, renderContext, gaussianBlurPass]( const FrameGraph* frameGraph ) {
+		Render( renderContext->backend, gaussianBlurPass, frameGraph );
+	} );
 
-	ID3D10Blob*		vertexShaderBuffer = nullptr;
-	ID3D10Blob*		pixelShaderBuffer = nullptr;
+	graph->Read( bloomPass, sourceTarget );
 
-	D3DReadFileToBlob( L"base_data/shaders/postfx_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/downsample_ps.cso", &pixelShaderBuffer );
+	for ( int level = 0; level < LEVEL_COUNT; ++level ) {
+		const frameGraphTargetDesc_t levelDesc = {
+			0,																				// uint32_t			width
+			0,																				// uint32_t			height
+			static_cast<uint32_t>( level ),													// uint32_t			sizeShift
+			RENDER_FORMAT_R16G16B16A16_FLOAT,												// renderFormat_t	format
+			1,																				// uint32_t			sampleCount
+			RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,						// uint32_t			bindFlags
+		};
 
-	if ( FAILED( renderContext->device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader ) ) ) {
-		return 1;
-	}
+		levelTargets[level][0] = graph->CreateTarget( "bloom ping", levelDesc );
+		levelTargets[level][1] = graph->CreateTarget( "bloom pong", levelDesc );
 
-	if ( FAILED( renderContext->device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader ) ) ) {
-		return 2;
+		graph->Write( bloomPass, levelTargets[level][0] );
+		graph->Write( bloomPass, levelTargets[level][1] );
 	}
 
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_POINT_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.MipLODBias = 0.0f;
-	samplerDesc.MaxAnisotropy = 1;
-	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-	samplerDesc.BorderColor[0] = 0;
-	samplerDesc.BorderColor[1] = 0;
-	samplerDesc.BorderColor[2] = 0;
-	samplerDesc.BorderColor[3] = 0;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-
-	renderContext->device->CreateSamplerState( &samplerDesc, &linearSamplerState );
-
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
-
-	return 0;
+	// the blur leaves its result in the second target of the pair (see GaussianBlur::Render)
+	return levelTargets[LEVEL_COUNT - 1][1];
 }
 
-void BloomPass::Render( ID3D11DeviceContext* devContext, GaussianBlur* gaussianBlurPass )
+void BloomPass::Render( RenderBackend* backend, GaussianBlur* gaussianBlurPass, const FrameGraph* graph )
 {
-	ID3D11Resource* resDst = nullptr;
-	finalRenderTargetResolve->view->GetResource( &resDst );
+	const renderTarget_t* levels[LEVEL_COUNT][2];
+	for ( int level = 0; level < LEVEL_COUNT; ++level ) {
+		levels[level][0] = graph->GetTarget( levelTargets[level][0] );
+		levels[level][1] = graph->GetTarget( levelTargets[level][1] );
+	}
 
-	ID3D11Resource* resSrc = nullptr;
-	renderTargetMS.view->GetResource( &resSrc );
+	backend->ResolveSubresource( levels[0][0]->texture, graph->GetTarget( sourceTarget )->texture, RENDER_FORMAT_R16G16B16A16_FLOAT );
 
-	devContext->ResolveSubresource( resDst, D3D11CalcSubresource( 0, 0, 1 ), resSrc, D3D11CalcSubresource( 0, 0, 1 ), DXGI_FORMAT_R16G16B16A16_FLOAT );
+	const renderViewport_t backupViewport = backend->GetViewport();
 
-	D3D11_VIEWPORT backupViewport = {};
-	UINT viewportCount = 1;
-	devContext->RSGetViewports( &viewportCount, &backupViewport );
+	for ( int i = 0; i < LEVEL_COUNT; i++ ) {
+		const renderTarget_t* finalRenderTarget = gaussianBlurPass->Render( backend, levels[i] );
 
-	unsigned int viewportW = baseWidth,
-		viewportH = baseHeight;
-	for ( int i = 0; i < 6; i++ ) {
-		finalRenderTarget = gaussianBlurPass->Render( devContext, renderTargets[i] );
+		if ( i < LEVEL_COUNT - 1 ) {
+			backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &linearSamplerState );
 
-		if ( i < 5 ) {
-			devContext->PSSetSamplers( 0, 1, &linearSamplerState );
+			backend->SetVertexShader( vertexShader );
+			backend->SetPixelShader( pixelShader );
 
-			devContext->VSSetShader( vertexShader, NULL, 0 );
-			devContext->PSSetShader( pixelShader, NULL, 0 );
+			backend->SetRenderTargets( 1, &levels[i + 1][0]->view, NULL );
+			Render_ClearTargetColor( backend, levels[i + 1][0] );
 
-			devContext->OMSetRenderTargets( 1, &renderTargets[i+1][0].view, NULL );
-			Render_ClearTargetColor( devContext, &renderTargets[i + 1][0] );
+			// the viewport covers the next (half size) level
+			const frameGraphTargetDesc_t& levelDesc = graph->GetPlan( levelTargets[i + 1][0] ).desc;
 
-			// set shadow viewport
-			D3D11_VIEWPORT viewport =
+			renderViewport_t viewport =
 			{
 				0.0f,
 				0.0f,
-				static_cast<FLOAT>( viewportW ),
-				static_cast<FLOAT>( viewportH ),
+				static_cast<float>( levelDesc.width ),
+				static_cast<float>( levelDesc.height ),
 				0.0f,
 				1.0f,
 			};
 
-			devContext->RSSetViewports( 1, &viewport );
+			backend->SetViewport( viewport );
 
-			devContext->PSSetShaderResources( 0, 1, &finalRenderTarget->ressource );
+			backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &finalRenderTarget->ressource );
 
-			devContext->Draw( 6, 0 );
+			backend->Draw( 6, 0 );
 			
-			ID3D11ShaderResourceView *const pSRV[1] = { NULL };
-			devContext->PSSetShaderResources( 0, 1, pSRV );
-
-			viewportW >>= 1;
-			viewportH >>= 1;
+			renderShaderResourceView_t *const pSRV[1] = { NULL };
+			backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, pSRV );
 		}
 	}
 
-	devContext->RSSetViewports( 1, &backupViewport );
-}
-
-const renderTarget_t* BloomPass::GetResolvedRenderTarget( const renderContext_t* renderContext )
-{
-	return finalRenderTarget;
+	backend->SetViewport( backupViewport );
 }
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <Engine/Graphics/Texture.h>
+#include <Engine/Graphics/FrameGraph.h>
 
 struct renderContext_t;
+class RenderBackend;
 class GaussianBlur;
 
 class BloomPass
 {
 public:
-	const renderTarget_t*		GetMSRenderTarget() { return &renderTargetMS; }
+	static constexpr int		LEVEL_COUNT = 6; // each level is half the size of the previous one
 
 public:
 								BloomPass();
@@ -16,24 +18,21 @@ public:
 								~BloomPass()			= default;
 
 	void						Destroy();
-	int							Create( const renderContext_t* renderContext, const int winWidth, const int winHeight );
-	void						Render( ID3D11DeviceContext* devContext, GaussianBlur* gaussianBlurPass );
+	int							Create( const renderContext_t* renderContext );
 
-	const renderTarget_t*		GetResolvedRenderTarget( const renderContext_t* renderContext );
+	// declares the level targets and the bloom pass, which resolves and blurs the (multisampled) source
+	// returns the blurred target read by the composition
+	frameGraphResource_t		AddToGraph( FrameGraph* graph, const renderContext_t* renderContext, const frameGraphResource_t source, GaussianBlur* gaussianBlurPass );
 
 private:
-	const renderTarget_t*		finalRenderTarget;
-	renderTarget_t*				finalRenderTargetResolve;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShader;
 
-	unsigned int				baseWidth;
-	unsigned int				baseHeight;
+	renderSamplerState_t*		linearSamplerState;
 
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
+	frameGraphResource_t		sourceTarget;
+	frameGraphResource_t		levelTargets[LEVEL_COUNT][2]; // ping, pong (resolved)
 
-	ID3D11SamplerState*         linearSamplerState;
-
-	renderTarget_t				renderTargetMS;
-	renderTarget_t				renderTargets[6][2]; // ping, pong (resolved)
-	bool						pingPong;
+private:
+	void						Render( RenderBackend* backend, GaussianBlur* gaussianBlurPass, const FrameGraph* graph );
 };
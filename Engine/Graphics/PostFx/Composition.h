@@ -18,12 +18,12 @@ public:
 	void						Render( const renderContext_t* context, const renderTarget_t* mainRt, const renderTarget_t* bloomRt );
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShader;
 
-	ID3D11PixelShader*			pixelShaderAvgLuminances;
-	ID3D11SamplerState*         samplerState;
-	ID3D11SamplerState*         samplerStateMipMap;
+	renderPixelShader_t*		pixelShaderAvgLuminances;
+	renderSamplerState_t*		samplerState;
+	renderSamplerState_t*		samplerStateMipMap;
 
 	renderTarget_t				averageLuminance[2];
 	int							activeTarget;
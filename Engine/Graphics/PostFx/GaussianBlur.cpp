@@ -1,9 +1,10 @@
 #include "Shared.h"
-#include <d3d11.h>
 #include "GaussianBlur.h"
-#include <d3dcompiler.h>
 
 #include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackend.h>
+#include <Engine/Graphics/PipelineStateCache.h>
+#include <Engine/Graphics/ShaderLibrary.h>
 
 GaussianBlur::GaussianBlur()
 	: vertexShader( nullptr )
@@ -15,84 +16,66 @@ GaussianBlur::GaussianBlur()
 
 void GaussianBlur::Destroy()
 {
-	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
-
-	RELEASE( vertexShader )
-	RELEASE( pixelShaders[0] )
-	RELEASE( pixelShaders[1] )
-	RELEASE( samplerState )
+	// owned by the shader library and the pipeline state cache
+	vertexShader	= nullptr;
+	pixelShaders[0]	= nullptr;
+	pixelShaders[1]	= nullptr;
+	samplerState	= nullptr;
 }
 
 int GaussianBlur::Create( const renderContext_t* renderContext )
 {
-	HRESULT result = 0;
-
-	ID3D10Blob*		vertexShaderBuffer = nullptr;
-	ID3D10Blob*		pixelShaderBuffer[2] = { nullptr, nullptr };
-
-	D3DReadFileToBlob( L"base_data/shaders/postfx_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/gaussianblur_vertical_ps.cso", &pixelShaderBuffer[0] );
-	D3DReadFileToBlob( L"base_data/shaders/gaussianblur_horizontal_ps.cso", &pixelShaderBuffer[1] );
-
-	result = renderContext->device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader );
-	if ( FAILED( result ) ) {
+	vertexShader = renderContext->shaders->GetVertexShader( L"base_data/shaders/postfx_vs.cso" );
+	if ( vertexShader == nullptr ) {
 		return 1;
 	}
 
-	result = renderContext->device->CreatePixelShader( pixelShaderBuffer[0]->GetBufferPointer(), pixelShaderBuffer[0]->GetBufferSize(), NULL, &pixelShaders[0] );
-	if ( FAILED( result ) ) {
-		return 2;
-	}
-
-	result = renderContext->device->CreatePixelShader( pixelShaderBuffer[1]->GetBufferPointer(), pixelShaderBuffer[1]->GetBufferSize(), NULL, &pixelShaders[1] );
-	if ( FAILED( result ) ) {
+	pixelShaders[0] = renderContext->shaders->GetPixelShader( L"base_data/shaders/gaussianblur_vertical_ps.cso" );
+	pixelShaders[1] = renderContext->shaders->GetPixelShader( L"base_data/shaders/gaussianblur_horizontal_ps.cso" );
+	if ( pixelShaders[0] == nullptr || pixelShaders[1] == nullptr ) {
 		return 2;
 	}
 
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_POINT_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	samplerDesc.MipLODBias = 0.0f;
-	samplerDesc.MaxAnisotropy = 1;
-	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-	samplerDesc.BorderColor[0] = 0;
-	samplerDesc.BorderColor[1] = 0;
-	samplerDesc.BorderColor[2] = 0;
-	samplerDesc.BorderColor[3] = 0;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-
-	renderContext->device->CreateSamplerState( &samplerDesc, &samplerState );
-
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer[0]->Release();
-	pixelShaderBuffer[1]->Release();
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_MIN_MAG_POINT_MIP_LINEAR;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.mipLODBias = 0.0f;
+	samplerDesc.maxAnisotropy = 1;
+	samplerDesc.comparisonFunc = RENDER_COMPARISON_ALWAYS;
+	samplerDesc.borderColor[0] = 0;
+	samplerDesc.borderColor[1] = 0;
+	samplerDesc.borderColor[2] = 0;
+	samplerDesc.borderColor[3] = 0;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+
+	samplerState = renderContext->pipelineStates->GetSamplerState( samplerDesc );
 
 	return 0;
 }
 
-const renderTarget_t* GaussianBlur::Render( ID3D11DeviceContext* devContext, const renderTarget_t* targets )
+const renderTarget_t* GaussianBlur::Render( RenderBackend* backend, const renderTarget_t* const targets[2] )
 {
-	devContext->VSSetShader( vertexShader, NULL, 0 );
+	backend->SetVertexShader( vertexShader );
 
-	devContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
+	backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
 
-	devContext->PSSetSamplers( 0, 1, &samplerState );
+	backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerState );
 
 	bool pingPong = false;
 	int writeAttachement = 1, readAttachement = 0;
 
 	for ( int i = 0; i < 2; ++i ) {
-		devContext->PSSetShader( pixelShaders[writeAttachement], NULL, 0 );
+		backend->SetPixelShader( pixelShaders[writeAttachement] );
 
-		devContext->OMSetRenderTargets( 1, &targets[writeAttachement].view, NULL );
-		Render_ClearTargetColor( devContext, &targets[writeAttachement] );
+		backend->SetRenderTargets( 1, &targets[writeAttachement]->view, NULL );
+		Render_ClearTargetColor( backend, targets[writeAttachement] );
 
-		devContext->PSSetShaderResources( 0, 1, &targets[readAttachement].ressource );
+		backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &targets[readAttachement]->ressource );
 
-		devContext->Draw( 6, 0 );
+		backend->Draw( 6, 0 );
 
 		pingPong = !pingPong;
 
@@ -100,9 +83,9 @@ const renderTarget_t* GaussianBlur::Render( ID3D11DeviceContext* devContext, con
 		readAttachement = ( writeAttachement == 0 ) ? 1 : 0;
 
 		// unbind the ressource so that we can use the render target on the next frame
-		ID3D11ShaderResourceView *const pSRV[1] = { NULL };
-		devContext->PSSetShaderResources( 0, 1, pSRV );
+		renderShaderResourceView_t *const pSRV[1] = { NULL };
+		backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, pSRV );
 	}
 
-	return &targets[writeAttachement];
+	return targets[writeAttachement];
 }
@@ -3,6 +3,7 @@
 #include <Engine/Graphics/Texture.h>
 
 struct renderContext_t;
+class RenderBackend;
 
 class GaussianBlur
 {
@@ -13,10 +14,10 @@ public:
 
 	void						Destroy();
 	int							Create( const renderContext_t* renderContext );
-	const renderTarget_t*		Render( ID3D11DeviceContext* devContext, const renderTarget_t* targets );
+	const renderTarget_t*		Render( RenderBackend* backend, const renderTarget_t* const targets[2] ); // ping, pong
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShaders[2];
-	ID3D11SamplerState*         samplerState;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShaders[2];
+	renderSamplerState_t*		samplerState;
 };
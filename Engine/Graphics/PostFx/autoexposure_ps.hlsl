@@ -4,6 +4,13 @@ struct psDataScreenQuad_t
 	float2 uv : TEXCOORD0;
 };
 
+cbuffer CommonData : register( b4 )
+{
+	float deltaTime;
+	float __PADDING__;
+	float2 renderScale; // the scene covers [0, renderScale] of the targets (dynamic resolution)
+}
+
 Texture2D mainRenderTargetTex : register( t0 );
 SamplerState defaultSampler : register( s0 );
 
@@ -30,7 +37,7 @@ float4 main( psDataScreenQuad_t p ) : SV_TARGET
 {
 	// computes geometric luminance from a render target
 	// source: Reinhard image calibration paper
-	float3 texelColor = mainRenderTargetTex.Sample( defaultSampler, p.uv ).rgb;
+	float3 texelColor = mainRenderTargetTex.Sample( defaultSampler, p.uv * renderScale ).rgb;
 	texelColor.rgb = ACESFilm( texelColor.rgb ); 
 	texelColor = accurateLinearToSRGB( texelColor.rgb );
 
@@ -1,6 +1,8 @@
 cbuffer CommonData : register( b4 )
 {
-	float4 deltaTime;
+	float deltaTime;
+	float __PADDING__;
+	float2 renderScale; // the scene covers [0, renderScale] of the targets (dynamic resolution)
 }
 
 struct psDataScreenQuad_t
@@ -42,6 +44,15 @@ float Vignette( const in float2 fragCoordinates )
 	return 0.3 + 0.7 * pow( 16.0 * fragCoordinates.x * fragCoordinates.y * ( 1.0 - fragCoordinates.x ) * ( 1.0 - fragCoordinates.y ), 0.2 );
 }
 
+// upscales the scene corner of a target to the whole screen; clamped half a texel inside, the texels around are stale
+float2 SceneUV( const in float2 uv, Texture2D tex )
+{
+	float2 texSize;
+	tex.GetDimensions( texSize.x, texSize.y );
+
+	return min( uv * renderScale, renderScale - 0.5 / texSize );
+}
+
 float3 ACESFilm( float3 x )
 {
 	float a = 2.51f;
@@ -103,14 +114,14 @@ float3 computeBloomLuminance( float3 bloomColor, float bloomEC, float currentEV
 
 float4 main( psDataScreenQuad_t p ) : SV_TARGET
 {
-	float4 finalColor = diffuseTex.Sample( defaultSampler, p.uv );
+	float4 finalColor = diffuseTex.Sample( defaultSampler, SceneUV( p.uv, diffuseTex ) );
 
 	// exposition
 	float lum = avgLuminance.SampleLevel( defaultSamplerMipMapped, p.uv, 10 ).r;
 	float prevLum = avgLuminancePrevious.SampleLevel( defaultSamplerMipMapped, p.uv, 10 ).r;
 
 	// Adapt the luminance using Pattanaik's technique
-	float adaptedLum = prevLum + ( lum - prevLum ) * ( 1.0 - exp( -deltaTime.x * 0.5f ) );
+	float adaptedLum = prevLum + ( lum - prevLum ) * ( 1.0 - exp( -deltaTime * 0.5f ) );
 
 	float exposure_val = computeEV100FromAvgLuminance( adaptedLum );
 	float exposure = convertEV100ToExposure( exposure_val );
@@ -118,7 +129,7 @@ float4 main( psDataScreenQuad_t p ) : SV_TARGET
 	finalColor.rgb *= exposure; // ComputeExposedColor( finalColor.rgb, lum );
 
 	// bloom
-	float4 bloomColor = bloomTex.Sample( defaultSampler, p.uv );
+	float4 bloomColor = bloomTex.Sample( defaultSampler, SceneUV( p.uv, bloomTex ) );
 	finalColor.rgb += computeBloomLuminance( bloomColor.rgb, 1.0, prevLum );
 
 	// tonemapping + gamma correction
@@ -0,0 +1,72 @@
+#include "Shared.h"
+#include "ReleaseQueue.h"
+#include "RenderContext.h"
+
+ReleaseQueue::ReleaseQueue()
+	: pendingCount( 0 )
+	, builtFrameCount( 0 )
+	, renderedFrameCount( 0 )
+{
+
+}
+
+void ReleaseQueue::BeginFrame( const uint64_t frameIndex )
+{
+	builtFrameCount.store( frameIndex + 1, std::memory_order_release );
+}
+
+void ReleaseQueue::EndFrame( const uint64_t frameIndex )
+{
+	renderedFrameCount.store( frameIndex + 1, std::memory_order_release );
+}
+
+void ReleaseQueue::Enqueue( release_t release )
+{
+	std::lock_guard<std::mutex> lock( releaseLock );
+
+	pendingReleases.push_back( { builtFrameCount.load( std::memory_order_acquire ), std::move( release ) } );
+	pendingCount.store( pendingReleases.size(), std::memory_order_relaxed );
+}
+
+void ReleaseQueue::Collect()
+{
+	Run( renderedFrameCount.load( std::memory_order_acquire ) );
+}
+
+void ReleaseQueue::Flush()
+{
+	// releases can queue other ones (e.g. a material its textures)
+	while ( GetPendingCount() != 0 ) {
+		Run( ~0ull );
+	}
+}
+
+void ReleaseQueue::Run( const uint64_t frameCount )
+{
+	std::vector<release_t> releases;
+
+	{
+		std::lock_guard<std::mutex> lock( releaseLock );
+
+		while ( !pendingReleases.empty() && pendingReleases.front().frame <= frameCount ) {
+			releases.push_back( std::move( pendingReleases.front().release ) );
+			pendingReleases.pop_front();
+		}
+
+		pendingCount.store( pendingReleases.size(), std::memory_order_relaxed );
+	}
+
+	// outside of the lock: releases can queue other ones
+	for ( release_t& release : releases ) {
+		release();
+	}
+}
+
+void Render_QueueRelease( const renderContext_t* context, ReleaseQueue::release_t release )
+{
+	if ( context->releases != nullptr ) {
+		context->releases->Enqueue( std::move( release ) );
+	} else {
+		release();
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+struct renderContext_t;
+
+// resources whose last reference is dropped (meshes geometry, materials, textures) might still be referenced by
+// snapshots waiting for the render thread; their destruction is queued until every snapshot built before the release has
+// been rendered
+// d3d11 keeps released objects alive until the gpu is done with them: only the snapshots have to be waited for
+// thread safe; releases run on the thread calling Collect (the main thread, see RenderManager::AcquireSnapshot)
+class ReleaseQueue
+{
+public:
+	using release_t = std::function<void()>;
+
+public:
+	inline std::size_t	GetPendingCount() const	{ return pendingCount.load( std::memory_order_relaxed ); }
+
+public:
+						ReleaseQueue();
+						ReleaseQueue( ReleaseQueue& ) = delete;
+						~ReleaseQueue() = default;
+
+	void				BeginFrame( const uint64_t frameIndex );	// a snapshot is being built
+	void				EndFrame( const uint64_t frameIndex );		// the renderer is done with the snapshot; frames end in order
+
+	void				Enqueue( release_t release );
+	void				Collect(); // runs the releases no snapshot can reference anymore
+	void				Flush(); // runs every release; once nothing renders anymore (shutdown)
+
+private:
+	struct pendingRelease_t
+	{
+		uint64_t		frame;		// snapshots built before it (frame index < frame) might reference the resource
+		release_t		release;
+	};
+
+private:
+	std::mutex						releaseLock;
+	std::deque<pendingRelease_t>	pendingReleases;	// by frame
+	std::atomic<std::size_t>		pendingCount;
+
+	std::atomic<uint64_t>			builtFrameCount;
+	std::atomic<uint64_t>			renderedFrameCount;
+
+private:
+	void				Run( const uint64_t frameCount );
+};
+
+// queued on the context's release queue; run right away if it has none (tools, headless)
+void Render_QueueRelease( const renderContext_t* context, ReleaseQueue::release_t release );
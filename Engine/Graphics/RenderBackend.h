@@ -0,0 +1,102 @@
+#pragma once
+
+#include "RenderTypes.h"
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+enum renderStage_t
+{
+	RENDER_STAGE_VERTEX = 0,
+	RENDER_STAGE_PIXEL,
+};
+
+// device and device context: resource creation, then what the frame issues once they exist (binds, draws, copies)
+// RenderBackendD3D11 forwards to a d3d11 device and context; RenderBackendNull records a compact command stream instead
+// creation is thread safe (the d3d11 device is free threaded); commands are not
+// a deferred backend (CreateDeferredBackend) records a command list (FinishCommandList) that the immediate one executes
+// in order; both backends must be of the same kind
+class RenderBackend
+{
+public:
+	virtual								~RenderBackend() = default;
+
+	virtual const bool					SupportsConstantBufferRanges() const = 0; // SetConstantBufferRange (d3d 11.1)
+	virtual const bool					SupportsNoOverwriteConstantBufferMaps() const = 0;
+
+	// null on failure; the caller owns the returned reference
+	virtual renderBuffer_t*				CreateBuffer( const renderBufferDesc_t& desc, const void* initialData ) = 0;
+	virtual renderTexture_t*			CreateTexture( const renderTextureDesc_t& desc ) = 0;
+	virtual renderTexture_t*			CreateTextureFromFile( const wchar_t* path, renderShaderResourceView_t** view ) = 0; // dds
+	virtual renderShaderResourceView_t*	CreateShaderResourceView( renderResource_t* resource, const renderViewDesc_t* desc ) = 0;
+	virtual renderTargetView_t*			CreateRenderTargetView( renderTexture_t* texture, const renderViewDesc_t* desc ) = 0;
+	virtual renderDepthStencilView_t*	CreateDepthStencilView( renderTexture_t* texture, const renderViewDesc_t* desc ) = 0;
+
+	virtual renderVertexShader_t*		CreateVertexShader( const void* bytecode, const size_t bytecodeSize ) = 0;
+	virtual renderPixelShader_t*		CreatePixelShader( const void* bytecode, const size_t bytecodeSize ) = 0;
+	virtual renderInputLayout_t*		CreateInputLayout( const renderInputElementDesc_t* elements, const uint32_t elementCount, const void* bytecode, const size_t bytecodeSize ) = 0;
+
+	virtual renderSamplerState_t*		CreateSamplerState( const renderSamplerDesc_t& desc ) = 0;
+	virtual renderBlendState_t*			CreateBlendState( const renderBlendDesc_t& desc ) = 0;
+	virtual renderRasterizerState_t*	CreateRasterizerState( const renderRasterizerDesc_t& desc ) = 0;
+	virtual renderDepthStencilState_t*	CreateDepthStencilState( const renderDepthStencilDesc_t& desc ) = 0;
+	virtual renderQuery_t*				CreateQuery( const renderQueryType_t type ) = 0;
+
+	// hlsl; errors get the compiler output (if any); flags are renderCompileFlags_t
+	virtual const bool					CompileShader( const wchar_t* sourcePath, const renderShaderMacro_t* defines, const char* entryPoint, const char* profile, const uint32_t flags, std::vector<uint8_t>& bytecode, std::string& errors ) = 0;
+	virtual const bool					PreprocessShader( const wchar_t* sourcePath, const std::vector<uint8_t>& source, std::vector<uint8_t>& preprocessed, std::string& errors ) = 0;
+	virtual const bool					LoadShaderBytecode( const wchar_t* path, std::vector<uint8_t>& bytecode ) = 0; // precompiled (.cso)
+
+	// null if the backend can't record command lists
+	virtual RenderBackend*				CreateDeferredBackend() = 0;
+
+	// owned by the backend; null on deferred backends
+	virtual renderTargetView_t*			GetBackBuffer() = 0;
+	virtual const bool					ResizeBackBuffer( const uint32_t width, const uint32_t height ) = 0; // the previous back buffer is released
+	virtual void						Present( const bool enableVsync ) = 0;
+
+	virtual void						SetPrimitiveTopology( const renderPrimitiveTopology_t topology ) = 0;
+	virtual void						SetInputLayout( renderInputLayout_t* inputLayout ) = 0;
+	virtual void						SetVertexBuffer( const uint32_t slot, renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset ) = 0;
+	virtual void						SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset ) = 0;
+
+	virtual void						SetVertexShader( renderVertexShader_t* shader ) = 0;
+	virtual void						SetPixelShader( renderPixelShader_t* shader ) = 0;
+	virtual void						SetConstantBuffers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers ) = 0;
+	virtual void						SetConstantBufferRange( const renderStage_t stage, const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount ) = 0;
+	virtual void						SetShaderResources( const renderStage_t stage, const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views ) = 0;
+	virtual void						SetSamplers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderSamplerState_t* const* samplers ) = 0;
+
+	virtual void						SetRasterizerState( renderRasterizerState_t* state ) = 0;
+	virtual void						SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t stencilRef ) = 0;
+	virtual void						SetBlendState( renderBlendState_t* state ) = 0; // null blend factor, full sample mask
+
+	virtual void						SetRenderTargets( const uint32_t count, renderTargetView_t* const* views, renderDepthStencilView_t* depthView ) = 0;
+	virtual void						SetViewport( const renderViewport_t& viewport ) = 0;
+	virtual renderViewport_t			GetViewport() = 0; // the one bound (passes restore it after drawing to targets of their own)
+
+	virtual void						ClearRenderTarget( renderTargetView_t* view, const float color[4] ) = 0;
+	virtual void						ClearDepthStencil( renderDepthStencilView_t* view, const uint32_t clearFlags, const float depth, const uint8_t stencil ) = 0;
+
+	virtual void						Draw( const uint32_t vertexCount, const uint32_t startVertex ) = 0;
+	virtual void						DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex ) = 0;
+	virtual void						DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance ) = 0;
+
+	// whole buffer; null on failure (the null backend hands out cpu memory)
+	virtual void*						MapBuffer( renderBuffer_t* buffer, const renderMap_t mapType ) = 0;
+	virtual void						UnmapBuffer( renderBuffer_t* buffer ) = 0;
+	virtual void						UpdateBuffer( renderBuffer_t* buffer, const uint32_t offset, const uint32_t size, const void* data ) = 0; // default usage buffers
+
+	virtual void						CopyResource( renderResource_t* destination, renderResource_t* source ) = 0; // same size and format
+	virtual void						CopyBufferRegion( renderBuffer_t* destination, const uint32_t destinationOffset, renderBuffer_t* source, const uint32_t sourceOffset, const uint32_t size ) = 0;
+	virtual void						ResolveSubresource( renderTexture_t* destination, renderTexture_t* source, const renderFormat_t format ) = 0; // first subresource
+	virtual void						GenerateMips( renderShaderResourceView_t* view ) = 0;
+
+	virtual void						BeginQuery( renderQuery_t* query ) = 0; // disjoint queries only
+	virtual void						EndQuery( renderQuery_t* query ) = 0;
+	virtual const bool					GetQueryData( renderQuery_t* query, void* data, const uint32_t dataSize ) = 0; // never flushes; false until the result is available
+
+	virtual void						FinishCommandList() = 0; // deferred backends only; ends the recording
+	virtual void						ExecuteCommandList( RenderBackend* deferred ) = 0; // immediate backend; consumes the finished list, the state is kept as it was
+};
@@ -0,0 +1,948 @@
+#include "Shared.h"
+#include "RenderBackendD3D11.h"
+
+#include <d3dcompiler.h>
+#include <Engine/ThirdParty/DirectXTK/Inc/DDSTextureLoader.h>
+
+// the neutral enums are passed through as is
+static_assert( RENDER_FORMAT_R16G16B16A16_FLOAT == DXGI_FORMAT_R16G16B16A16_FLOAT, "format values mismatch" );
+static_assert( RENDER_FORMAT_R24G8_TYPELESS == DXGI_FORMAT_R24G8_TYPELESS, "format values mismatch" );
+static_assert( RENDER_FORMAT_R8_UNORM == DXGI_FORMAT_R8_UNORM, "format values mismatch" );
+static_assert( RENDER_BIND_DEPTH_STENCIL == D3D11_BIND_DEPTH_STENCIL, "bind flag values mismatch" );
+static_assert( RENDER_USAGE_STAGING == D3D11_USAGE_STAGING, "usage values mismatch" );
+static_assert( RENDER_CPU_ACCESS_READ == D3D11_CPU_ACCESS_READ, "cpu access values mismatch" );
+static_assert( RENDER_MISC_BUFFER_STRUCTURED == D3D11_RESOURCE_MISC_BUFFER_STRUCTURED, "misc flag values mismatch" );
+static_assert( RENDER_MAP_WRITE_NO_OVERWRITE == D3D11_MAP_WRITE_NO_OVERWRITE, "map values mismatch" );
+static_assert( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP == D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, "topology values mismatch" );
+static_assert( RENDER_COMPARISON_ALWAYS == D3D11_COMPARISON_ALWAYS, "comparison values mismatch" );
+static_assert( RENDER_STENCIL_OP_DECR == D3D11_STENCIL_OP_DECR, "stencil op values mismatch" );
+static_assert( RENDER_BLEND_INV_DEST_COLOR == D3D11_BLEND_INV_DEST_COLOR, "blend values mismatch" );
+static_assert( RENDER_BLEND_OP_MAX == D3D11_BLEND_OP_MAX, "blend op values mismatch" );
+static_assert( RENDER_FILL_SOLID == D3D11_FILL_SOLID && RENDER_CULL_BACK == D3D11_CULL_BACK, "rasterizer values mismatch" );
+static_assert( RENDER_FILTER_ANISOTROPIC == D3D11_FILTER_ANISOTROPIC, "filter values mismatch" );
+static_assert( RENDER_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR == D3D11_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR, "filter values mismatch" );
+static_assert( RENDER_TEXTURE_ADDRESS_BORDER == D3D11_TEXTURE_ADDRESS_BORDER, "address mode values mismatch" );
+static_assert( RENDER_INPUT_PER_INSTANCE_DATA == D3D11_INPUT_PER_INSTANCE_DATA, "input classification values mismatch" );
+static_assert( RENDER_QUERY_TIMESTAMP_DISJOINT == D3D11_QUERY_TIMESTAMP_DISJOINT, "query values mismatch" );
+static_assert( RENDER_CLEAR_STENCIL == D3D11_CLEAR_STENCIL, "clear flag values mismatch" );
+static_assert( RENDER_COMPILE_OPTIMIZATION_LEVEL3 == D3DCOMPILE_OPTIMIZATION_LEVEL3 && RENDER_COMPILE_SKIP_OPTIMIZATION == D3DCOMPILE_SKIP_OPTIMIZATION, "compile flag values mismatch" );
+static_assert( RENDER_APPEND_ALIGNED_ELEMENT == D3D11_APPEND_ALIGNED_ELEMENT, "append aligned value mismatch" );
+static_assert( RENDER_SIMULTANEOUS_RENDER_TARGET_COUNT == D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, "render target count mismatch" );
+static_assert( sizeof( renderViewport_t ) == sizeof( D3D11_VIEWPORT ), "viewport layout mismatch" );
+
+namespace
+{
+	// handle of a d3d object; the wrapper owns one reference
+	template<typename T, typename D3DType>
+	struct d3d11Object_t : T
+	{
+							~d3d11Object_t()	{ if ( object != nullptr ) { object->Release(); } }
+
+		D3DType*			object = nullptr;
+	};
+
+	using d3d11Buffer_t				= d3d11Object_t<renderBuffer_t, ID3D11Buffer>;
+	using d3d11Texture_t			= d3d11Object_t<renderTexture_t, ID3D11Resource>;
+	using d3d11ShaderResourceView_t	= d3d11Object_t<renderShaderResourceView_t, ID3D11ShaderResourceView>;
+	using d3d11RenderTargetView_t	= d3d11Object_t<renderTargetView_t, ID3D11RenderTargetView>;
+	using d3d11DepthStencilView_t	= d3d11Object_t<renderDepthStencilView_t, ID3D11DepthStencilView>;
+	using d3d11VertexShader_t		= d3d11Object_t<renderVertexShader_t, ID3D11VertexShader>;
+	using d3d11PixelShader_t		= d3d11Object_t<renderPixelShader_t, ID3D11PixelShader>;
+	using d3d11InputLayout_t		= d3d11Object_t<renderInputLayout_t, ID3D11InputLayout>;
+	using d3d11SamplerState_t		= d3d11Object_t<renderSamplerState_t, ID3D11SamplerState>;
+	using d3d11BlendState_t			= d3d11Object_t<renderBlendState_t, ID3D11BlendState>;
+	using d3d11RasterizerState_t	= d3d11Object_t<renderRasterizerState_t, ID3D11RasterizerState>;
+	using d3d11DepthStencilState_t	= d3d11Object_t<renderDepthStencilState_t, ID3D11DepthStencilState>;
+	using d3d11Query_t				= d3d11Object_t<renderQuery_t, ID3D11Query>;
+
+	template<typename D3DType, typename T>
+	D3DType* GetObject( T* handle )
+	{
+		return ( handle != nullptr ) ? static_cast<d3d11Object_t<T, D3DType>*>( handle )->object : nullptr;
+	}
+
+	ID3D11Resource* GetResource( renderResource_t* resource )
+	{
+		renderBuffer_t* buffer = dynamic_cast<renderBuffer_t*>( resource );
+
+		if ( buffer != nullptr ) {
+			return GetObject<ID3D11Buffer>( buffer );
+		}
+
+		return GetObject<ID3D11Resource>( static_cast<renderTexture_t*>( resource ) );
+	}
+
+	// null (and the handle released) if the creation failed
+	template<typename Wrapper, typename D3DType, typename CreateFunc>
+	Wrapper* Wrap( CreateFunc create )
+	{
+		D3DType* object = nullptr;
+
+		if ( FAILED( create( &object ) ) || object == nullptr ) {
+			return nullptr;
+		}
+
+		Wrapper* wrapper = new Wrapper();
+		wrapper->object = object;
+
+		return wrapper;
+	}
+
+	template<typename Wrapper>
+	Wrapper* WrapView( typename std::remove_reference<decltype( *Wrapper::object )>::type* view, renderResource_t* resource )
+	{
+		Wrapper* wrapper = new Wrapper();
+		wrapper->object = view;
+
+		resource->AddRef();
+		wrapper->resource = resource;
+
+		return wrapper;
+	}
+
+	template<typename D3DType, typename T, uint32_t N>
+	void GetObjects( D3DType* ( &objects )[N], const uint32_t count, T* const* handles )
+	{
+		for ( uint32_t i = 0; i < count && i < N; ++i ) {
+			objects[i] = GetObject<D3DType>( handles[i] );
+		}
+	}
+
+	D3D11_SRV_DIMENSION GetSRVDimension( const renderViewDimension_t dimension )
+	{
+		switch ( dimension ) {
+		case RENDER_VIEW_DIMENSION_BUFFER:		return D3D11_SRV_DIMENSION_BUFFER;
+		case RENDER_VIEW_DIMENSION_TEXTURE1D:	return D3D11_SRV_DIMENSION_TEXTURE1D;
+		case RENDER_VIEW_DIMENSION_TEXTURE2D:	return D3D11_SRV_DIMENSION_TEXTURE2D;
+		case RENDER_VIEW_DIMENSION_TEXTURE2DMS:	return D3D11_SRV_DIMENSION_TEXTURE2DMS;
+		case RENDER_VIEW_DIMENSION_TEXTURE3D:	return D3D11_SRV_DIMENSION_TEXTURE3D;
+		default:								return D3D11_SRV_DIMENSION_UNKNOWN;
+		}
+	}
+
+	D3D11_RTV_DIMENSION GetRTVDimension( const renderViewDimension_t dimension )
+	{
+		switch ( dimension ) {
+		case RENDER_VIEW_DIMENSION_BUFFER:		return D3D11_RTV_DIMENSION_BUFFER;
+		case RENDER_VIEW_DIMENSION_TEXTURE1D:	return D3D11_RTV_DIMENSION_TEXTURE1D;
+		case RENDER_VIEW_DIMENSION_TEXTURE2D:	return D3D11_RTV_DIMENSION_TEXTURE2D;
+		case RENDER_VIEW_DIMENSION_TEXTURE2DMS:	return D3D11_RTV_DIMENSION_TEXTURE2DMS;
+		case RENDER_VIEW_DIMENSION_TEXTURE3D:	return D3D11_RTV_DIMENSION_TEXTURE3D;
+		default:								return D3D11_RTV_DIMENSION_UNKNOWN;
+		}
+	}
+
+	D3D11_DSV_DIMENSION GetDSVDimension( const renderViewDimension_t dimension )
+	{
+		switch ( dimension ) {
+		case RENDER_VIEW_DIMENSION_TEXTURE1D:	return D3D11_DSV_DIMENSION_TEXTURE1D;
+		case RENDER_VIEW_DIMENSION_TEXTURE2D:	return D3D11_DSV_DIMENSION_TEXTURE2D;
+		case RENDER_VIEW_DIMENSION_TEXTURE2DMS:	return D3D11_DSV_DIMENSION_TEXTURE2DMS;
+		default:								return D3D11_DSV_DIMENSION_UNKNOWN;
+		}
+	}
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC GetSRVDesc( const renderViewDesc_t& desc )
+	{
+		D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = {};
+		viewDesc.Format			= static_cast<DXGI_FORMAT>( desc.format );
+		viewDesc.ViewDimension	= GetSRVDimension( desc.dimension );
+
+		// most detailed mip and mip levels are at the same place for every texture dimension
+		viewDesc.Texture2D.MostDetailedMip	= desc.mostDetailedMip;
+		viewDesc.Texture2D.MipLevels		= desc.mipLevels;
+
+		return viewDesc;
+	}
+
+	D3D11_RENDER_TARGET_VIEW_DESC GetRTVDesc( const renderViewDesc_t& desc )
+	{
+		D3D11_RENDER_TARGET_VIEW_DESC viewDesc = {};
+		viewDesc.Format			= static_cast<DXGI_FORMAT>( desc.format );
+		viewDesc.ViewDimension	= GetRTVDimension( desc.dimension );
+
+		if ( desc.dimension == RENDER_VIEW_DIMENSION_TEXTURE3D ) {
+			viewDesc.Texture3D.MipSlice		= desc.mipSlice;
+			viewDesc.Texture3D.FirstWSlice	= desc.firstSlice;
+			viewDesc.Texture3D.WSize		= desc.sliceCount;
+		} else {
+			viewDesc.Texture2D.MipSlice		= desc.mipSlice;
+		}
+
+		return viewDesc;
+	}
+
+	D3D11_DEPTH_STENCIL_VIEW_DESC GetDSVDesc( const renderViewDesc_t& desc )
+	{
+		D3D11_DEPTH_STENCIL_VIEW_DESC viewDesc = {};
+		viewDesc.Format				= static_cast<DXGI_FORMAT>( desc.format );
+		viewDesc.ViewDimension		= GetDSVDimension( desc.dimension );
+		viewDesc.Texture2D.MipSlice	= desc.mipSlice;
+
+		return viewDesc;
+	}
+
+	D3D11_DEPTH_STENCILOP_DESC GetStencilOpDesc( const renderStencilOpDesc_t& desc )
+	{
+		return {
+			static_cast<D3D11_STENCIL_OP>( desc.stencilFailOp ),
+			static_cast<D3D11_STENCIL_OP>( desc.stencilDepthFailOp ),
+			static_cast<D3D11_STENCIL_OP>( desc.stencilPassOp ),
+			static_cast<D3D11_COMPARISON_FUNC>( desc.stencilFunc ),
+		};
+	}
+
+	const bool ReadBlob( ID3D10Blob* blob, std::vector<uint8_t>& data )
+	{
+		if ( blob == nullptr ) {
+			return false;
+		}
+
+		const uint8_t* blobData = static_cast<const uint8_t*>( blob->GetBufferPointer() );
+		data.assign( blobData, blobData + blob->GetBufferSize() );
+
+		blob->Release();
+
+		return true;
+	}
+}
+
+RenderBackendD3D11::RenderBackendD3D11( ID3D11Device* renderDevice, ID3D11DeviceContext* context, ID3D11DeviceContext1* context1, IDXGISwapChain* renderSwapChain )
+	: device( renderDevice )
+	, deviceContext( context )
+	, deviceContext1( context1 )
+	, swapChain( renderSwapChain )
+	, commandList( nullptr )
+	, backBuffer( nullptr )
+	, supportsRanges( false )
+	, supportsNoOverwrite( false )
+{
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+
+	// fails on a 11.0 runtime; every option stays false
+	device->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof( D3D11_FEATURE_DATA_D3D11_OPTIONS ) );
+
+	supportsRanges		= ( deviceContext1 != nullptr ) && options.ConstantBufferOffsetting;
+	supportsNoOverwrite	= options.MapNoOverwriteOnDynamicConstantBuffer != FALSE;
+}
+
+RenderBackendD3D11::~RenderBackendD3D11()
+{
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	if ( swapChain != nullptr ) {
+		swapChain->SetFullscreenState( false, nullptr );
+	}
+
+	RELEASE( commandList )
+	RELEASE( backBuffer )
+	RELEASE( deviceContext1 )
+	RELEASE( deviceContext )
+	RELEASE( swapChain )
+	RELEASE( device )
+}
+
+const bool RenderBackendD3D11::SupportsConstantBufferRanges() const
+{
+	return supportsRanges;
+}
+
+const bool RenderBackendD3D11::SupportsNoOverwriteConstantBufferMaps() const
+{
+	return supportsNoOverwrite;
+}
+
+renderBuffer_t* RenderBackendD3D11::CreateBuffer( const renderBufferDesc_t& desc, const void* initialData )
+{
+	const D3D11_BUFFER_DESC bufferDesc = {
+		desc.size,											// UINT ByteWidth
+		static_cast<D3D11_USAGE>( desc.usage ),				// D3D11_USAGE Usage
+		desc.bindFlags,										// UINT BindFlags
+		desc.cpuAccessFlags,								// UINT CPUAccessFlags
+		desc.miscFlags,										// UINT MiscFlags
+		desc.structureStride,								// UINT StructureByteStride
+	};
+
+	const D3D11_SUBRESOURCE_DATA data = {
+		initialData,										// const void* pSysMem
+		0,													// UINT SysMemPitch
+		0,													// UINT SysMemSlicePitch
+	};
+
+	d3d11Buffer_t* buffer = Wrap<d3d11Buffer_t, ID3D11Buffer>( [&]( ID3D11Buffer** object ) {
+		return device->CreateBuffer( &bufferDesc, ( initialData != nullptr ) ? &data : NULL, object );
+	} );
+
+	if ( buffer != nullptr ) {
+		buffer->desc = desc;
+	}
+
+	return buffer;
+}
+
+renderTexture_t* RenderBackendD3D11::CreateTexture( const renderTextureDesc_t& desc )
+{
+	ID3D11Resource* resource = nullptr;
+	HRESULT createResult = E_INVALIDARG;
+
+	switch ( desc.dimension ) {
+	case RENDER_TEXTURE_DIMENSION_1D: {
+		const D3D11_TEXTURE1D_DESC textureDesc = {
+			desc.width,										// UINT Width
+			desc.mipLevels,									// UINT MipLevels
+			desc.arraySize,									// UINT ArraySize
+			static_cast<DXGI_FORMAT>( desc.format ),		// DXGI_FORMAT Format
+			static_cast<D3D11_USAGE>( desc.usage ),			// D3D11_USAGE Usage
+			desc.bindFlags,									// UINT BindFlags
+			desc.cpuAccessFlags,							// UINT CPUAccessFlags
+			desc.miscFlags,									// UINT MiscFlags
+		};
+
+		createResult = device->CreateTexture1D( &textureDesc, NULL, reinterpret_cast<ID3D11Texture1D**>( &resource ) );
+	} break;
+
+	case RENDER_TEXTURE_DIMENSION_2D: {
+		const D3D11_TEXTURE2D_DESC textureDesc = {
+			desc.width,										// UINT Width
+			desc.height,									// UINT Height
+			desc.mipLevels,									// UINT MipLevels
+			desc.arraySize,									// UINT ArraySize
+			static_cast<DXGI_FORMAT>( desc.format ),		// DXGI_FORMAT Format
+			{												// DXGI_SAMPLE_DESC SampleDesc
+				desc.sampleCount,							//		UINT Count
+				0,											//		UINT Quality
+			},												//
+			static_cast<D3D11_USAGE>( desc.usage ),			// D3D11_USAGE Usage
+			desc.bindFlags,									// UINT BindFlags
+			desc.cpuAccessFlags,							// UINT CPUAccessFlags
+			desc.miscFlags,									// UINT MiscFlags
+		};
+
+		createResult = device->CreateTexture2D( &textureDesc, NULL, reinterpret_cast<ID3D11Texture2D**>( &resource ) );
+	} break;
+
+	case RENDER_TEXTURE_DIMENSION_3D: {
+		const D3D11_TEXTURE3D_DESC textureDesc = {
+			desc.width,										// UINT Width
+			desc.height,									// UINT Height
+			desc.depth,										// UINT Depth
+			desc.mipLevels,									// UINT MipLevels
+			static_cast<DXGI_FORMAT>( desc.format ),		// DXGI_FORMAT Format
+			static_cast<D3D11_USAGE>( desc.usage ),			// D3D11_USAGE Usage
+			desc.bindFlags,									// UINT BindFlags
+			desc.cpuAccessFlags,							// UINT CPUAccessFlags
+			desc.miscFlags,									// UINT MiscFlags
+		};
+
+		createResult = device->CreateTexture3D( &textureDesc, NULL, reinterpret_cast<ID3D11Texture3D**>( &resource ) );
+	} break;
+	}
+
+	if ( FAILED( createResult ) || resource == nullptr ) {
+		return nullptr;
+	}
+
+	d3d11Texture_t* texture = new d3d11Texture_t();
+	texture->object	= resource;
+	texture->desc	= desc;
+
+	return texture;
+}
+
+renderTexture_t* RenderBackendD3D11::CreateTextureFromFile( const wchar_t* path, renderShaderResourceView_t** view )
+{
+	ID3D11Resource* resource = nullptr;
+	ID3D11ShaderResourceView* resourceView = nullptr;
+
+	if ( FAILED( DirectX::CreateDDSTextureFromFile( device, path, &resource, &resourceView ) ) ) {
+		return nullptr;
+	}
+
+	// the loader picks the description; only the dimension matters to the callers
+	d3d11Texture_t* texture = new d3d11Texture_t();
+	texture->object	= resource;
+	texture->desc	= {};
+
+	D3D11_RESOURCE_DIMENSION dimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+	resource->GetType( &dimension );
+
+	texture->desc.dimension = ( dimension == D3D11_RESOURCE_DIMENSION_TEXTURE1D ) ? RENDER_TEXTURE_DIMENSION_1D
+							: ( dimension == D3D11_RESOURCE_DIMENSION_TEXTURE3D ) ? RENDER_TEXTURE_DIMENSION_3D
+							: RENDER_TEXTURE_DIMENSION_2D;
+
+	if ( view != nullptr ) {
+		*view = WrapView<d3d11ShaderResourceView_t>( resourceView, texture );
+	} else {
+		resourceView->Release();
+	}
+
+	return texture;
+}
+
+renderShaderResourceView_t* RenderBackendD3D11::CreateShaderResourceView( renderResource_t* resource, const renderViewDesc_t* desc )
+{
+	ID3D11Resource* d3dResource = GetResource( resource );
+
+	if ( d3dResource == nullptr ) {
+		return nullptr;
+	}
+
+	const D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc = ( desc != nullptr ) ? GetSRVDesc( *desc ) : D3D11_SHADER_RESOURCE_VIEW_DESC{};
+
+	ID3D11ShaderResourceView* view = nullptr;
+
+	if ( FAILED( device->CreateShaderResourceView( d3dResource, ( desc != nullptr ) ? &viewDesc : NULL, &view ) ) ) {
+		return nullptr;
+	}
+
+	return WrapView<d3d11ShaderResourceView_t>( view, resource );
+}
+
+renderTargetView_t* RenderBackendD3D11::CreateRenderTargetView( renderTexture_t* texture, const renderViewDesc_t* desc )
+{
+	ID3D11Resource* d3dResource = GetObject<ID3D11Resource>( texture );
+
+	if ( d3dResource == nullptr ) {
+		return nullptr;
+	}
+
+	const D3D11_RENDER_TARGET_VIEW_DESC viewDesc = ( desc != nullptr ) ? GetRTVDesc( *desc ) : D3D11_RENDER_TARGET_VIEW_DESC{};
+
+	ID3D11RenderTargetView* view = nullptr;
+
+	if ( FAILED( device->CreateRenderTargetView( d3dResource, ( desc != nullptr ) ? &viewDesc : NULL, &view ) ) ) {
+		return nullptr;
+	}
+
+	return WrapView<d3d11RenderTargetView_t>( view, texture );
+}
+
+renderDepthStencilView_t* RenderBackendD3D11::CreateDepthStencilView( renderTexture_t* texture, const renderViewDesc_t* desc )
+{
+	ID3D11Resource* d3dResource = GetObject<ID3D11Resource>( texture );
+
+	if ( d3dResource == nullptr ) {
+		return nullptr;
+	}
+
+	const D3D11_DEPTH_STENCIL_VIEW_DESC viewDesc = ( desc != nullptr ) ? GetDSVDesc( *desc ) : D3D11_DEPTH_STENCIL_VIEW_DESC{};
+
+	ID3D11DepthStencilView* view = nullptr;
+
+	if ( FAILED( device->CreateDepthStencilView( d3dResource, ( desc != nullptr ) ? &viewDesc : NULL, &view ) ) ) {
+		return nullptr;
+	}
+
+	return WrapView<d3d11DepthStencilView_t>( view, texture );
+}
+
+renderVertexShader_t* RenderBackendD3D11::CreateVertexShader( const void* bytecode, const size_t bytecodeSize )
+{
+	return Wrap<d3d11VertexShader_t, ID3D11VertexShader>( [&]( ID3D11VertexShader** object ) {
+		return device->CreateVertexShader( bytecode, bytecodeSize, NULL, object );
+	} );
+}
+
+renderPixelShader_t* RenderBackendD3D11::CreatePixelShader( const void* bytecode, const size_t bytecodeSize )
+{
+	return Wrap<d3d11PixelShader_t, ID3D11PixelShader>( [&]( ID3D11PixelShader** object ) {
+		return device->CreatePixelShader( bytecode, bytecodeSize, NULL, object );
+	} );
+}
+
+renderInputLayout_t* RenderBackendD3D11::CreateInputLayout( const renderInputElementDesc_t* elements, const uint32_t elementCount, const void* bytecode, const size_t bytecodeSize )
+{
+	std::vector<D3D11_INPUT_ELEMENT_DESC> elementDescs( elementCount );
+
+	for ( uint32_t i = 0; i < elementCount; ++i ) {
+		const renderInputElementDesc_t& element = elements[i];
+
+		elementDescs[i] = {
+			element.semanticName,													// LPCSTR SemanticName
+			element.semanticIndex,													// UINT SemanticIndex
+			static_cast<DXGI_FORMAT>( element.format ),								// DXGI_FORMAT Format
+			element.inputSlot,														// UINT InputSlot
+			element.alignedByteOffset,												// UINT AlignedByteOffset
+			static_cast<D3D11_INPUT_CLASSIFICATION>( element.inputSlotClass ),		// D3D11_INPUT_CLASSIFICATION InputSlotClass
+			element.instanceDataStepRate,											// UINT InstanceDataStepRate
+		};
+	}
+
+	return Wrap<d3d11InputLayout_t, ID3D11InputLayout>( [&]( ID3D11InputLayout** object ) {
+		return device->CreateInputLayout( elementDescs.data(), elementCount, bytecode, bytecodeSize, object );
+	} );
+}
+
+renderSamplerState_t* RenderBackendD3D11::CreateSamplerState( const renderSamplerDesc_t& desc )
+{
+	const D3D11_SAMPLER_DESC samplerDesc = {
+		static_cast<D3D11_FILTER>( desc.filter ),							// D3D11_FILTER Filter
+		static_cast<D3D11_TEXTURE_ADDRESS_MODE>( desc.addressU ),			// D3D11_TEXTURE_ADDRESS_MODE AddressU
+		static_cast<D3D11_TEXTURE_ADDRESS_MODE>( desc.addressV ),			// D3D11_TEXTURE_ADDRESS_MODE AddressV
+		static_cast<D3D11_TEXTURE_ADDRESS_MODE>( desc.addressW ),			// D3D11_TEXTURE_ADDRESS_MODE AddressW
+		desc.mipLODBias,													// FLOAT MipLODBias
+		desc.maxAnisotropy,													// UINT MaxAnisotropy
+		static_cast<D3D11_COMPARISON_FUNC>( desc.comparisonFunc ),			// D3D11_COMPARISON_FUNC ComparisonFunc
+		{ desc.borderColor[0], desc.borderColor[1], desc.borderColor[2], desc.borderColor[3] },	// FLOAT BorderColor[4]
+		desc.minLOD,														// FLOAT MinLOD
+		desc.maxLOD,														// FLOAT MaxLOD
+	};
+
+	return Wrap<d3d11SamplerState_t, ID3D11SamplerState>( [&]( ID3D11SamplerState** object ) {
+		return device->CreateSamplerState( &samplerDesc, object );
+	} );
+}
+
+renderBlendState_t* RenderBackendD3D11::CreateBlendState( const renderBlendDesc_t& desc )
+{
+	D3D11_BLEND_DESC blendDesc = {};
+	blendDesc.AlphaToCoverageEnable		= desc.alphaToCoverageEnable;
+	blendDesc.IndependentBlendEnable	= desc.independentBlendEnable;
+
+	for ( uint32_t i = 0; i < RENDER_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i ) {
+		const renderTargetBlendDesc_t& renderTarget = desc.renderTarget[i];
+
+		blendDesc.RenderTarget[i] = {
+			static_cast<BOOL>( renderTarget.blendEnable ),					// BOOL BlendEnable
+			static_cast<D3D11_BLEND>( renderTarget.srcBlend ),				// D3D11_BLEND SrcBlend
+			static_cast<D3D11_BLEND>( renderTarget.destBlend ),				// D3D11_BLEND DestBlend
+			static_cast<D3D11_BLEND_OP>( renderTarget.blendOp ),			// D3D11_BLEND_OP BlendOp
+			static_cast<D3D11_BLEND>( renderTarget.srcBlendAlpha ),			// D3D11_BLEND SrcBlendAlpha
+			static_cast<D3D11_BLEND>( renderTarget.destBlendAlpha ),		// D3D11_BLEND DestBlendAlpha
+			static_cast<D3D11_BLEND_OP>( renderTarget.blendOpAlpha ),		// D3D11_BLEND_OP BlendOpAlpha
+			static_cast<UINT8>( renderTarget.writeMask ),					// UINT8 RenderTargetWriteMask
+		};
+	}
+
+	return Wrap<d3d11BlendState_t, ID3D11BlendState>( [&]( ID3D11BlendState** object ) {
+		return device->CreateBlendState( &blendDesc, object );
+	} );
+}
+
+renderRasterizerState_t* RenderBackendD3D11::CreateRasterizerState( const renderRasterizerDesc_t& desc )
+{
+	const D3D11_RASTERIZER_DESC rasterizerDesc = {
+		static_cast<D3D11_FILL_MODE>( desc.fillMode ),					// D3D11_FILL_MODE FillMode
+		static_cast<D3D11_CULL_MODE>( desc.cullMode ),					// D3D11_CULL_MODE CullMode
+		static_cast<BOOL>( desc.frontCounterClockwise ),				// BOOL FrontCounterClockwise
+		desc.depthBias,													// INT DepthBias
+		desc.depthBiasClamp,											// FLOAT DepthBiasClamp
+		desc.slopeScaledDepthBias,										// FLOAT SlopeScaledDepthBias
+		static_cast<BOOL>( desc.depthClipEnable ),						// BOOL DepthClipEnable
+		static_cast<BOOL>( desc.scissorEnable ),						// BOOL ScissorEnable
+		static_cast<BOOL>( desc.multisampleEnable ),					// BOOL MultisampleEnable
+		static_cast<BOOL>( desc.antialiasedLineEnable ),				// BOOL AntialiasedLineEnable
+	};
+
+	return Wrap<d3d11RasterizerState_t, ID3D11RasterizerState>( [&]( ID3D11RasterizerState** object ) {
+		return device->CreateRasterizerState( &rasterizerDesc, object );
+	} );
+}
+
+renderDepthStencilState_t* RenderBackendD3D11::CreateDepthStencilState( const renderDepthStencilDesc_t& desc )
+{
+	const D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {
+		static_cast<BOOL>( desc.depthEnable ),							// BOOL DepthEnable
+		static_cast<D3D11_DEPTH_WRITE_MASK>( desc.depthWriteMask ),		// D3D11_DEPTH_WRITE_MASK DepthWriteMask
+		static_cast<D3D11_COMPARISON_FUNC>( desc.depthFunc ),			// D3D11_COMPARISON_FUNC DepthFunc
+		static_cast<BOOL>( desc.stencilEnable ),						// BOOL StencilEnable
+		static_cast<UINT8>( desc.stencilReadMask ),						// UINT8 StencilReadMask
+		static_cast<UINT8>( desc.stencilWriteMask ),					// UINT8 StencilWriteMask
+		GetStencilOpDesc( desc.frontFace ),								// D3D11_DEPTH_STENCILOP_DESC FrontFace
+		GetStencilOpDesc( desc.backFace ),								// D3D11_DEPTH_STENCILOP_DESC BackFace
+	};
+
+	return Wrap<d3d11DepthStencilState_t, ID3D11DepthStencilState>( [&]( ID3D11DepthStencilState** object ) {
+		return device->CreateDepthStencilState( &depthStencilDesc, object );
+	} );
+}
+
+renderQuery_t* RenderBackendD3D11::CreateQuery( const renderQueryType_t type )
+{
+	const D3D11_QUERY_DESC queryDesc = { static_cast<D3D11_QUERY>( type ), 0 };
+
+	d3d11Query_t* query = Wrap<d3d11Query_t, ID3D11Query>( [&]( ID3D11Query** object ) {
+		return device->CreateQuery( &queryDesc, object );
+	} );
+
+	if ( query != nullptr ) {
+		query->type = type;
+	}
+
+	return query;
+}
+
+const bool RenderBackendD3D11::CompileShader( const wchar_t* sourcePath, const renderShaderMacro_t* defines, const char* entryPoint, const char* profile, const uint32_t flags, std::vector<uint8_t>& bytecode, std::string& errors )
+{
+	std::vector<D3D_SHADER_MACRO> macros;
+
+	for ( const renderShaderMacro_t* define = defines; define != nullptr && define->name != nullptr; ++define ) {
+		macros.push_back( { define->name, define->definition } );
+	}
+
+	macros.push_back( { NULL, NULL } );
+
+	ID3D10Blob* compiled = nullptr;
+	ID3D10Blob* compileErrors = nullptr;
+
+	const HRESULT compileResult = D3DCompileFromFile( sourcePath, macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE, entryPoint, profile, flags, 0, &compiled, &compileErrors );
+
+	std::vector<uint8_t> errorMessage;
+
+	if ( ReadBlob( compileErrors, errorMessage ) ) {
+		errors.assign( errorMessage.begin(), errorMessage.end() );
+	}
+
+	if ( FAILED( compileResult ) ) {
+		if ( compiled != nullptr ) {
+			compiled->Release();
+		}
+
+		return false;
+	}
+
+	return ReadBlob( compiled, bytecode );
+}
+
+const bool RenderBackendD3D11::PreprocessShader( const wchar_t* sourcePath, const std::vector<uint8_t>& source, std::vector<uint8_t>& preprocessed, std::string& errors )
+{
+	// includes are looked up next to the source
+	char sourcePathAnsi[MAX_PATH];
+	WideCharToMultiByte( CP_UTF8, 0, sourcePath, -1, sourcePathAnsi, MAX_PATH, NULL, NULL );
+
+	ID3D10Blob* preprocessedBlob = nullptr;
+	ID3D10Blob* preprocessErrors = nullptr;
+
+	const HRESULT preprocessResult = D3DPreprocess( source.data(), source.size(), sourcePathAnsi, NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE, &preprocessedBlob, &preprocessErrors );
+
+	std::vector<uint8_t> errorMessage;
+
+	if ( ReadBlob( preprocessErrors, errorMessage ) ) {
+		errors.assign( errorMessage.begin(), errorMessage.end() );
+	}
+
+	if ( FAILED( preprocessResult ) ) {
+		if ( preprocessedBlob != nullptr ) {
+			preprocessedBlob->Release();
+		}
+
+		return false;
+	}
+
+	return ReadBlob( preprocessedBlob, preprocessed );
+}
+
+const bool RenderBackendD3D11::LoadShaderBytecode( const wchar_t* path, std::vector<uint8_t>& bytecode )
+{
+	ID3D10Blob* blob = nullptr;
+
+	if ( FAILED( D3DReadFileToBlob( path, &blob ) ) ) {
+		return false;
+	}
+
+	return ReadBlob( blob, bytecode );
+}
+
+RenderBackend* RenderBackendD3D11::CreateDeferredBackend()
+{
+	ID3D11DeviceContext* deferredContext = nullptr;
+
+	if ( FAILED( device->CreateDeferredContext( 0, &deferredContext ) ) ) {
+		return nullptr;
+	}
+
+	ID3D11DeviceContext1* deferredContext1 = nullptr;
+
+	if ( FAILED( deferredContext->QueryInterface( __uuidof( ID3D11DeviceContext1 ), ( void** )&deferredContext1 ) ) ) {
+		deferredContext1 = nullptr;
+	}
+
+	device->AddRef();
+
+	return new RenderBackendD3D11( device, deferredContext, deferredContext1, nullptr );
+}
+
+renderTargetView_t* RenderBackendD3D11::GetBackBuffer()
+{
+	return backBuffer;
+}
+
+const bool RenderBackendD3D11::ResizeBackBuffer( const uint32_t width, const uint32_t height )
+{
+	if ( swapChain == nullptr ) {
+		return false;
+	}
+
+	deviceContext->OMSetRenderTargets( 0, 0, 0 );
+
+	RELEASE( backBuffer )
+
+	// sized from the window
+	swapChain->ResizeBuffers( 0, 0, 0, DXGI_FORMAT_UNKNOWN, 0 );
+
+	ID3D11Texture2D* backBufferTexture = nullptr;
+
+	if ( FAILED( swapChain->GetBuffer( 0, __uuidof( ID3D11Texture2D ), ( void** )&backBufferTexture ) ) ) {
+		return false;
+	}
+
+	d3d11Texture_t* texture = new d3d11Texture_t();
+	texture->object	= backBufferTexture;
+	texture->desc	= {};
+	texture->desc.dimension	= RENDER_TEXTURE_DIMENSION_2D;
+	texture->desc.width		= width;
+	texture->desc.height	= height;
+
+	backBuffer = CreateRenderTargetView( texture, nullptr );
+
+	// the view keeps the texture alive
+	texture->Release();
+
+	return backBuffer != nullptr;
+}
+
+void RenderBackendD3D11::Present( const bool enableVsync )
+{
+	swapChain->Present( ( enableVsync ? 1 : 0 ), 0 );
+}
+
+void RenderBackendD3D11::SetPrimitiveTopology( const renderPrimitiveTopology_t topology )
+{
+	deviceContext->IASetPrimitiveTopology( static_cast<D3D11_PRIMITIVE_TOPOLOGY>( topology ) );
+}
+
+void RenderBackendD3D11::SetInputLayout( renderInputLayout_t* inputLayout )
+{
+	deviceContext->IASetInputLayout( GetObject<ID3D11InputLayout>( inputLayout ) );
+}
+
+void RenderBackendD3D11::SetVertexBuffer( const uint32_t slot, renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset )
+{
+	ID3D11Buffer* vertexBuffer = GetObject<ID3D11Buffer>( buffer );
+	deviceContext->IASetVertexBuffers( slot, 1, &vertexBuffer, &stride, &offset );
+}
+
+void RenderBackendD3D11::SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset )
+{
+	deviceContext->IASetIndexBuffer( GetObject<ID3D11Buffer>( buffer ), static_cast<DXGI_FORMAT>( format ), offset );
+}
+
+void RenderBackendD3D11::SetVertexShader( renderVertexShader_t* shader )
+{
+	deviceContext->VSSetShader( GetObject<ID3D11VertexShader>( shader ), NULL, 0 );
+}
+
+void RenderBackendD3D11::SetPixelShader( renderPixelShader_t* shader )
+{
+	deviceContext->PSSetShader( GetObject<ID3D11PixelShader>( shader ), NULL, 0 );
+}
+
+void RenderBackendD3D11::SetConstantBuffers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers )
+{
+	ID3D11Buffer* constantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	GetObjects( constantBuffers, count, buffers );
+
+	if ( stage == RENDER_STAGE_VERTEX ) {
+		deviceContext->VSSetConstantBuffers( first, count, constantBuffers );
+	} else {
+		deviceContext->PSSetConstantBuffers( first, count, constantBuffers );
+	}
+}
+
+void RenderBackendD3D11::SetConstantBufferRange( const renderStage_t stage, const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount )
+{
+	ID3D11Buffer* constantBuffer = GetObject<ID3D11Buffer>( buffer );
+
+	if ( stage == RENDER_STAGE_VERTEX ) {
+		deviceContext1->VSSetConstantBuffers1( slot, 1, &constantBuffer, &firstConstant, &constantCount );
+	} else {
+		deviceContext1->PSSetConstantBuffers1( slot, 1, &constantBuffer, &firstConstant, &constantCount );
+	}
+}
+
+void RenderBackendD3D11::SetShaderResources( const renderStage_t stage, const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views )
+{
+	ID3D11ShaderResourceView* resourceViews[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+	GetObjects( resourceViews, count, views );
+
+	if ( stage == RENDER_STAGE_VERTEX ) {
+		deviceContext->VSSetShaderResources( first, count, resourceViews );
+	} else {
+		deviceContext->PSSetShaderResources( first, count, resourceViews );
+	}
+}
+
+void RenderBackendD3D11::SetSamplers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderSamplerState_t* const* samplers )
+{
+	ID3D11SamplerState* samplerStates[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+	GetObjects( samplerStates, count, samplers );
+
+	if ( stage == RENDER_STAGE_VERTEX ) {
+		deviceContext->VSSetSamplers( first, count, samplerStates );
+	} else {
+		deviceContext->PSSetSamplers( first, count, samplerStates );
+	}
+}
+
+void RenderBackendD3D11::SetRasterizerState( renderRasterizerState_t* state )
+{
+	deviceContext->RSSetState( GetObject<ID3D11RasterizerState>( state ) );
+}
+
+void RenderBackendD3D11::SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t stencilRef )
+{
+	deviceContext->OMSetDepthStencilState( GetObject<ID3D11DepthStencilState>( state ), stencilRef );
+}
+
+void RenderBackendD3D11::SetBlendState( renderBlendState_t* state )
+{
+	deviceContext->OMSetBlendState( GetObject<ID3D11BlendState>( state ), NULL, 0xFFFFFFFF );
+}
+
+void RenderBackendD3D11::SetRenderTargets( const uint32_t count, renderTargetView_t* const* views, renderDepthStencilView_t* depthView )
+{
+	ID3D11RenderTargetView* renderTargetViews[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+	GetObjects( renderTargetViews, count, views );
+
+	deviceContext->OMSetRenderTargets( count, renderTargetViews, GetObject<ID3D11DepthStencilView>( depthView ) );
+}
+
+void RenderBackendD3D11::SetViewport( const renderViewport_t& viewport )
+{
+	deviceContext->RSSetViewports( 1, reinterpret_cast<const D3D11_VIEWPORT*>( &viewport ) );
+}
+
+renderViewport_t RenderBackendD3D11::GetViewport()
+{
+	renderViewport_t viewport = {};
+
+	UINT viewportCount = 1;
+	deviceContext->RSGetViewports( &viewportCount, reinterpret_cast<D3D11_VIEWPORT*>( &viewport ) );
+
+	return viewport;
+}
+
+void RenderBackendD3D11::ClearRenderTarget( renderTargetView_t* view, const float color[4] )
+{
+	deviceContext->ClearRenderTargetView( GetObject<ID3D11RenderTargetView>( view ), color );
+}
+
+void RenderBackendD3D11::ClearDepthStencil( renderDepthStencilView_t* view, const uint32_t clearFlags, const float depth, const uint8_t stencil )
+{
+	deviceContext->ClearDepthStencilView( GetObject<ID3D11DepthStencilView>( view ), clearFlags, depth, stencil );
+}
+
+void RenderBackendD3D11::Draw( const uint32_t vertexCount, const uint32_t startVertex )
+{
+	deviceContext->Draw( vertexCount, startVertex );
+}
+
+void RenderBackendD3D11::DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex )
+{
+	deviceContext->DrawIndexed( indexCount, startIndex, baseVertex );
+}
+
+void RenderBackendD3D11::DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance )
+{
+	deviceContext->DrawIndexedInstanced( indexCount, instanceCount, startIndex, baseVertex, startInstance );
+}
+
+void* RenderBackendD3D11::MapBuffer( renderBuffer_t* buffer, const renderMap_t mapType )
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+
+	if ( FAILED( deviceContext->Map( GetObject<ID3D11Buffer>( buffer ), 0, static_cast<D3D11_MAP>( mapType ), 0, &mappedResource ) ) ) {
+		return nullptr;
+	}
+
+	return mappedResource.pData;
+}
+
+void RenderBackendD3D11::UnmapBuffer( renderBuffer_t* buffer )
+{
+	deviceContext->Unmap( GetObject<ID3D11Buffer>( buffer ), 0 );
+}
+
+void RenderBackendD3D11::UpdateBuffer( renderBuffer_t* buffer, const uint32_t offset, const uint32_t size, const void* data )
+{
+	// boxes are in bytes for buffers
+	const D3D11_BOX box = { offset, 0, 0, offset + size, 1, 1 };
+	deviceContext->UpdateSubresource( GetObject<ID3D11Buffer>( buffer ), 0, &box, data, 0, 0 );
+}
+
+void RenderBackendD3D11::CopyResource( renderResource_t* destination, renderResource_t* source )
+{
+	deviceContext->CopyResource( GetResource( destination ), GetResource( source ) );
+}
+
+void RenderBackendD3D11::CopyBufferRegion( renderBuffer_t* destination, const uint32_t destinationOffset, renderBuffer_t* source, const uint32_t sourceOffset, const uint32_t size )
+{
+	const D3D11_BOX sourceBox = { sourceOffset, 0, 0, sourceOffset + size, 1, 1 };
+	deviceContext->CopySubresourceRegion( GetObject<ID3D11Buffer>( destination ), 0, destinationOffset, 0, 0, GetObject<ID3D11Buffer>( source ), 0, &sourceBox );
+}
+
+void RenderBackendD3D11::ResolveSubresource( renderTexture_t* destination, renderTexture_t* source, const renderFormat_t format )
+{
+	deviceContext->ResolveSubresource( GetObject<ID3D11Resource>( destination ), 0, GetObject<ID3D11Resource>( source ), 0, static_cast<DXGI_FORMAT>( format ) );
+}
+
+void RenderBackendD3D11::GenerateMips( renderShaderResourceView_t* view )
+{
+	deviceContext->GenerateMips( GetObject<ID3D11ShaderResourceView>( view ) );
+}
+
+void RenderBackendD3D11::BeginQuery( renderQuery_t* query )
+{
+	deviceContext->Begin( GetObject<ID3D11Query>( query ) );
+}
+
+void RenderBackendD3D11::EndQuery( renderQuery_t* query )
+{
+	deviceContext->End( GetObject<ID3D11Query>( query ) );
+}
+
+const bool RenderBackendD3D11::GetQueryData( renderQuery_t* query, void* data, const uint32_t dataSize )
+{
+	ID3D11Query* d3dQuery = GetObject<ID3D11Query>( query );
+
+	if ( query->type != RENDER_QUERY_TIMESTAMP_DISJOINT ) {
+		return deviceContext->GetData( d3dQuery, data, dataSize, D3D11_ASYNC_GETDATA_DONOTFLUSH ) == S_OK;
+	}
+
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData = {};
+
+	if ( dataSize < sizeof( renderQueryTimestampDisjoint_t ) || deviceContext->GetData( d3dQuery, &disjointData, sizeof( disjointData ), D3D11_ASYNC_GETDATA_DONOTFLUSH ) != S_OK ) {
+		return false;
+	}
+
+	renderQueryTimestampDisjoint_t* timestampDisjoint = static_cast<renderQueryTimestampDisjoint_t*>( data );
+	timestampDisjoint->frequency	= disjointData.Frequency;
+	timestampDisjoint->disjoint		= disjointData.Disjoint;
+
+	return true;
+}
+
+void RenderBackendD3D11::FinishCommandList()
+{
+	RELEASE( commandList )
+
+	// the deferred context starts over from the default state
+	if ( FAILED( deviceContext->FinishCommandList( FALSE, &commandList ) ) ) {
+		commandList = nullptr;
+	}
+}
+
+void RenderBackendD3D11::ExecuteCommandList( RenderBackend* deferred )
+{
+	RenderBackendD3D11* deferredBackend = static_cast<RenderBackendD3D11*>( deferred );
+
+	if ( deferredBackend->commandList == nullptr ) {
+		return;
+	}
+
+	// restoring the state keeps the state cache of the immediate context valid
+	deviceContext->ExecuteCommandList( deferredBackend->commandList, TRUE );
+
+	deferredBackend->commandList->Release();
+	deferredBackend->commandList = nullptr;
+}
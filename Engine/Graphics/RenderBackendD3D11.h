@@ -0,0 +1,103 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+#include <d3d11_1.h>
+
+// d3d11 device and context (immediate or deferred); handles wrap the d3d objects
+// the backend takes over the references it is given; only the immediate one has a swap chain (see RenderContextD3D11)
+class RenderBackendD3D11 : public RenderBackend
+{
+public:
+	inline ID3D11Device*		GetDevice() const			{ return device; } // for the d3d11 only tools (editor ui)
+	inline ID3D11DeviceContext*	GetDeviceContext() const	{ return deviceContext; }
+
+public:
+							RenderBackendD3D11( ID3D11Device* device, ID3D11DeviceContext* context, ID3D11DeviceContext1* context1, IDXGISwapChain* swapChain ); // context1 and swapChain are optional
+							RenderBackendD3D11( RenderBackendD3D11& ) = delete;
+							~RenderBackendD3D11();
+
+	const bool				SupportsConstantBufferRanges() const override;
+	const bool				SupportsNoOverwriteConstantBufferMaps() const override;
+
+	renderBuffer_t*				CreateBuffer( const renderBufferDesc_t& desc, const void* initialData ) override;
+	renderTexture_t*			CreateTexture( const renderTextureDesc_t& desc ) override;
+	renderTexture_t*			CreateTextureFromFile( const wchar_t* path, renderShaderResourceView_t** view ) override;
+	renderShaderResourceView_t*	CreateShaderResourceView( renderResource_t* resource, const renderViewDesc_t* desc ) override;
+	renderTargetView_t*			CreateRenderTargetView( renderTexture_t* texture, const renderViewDesc_t* desc ) override;
+	renderDepthStencilView_t*	CreateDepthStencilView( renderTexture_t* texture, const renderViewDesc_t* desc ) override;
+
+	renderVertexShader_t*		CreateVertexShader( const void* bytecode, const size_t bytecodeSize ) override;
+	renderPixelShader_t*		CreatePixelShader( const void* bytecode, const size_t bytecodeSize ) override;
+	renderInputLayout_t*		CreateInputLayout( const renderInputElementDesc_t* elements, const uint32_t elementCount, const void* bytecode, const size_t bytecodeSize ) override;
+
+	renderSamplerState_t*		CreateSamplerState( const renderSamplerDesc_t& desc ) override;
+	renderBlendState_t*			CreateBlendState( const renderBlendDesc_t& desc ) override;
+	renderRasterizerState_t*	CreateRasterizerState( const renderRasterizerDesc_t& desc ) override;
+	renderDepthStencilState_t*	CreateDepthStencilState( const renderDepthStencilDesc_t& desc ) override;
+	renderQuery_t*				CreateQuery( const renderQueryType_t type ) override;
+
+	const bool				CompileShader( const wchar_t* sourcePath, const renderShaderMacro_t* defines, const char* entryPoint, const char* profile, const uint32_t flags, std::vector<uint8_t>& bytecode, std::string& errors ) override;
+	const bool				PreprocessShader( const wchar_t* sourcePath, const std::vector<uint8_t>& source, std::vector<uint8_t>& preprocessed, std::string& errors ) override;
+	const bool				LoadShaderBytecode( const wchar_t* path, std::vector<uint8_t>& bytecode ) override;
+
+	RenderBackend*			CreateDeferredBackend() override;
+
+	renderTargetView_t*		GetBackBuffer() override;
+	const bool				ResizeBackBuffer( const uint32_t width, const uint32_t height ) override;
+	void					Present( const bool enableVsync ) override;
+
+	void					SetPrimitiveTopology( const renderPrimitiveTopology_t topology ) override;
+	void					SetInputLayout( renderInputLayout_t* inputLayout ) override;
+	void					SetVertexBuffer( const uint32_t slot, renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset ) override;
+	void					SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset ) override;
+
+	void					SetVertexShader( renderVertexShader_t* shader ) override;
+	void					SetPixelShader( renderPixelShader_t* shader ) override;
+	void					SetConstantBuffers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers ) override;
+	void					SetConstantBufferRange( const renderStage_t stage, const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount ) override;
+	void					SetShaderResources( const renderStage_t stage, const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views ) override;
+	void					SetSamplers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderSamplerState_t* const* samplers ) override;
+
+	void					SetRasterizerState( renderRasterizerState_t* state ) override;
+	void					SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t stencilRef ) override;
+	void					SetBlendState( renderBlendState_t* state ) override;
+
+	void					SetRenderTargets( const uint32_t count, renderTargetView_t* const* views, renderDepthStencilView_t* depthView ) override;
+	void					SetViewport( const renderViewport_t& viewport ) override;
+	renderViewport_t		GetViewport() override;
+
+	void					ClearRenderTarget( renderTargetView_t* view, const float color[4] ) override;
+	void					ClearDepthStencil( renderDepthStencilView_t* view, const uint32_t clearFlags, const float depth, const uint8_t stencil ) override;
+
+	void					Draw( const uint32_t vertexCount, const uint32_t startVertex ) override;
+	void					DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex ) override;
+	void					DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance ) override;
+
+	void*					MapBuffer( renderBuffer_t* buffer, const renderMap_t mapType ) override;
+	void					UnmapBuffer( renderBuffer_t* buffer ) override;
+	void					UpdateBuffer( renderBuffer_t* buffer, const uint32_t offset, const uint32_t size, const void* data ) override;
+
+	void					CopyResource( renderResource_t* destination, renderResource_t* source ) override;
+	void					CopyBufferRegion( renderBuffer_t* destination, const uint32_t destinationOffset, renderBuffer_t* source, const uint32_t sourceOffset, const uint32_t size ) override;
+	void					ResolveSubresource( renderTexture_t* destination, renderTexture_t* source, const renderFormat_t format ) override;
+	void					GenerateMips( renderShaderResourceView_t* view ) override;
+
+	void					BeginQuery( renderQuery_t* query ) override;
+	void					EndQuery( renderQuery_t* query ) override;
+	const bool				GetQueryData( renderQuery_t* query, void* data, const uint32_t dataSize ) override;
+
+	void					FinishCommandList() override;
+	void					ExecuteCommandList( RenderBackend* deferred ) override;
+
+private:
+	ID3D11Device*			device;
+	ID3D11DeviceContext*	deviceContext;
+	ID3D11DeviceContext1*	deviceContext1;
+	IDXGISwapChain*			swapChain;
+	ID3D11CommandList*		commandList;	// finished and not executed yet (deferred contexts)
+	renderTargetView_t*		backBuffer;
+
+	bool					supportsRanges;
+	bool					supportsNoOverwrite;
+};
@@ -0,0 +1,760 @@
+#include "Shared.h"
+#include "RenderBackendNull.h"
+
+#include <Engine/System/MurmurHash2_64.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	constexpr unsigned int HASH_SEED = 0xB;
+
+	template<typename T>
+	struct nullObject_t : T
+	{
+		uint32_t	streamId = 0;	// id in the stream of the immediate backend; 0 until recorded
+	};
+
+	struct nullBuffer_t : nullObject_t<renderBuffer_t>
+	{
+		std::vector<uint8_t>	memory;	// up to the last byte written
+	};
+
+	uint32_t HashContent( const void* data, const std::size_t size )
+	{
+		const uint64_t hashcode = MurmurHash64A( data, static_cast<int>( size ), HASH_SEED );
+		return static_cast<uint32_t>( hashcode ^ ( hashcode >> 32 ) );
+	}
+
+	uint32_t FloatBits( const float value )
+	{
+		uint32_t bits = 0;
+		memcpy( &bits, &value, sizeof( uint32_t ) );
+		return bits;
+	}
+
+	uint8_t* GetBufferMemory( renderBuffer_t* buffer, const std::size_t size )
+	{
+		std::vector<uint8_t>& memory = static_cast<nullBuffer_t*>( buffer )->memory;
+
+		if ( memory.size() < size ) {
+			memory.resize( size, 0 );
+		}
+
+		return memory.data();
+	}
+
+	template<typename T>
+	T* CreateObject()
+	{
+		return new nullObject_t<T>();
+	}
+
+	template<typename T>
+	T* CreateView( renderResource_t* resource )
+	{
+		if ( resource == nullptr ) {
+			return nullptr;
+		}
+
+		T* view = CreateObject<T>();
+
+		resource->AddRef();
+		view->resource = resource;
+
+		return view;
+	}
+
+	// arguments of a command holding object ids: [first, first + count)
+	void GetObjectArguments( const renderCommand_t command, const uint32_t argumentCount, uint32_t& first, uint32_t& count )
+	{
+		first = 0;
+		count = 0;
+
+		switch ( command ) {
+		case RENDER_COMMAND_SET_INPUT_LAYOUT:
+		case RENDER_COMMAND_SET_INDEX_BUFFER:
+		case RENDER_COMMAND_SET_VERTEX_SHADER:
+		case RENDER_COMMAND_SET_PIXEL_SHADER:
+		case RENDER_COMMAND_SET_RASTERIZER_STATE:
+		case RENDER_COMMAND_SET_DEPTH_STENCIL_STATE:
+		case RENDER_COMMAND_SET_BLEND_STATE:
+		case RENDER_COMMAND_MAP_BUFFER:
+		case RENDER_COMMAND_UNMAP_BUFFER:
+		case RENDER_COMMAND_UPDATE_BUFFER:
+		case RENDER_COMMAND_CLEAR_RENDER_TARGET:
+		case RENDER_COMMAND_CLEAR_DEPTH_STENCIL:
+		case RENDER_COMMAND_GENERATE_MIPS:
+		case RENDER_COMMAND_BEGIN_QUERY:
+		case RENDER_COMMAND_END_QUERY:
+			count = 1;
+			break;
+
+		case RENDER_COMMAND_COPY_RESOURCE:
+		case RENDER_COMMAND_COPY_BUFFER_REGION:
+		case RENDER_COMMAND_RESOLVE_SUBRESOURCE:
+			count = 2;
+			break;
+
+		case RENDER_COMMAND_SET_VERTEX_BUFFER:
+			first = 1;
+			count = 1;
+			break;
+
+		case RENDER_COMMAND_SET_CONSTANT_BUFFER_RANGE:
+			first = 2;
+			count = 1;
+			break;
+
+		case RENDER_COMMAND_SET_CONSTANT_BUFFERS:
+		case RENDER_COMMAND_SET_SHADER_RESOURCES:
+		case RENDER_COMMAND_SET_SAMPLERS:
+			first = 2;
+			count = argumentCount - 2;
+			break;
+
+		case RENDER_COMMAND_SET_RENDER_TARGETS:
+			first = 1;
+			count = argumentCount - 1;
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+RenderBackendNull::RenderBackendNull( const bool supportsConstantBufferRanges )
+	: supportsRanges( supportsConstantBufferRanges )
+	, isDeferred( false )
+	, counters{}
+	, objectCount( 0 )
+	, viewport{}
+	, backBuffer( nullptr )
+{
+
+}
+
+RenderBackendNull::~RenderBackendNull()
+{
+	if ( backBuffer != nullptr ) {
+		backBuffer->Release();
+		backBuffer = nullptr;
+	}
+}
+
+uint64_t RenderBackendNull::GetStreamHash() const
+{
+	return MurmurHash64A( stream.data(), static_cast<int>( stream.size() * sizeof( uint32_t ) ), HASH_SEED );
+}
+
+void RenderBackendNull::Clear()
+{
+	stream.clear();
+	counters = {};
+}
+
+const bool RenderBackendNull::Save( const char* fileName ) const
+{
+	FILE* file = fopen( fileName, "wb" );
+
+	if ( file == nullptr ) {
+		return false;
+	}
+
+	const std::size_t writtenCount = fwrite( stream.data(), sizeof( uint32_t ), stream.size(), file );
+	fclose( file );
+
+	return writtenCount == stream.size();
+}
+
+const bool RenderBackendNull::Diff( const char* fileName, int64_t& firstDifference ) const
+{
+	FILE* file = fopen( fileName, "rb" );
+
+	if ( file == nullptr ) {
+		return false;
+	}
+
+	std::vector<uint32_t> saved;
+	uint32_t words[1024];
+	std::size_t readCount = 0;
+
+	while ( ( readCount = fread( words, sizeof( uint32_t ), _countof( words ), file ) ) != 0 ) {
+		saved.insert( saved.end(), words, words + readCount );
+	}
+
+	fclose( file );
+
+	// command by command: index of the first one that differs (or that only one of the streams has); -1 if they match
+	firstDifference = -1;
+
+	std::size_t offset = 0;
+	int64_t commandIndex = 0;
+
+	while ( offset < stream.size() || offset < saved.size() ) {
+		if ( offset >= stream.size() || offset >= saved.size() ) {
+			firstDifference = commandIndex;
+			break;
+		}
+
+		const std::size_t commandLength = 1 + ( stream[offset] & 0xFFFFFF );
+
+		if ( stream[offset] != saved[offset] || offset + commandLength > saved.size()
+			|| memcmp( &stream[offset], &saved[offset], commandLength * sizeof( uint32_t ) ) != 0 ) {
+			firstDifference = commandIndex;
+			break;
+		}
+
+		offset += commandLength;
+		++commandIndex;
+	}
+
+	return true;
+}
+
+const bool RenderBackendNull::SupportsConstantBufferRanges() const
+{
+	return supportsRanges;
+}
+
+const bool RenderBackendNull::SupportsNoOverwriteConstantBufferMaps() const
+{
+	return true;
+}
+
+renderBuffer_t* RenderBackendNull::CreateBuffer( const renderBufferDesc_t& desc, const void* initialData )
+{
+	nullBuffer_t* buffer = new nullBuffer_t();
+	buffer->desc = desc;
+
+	if ( initialData != nullptr ) {
+		const uint8_t* data = static_cast<const uint8_t*>( initialData );
+		buffer->memory.assign( data, data + desc.size );
+	}
+
+	return buffer;
+}
+
+renderTexture_t* RenderBackendNull::CreateTexture( const renderTextureDesc_t& desc )
+{
+	renderTexture_t* texture = CreateObject<renderTexture_t>();
+	texture->desc = desc;
+
+	return texture;
+}
+
+renderTexture_t* RenderBackendNull::CreateTextureFromFile( const wchar_t*, renderShaderResourceView_t** view )
+{
+	const renderTextureDesc_t placeholderDesc = {
+		RENDER_TEXTURE_DIMENSION_2D,	// renderTextureDimension_t dimension
+		1,								// uint32_t width
+		1,								// uint32_t height
+		1,								// uint32_t depth
+		1,								// uint32_t mipLevels
+		1,								// uint32_t arraySize
+		RENDER_FORMAT_R8G8B8A8_UNORM,	// renderFormat_t format
+		1,								// uint32_t sampleCount
+		RENDER_USAGE_IMMUTABLE,			// renderUsage_t usage
+		RENDER_BIND_SHADER_RESOURCE,	// uint32_t bindFlags
+		0,								// uint32_t cpuAccessFlags
+		0,								// uint32_t miscFlags
+	};
+
+	renderTexture_t* texture = CreateTexture( placeholderDesc );
+
+	if ( view != nullptr ) {
+		*view = CreateShaderResourceView( texture, nullptr );
+	}
+
+	return texture;
+}
+
+renderShaderResourceView_t* RenderBackendNull::CreateShaderResourceView( renderResource_t* resource, const renderViewDesc_t* )
+{
+	return CreateView<renderShaderResourceView_t>( resource );
+}
+
+renderTargetView_t* RenderBackendNull::CreateRenderTargetView( renderTexture_t* texture, const renderViewDesc_t* )
+{
+	return CreateView<renderTargetView_t>( texture );
+}
+
+renderDepthStencilView_t* RenderBackendNull::CreateDepthStencilView( renderTexture_t* texture, const renderViewDesc_t* )
+{
+	return CreateView<renderDepthStencilView_t>( texture );
+}
+
+renderVertexShader_t* RenderBackendNull::CreateVertexShader( const void*, const size_t )
+{
+	return CreateObject<renderVertexShader_t>();
+}
+
+renderPixelShader_t* RenderBackendNull::CreatePixelShader( const void*, const size_t )
+{
+	return CreateObject<renderPixelShader_t>();
+}
+
+renderInputLayout_t* RenderBackendNull::CreateInputLayout( const renderInputElementDesc_t*, const uint32_t, const void*, const size_t )
+{
+	return CreateObject<renderInputLayout_t>();
+}
+
+renderSamplerState_t* RenderBackendNull::CreateSamplerState( const renderSamplerDesc_t& )
+{
+	return CreateObject<renderSamplerState_t>();
+}
+
+renderBlendState_t* RenderBackendNull::CreateBlendState( const renderBlendDesc_t& )
+{
+	return CreateObject<renderBlendState_t>();
+}
+
+renderRasterizerState_t* RenderBackendNull::CreateRasterizerState( const renderRasterizerDesc_t& )
+{
+	return CreateObject<renderRasterizerState_t>();
+}
+
+renderDepthStencilState_t* RenderBackendNull::CreateDepthStencilState( const renderDepthStencilDesc_t& )
+{
+	return CreateObject<renderDepthStencilState_t>();
+}
+
+renderQuery_t* RenderBackendNull::CreateQuery( const renderQueryType_t type )
+{
+	renderQuery_t* query = CreateObject<renderQuery_t>();
+	query->type = type;
+
+	return query;
+}
+
+const bool RenderBackendNull::CompileShader( const wchar_t*, const renderShaderMacro_t*, const char*, const char*, const uint32_t, std::vector<uint8_t>&, std::string& errors )
+{
+	errors = "no shader compiler on the null backend\n";
+	return false;
+}
+
+const bool RenderBackendNull::PreprocessShader( const wchar_t*, const std::vector<uint8_t>&, std::vector<uint8_t>&, std::string& errors )
+{
+	errors = "no shader compiler on the null backend\n";
+	return false;
+}
+
+const bool RenderBackendNull::LoadShaderBytecode( const wchar_t*, std::vector<uint8_t>& bytecode )
+{
+	bytecode.clear();
+	return true;
+}
+
+RenderBackend* RenderBackendNull::CreateDeferredBackend()
+{
+	RenderBackendNull* deferred = new RenderBackendNull( supportsRanges );
+	deferred->isDeferred = true;
+
+	return deferred;
+}
+
+renderTargetView_t* RenderBackendNull::GetBackBuffer()
+{
+	return backBuffer;
+}
+
+const bool RenderBackendNull::ResizeBackBuffer( const uint32_t width, const uint32_t height )
+{
+	if ( isDeferred ) {
+		return false;
+	}
+
+	if ( backBuffer != nullptr ) {
+		backBuffer->Release();
+		backBuffer = nullptr;
+	}
+
+	const renderTextureDesc_t backBufferDesc = {
+		RENDER_TEXTURE_DIMENSION_2D,	// renderTextureDimension_t dimension
+		width,							// uint32_t width
+		height,							// uint32_t height
+		1,								// uint32_t depth
+		1,								// uint32_t mipLevels
+		1,								// uint32_t arraySize
+		RENDER_FORMAT_R8G8B8A8_UNORM,	// renderFormat_t format
+		1,								// uint32_t sampleCount
+		RENDER_USAGE_DEFAULT,			// renderUsage_t usage
+		RENDER_BIND_RENDER_TARGET,		// uint32_t bindFlags
+		0,								// uint32_t cpuAccessFlags
+		0,								// uint32_t miscFlags
+	};
+
+	renderTexture_t* backBufferTexture = CreateTexture( backBufferDesc );
+
+	// the view keeps the texture alive
+	backBuffer = CreateRenderTargetView( backBufferTexture, nullptr );
+	backBufferTexture->Release();
+
+	return true;
+}
+
+void RenderBackendNull::Present( const bool enableVsync )
+{
+	Record( RENDER_COMMAND_PRESENT, { static_cast<uint32_t>( enableVsync ) } );
+}
+
+void RenderBackendNull::SetPrimitiveTopology( const renderPrimitiveTopology_t topology )
+{
+	Record( RENDER_COMMAND_SET_PRIMITIVE_TOPOLOGY, { static_cast<uint32_t>( topology ) } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetInputLayout( renderInputLayout_t* inputLayout )
+{
+	Record( RENDER_COMMAND_SET_INPUT_LAYOUT, { GetObjectId( inputLayout ) } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetVertexBuffer( const uint32_t slot, renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset )
+{
+	Record( RENDER_COMMAND_SET_VERTEX_BUFFER, { slot, GetObjectId( buffer ), stride, offset } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset )
+{
+	Record( RENDER_COMMAND_SET_INDEX_BUFFER, { GetObjectId( buffer ), static_cast<uint32_t>( format ), offset } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetVertexShader( renderVertexShader_t* shader )
+{
+	Record( RENDER_COMMAND_SET_VERTEX_SHADER, { GetObjectId( shader ) } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetPixelShader( renderPixelShader_t* shader )
+{
+	Record( RENDER_COMMAND_SET_PIXEL_SHADER, { GetObjectId( shader ) } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetConstantBuffers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers )
+{
+	RecordSlots( RENDER_COMMAND_SET_CONSTANT_BUFFERS, stage, first, count, buffers );
+}
+
+void RenderBackendNull::SetConstantBufferRange( const renderStage_t stage, const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount )
+{
+	Record( RENDER_COMMAND_SET_CONSTANT_BUFFER_RANGE, { static_cast<uint32_t>( stage ), slot, GetObjectId( buffer ), firstConstant, constantCount } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetShaderResources( const renderStage_t stage, const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views )
+{
+	RecordSlots( RENDER_COMMAND_SET_SHADER_RESOURCES, stage, first, count, views );
+}
+
+void RenderBackendNull::SetSamplers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderSamplerState_t* const* samplers )
+{
+	RecordSlots( RENDER_COMMAND_SET_SAMPLERS, stage, first, count, samplers );
+}
+
+void RenderBackendNull::SetRasterizerState( renderRasterizerState_t* state )
+{
+	Record( RENDER_COMMAND_SET_RASTERIZER_STATE, { GetObjectId( state ) } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t stencilRef )
+{
+	Record( RENDER_COMMAND_SET_DEPTH_STENCIL_STATE, { GetObjectId( state ), stencilRef } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetBlendState( renderBlendState_t* state )
+{
+	Record( RENDER_COMMAND_SET_BLEND_STATE, { GetObjectId( state ) } );
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetRenderTargets( const uint32_t count, renderTargetView_t* const* views, renderDepthStencilView_t* depthView )
+{
+	stream.push_back( ( static_cast<uint32_t>( RENDER_COMMAND_SET_RENDER_TARGETS ) << 24 ) | ( count + 2 ) );
+	stream.push_back( count );
+
+	for ( uint32_t i = 0; i < count; ++i ) {
+		stream.push_back( GetObjectId( views[i] ) );
+	}
+
+	stream.push_back( GetObjectId( depthView ) );
+
+	counters.commandCount++;
+	counters.stateChanges++;
+}
+
+void RenderBackendNull::SetViewport( const renderViewport_t& boundViewport )
+{
+	viewport = boundViewport;
+
+	Record( RENDER_COMMAND_SET_VIEWPORT, {
+		FloatBits( viewport.topLeftX ),
+		FloatBits( viewport.topLeftY ),
+		FloatBits( viewport.width ),
+		FloatBits( viewport.height ),
+		FloatBits( viewport.minDepth ),
+		FloatBits( viewport.maxDepth ),
+	} );
+
+	counters.stateChanges++;
+}
+
+renderViewport_t RenderBackendNull::GetViewport()
+{
+	return viewport;
+}
+
+void RenderBackendNull::ClearRenderTarget( renderTargetView_t* view, const float color[4] )
+{
+	Record( RENDER_COMMAND_CLEAR_RENDER_TARGET, { GetObjectId( view ), FloatBits( color[0] ), FloatBits( color[1] ), FloatBits( color[2] ), FloatBits( color[3] ) } );
+}
+
+void RenderBackendNull::ClearDepthStencil( renderDepthStencilView_t* view, const uint32_t clearFlags, const float depth, const uint8_t stencil )
+{
+	Record( RENDER_COMMAND_CLEAR_DEPTH_STENCIL, { GetObjectId( view ), clearFlags, FloatBits( depth ), stencil } );
+}
+
+void RenderBackendNull::Draw( const uint32_t vertexCount, const uint32_t startVertex )
+{
+	Record( RENDER_COMMAND_DRAW, { vertexCount, startVertex } );
+
+	counters.drawCalls++;
+	counters.instanceCount++;
+	counters.primitiveCount += vertexCount / 3;
+}
+
+void RenderBackendNull::DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex )
+{
+	Record( RENDER_COMMAND_DRAW_INDEXED, { indexCount, startIndex, static_cast<uint32_t>( baseVertex ) } );
+
+	counters.drawCalls++;
+	counters.instanceCount++;
+	counters.primitiveCount += indexCount / 3;
+}
+
+void RenderBackendNull::DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance )
+{
+	Record( RENDER_COMMAND_DRAW_INDEXED_INSTANCED, { indexCount, instanceCount, startIndex, static_cast<uint32_t>( baseVertex ), startInstance } );
+
+	counters.drawCalls++;
+	counters.instanceCount += instanceCount;
+	counters.primitiveCount += static_cast<uint64_t>( indexCount / 3 ) * instanceCount;
+}
+
+void* RenderBackendNull::MapBuffer( renderBuffer_t* buffer, const renderMap_t mapType )
+{
+	if ( buffer == nullptr ) {
+		return nullptr;
+	}
+
+	Record( RENDER_COMMAND_MAP_BUFFER, { GetObjectId( buffer ), buffer->desc.size, static_cast<uint32_t>( mapType ) } );
+	counters.mapCount++;
+
+	// no overwrite maps see the previous content
+	return GetBufferMemory( buffer, buffer->desc.size );
+}
+
+void RenderBackendNull::UnmapBuffer( renderBuffer_t* buffer )
+{
+	const uint8_t* memory = GetBufferMemory( buffer, buffer->desc.size );
+
+	Record( RENDER_COMMAND_UNMAP_BUFFER, { GetObjectId( buffer ), HashContent( memory, buffer->desc.size ) } );
+}
+
+void RenderBackendNull::UpdateBuffer( renderBuffer_t* buffer, const uint32_t offset, const uint32_t size, const void* data )
+{
+	Record( RENDER_COMMAND_UPDATE_BUFFER, { GetObjectId( buffer ), offset, size, HashContent( data, size ) } );
+	counters.updatedBytes += size;
+
+	memcpy( GetBufferMemory( buffer, offset + size ) + offset, data, size );
+}
+
+void RenderBackendNull::CopyResource( renderResource_t* destination, renderResource_t* source )
+{
+	Record( RENDER_COMMAND_COPY_RESOURCE, { GetResourceId( destination ), GetResourceId( source ) } );
+
+	renderBuffer_t* destinationBuffer	= dynamic_cast<renderBuffer_t*>( destination );
+	renderBuffer_t* sourceBuffer		= dynamic_cast<renderBuffer_t*>( source );
+
+	if ( destinationBuffer != nullptr && sourceBuffer != nullptr ) {
+		static_cast<nullBuffer_t*>( destinationBuffer )->memory = static_cast<nullBuffer_t*>( sourceBuffer )->memory;
+	}
+}
+
+void RenderBackendNull::CopyBufferRegion( renderBuffer_t* destination, const uint32_t destinationOffset, renderBuffer_t* source, const uint32_t sourceOffset, const uint32_t size )
+{
+	Record( RENDER_COMMAND_COPY_BUFFER_REGION, { GetObjectId( destination ), GetObjectId( source ), destinationOffset, sourceOffset, size } );
+
+	const uint8_t* sourceMemory = GetBufferMemory( source, sourceOffset + size );
+	memcpy( GetBufferMemory( destination, destinationOffset + size ) + destinationOffset, sourceMemory + sourceOffset, size );
+}
+
+void RenderBackendNull::ResolveSubresource( renderTexture_t* destination, renderTexture_t* source, const renderFormat_t format )
+{
+	Record( RENDER_COMMAND_RESOLVE_SUBRESOURCE, { GetObjectId( destination ), GetObjectId( source ), static_cast<uint32_t>( format ) } );
+}
+
+void RenderBackendNull::GenerateMips( renderShaderResourceView_t* view )
+{
+	Record( RENDER_COMMAND_GENERATE_MIPS, { GetObjectId( view ) } );
+}
+
+void RenderBackendNull::BeginQuery( renderQuery_t* query )
+{
+	Record( RENDER_COMMAND_BEGIN_QUERY, { GetObjectId( query ) } );
+}
+
+void RenderBackendNull::EndQuery( renderQuery_t* query )
+{
+	Record( RENDER_COMMAND_END_QUERY, { GetObjectId( query ) } );
+}
+
+const bool RenderBackendNull::GetQueryData( renderQuery_t* query, void* data, const uint32_t dataSize )
+{
+	// read backs are not commands; they are not recorded
+	switch ( query->type ) {
+	case RENDER_QUERY_EVENT: {
+		const uint32_t isDone = 1;
+		memcpy( data, &isDone, std::min<std::size_t>( dataSize, sizeof( uint32_t ) ) );
+	} break;
+
+	case RENDER_QUERY_TIMESTAMP: {
+		const uint64_t timestamp = 0;
+		memcpy( data, &timestamp, std::min<std::size_t>( dataSize, sizeof( uint64_t ) ) );
+	} break;
+
+	case RENDER_QUERY_TIMESTAMP_DISJOINT: {
+		const renderQueryTimestampDisjoint_t disjointData = { 1, 0 };
+		memcpy( data, &disjointData, std::min<std::size_t>( dataSize, sizeof( renderQueryTimestampDisjoint_t ) ) );
+	} break;
+	}
+
+	return true;
+}
+
+void RenderBackendNull::FinishCommandList()
+{
+	// the stream is the command list
+}
+
+void RenderBackendNull::ExecuteCommandList( RenderBackend* deferred )
+{
+	RenderBackendNull* recorded = static_cast<RenderBackendNull*>( deferred );
+
+	const std::vector<uint32_t>& recordedStream = recorded->stream;
+	stream.reserve( stream.size() + recordedStream.size() );
+
+	for ( std::size_t i = 0; i < recordedStream.size(); ) {
+		const uint32_t header			= recordedStream[i];
+		const uint32_t argumentCount	= header & 0xFFFFFF;
+
+		uint32_t firstObject = 0, objectCount = 0;
+		GetObjectArguments( static_cast<renderCommand_t>( header >> 24 ), argumentCount, firstObject, objectCount );
+
+		stream.push_back( header );
+
+		for ( uint32_t argument = 0; argument < argumentCount; ++argument ) {
+			uint32_t value = recordedStream[i + 1 + argument];
+
+			// ids are local to each stream
+			if ( value != 0 && argument >= firstObject && argument - firstObject < objectCount ) {
+				value = GetStreamId( recorded->objects[value - 1] );
+			}
+
+			stream.push_back( value );
+		}
+
+		i += 1 + argumentCount;
+	}
+
+	const renderStreamCounters_t& recordedCounters = recorded->counters;
+	counters.commandCount	+= recordedCounters.commandCount;
+	counters.stateChanges	+= recordedCounters.stateChanges;
+	counters.drawCalls		+= recordedCounters.drawCalls;
+	counters.instanceCount	+= recordedCounters.instanceCount;
+	counters.primitiveCount	+= recordedCounters.primitiveCount;
+	counters.mapCount		+= recordedCounters.mapCount;
+	counters.updatedBytes	+= recordedCounters.updatedBytes;
+
+	// objects released before the next recording might be reallocated at the same address
+	recorded->Clear();
+	recorded->objectIds.clear();
+	recorded->objects.clear();
+}
+
+template<typename T>
+uint32_t RenderBackendNull::GetObjectId( T* object )
+{
+	if ( object == nullptr ) {
+		return 0;
+	}
+
+	return GetStreamId( &static_cast<nullObject_t<T>*>( object )->streamId );
+}
+
+uint32_t RenderBackendNull::GetStreamId( uint32_t* objectId )
+{
+	if ( !isDeferred ) {
+		if ( *objectId == 0 ) {
+			*objectId = ++objectCount;
+		}
+
+		return *objectId;
+	}
+
+	// the object ids are written by the immediate backend only (deferred ones record in parallel)
+	auto it = objectIds.find( objectId );
+
+	if ( it != objectIds.end() ) {
+		return it->second;
+	}
+
+	objects.push_back( objectId );
+
+	const uint32_t id = static_cast<uint32_t>( objects.size() );
+	objectIds.emplace( objectId, id );
+
+	return id;
+}
+
+uint32_t RenderBackendNull::GetResourceId( renderResource_t* resource )
+{
+	renderBuffer_t* buffer = dynamic_cast<renderBuffer_t*>( resource );
+
+	if ( buffer != nullptr ) {
+		return GetObjectId( buffer );
+	}
+
+	return GetObjectId( static_cast<renderTexture_t*>( resource ) );
+}
+
+void RenderBackendNull::Record( const renderCommand_t command, std::initializer_list<uint32_t> arguments )
+{
+	stream.push_back( ( static_cast<uint32_t>( command ) << 24 ) | static_cast<uint32_t>( arguments.size() ) );
+	stream.insert( stream.end(), arguments.begin(), arguments.end() );
+
+	counters.commandCount++;
+}
+
+template<typename T>
+void RenderBackendNull::RecordSlots( const renderCommand_t command, const renderStage_t stage, const uint32_t first, const uint32_t count, T* const* objects )
+{
+	stream.push_back( ( static_cast<uint32_t>( command ) << 24 ) | ( count + 2 ) );
+	stream.push_back( static_cast<uint32_t>( stage ) );
+	stream.push_back( first );
+
+	for ( uint32_t i = 0; i < count; ++i ) {
+		stream.push_back( GetObjectId( objects[i] ) );
+	}
+
+	counters.commandCount++;
+	counters.stateChanges++;
+}
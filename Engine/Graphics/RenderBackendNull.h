@@ -0,0 +1,179 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+#include <initializer_list>
+#include <unordered_map>
+#include <vector>
+
+enum renderCommand_t : uint8_t
+{
+	RENDER_COMMAND_SET_PRIMITIVE_TOPOLOGY = 0,
+	RENDER_COMMAND_SET_INPUT_LAYOUT,
+	RENDER_COMMAND_SET_VERTEX_BUFFER,
+	RENDER_COMMAND_SET_INDEX_BUFFER,
+	RENDER_COMMAND_SET_VERTEX_SHADER,
+	RENDER_COMMAND_SET_PIXEL_SHADER,
+	RENDER_COMMAND_SET_CONSTANT_BUFFERS,
+	RENDER_COMMAND_SET_CONSTANT_BUFFER_RANGE,
+	RENDER_COMMAND_SET_SHADER_RESOURCES,
+	RENDER_COMMAND_SET_SAMPLERS,
+	RENDER_COMMAND_SET_RASTERIZER_STATE,
+	RENDER_COMMAND_SET_DEPTH_STENCIL_STATE,
+	RENDER_COMMAND_SET_BLEND_STATE,
+	RENDER_COMMAND_SET_RENDER_TARGETS,
+	RENDER_COMMAND_SET_VIEWPORT,		// float bits
+	RENDER_COMMAND_DRAW,
+	RENDER_COMMAND_DRAW_INDEXED,
+	RENDER_COMMAND_DRAW_INDEXED_INSTANCED,
+	RENDER_COMMAND_MAP_BUFFER,
+	RENDER_COMMAND_UNMAP_BUFFER,		// content hash of the mapped memory
+	RENDER_COMMAND_UPDATE_BUFFER,		// content hash of the data
+	RENDER_COMMAND_CLEAR_RENDER_TARGET,	// float bits
+	RENDER_COMMAND_CLEAR_DEPTH_STENCIL,	// float bits
+	RENDER_COMMAND_COPY_RESOURCE,
+	RENDER_COMMAND_COPY_BUFFER_REGION,
+	RENDER_COMMAND_RESOLVE_SUBRESOURCE,
+	RENDER_COMMAND_GENERATE_MIPS,
+	RENDER_COMMAND_BEGIN_QUERY,
+	RENDER_COMMAND_END_QUERY,
+	RENDER_COMMAND_PRESENT,
+
+	RENDER_COMMAND_COUNT
+};
+
+struct renderStreamCounters_t
+{
+	uint64_t	commandCount;
+	uint64_t	stateChanges;	// binds (a multi slot bind counts once)
+	uint64_t	drawCalls;
+	uint64_t	instanceCount;	// 1 per non instanced draw
+	uint64_t	primitiveCount;	// triangles, assuming triangle lists
+	uint64_t	mapCount;
+	uint64_t	updatedBytes;	// UpdateBuffer only
+};
+
+// null backend; nothing reaches a gpu, every command is appended to a compact stream instead
+// stream layout: per command one header word ( opcode << 24 | argument count ) then the 32 bits arguments
+// objects are recorded as ids given in order of first use (0 is null) by the immediate backend, so the streams of two
+// runs (or two builds) can be diffed
+// objects are placeholders, except for buffers: their content is kept in cpu memory (creation data, maps, updates and
+// copies), so that read backs see what was written; queries are complete right away (timestamps are 0)
+// executing a deferred null backend appends its stream with the ids remapped, as if it had been recorded in place
+// nothing is read from disk: textures loaded from files are 1x1 placeholders, precompiled shaders have an empty bytecode
+// and shaders can't be compiled
+class RenderBackendNull : public RenderBackend
+{
+public:
+	inline const uint32_t*					GetStream() const		{ return stream.data(); }
+	inline std::size_t						GetStreamLength() const	{ return stream.size(); } // in words
+	inline const renderStreamCounters_t&	GetCounters() const		{ return counters; }
+
+public:
+							RenderBackendNull( const bool supportsConstantBufferRanges = true );
+							RenderBackendNull( RenderBackendNull& ) = delete;
+							~RenderBackendNull();
+
+	uint64_t				GetStreamHash() const;
+	void					Clear(); // stream and counters; object ids are kept so that successive frames are comparable
+	const bool				Save( const char* fileName ) const; // raw stream, native endianness
+	const bool				Diff( const char* fileName, int64_t& firstDifference ) const; // against a saved stream; false if it can't be read
+
+	const bool				SupportsConstantBufferRanges() const override;
+	const bool				SupportsNoOverwriteConstantBufferMaps() const override;
+
+	renderBuffer_t*				CreateBuffer( const renderBufferDesc_t& desc, const void* initialData ) override;
+	renderTexture_t*			CreateTexture( const renderTextureDesc_t& desc ) override;
+	renderTexture_t*			CreateTextureFromFile( const wchar_t* path, renderShaderResourceView_t** view ) override;
+	renderShaderResourceView_t*	CreateShaderResourceView( renderResource_t* resource, const renderViewDesc_t* desc ) override;
+	renderTargetView_t*			CreateRenderTargetView( renderTexture_t* texture, const renderViewDesc_t* desc ) override;
+	renderDepthStencilView_t*	CreateDepthStencilView( renderTexture_t* texture, const renderViewDesc_t* desc ) override;
+
+	renderVertexShader_t*		CreateVertexShader( const void* bytecode, const size_t bytecodeSize ) override;
+	renderPixelShader_t*		CreatePixelShader( const void* bytecode, const size_t bytecodeSize ) override;
+	renderInputLayout_t*		CreateInputLayout( const renderInputElementDesc_t* elements, const uint32_t elementCount, const void* bytecode, const size_t bytecodeSize ) override;
+
+	renderSamplerState_t*		CreateSamplerState( const renderSamplerDesc_t& desc ) override;
+	renderBlendState_t*			CreateBlendState( const renderBlendDesc_t& desc ) override;
+	renderRasterizerState_t*	CreateRasterizerState( const renderRasterizerDesc_t& desc ) override;
+	renderDepthStencilState_t*	CreateDepthStencilState( const renderDepthStencilDesc_t& desc ) override;
+	renderQuery_t*				CreateQuery( const renderQueryType_t type ) override;
+
+	const bool				CompileShader( const wchar_t* sourcePath, const renderShaderMacro_t* defines, const char* entryPoint, const char* profile, const uint32_t flags, std::vector<uint8_t>& bytecode, std::string& errors ) override;
+	const bool				PreprocessShader( const wchar_t* sourcePath, const std::vector<uint8_t>& source, std::vector<uint8_t>& preprocessed, std::string& errors ) override;
+	const bool				LoadShaderBytecode( const wchar_t* path, std::vector<uint8_t>& bytecode ) override;
+
+	RenderBackend*			CreateDeferredBackend() override;
+
+	renderTargetView_t*		GetBackBuffer() override;
+	const bool				ResizeBackBuffer( const uint32_t width, const uint32_t height ) override;
+	void					Present( const bool enableVsync ) override;
+
+	void					SetPrimitiveTopology( const renderPrimitiveTopology_t topology ) override;
+	void					SetInputLayout( renderInputLayout_t* inputLayout ) override;
+	void					SetVertexBuffer( const uint32_t slot, renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset ) override;
+	void					SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset ) override;
+
+	void					SetVertexShader( renderVertexShader_t* shader ) override;
+	void					SetPixelShader( renderPixelShader_t* shader ) override;
+	void					SetConstantBuffers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers ) override;
+	void					SetConstantBufferRange( const renderStage_t stage, const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount ) override;
+	void					SetShaderResources( const renderStage_t stage, const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views ) override;
+	void					SetSamplers( const renderStage_t stage, const uint32_t first, const uint32_t count, renderSamplerState_t* const* samplers ) override;
+
+	void					SetRasterizerState( renderRasterizerState_t* state ) override;
+	void					SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t stencilRef ) override;
+	void					SetBlendState( renderBlendState_t* state ) override;
+
+	void					SetRenderTargets( const uint32_t count, renderTargetView_t* const* views, renderDepthStencilView_t* depthView ) override;
+	void					SetViewport( const renderViewport_t& viewport ) override;
+	renderViewport_t		GetViewport() override;
+
+	void					ClearRenderTarget( renderTargetView_t* view, const float color[4] ) override;
+	void					ClearDepthStencil( renderDepthStencilView_t* view, const uint32_t clearFlags, const float depth, const uint8_t stencil ) override;
+
+	void					Draw( const uint32_t vertexCount, const uint32_t startVertex ) override;
+	void					DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex ) override;
+	void					DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance ) override;
+
+	void*					MapBuffer( renderBuffer_t* buffer, const renderMap_t mapType ) override;
+	void					UnmapBuffer( renderBuffer_t* buffer ) override;
+	void					UpdateBuffer( renderBuffer_t* buffer, const uint32_t offset, const uint32_t size, const void* data ) override;
+
+	void					CopyResource( renderResource_t* destination, renderResource_t* source ) override;
+	void					CopyBufferRegion( renderBuffer_t* destination, const uint32_t destinationOffset, renderBuffer_t* source, const uint32_t sourceOffset, const uint32_t size ) override;
+	void					ResolveSubresource( renderTexture_t* destination, renderTexture_t* source, const renderFormat_t format ) override;
+	void					GenerateMips( renderShaderResourceView_t* view ) override;
+
+	void					BeginQuery( renderQuery_t* query ) override;
+	void					EndQuery( renderQuery_t* query ) override;
+	const bool				GetQueryData( renderQuery_t* query, void* data, const uint32_t dataSize ) override;
+
+	void					FinishCommandList() override;
+	void					ExecuteCommandList( RenderBackend* deferred ) override;
+
+private:
+	bool									supportsRanges;
+	bool									isDeferred;
+
+	std::vector<uint32_t>					stream;
+	renderStreamCounters_t					counters;
+	uint32_t								objectCount;	// ids given by the immediate backend
+	renderViewport_t						viewport;
+	renderTargetView_t*						backBuffer;
+
+	// deferred backends: local ids, remapped once executed
+	std::unordered_map<uint32_t*, uint32_t>	objectIds;
+	std::vector<uint32_t*>					objects;		// id fields of the objects, by local id - 1
+
+private:
+	template<typename T>
+	uint32_t				GetObjectId( T* object );
+	uint32_t				GetStreamId( uint32_t* objectId );
+	uint32_t				GetResourceId( renderResource_t* resource );
+
+	void					Record( const renderCommand_t command, std::initializer_list<uint32_t> arguments );
+
+	template<typename T>
+	void					RecordSlots( const renderCommand_t command, const renderStage_t stage, const uint32_t first, const uint32_t count, T* const* objects );
+};
@@ -1,233 +1,205 @@
 #include "Shared.h"
-#include <Engine/System/Window.h>
 #include "RenderContext.h"
-
-const int Sys_CreateRenderContext( renderContext_t* context, const window_t* window )
+#include "StateCache.h"
+#include "RenderBackendNull.h"
+#include "PipelineStateCache.h"
+#include "ShaderLibrary.h"
+#include "GeometryBuffer.h"
+#include "ReleaseQueue.h"
+
+#if !defined( _WIN32 )
+// d3d11 only exists on windows (see RenderContextD3D11.cpp): elsewhere, only the null context can be created
+const int Sys_CreateRenderContext( renderContext_t*, const window_t* )
 {
-	UINT vsyncNumerator		= 0,
-		 vsyncDenominator	= 0;
-
-	{
-		IDXGIFactory* factory = nullptr;
-		CreateDXGIFactory( __uuidof( IDXGIFactory ), ( void** )&factory );
-
-		IDXGIAdapter* adapter = nullptr;
-		factory->EnumAdapters( 0, &adapter );
-
-		IDXGIOutput* adapterOutput = nullptr;
-		unsigned int numModes = 0;
-		adapter->EnumOutputs( 0, &adapterOutput );
-		adapterOutput->GetDisplayModeList( DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, NULL );
-
-		DXGI_MODE_DESC* displayModeList = new DXGI_MODE_DESC[numModes]();
-		adapterOutput->GetDisplayModeList( DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, displayModeList );
-
-		for ( unsigned int i = 0; i < numModes; ++i ) {
-			if ( displayModeList[i].Width == window->width && displayModeList[i].Height == window->height ) {
-				vsyncNumerator = displayModeList[i].RefreshRate.Numerator;
-				vsyncDenominator = displayModeList[i].RefreshRate.Denominator;
-				break;
-			}
-		}
-
-		delete[] displayModeList;
+	return 1;
+}
+#endif
 
-		adapterOutput->Release();
-		adapter->Release();
-		factory->Release();
-	}
+const int Sys_CreateNullRenderContext( renderContext_t* context, const unsigned short width, const unsigned short height )
+{
+	// constant buffer ranges, as on any d3d 11.1 runtime
+	return Sys_InitializeRenderContext( context, new RenderBackendNull( true ), width, height );
+}
 
-	constexpr D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
-
-	const DXGI_SWAP_CHAIN_DESC swapChainDesc = {
-		{																					// DXGI_MODE_DESC BufferDesc
-			window->width,																	//		UINT Width
-			window->height,																	//		UINT Height
-			{																				//		DXGI_RATIONAL RefreshRate
-				vsyncNumerator,																//			UINT Numerator			
-				vsyncDenominator,															//			UINT Denominator
-			},																				//
-			DXGI_FORMAT_R8G8B8A8_UNORM,														//		DXGI_FORMAT Format
-			DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED,											//		DXGI_MODE_SCANLINE_ORDER ScanlineOrdering
-			DXGI_MODE_SCALING_UNSPECIFIED,													//		DXGI_MODE_SCALING Scaling
-		},																					//
-		{																					// DXGI_SAMPLE_DESC SampleDesc
-			1,																				//		UINT Count
-			0,																				//		UINT Quality
-		},																					//
-		DXGI_USAGE_RENDER_TARGET_OUTPUT,													// DXGI_USAGE BufferUsage
-		1,																					// UINT BufferCount
-		window->handle,																		// HWND OutputWindow
-		static_cast<BOOL>( window->flags & WIN_DISP_MODE_WINDOWED ),						// BOOL Windowed
-		DXGI_SWAP_EFFECT_DISCARD,															// DXGI_SWAP_EFFECT SwapEffect
-		0,																					// UINT Flags
-	};
+const int Sys_InitializeRenderContext( renderContext_t* context, RenderBackend* backend, const unsigned short width, const unsigned short height )
+{
+	context->backend = backend;
 
-	UINT creationFlags = 0;
+	context->shaders = new ShaderLibrary();
+	context->shaders->Initialize( context->backend, L"base_data/shaders/source/", L"base_data/shaders/cache/" );
 
-	if ( FAILED( D3D11CreateDeviceAndSwapChain( NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, creationFlags, &featureLevel, 1,
-												D3D11_SDK_VERSION, &swapChainDesc, &context->swapChain, &context->device,
-												NULL, &context->deviceContext ) ) ) {
-		return 1;
-	}
+	context->pipelineStates = new PipelineStateCache();
+	context->pipelineStates->Initialize( context->backend, context->shaders );
 
+	constexpr renderRasterizerDesc_t rasterDesc = 
 	{
-		ID3D11Texture2D* backBufferPtr = nullptr;
-
-		context->swapChain->GetBuffer( 0, __uuidof( ID3D11Texture2D ), ( LPVOID* )&backBufferPtr );
+		RENDER_FILL_SOLID,
+		RENDER_CULL_BACK,
+		0,          // uint32_t frontCounterClockwise;
+		0,          // int32_t depthBias;
+		0.0f,       // float depthBiasClamp;
+		0.0f,       // float slopeScaledDepthBias;
+		1,          // uint32_t depthClipEnable;
+		0,          // uint32_t scissorEnable;
+		0,          // uint32_t multisampleEnable;
+		0,          // uint32_t antialiasedLineEnable;
+	};
 
-		if ( FAILED( context->device->CreateRenderTargetView( backBufferPtr, NULL, &context->backBuffer ) ) ) {
-			return 2;
-		}
+	context->rasterState = context->pipelineStates->GetRasterizerState( rasterDesc );
 
-		backBufferPtr->Release();
+	if ( context->rasterState == nullptr ) {
+		return 3;
 	}
 
+	context->backend->SetRasterizerState( context->rasterState );
 
-	constexpr D3D11_RASTERIZER_DESC rasterDesc = 
-	{
-		D3D11_FILL_SOLID,
-		D3D11_CULL_BACK,
-		0,          // BOOL FrontCounterClockwise;
-		0,          // INT DepthBias;
-		0.0f,       // FLOAT DepthBiasClamp;
-		0.0f,       // FLOAT SlopeScaledDepthBias;
-		TRUE,       // BOOL DepthClipEnable;
-		0,          // BOOL ScissorEnable;
-		0,          // BOOL MultisampleEnable;
-		0,          // BOOL AntialiasedLineEnable;
-	};
+	context->stateCache = new StateCache();
+	context->stateCache->Initialize( context->backend );
 
-	if ( FAILED( context->device->CreateRasterizerState( &rasterDesc, &context->rasterState ) ) ) {
-		return 3;
-	}
+	// 1M vertices (56MB over both streams) and 4M indices (16MB)
+	// meshes get buffers of their own if the shared ones can't be created or are full
+	context->geometry = new GeometryBuffer();
+	context->geometry->Create( context, 1 << 20, 1 << 22 );
 
-	context->deviceContext->RSSetState( context->rasterState );
+	context->releases = new ReleaseQueue();
 
-	Sys_ResizeRenderContext( context, window->width, window->height );
+	Sys_ResizeRenderContext( context, width, height );
 
 	return 0;
 }
 
 void Sys_DestroyRenderContext( renderContext_t* context )
 {
-	if ( context->swapChain != nullptr ) {
-		context->swapChain->SetFullscreenState( false, nullptr );
-	}
-
 	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
 
-	RELEASE( context->rasterState )
-	RELEASE( context->backBuffer )
-	RELEASE( context->deviceContext )
-	RELEASE( context->device )
-	RELEASE( context->swapChain )
+	// state objects are owned by the pipeline state cache
+	delete context->pipelineStates;
+	context->pipelineStates = nullptr;
+
+	context->rasterState						= nullptr;
+	context->depthStencilBuffer.stateAtmosphere	= nullptr;
+	context->depthStencilBuffer.stateOpaque		= nullptr;
+
+	// and shaders by the shader library
+	delete context->shaders;
+	context->shaders = nullptr;
+
+	// pending releases might return geometry ranges
+	if ( context->releases != nullptr ) {
+		context->releases->Flush();
+		delete context->releases;
+		context->releases = nullptr;
+	}
+
+	if ( context->geometry != nullptr ) {
+		context->geometry->Destroy();
+		delete context->geometry;
+		context->geometry = nullptr;
+	}
 
 	RELEASE( context->depthStencilBuffer.buffer )
-	RELEASE( context->depthStencilBuffer.stateAtmosphere )
-	RELEASE( context->depthStencilBuffer.stateOpaque )
 	RELEASE( context->depthStencilBuffer.view )
+
+	delete context->stateCache;
+	context->stateCache = nullptr;
+
+	// the back buffer goes with the backend (and the swap chain, if any)
+	context->backBuffer = nullptr;
+
+	delete context->backend;
+	context->backend = nullptr;
 }
 
 void Sys_ResizeRenderContext( renderContext_t* context, const unsigned short width, const unsigned short height )
 {
 	// resolve pointer indirection only once for the most used object of the struct
-	ID3D11DeviceContext*	deviceContext	= context->deviceContext;
-	ID3D11Device*			device			= context->device;
-
-	deviceContext->OMSetRenderTargets( 0, 0, 0 );
-	context->backBuffer->Release();
-	context->swapChain->ResizeBuffers( 0, 0, 0, DXGI_FORMAT_UNKNOWN, 0 );
+	RenderBackend* backend = context->backend;
 
-	{
-		ID3D11Texture2D* pBuffer = nullptr;
-
-		context->swapChain->GetBuffer( 0, __uuidof( ID3D11Texture2D ), ( void** )&pBuffer );
-		device->CreateRenderTargetView( pBuffer, NULL, &context->backBuffer );
-
-		pBuffer->Release();
-	}
+	backend->ResizeBackBuffer( width, height );
+	context->backBuffer = backend->GetBackBuffer();
 
-	deviceContext->OMSetRenderTargets( 1, &context->backBuffer, NULL );
+	backend->SetRenderTargets( 1, &context->backBuffer, nullptr );
 
 	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
 
-	RELEASE( context->depthStencilBuffer.buffer )
-	RELEASE( context->depthStencilBuffer.stateAtmosphere )
-	RELEASE( context->depthStencilBuffer.stateOpaque )
 	RELEASE( context->depthStencilBuffer.view )
+	RELEASE( context->depthStencilBuffer.buffer )
 
-	D3D11_VIEWPORT viewport = 
+	context->viewport = 
 	{
 		0.0f,
 		0.0f,
-		static_cast<FLOAT>( width ),
-		static_cast<FLOAT>( height ),
+		static_cast<float>( width ),
+		static_cast<float>( height ),
 		0.0f,
 		1.0f,
 	};
 
-	context->deviceContext->RSSetViewports( 1, &viewport );
+	backend->SetViewport( context->viewport );
 	
-	const D3D11_TEXTURE2D_DESC depthBufferDesc = {
-		width,							// UINT Width
-		height,							// UINT Height
-		1,								// UINT MipLevels
-		1,								// UINT ArraySize
-		DXGI_FORMAT_R24G8_TYPELESS,	// DXGI_FORMAT Format
-		{								// DXGI_SAMPLE_DESC SampleDesc
-			4,							//		UINT Count
-			0,							//		UINT Quality
-		},								//
-		D3D11_USAGE_DEFAULT,			// D3D11_USAGE Usage
-		D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE,		// UINT BindFlags
-		0,								// UINT CPUAccessFlags
-		0,								// UINT MiscFlags
+	const renderTextureDesc_t depthBufferDesc = {
+		RENDER_TEXTURE_DIMENSION_2D,	// renderTextureDimension_t dimension
+		width,							// uint32_t width
+		height,							// uint32_t height
+		1,								// uint32_t depth
+		1,								// uint32_t mipLevels
+		1,								// uint32_t arraySize
+		RENDER_FORMAT_R24G8_TYPELESS,	// renderFormat_t format
+		4,								// uint32_t sampleCount
+		RENDER_USAGE_DEFAULT,			// renderUsage_t usage
+		RENDER_BIND_DEPTH_STENCIL | RENDER_BIND_SHADER_RESOURCE,	// uint32_t bindFlags
+		0,								// uint32_t cpuAccessFlags
+		0,								// uint32_t miscFlags
 	};
 
-	D3D11_DEPTH_STENCIL_DESC depthStencilDesc = {
-		TRUE,							// BOOL DepthEnable
-		D3D11_DEPTH_WRITE_MASK_ALL,		// D3D11_DEPTH_WRITE_MASK DepthWriteMask
-		D3D11_COMPARISON_LESS_EQUAL,	// D3D11_COMPARISON_FUNC DepthFunc
-		TRUE,							// BOOL StencilEnable
-		0xFF,							// UINT8 StencilReadMask
-		0xFF,							// UINT8 StencilWriteMask
-		{								// D3D11_DEPTH_STENCILOP_DESC FrontFace
-			D3D11_STENCIL_OP_KEEP,		//		D3D11_STENCIL_OP StencilFailOp
-			D3D11_STENCIL_OP_INCR,		//		D3D11_STENCIL_OP StencilDepthFailOp
-			D3D11_STENCIL_OP_KEEP,		//		D3D11_STENCIL_OP StencilPassOp
-			D3D11_COMPARISON_ALWAYS,	//		D3D11_COMPARISON_FUNC StencilFunc
+	renderDepthStencilDesc_t depthStencilDesc = {
+		1,								// uint32_t depthEnable
+		RENDER_DEPTH_WRITE_MASK_ALL,	// renderDepthWriteMask_t depthWriteMask
+		RENDER_COMPARISON_LESS_EQUAL,	// renderComparison_t depthFunc
+		1,								// uint32_t stencilEnable
+		0xFF,							// uint32_t stencilReadMask
+		0xFF,							// uint32_t stencilWriteMask
+		{								// renderStencilOpDesc_t frontFace
+			RENDER_STENCIL_OP_KEEP,		//		renderStencilOp_t stencilFailOp
+			RENDER_STENCIL_OP_INCR,		//		renderStencilOp_t stencilDepthFailOp
+			RENDER_STENCIL_OP_KEEP,		//		renderStencilOp_t stencilPassOp
+			RENDER_COMPARISON_ALWAYS,	//		renderComparison_t stencilFunc
 		},								//
-		{								// D3D11_DEPTH_STENCILOP_DESC BackFace
-			D3D11_STENCIL_OP_KEEP,		//		D3D11_STENCIL_OP StencilFailOp
-			D3D11_STENCIL_OP_DECR,		//		D3D11_STENCIL_OP StencilDepthFailOp
-			D3D11_STENCIL_OP_KEEP,		//		D3D11_STENCIL_OP StencilPassOp
-			D3D11_COMPARISON_ALWAYS,	//		D3D11_COMPARISON_FUNC StencilFunc
+		{								// renderStencilOpDesc_t backFace
+			RENDER_STENCIL_OP_KEEP,		//		renderStencilOp_t stencilFailOp
+			RENDER_STENCIL_OP_DECR,		//		renderStencilOp_t stencilDepthFailOp
+			RENDER_STENCIL_OP_KEEP,		//		renderStencilOp_t stencilPassOp
+			RENDER_COMPARISON_ALWAYS,	//		renderComparison_t stencilFunc
 		},								//
 	};
 
-	const D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc = {
-		DXGI_FORMAT_D24_UNORM_S8_UINT,					// DXGI_FORMAT Format
-		D3D11_DSV_DIMENSION_TEXTURE2DMS,			// D3D11_DSV_DIMENSION ViewDimension
-		0,										// UINT Flags
+	const renderViewDesc_t depthStencilViewDesc = {
+		RENDER_FORMAT_D24_UNORM_S8_UINT,		// renderFormat_t format
+		RENDER_VIEW_DIMENSION_TEXTURE2DMS,		// renderViewDimension_t dimension
+		0,										// uint32_t mostDetailedMip
+		0,										// uint32_t mipLevels
+		0,										// uint32_t mipSlice
+		0,										// uint32_t firstSlice
+		0,										// uint32_t sliceCount
 	};
 
-	D3D11_SHADER_RESOURCE_VIEW_DESC sr_desc;
-	sr_desc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
-	sr_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DMS;
-	sr_desc.Texture2D.MostDetailedMip = 0;
-	sr_desc.Texture2D.MipLevels = 1;
-
 	// some error check would be nice maybe? :)
-	context->device->CreateTexture2D( &depthBufferDesc, NULL, &context->depthStencilBuffer.buffer );
-	context->device->CreateDepthStencilState( &depthStencilDesc, &context->depthStencilBuffer.stateOpaque );
+	context->depthStencilBuffer.buffer = backend->CreateTexture( depthBufferDesc );
+	context->depthStencilBuffer.stateOpaque = context->pipelineStates->GetDepthStencilState( depthStencilDesc );
+
+	depthStencilDesc.stencilEnable = 0;
+	depthStencilDesc.depthEnable = 0;
 
-	depthStencilDesc.StencilEnable = FALSE;
-	depthStencilDesc.DepthEnable = FALSE;
+	// same descriptors on every resize; the cache hands back the existing states
+	context->depthStencilBuffer.stateAtmosphere = context->pipelineStates->GetDepthStencilState( depthStencilDesc );
+	backend->SetDepthStencilState( context->depthStencilBuffer.stateOpaque, 1 );
+
+	if ( context->depthStencilBuffer.buffer != nullptr ) {
+		context->depthStencilBuffer.view = backend->CreateDepthStencilView( context->depthStencilBuffer.buffer, &depthStencilViewDesc );
+	}
 
-	context->device->CreateDepthStencilState( &depthStencilDesc, &context->depthStencilBuffer.stateAtmosphere );
-	context->deviceContext->OMSetDepthStencilState( context->depthStencilBuffer.stateOpaque, 1 );
-	context->device->CreateDepthStencilView( context->depthStencilBuffer.buffer, &depthStencilViewDesc, &context->depthStencilBuffer.view );
+	backend->SetRenderTargets( 1, &context->backBuffer, context->depthStencilBuffer.view );
 
-	context->deviceContext->OMSetRenderTargets( 1, &context->backBuffer, context->depthStencilBuffer.view );
+	// everything above went around the state cache
+	context->stateCache->Invalidate();
 }
@@ -1,25 +1,39 @@
 #pragma once
 
-#include <d3d11.h>
+#include "RenderTypes.h"
 
 struct window_t;
+class RenderBackend;
+class StateCache;
+class PipelineStateCache;
+class ShaderLibrary;
+class GeometryBuffer;
+class ReleaseQueue;
 
 struct renderContext_t
 {
-	ID3D11DeviceContext*		deviceContext;
-	ID3D11Device*				device;
-	ID3D11RenderTargetView*		backBuffer;
-	IDXGISwapChain*				swapChain;
-	ID3D11RasterizerState*		rasterState;
+	renderTargetView_t*			backBuffer;		// owned by the backend
+	renderRasterizerState_t*	rasterState;
+	RenderBackend*				backend;		// device and immediate context (d3d11, or null when headless)
+	StateCache*					stateCache;		// redundant state filter over the backend
+	PipelineStateCache*			pipelineStates;	// shared state objects; owns rasterState and the depth stencil states
+	ShaderLibrary*				shaders;		// every shader and material permutation; owns them
+	GeometryBuffer*				geometry;		// shared vertex and index buffers of the meshes
+	ReleaseQueue*				releases;		// destruction of the resources snapshots in flight might reference
+	renderViewport_t			viewport;		// back buffer sized
 
 	struct {
-		ID3D11Texture2D*			buffer;
-		ID3D11DepthStencilState*	stateAtmosphere;
-		ID3D11DepthStencilState*	stateOpaque;
-		ID3D11DepthStencilView*		view;
+		renderTexture_t*			buffer;
+		renderDepthStencilState_t*	stateAtmosphere;
+		renderDepthStencilState_t*	stateOpaque;
+		renderDepthStencilView_t*	view;
 	} depthStencilBuffer;
 };
 
-const int	Sys_CreateRenderContext( renderContext_t* context, const window_t* window );
+const int	Sys_CreateRenderContext( renderContext_t* context, const window_t* window ); // d3d11 device and swap chain (RenderContextD3D11.cpp)
+const int	Sys_CreateNullRenderContext( renderContext_t* context, const unsigned short width, const unsigned short height ); // RenderBackendNull; nothing is drawn
 void		Sys_DestroyRenderContext( renderContext_t* context );
 void		Sys_ResizeRenderContext( renderContext_t* context, const unsigned short width, const unsigned short height );
+
+// what both creations share once the backend exists; the context takes over the backend
+const int	Sys_InitializeRenderContext( renderContext_t* context, RenderBackend* backend, const unsigned short width, const unsigned short height );
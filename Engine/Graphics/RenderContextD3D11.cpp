@@ -0,0 +1,88 @@
+#include "Shared.h"
+#include <Engine/System/Window.h>
+#include "RenderContext.h"
+#include "RenderBackendD3D11.h"
+
+const int Sys_CreateRenderContext( renderContext_t* context, const window_t* window )
+{
+	UINT vsyncNumerator		= 0,
+		 vsyncDenominator	= 0;
+
+	{
+		IDXGIFactory* factory = nullptr;
+		CreateDXGIFactory( __uuidof( IDXGIFactory ), ( void** )&factory );
+
+		IDXGIAdapter* adapter = nullptr;
+		factory->EnumAdapters( 0, &adapter );
+
+		IDXGIOutput* adapterOutput = nullptr;
+		unsigned int numModes = 0;
+		adapter->EnumOutputs( 0, &adapterOutput );
+		adapterOutput->GetDisplayModeList( DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, NULL );
+
+		DXGI_MODE_DESC* displayModeList = new DXGI_MODE_DESC[numModes]();
+		adapterOutput->GetDisplayModeList( DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_ENUM_MODES_INTERLACED, &numModes, displayModeList );
+
+		for ( unsigned int i = 0; i < numModes; ++i ) {
+			if ( displayModeList[i].Width == window->width && displayModeList[i].Height == window->height ) {
+				vsyncNumerator = displayModeList[i].RefreshRate.Numerator;
+				vsyncDenominator = displayModeList[i].RefreshRate.Denominator;
+				break;
+			}
+		}
+
+		delete[] displayModeList;
+
+		adapterOutput->Release();
+		adapter->Release();
+		factory->Release();
+	}
+
+	constexpr D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+
+	const DXGI_SWAP_CHAIN_DESC swapChainDesc = {
+		{																					// DXGI_MODE_DESC BufferDesc
+			window->width,																	//		UINT Width
+			window->height,																	//		UINT Height
+			{																				//		DXGI_RATIONAL RefreshRate
+				vsyncNumerator,																//			UINT Numerator			
+				vsyncDenominator,															//			UINT Denominator
+			},																				//
+			DXGI_FORMAT_R8G8B8A8_UNORM,														//		DXGI_FORMAT Format
+			DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED,											//		DXGI_MODE_SCANLINE_ORDER ScanlineOrdering
+			DXGI_MODE_SCALING_UNSPECIFIED,													//		DXGI_MODE_SCALING Scaling
+		},																					//
+		{																					// DXGI_SAMPLE_DESC SampleDesc
+			1,																				//		UINT Count
+			0,																				//		UINT Quality
+		},																					//
+		DXGI_USAGE_RENDER_TARGET_OUTPUT,													// DXGI_USAGE BufferUsage
+		1,																					// UINT BufferCount
+		window->handle,																		// HWND OutputWindow
+		static_cast<BOOL>( window->flags & WIN_DISP_MODE_WINDOWED ),						// BOOL Windowed
+		DXGI_SWAP_EFFECT_DISCARD,															// DXGI_SWAP_EFFECT SwapEffect
+		0,																					// UINT Flags
+	};
+
+	UINT creationFlags = 0;
+
+	ID3D11Device*			device			= nullptr;
+	ID3D11DeviceContext*	deviceContext	= nullptr;
+	ID3D11DeviceContext1*	deviceContext1	= nullptr;
+	IDXGISwapChain*			swapChain		= nullptr;
+
+	if ( FAILED( D3D11CreateDeviceAndSwapChain( NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, creationFlags, &featureLevel, 1,
+												D3D11_SDK_VERSION, &swapChainDesc, &swapChain, &device,
+												NULL, &deviceContext ) ) ) {
+		return 1;
+	}
+
+	// constant buffer offsets (see CBufferRing)
+	if ( FAILED( deviceContext->QueryInterface( __uuidof( ID3D11DeviceContext1 ), ( void** )&deviceContext1 ) ) ) {
+		deviceContext1 = nullptr;
+	}
+
+	// the back buffer is created by the resize
+	return Sys_InitializeRenderContext( context, new RenderBackendD3D11( device, deviceContext, deviceContext1, swapChain ), window->width, window->height );
+}
+
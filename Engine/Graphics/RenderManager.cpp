@@ -1,24 +1,88 @@
 #include "Shared.h"
-#include <Engine/System/Window.h>
-#include <Engine/Game/World.h>
 #include "RenderContext.h"
 #include "CBuffer.h"
 #include "RenderManager.h"
+#include "ShaderLibrary.h"
+#include "ReleaseQueue.h"
+#include "RenderBackend.h"
 
-#include <Engine/ThirdParty/DirectXTK/Inc/DDSTextureLoader.h>
-#include <Engine/ThirdParty/DirectXTK/Inc/ScreenGrab.h>
+#include <Engine/System/Log.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// shaders of the passes created below; loaded up front in parallel rather than one at a time by each pass
+	const shaderPreload_t PASS_SHADERS[] =
+	{
+		{ RENDER_STAGE_VERTEX,	L"base_data/shaders/opaque_vs.cso" },
+		{ RENDER_STAGE_VERTEX,	L"base_data/shaders/depth_vs.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/opaque_ps.cso" },
+		{ RENDER_STAGE_VERTEX,	L"base_data/shaders/postfx_vs.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/composition_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/autoexposure_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/downsample_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/gaussianblur_vertical_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/gaussianblur_horizontal_ps.cso" },
+		{ RENDER_STAGE_VERTEX,	L"base_data/shaders/shadow_vs.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/shadow_ps.cso" },
+		{ RENDER_STAGE_VERTEX,	L"base_data/shaders/atmosphere_vs.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/atmosphere_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/transmittance_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/irradiance_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/inscatter1_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/copyirradiance_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/copyinscatter_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/inscatterS_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/irradianceN_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/inscatterN_ps.cso" },
+		{ RENDER_STAGE_PIXEL,	L"base_data/shaders/copyinscatterN_ps.cso" },
+	};
+
+	// sources with material permutations; the permutations compiled by previous runs are loaded with the passes
+	const wchar_t* const PERMUTATION_SOURCES[] =
+	{
+		L"opaque_ps.hlsl",
+	};
+
+	// 60 Hz with some slack for the present; 2.5% steps down to half the back buffer size
+	const dynamicResolutionSettings_t DYNAMIC_RESOLUTION_SETTINGS =
+	{
+		15.5f,						// float		targetFrameTime
+		0.5f,						// float		minScale
+		1.0f,						// float		maxScale
+		0.025f,						// float		scaleStep
+		0.25f,						// float		smoothing
+		0.1f,						// float		proportionalGain
+		0.05f,						// float		integralGain
+		0.0f,						// float		derivativeGain
+	};
+}
 
 void RenderManager::Shutdown()
 {
+	StopRenderThread();
+
 	defaultSurf.Destroy();
 	opaqueSurf.Destroy();
 
 	skybox.Destroy();
 	compositionPass.Destroy();
 
+	// nothing renders anymore: queued releases can run before the managers drop what is left
+	renderContext.releases->Flush();
+
 	texMan.Flush();
 	matMan.Flush();
 
+	frameGraph.Release();
+
+	commandRecorder.Destroy();
+	gpuTimer.Destroy();
+	cbufferRing.Destroy();
+	transformBuffer.Destroy();
+
 	// destroy the context at the end
 	Sys_DestroyRenderContext( &renderContext );
 }
@@ -31,200 +95,319 @@ const int RenderManager::Initialize( const window_t* window )
 		return contextCreationStatus;
 	}
 
-	if ( !lightMan.Initialize( &renderContext ) ) {
-		return 1;
+	return InitializeResources();
+}
+
+const int RenderManager::InitializeHeadless( const unsigned short width, const unsigned short height )
+{
+	const int contextCreationStatus = Sys_CreateNullRenderContext( &renderContext, width, height );
+
+	if ( contextCreationStatus != 0 ) {
+		return contextCreationStatus;
 	}
 
+	return InitializeResources();
+}
+
+const int RenderManager::InitializeResources()
+{
+	isRenderThreadRunning	= false;
+	frameCount				= 0;
+	frameSnapshot			= nullptr;
+	buildingSnapshot		= nullptr;
+
 	matMan.Initialize( &renderContext, &texMan );
 
+	dynamicResolution.Initialize( DYNAMIC_RESOLUTION_SETTINGS );
+	sceneViewport = renderContext.viewport;
+
+	// the device is free threaded: loads and resource creation run on the workers
+	// anything touching the immediate context (or the material manager) runs on this thread
+	startupTasks.Reset();
+
+	startupTasks.AddTask( "light manager", [this]() {
+		return lightMan.Initialize() ? 0 : 1;
+	} );
+
+	startupTasks.AddTask( "cbuffer ring", [this]() {
+		return cbufferRing.Create( &renderContext, CBUFFER_RING_SIZE ) ? 0 : 1;
+	} );
+
+	startupTasks.AddTask( "transform buffer", [this]() {
+		return transformBuffer.Create( &renderContext, TRANSFORM_CAPACITY ) ? 0 : 1;
+	} );
+
+	// chunks are spread over whatever workers exist at record time
+	// missing deferred contexts only cost parallelism
+	startupTasks.AddTask( "command recorder", [this]() {
+		commandRecorder.Create( &renderContext, CommandRecorder::MAX_CHUNK_COUNT );
+		return 0;
+	} );
+
+	// without it, frames are never measured and the scale stays at its max
+	startupTasks.AddTask( "gpu timer", [this]() {
+		gpuTimer.Create( &renderContext );
+		return 0;
+	} );
+
+	const uint32_t shadersTask = startupTasks.AddTask( "shaders", [this]() {
+		renderContext.shaders->Preload( PASS_SHADERS, _countof( PASS_SHADERS ), PERMUTATION_SOURCES, _countof( PERMUTATION_SOURCES ) );
+		return 0;
+	} );
+
+	// passes get their shaders from the library once preloaded (no blob is read twice)
+	// a pass failing to load renders nothing; not fatal
+	const uint32_t passTasks[] = {
+		startupTasks.AddTask( "opaque surface", [this]() { opaqueSurf.Create( &renderContext ); return 0; } ),
+		startupTasks.AddTask( "bloom", [this]() { bloom.Create( &renderContext ); return 0; } ),
+		startupTasks.AddTask( "shadow mapping", [this]() { shadowMapper.Create( &renderContext ); return 0; } ),
+		startupTasks.AddTask( "gaussian blur", [this]() { gaussianBlur.Create( &renderContext ); return 0; } ),
+		startupTasks.AddTask( "atmosphere", [this]() { atmosphere.Create( &renderContext ); return 0; } ),
+		startupTasks.AddTask( "composition", [this]() { compositionPass.Create( &renderContext, &texMan ); return 0; }, true ), // generates mips
+	};
+
+	for ( const uint32_t passTask : passTasks ) {
+		startupTasks.DependsOn( passTask, shadersTask );
+	}
+
+	const uint32_t atmosphereTask = passTasks[4];
+
+	const uint32_t precomputeTask = startupTasks.AddTask( "atmosphere precompute", [this]() {
+		atmosphere.Precompute( &renderContext );
+		return 0;
+	}, true );
+
+	startupTasks.DependsOn( precomputeTask, atmosphereTask );
+
 	// might use some bullshit 'manager' to store materials all together
-	defaultSurf.Create( renderContext.device );
-	opaqueSurf.Create( &renderContext );
-	compositionPass.Create( &renderContext, &texMan );
-	bloom.Create( &renderContext, window->width, window->height );
-	shadowMapper.Create( &renderContext );
-	gaussianBlur.Create( &renderContext );
-	atmosphere.Create( renderContext.device );
-	atmosphere.Precompute( renderContext.device, renderContext.deviceContext );
-
-	Render_CreateCBuffer( &renderContext, commonBuffer, sizeof( commonBuffer_t ) );
-	renderContext.deviceContext->PSSetConstantBuffers( 4, 1, &commonBuffer );
+	startupTasks.AddTask( "default surface", [this]() {
+		defaultSurf.Create( renderContext.backend );
+		return 0;
+	} );
 
 	// skybox, should be replaced with realistic atmospheric scaterring
-	skybox.Create( &renderContext, &matMan, renderContext.device );
+	// its mesh is uploaded through the immediate context
+	startupTasks.AddTask( "skybox", [this]() {
+		skybox.Create( &renderContext, &matMan );
+		return 0;
+	}, true );
 
 	// IBL Test with predefined environment
-	iblLut = texMan.GetTexture( &renderContext, "base_data/textures/dev/brdf_lut.dds" );
-	if ( iblLut == nullptr ) {
-		return 2;
-	}
-	renderContext.deviceContext->PSSetShaderResources( 5, 1, &iblLut->view );
-	
-	SwapEnvMap();
-
-	D3D11_RENDER_TARGET_VIEW_DESC   renderTargetViewDesc;
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DMS;
-	renderTargetViewDesc.Texture2D.MipSlice = 0;
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
-	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DMS;
-	shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
-	shaderResourceViewDesc.Texture2D.MipLevels = -1;
-
-	D3D11_TEXTURE2D_DESC mainRtDesc = {
-		window->width,
-		window->height,
-		1,
-		1,
-		DXGI_FORMAT_R16G16B16A16_FLOAT,
-		{																					// DXGI_SAMPLE_DESC SampleDesc
-			4,																				//		UINT Count
-			0,																				//		UINT Quality
-		},
-		D3D11_USAGE_DEFAULT,
-		D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
-		0,
-		0,
-	};
+	const uint32_t lutTask = startupTasks.AddTask( "brdf lut", [this]() {
+		iblLut = texMan.GetTexture( &renderContext, "base_data/textures/dev/brdf_lut.dds" );
+		return ( iblLut != nullptr ) ? 0 : 2;
+	} );
 
-	renderTargetViewDesc.Format = mainRtDesc.Format;
-	shaderResourceViewDesc.Format = mainRtDesc.Format;
+	const uint32_t bindLutTask = startupTasks.AddTask( "bind brdf lut", [this]() {
+		renderContext.backend->SetShaderResources( RENDER_STAGE_PIXEL, 5, 1, &iblLut->view );
+		return 0;
+	}, true );
 
-	if ( FAILED( renderContext.device->CreateTexture2D( &mainRtDesc, nullptr, &mainRenderTarget.tex2D ) ) ) {
-		return 3;
-	}
+	startupTasks.DependsOn( bindLutTask, lutTask );
 
-	if ( FAILED( renderContext.device->CreateRenderTargetView( mainRenderTarget.tex2D, &renderTargetViewDesc, &mainRenderTarget.view ) ) ) {
-		return 3;
-	}
+	bool isEnvMapLoaded = false;
 
-	if ( FAILED( renderContext.device->CreateShaderResourceView( mainRenderTarget.tex2D, &shaderResourceViewDesc, &mainRenderTarget.ressource ) ) ) {
-		return 3;
-	}
-	
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	const uint32_t envMapTask = startupTasks.AddTask( "env map", [this, &isEnvMapLoaded]() {
+		isEnvMapLoaded = LoadEnvMap();
+		return 0;
+	} );
 
-	mainRtDesc.SampleDesc.Count = 1;
+	const uint32_t bindEnvMapTask = startupTasks.AddTask( "bind env map", [this, &isEnvMapLoaded]() {
+		if ( isEnvMapLoaded ) {
+			BindEnvMap();
+		}
 
-	if ( FAILED( renderContext.device->CreateTexture2D( &mainRtDesc, nullptr, &mainRenderTargetResolved.tex2D ) ) ) {
-		return 3;
-	}
+		return 0;
+	}, true );
 
-	if ( FAILED( renderContext.device->CreateRenderTargetView( mainRenderTargetResolved.tex2D, &renderTargetViewDesc, &mainRenderTargetResolved.view ) ) ) {
-		return 3;
-	}
+	startupTasks.DependsOn( bindEnvMapTask, envMapTask );
 
-	if ( FAILED( renderContext.device->CreateShaderResourceView( mainRenderTargetResolved.tex2D, &shaderResourceViewDesc, &mainRenderTargetResolved.ressource ) ) ) {
-		return 3;
-	}
-	
-	const D3D11_TEXTURE2D_DESC shadowMapTestDesc = {
-		2048,
-		2048,
-		1,
-		1,
-		DXGI_FORMAT_R24G8_TYPELESS,
-		{																					// DXGI_SAMPLE_DESC SampleDesc
-			1,																				//		UINT Count
-			0,																				//		UINT Quality
-		},
-		D3D11_USAGE_DEFAULT,
-		D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE,
-		0,
-		0,
-	};
+	startupTasks.AddTask( "frame graph", [this]() {
+		BuildFrameGraph();
 
-	renderTargetViewDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-	shaderResourceViewDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS; 
+		// sized from the back buffer
+		const uint32_t width	= static_cast<uint32_t>( renderContext.viewport.width );
+		const uint32_t height	= static_cast<uint32_t>( renderContext.viewport.height );
 
-	if ( FAILED( renderContext.device->CreateTexture2D( &shadowMapTestDesc, nullptr, &shadowMapTest.tex2D ) ) ) {
-		return 3;
-	}
+		if ( !frameGraph.Compile( width, height ) || !frameGraph.Realize( renderContext.backend ) ) {
+			return 3;
+		}
 
-	if ( FAILED( renderContext.device->CreateShaderResourceView( shadowMapTest.tex2D, &shaderResourceViewDesc, &shadowMapTest.ressource ) ) ) {
-		return 3;
+		return 0;
+	} );
+
+	return startupTasks.Execute();
+}
+
+void RenderManager::FrameWorld( const renderSnapshot_t* snapshot )
+{
+	stateCacheCounters = renderContext.stateCache->GetCounters();
+	renderContext.stateCache->ResetCounters();
+
+	const stateCacheCounters_t chunkCounters = commandRecorder.ConsumeCounters();
+	stateCacheCounters.submittedCalls	+= chunkCounters.submittedCalls;
+	stateCacheCounters.filteredCalls	+= chunkCounters.filteredCalls;
+	stateCacheCounters.issuedCalls		+= chunkCounters.issuedCalls;
+
+	// meshes loaded since the last frame (streaming thread) are only staged; released ones leave holes in the shared buffers
+	renderContext.geometry->Upload( &renderContext );
+
+	// compaction moves the range offsets: never while the main thread builds the next snapshot (AcquireSnapshot waits meanwhile)
+	{
+		std::lock_guard<std::mutex> lock( snapshotLock );
+
+		if ( buildingSnapshot == nullptr || buildingSnapshot == snapshot ) {
+			renderContext.geometry->Compact( &renderContext, MAX_GEOMETRY_FRAGMENTATION );
+		}
 	}
 
-	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc = {};
-	depthStencilViewDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
-	depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-	depthStencilViewDesc.Texture2D.MipSlice = 0;
+	// gpu times come back a few frames late; each measured frame is one controller sample
+	double gpuFrameTime = 0.0;
 
-	if ( FAILED( renderContext.device->CreateDepthStencilView( shadowMapTest.tex2D, &depthStencilViewDesc, &shadowMapTest.depthView ) ) ) {
-		return 3;
+	while ( gpuTimer.Poll( renderContext.backend, gpuFrameTime ) ) {
+		dynamicResolution.Update( static_cast<float>( gpuFrameTime ) );
 	}
 
-	return 0;
+	const float renderScale = dynamicResolution.GetScale();
+
+	sceneViewport			= renderContext.viewport;
+	sceneViewport.width		= std::max( std::floor( renderContext.viewport.width * renderScale ), 1.0f );
+	sceneViewport.height	= std::max( std::floor( renderContext.viewport.height * renderScale ), 1.0f );
+
+	gpuTimer.Begin( renderContext.backend );
+
+	UploadFrameConstants( snapshot );
+
+	frameSnapshot = snapshot;
+	frameGraph.Execute();
+	frameSnapshot = nullptr;
+
+	gpuTimer.End( renderContext.backend );
+
+	renderContext.releases->EndFrame( snapshot->frameIndex );
 }
 
-void RenderManager::RenderNode( Camera* activeCamera, const areaNode_t* node )
+void RenderManager::BuildFrameGraph()
 {
-	for ( const areaNode_t* child : node->children ) {
-		if ( child->flags & NODE_FLAG_CONTENT_MESH ) {
-			mesh_t* mesh = static_cast< mesh_t* >( child->content );
+	frameGraph.Reset();
+
+	const frameGraphTargetDesc_t mainDesc = {
+		0,																				// uint32_t			width
+		0,																				// uint32_t			height
+		0,																				// uint32_t			sizeShift
+		RENDER_FORMAT_R16G16B16A16_FLOAT,												// renderFormat_t	format
+		4,																				// uint32_t			sampleCount
+		RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,						// uint32_t			bindFlags
+	};
 
-			Render_BindMesh( &renderContext, mesh );
-			opaqueSurf.Render( &renderContext, mesh, activeCamera );
-		}
+	frameGraphTargetDesc_t resolvedDesc = mainDesc;
+	resolvedDesc.sampleCount = 1;
 
-		if ( child->children.size() > 0 ) {
-			RenderNode( activeCamera, child );
-		}
-	}
+	const frameGraphTargetDesc_t shadowMapDesc = {
+		2048,																			// uint32_t			width
+		2048,																			// uint32_t			height
+		0,																				// uint32_t			sizeShift
+		RENDER_FORMAT_R24G8_TYPELESS,													// renderFormat_t	format
+		1,																				// uint32_t			sampleCount
+		RENDER_BIND_DEPTH_STENCIL | RENDER_BIND_SHADER_RESOURCE,						// uint32_t			bindFlags
+	};
+
+	frameTargets.main			= frameGraph.CreateTarget( "main", mainDesc );
+	frameTargets.bloomSource	= frameGraph.CreateTarget( "bloom source", mainDesc );
+	frameTargets.mainResolved	= frameGraph.CreateTarget( "main resolved", resolvedDesc );
+
+	// TMP: nothing renders the shadow map yet; persistent so that reading it unwritten is legal
+	frameTargets.shadowMap		= frameGraph.CreateTarget( "shadow map", shadowMapDesc, true );
+
+	const uint32_t opaquePass = frameGraph.AddPass( "opaque", [this]( const FrameGraph* graph ) {
+		RenderOpaquePass( graph );
+	} );
+
+	frameGraph.Read( opaquePass, frameTargets.shadowMap );
+	frameGraph.Write( opaquePass, frameTargets.main );
+	frameGraph.Write( opaquePass, frameTargets.bloomSource );
+
+	frameTargets.bloomResult = bloom.AddToGraph( &frameGraph, &renderContext, frameTargets.bloomSource, &gaussianBlur );
+
+	// the bloom levels are dead by now: the resolved target shares the first one
+	const uint32_t resolvePass = frameGraph.AddPass( "resolve", [this]( const FrameGraph* graph ) {
+		renderContext.backend->ResolveSubresource( graph->GetTarget( frameTargets.mainResolved )->texture, graph->GetTarget( frameTargets.main )->texture, RENDER_FORMAT_R16G16B16A16_FLOAT );
+	} );
+
+	frameGraph.Read( resolvePass, frameTargets.main );
+	frameGraph.Write( resolvePass, frameTargets.mainResolved );
+
+	// writes the back buffer (outside of the graph)
+	const uint32_t compositionGraphPass = frameGraph.AddPass( "composition", [this]( const FrameGraph* graph ) {
+		renderContext.backend->SetViewport( renderContext.viewport );
+		compositionPass.Render( &renderContext, graph->GetTarget( frameTargets.mainResolved ), graph->GetTarget( frameTargets.bloomResult ) );
+	} );
+
+	frameGraph.Read( compositionGraphPass, frameTargets.mainResolved );
+	frameGraph.Read( compositionGraphPass, frameTargets.bloomResult );
 }
 
-void RenderManager::FrameWorld( const float interpolatedFt, Camera* activeCamera, const worldArea_t* activeArea)
+void RenderManager::RenderOpaquePass( const FrameGraph* graph )
 {
-	// update Common cbuffer (dt, sys infos, ...)
-	commonBufferData.deltaTime = interpolatedFt;
-	UpdateCommonCBuffer();
-	
-	// update and prepare active camera for frame rendering
-	activeCamera->UpdateMatrices( &renderContext );
-
-	// update light list
-	// WARNING: totally bloated; should be optimized ASAP!!!!!
-	lightMan.Update( &renderContext, activeArea, isNight );
+	const renderSnapshot_t* snapshot = frameSnapshot;
 
 	//skybox.Render( &renderContext );
 
-	// DRAW STUFF FROM RENDER LIST
-	// => Sort the data!
-	// => use a 64bits bitfield containing all the data required to setup the renderer properly
-	// => tex to bind, raster state, ...
+	const renderTarget_t* bloomSource = graph->GetTarget( frameTargets.bloomSource );
+	const renderTarget_t* shadowMap = graph->GetTarget( frameTargets.shadowMap );
+
+	renderTargetView_t* mainPassRv[2] = { graph->GetTarget( frameTargets.main )->view, bloomSource->view };
+	renderContext.backend->SetRenderTargets( 2, mainPassRv, renderContext.depthStencilBuffer.view );
+	Render_ClearTargetColor( renderContext.backend, bloomSource );
+	renderContext.backend->ClearDepthStencil( renderContext.depthStencilBuffer.view, RENDER_CLEAR_DEPTH, 1.0F, 0x0 );
+	renderContext.backend->SetViewport( sceneViewport );
+
+	renderShaderResourceView_t* const pSRV[1] = { NULL };
+	renderContext.backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, pSRV );
 
-	ID3D11RenderTargetView* mainPassRv[2] = { mainRenderTarget.view, bloom.GetMSRenderTarget()->view };
-	renderContext.deviceContext->OMSetRenderTargets( 2, mainPassRv, renderContext.depthStencilBuffer.view );
-	Render_ClearTargetColor( renderContext.deviceContext, bloom.GetMSRenderTarget() );
-	renderContext.deviceContext->ClearDepthStencilView( renderContext.depthStencilBuffer.view, D3D11_CLEAR_DEPTH, 1.0F, 0x0 );
+	renderContext.backend->SetShaderResources( RENDER_STAGE_PIXEL, 8, 1, &shadowMap->ressource );
 
-	ID3D11ShaderResourceView *const pSRV[1] = { NULL };
-	renderContext.deviceContext->PSSetShaderResources( 0, 1, pSRV );
+	renderContext.backend->SetDepthStencilState( renderContext.depthStencilBuffer.stateAtmosphere, 1 );
+	atmosphere.Render( renderContext.backend );
+	renderContext.backend->SetDepthStencilState( renderContext.depthStencilBuffer.stateOpaque, 1 );
 
-	renderContext.deviceContext->PSSetShaderResources( 8, 1, &shadowMapTest.ressource );
+	// atmosphere (and the passes of the previous frame) bound states behind the cache back
+	renderContext.stateCache->Invalidate();
 
-	renderContext.deviceContext->OMSetDepthStencilState( renderContext.depthStencilBuffer.stateAtmosphere, 1 );
-	atmosphere.Render( renderContext.deviceContext );
-	renderContext.deviceContext->OMSetDepthStencilState( renderContext.depthStencilBuffer.stateOpaque, 1 );
+	// depth prepass: the opaque batches are shaded once per visible fragment (their depth is tested less equal)
+	const uint32_t opaqueBatchCount = snapshot->passBatchOffsets[RENDER_PASS_OPAQUE + 1] - snapshot->passBatchOffsets[RENDER_PASS_OPAQUE];
 
-	if ( activeArea->nodes != nullptr ) {
-		RenderNode( activeCamera, activeArea->nodes );
+	if ( opaqueBatchCount != 0 ) {
+		commandRecorder.Record( &renderContext, opaqueBatchCount, [this, snapshot]( const renderContext_t* context, const uint32_t begin, const uint32_t end ) {
+			if ( context != &renderContext ) {
+				BindOpaquePass( context );
+			}
+
+			opaqueSurf.DrawDepthBatches( context, &transformBuffer, snapshot, snapshot->passBatchOffsets[RENDER_PASS_OPAQUE] + begin, end - begin );
+		} );
 	}
 
-	// unbind the ressource so that we can use the render target on the next frame
-	renderContext.deviceContext->PSSetShaderResources( 8, 1, pSRV );
+	// one recording per queue pass (each binds its own blend and depth states); big ones are recorded on the job workers then executed in order
+	for ( uint32_t pass = 0; pass < RENDER_PASS_COUNT; ++pass ) {
+		const uint32_t firstBatch = snapshot->passBatchOffsets[pass];
+		const uint32_t batchCount = snapshot->passBatchOffsets[pass + 1] - firstBatch;
 
-	bloom.Render( renderContext.deviceContext, &gaussianBlur );
+		if ( batchCount == 0 ) {
+			continue;
+		}
 
-	ID3D11Resource* resSrc = nullptr;
-	mainRenderTargetResolved.view->GetResource( &resSrc );
+		commandRecorder.Record( &renderContext, batchCount, [this, snapshot, pass, firstBatch]( const renderContext_t* context, const uint32_t begin, const uint32_t end ) {
+			// the immediate context already holds the targets and shared resources
+			if ( context != &renderContext ) {
+				BindOpaquePass( context );
+			}
 
-	ID3D11Resource* resDst = nullptr;
-	mainRenderTarget.view->GetResource( &resDst );
+			opaqueSurf.DrawBatches( context, &transformBuffer, snapshot, static_cast<renderPass_t>( pass ), firstBatch + begin, end - begin );
+		} );
+	}
 
-	renderContext.deviceContext->ResolveSubresource( resSrc, D3D11CalcSubresource( 0, 0, 1 ), resDst, D3D11CalcSubresource( 0, 0, 1 ), DXGI_FORMAT_R16G16B16A16_FLOAT );
-	compositionPass.Render( &renderContext, &mainRenderTargetResolved, bloom.GetResolvedRenderTarget( &renderContext ) );
+	// unbind the ressource so that we can use the render target on the next frame
+	renderContext.backend->SetShaderResources( RENDER_STAGE_PIXEL, 8, 1, pSRV );
 }
 
 // screenshot
@@ -239,82 +422,229 @@ void RenderManager::FrameWorld( const float interpolatedFt, Camera* activeCamera
 
 void RenderManager::Swap() const
 {
-	renderContext.swapChain->Present( ( enableVsync ? 1 : 0 ), 0 );
+	renderContext.backend->Present( enableVsync );
 }
 
-void RenderManager::Resize( const unsigned short width, const unsigned short height )
+void RenderManager::StartRenderThread()
 {
-	Sys_ResizeRenderContext( &renderContext, width, height );
+	if ( isRenderThreadRunning ) {
+		return;
+	}
 
-	D3D11_RENDER_TARGET_VIEW_DESC   renderTargetViewDesc;
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-	renderTargetViewDesc.Texture2D.MipSlice = 0;
-	renderTargetViewDesc.Texture3D.MipSlice = 0;
-
-	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
-	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
-	shaderResourceViewDesc.Texture2D.MipLevels = -1;
-	shaderResourceViewDesc.Texture3D.MostDetailedMip = 0;
-	shaderResourceViewDesc.Texture3D.MipLevels = -1;
-
-	const D3D11_TEXTURE2D_DESC mainRtDesc = {
-		width,
-		height,
-		1,
-		1,
-		DXGI_FORMAT_R16G16B16A16_FLOAT,
-		{																					// DXGI_SAMPLE_DESC SampleDesc
-			1,																				//		UINT Count
-			0,																				//		UINT Quality
-		},
-		D3D11_USAGE_DEFAULT,
-		D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
-		0,
-		0,
-	};
+	freeSnapshots.clear();
+	queuedSnapshots.clear();
 
-	renderTargetViewDesc.Format = mainRtDesc.Format;
-	shaderResourceViewDesc.Format = mainRtDesc.Format;
+	for ( renderSnapshot_t& snapshot : snapshots ) {
+		freeSnapshots.push_back( &snapshot );
+	}
+
+	isRenderThreadRunning = true;
+	renderThread = std::thread( &RenderManager::RenderThreadLoop, this );
+}
 
-	if ( FAILED( renderContext.device->CreateTexture2D( &mainRtDesc, nullptr, &mainRenderTarget.tex2D ) ) ) {
+void RenderManager::StopRenderThread()
+{
+	if ( !isRenderThreadRunning ) {
 		return;
 	}
 
-	if ( FAILED( renderContext.device->CreateRenderTargetView( mainRenderTarget.tex2D, &renderTargetViewDesc, &mainRenderTarget.view ) ) ) {
-		return;
+	{
+		std::lock_guard<std::mutex> lock( snapshotLock );
+		isRenderThreadRunning = false;
 	}
 
-	if ( FAILED( renderContext.device->CreateShaderResourceView( mainRenderTarget.tex2D, &shaderResourceViewDesc, &mainRenderTarget.ressource ) ) ) {
+	// queued frames are rendered before the thread exits
+	snapshotCondition.notify_all();
+	renderThread.join();
+}
+
+renderSnapshot_t* RenderManager::AcquireSnapshot()
+{
+	renderSnapshot_t* snapshot = &snapshots[0];
+
+	{
+		std::unique_lock<std::mutex> lock( snapshotLock );
+
+		if ( isRenderThreadRunning ) {
+			snapshotCondition.wait( lock, [this]() { return !freeSnapshots.empty(); } );
+
+			snapshot = freeSnapshots.front();
+			freeSnapshots.pop_front();
+		}
+
+		buildingSnapshot = snapshot;
+	}
+
+	snapshot->frameIndex = frameCount++;
+
+	// resources released while the previous snapshots were in flight
+	renderContext.releases->BeginFrame( snapshot->frameIndex );
+	renderContext.releases->Collect();
+
+	return snapshot;
+}
+
+void RenderManager::SubmitSnapshot( renderSnapshot_t* snapshot )
+{
+	if ( !isRenderThreadRunning ) {
+		FrameWorld( snapshot );
+		Swap();
+		Render_ClearSnapshot( snapshot );
 		return;
 	}
 
-	// resize render targets and any additional stuff
+	{
+		std::lock_guard<std::mutex> lock( snapshotLock );
+		queuedSnapshots.push_back( snapshot );
+		buildingSnapshot = nullptr;
+	}
+
+	snapshotCondition.notify_all();
+}
+
+void RenderManager::RenderThreadLoop()
+{
+	while ( 1 ) {
+		renderSnapshot_t* snapshot = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock( snapshotLock );
+			snapshotCondition.wait( lock, [this]() { return !queuedSnapshots.empty() || !isRenderThreadRunning; } );
+
+			if ( queuedSnapshots.empty() ) {
+				return;
+			}
+
+			snapshot = queuedSnapshots.front();
+			queuedSnapshots.pop_front();
+		}
+
+		FrameWorld( snapshot );
+		Swap();
+
+		// let the world free evicted areas as soon as possible
+		Render_ClearSnapshot( snapshot );
+
+		{
+			std::lock_guard<std::mutex> lock( snapshotLock );
+			freeSnapshots.push_back( snapshot );
+		}
+
+		snapshotCondition.notify_all();
+	}
+}
+
+void RenderManager::Resize( const unsigned short width, const unsigned short height )
+{
+	Sys_ResizeRenderContext( &renderContext, width, height );
+
+	// only the targets sized from the back buffer are recreated
+	if ( !frameGraph.Compile( width, height ) || !frameGraph.Realize( renderContext.backend ) ) {
+		Log_Printf( "RenderManager: failed to resize the frame graph targets to %ux%u\n", width, height );
+		return;
+	}
 }
 
 void RenderManager::SwapEnvMap()
+{
+	if ( LoadEnvMap() ) {
+		BindEnvMap();
+	}
+}
+
+const bool RenderManager::LoadEnvMap()
 {
 	skybox.LoadEnvMap( &renderContext, &texMan, &matMan, ( isNight ? "base_data/textures/dev/ibl_env_j.dds" : "base_data/textures/dev/ibl_env_n.dds" ) );
 
 	iblCubeDiff = texMan.GetTexture( &renderContext, ( isNight ? "base_data/textures/dev/ibl_diffuse_j.dds" : "base_data/textures/dev/ibl_diffuse_n.dds" ) );
 	if ( iblCubeDiff == nullptr ) {
-		return;
+		return false;
 	}
 
-	renderContext.deviceContext->PSSetShaderResources( 6, 1, &iblCubeDiff->view );
-
 	iblCubeEnv = texMan.GetTexture( &renderContext, ( isNight ? "base_data/textures/dev/ibl_spec_j.dds" : "base_data/textures/dev/ibl_spec_n.dds" ) );
-	if ( iblCubeEnv == nullptr ) {
-		return;
-	}
 
-	renderContext.deviceContext->PSSetShaderResources( 7, 1, &iblCubeEnv->view );
+	return iblCubeEnv != nullptr;
+}
+
+void RenderManager::BindEnvMap()
+{
+	renderContext.backend->SetShaderResources( RENDER_STAGE_PIXEL, 6, 1, &iblCubeDiff->view );
+	renderContext.backend->SetShaderResources( RENDER_STAGE_PIXEL, 7, 1, &iblCubeEnv->view );
 
 	isNight = !isNight;
 }
 
-void RenderManager::UpdateCommonCBuffer()
+void RenderManager::BindOpaquePass( const renderContext_t* context )
 {
-	Render_UploadCBuffer( &renderContext, commonBuffer, &commonBufferData, sizeof( commonBuffer_t ) );
-	renderContext.deviceContext->PSSetConstantBuffers( 4, 1, &commonBuffer );
+	// deferred contexts start from the default state; nothing bound on the immediate context is inherited
+	renderTargetView_t* mainPassRv[2] = { frameGraph.GetTarget( frameTargets.main )->view, frameGraph.GetTarget( frameTargets.bloomSource )->view };
+	context->backend->SetRenderTargets( 2, mainPassRv, renderContext.depthStencilBuffer.view );
+	context->backend->SetViewport( sceneViewport );
+
+	StateCache* stateCache = context->stateCache;
+
+	stateCache->SetRasterizerState( renderContext.rasterState );
+	stateCache->SetDepthStencilState( renderContext.depthStencilBuffer.stateOpaque, 1 );
+	stateCache->SetBlendState( NULL );
+
+	stateCache->SetPSShaderResource( 5, iblLut->view );
+	stateCache->SetPSShaderResource( 6, iblCubeDiff->view );
+	stateCache->SetPSShaderResource( 7, iblCubeEnv->view );
+	stateCache->SetPSShaderResource( 8, frameGraph.GetTarget( frameTargets.shadowMap )->ressource );
+
+	cbufferRing.Rebind( context );
+}
+
+void RenderManager::UploadFrameConstants( const renderSnapshot_t* snapshot )
+{
+	const std::size_t drawCount = snapshot->draws.size();
+
+	const uint32_t frameSize = CBufferRing::GetAlignedSize( sizeof( commonBuffer_t ) )
+						 + CBufferRing::GetAlignedSize( sizeof( camCbuffer_t ) )
+						 + CBufferRing::GetAlignedSize( LightManager::GetCBufferSize() );
+
+	// a failed frame uploads nothing; empty slices are never bound
+	cbufferRing.BeginFrame( &renderContext, frameSize );
+
+	// common cbuffer (dt, sys infos, ...)
+	commonBufferData.deltaTime		= snapshot->frameTime;
+	commonBufferData.renderScale[0]	= sceneViewport.width / renderContext.viewport.width;
+	commonBufferData.renderScale[1]	= sceneViewport.height / renderContext.viewport.height;
+	const cbufferSlice_t commonSlice = cbufferRing.Upload( &commonBufferData, sizeof( commonBuffer_t ) );
+
+	// camera matrices have been computed by the simulation
+	const cbufferSlice_t cameraSlice = cbufferRing.Upload( &snapshot->camera, sizeof( camCbuffer_t ) );
+
+	// update light list
+	// WARNING: totally bloated; should be optimized ASAP!!!!!
+	const cbufferSlice_t lightSlice = lightMan.Update( &cbufferRing, snapshot, isNight );
+
+	cbufferRing.EndFrame( &renderContext );
+
+	// static draws keep their slot and don't upload anything
+	drawTransforms.resize( drawCount );
+
+	for ( std::size_t i = 0; i < drawCount; ++i ) {
+		const renderDraw_t& draw = snapshot->draws[i];
+		drawTransforms[i] = transformBuffer.Update( draw.mesh->transformation, draw.modelMatrix );
+	}
+
+	transformBuffer.Upload( &renderContext );
+
+	const std::size_t instanceCount = snapshot->instanceDraws.size();
+	instanceTransforms.resize( instanceCount );
+
+	for ( std::size_t i = 0; i < instanceCount; ++i ) {
+		instanceTransforms[i] = drawTransforms[snapshot->instanceDraws[i]];
+	}
+
+	transformBuffer.UploadInstances( &renderContext, instanceTransforms.data(), static_cast<uint32_t>( instanceCount ) );
+
+	cbufferRing.BindVS( &renderContext, 0, cameraSlice );
+	cbufferRing.BindPS( &renderContext, 0, cameraSlice );
+	cbufferRing.BindPS( &renderContext, 3, lightSlice );
+	cbufferRing.BindPS( &renderContext, 4, commonSlice );
+
+	// the atmosphere reads the camera before the next draw call
+	renderContext.stateCache->Flush();
 }
@@ -8,6 +8,16 @@ struct window_t;
 #include "Camera.h"
 #include "Texture.h"
 #include "LightManager.h"
+#include "RenderSnapshot.h"
+#include "StateCache.h"
+#include "CBufferRing.h"
+#include "TransformBuffer.h"
+#include "CommandRecorder.h"
+#include "FrameGraph.h"
+#include "GpuTimer.h"
+#include "DynamicResolution.h"
+
+#include <Engine/System/TaskGraph.h>
 
 #include "Surfaces/Default.h"
 #include "Surfaces/Opaque.h"
@@ -22,8 +32,11 @@ struct window_t;
 
 #include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
 
-struct worldArea_t;
-struct areaNode_t;
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
 
 class RenderManager
 {
@@ -31,6 +44,10 @@ public:
 	inline const renderContext_t*	GetContext() { return &renderContext; }
 	inline TextureManager*			GetTextureManager() { return &texMan; }
 	inline MaterialManager*			GetMaterialManager() { return &matMan; }
+	inline stateCacheCounters_t		GetStateCacheCounters() const { return stateCacheCounters; } // previous frame
+	inline uint32_t					GetTransformUploadSize() const { return transformBuffer.GetUploadedSize(); } // bytes, previous frame
+	inline const TaskGraph&			GetStartupTasks() const { return startupTasks; } // timings of Initialize
+	inline float					GetRenderScale() const { return dynamicResolution.GetScale(); } // of the next frame
 
 public:
 					RenderManager()					= default;
@@ -39,17 +56,32 @@ public:
 
 	void			Shutdown();
 	const int		Initialize( const window_t* window );
-	void			FrameWorld( const float interpolatedFt, Camera* activeCamera, const worldArea_t* activeArea );
+	const int		InitializeHeadless( const unsigned short width, const unsigned short height ); // null backend; frames are recorded, not drawn
+	void			FrameWorld( const renderSnapshot_t* snapshot );
 	void			Swap() const;
+
+	// pipelined rendering: frame N is rendered on a dedicated thread while frame N+1 is simulated
+	// once started, the render thread owns the immediate context; the caller must not issue any draw call
+	void				StartRenderThread();
+	void				StopRenderThread();
+	renderSnapshot_t*	AcquireSnapshot(); // blocks if the renderer is MAX_QUEUED_FRAMES frames behind
+	void				SubmitSnapshot( renderSnapshot_t* snapshot ); // renders and presents inline if the render thread is not running
 	void			Resize( const unsigned short width, const unsigned short height );
 
 	void			SwapEnvMap();
 
 private:
+	static constexpr int	MAX_QUEUED_FRAMES	= 1;
+	static constexpr int	SNAPSHOT_COUNT		= MAX_QUEUED_FRAMES + 2; // + one being built, + one being rendered
+	static constexpr uint32_t	CBUFFER_RING_SIZE	= 1 << 20; // grows if a frame needs more
+	static constexpr uint32_t	TRANSFORM_CAPACITY	= 4096; // grows as well
+	static constexpr float	MAX_GEOMETRY_FRAGMENTATION = 0.5f; // of the free space of the shared geometry buffers; compacted beyond
+
 	struct commonBuffer_t
 	{
 		float deltaTime;
-		int __PADDING__[3];
+		int __PADDING__;
+		float renderScale[2]; // scene viewport size over targets size
 	} commonBufferData;
 
 private:
@@ -66,11 +98,18 @@ private:
 		texture_t*		iblLut;
 		texture_t*		iblCubeDiff;
 		texture_t*		iblCubeEnv;
-
-		renderTarget_t	shadowMapTest;
 	// END TMP
 
-	CBuffer			commonBuffer;
+	// every per-frame constant (common, camera, lights) is uploaded with a single map
+	CBufferRing					cbufferRing;
+
+	// model matrices persist from one frame to another; only the ones which changed are uploaded
+	TransformBuffer				transformBuffer;
+	std::vector<uint32_t>		drawTransforms;		// indexed by renderSubDraw_t::drawIndex
+	std::vector<uint32_t>		instanceTransforms;	// indexed like renderSnapshot_t::instanceDraws
+
+	// opaque batches are recorded in parallel (one deferred context per chunk)
+	CommandRecorder				commandRecorder;
 
 	// Surfaces
 	SurfaceDefault	defaultSurf;
@@ -85,12 +124,51 @@ private:
 	GaussianBlur	gaussianBlur;
 
 	// Render Targets
-	renderTarget_t	mainRenderTarget;
-	renderTarget_t	mainRenderTargetResolved;
+	// owned by the frame graph; sized (and resized) from the back buffer
+	FrameGraph		frameGraph;
+
+	struct frameTargets_t
+	{
+		frameGraphResource_t	main;
+		frameGraphResource_t	bloomSource;
+		frameGraphResource_t	mainResolved;
+		frameGraphResource_t	shadowMap;
+		frameGraphResource_t	bloomResult;
+	} frameTargets;
+
+	const renderSnapshot_t*	frameSnapshot; // read by the passes while the graph executes
+
+	// dynamic resolution: the scene is rendered in the top left corner of the targets, smaller when the gpu is over budget
+	// the passes after the resolve work on the whole targets; composition upscales the corner to the back buffer
+	GpuTimer				gpuTimer;
+	DynamicResolution		dynamicResolution;
+	renderViewport_t		sceneViewport;
+
+	// startup steps and their dependencies; kept for the timing report
+	TaskGraph		startupTasks;
 
 	bool			isNight;
 
+	stateCacheCounters_t			stateCacheCounters;
+
+	// render thread
+	renderSnapshot_t				snapshots[SNAPSHOT_COUNT];
+	std::deque<renderSnapshot_t*>	freeSnapshots;
+	std::deque<renderSnapshot_t*>	queuedSnapshots;
+	std::mutex						snapshotLock;
+	std::condition_variable			snapshotCondition;
+	std::thread						renderThread;
+	bool							isRenderThreadRunning;
+	uint64_t						frameCount;
+	const renderSnapshot_t*			buildingSnapshot;	// acquired and not submitted yet: the main thread may be reading the meshes
+
 private:
-	void			RenderNode( Camera* activeCamera, const areaNode_t* node );
-	void			UpdateCommonCBuffer();
+	const int		InitializeResources(); // once the context exists; sized from its back buffer
+	void			RenderThreadLoop();
+	void			UploadFrameConstants( const renderSnapshot_t* snapshot );
+	void			BindOpaquePass( const renderContext_t* context );
+	void			BuildFrameGraph();
+	void			RenderOpaquePass( const FrameGraph* graph );
+	const bool		LoadEnvMap(); // textures of the next env map; any thread
+	void			BindEnvMap();
 };
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "Shared.h"
+#include "RenderQueue.h"
+
+#include <Engine/System/JobSystem.h>
+
+#include <algorithm>
+
+namespace
+{
+	constexpr uint32_t	RADIX_BITS			= 8;
+	constexpr uint32_t	RADIX_BUCKETS		= 1 << RADIX_BITS;
+	constexpr uint32_t	RADIX_PASS_COUNT	= 64 / RADIX_BITS;
+
+	// below this, splitting the work costs more than it saves
+	constexpr std::size_t	PARALLEL_SORT_THRESHOLD	= 16384;
+	constexpr std::size_t	MIN_BLOCK_SIZE			= 8192;
+
+	uint32_t GetDepthBits( const float viewDepth )
+	{
+		// the bit pattern of a positive float grows with its value; keep the 24 msb
+		const float clampedDepth = std::max( viewDepth, 0.0f );
+
+		uint32_t depthBits = 0;
+		memcpy( &depthBits, &clampedDepth, sizeof( float ) );
+
+		return depthBits >> 8;
+	}
+
+	inline uint32_t GetDigit( const sortKey_t key, const uint32_t pass )
+	{
+		return static_cast<uint32_t>( key >> ( pass * RADIX_BITS ) ) & ( RADIX_BUCKETS - 1 );
+	}
+
+	void SortSerial( renderQueueItem_t* items, renderQueueItem_t* scratch, const std::size_t itemCount )
+	{
+		uint32_t histograms[RADIX_PASS_COUNT][RADIX_BUCKETS] = {};
+
+		// every histogram in a single read
+		for ( std::size_t i = 0; i < itemCount; ++i ) {
+			for ( uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass ) {
+				histograms[pass][GetDigit( items[i].key, pass )]++;
+			}
+		}
+
+		renderQueueItem_t* source = items;
+		renderQueueItem_t* destination = scratch;
+
+		for ( uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass ) {
+			uint32_t* histogram = histograms[pass];
+
+			// every key shares this digit; nothing to do
+			if ( histogram[GetDigit( source[0].key, pass )] == itemCount ) {
+				continue;
+			}
+
+			uint32_t offset = 0;
+			for ( uint32_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket ) {
+				const uint32_t bucketCount = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucketCount;
+			}
+
+			for ( std::size_t i = 0; i < itemCount; ++i ) {
+				destination[histogram[GetDigit( source[i].key, pass )]++] = source[i];
+			}
+
+			std::swap( source, destination );
+		}
+
+		if ( source != items ) {
+			memcpy( items, source, itemCount * sizeof( renderQueueItem_t ) );
+		}
+	}
+
+	void SortParallel( renderQueueItem_t* items, renderQueueItem_t* scratch, const std::size_t itemCount )
+	{
+		const uint32_t blockCount = static_cast<uint32_t>( std::min<std::size_t>( Job_GetWorkerCount() * 2, ( itemCount + MIN_BLOCK_SIZE - 1 ) / MIN_BLOCK_SIZE ) );
+		const uint32_t blockSize = static_cast<uint32_t>( ( itemCount + blockCount - 1 ) / blockCount );
+
+		// one histogram per block; turned into per block scatter offsets
+		std::vector<uint32_t> blockHistograms( blockCount * RADIX_BUCKETS );
+
+		renderQueueItem_t* source = items;
+		renderQueueItem_t* destination = scratch;
+
+		for ( uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass ) {
+			std::fill( blockHistograms.begin(), blockHistograms.end(), 0 );
+
+			Job_ParallelFor( 0, blockCount, 1, [&]( const uint32_t blockBegin, const uint32_t blockEnd ) {
+				for ( uint32_t block = blockBegin; block < blockEnd; ++block ) {
+					uint32_t* histogram = &blockHistograms[block * RADIX_BUCKETS];
+
+					const std::size_t first = static_cast<std::size_t>( block ) * blockSize,
+									  last	= std::min<std::size_t>( first + blockSize, itemCount );
+
+					for ( std::size_t i = first; i < last; ++i ) {
+						histogram[GetDigit( source[i].key, pass )]++;
+					}
+				}
+			} );
+
+			// buckets first, then blocks: keeps the sort stable
+			uint32_t offset = 0, largestBucket = 0;
+			for ( uint32_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket ) {
+				const uint32_t bucketBegin = offset;
+
+				for ( uint32_t block = 0; block < blockCount; ++block ) {
+					uint32_t& count = blockHistograms[block * RADIX_BUCKETS + bucket];
+					const uint32_t blockBucketCount = count;
+
+					count = offset;
+					offset += blockBucketCount;
+				}
+
+				largestBucket = std::max( largestBucket, offset - bucketBegin );
+			}
+
+			if ( largestBucket == itemCount ) {
+				continue;
+			}
+
+			Job_ParallelFor( 0, blockCount, 1, [&]( const uint32_t blockBegin, const uint32_t blockEnd ) {
+				for ( uint32_t block = blockBegin; block < blockEnd; ++block ) {
+					uint32_t* offsets = &blockHistograms[block * RADIX_BUCKETS];
+
+					const std::size_t first = static_cast<std::size_t>( block ) * blockSize,
+									  last	= std::min<std::size_t>( first + blockSize, itemCount );
+
+					for ( std::size_t i = first; i < last; ++i ) {
+						destination[offsets[GetDigit( source[i].key, pass )]++] = source[i];
+					}
+				}
+			} );
+
+			std::swap( source, destination );
+		}
+
+		if ( source != items ) {
+			memcpy( items, source, itemCount * sizeof( renderQueueItem_t ) );
+		}
+	}
+}
+
+sortKey_t Render_BuildSortKey( const renderPass_t pass, const surfType_t surfType, const uint32_t shader, const uint32_t material, const float viewDepth )
+{
+	const sortKey_t passBits		= static_cast<sortKey_t>( pass & 0xF ) << 60;
+	const sortKey_t surfaceBits		= static_cast<sortKey_t>( surfType & 0xF ) << 56;
+	const sortKey_t shaderBits		= static_cast<sortKey_t>( shader & 0xFF );
+	const sortKey_t materialBits	= static_cast<sortKey_t>( material & 0xFFFFFF );
+	const sortKey_t depthBits		= static_cast<sortKey_t>( GetDepthBits( viewDepth ) );
+
+	if ( pass == RENDER_PASS_TRANSPARENT ) {
+		// blending order first; farthest draws come first
+		return passBits | surfaceBits | ( ( ~depthBits & 0xFFFFFF ) << 32 ) | ( shaderBits << 24 ) | materialBits;
+	}
+
+	return passBits | surfaceBits | ( shaderBits << 48 ) | ( materialBits << 24 ) | depthBits;
+}
+
+void RenderQueue::Clear()
+{
+	items.clear();
+}
+
+void RenderQueue::Push( const sortKey_t key, const uint32_t payload )
+{
+	items.push_back( { key, payload, 0 } );
+}
+
+void RenderQueue::Sort()
+{
+	scratch.resize( items.size() );
+
+	Render_RadixSort( items.data(), scratch.data(), items.size() );
+}
+
+void Render_RadixSort( renderQueueItem_t* items, renderQueueItem_t* scratch, const std::size_t itemCount )
+{
+	if ( itemCount < 2 ) {
+		return;
+	}
+
+	if ( itemCount < PARALLEL_SORT_THRESHOLD || !Job_IsInitialized() || Job_GetWorkerCount() < 2 ) {
+		SortSerial( items, scratch, itemCount );
+	} else {
+		SortParallel( items, scratch, itemCount );
+	}
+}
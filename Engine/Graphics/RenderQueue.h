@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Material.h"
+
+#include <vector>
+
+enum renderPass_t
+{
+	RENDER_PASS_OPAQUE = 0,
+	RENDER_PASS_TRANSPARENT,
+	RENDER_PASS_UI,
+
+	RENDER_PASS_COUNT
+};
+
+using sortKey_t = uint64_t;
+
+// 64 bits sort key; everything required to order draws so that state changes are minimized
+// opaque (msb to lsb)		: pass (4) | surface (4) | shader (8) | material (24) | depth (24, front to back)
+// transparent (msb to lsb)	: pass (4) | surface (4) | depth (24, back to front) | shader (8) | material (24)
+sortKey_t Render_BuildSortKey( const renderPass_t pass, const surfType_t surfType, const uint32_t shader, const uint32_t material, const float viewDepth );
+
+inline renderPass_t Render_GetSortKeyPass( const sortKey_t key )
+{
+	return static_cast<renderPass_t>( key >> 60 );
+}
+
+inline surfType_t Render_GetSortKeySurface( const sortKey_t key )
+{
+	return static_cast<surfType_t>( ( key >> 56 ) & 0xF );
+}
+
+struct renderQueueItem_t
+{
+	sortKey_t	key;		// 8
+	uint32_t	payload;	// 4 // index in the caller draw list
+	uint32_t	__PADDING__;// 4
+};
+
+// flat list of draws; filled in any order, sorted once and consumed linearly
+class RenderQueue
+{
+public:
+	inline const renderQueueItem_t*	GetItems() const		{ return items.data(); }
+	inline std::size_t				GetItemCount() const	{ return items.size(); }
+
+public:
+								RenderQueue()					= default;
+								RenderQueue( RenderQueue& )		= delete;
+								~RenderQueue()					= default;
+
+	void						Clear(); // keeps capacity
+	void						Push( const sortKey_t key, const uint32_t payload );
+	void						Sort();
+
+private:
+	std::vector<renderQueueItem_t>	items;
+	std::vector<renderQueueItem_t>	scratch;
+};
+
+// stable LSD radix sort (8 bits per pass) on the item keys; 'scratch' must hold 'itemCount' items
+// large inputs are histogrammed and scattered in parallel through the job system
+void	Render_RadixSort( renderQueueItem_t* items, renderQueueItem_t* scratch, const std::size_t itemCount );
@@ -0,0 +1,317 @@
+#include "Shared.h"
+#include "RenderSnapshot.h"
+#include "Mesh.h"
+
+#include <Engine/Game/World.h>
+
+#include <algorithm>
+
+namespace
+{
+	void CollectContent( renderSnapshot_t* snapshot, const areaNode_t* node )
+	{
+		// empty nodes (or content which has not been loaded); their children are still collected
+		if ( node->content == nullptr ) {
+			return;
+		}
+
+		if ( node->flags & NODE_FLAG_CONTENT_MESH ) {
+			const mesh_t* mesh = static_cast<const mesh_t*>( node->content );
+			snapshot->draws.push_back( { mesh, mesh->transformation->modelMatrix } );
+		} else if ( node->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
+			snapshot->sphereLights.push_back( *static_cast<const sphereAreaLight_t*>( node->content ) );
+		} else if ( node->flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
+			snapshot->diskLights.push_back( *static_cast<const diskAreaLight_t*>( node->content ) );
+		} else if ( node->flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
+			snapshot->rectangleLights.push_back( *static_cast<const rectangleAreaLight_t*>( node->content ) );
+		} else if ( node->flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
+			const sunLight_t* sun = static_cast<const sunLight_t*>( node->content );
+
+			snapshot->sun		= { sun->worldPositionRadius, sun->colorAndIntensityLux, sun->sphericalThetaGammaAndPADDING };
+			snapshot->hasSun	= true;
+		}
+	}
+
+	void CollectNode( renderSnapshot_t* snapshot, const areaNode_t* node )
+	{
+		for ( const areaNode_t* child : node->children ) {
+			CollectContent( snapshot, child );
+
+			if ( child->children.size() > 0 ) {
+				CollectNode( snapshot, child );
+			}
+		}
+	}
+
+	struct viewFrustum_t
+	{
+		DirectX::XMVECTOR	planes[6];	// inward facing
+	};
+
+	// clip space planes of a row vector view projection (d3d depth range)
+	viewFrustum_t BuildFrustum( const DirectX::XMMATRIX& viewProjection )
+	{
+		const DirectX::XMMATRIX columns = DirectX::XMMatrixTranspose( viewProjection );
+
+		viewFrustum_t frustum = {};
+		frustum.planes[0] = DirectX::XMPlaneNormalize( DirectX::XMVectorAdd( columns.r[3], columns.r[0] ) );
+		frustum.planes[1] = DirectX::XMPlaneNormalize( DirectX::XMVectorSubtract( columns.r[3], columns.r[0] ) );
+		frustum.planes[2] = DirectX::XMPlaneNormalize( DirectX::XMVectorAdd( columns.r[3], columns.r[1] ) );
+		frustum.planes[3] = DirectX::XMPlaneNormalize( DirectX::XMVectorSubtract( columns.r[3], columns.r[1] ) );
+		frustum.planes[4] = DirectX::XMPlaneNormalize( columns.r[2] );
+		frustum.planes[5] = DirectX::XMPlaneNormalize( DirectX::XMVectorSubtract( columns.r[3], columns.r[2] ) );
+
+		return frustum;
+	}
+
+	const bool IsSphereVisible( const viewFrustum_t& frustum, const DirectX::BoundingSphere& sphere )
+	{
+		const DirectX::XMVECTOR center = DirectX::XMLoadFloat3( &sphere.Center );
+
+		for ( const DirectX::XMVECTOR& plane : frustum.planes ) {
+			if ( DirectX::XMVectorGetX( DirectX::XMPlaneDotCoord( plane, center ) ) < -sphere.Radius ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void QueueSubDraw( renderSnapshot_t* snapshot, const renderPass_t pass, const material_t* material, const float viewDepth, const renderSubDraw_t& subDraw )
+	{
+		const sortKey_t key = Render_BuildSortKey( pass, material->surfType, Render_GetShaderPermutation( material ), material->sortId, viewDepth );
+
+		snapshot->queue.Push( key, static_cast<uint32_t>( snapshot->subDraws.size() ) );
+		snapshot->subDraws.push_back( subDraw );
+	}
+
+	// static batch submeshes are made of pieces (sorted by ibo offset); culled pieces split the submesh range in runs
+	// each run is sorted by its nearest piece (the batch is in world space: its origin says nothing about the depth)
+	void QueuePieces( renderSnapshot_t* snapshot, const viewFrustum_t& frustum, const uint32_t drawIndex, const uint32_t subMeshIndex )
+	{
+		const mesh_t* mesh = snapshot->draws[drawIndex].mesh;
+		const submesh_t& subMesh = mesh->subMeshes[subMeshIndex];
+		const DirectX::XMMATRIX& viewProjection = snapshot->camera.viewProjection;
+
+		const unsigned int rangeEnd = subMesh.iboOffset + subMesh.indiceCount;
+
+		auto piece = std::lower_bound( mesh->pieces.begin(), mesh->pieces.end(), subMesh.iboOffset, []( const meshPiece_t& meshPiece, const unsigned int offset ) {
+			return meshPiece.iboOffset < offset;
+		} );
+
+		renderSubDraw_t run = { drawIndex, subMeshIndex, 0, 0 };
+		float runDepth = 0.0f;
+
+		for ( ; piece != mesh->pieces.end() && piece->iboOffset < rangeEnd; ++piece ) {
+			if ( !IsSphereVisible( frustum, piece->boundingSphere ) ) {
+				if ( run.indiceCount != 0 ) {
+					QueueSubDraw( snapshot, RENDER_PASS_OPAQUE, subMesh.material, runDepth, run );
+					run.indiceCount = 0;
+				}
+
+				continue;
+			}
+
+			const float pieceDepth = DirectX::XMVectorGetW( DirectX::XMVector3Transform( DirectX::XMLoadFloat3( &piece->boundingSphere.Center ), viewProjection ) );
+
+			if ( run.indiceCount == 0 ) {
+				run.iboOffset	= piece->iboOffset;
+				runDepth		= pieceDepth;
+			} else {
+				runDepth		= std::min( runDepth, pieceDepth );
+			}
+
+			run.indiceCount += piece->indiceCount;
+		}
+
+		if ( run.indiceCount != 0 ) {
+			QueueSubDraw( snapshot, RENDER_PASS_OPAQUE, subMesh.material, runDepth, run );
+		}
+	}
+
+	void QueueDraws( renderSnapshot_t* snapshot )
+	{
+		const DirectX::XMMATRIX& viewProjection = snapshot->camera.viewProjection;
+		const viewFrustum_t frustum = BuildFrustum( viewProjection );
+
+		for ( uint32_t drawIndex = 0; drawIndex < snapshot->draws.size(); ++drawIndex ) {
+			const renderDraw_t& draw = snapshot->draws[drawIndex];
+
+			// clip space w is the view space depth
+			const float viewDepth = DirectX::XMVectorGetW( DirectX::XMVector3Transform( draw.modelMatrix.r[3], viewProjection ) );
+
+			for ( uint32_t subMeshIndex = 0; subMeshIndex < draw.mesh->subMeshes.size(); ++subMeshIndex ) {
+				const submesh_t& subMesh = draw.mesh->subMeshes[subMeshIndex];
+				const material_t* material = subMesh.material;
+
+				if ( material == nullptr || material->surfType == SURF_INVISIBLE ) {
+					continue;
+				}
+
+				// merged meshes are opaque only (see Render_IsMergeableMesh)
+				if ( !draw.mesh->pieces.empty() ) {
+					QueuePieces( snapshot, frustum, drawIndex, subMeshIndex );
+					continue;
+				}
+
+				renderPass_t pass = RENDER_PASS_OPAQUE;
+
+				if ( material->surfType == SURF_UI ) {
+					pass = RENDER_PASS_UI;
+				} else if ( material->surfType == SURF_TRANSPARENT || material->alpha != nullptr ) {
+					// alpha mapped materials are blended; they have to be drawn after opaque stuff
+					pass = RENDER_PASS_TRANSPARENT;
+				}
+
+				QueueSubDraw( snapshot, pass, material, viewDepth, { drawIndex, subMeshIndex, subMesh.iboOffset, subMesh.indiceCount } );
+			}
+		}
+
+		snapshot->queue.Sort();
+	}
+
+	struct batchEntry_t
+	{
+		const void*				geometry;	// see Render_GetMeshGeometry; range offsets are not read here (the render thread compacts them)
+		const material_t*		material;
+		uint32_t				iboOffset;	// in the mesh
+		uint32_t				indiceCount;
+		uint32_t				order;		// position in the queue
+		uint32_t				subDrawIndex;
+	};
+
+	const bool IsSameBatch( const batchEntry_t& a, const batchEntry_t& b )
+	{
+		return a.geometry == b.geometry && a.material == b.material && a.iboOffset == b.iboOffset && a.indiceCount == b.indiceCount;
+	}
+
+	// copies of a mesh share their gpu buffers (e.g. WorldEditor::PasteNode); each identical submesh of a queue run becomes an instance
+	// of the same batch; batches keep the order of their first instance (front to back is mostly preserved)
+	void BuildBatches( renderSnapshot_t* snapshot )
+	{
+		const renderQueueItem_t* items = snapshot->queue.GetItems();
+		const std::size_t itemCount = snapshot->queue.GetItemCount();
+
+		std::vector<batchEntry_t> entries;
+		std::vector<std::pair<uint32_t, renderBatch_t>> runBatches; // queue position of the first instance
+
+		// the queue is sorted by pass first: each pass is a contiguous range of batches
+		uint32_t nextPass = 0;
+
+		for ( std::size_t runBegin = 0; runBegin < itemCount; ) {
+			const sortKey_t runKey = items[runBegin].key;
+
+			while ( nextPass <= static_cast<uint32_t>( Render_GetSortKeyPass( runKey ) ) ) {
+				snapshot->passBatchOffsets[nextPass++] = static_cast<uint32_t>( snapshot->batches.size() );
+			}
+
+			// blending order must be kept; only opaque draws with the same states (anything but the depth) are merged
+			if ( Render_GetSortKeyPass( runKey ) != RENDER_PASS_OPAQUE ) {
+				const uint32_t subDrawIndex = items[runBegin].payload;
+
+				snapshot->batches.push_back( { subDrawIndex, static_cast<uint32_t>( snapshot->instanceDraws.size() ), 1 } );
+				snapshot->instanceDraws.push_back( snapshot->subDraws[subDrawIndex].drawIndex );
+
+				runBegin++;
+				continue;
+			}
+
+			std::size_t runEnd = runBegin + 1;
+			while ( runEnd < itemCount && ( items[runEnd].key >> 24 ) == ( runKey >> 24 ) ) {
+				runEnd++;
+			}
+
+			entries.clear();
+
+			for ( std::size_t i = runBegin; i < runEnd; ++i ) {
+				const renderSubDraw_t& subDraw = snapshot->subDraws[items[i].payload];
+				const mesh_t* mesh = snapshot->draws[subDraw.drawIndex].mesh;
+				const submesh_t& subMesh = mesh->subMeshes[subDraw.subMeshIndex];
+
+				entries.push_back( { Render_GetMeshGeometry( mesh ), subMesh.material, subDraw.iboOffset, subDraw.indiceCount, static_cast<uint32_t>( i ), items[i].payload } );
+			}
+
+			std::sort( entries.begin(), entries.end(), []( const batchEntry_t& a, const batchEntry_t& b ) {
+				if ( a.geometry != b.geometry ) return a.geometry < b.geometry;
+				if ( a.material != b.material ) return a.material < b.material;
+				if ( a.iboOffset != b.iboOffset ) return a.iboOffset < b.iboOffset;
+				if ( a.indiceCount != b.indiceCount ) return a.indiceCount < b.indiceCount;
+				return a.order < b.order;
+			} );
+
+			runBatches.clear();
+
+			for ( std::size_t i = 0; i < entries.size(); ++i ) {
+				if ( i == 0 || !IsSameBatch( entries[i - 1], entries[i] ) ) {
+					// entries of a batch are sorted by queue position; the first one gives the batch position
+					runBatches.push_back( { entries[i].order, { entries[i].subDrawIndex, static_cast<uint32_t>( snapshot->instanceDraws.size() ), 0 } } );
+				}
+
+				runBatches.back().second.instanceCount++;
+				snapshot->instanceDraws.push_back( snapshot->subDraws[entries[i].subDrawIndex].drawIndex );
+			}
+
+			std::sort( runBatches.begin(), runBatches.end(), []( const std::pair<uint32_t, renderBatch_t>& a, const std::pair<uint32_t, renderBatch_t>& b ) {
+				return a.first < b.first;
+			} );
+
+			for ( const std::pair<uint32_t, renderBatch_t>& runBatch : runBatches ) {
+				snapshot->batches.push_back( runBatch.second );
+			}
+
+			runBegin = runEnd;
+		}
+
+		while ( nextPass <= RENDER_PASS_COUNT ) {
+			snapshot->passBatchOffsets[nextPass++] = static_cast<uint32_t>( snapshot->batches.size() );
+		}
+	}
+}
+
+void Render_ClearSnapshot( renderSnapshot_t* snapshot )
+{
+	for ( const worldArea_t* area : snapshot->areas ) {
+		World::ReleaseArea( area );
+	}
+
+	snapshot->areas.clear();
+	snapshot->draws.clear();
+	snapshot->subDraws.clear();
+	snapshot->queue.Clear();
+	snapshot->batches.clear();
+	snapshot->instanceDraws.clear();
+
+	for ( uint32_t& offset : snapshot->passBatchOffsets ) {
+		offset = 0;
+	}
+	snapshot->sphereLights.clear();
+	snapshot->diskLights.clear();
+	snapshot->rectangleLights.clear();
+
+	snapshot->hasSun = false;
+}
+
+void Render_BuildSnapshot( renderSnapshot_t* snapshot, const Camera* camera, const worldArea_t* const* areas, const std::size_t areaCount, const float frameTime )
+{
+	Render_ClearSnapshot( snapshot );
+
+	snapshot->frameTime = frameTime;
+
+	camera->GetShaderMatrices( &snapshot->camera );
+
+	for ( std::size_t i = 0; i < areaCount; ++i ) {
+		const worldArea_t* area = areas[i];
+
+		if ( area == nullptr || area->nodes == nullptr ) {
+			continue;
+		}
+
+		World::AcquireArea( area );
+		snapshot->areas.push_back( area );
+
+		CollectNode( snapshot, area->nodes );
+	}
+
+	QueueDraws( snapshot );
+	BuildBatches( snapshot );
+}
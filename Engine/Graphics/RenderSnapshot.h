@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Camera.h"
+#include "LightManager.h"
+#include "RenderQueue.h"
+
+#include <vector>
+
+struct mesh_t;
+struct worldArea_t;
+
+// sunLight_t without its gpu resources (which can't be copied)
+struct renderSun_t
+{
+	DirectX::XMFLOAT4	worldPositionRadius;
+	DirectX::XMFLOAT4	colorAndIntensityLux;
+	DirectX::XMFLOAT4	sphericalThetaGammaAndPADDING;
+};
+
+struct renderDraw_t
+{
+	const mesh_t*		mesh;
+	DirectX::XMMATRIX	modelMatrix;
+};
+
+// a single submesh of a draw; render queue payloads index this list
+// static batches are drawn by runs of visible pieces: the index range is then a part of the submesh one
+struct renderSubDraw_t
+{
+	uint32_t			drawIndex;
+	uint32_t			subMeshIndex;
+	uint32_t			iboOffset;		// relative to the mesh first index (see submesh_t)
+	uint32_t			indiceCount;
+};
+
+// subdraws sharing vertex buffer, submesh range and material; drawn with a single instanced call
+struct renderBatch_t
+{
+	uint32_t			subDrawIndex;	// first subdraw of the batch (mesh, submesh and material of the whole batch)
+	uint32_t			firstInstance;	// in renderSnapshot_t::instanceDraws
+	uint32_t			instanceCount;
+};
+
+// immutable copy of everything required to render a frame
+// built by the simulation thread, consumed by the renderer; it never reads the live world
+struct renderSnapshot_t
+{
+	uint64_t							frameIndex;		// assigned by RenderManager::AcquireSnapshot
+	float								frameTime;		// seconds
+
+	camCbuffer_t						camera;
+
+	std::vector<renderDraw_t>			draws;
+	std::vector<renderSubDraw_t>		subDraws;
+	RenderQueue							queue;			// sorted subDraws
+	std::vector<renderBatch_t>			batches;		// queue order; only opaque draws are merged
+	uint32_t							passBatchOffsets[RENDER_PASS_COUNT + 1]; // batches of pass p: [passBatchOffsets[p], passBatchOffsets[p + 1])
+	std::vector<uint32_t>				instanceDraws;	// draw index of each batch instance
+	std::vector<sphereAreaLight_t>		sphereLights;
+	std::vector<diskAreaLight_t>		diskLights;
+	std::vector<rectangleAreaLight_t>	rectangleLights;
+	renderSun_t							sun;
+	bool								hasSun;
+
+	std::vector<const worldArea_t*>		areas;			// acquired while the snapshot is alive (meshes are owned by the areas)
+};
+
+// releases the areas held by the snapshot and empties it (capacity is kept for the next frame)
+void	Render_ClearSnapshot( renderSnapshot_t* snapshot );
+void	Render_BuildSnapshot( renderSnapshot_t* snapshot, const Camera* camera, const worldArea_t* const* areas, const std::size_t areaCount, const float frameTime );
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// device neutral types of the render backends (see RenderBackend)
+// enum values are the d3d11 / dxgi ones (the d3d11 backend checks them); view dimensions are converted
+// descriptors only have 32 bits fields, without padding: the pipeline state cache hashes their bytes
+
+enum renderFormat_t
+{
+	RENDER_FORMAT_UNKNOWN				= 0,
+	RENDER_FORMAT_R32G32B32A32_FLOAT	= 2,
+	RENDER_FORMAT_R32G32B32_FLOAT		= 6,
+	RENDER_FORMAT_R16G16B16A16_FLOAT	= 10,
+	RENDER_FORMAT_R32G32_FLOAT			= 16,
+	RENDER_FORMAT_R8G8B8A8_UNORM		= 28,
+	RENDER_FORMAT_R32_TYPELESS			= 39,
+	RENDER_FORMAT_D32_FLOAT				= 40,
+	RENDER_FORMAT_R32_FLOAT				= 41,
+	RENDER_FORMAT_R32_UINT				= 42,
+	RENDER_FORMAT_R24G8_TYPELESS		= 44,
+	RENDER_FORMAT_D24_UNORM_S8_UINT		= 45,
+	RENDER_FORMAT_R24_UNORM_X8_TYPELESS	= 46,
+	RENDER_FORMAT_R16_TYPELESS			= 53,
+	RENDER_FORMAT_R16_FLOAT				= 54,
+	RENDER_FORMAT_D16_UNORM				= 55,
+	RENDER_FORMAT_R16_UNORM				= 56,
+	RENDER_FORMAT_R8_UNORM				= 61,
+};
+
+enum renderBindFlags_t
+{
+	RENDER_BIND_VERTEX_BUFFER		= 0x1,
+	RENDER_BIND_INDEX_BUFFER		= 0x2,
+	RENDER_BIND_CONSTANT_BUFFER		= 0x4,
+	RENDER_BIND_SHADER_RESOURCE		= 0x8,
+	RENDER_BIND_RENDER_TARGET		= 0x20,
+	RENDER_BIND_DEPTH_STENCIL		= 0x40,
+};
+
+enum renderUsage_t
+{
+	RENDER_USAGE_DEFAULT	= 0,
+	RENDER_USAGE_IMMUTABLE	= 1,
+	RENDER_USAGE_DYNAMIC	= 2,
+	RENDER_USAGE_STAGING	= 3,
+};
+
+enum renderCpuAccessFlags_t
+{
+	RENDER_CPU_ACCESS_WRITE	= 0x10000,
+	RENDER_CPU_ACCESS_READ	= 0x20000,
+};
+
+enum renderMiscFlags_t
+{
+	RENDER_MISC_GENERATE_MIPS		= 0x1,	// render target and shader resource textures
+	RENDER_MISC_BUFFER_STRUCTURED	= 0x40,
+};
+
+enum renderMap_t
+{
+	RENDER_MAP_READ					= 1,
+	RENDER_MAP_WRITE				= 2,
+	RENDER_MAP_READ_WRITE			= 3,
+	RENDER_MAP_WRITE_DISCARD		= 4,
+	RENDER_MAP_WRITE_NO_OVERWRITE	= 5,
+};
+
+enum renderPrimitiveTopology_t
+{
+	RENDER_PRIMITIVE_TOPOLOGY_UNDEFINED		= 0,
+	RENDER_PRIMITIVE_TOPOLOGY_POINTLIST		= 1,
+	RENDER_PRIMITIVE_TOPOLOGY_LINELIST		= 2,
+	RENDER_PRIMITIVE_TOPOLOGY_LINESTRIP		= 3,
+	RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST	= 4,
+	RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP	= 5,
+};
+
+enum renderComparison_t
+{
+	RENDER_COMPARISON_NEVER			= 1,
+	RENDER_COMPARISON_LESS			= 2,
+	RENDER_COMPARISON_EQUAL			= 3,
+	RENDER_COMPARISON_LESS_EQUAL	= 4,
+	RENDER_COMPARISON_GREATER		= 5,
+	RENDER_COMPARISON_NOT_EQUAL		= 6,
+	RENDER_COMPARISON_GREATER_EQUAL	= 7,
+	RENDER_COMPARISON_ALWAYS		= 8,
+};
+
+enum renderDepthWriteMask_t
+{
+	RENDER_DEPTH_WRITE_MASK_ZERO	= 0,
+	RENDER_DEPTH_WRITE_MASK_ALL		= 1,
+};
+
+enum renderStencilOp_t
+{
+	RENDER_STENCIL_OP_KEEP		= 1,
+	RENDER_STENCIL_OP_ZERO		= 2,
+	RENDER_STENCIL_OP_REPLACE	= 3,
+	RENDER_STENCIL_OP_INCR_SAT	= 4,
+	RENDER_STENCIL_OP_DECR_SAT	= 5,
+	RENDER_STENCIL_OP_INVERT	= 6,
+	RENDER_STENCIL_OP_INCR		= 7,
+	RENDER_STENCIL_OP_DECR		= 8,
+};
+
+enum renderBlend_t
+{
+	RENDER_BLEND_ZERO			= 1,
+	RENDER_BLEND_ONE			= 2,
+	RENDER_BLEND_SRC_COLOR		= 3,
+	RENDER_BLEND_INV_SRC_COLOR	= 4,
+	RENDER_BLEND_SRC_ALPHA		= 5,
+	RENDER_BLEND_INV_SRC_ALPHA	= 6,
+	RENDER_BLEND_DEST_ALPHA		= 7,
+	RENDER_BLEND_INV_DEST_ALPHA	= 8,
+	RENDER_BLEND_DEST_COLOR		= 9,
+	RENDER_BLEND_INV_DEST_COLOR	= 10,
+};
+
+enum renderBlendOp_t
+{
+	RENDER_BLEND_OP_ADD				= 1,
+	RENDER_BLEND_OP_SUBTRACT		= 2,
+	RENDER_BLEND_OP_REV_SUBTRACT	= 3,
+	RENDER_BLEND_OP_MIN				= 4,
+	RENDER_BLEND_OP_MAX				= 5,
+};
+
+enum renderColorWriteFlags_t
+{
+	RENDER_COLOR_WRITE_ENABLE_ALL	= 0xF,
+};
+
+enum renderFillMode_t
+{
+	RENDER_FILL_WIREFRAME	= 2,
+	RENDER_FILL_SOLID		= 3,
+};
+
+enum renderCullMode_t
+{
+	RENDER_CULL_NONE	= 1,
+	RENDER_CULL_FRONT	= 2,
+	RENDER_CULL_BACK	= 3,
+};
+
+enum renderFilter_t
+{
+	RENDER_FILTER_MIN_MAG_MIP_POINT					= 0x0,
+	RENDER_FILTER_MIN_MAG_POINT_MIP_LINEAR			= 0x1,
+	RENDER_FILTER_MIN_MAG_MIP_LINEAR				= 0x15,
+	RENDER_FILTER_ANISOTROPIC						= 0x55,
+	RENDER_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR		= 0x95,
+};
+
+enum renderTextureAddressMode_t
+{
+	RENDER_TEXTURE_ADDRESS_WRAP		= 1,
+	RENDER_TEXTURE_ADDRESS_MIRROR	= 2,
+	RENDER_TEXTURE_ADDRESS_CLAMP	= 3,
+	RENDER_TEXTURE_ADDRESS_BORDER	= 4,
+};
+
+enum renderInputClassification_t
+{
+	RENDER_INPUT_PER_VERTEX_DATA	= 0,
+	RENDER_INPUT_PER_INSTANCE_DATA	= 1,
+};
+
+enum renderQueryType_t
+{
+	RENDER_QUERY_EVENT					= 0,	// BOOL, true once the gpu is past the end
+	RENDER_QUERY_TIMESTAMP				= 2,	// uint64_t
+	RENDER_QUERY_TIMESTAMP_DISJOINT		= 3,	// renderQueryTimestampDisjoint_t
+};
+
+enum renderClearFlags_t
+{
+	RENDER_CLEAR_DEPTH		= 0x1,
+	RENDER_CLEAR_STENCIL	= 0x2,
+};
+
+// hlsl compilation (see RenderBackend::CompileShader)
+enum renderCompileFlags_t
+{
+	RENDER_COMPILE_DEBUG				= 0x1,
+	RENDER_COMPILE_SKIP_OPTIMIZATION	= 0x4,
+	RENDER_COMPILE_OPTIMIZATION_LEVEL3	= 0x8000,
+};
+
+enum renderTextureDimension_t
+{
+	RENDER_TEXTURE_DIMENSION_1D = 0,
+	RENDER_TEXTURE_DIMENSION_2D,
+	RENDER_TEXTURE_DIMENSION_3D,
+};
+
+enum renderViewDimension_t
+{
+	RENDER_VIEW_DIMENSION_BUFFER = 0,
+	RENDER_VIEW_DIMENSION_TEXTURE1D,
+	RENDER_VIEW_DIMENSION_TEXTURE2D,
+	RENDER_VIEW_DIMENSION_TEXTURE2DMS,
+	RENDER_VIEW_DIMENSION_TEXTURE3D,
+};
+
+constexpr uint32_t	RENDER_APPEND_ALIGNED_ELEMENT		= 0xFFFFFFFF;
+constexpr uint32_t	RENDER_SIMULTANEOUS_RENDER_TARGET_COUNT	= 8;
+constexpr float		RENDER_FLOAT32_MAX					= 3.402823466e+38f;
+
+struct renderBufferDesc_t
+{
+	uint32_t						size;				// bytes
+	renderUsage_t					usage;
+	uint32_t						bindFlags;			// renderBindFlags_t
+	uint32_t						cpuAccessFlags;		// renderCpuAccessFlags_t
+	uint32_t						miscFlags;			// renderMiscFlags_t
+	uint32_t						structureStride;
+};
+
+struct renderTextureDesc_t
+{
+	renderTextureDimension_t		dimension;
+	uint32_t						width;
+	uint32_t						height;				// 1 for 1D textures
+	uint32_t						depth;				// 3D textures; 1 otherwise
+	uint32_t						mipLevels;			// 0: full chain
+	uint32_t						arraySize;			// 1 for 3D textures
+	renderFormat_t					format;
+	uint32_t						sampleCount;
+	renderUsage_t					usage;
+	uint32_t						bindFlags;
+	uint32_t						cpuAccessFlags;
+	uint32_t						miscFlags;
+};
+
+// a null descriptor views the whole resource with its own format
+struct renderViewDesc_t
+{
+	renderFormat_t					format;
+	renderViewDimension_t			dimension;
+	uint32_t						mostDetailedMip;	// shader resource views
+	uint32_t						mipLevels;			// shader resource views; ~0: every level from mostDetailedMip
+	uint32_t						mipSlice;			// render target and depth stencil views
+	uint32_t						firstSlice;			// 3D render target views (w slices)
+	uint32_t						sliceCount;
+};
+
+struct renderSamplerDesc_t
+{
+	renderFilter_t					filter;
+	renderTextureAddressMode_t		addressU;
+	renderTextureAddressMode_t		addressV;
+	renderTextureAddressMode_t		addressW;
+	float							mipLODBias;
+	uint32_t						maxAnisotropy;
+	renderComparison_t				comparisonFunc;
+	float							borderColor[4];
+	float							minLOD;
+	float							maxLOD;
+};
+
+struct renderTargetBlendDesc_t
+{
+	uint32_t						blendEnable;
+	renderBlend_t					srcBlend;
+	renderBlend_t					destBlend;
+	renderBlendOp_t					blendOp;
+	renderBlend_t					srcBlendAlpha;
+	renderBlend_t					destBlendAlpha;
+	renderBlendOp_t					blendOpAlpha;
+	uint32_t						writeMask;			// renderColorWriteFlags_t
+};
+
+struct renderBlendDesc_t
+{
+	uint32_t						alphaToCoverageEnable;
+	uint32_t						independentBlendEnable;
+	renderTargetBlendDesc_t			renderTarget[RENDER_SIMULTANEOUS_RENDER_TARGET_COUNT];
+};
+
+struct renderStencilOpDesc_t
+{
+	renderStencilOp_t				stencilFailOp;
+	renderStencilOp_t				stencilDepthFailOp;
+	renderStencilOp_t				stencilPassOp;
+	renderComparison_t				stencilFunc;
+};
+
+struct renderDepthStencilDesc_t
+{
+	uint32_t						depthEnable;
+	renderDepthWriteMask_t			depthWriteMask;
+	renderComparison_t				depthFunc;
+	uint32_t						stencilEnable;
+	uint32_t						stencilReadMask;
+	uint32_t						stencilWriteMask;
+	renderStencilOpDesc_t			frontFace;
+	renderStencilOpDesc_t			backFace;
+};
+
+struct renderRasterizerDesc_t
+{
+	renderFillMode_t				fillMode;
+	renderCullMode_t				cullMode;
+	uint32_t						frontCounterClockwise;
+	int32_t							depthBias;
+	float							depthBiasClamp;
+	float							slopeScaledDepthBias;
+	uint32_t						depthClipEnable;
+	uint32_t						scissorEnable;
+	uint32_t						multisampleEnable;
+	uint32_t						antialiasedLineEnable;
+};
+
+// not hashed as is (semanticName is a pointer)
+struct renderInputElementDesc_t
+{
+	const char*						semanticName;
+	uint32_t						semanticIndex;
+	renderFormat_t					format;
+	uint32_t						inputSlot;
+	uint32_t						alignedByteOffset;	// RENDER_APPEND_ALIGNED_ELEMENT: right after the previous element
+	renderInputClassification_t		inputSlotClass;
+	uint32_t						instanceDataStepRate;
+};
+
+struct renderViewport_t
+{
+	float							topLeftX;
+	float							topLeftY;
+	float							width;
+	float							height;
+	float							minDepth;
+	float							maxDepth;
+};
+
+struct renderQueryTimestampDisjoint_t
+{
+	uint64_t						frequency;			// ticks per second
+	uint32_t						disjoint;			// the timestamps are unreliable
+};
+
+// shader macro; arrays end with a null name
+struct renderShaderMacro_t
+{
+	const char*						name;
+	const char*						definition;
+};
+
+// device objects; created with one reference, deleted on the last Release (as d3d does)
+// backends derive from the types below to hold their own object; handles are only valid on the backend that created
+// them (and the deferred backends it created)
+struct renderObject_t
+{
+							renderObject_t() : refCount( 1 ) {}
+							renderObject_t( renderObject_t& ) = delete;
+	virtual					~renderObject_t() = default;
+
+	inline void				AddRef()	{ refCount.fetch_add( 1, std::memory_order_relaxed ); }
+	inline void				Release()	{ if ( refCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) { delete this; } }
+
+private:
+	std::atomic<uint32_t>	refCount;
+};
+
+struct renderResource_t : renderObject_t {};
+
+struct renderBuffer_t : renderResource_t
+{
+	renderBufferDesc_t		desc;
+};
+
+struct renderTexture_t : renderResource_t
+{
+	renderTextureDesc_t		desc;
+};
+
+// views keep a reference on their resource
+struct renderView_t : renderObject_t
+{
+							~renderView_t()	{ if ( resource != nullptr ) { resource->Release(); } }
+
+	renderResource_t*		resource = nullptr;
+};
+
+struct renderShaderResourceView_t	: renderView_t {};
+struct renderTargetView_t			: renderView_t {};
+struct renderDepthStencilView_t		: renderView_t {};
+
+struct renderVertexShader_t			: renderObject_t {};
+struct renderPixelShader_t			: renderObject_t {};
+struct renderInputLayout_t			: renderObject_t {};
+struct renderSamplerState_t			: renderObject_t {};
+struct renderRasterizerState_t		: renderObject_t {};
+struct renderDepthStencilState_t	: renderObject_t {};
+struct renderBlendState_t			: renderObject_t {};
+
+struct renderQuery_t : renderObject_t
+{
+	renderQueryType_t		type;
+};
@@ -0,0 +1,449 @@
+#include "Shared.h"
+#include "ShaderLibrary.h"
+
+#include <Engine/System/JobSystem.h>
+#include <Engine/System/Log.h>
+#include <Engine/System/MurmurHash2_64.h>
+#include <Engine/System/Platform.h>
+
+#include <cstdio>
+
+namespace
+{
+	constexpr unsigned int HASH_SEED = 0xB;
+
+	constexpr const char* PERMUTATION_PROFILE = "ps_5_0";
+
+#ifdef _DEBUG
+	constexpr uint32_t PERMUTATION_COMPILE_FLAGS = RENDER_COMPILE_DEBUG | RENDER_COMPILE_SKIP_OPTIMIZATION;
+#else
+	constexpr uint32_t PERMUTATION_COMPILE_FLAGS = RENDER_COMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+	// configurations compiling with different options share the cache directory
+	uint32_t GetCompileOptionsHash()
+	{
+		char compileOptions[64];
+		const int optionsLength = snprintf( compileOptions, sizeof( compileOptions ), "%s_%08x", PERMUTATION_PROFILE, PERMUTATION_COMPILE_FLAGS );
+
+		return static_cast<uint32_t>( MurmurHash64A( compileOptions, optionsLength, HASH_SEED ) );
+	}
+
+	void LogErrors( const char* operation, const wchar_t* path, const std::string& errors )
+	{
+		// errors is the compiler output
+		Log_Printf( "ShaderLibrary: failed to %s '%ls'\n%s", operation, path, errors.c_str() );
+	}
+
+	const bool ReadFile( const wchar_t* path, std::vector<uint8_t>& data )
+	{
+		FILE* file = Sys_OpenFile( path, "rb" );
+
+		if ( file == nullptr ) {
+			return false;
+		}
+
+		fseek( file, 0, SEEK_END );
+		const long fileSize = ftell( file );
+		fseek( file, 0, SEEK_SET );
+
+		data.resize( ( fileSize > 0 ) ? static_cast<std::size_t>( fileSize ) : 0 );
+
+		const bool isRead = ( fileSize >= 0 ) && fread( data.data(), 1, data.size(), file ) == data.size();
+
+		fclose( file );
+
+		return isRead;
+	}
+
+	void WriteFile( const wchar_t* path, const std::vector<uint8_t>& data )
+	{
+		FILE* file = Sys_OpenFile( path, "wb" );
+
+		if ( file == nullptr ) {
+			return;
+		}
+
+		fwrite( data.data(), 1, data.size(), file );
+		fclose( file );
+	}
+
+	uint64_t HashPath( const wchar_t* path )
+	{
+		return MurmurHash64A( path, static_cast<int>( wcslen( path ) * sizeof( wchar_t ) ), HASH_SEED );
+	}
+
+	uint64_t HashPermutation( const wchar_t* sourceName, const shaderPermutation_t permutation )
+	{
+		return HashPath( sourceName ) ^ ( static_cast<uint64_t>( permutation ) * 0x9E3779B97F4A7C15ull );
+	}
+
+	// "opaque_ps.hlsl" -> "opaque_ps"
+	std::wstring GetStem( const wchar_t* sourceName )
+	{
+		std::wstring stem( sourceName );
+
+		const std::size_t extension = stem.find_last_of( L'.' );
+
+		if ( extension != std::wstring::npos ) {
+			stem.resize( extension );
+		}
+
+		return stem;
+	}
+
+	template<typename T>
+	void ReleaseAll( std::unordered_map<uint64_t, T*>& content )
+	{
+		for ( auto& entry : content ) {
+			if ( entry.second != nullptr ) {
+				entry.second->Release();
+			}
+		}
+
+		content.clear();
+	}
+
+	struct permutationLoad_t
+	{
+		const wchar_t*			sourceName;
+		shaderPermutation_t		permutation;
+	};
+}
+
+ShaderLibrary::ShaderLibrary()
+	: backend( nullptr )
+{
+
+}
+
+ShaderLibrary::~ShaderLibrary()
+{
+	Clear();
+}
+
+void ShaderLibrary::Initialize( RenderBackend* renderBackend, const wchar_t* shaderSourceDirectory, const wchar_t* shaderCacheDirectory )
+{
+	Clear();
+
+	backend			= renderBackend;
+	sourceDirectory	= shaderSourceDirectory;
+	cacheDirectory	= shaderCacheDirectory;
+
+	// fails if it already exists
+	Sys_CreateDirectory( cacheDirectory.c_str() );
+}
+
+void ShaderLibrary::Clear()
+{
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	ReleaseAll( vertexShaders );
+	ReleaseAll( pixelShaders );
+
+	bytecodes.clear();
+
+	sourceHashes.clear();
+}
+
+const std::vector<uint8_t>* ShaderLibrary::GetBytecode( const wchar_t* shaderPath )
+{
+	const uint64_t shaderHashcode = HashPath( shaderPath );
+
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
+
+		auto it = bytecodes.find( shaderHashcode );
+
+		if ( it != bytecodes.end() ) {
+			return &it->second;
+		}
+	}
+
+	std::vector<uint8_t> bytecode;
+
+	if ( !backend->LoadShaderBytecode( shaderPath, bytecode ) ) {
+		LogErrors( "read", shaderPath, "" );
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	// another thread might have read it in the meantime; map values don't move
+	return &bytecodes.emplace( shaderHashcode, std::move( bytecode ) ).first->second;
+}
+
+renderVertexShader_t* ShaderLibrary::GetVertexShader( const wchar_t* shaderPath )
+{
+	const uint64_t shaderHashcode = HashPath( shaderPath );
+
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
+
+		auto it = vertexShaders.find( shaderHashcode );
+
+		if ( it != vertexShaders.end() ) {
+			return it->second;
+		}
+	}
+
+	const std::vector<uint8_t>* bytecode = GetBytecode( shaderPath );
+
+	if ( bytecode == nullptr ) {
+		return nullptr;
+	}
+
+	renderVertexShader_t* shader = backend->CreateVertexShader( bytecode->data(), bytecode->size() );
+
+	if ( shader == nullptr ) {
+		LogErrors( "create", shaderPath, "" );
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	auto it = vertexShaders.emplace( shaderHashcode, shader );
+
+	if ( !it.second ) {
+		shader->Release();
+	}
+
+	return it.first->second;
+}
+
+renderPixelShader_t* ShaderLibrary::GetPixelShader( const wchar_t* shaderPath )
+{
+	const uint64_t shaderHashcode = HashPath( shaderPath );
+
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
+
+		auto it = pixelShaders.find( shaderHashcode );
+
+		if ( it != pixelShaders.end() ) {
+			return it->second;
+		}
+	}
+
+	// pixel shaders have no input layout to validate; the bytecode is not kept
+	std::vector<uint8_t> bytecode;
+
+	if ( !backend->LoadShaderBytecode( shaderPath, bytecode ) ) {
+		LogErrors( "read", shaderPath, "" );
+		return nullptr;
+	}
+
+	renderPixelShader_t* shader = backend->CreatePixelShader( bytecode.data(), bytecode.size() );
+
+	if ( shader == nullptr ) {
+		LogErrors( "create", shaderPath, "" );
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	auto it = pixelShaders.emplace( shaderHashcode, shader );
+
+	if ( !it.second ) {
+		shader->Release();
+	}
+
+	return it.first->second;
+}
+
+renderPixelShader_t* ShaderLibrary::GetPixelShaderPermutation( const wchar_t* sourceName, const shaderPermutation_t permutation )
+{
+	const uint64_t shaderHashcode = HashPermutation( sourceName, permutation );
+
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
+
+		auto it = pixelShaders.find( shaderHashcode );
+
+		if ( it != pixelShaders.end() ) {
+			return it->second;
+		}
+	}
+
+	renderPixelShader_t* shader = nullptr;
+	const uint64_t sourceHash = GetSourceHash( sourceName );
+
+	if ( sourceHash != 0 ) {
+		const std::wstring cachedPath = GetPermutationPath( sourceName, sourceHash, permutation );
+
+		std::vector<uint8_t> bytecode;
+		bool isLoaded = ReadFile( cachedPath.c_str(), bytecode );
+
+		if ( !isLoaded ) {
+			isLoaded = CompilePermutation( sourceName, permutation, bytecode );
+
+			if ( isLoaded ) {
+				WriteFile( cachedPath.c_str(), bytecode );
+			}
+		}
+
+		if ( isLoaded ) {
+			shader = backend->CreatePixelShader( bytecode.data(), bytecode.size() );
+
+			if ( shader == nullptr ) {
+				LogErrors( "create", cachedPath.c_str(), "" );
+			}
+		}
+	}
+
+	// failures are kept too, so that a missing source is not looked up for every material
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	auto it = pixelShaders.emplace( shaderHashcode, shader );
+
+	if ( !it.second && shader != nullptr ) {
+		shader->Release();
+	}
+
+	return it.first->second;
+}
+
+void ShaderLibrary::Preload( const shaderPreload_t* shaders, const std::size_t shaderCount, const wchar_t* const* sourceNames, const std::size_t sourceCount )
+{
+	std::vector<permutationLoad_t> permutationLoads;
+
+	for ( std::size_t i = 0; i < sourceCount; ++i ) {
+		std::vector<shaderPermutation_t> permutations;
+		PreloadPermutations( sourceNames[i], permutations );
+
+		for ( const shaderPermutation_t permutation : permutations ) {
+			permutationLoads.push_back( { sourceNames[i], permutation } );
+		}
+	}
+
+	const uint32_t loadCount = static_cast<uint32_t>( shaderCount + permutationLoads.size() );
+
+	// one shader per job; most of the time is spent reading files and in the driver compiler
+	Job_ParallelFor( 0, loadCount, 1, [&]( const uint32_t begin, const uint32_t end ) {
+		for ( uint32_t i = begin; i < end; ++i ) {
+			if ( i < shaderCount ) {
+				const shaderPreload_t& shader = shaders[i];
+
+				if ( shader.stage == RENDER_STAGE_VERTEX ) {
+					GetVertexShader( shader.path );
+				} else {
+					GetPixelShader( shader.path );
+				}
+			} else {
+				const permutationLoad_t& load = permutationLoads[i - shaderCount];
+				GetPixelShaderPermutation( load.sourceName, load.permutation );
+			}
+		}
+	} );
+}
+
+uint64_t ShaderLibrary::GetSourceHash( const wchar_t* sourceName )
+{
+	const uint64_t sourceHashcode = HashPath( sourceName );
+
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
+
+		auto it = sourceHashes.find( sourceHashcode );
+
+		if ( it != sourceHashes.end() ) {
+			return it->second;
+		}
+	}
+
+	const std::wstring sourcePath = sourceDirectory + sourceName;
+
+	uint64_t sourceHash = 0;
+	std::vector<uint8_t> source;
+
+	if ( ReadFile( sourcePath.c_str(), source ) ) {
+		// preprocessed, so that editing an include invalidates the permutations too
+		std::vector<uint8_t> preprocessed;
+		std::string errors;
+
+		if ( backend->PreprocessShader( sourcePath.c_str(), source, preprocessed, errors ) ) {
+			sourceHash = MurmurHash64A( preprocessed.data(), static_cast<int>( preprocessed.size() ), HASH_SEED );
+			sourceHash = ( sourceHash != 0 ) ? sourceHash : 1;
+		} else {
+			LogErrors( "preprocess", sourcePath.c_str(), errors );
+		}
+	}
+
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	return sourceHashes.emplace( sourceHashcode, sourceHash ).first->second;
+}
+
+std::wstring ShaderLibrary::GetPermutationPath( const wchar_t* sourceName, const uint64_t sourceHash, const shaderPermutation_t permutation ) const
+{
+	// <stem>_<source hash>_<compile options hash>_<permutation>.cso
+	wchar_t suffix[64];
+	swprintf( suffix, 64, L"_%016llx_%08x_%08x.cso", static_cast<unsigned long long>( sourceHash ), GetCompileOptionsHash(), permutation );
+
+	return cacheDirectory + GetStem( sourceName ) + suffix;
+}
+
+const bool ShaderLibrary::CompilePermutation( const wchar_t* sourceName, const shaderPermutation_t permutation, std::vector<uint8_t>& bytecode ) const
+{
+	const std::wstring sourcePath = sourceDirectory + sourceName;
+
+	char permutationFlags[16];
+	snprintf( permutationFlags, 16, "0x%xu", permutation );
+
+	const renderShaderMacro_t defines[2] = {
+		{ "PERMUTATION_FLAGS", permutationFlags },
+		{ nullptr, nullptr },
+	};
+
+	std::string errors;
+
+	if ( !backend->CompileShader( sourcePath.c_str(), defines, "main", PERMUTATION_PROFILE, PERMUTATION_COMPILE_FLAGS, bytecode, errors ) ) {
+		char operation[64];
+		snprintf( operation, sizeof( operation ), "compile permutation %08x of", permutation );
+
+		LogErrors( operation, sourcePath.c_str(), errors );
+		return false;
+	}
+
+	return true;
+}
+
+void ShaderLibrary::PreloadPermutations( const wchar_t* sourceName, std::vector<shaderPermutation_t>& permutations )
+{
+	const uint64_t sourceHash = GetSourceHash( sourceName );
+
+	if ( sourceHash == 0 ) {
+		return;
+	}
+
+	const std::wstring stem = GetStem( sourceName );
+
+	const uint32_t compileOptionsHash = GetCompileOptionsHash();
+
+	std::vector<std::wstring> fileNames;
+	Sys_ListDirectory( cacheDirectory, stem + L"_", fileNames );
+
+	for ( const std::wstring& fileName : fileNames ) {
+		unsigned long long fileSourceHash = 0;
+		uint32_t fileCompileOptionsHash = 0;
+		shaderPermutation_t filePermutation = 0;
+
+		const wchar_t* suffix = fileName.c_str() + stem.size();
+
+		if ( fileName.size() < 4 || fileName.compare( fileName.size() - 4, 4, L".cso" ) != 0 ) {
+			continue;
+		}
+
+		// files of other configurations (e.g. debug) are left alone; they get deleted by their own runs
+		if ( swscanf( suffix, L"_%16llx_%8x_%8x.cso", &fileSourceHash, &fileCompileOptionsHash, &filePermutation ) != 3 || fileCompileOptionsHash != compileOptionsHash ) {
+			continue;
+		}
+
+		if ( fileSourceHash == sourceHash ) {
+			permutations.push_back( filePermutation );
+		} else {
+			// compiled from an older source; it will never be loaded again
+			Sys_DeleteFile( ( cacheDirectory + fileName ).c_str() );
+		}
+	}
+}
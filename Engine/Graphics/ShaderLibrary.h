@@ -0,0 +1,62 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// compile time features of a shader source; for surfaces, the material flags (see Render_GetShaderPermutation)
+using shaderPermutation_t = uint32_t;
+
+struct shaderPreload_t
+{
+	renderStage_t		stage;
+	const wchar_t*		path;
+};
+
+// every shader of the renderer; bytecode is read (or compiled) once, shaders are created once and owned by the library
+// precompiled shaders (.cso) are keyed by path
+// permutations are compiled from the hlsl source (sourceDirectory) with PERMUTATION_FLAGS defined, then written to
+// cacheDirectory under a hash of the preprocessed source (includes too) and of the compile options (profile and flags, so
+// that configurations don't overwrite each other); later runs load them instead of compiling; failures are logged
+// thread safe; file reads and compilation happen outside of the lock
+class ShaderLibrary
+{
+public:
+								ShaderLibrary();
+								ShaderLibrary( ShaderLibrary& ) = delete;
+								~ShaderLibrary();
+
+	void						Initialize( RenderBackend* backend, const wchar_t* sourceDirectory, const wchar_t* cacheDirectory );
+	void						Clear();
+
+	const std::vector<uint8_t>*	GetBytecode( const wchar_t* shaderPath ); // input layouts are validated against it
+	renderVertexShader_t*		GetVertexShader( const wchar_t* shaderPath );
+	renderPixelShader_t*		GetPixelShader( const wchar_t* shaderPath );
+
+	// null if the source can't be compiled (e.g. not deployed); callers fall back to their precompiled shader
+	renderPixelShader_t*		GetPixelShaderPermutation( const wchar_t* sourceName, const shaderPermutation_t permutation );
+
+	// creates the given shaders and every up to date cached permutation of the sources on the job system
+	// stale permutations (older source) are deleted from the cache
+	void						Preload( const shaderPreload_t* shaders, const std::size_t shaderCount, const wchar_t* const* sourceNames, const std::size_t sourceCount );
+
+private:
+	RenderBackend*											backend;
+	std::wstring											sourceDirectory;
+	std::wstring											cacheDirectory;
+	std::mutex												contentLock;
+
+	std::unordered_map<uint64_t, std::vector<uint8_t>>		bytecodes;
+	std::unordered_map<uint64_t, renderVertexShader_t*>		vertexShaders;
+	std::unordered_map<uint64_t, renderPixelShader_t*>		pixelShaders;	// precompiled and permutations
+	std::unordered_map<uint64_t, uint64_t>					sourceHashes;	// preprocessed source by source name; 0 if missing
+
+private:
+	uint64_t					GetSourceHash( const wchar_t* sourceName );
+	std::wstring				GetPermutationPath( const wchar_t* sourceName, const uint64_t sourceHash, const shaderPermutation_t permutation ) const;
+	const bool					CompilePermutation( const wchar_t* sourceName, const shaderPermutation_t permutation, std::vector<uint8_t>& bytecode ) const;
+	void						PreloadPermutations( const wchar_t* sourceName, std::vector<shaderPermutation_t>& permutations );
+};
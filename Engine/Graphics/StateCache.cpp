@@ -0,0 +1,374 @@
+#include "Shared.h"
+#include "StateCache.h"
+
+namespace
+{
+	template<typename T, uint32_t N>
+	void ForgetSlots( T* ( &bound )[N], uint32_t& knownMask, uint32_t& pendingMask )
+	{
+		for ( T*& value : bound ) {
+			value = nullptr;
+		}
+
+		knownMask	= 0;
+		pendingMask	= 0;
+	}
+}
+
+StateCache::StateCache()
+	: backend( nullptr )
+	, counters{}
+	, knownStates( 0 )
+	, topology( RENDER_PRIMITIVE_TOPOLOGY_UNDEFINED )
+	, inputLayout( nullptr )
+	, vertexBuffer( nullptr )
+	, vertexStride( 0 )
+	, vertexOffset( 0 )
+	, attributeBuffer( nullptr )
+	, attributeStride( 0 )
+	, attributeOffset( 0 )
+	, instanceBuffer( nullptr )
+	, instanceStride( 0 )
+	, instanceOffset( 0 )
+	, indexBuffer( nullptr )
+	, indexFormat( RENDER_FORMAT_UNKNOWN )
+	, indexOffset( 0 )
+	, vertexShader( nullptr )
+	, pixelShader( nullptr )
+	, rasterizerState( nullptr )
+	, depthStencilState( nullptr )
+	, stencilRef( 0 )
+	, blendState( nullptr )
+	, vsConstantBuffers{}
+	, psConstantBuffers{}
+	, vsShaderResources{}
+	, psShaderResources{}
+	, psSamplers{}
+{
+
+}
+
+void StateCache::Initialize( RenderBackend* renderBackend )
+{
+	backend = renderBackend;
+
+	Invalidate();
+	ResetCounters();
+}
+
+void StateCache::Invalidate()
+{
+	// pending slots are dropped too; whoever bypassed the cache has overwritten them anyway
+	knownStates = 0;
+
+	ForgetSlots( vsConstantBuffers.bound, vsConstantBuffers.knownMask, vsConstantBuffers.pendingMask );
+	ForgetSlots( psConstantBuffers.bound, psConstantBuffers.knownMask, psConstantBuffers.pendingMask );
+	ForgetSlots( vsShaderResources.bound, vsShaderResources.knownMask, vsShaderResources.pendingMask );
+	ForgetSlots( psShaderResources.bound, psShaderResources.knownMask, psShaderResources.pendingMask );
+	ForgetSlots( psSamplers.bound, psSamplers.knownMask, psSamplers.pendingMask );
+}
+
+void StateCache::Flush()
+{
+	FlushSlots( vsConstantBuffers, [this]( const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers ) {
+		backend->SetConstantBuffers( RENDER_STAGE_VERTEX, first, count, buffers );
+	} );
+
+	FlushSlots( psConstantBuffers, [this]( const uint32_t first, const uint32_t count, renderBuffer_t* const* buffers ) {
+		backend->SetConstantBuffers( RENDER_STAGE_PIXEL, first, count, buffers );
+	} );
+
+	FlushSlots( vsShaderResources, [this]( const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views ) {
+		backend->SetShaderResources( RENDER_STAGE_VERTEX, first, count, views );
+	} );
+
+	FlushSlots( psShaderResources, [this]( const uint32_t first, const uint32_t count, renderShaderResourceView_t* const* views ) {
+		backend->SetShaderResources( RENDER_STAGE_PIXEL, first, count, views );
+	} );
+
+	FlushSlots( psSamplers, [this]( const uint32_t first, const uint32_t count, renderSamplerState_t* const* samplers ) {
+		backend->SetSamplers( RENDER_STAGE_PIXEL, first, count, samplers );
+	} );
+}
+
+void StateCache::SetPrimitiveTopology( const renderPrimitiveTopology_t primitiveTopology )
+{
+	if ( IsRedundant( STATE_TOPOLOGY, topology == primitiveTopology ) ) {
+		return;
+	}
+
+	topology = primitiveTopology;
+	backend->SetPrimitiveTopology( topology );
+}
+
+void StateCache::SetInputLayout( renderInputLayout_t* layout )
+{
+	if ( IsRedundant( STATE_INPUT_LAYOUT, inputLayout == layout ) ) {
+		return;
+	}
+
+	inputLayout = layout;
+	backend->SetInputLayout( inputLayout );
+}
+
+void StateCache::SetVertexBuffer( renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset )
+{
+	if ( IsRedundant( STATE_VERTEX_BUFFER, vertexBuffer == buffer && vertexStride == stride && vertexOffset == offset ) ) {
+		return;
+	}
+
+	vertexBuffer = buffer;
+	vertexStride = stride;
+	vertexOffset = offset;
+
+	backend->SetVertexBuffer( 0, vertexBuffer, vertexStride, vertexOffset );
+}
+
+void StateCache::SetAttributeBuffer( renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset )
+{
+	if ( IsRedundant( STATE_ATTRIBUTE_BUFFER, attributeBuffer == buffer && attributeStride == stride && attributeOffset == offset ) ) {
+		return;
+	}
+
+	attributeBuffer = buffer;
+	attributeStride = stride;
+	attributeOffset = offset;
+
+	backend->SetVertexBuffer( 1, attributeBuffer, attributeStride, attributeOffset );
+}
+
+void StateCache::SetInstanceBuffer( renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset )
+{
+	if ( IsRedundant( STATE_INSTANCE_BUFFER, instanceBuffer == buffer && instanceStride == stride && instanceOffset == offset ) ) {
+		return;
+	}
+
+	instanceBuffer = buffer;
+	instanceStride = stride;
+	instanceOffset = offset;
+
+	backend->SetVertexBuffer( 2, instanceBuffer, instanceStride, instanceOffset );
+}
+
+void StateCache::SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset )
+{
+	if ( IsRedundant( STATE_INDEX_BUFFER, indexBuffer == buffer && indexFormat == format && indexOffset == offset ) ) {
+		return;
+	}
+
+	indexBuffer = buffer;
+	indexFormat = format;
+	indexOffset = offset;
+
+	backend->SetIndexBuffer( indexBuffer, indexFormat, indexOffset );
+}
+
+void StateCache::SetVertexShader( renderVertexShader_t* shader )
+{
+	if ( IsRedundant( STATE_VERTEX_SHADER, vertexShader == shader ) ) {
+		return;
+	}
+
+	vertexShader = shader;
+	backend->SetVertexShader( vertexShader );
+}
+
+void StateCache::SetPixelShader( renderPixelShader_t* shader )
+{
+	if ( IsRedundant( STATE_PIXEL_SHADER, pixelShader == shader ) ) {
+		return;
+	}
+
+	pixelShader = shader;
+	backend->SetPixelShader( pixelShader );
+}
+
+void StateCache::SetVSConstantBuffer( const uint32_t slot, renderBuffer_t* buffer )
+{
+	SetSlot( vsConstantBuffers, slot, buffer );
+}
+
+void StateCache::SetPSConstantBuffer( const uint32_t slot, renderBuffer_t* buffer )
+{
+	SetSlot( psConstantBuffers, slot, buffer );
+}
+
+void StateCache::SetVSShaderResource( const uint32_t slot, renderShaderResourceView_t* view )
+{
+	SetSlot( vsShaderResources, slot, view );
+}
+
+void StateCache::SetPSShaderResource( const uint32_t slot, renderShaderResourceView_t* view )
+{
+	SetSlot( psShaderResources, slot, view );
+}
+
+void StateCache::SetPSSampler( const uint32_t slot, renderSamplerState_t* sampler )
+{
+	SetSlot( psSamplers, slot, sampler );
+}
+
+void StateCache::SetVSConstantBufferRange( const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount )
+{
+	if ( ForgetSlot( vsConstantBuffers, slot ) ) {
+		backend->SetConstantBufferRange( RENDER_STAGE_VERTEX, slot, buffer, firstConstant, constantCount );
+	}
+}
+
+void StateCache::SetPSConstantBufferRange( const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount )
+{
+	if ( ForgetSlot( psConstantBuffers, slot ) ) {
+		backend->SetConstantBufferRange( RENDER_STAGE_PIXEL, slot, buffer, firstConstant, constantCount );
+	}
+}
+
+void StateCache::SetRasterizerState( renderRasterizerState_t* state )
+{
+	if ( IsRedundant( STATE_RASTERIZER, rasterizerState == state ) ) {
+		return;
+	}
+
+	rasterizerState = state;
+	backend->SetRasterizerState( rasterizerState );
+}
+
+void StateCache::SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t reference )
+{
+	if ( IsRedundant( STATE_DEPTH_STENCIL, depthStencilState == state && stencilRef == reference ) ) {
+		return;
+	}
+
+	depthStencilState	= state;
+	stencilRef			= reference;
+
+	backend->SetDepthStencilState( depthStencilState, stencilRef );
+}
+
+void StateCache::SetBlendState( renderBlendState_t* state )
+{
+	if ( IsRedundant( STATE_BLEND, blendState == state ) ) {
+		return;
+	}
+
+	blendState = state;
+	backend->SetBlendState( blendState );
+}
+
+void StateCache::DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex )
+{
+	Flush();
+	backend->DrawIndexed( indexCount, startIndex, baseVertex );
+}
+
+void StateCache::DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance )
+{
+	Flush();
+	backend->DrawIndexedInstanced( indexCount, instanceCount, startIndex, baseVertex, startInstance );
+}
+
+void StateCache::Draw( const uint32_t vertexCount, const uint32_t startVertex )
+{
+	Flush();
+	backend->Draw( vertexCount, startVertex );
+}
+
+const bool StateCache::IsRedundant( const uint32_t state, const bool isSameValue )
+{
+	counters.submittedCalls++;
+
+	if ( ( knownStates & state ) && isSameValue ) {
+		counters.filteredCalls++;
+		return true;
+	}
+
+	knownStates |= state;
+	counters.issuedCalls++;
+
+	return false;
+}
+
+template<typename T, uint32_t N>
+void StateCache::SetSlot( slotCache_t<T, N>& cache, const uint32_t slot, T* value )
+{
+	if ( slot >= N ) {
+		return;
+	}
+
+	counters.submittedCalls++;
+
+	const uint32_t slotBit = 1u << slot;
+
+	// compare against what will be bound at the next draw
+	T* effectiveValue = ( cache.pendingMask & slotBit ) ? cache.pending[slot] : cache.bound[slot];
+	const bool isKnown = ( ( cache.knownMask | cache.pendingMask ) & slotBit ) != 0;
+
+	if ( isKnown && effectiveValue == value ) {
+		counters.filteredCalls++;
+		return;
+	}
+
+	if ( ( cache.knownMask & slotBit ) && cache.bound[slot] == value ) {
+		// back to the bound value; nothing to do anymore
+		cache.pendingMask &= ~slotBit;
+		counters.filteredCalls++;
+		return;
+	}
+
+	cache.pending[slot] = value;
+	cache.pendingMask |= slotBit;
+}
+
+template<typename T, uint32_t N>
+const bool StateCache::ForgetSlot( slotCache_t<T, N>& cache, const uint32_t slot )
+{
+	if ( slot >= N || !backend->SupportsConstantBufferRanges() ) {
+		return false;
+	}
+
+	counters.submittedCalls++;
+	counters.issuedCalls++;
+
+	// the slot content is out of the cache hands; the next plain binding always goes through
+	const uint32_t slotBit = 1u << slot;
+
+	cache.bound[slot]	= nullptr;
+	cache.knownMask		&= ~slotBit;
+	cache.pendingMask	&= ~slotBit;
+
+	return true;
+}
+
+template<typename T, uint32_t N, typename BindFunc>
+void StateCache::FlushSlots( slotCache_t<T, N>& cache, BindFunc bind )
+{
+	uint32_t pendingMask = cache.pendingMask;
+
+	// one call per run of contiguous dirty slots
+	while ( pendingMask != 0 ) {
+		uint32_t first = 0;
+		while ( ( pendingMask & ( 1u << first ) ) == 0 ) {
+			first++;
+		}
+
+		uint32_t last = first;
+		while ( last + 1 < N && ( pendingMask & ( 1u << ( last + 1 ) ) ) ) {
+			last++;
+		}
+
+		const uint32_t count = last - first + 1;
+
+		for ( uint32_t slot = first; slot <= last; ++slot ) {
+			cache.bound[slot] = cache.pending[slot];
+		}
+
+		bind( first, count, &cache.bound[first] );
+		counters.issuedCalls++;
+
+		const uint32_t runMask = ( count == 32 ) ? ~0u : ( ( ( 1u << count ) - 1 ) << first );
+
+		pendingMask &= ~runMask;
+		cache.knownMask |= runMask;
+	}
+
+	cache.pendingMask = 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "RenderBackend.h"
+
+struct stateCacheCounters_t
+{
+	uint64_t	submittedCalls;	// state changes requested by the renderer
+	uint64_t	filteredCalls;	// dropped because the state was already bound
+	uint64_t	issuedCalls;	// calls actually made on the backend (after slot coalescing)
+};
+
+// redundant state filter in front of the render backend
+// shaders, IA and OM states are issued right away if they changed; slot bindings (cbuffers, SRVs, samplers) are
+// deferred until the next draw so that contiguous slots are bound with a single call
+// anything touching the device context (or the backend) directly must call Invalidate() before the cache is used again
+class StateCache
+{
+public:
+	static constexpr uint32_t	CBUFFER_SLOT_COUNT	= 14;
+	static constexpr uint32_t	SRV_SLOT_COUNT		= 16;
+	static constexpr uint32_t	SAMPLER_SLOT_COUNT	= 16;
+
+public:
+	inline const stateCacheCounters_t&	GetCounters() const		{ return counters; }
+	inline void							ResetCounters()			{ counters = {}; }
+
+public:
+								StateCache();
+								StateCache( StateCache& ) = delete;
+								~StateCache() = default;
+
+	void						Initialize( RenderBackend* renderBackend ); // not owned
+	void						Invalidate();
+	void						Flush(); // binds pending slots; done by draw calls
+
+	void						SetPrimitiveTopology( const renderPrimitiveTopology_t topology );
+	void						SetInputLayout( renderInputLayout_t* inputLayout );
+	void						SetVertexBuffer( renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset ); // slot 0 (positions)
+	void						SetAttributeBuffer( renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset ); // slot 1
+	void						SetInstanceBuffer( renderBuffer_t* buffer, const uint32_t stride, const uint32_t offset ); // slot 2
+	void						SetIndexBuffer( renderBuffer_t* buffer, const renderFormat_t format, const uint32_t offset );
+
+	void						SetVertexShader( renderVertexShader_t* shader );
+	void						SetPixelShader( renderPixelShader_t* shader );
+
+	void						SetVSConstantBuffer( const uint32_t slot, renderBuffer_t* buffer );
+	void						SetPSConstantBuffer( const uint32_t slot, renderBuffer_t* buffer );
+	void						SetVSShaderResource( const uint32_t slot, renderShaderResourceView_t* view );
+	void						SetPSShaderResource( const uint32_t slot, renderShaderResourceView_t* view );
+	void						SetPSSampler( const uint32_t slot, renderSamplerState_t* sampler );
+
+	// part of a buffer (in 16 bytes constants); bound right away and never filtered; requires backend support
+	void						SetVSConstantBufferRange( const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount );
+	void						SetPSConstantBufferRange( const uint32_t slot, renderBuffer_t* buffer, const uint32_t firstConstant, const uint32_t constantCount );
+
+	void						SetRasterizerState( renderRasterizerState_t* state );
+	void						SetDepthStencilState( renderDepthStencilState_t* state, const uint32_t stencilRef );
+	void						SetBlendState( renderBlendState_t* state ); // null blend factor, full sample mask
+
+	void						DrawIndexed( const uint32_t indexCount, const uint32_t startIndex, const int32_t baseVertex );
+	void						DrawIndexedInstanced( const uint32_t indexCount, const uint32_t instanceCount, const uint32_t startIndex, const int32_t baseVertex, const uint32_t startInstance );
+	void						Draw( const uint32_t vertexCount, const uint32_t startVertex );
+
+private:
+	template<typename T, uint32_t N>
+	struct slotCache_t
+	{
+		T*			bound[N];
+		T*			pending[N];
+		uint32_t	knownMask;		// slots whose bound value is known
+		uint32_t	pendingMask;	// slots to bind on the next flush
+	};
+
+	enum scalarState_t
+	{
+		STATE_TOPOLOGY			= 1 << 0,
+		STATE_INPUT_LAYOUT		= 1 << 1,
+		STATE_VERTEX_BUFFER		= 1 << 2,
+		STATE_INDEX_BUFFER		= 1 << 3,
+		STATE_VERTEX_SHADER		= 1 << 4,
+		STATE_PIXEL_SHADER		= 1 << 5,
+		STATE_RASTERIZER		= 1 << 6,
+		STATE_DEPTH_STENCIL		= 1 << 7,
+		STATE_BLEND				= 1 << 8,
+		STATE_INSTANCE_BUFFER	= 1 << 9,
+		STATE_ATTRIBUTE_BUFFER	= 1 << 10,
+	};
+
+private:
+	RenderBackend*					backend;
+	stateCacheCounters_t			counters;
+	uint32_t						knownStates;	// scalarState_t bits
+
+	renderPrimitiveTopology_t		topology;
+	renderInputLayout_t*			inputLayout;
+	renderBuffer_t*					vertexBuffer;
+	uint32_t						vertexStride;
+	uint32_t						vertexOffset;
+	renderBuffer_t*					attributeBuffer;
+	uint32_t						attributeStride;
+	uint32_t						attributeOffset;
+	renderBuffer_t*					instanceBuffer;
+	uint32_t						instanceStride;
+	uint32_t						instanceOffset;
+	renderBuffer_t*					indexBuffer;
+	renderFormat_t					indexFormat;
+	uint32_t						indexOffset;
+	renderVertexShader_t*			vertexShader;
+	renderPixelShader_t*			pixelShader;
+	renderRasterizerState_t*		rasterizerState;
+	renderDepthStencilState_t*		depthStencilState;
+	uint32_t						stencilRef;
+	renderBlendState_t*				blendState;
+
+	slotCache_t<renderBuffer_t, CBUFFER_SLOT_COUNT>				vsConstantBuffers;
+	slotCache_t<renderBuffer_t, CBUFFER_SLOT_COUNT>				psConstantBuffers;
+	slotCache_t<renderShaderResourceView_t, SRV_SLOT_COUNT>		vsShaderResources;
+	slotCache_t<renderShaderResourceView_t, SRV_SLOT_COUNT>		psShaderResources;
+	slotCache_t<renderSamplerState_t, SAMPLER_SLOT_COUNT>		psSamplers;
+
+private:
+	const bool					IsRedundant( const uint32_t state, const bool isSameValue );
+
+	template<typename T, uint32_t N>
+	void						SetSlot( slotCache_t<T, N>& cache, const uint32_t slot, T* value );
+
+	template<typename T, uint32_t N>
+	const bool					ForgetSlot( slotCache_t<T, N>& cache, const uint32_t slot );
+
+	template<typename T, uint32_t N, typename BindFunc>
+	void						FlushSlots( slotCache_t<T, N>& cache, BindFunc bind );
+};
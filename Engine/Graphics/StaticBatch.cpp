@@ -0,0 +1,244 @@
+#include "Shared.h"
+#include "StaticBatch.h"
+
+#include "RenderContext.h"
+#include "RenderBackend.h"
+#include "Mesh.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	struct meshGeometry_t
+	{
+		std::vector<DirectX::XMFLOAT3>	positions;
+		std::vector<vertexAttributes_t>	attributes;
+		std::vector<unsigned int>		indices;
+	};
+
+	// a submesh waiting to be appended to its material range
+	struct mergedPiece_t
+	{
+		std::size_t				materialIndex;
+		const submesh_t*		subMesh;
+		unsigned int			baseVertex;		// first vertex of the source mesh in the merged buffers
+		const meshGeometry_t*	geometry;
+		bool					isMirrored;		// negative scale
+	};
+
+	const bool ReadBuffer( const renderContext_t* context, renderBuffer_t* buffer, const uint32_t offset, void* content, const uint32_t size )
+	{
+		renderBufferDesc_t stagingDesc = buffer->desc;
+
+		if ( stagingDesc.size < offset + size ) {
+			return false;
+		}
+
+		stagingDesc.size			= size;
+		stagingDesc.usage			= RENDER_USAGE_STAGING;
+		stagingDesc.bindFlags		= 0;
+		stagingDesc.cpuAccessFlags	= RENDER_CPU_ACCESS_READ;
+		stagingDesc.miscFlags		= 0;
+
+		renderBuffer_t* stagingBuffer = context->backend->CreateBuffer( stagingDesc, nullptr );
+		if ( stagingBuffer == nullptr ) {
+			return false;
+		}
+
+		// only the range of the mesh (the buffers might be the shared ones)
+		context->backend->CopyBufferRegion( stagingBuffer, 0, buffer, offset, size );
+
+		const void* mappedData = context->backend->MapBuffer( stagingBuffer, RENDER_MAP_READ );
+		const bool isMapped = ( mappedData != nullptr );
+
+		if ( isMapped ) {
+			memcpy( content, mappedData, size );
+			context->backend->UnmapBuffer( stagingBuffer );
+		}
+
+		stagingBuffer->Release();
+
+		return isMapped;
+	}
+
+	const bool ReadGeometry( const renderContext_t* context, const mesh_t* mesh, meshGeometry_t& geometry )
+	{
+		const uint32_t	vertexCount = static_cast<uint32_t>( mesh->vertexCount ),
+						indiceCount = static_cast<uint32_t>( mesh->indiceCount );
+
+		// the offsets are patched by the compactions of the render thread; read under the range lock
+		const geometryRange_t range = ( mesh->geometryRange != nullptr ) ? context->geometry->GetRange( mesh->geometryRange ) : geometryRange_t{};
+
+		const uint32_t	firstVertex	= range.firstVertex,
+						firstIndex	= range.firstIndex;
+
+		geometry.positions.resize( vertexCount );
+		geometry.attributes.resize( vertexCount );
+		geometry.indices.resize( indiceCount );
+
+		return ReadBuffer( context, mesh->positionBuffer, firstVertex * sizeof( DirectX::XMFLOAT3 ), geometry.positions.data(), vertexCount * sizeof( DirectX::XMFLOAT3 ) )
+			&& ReadBuffer( context, mesh->attributeBuffer, firstVertex * sizeof( vertexAttributes_t ), geometry.attributes.data(), vertexCount * sizeof( vertexAttributes_t ) )
+			&& ReadBuffer( context, mesh->indiceBuffer, firstIndex * sizeof( unsigned int ), geometry.indices.data(), indiceCount * sizeof( unsigned int ) );
+	}
+
+	void StoreDirection( DirectX::XMFLOAT3& direction, const DirectX::FXMMATRIX matrix )
+	{
+		const DirectX::XMVECTOR transformed = DirectX::XMVector3TransformNormal( DirectX::XMLoadFloat3( &direction ), matrix );
+		DirectX::XMStoreFloat3( &direction, DirectX::XMVector3Normalize( transformed ) );
+	}
+}
+
+const bool Render_IsMergeableMesh( const mesh_t* mesh )
+{
+	if ( mesh == nullptr || mesh->positionBuffer == nullptr || mesh->subMeshes.empty() || !mesh->pieces.empty() ) {
+		return false;
+	}
+
+	for ( const submesh_t& subMesh : mesh->subMeshes ) {
+		const material_t* material = subMesh.material;
+
+		if ( material == nullptr || material->surfType != SURF_OPAQUE || material->alpha != nullptr ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int Render_MergeStaticMeshes( const renderContext_t* context, MaterialManager* matMan, const mesh_t* const* meshes, const std::size_t meshCount, mesh_t* mergedMesh )
+{
+	if ( mergedMesh->transformation == nullptr ) {
+		return 1;
+	}
+
+	// copies share their geometry (see WorldEditor::PasteNode); each one is read once
+	std::unordered_map<const void*, meshGeometry_t> geometries;
+
+	std::vector<DirectX::XMFLOAT3>	positions;
+	std::vector<vertexAttributes_t>	attributes;
+	std::vector<const material_t*>	materials; // by first use
+	std::vector<mergedPiece_t>		pieces;
+
+	for ( std::size_t meshIndex = 0; meshIndex < meshCount; ++meshIndex ) {
+		const mesh_t* mesh = meshes[meshIndex];
+
+		if ( !Render_IsMergeableMesh( mesh ) ) {
+			return 1;
+		}
+
+		meshGeometry_t& geometry = geometries[Render_GetMeshGeometry( mesh )];
+
+		if ( geometry.positions.empty() && !ReadGeometry( context, mesh, geometry ) ) {
+			return 2;
+		}
+
+		// bake the world matrix; directions use the inverse transpose so that non uniform scales keep normals right
+		const DirectX::XMMATRIX& modelMatrix = mesh->transformation->modelMatrix;
+		const DirectX::XMMATRIX normalMatrix = DirectX::XMMatrixTranspose( DirectX::XMMatrixInverse( nullptr, modelMatrix ) );
+
+		const unsigned int baseVertex = static_cast<unsigned int>( positions.size() );
+
+		for ( std::size_t i = 0; i < geometry.positions.size(); ++i ) {
+			DirectX::XMFLOAT3 position;
+			DirectX::XMStoreFloat3( &position, DirectX::XMVector3TransformCoord( DirectX::XMLoadFloat3( &geometry.positions[i] ), modelMatrix ) );
+
+			vertexAttributes_t vertexAttributes = geometry.attributes[i];
+			StoreDirection( vertexAttributes.normal, normalMatrix );
+			StoreDirection( vertexAttributes.tangent, modelMatrix );
+			StoreDirection( vertexAttributes.bitangent, modelMatrix );
+
+			positions.push_back( position );
+			attributes.push_back( vertexAttributes );
+		}
+
+		const bool isMirrored = DirectX::XMVectorGetX( DirectX::XMMatrixDeterminant( modelMatrix ) ) < 0.0f;
+
+		for ( const submesh_t& subMesh : mesh->subMeshes ) {
+			const std::size_t materialIndex = std::find( materials.begin(), materials.end(), subMesh.material ) - materials.begin();
+
+			if ( materialIndex == materials.size() ) {
+				materials.push_back( subMesh.material );
+			}
+
+			pieces.push_back( { materialIndex, &subMesh, baseVertex, &geometry, isMirrored } );
+		}
+	}
+
+	if ( pieces.empty() ) {
+		return 1;
+	}
+
+	// one contiguous index range per material
+	std::stable_sort( pieces.begin(), pieces.end(), []( const mergedPiece_t& left, const mergedPiece_t& right ) {
+		return left.materialIndex < right.materialIndex;
+	} );
+
+	std::vector<unsigned int> indices;
+	std::vector<DirectX::XMFLOAT3> piecePositions;
+
+	mergedMesh->subMeshes.clear();
+	mergedMesh->pieces.clear();
+
+	// vertices are in world space already; every submesh shares the transform of the merged mesh
+	transform_t* identityTransform = mergedMesh->transformation;
+	identityTransform->modelMatrix = DirectX::XMMatrixIdentity();
+
+	for ( const mergedPiece_t& piece : pieces ) {
+		const submesh_t* subMesh = piece.subMesh;
+		const unsigned int* sourceIndices = piece.geometry->indices.data() + subMesh->iboOffset;
+
+		if ( mergedMesh->subMeshes.empty() || mergedMesh->subMeshes.back().material != subMesh->material ) {
+			submesh_t mergedSubMesh = {
+				subMesh->material,
+				identityTransform,
+				0,
+				static_cast<unsigned int>( indices.size() ),
+				0,
+				0,
+			};
+
+			mergedMesh->subMeshes.push_back( mergedSubMesh );
+
+			matMan->AcquireMaterial( subMesh->material );
+		}
+
+		meshPiece_t mergedPiece = {};
+		mergedPiece.iboOffset	= static_cast<unsigned int>( indices.size() );
+		mergedPiece.indiceCount	= subMesh->indiceCount;
+
+		piecePositions.clear();
+
+		for ( unsigned int i = 0; i + 2 < subMesh->indiceCount; i += 3 ) {
+			unsigned int triangle[3] = { piece.baseVertex + sourceIndices[i], piece.baseVertex + sourceIndices[i + 1], piece.baseVertex + sourceIndices[i + 2] };
+
+			// a negative scale flips the winding
+			if ( piece.isMirrored ) {
+				std::swap( triangle[1], triangle[2] );
+			}
+
+			for ( const unsigned int mergedIndex : triangle ) {
+				indices.push_back( mergedIndex );
+				piecePositions.push_back( positions[mergedIndex] );
+			}
+		}
+
+		DirectX::BoundingSphere::CreateFromPoints( mergedPiece.boundingSphere, piecePositions.size(), piecePositions.data(), sizeof( DirectX::XMFLOAT3 ) );
+
+		if ( mergedMesh->pieces.empty() ) {
+			identityTransform->boundingSphere = mergedPiece.boundingSphere;
+		} else {
+			DirectX::BoundingSphere::CreateMerged( identityTransform->boundingSphere, identityTransform->boundingSphere, mergedPiece.boundingSphere );
+		}
+
+		mergedMesh->subMeshes.back().indiceCount += subMesh->indiceCount;
+		mergedMesh->pieces.push_back( mergedPiece );
+	}
+
+	const int bufferStatus = Render_CreateMeshBuffers( context, mergedMesh, positions.data(), attributes.data(), static_cast<unsigned int>( positions.size() ), indices.data(), static_cast<unsigned int>( indices.size() ) );
+	if ( bufferStatus != 0 ) {
+		return 2 + bufferStatus;
+	}
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+struct renderContext_t;
+struct mesh_t;
+class MaterialManager;
+
+// static set dressing merged into a single mesh (usually one per area): transforms are baked into the vertices and the
+// submeshes sharing a material become a single draw range; the bounds of every source submesh are kept as pieces
+// source buffers are read back from the gpu with the immediate context: cook time only (e.g. editor), never while the
+// render thread runs
+// the merged mesh holds its own references on the materials; the sources are left untouched
+// the merged mesh must come with its transform (e.g. from World::AllocateContent); it is reset to identity
+const bool	Render_IsMergeableMesh( const mesh_t* mesh ); // opaque materials only (blended draws are sorted by depth)
+int			Render_MergeStaticMeshes( const renderContext_t* context, MaterialManager* matMan, const mesh_t* const* meshes, const std::size_t meshCount, mesh_t* mergedMesh );
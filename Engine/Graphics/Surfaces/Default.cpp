@@ -1,7 +1,9 @@
 #include "Shared.h"
-#include <d3d11.h>
 #include "Default.h"
-#include <d3dcompiler.h>
+
+#include <Engine/Graphics/RenderBackend.h>
+
+#include <vector>
 
 SurfaceDefault::SurfaceDefault()
 	: vertexShader( nullptr )
@@ -20,86 +22,85 @@ void SurfaceDefault::Destroy()
 	RELEASE( shaderLayout )
 }
 
-const int SurfaceDefault::Create( ID3D11Device* dev )
+const int SurfaceDefault::Create( RenderBackend* backend )
 {
-	HRESULT result = 0;
+	std::vector<uint8_t> vertexShaderBytecode, pixelShaderBytecode;
 
-	ID3D10Blob*		vertexShaderBuffer = nullptr;
-	ID3D10Blob*		pixelShaderBuffer = nullptr;
+	if ( !backend->LoadShaderBytecode( L"base_data/shaders/default_vs.cso", vertexShaderBytecode ) ) {
+		return 1;
+	}
 
-	D3DReadFileToBlob( L"base_data/shaders/default_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/default_ps.cso", &pixelShaderBuffer );
+	if ( !backend->LoadShaderBytecode( L"base_data/shaders/default_ps.cso", pixelShaderBytecode ) ) {
+		return 2;
+	}
 
-	result = dev->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader );
-	if ( FAILED( result ) ) {
+	vertexShader = backend->CreateVertexShader( vertexShaderBytecode.data(), vertexShaderBytecode.size() );
+	if ( vertexShader == nullptr ) {
 		return 1;
 	}
 
-	result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader );
-	if ( FAILED( result ) ) {
+	pixelShader = backend->CreatePixelShader( pixelShaderBytecode.data(), pixelShaderBytecode.size() );
+	if ( pixelShader == nullptr ) {
 		return 2;
 	}
 
-	D3D11_INPUT_ELEMENT_DESC layoutDesc[5] = {};
-	layoutDesc[0].SemanticName = "POSITION";
-	layoutDesc[0].SemanticIndex = 0;
-	layoutDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[0].InputSlot = 0;
-	layoutDesc[0].AlignedByteOffset = 0;
-	layoutDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[0].InstanceDataStepRate = 0;
-
-	layoutDesc[1].SemanticName = "NORMAL";
-	layoutDesc[1].SemanticIndex = 0;
-	layoutDesc[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[1].InputSlot = 0;
-	layoutDesc[1].AlignedByteOffset = 0;
-	layoutDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[1].InstanceDataStepRate = 0;
-
-	layoutDesc[2].SemanticName = "TEXCOORD";
-	layoutDesc[2].SemanticIndex = 0;
-	layoutDesc[2].Format = DXGI_FORMAT_R32G32_FLOAT;
-	layoutDesc[2].InputSlot = 0;
-	layoutDesc[2].AlignedByteOffset = 0;
-	layoutDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[2].InstanceDataStepRate = 0;
-
-	layoutDesc[3].SemanticName = "TANGENT";
-	layoutDesc[3].SemanticIndex = 0;
-	layoutDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[3].InputSlot = 0;
-	layoutDesc[3].AlignedByteOffset = 0;
-	layoutDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[3].InstanceDataStepRate = 0;
-
-	layoutDesc[4].SemanticName = "BINORMAL";
-	layoutDesc[4].SemanticIndex = 0;
-	layoutDesc[4].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[4].InputSlot = 0;
-	layoutDesc[4].AlignedByteOffset = 0;
-	layoutDesc[4].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[4].InstanceDataStepRate = 0;
-
-	result = dev->CreateInputLayout( layoutDesc, 5, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &shaderLayout );
-	if ( FAILED( result ) ) {
+	renderInputElementDesc_t layoutDesc[5] = {};
+	layoutDesc[0].semanticName = "POSITION";
+	layoutDesc[0].semanticIndex = 0;
+	layoutDesc[0].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[0].inputSlot = 0;
+	layoutDesc[0].alignedByteOffset = 0;
+	layoutDesc[0].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[0].instanceDataStepRate = 0;
+
+	layoutDesc[1].semanticName = "NORMAL";
+	layoutDesc[1].semanticIndex = 0;
+	layoutDesc[1].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[1].inputSlot = 1;
+	layoutDesc[1].alignedByteOffset = 0;
+	layoutDesc[1].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[1].instanceDataStepRate = 0;
+
+	layoutDesc[2].semanticName = "TEXCOORD";
+	layoutDesc[2].semanticIndex = 0;
+	layoutDesc[2].format = RENDER_FORMAT_R32G32_FLOAT;
+	layoutDesc[2].inputSlot = 1;
+	layoutDesc[2].alignedByteOffset = RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[2].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[2].instanceDataStepRate = 0;
+
+	layoutDesc[3].semanticName = "TANGENT";
+	layoutDesc[3].semanticIndex = 0;
+	layoutDesc[3].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[3].inputSlot = 1;
+	layoutDesc[3].alignedByteOffset = RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[3].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[3].instanceDataStepRate = 0;
+
+	layoutDesc[4].semanticName = "BINORMAL";
+	layoutDesc[4].semanticIndex = 0;
+	layoutDesc[4].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[4].inputSlot = 1;
+	layoutDesc[4].alignedByteOffset = RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[4].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[4].instanceDataStepRate = 0;
+
+	shaderLayout = backend->CreateInputLayout( layoutDesc, 5, vertexShaderBytecode.data(), vertexShaderBytecode.size() );
+	if ( shaderLayout == nullptr ) {
 		return 3;
 	}
-	
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
 
 	return 0;
 }
 
-void SurfaceDefault::Render( ID3D11DeviceContext* devContext, const UINT indexCount )
+void SurfaceDefault::Render( RenderBackend* backend, const uint32_t indexCount )
 {
-	devContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+	backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
 
-	devContext->IASetInputLayout( shaderLayout );
+	backend->SetInputLayout( shaderLayout );
 
-	devContext->VSSetShader( vertexShader, NULL, 0 );
-	devContext->PSSetShader( pixelShader, NULL, 0 );
+	backend->SetVertexShader( vertexShader );
+	backend->SetPixelShader( pixelShader );
 
-	devContext->DrawIndexed( indexCount, 0, 0 );
+	backend->DrawIndexed( indexCount, 0, 0 );
 }
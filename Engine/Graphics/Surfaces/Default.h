@@ -1,5 +1,9 @@
 #pragma once
 
+#include <Engine/Graphics/RenderTypes.h>
+
+class RenderBackend;
+
 class SurfaceDefault
 {
 public:
@@ -8,11 +12,11 @@ public:
 								~SurfaceDefault()					= default;
 
 	void						Destroy();
-	const int					Create( ID3D11Device* dev );
-	void						Render( ID3D11DeviceContext* devContext, const UINT indexCount );
+	const int					Create( RenderBackend* backend );
+	void						Render( RenderBackend* backend, const uint32_t indexCount );
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
-	ID3D11InputLayout*			shaderLayout;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShader;
+	renderInputLayout_t*		shaderLayout;
 };
@@ -1,182 +1,274 @@
 #include "Shared.h"
-#include <d3d11.h>
 #include "Opaque.h"
-#include <d3dcompiler.h>
 
 #include <Engine/Graphics/Mesh.h>
 #include <Engine/Graphics/RenderContext.h>
-#include <Engine/Graphics/CBuffer.h>
-#include <Engine/Graphics/Camera.h>
-
-struct matModelBuffer_t
-{
-	DirectX::XMMATRIX model;
-};
+#include <Engine/Graphics/RenderSnapshot.h>
+#include <Engine/Graphics/TransformBuffer.h>
+#include <Engine/Graphics/StateCache.h>
+#include <Engine/Graphics/PipelineStateCache.h>
+#include <Engine/Graphics/ShaderLibrary.h>
 
 SurfaceOpaque::SurfaceOpaque()
 	: vertexShader( nullptr )
 	, pixelShader( nullptr )
 	, shaderLayout( nullptr )
+	, depthVertexShader( nullptr )
+	, depthShaderLayout( nullptr )
 	, samplerState( nullptr )
+	, shadowSamplerState( nullptr )
+	, passStates{}
 {
 
 }
 
 void SurfaceOpaque::Destroy()
 {
-	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
-
-	RELEASE( vertexShader )
-	RELEASE( pixelShader )
-	RELEASE( shaderLayout )
-	RELEASE( samplerState )
+	// owned by the shader library and the pipeline state cache
+	vertexShader		= nullptr;
+	pixelShader			= nullptr;
+	shaderLayout		= nullptr;
+	depthVertexShader	= nullptr;
+	depthShaderLayout	= nullptr;
+	samplerState		= nullptr;
+	shadowSamplerState	= nullptr;
+
+	for ( passState_t& passState : passStates ) {
+		passState = {};
+	}
 }
 
 const int SurfaceOpaque::Create( const renderContext_t* context )
 {
-	HRESULT result = 0;
-
-	ID3D10Blob*		vertexShaderBuffer	= nullptr;
-	ID3D10Blob*		pixelShaderBuffer	= nullptr;
-
-	D3DReadFileToBlob( L"base_data/shaders/opaque_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/opaque_ps.cso", &pixelShaderBuffer );
+	PipelineStateCache* pipelineStates = context->pipelineStates;
 
-	if ( FAILED( context->device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader ) ) ) {
+	// generic shader; materials with a permutation of their own override it (see material_t)
+	vertexShader = context->shaders->GetVertexShader( L"base_data/shaders/opaque_vs.cso" );
+	if ( vertexShader == nullptr ) {
 		return 1;
 	}
 
-	if ( FAILED( context->device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader ) ) ) {
+	pixelShader = context->shaders->GetPixelShader( L"base_data/shaders/opaque_ps.cso" );
+	if ( pixelShader == nullptr ) {
 		return 2;
 	}
 
-	D3D11_INPUT_ELEMENT_DESC layoutDesc[5] = {};
-	layoutDesc[0].SemanticName			= "POSITION";
-	layoutDesc[0].SemanticIndex			= 0;
-	layoutDesc[0].Format				= DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[0].InputSlot				= 0;
-	layoutDesc[0].AlignedByteOffset		= 0;
-	layoutDesc[0].InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[0].InstanceDataStepRate	= 0;
-
-	layoutDesc[1].SemanticName			= "NORMAL";
-	layoutDesc[1].SemanticIndex			= 0;
-	layoutDesc[1].Format				= DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[1].InputSlot				= 0;
-	layoutDesc[1].AlignedByteOffset		= D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[1].InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[1].InstanceDataStepRate	= 0;
-
-	layoutDesc[2].SemanticName			= "TEXCOORD";
-	layoutDesc[2].SemanticIndex			= 0;
-	layoutDesc[2].Format				= DXGI_FORMAT_R32G32_FLOAT;
-	layoutDesc[2].InputSlot				= 0;
-	layoutDesc[2].AlignedByteOffset		= D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[2].InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[2].InstanceDataStepRate	= 0;
-
-	layoutDesc[3].SemanticName			= "TANGENT";
-	layoutDesc[3].SemanticIndex			= 0;
-	layoutDesc[3].Format				= DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[3].InputSlot				= 0;
-	layoutDesc[3].AlignedByteOffset		= D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[3].InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[3].InstanceDataStepRate	= 0;
-
-	layoutDesc[4].SemanticName			= "BINORMAL";
-	layoutDesc[4].SemanticIndex			= 0;
-	layoutDesc[4].Format				= DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[4].InputSlot				= 0;
-	layoutDesc[4].AlignedByteOffset		= D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[4].InputSlotClass		= D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[4].InstanceDataStepRate	= 0;
-
-	if ( FAILED( context->device->CreateInputLayout( layoutDesc, 5, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &shaderLayout ) ) ) {
+	renderInputElementDesc_t layoutDesc[6] = {};
+	layoutDesc[0].semanticName			= "POSITION";
+	layoutDesc[0].semanticIndex			= 0;
+	layoutDesc[0].format				= RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[0].inputSlot				= 0;
+	layoutDesc[0].alignedByteOffset		= 0;
+	layoutDesc[0].inputSlotClass		= RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[0].instanceDataStepRate	= 0;
+
+	// attribute stream (see mesh_t)
+	layoutDesc[1].semanticName			= "NORMAL";
+	layoutDesc[1].semanticIndex			= 0;
+	layoutDesc[1].format				= RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[1].inputSlot				= 1;
+	layoutDesc[1].alignedByteOffset		= 0;
+	layoutDesc[1].inputSlotClass		= RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[1].instanceDataStepRate	= 0;
+
+	layoutDesc[2].semanticName			= "TEXCOORD";
+	layoutDesc[2].semanticIndex			= 0;
+	layoutDesc[2].format				= RENDER_FORMAT_R32G32_FLOAT;
+	layoutDesc[2].inputSlot				= 1;
+	layoutDesc[2].alignedByteOffset		= RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[2].inputSlotClass		= RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[2].instanceDataStepRate	= 0;
+
+	layoutDesc[3].semanticName			= "TANGENT";
+	layoutDesc[3].semanticIndex			= 0;
+	layoutDesc[3].format				= RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[3].inputSlot				= 1;
+	layoutDesc[3].alignedByteOffset		= RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[3].inputSlotClass		= RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[3].instanceDataStepRate	= 0;
+
+	layoutDesc[4].semanticName			= "BINORMAL";
+	layoutDesc[4].semanticIndex			= 0;
+	layoutDesc[4].format				= RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[4].inputSlot				= 1;
+	layoutDesc[4].alignedByteOffset		= RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[4].inputSlotClass		= RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[4].instanceDataStepRate	= 0;
+
+	// transform index (see TransformBuffer)
+	layoutDesc[5].semanticName			= "INSTANCE";
+	layoutDesc[5].semanticIndex			= 0;
+	layoutDesc[5].format				= RENDER_FORMAT_R32_UINT;
+	layoutDesc[5].inputSlot				= 2;
+	layoutDesc[5].alignedByteOffset		= 0;
+	layoutDesc[5].inputSlotClass		= RENDER_INPUT_PER_INSTANCE_DATA;
+	layoutDesc[5].instanceDataStepRate	= 1;
+
+	shaderLayout = pipelineStates->GetInputLayout( layoutDesc, 6, L"base_data/shaders/opaque_vs.cso" );
+	if ( shaderLayout == nullptr ) {
+		return 3;
+	}
+
+	depthVertexShader = context->shaders->GetVertexShader( L"base_data/shaders/depth_vs.cso" );
+	if ( depthVertexShader == nullptr ) {
+		return 1;
+	}
+
+	// position and instance streams only (see Render_BindMeshPositions)
+	layoutDesc[1] = layoutDesc[5];
+
+	depthShaderLayout = pipelineStates->GetInputLayout( layoutDesc, 2, L"base_data/shaders/depth_vs.cso" );
+	if ( depthShaderLayout == nullptr ) {
 		return 3;
 	}
-	
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
-
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_ANISOTROPIC;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	samplerDesc.MaxAnisotropy = 8;
-
-	if ( FAILED( context->device->CreateSamplerState( &samplerDesc, &samplerState ) ) ) {
+
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_ANISOTROPIC;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+	samplerDesc.maxAnisotropy = 8;
+
+	samplerState = pipelineStates->GetSamplerState( samplerDesc );
+	if ( samplerState == nullptr ) {
 		return 4;
 	}
 
-	D3D11_SAMPLER_DESC shadowSamplerDesc = {};
-	shadowSamplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	shadowSamplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	shadowSamplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	shadowSamplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	shadowSamplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+	renderSamplerDesc_t shadowSamplerDesc = {};
+	shadowSamplerDesc.filter = RENDER_FILTER_MIN_MAG_MIP_LINEAR;
+	shadowSamplerDesc.addressU = RENDER_TEXTURE_ADDRESS_CLAMP;
+	shadowSamplerDesc.addressV = RENDER_TEXTURE_ADDRESS_CLAMP;
+	shadowSamplerDesc.addressW = RENDER_TEXTURE_ADDRESS_CLAMP;
+	shadowSamplerDesc.comparisonFunc = RENDER_COMPARISON_LESS_EQUAL;
 
-	if ( FAILED( context->device->CreateSamplerState( &shadowSamplerDesc, &shadowSamplerState ) ) ) {
+	shadowSamplerState = pipelineStates->GetSamplerState( shadowSamplerDesc );
+	if ( shadowSamplerState == nullptr ) {
 		return 4;
 	}
 
-	Render_CreateCBuffer( context, cbuffer, sizeof( matModelBuffer_t ) );
+	renderBlendDesc_t alphaBlendDesc = {};
+	alphaBlendDesc.renderTarget[0].blendEnable = 1;
+	alphaBlendDesc.renderTarget[0].writeMask = RENDER_COLOR_WRITE_ENABLE_ALL;
+
+	alphaBlendDesc.renderTarget[0].srcBlend			= RENDER_BLEND_SRC_ALPHA;
+	alphaBlendDesc.renderTarget[0].destBlend		= RENDER_BLEND_INV_SRC_ALPHA;
+
+	alphaBlendDesc.renderTarget[0].srcBlendAlpha	= RENDER_BLEND_ONE;
+	alphaBlendDesc.renderTarget[0].destBlendAlpha	= RENDER_BLEND_ONE;
+
+	alphaBlendDesc.renderTarget[0].blendOp			= RENDER_BLEND_OP_ADD;
+	alphaBlendDesc.renderTarget[0].blendOpAlpha		= RENDER_BLEND_OP_ADD;
+
+	renderBlendState_t* alphaBlendState = pipelineStates->GetBlendState( alphaBlendDesc );
+	if ( alphaBlendState == nullptr ) {
+		return 5;
+	}
+
+	// transparent surfaces are tested against the opaque depth but don't write it; ui goes over everything
+	renderDepthStencilDesc_t depthStencilDesc = {};
+	depthStencilDesc.depthEnable	= 1;
+	depthStencilDesc.depthWriteMask	= RENDER_DEPTH_WRITE_MASK_ZERO;
+	depthStencilDesc.depthFunc		= RENDER_COMPARISON_LESS_EQUAL;
+
+	renderDepthStencilState_t* transparentDepthState = pipelineStates->GetDepthStencilState( depthStencilDesc );
+	if ( transparentDepthState == nullptr ) {
+		return 6;
+	}
+
+	depthStencilDesc.depthEnable = 0;
+
+	renderDepthStencilState_t* uiDepthState = pipelineStates->GetDepthStencilState( depthStencilDesc );
+	if ( uiDepthState == nullptr ) {
+		return 6;
+	}
 
-	context->deviceContext->VSSetConstantBuffers( 2, 1, &cbuffer );
+	passStates[RENDER_PASS_OPAQUE]		= { nullptr, context->depthStencilBuffer.stateOpaque };
+	passStates[RENDER_PASS_TRANSPARENT]	= { alphaBlendState, transparentDepthState };
+	passStates[RENDER_PASS_UI]			= { alphaBlendState, uiDepthState };
 
 	return 0;
 }
 
-void SurfaceOpaque::Render( const renderContext_t* context, const mesh_t* mesh, const Camera* camera )
+void SurfaceOpaque::DrawBatches( const renderContext_t* context, const TransformBuffer* transforms, const renderSnapshot_t* snapshot, const renderPass_t pass, const uint32_t firstBatch, const uint32_t batchCount )
+{
+	// the queue has been sorted (pass, surface, shader, material, depth) and batched by the simulation; consume it linearly
+	const mesh_t* boundMesh = nullptr;
+
+	Bind( context, transforms, pass );
+
+	for ( uint32_t batchIndex = firstBatch; batchIndex < firstBatch + batchCount; ++batchIndex ) {
+		const renderBatch_t& batch = snapshot->batches[batchIndex];
+		const renderSubDraw_t& subDraw = snapshot->subDraws[batch.subDrawIndex];
+		const renderDraw_t& draw = snapshot->draws[subDraw.drawIndex];
+
+		// every instance of the batch uses the same buffers; any of them can be bound
+		// meshes of the shared geometry buffers bind the same buffers (filtered by the state cache)
+		if ( draw.mesh != boundMesh ) {
+			Render_BindMesh( context, draw.mesh );
+			boundMesh = draw.mesh;
+		}
+
+		DrawSubMesh( context, draw.mesh, subDraw, batch.firstInstance, batch.instanceCount );
+	}
+}
+
+void SurfaceOpaque::DrawDepthBatches( const renderContext_t* context, const TransformBuffer* transforms, const renderSnapshot_t* snapshot, const uint32_t firstBatch, const uint32_t batchCount )
 {
-	context->deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+	StateCache* stateCache = context->stateCache;
+	const mesh_t* boundMesh = nullptr;
 
-	context->deviceContext->IASetInputLayout( shaderLayout );
+	Bind( context, transforms, RENDER_PASS_OPAQUE );
 
-	context->deviceContext->VSSetShader( vertexShader, NULL, 0 );
-	context->deviceContext->PSSetShader( pixelShader, NULL, 0 );
+	// no pixel shader: only the depth is written, whatever the targets
+	stateCache->SetInputLayout( depthShaderLayout );
+	stateCache->SetVertexShader( depthVertexShader );
+	stateCache->SetPixelShader( nullptr );
 
-	context->deviceContext->PSSetSamplers( 0, 1, &samplerState );
-	context->deviceContext->PSSetSamplers( 1, 1, &shadowSamplerState );
+	for ( uint32_t batchIndex = firstBatch; batchIndex < firstBatch + batchCount; ++batchIndex ) {
+		const renderBatch_t& batch = snapshot->batches[batchIndex];
+		const renderSubDraw_t& subDraw = snapshot->subDraws[batch.subDrawIndex];
+		const renderDraw_t& draw = snapshot->draws[subDraw.drawIndex];
 
-	Render_UploadCBuffer( context, cbuffer, &mesh->transformation->modelMatrix, sizeof( matModelBuffer_t ) );
-	context->deviceContext->VSSetConstantBuffers( 2, 1, &cbuffer );
+		if ( draw.mesh != boundMesh ) {
+			Render_BindMeshPositions( context, draw.mesh );
+			boundMesh = draw.mesh;
+		}
 
-	for ( const submesh_t& subMesh : mesh->subMeshes ) {
-		/*if ( !cam.frustum.Contains( subMesh.transformation->boundingSphere ) ) {
-			continue;
-		}*/
+		stateCache->DrawIndexedInstanced( subDraw.indiceCount, batch.instanceCount, Render_GetMeshFirstIndex( draw.mesh ) + subDraw.iboOffset, Render_GetMeshBaseVertex( draw.mesh ), batch.firstInstance );
+	}
+}
 
-		// this is ineffective as hell
-		// TODO: proper model matrix management
-		// ( model matrix pool using a cbuffer? just need a way to identify each submesh by hashing or id)
+void SurfaceOpaque::Bind( const renderContext_t* context, const TransformBuffer* transforms, const renderPass_t pass )
+{
+	StateCache* stateCache = context->stateCache;
 
-		if ( subMesh.material->alpha != nullptr ) {
-			D3D11_BLEND_DESC omDesc = {};
-			omDesc.RenderTarget[0].BlendEnable = TRUE;
-			omDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	stateCache->SetBlendState( passStates[pass].blendState );
+	stateCache->SetDepthStencilState( passStates[pass].depthStencilState, 1 );
 
-			omDesc.RenderTarget[0].SrcBlend			= D3D11_BLEND_SRC_ALPHA;
-			omDesc.RenderTarget[0].DestBlend		= D3D11_BLEND_INV_SRC_ALPHA;
+	stateCache->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
 
-			omDesc.RenderTarget[0].SrcBlendAlpha	= D3D11_BLEND_ONE;
-			omDesc.RenderTarget[0].DestBlendAlpha	= D3D11_BLEND_ONE;
+	stateCache->SetInputLayout( shaderLayout );
 
-			omDesc.RenderTarget[0].BlendOp			= D3D11_BLEND_OP_ADD;
-			omDesc.RenderTarget[0].BlendOpAlpha		= D3D11_BLEND_OP_ADD;
+	stateCache->SetVertexShader( vertexShader );
 
-			ID3D11BlendState* mBlendState = NULL;
-			context->device->CreateBlendState( &omDesc, &mBlendState );
+	stateCache->SetPSSampler( 0, samplerState );
+	stateCache->SetPSSampler( 1, shadowSamplerState );
 
-			float blendFactor[] = { 0,0, 0, 0 };
-			UINT sampleMask = 0xffffffff;
-			context->deviceContext->OMSetBlendState( mBlendState, blendFactor, sampleMask );
-		}
+	stateCache->SetInstanceBuffer( transforms->GetInstanceBuffer(), sizeof( uint32_t ), 0 );
+	stateCache->SetVSShaderResource( 0, transforms->GetView() );
+}
 
-		Render_BindOpaqueMaterial( context->deviceContext, subMesh.material );
-		context->deviceContext->DrawIndexed( subMesh.indiceCount, subMesh.iboOffset, 0 );
-		context->deviceContext->OMSetBlendState( NULL, NULL, 0xFFFFFFFF );
-	}
+void SurfaceOpaque::DrawSubMesh( const renderContext_t* context, const mesh_t* mesh, const renderSubDraw_t& subDraw, const uint32_t firstInstance, const uint32_t instanceCount )
+{
+	const submesh_t& subMesh = mesh->subMeshes[subDraw.subMeshIndex];
+
+	// batches are sorted by shader first; the permutation only changes between material groups
+	const material_t* material = subMesh.material;
+	context->stateCache->SetPixelShader( ( material->pixelShader != nullptr ) ? material->pixelShader : pixelShader );
+
+	Render_BindOpaqueMaterial( context->stateCache, material );
+	// the instances are a range of the transform slots uploaded for the frame
+	context->stateCache->DrawIndexedInstanced( subDraw.indiceCount, instanceCount, Render_GetMeshFirstIndex( mesh ) + subDraw.iboOffset, Render_GetMeshBaseVertex( mesh ), firstInstance );
 }
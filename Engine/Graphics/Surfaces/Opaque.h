@@ -1,9 +1,13 @@
 #pragma once
 
 struct mesh_t;
+struct renderSubDraw_t;
 struct renderContext_t;
-class FreeCamera;
-class Camera;
+struct renderSnapshot_t;
+class TransformBuffer;
+
+#include <Engine/Graphics/RenderQueue.h>
+#include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
 
 class SurfaceOpaque
 {
@@ -14,13 +18,33 @@ public:
 
 	void						Destroy();
 	const int					Create( const renderContext_t* context );
-	void						Render( const renderContext_t* context, const mesh_t* mesh, const Camera* camera );
+
+	// draws a range of the sorted and batched submeshes of the snapshot (see RenderQueue and renderBatch_t) through the state cache only
+	// the range must belong to 'pass' (see renderSnapshot_t::passBatchOffsets); its blend and depth states are bound first
+	// transforms and instances must have been uploaded for the frame; ranges can be recorded concurrently on different contexts
+	void						DrawBatches( const renderContext_t* context, const TransformBuffer* transforms, const renderSnapshot_t* snapshot, const renderPass_t pass, const uint32_t firstBatch, const uint32_t batchCount );
+
+	// depth only version of DrawBatches (position stream, no pixel shader); meant for the opaque batches, before they are shaded
+	void						DrawDepthBatches( const renderContext_t* context, const TransformBuffer* transforms, const renderSnapshot_t* snapshot, const uint32_t firstBatch, const uint32_t batchCount );
+
+private:
+	struct passState_t
+	{
+		renderBlendState_t*			blendState;
+		renderDepthStencilState_t*	depthStencilState;
+	};
+
+private:
+	renderVertexShader_t*			vertexShader;
+	renderPixelShader_t*			pixelShader;
+	renderInputLayout_t*			shaderLayout;
+	renderVertexShader_t*			depthVertexShader;
+	renderInputLayout_t*			depthShaderLayout;
+	renderSamplerState_t*			samplerState;
+	renderSamplerState_t*			shadowSamplerState;
+	passState_t					passStates[RENDER_PASS_COUNT];
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
-	ID3D11InputLayout*			shaderLayout;
-	ID3D11SamplerState*			samplerState;
-	ID3D11SamplerState*			shadowSamplerState;
-	ID3D11Buffer*				cbuffer;
+	void						Bind( const renderContext_t* context, const TransformBuffer* transforms, const renderPass_t pass );
+	void						DrawSubMesh( const renderContext_t* context, const mesh_t* mesh, const renderSubDraw_t& subDraw, const uint32_t firstInstance, const uint32_t instanceCount );
 };
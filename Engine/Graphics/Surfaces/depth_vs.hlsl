@@ -0,0 +1,24 @@
+// depth prepass of the opaque surfaces: position stream only; the attributes are never fetched
+// the clip position must be computed exactly like opaque_vs (the opaque pass tests less equal against it)
+struct vsData_t
+{
+    float3 position     : POSITION;
+    uint instanceId     : INSTANCE; // transform index (per instance stream; see TransformBuffer)
+};
+
+cbuffer MatrixBuffer : register( b0 )
+{
+	float4 camPosition;
+	matrix viewProjectionMatrix;
+};
+
+StructuredBuffer<float4x4> modelMatrices : register( t0 );
+
+float4 main( vsData_t input ) : SV_POSITION
+{
+	const float4x4 modelMatrix = modelMatrices[input.instanceId];
+
+	const float4 positionWS = mul( modelMatrix, float4( input.position, 1.0f ) );
+
+	return mul( viewProjectionMatrix, positionWS );
+}
@@ -99,6 +99,15 @@ struct psOutput_t
 #define IS_METAL_MAPPED( flags ) ( flags >> 5 ) & 1 
 #define IS_ALPHA_MAPPED( flags ) ( flags >> 6 ) & 1 
 
+// material permutations are compiled with the flags known at compile time (see ShaderLibrary)
+#ifdef PERMUTATION_FLAGS
+#define MATERIAL_FLAGS PERMUTATION_FLAGS
+#define MATERIAL_BRANCH
+#else
+#define MATERIAL_FLAGS flags
+#define MATERIAL_BRANCH [branch]
+#endif
+
 psOutput_t main( psData_t p ) : SV_TARGET
 {
 	psOutput_t output = 
@@ -109,16 +118,16 @@ psOutput_t main( psData_t p ) : SV_TARGET
 
 	float3 albedo = float3( 1.0f, 1.0f, 1.0f );
 
-	if ( IS_ALBEDO_MAPPED( flags ) ) {
+	if ( IS_ALBEDO_MAPPED( MATERIAL_FLAGS ) ) {
 		albedo = ( albedoMap.Sample( defaultSampler, p.uvCoord ).xyz );
 	}
 
-	[branch]
-	if ( IS_SHADELESS( flags ) ) {
+	MATERIAL_BRANCH
+	if ( IS_SHADELESS( MATERIAL_FLAGS ) ) {
 		output.lightResult.rgb = albedo * ( diffuseColor );
 	} else {
 		float metalness = 0.0f;
-		if ( IS_METAL_MAPPED( flags ) ) {
+		if ( IS_METAL_MAPPED( MATERIAL_FLAGS ) ) {
 			metalness = metalMap.Sample( defaultSampler, p.uvCoord ).x;
 		}
 
@@ -128,20 +137,20 @@ psOutput_t main( psData_t p ) : SV_TARGET
 		float3 V = normalize( camPosition.xyz - p.positionWS.xyz );
 		float3 N = normalize( p.normal );
 
-		if ( IS_NORMAL_MAPPED( flags ) ) {
+		if ( IS_NORMAL_MAPPED( MATERIAL_FLAGS ) ) {
 			float3 normal = normalMap.Sample( defaultSampler, p.uvCoord ).xyz * 2.0f - 1.0f;
 			N = normalize( ( normal.x * p.tangent ) + ( normal.y * p.binormal ) + ( normal.z * p.normal ) );
 		}
 
 		float ao = 1.0f;
 		
-		if ( IS_AO_MAPPED( flags ) ) {
+		if ( IS_AO_MAPPED( MATERIAL_FLAGS ) ) {
 			ao = aoMap.Sample( defaultSampler, p.uvCoord ).x;
 		}
 
 		float normalLength = length( N * 2.0 - 1.0 );
 		float roughness = 0.999f;
-		if ( IS_ROUGH_MAPPED( flags ) ) {
+		if ( IS_ROUGH_MAPPED( MATERIAL_FLAGS ) ) {
 			roughness = roughMap.Sample( defaultSampler, p.uvCoord ).x;
 		}
 
@@ -168,7 +177,7 @@ psOutput_t main( psData_t p ) : SV_TARGET
 	// since we are aiming for a rgba16 rt, avoiding NaN and Inf would be cool
 	output.bloomResult.rgb = output.lightResult.rgb  * ( emissivity * 2.0 );
 
-	if ( IS_ALPHA_MAPPED( flags ) ) output.lightResult.a *= alphaMap.Sample( defaultSampler, p.uvCoord ).r;
+	if ( IS_ALPHA_MAPPED( MATERIAL_FLAGS ) ) output.lightResult.a *= alphaMap.Sample( defaultSampler, p.uvCoord ).r;
 
 	return output;
 }
@@ -5,6 +5,7 @@ struct vsData_t
     float2 uvCoord      : TEXCOORD0;
     float3 tangent      : TANGENT;
     float3 binormal		: BINORMAL;
+    uint instanceId     : INSTANCE; // transform index (per instance stream; see TransformBuffer)
 };
 
 cbuffer MatrixBuffer : register( b0 )
@@ -13,10 +14,7 @@ cbuffer MatrixBuffer : register( b0 )
 	matrix viewProjectionMatrix;
 };
 
-cbuffer MatrixModelBuffer : register( b2 )
-{
-	float4x4 modelMatrix;
-};
+StructuredBuffer<float4x4> modelMatrices : register( t0 );
 
 cbuffer LightMatrixModelBuffer : register( b4 )
 {
@@ -41,6 +39,8 @@ psData_t main( vsData_t input )
 {
 	psData_t output = ( psData_t )0;
 
+	const float4x4 modelMatrix = modelMatrices[input.instanceId];
+
 	output.positionWS	= mul( modelMatrix, float4( input.position, 1.0f ) );
 	output.position		= mul( viewProjectionMatrix, output.positionWS );
 
@@ -1,41 +1,94 @@
 #include "Shared.h"
 #include "RenderContext.h"
+#include "RenderBackend.h"
 #include "Texture.h"
+#include "ReleaseQueue.h"
 
-#include <d3d11.h>
-#include <Engine/ThirdParty/DirectXTK/Inc/DDSTextureLoader.h>
+#include <cstdlib>
 
 texture_t* TextureManager::GetTexture( const renderContext_t* context, const char* texPath )
 {
 	const uint64_t texHashcode = MurmurHash64A( texPath, static_cast<int>( strlen( texPath ) ), 0xB );
 
-	auto it = content.find( texHashcode );
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
 
-	if ( it != content.end() ) {
-		return it->second.get();
+		auto it = content.find( texHashcode );
+
+		if ( it != content.end() ) {
+			it->second->refCount++;
+			return it->second.get();
+		}
 	}
 
-	content[texHashcode] = std::make_unique<texture_t>();
+	// load outside of the lock; resource creation is free threaded
+	wchar_t widePath[260]{ '\0' }; // because Microsoft
+	std::mbstowcs( widePath, texPath, _countof( widePath ) - 1 );
 
-	static wchar_t widePath[MAX_PATH]{ '\0' }; // because Microsoft
-	std::size_t wideConvertedLength = 0;
+	std::unique_ptr<texture_t> texture = std::make_unique<texture_t>();
 
-	mbstowcs_s( &wideConvertedLength, widePath, texPath, MAX_PATH );
-	
-	const HRESULT texLoadResult = DirectX::CreateDDSTextureFromFile( context->device, widePath, &content[texHashcode]->ressource, &content[texHashcode]->view );
+	texture->ressource = context->backend->CreateTextureFromFile( widePath, &texture->view );
 
-	if ( texLoadResult != S_OK ) {
-		content.erase( texHashcode );
+	if ( texture->ressource == nullptr ) {
 		// TODO: log stuff
 		return nullptr;
 	}
 
-	return content[texHashcode].get();
+	std::lock_guard<std::mutex> lock( contentLock );
+
+	// another thread might have loaded the same texture in the meantime; keep the first one
+	std::unique_ptr<texture_t>& entry = content[texHashcode];
+
+	if ( entry == nullptr ) {
+		texture->hashcode = texHashcode;
+		entry = std::move( texture );
+	}
+
+	entry->refCount++;
+
+	return entry.get();
+}
+
+void TextureManager::AcquireTexture( texture_t* texture )
+{
+	if ( texture != nullptr ) {
+		std::lock_guard<std::mutex> lock( contentLock );
+		texture->refCount++;
+	}
+}
+
+void TextureManager::ReleaseTexture( const renderContext_t* context, texture_t* texture )
+{
+	if ( texture == nullptr ) {
+		return;
+	}
+
+	texture_t* releasedTexture = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock( contentLock );
+
+		if ( --texture->refCount > 0 ) {
+			return;
+		}
+
+		auto it = content.find( texture->hashcode );
+
+		if ( it != content.end() && it->second.get() == texture ) {
+			releasedTexture = it->second.release();
+			content.erase( it );
+		}
+	}
+
+	// snapshots in flight might still bind it
+	if ( releasedTexture != nullptr ) {
+		Render_QueueRelease( context, [releasedTexture]() { delete releasedTexture; } );
+	}
 }
 
-void Render_ClearTargetColor( ID3D11DeviceContext* context, const renderTarget_t* rt )
+void Render_ClearTargetColor( RenderBackend* backend, const renderTarget_t* rt )
 {
-	static constexpr FLOAT CLEAR_COLOR[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	static constexpr float CLEAR_COLOR[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
 
-	context->ClearRenderTargetView( rt->view, CLEAR_COLOR );
+	backend->ClearRenderTarget( rt->view, CLEAR_COLOR );
 }
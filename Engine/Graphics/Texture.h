@@ -4,9 +4,11 @@
 
 struct renderContext_t;
 
-#include <d3d11.h>
+#include "RenderTypes.h"
+
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include <Engine/System/MurmurHash2_64.h>
 
@@ -18,52 +20,54 @@ struct texture_t
 		RELEASE( view )
 	}
 
-	ID3D11Resource*				ressource;
-	ID3D11ShaderResourceView*	view;
+	renderTexture_t*				ressource;
+	renderShaderResourceView_t*		view;
+
+	uint64_t					hashcode;	// path hash; key in the texture manager
+	int32_t						refCount;	// guarded by the texture manager lock
 };
 
 struct renderTarget_t
 {
 	~renderTarget_t()
 	{
-		RELEASE( tex1D )
-		RELEASE( tex2D )
-		RELEASE( tex3D )
-
+		RELEASE( texture )
 		RELEASE( ressource )
 		RELEASE( view )
 	}
 
-	union
-	{
-		ID3D11Texture1D*			tex1D;
-		ID3D11Texture2D*			tex2D;
-		ID3D11Texture3D*			tex3D;
-	};
-
-	ID3D11ShaderResourceView*		ressource;
+	renderTexture_t*				texture;	// 1D, 2D or 3D (see desc.dimension)
+	renderShaderResourceView_t*		ressource;
 
 	union
 	{
-		ID3D11RenderTargetView*     view;
-		ID3D11DepthStencilView*		depthView;
+		renderTargetView_t*			view;
+		renderDepthStencilView_t*	depthView;
 	};
 };
 
+// thread safe; textures can be preloaded from a background thread (see StateManager)
+// textures are shared and counted: every GetTexture must be matched by a ReleaseTexture; the last release removes the
+// texture from the cache and queues its destruction (see ReleaseQueue); a texture requested again before that is reloaded
 class TextureManager
 {
 public:
-	inline void	Flush() { content.clear(); }
+	inline void	Flush() { std::lock_guard<std::mutex> lock( contentLock ); content.clear(); } // drops every texture; shutdown only
 
 public:
 				TextureManager()					= default;
 				TextureManager( TextureManager& )	= delete;
 				~TextureManager()					= default;
 
-	texture_t*	GetTexture( const renderContext_t* context, const char* texPath );
+	texture_t*	GetTexture( const renderContext_t* context, const char* texPath ); // acquired; null if the file can't be loaded
+	void		AcquireTexture( texture_t* texture );
+	void		ReleaseTexture( const renderContext_t* context, texture_t* texture );
 
 private:
-	std::map<uint64_t, std::unique_ptr<texture_t>> content;
+	std::mutex										contentLock;
+	std::map<uint64_t, std::unique_ptr<texture_t>>	content;
 };
 
-void Render_ClearTargetColor( ID3D11DeviceContext* context, const renderTarget_t* rt );
+class RenderBackend;
+
+void Render_ClearTargetColor( RenderBackend* backend, const renderTarget_t* rt );
@@ -0,0 +1,265 @@
+#include "Shared.h"
+#include "TransformBuffer.h"
+#include "RenderContext.h"
+#include "RenderBackend.h"
+
+#include <algorithm>
+
+TransformBuffer::TransformBuffer()
+	: buffer( nullptr )
+	, view( nullptr )
+	, instanceBuffer( nullptr )
+	, gpuCapacity( 0 )
+	, instanceCapacity( 0 )
+	, dirtyPageCount( 0 )
+	, frameIndex( 0 )
+	, uploadedSize( 0 )
+{
+
+}
+
+const bool TransformBuffer::Create( const renderContext_t* context, const uint32_t capacity )
+{
+	matrices.reserve( capacity );
+	slots.reserve( capacity );
+
+	return CreateBuffers( context, capacity );
+}
+
+void TransformBuffer::Destroy()
+{
+	ReleaseBuffers();
+
+	matrices.clear();
+	slots.clear();
+	freeSlots.clear();
+	ownerSlots.clear();
+	dirtyPages.clear();
+
+	dirtyPageCount	= 0;
+	gpuCapacity		= 0;
+}
+
+uint32_t TransformBuffer::Update( const transform_t* owner, const DirectX::XMMATRIX& matrix )
+{
+	auto it = ownerSlots.find( owner );
+
+	uint32_t slot = INVALID_INDEX;
+	bool isNewSlot = false;
+
+	if ( it != ownerSlots.end() ) {
+		slot = it->second;
+	} else {
+		if ( !freeSlots.empty() ) {
+			slot = freeSlots.back();
+			freeSlots.pop_back();
+		} else {
+			slot = static_cast<uint32_t>( slots.size() );
+
+			slots.push_back( {} );
+			matrices.emplace_back();
+
+			if ( dirtyPages.size() * PAGE_SIZE < slots.size() ) {
+				dirtyPages.push_back( 0 );
+			}
+		}
+
+		slots[slot].owner = owner;
+		ownerSlots.emplace( owner, slot );
+
+		isNewSlot = true;
+	}
+
+	slots[slot].lastUsedFrame = frameIndex;
+
+	DirectX::XMFLOAT4X4 value;
+	DirectX::XMStoreFloat4x4( &value, matrix );
+
+	// most transforms don't move from one frame to another
+	if ( isNewSlot || memcmp( &matrices[slot], &value, sizeof( DirectX::XMFLOAT4X4 ) ) != 0 ) {
+		matrices[slot] = value;
+		MarkDirty( slot );
+	}
+
+	return slot;
+}
+
+const bool TransformBuffer::Upload( const renderContext_t* context )
+{
+	uploadedSize = 0;
+
+	if ( slots.size() > gpuCapacity ) {
+		uint32_t capacity = ( gpuCapacity != 0 ) ? gpuCapacity : PAGE_SIZE;
+
+		while ( capacity < slots.size() ) {
+			capacity <<= 1;
+		}
+
+		if ( !CreateBuffers( context, capacity ) ) {
+			return false;
+		}
+
+		// the previous content is gone
+		std::fill( dirtyPages.begin(), dirtyPages.end(), 1 );
+		dirtyPageCount = dirtyPages.size();
+	}
+
+	if ( dirtyPageCount != 0 ) {
+		const std::size_t pageCount = dirtyPages.size();
+
+		// one update per run of contiguous dirty pages
+		for ( std::size_t page = 0; page < pageCount; ++page ) {
+			if ( dirtyPages[page] == 0 ) {
+				continue;
+			}
+
+			std::size_t lastPage = page;
+			while ( lastPage + 1 < pageCount && dirtyPages[lastPage + 1] != 0 ) {
+				lastPage++;
+			}
+
+			constexpr uint32_t MATRIX_SIZE = sizeof( DirectX::XMFLOAT4X4 );
+
+			const uint32_t firstSlot	= static_cast<uint32_t>( page * PAGE_SIZE );
+			const uint32_t endSlot		= static_cast<uint32_t>( std::min( ( lastPage + 1 ) * PAGE_SIZE, slots.size() ) );
+			const uint32_t runSize		= ( endSlot - firstSlot ) * MATRIX_SIZE;
+
+			context->backend->UpdateBuffer( buffer, firstSlot * MATRIX_SIZE, runSize, &matrices[firstSlot] );
+			uploadedSize += runSize;
+
+			std::fill( dirtyPages.begin() + page, dirtyPages.begin() + lastPage + 1, 0 );
+			page = lastPage;
+		}
+
+		dirtyPageCount = 0;
+	}
+
+	if ( ( ++frameIndex % RETIRE_FRAME_COUNT ) == 0 ) {
+		RetireUnusedSlots();
+	}
+
+	return true;
+}
+
+const bool TransformBuffer::UploadInstances( const renderContext_t* context, const uint32_t* slotIndexes, const uint32_t instanceCount )
+{
+	if ( instanceCount == 0 ) {
+		return true;
+	}
+
+	if ( instanceCount > instanceCapacity ) {
+		if ( instanceBuffer != nullptr ) {
+			instanceBuffer->Release();
+			instanceBuffer = nullptr;
+		}
+
+		uint32_t capacity = ( instanceCapacity != 0 ) ? instanceCapacity : PAGE_SIZE;
+
+		while ( capacity < instanceCount ) {
+			capacity <<= 1;
+		}
+
+		const renderBufferDesc_t instanceDesc = {
+			capacity * static_cast<uint32_t>( sizeof( uint32_t ) ),	// uint32_t size
+			RENDER_USAGE_DYNAMIC,									// renderUsage_t usage
+			RENDER_BIND_VERTEX_BUFFER,								// uint32_t bindFlags
+			RENDER_CPU_ACCESS_WRITE,								// uint32_t cpuAccessFlags
+			0,														// uint32_t miscFlags
+			0,														// uint32_t structureStride
+		};
+
+		instanceBuffer = context->backend->CreateBuffer( instanceDesc, nullptr );
+
+		if ( instanceBuffer == nullptr ) {
+			instanceCapacity = 0;
+			return false;
+		}
+
+		instanceCapacity = capacity;
+	}
+
+	void* mappedData = context->backend->MapBuffer( instanceBuffer, RENDER_MAP_WRITE_DISCARD );
+
+	if ( mappedData == nullptr ) {
+		return false;
+	}
+
+	memcpy( mappedData, slotIndexes, instanceCount * sizeof( uint32_t ) );
+	context->backend->UnmapBuffer( instanceBuffer );
+
+	return true;
+}
+
+const bool TransformBuffer::CreateBuffers( const renderContext_t* context, const uint32_t capacity )
+{
+	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
+
+	RELEASE( view )
+	RELEASE( buffer )
+
+	gpuCapacity = 0;
+
+	const renderBufferDesc_t bufferDesc = {
+		capacity * static_cast<uint32_t>( sizeof( DirectX::XMFLOAT4X4 ) ),	// uint32_t size
+		RENDER_USAGE_DEFAULT,												// renderUsage_t usage
+		RENDER_BIND_SHADER_RESOURCE,										// uint32_t bindFlags
+		0,																	// uint32_t cpuAccessFlags
+		RENDER_MISC_BUFFER_STRUCTURED,										// uint32_t miscFlags
+		sizeof( DirectX::XMFLOAT4X4 ),										// uint32_t structureStride
+	};
+
+	buffer = context->backend->CreateBuffer( bufferDesc, nullptr );
+
+	if ( buffer == nullptr ) {
+		return false;
+	}
+
+	// null desc; the view covers the whole structured buffer
+	view = context->backend->CreateShaderResourceView( buffer, nullptr );
+
+	if ( view == nullptr ) {
+		RELEASE( buffer )
+		return false;
+	}
+
+	gpuCapacity = capacity;
+
+	return true;
+}
+
+void TransformBuffer::ReleaseBuffers()
+{
+	RELEASE( view )
+	RELEASE( buffer )
+	RELEASE( instanceBuffer )
+
+	gpuCapacity			= 0;
+	instanceCapacity	= 0;
+}
+
+void TransformBuffer::MarkDirty( const uint32_t slot )
+{
+	uint8_t& isPageDirty = dirtyPages[slot / PAGE_SIZE];
+
+	if ( isPageDirty == 0 ) {
+		isPageDirty = 1;
+		dirtyPageCount++;
+	}
+}
+
+void TransformBuffer::RetireUnusedSlots()
+{
+	// the gpu copy is left as is; a recycled slot is always written before being drawn again
+	for ( uint32_t slot = 0; slot < slots.size(); ++slot ) {
+		slot_t& entry = slots[slot];
+
+		if ( entry.owner == nullptr || entry.lastUsedFrame + RETIRE_FRAME_COUNT > frameIndex ) {
+			continue;
+		}
+
+		ownerSlots.erase( entry.owner );
+		entry.owner = nullptr;
+
+		freeSlots.push_back( slot );
+	}
+}
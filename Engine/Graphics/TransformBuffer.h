@@ -0,0 +1,74 @@
+#pragma once
+
+#include "RenderTypes.h"
+
+#include <Engine/ThirdParty/DirectXTK/Inc/SimpleMath.h>
+
+#include <unordered_map>
+#include <vector>
+
+struct renderContext_t;
+struct transform_t;
+
+// persistent gpu copy of the transforms drawn by the renderer (StructuredBuffer<float4x4>)
+// each transform keeps its slot while it is drawn; the cpu mirror tracks written pages and Upload only sends those
+// slots unused for RETIRE_FRAME_COUNT frames are recycled (owners are only used as keys; they are never dereferenced)
+// the shader reads its slot from the instance stream (see UploadInstances); instanced draws pick their range with the start instance
+// render thread only
+class TransformBuffer
+{
+public:
+	static constexpr uint32_t	INVALID_INDEX = ~0u;
+
+public:
+	inline renderShaderResourceView_t*	GetView() const				{ return view; }
+	inline renderBuffer_t*				GetInstanceBuffer() const	{ return instanceBuffer; } // R32_UINT slot index per instance
+	inline std::size_t					GetInstanceCount() const	{ return slots.size(); }
+	inline uint32_t						GetUploadedSize() const		{ return uploadedSize; } // bytes sent by the last Upload
+
+public:
+								TransformBuffer();
+								TransformBuffer( TransformBuffer& ) = delete;
+								~TransformBuffer() = default;
+
+	const bool					Create( const renderContext_t* context, const uint32_t capacity );
+	void						Destroy();
+
+	uint32_t					Update( const transform_t* owner, const DirectX::XMMATRIX& matrix ); // slot index of the owner
+	const bool					Upload( const renderContext_t* context ); // once per frame, before the draws reading the buffer
+	const bool					UploadInstances( const renderContext_t* context, const uint32_t* slotIndexes, const uint32_t instanceCount ); // discards the previous list
+
+private:
+	static constexpr uint32_t	PAGE_SIZE			= 64; // matrices per dirty page (4KB)
+	static constexpr uint64_t	RETIRE_FRAME_COUNT	= 64;
+
+	struct slot_t
+	{
+		const transform_t*		owner;		// null if free
+		uint64_t				lastUsedFrame;
+	};
+
+private:
+	renderBuffer_t*				buffer;
+	renderShaderResourceView_t*	view;
+	renderBuffer_t*				instanceBuffer;
+	uint32_t					gpuCapacity;		// in matrices
+	uint32_t					instanceCapacity;
+
+	std::vector<DirectX::XMFLOAT4X4>						matrices;	// cpu mirror
+	std::vector<slot_t>										slots;
+	std::vector<uint32_t>									freeSlots;
+	std::unordered_map<const transform_t*, uint32_t>		ownerSlots;
+
+	std::vector<uint8_t>		dirtyPages;
+	std::size_t					dirtyPageCount;
+
+	uint64_t					frameIndex;
+	uint32_t					uploadedSize;
+
+private:
+	const bool					CreateBuffers( const renderContext_t* context, const uint32_t capacity );
+	void						ReleaseBuffers();
+	void						MarkDirty( const uint32_t slot );
+	void						RetireUnusedSlots();
+};
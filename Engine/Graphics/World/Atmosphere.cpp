@@ -1,8 +1,11 @@
 #include "Shared.h"
-#include <d3d11.h>
-#include <d3dcompiler.h>
 #include "Atmosphere.h"
 
+#include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackend.h>
+#include <Engine/Graphics/PipelineStateCache.h>
+#include <Engine/Graphics/ShaderLibrary.h>
+
 Atmosphere::Atmosphere()
     : vertexShader( nullptr )
     , pixelShader( nullptr )
@@ -16,237 +19,209 @@ Atmosphere::~Atmosphere()
 {
 	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
 
-	RELEASE( vertexShader )
-	RELEASE( pixelShader )
 	RELEASE( shaderLayout )
-	RELEASE( samplerState )
+
+	// shaders are owned by the shader library, samplerState by the pipeline state cache
 }
 
-int Atmosphere::Create( ID3D11Device* dev )
+int Atmosphere::Create( const renderContext_t* context )
 {
-    HRESULT result = 0;
-
-    ID3D10Blob*		vertexShaderBuffer = nullptr;
-    ID3D10Blob*		pixelShaderBuffer = nullptr;
-
-    D3DReadFileToBlob( L"base_data/shaders/atmosphere_vs.cso", &vertexShaderBuffer );
-    D3DReadFileToBlob( L"base_data/shaders/atmosphere_ps.cso", &pixelShaderBuffer );
-
-    result = dev->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader );
-    if ( FAILED( result ) ) {
+    vertexShader = context->shaders->GetVertexShader( L"base_data/shaders/atmosphere_vs.cso" );
+    if ( vertexShader == nullptr ) {
         return 1;
     }
 
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader );
-    if ( FAILED( result ) ) {
+    pixelShader = context->shaders->GetPixelShader( L"base_data/shaders/atmosphere_ps.cso" );
+    if ( pixelShader == nullptr ) {
         return 2;
     }
 
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
-
-    D3D11_SAMPLER_DESC samplerDesc = {};
-    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-    samplerDesc.MipLODBias = 0.0f;
-    samplerDesc.MaxAnisotropy = 1;
-    samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-    samplerDesc.BorderColor[0] = 0;
-    samplerDesc.BorderColor[1] = 0;
-    samplerDesc.BorderColor[2] = 0;
-    samplerDesc.BorderColor[3] = 0;
-    samplerDesc.MinLOD = 0;
-    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-
-    result = dev->CreateSamplerState( &samplerDesc, &samplerState );
-    if ( FAILED( result ) ) {
+    renderSamplerDesc_t samplerDesc = {};
+    samplerDesc.filter = RENDER_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.mipLODBias = 0.0f;
+    samplerDesc.maxAnisotropy = 1;
+    samplerDesc.comparisonFunc = RENDER_COMPARISON_ALWAYS;
+    samplerDesc.borderColor[0] = 0;
+    samplerDesc.borderColor[1] = 0;
+    samplerDesc.borderColor[2] = 0;
+    samplerDesc.borderColor[3] = 0;
+    samplerDesc.minLOD = 0;
+    samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+
+    samplerState = context->pipelineStates->GetSamplerState( samplerDesc );
+    if ( samplerState == nullptr ) {
         return 3;
     }
 
-    return Prepare( dev );
+    return Prepare( context->backend );
 }
 
-void Atmosphere::Render( ID3D11DeviceContext* devContext )
+void Atmosphere::Render( RenderBackend* backend )
 {
-    devContext->VSSetShader( vertexShader, NULL, 0 );
-    devContext->PSSetShader( pixelShader, NULL, 0 );
+    backend->SetVertexShader( vertexShader );
+    backend->SetPixelShader( pixelShader );
 
-    devContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
+    backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
 
-    devContext->PSSetShaderResources( 0, 1, &inscatterTex.ressource );
-    devContext->PSSetShaderResources( 1, 1, &irradianceTex.ressource );
-    devContext->PSSetShaderResources( 2, 1, &transmittanceTex.ressource );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &inscatterTex.ressource );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 1, 1, &irradianceTex.ressource );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 2, 1, &transmittanceTex.ressource );
 
-    devContext->PSSetSamplers( 0, 1, &samplerState );
+    backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerState );
 
-    devContext->Draw( 6, 0 );
+    backend->Draw( 6, 0 );
 
-    devContext->PSSetShaderResources( 8, 1, &inscatterTex.ressource );
-    devContext->PSSetShaderResources( 6, 1, &irradianceTex.ressource );
-    devContext->PSSetShaderResources( 7, 1, &transmittanceTex.ressource );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 8, 1, &inscatterTex.ressource );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 6, 1, &irradianceTex.ressource );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 7, 1, &transmittanceTex.ressource );
 }
 
-int Atmosphere::Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContext )
+int Atmosphere::Precompute( const renderContext_t* context )
 {
-	D3D11_VIEWPORT backupViewport = {};
-	UINT viewportCount = 1;
-	devContext->RSGetViewports( &viewportCount, &backupViewport );
+    RenderBackend*          backend         = context->backend;
+    PipelineStateCache*     pipelineStates  = context->pipelineStates;
 
-    ID3D11InputLayout*  shaderLayoutPostFx = nullptr;
+	const renderViewport_t backupViewport = backend->GetViewport();
 
-    ID3D11VertexShader*	vertexShaderPostFx = nullptr;
-    ID3D11PixelShader*	pixelShaderTransmittance = nullptr;
+    renderInputLayout_t*  shaderLayoutPostFx = nullptr;
 
-    ID3D10Blob*		    vertexShaderBuffer = nullptr;
-    ID3D10Blob*		    pixelShaderBuffer = nullptr;
+    renderVertexShader_t*	vertexShaderPostFx = nullptr;
+    renderPixelShader_t*	pixelShaderTransmittance = nullptr;
 
-	ID3D11SamplerState* samplerStateFx = nullptr;
+	renderSamplerState_t* samplerStateFx = nullptr;
 
-    ID3D11BlendState*           d3dBlendState;
+    renderBlendState_t*           d3dBlendState;
 
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.MipLODBias = 0.0f;
-	samplerDesc.MaxAnisotropy = 1;
-	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-	samplerDesc.BorderColor[0] = 0;
-	samplerDesc.BorderColor[1] = 0;
-	samplerDesc.BorderColor[2] = 0;
-	samplerDesc.BorderColor[3] = 0;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.mipLODBias = 0.0f;
+	samplerDesc.maxAnisotropy = 1;
+	samplerDesc.comparisonFunc = RENDER_COMPARISON_ALWAYS;
+	samplerDesc.borderColor[0] = 0;
+	samplerDesc.borderColor[1] = 0;
+	samplerDesc.borderColor[2] = 0;
+	samplerDesc.borderColor[3] = 0;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
 
-	dev->CreateSamplerState( &samplerDesc, &samplerStateFx );
+	// same as the sky sampler; shared through the cache
+	samplerStateFx = pipelineStates->GetSamplerState( samplerDesc );
 
-    D3D11_BUFFER_DESC precomputeBuffer = {};
+    renderBufferDesc_t precomputeBuffer = {};
 
-    precomputeBuffer.Usage = D3D11_USAGE_DYNAMIC;
-    precomputeBuffer.ByteWidth = sizeof( atmospherePrecomputeCbuffer_t );
-    precomputeBuffer.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    precomputeBuffer.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    precomputeBuffer.MiscFlags = 0;
-    precomputeBuffer.StructureByteStride = 0;
+    precomputeBuffer.usage = RENDER_USAGE_DYNAMIC;
+    precomputeBuffer.size = sizeof( atmospherePrecomputeCbuffer_t );
+    precomputeBuffer.bindFlags = RENDER_BIND_CONSTANT_BUFFER;
+    precomputeBuffer.cpuAccessFlags = RENDER_CPU_ACCESS_WRITE;
+    precomputeBuffer.miscFlags = 0;
+    precomputeBuffer.structureStride = 0;
 
-    dev->CreateBuffer( &precomputeBuffer, NULL, &cbuffer );
+    cbuffer = backend->CreateBuffer( precomputeBuffer, nullptr );
 
-    D3D11_VIEWPORT viewport = {
+    renderViewport_t viewport = {
         0.0f,
         0.0f,
-        static_cast<FLOAT>( TRANSMITTANCE_W ),
-        static_cast<FLOAT>( TRANSMITTANCE_H ),
+        static_cast<float>( TRANSMITTANCE_W ),
+        static_cast<float>( TRANSMITTANCE_H ),
         0.0f,
         1.0f,
     };
 
-    FLOAT color[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+    float color[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/postfx_vs.cso", &vertexShaderBuffer );
-    D3DReadFileToBlob( L"base_data/shaders/transmittance_ps.cso", &pixelShaderBuffer );
-
-    HRESULT result = dev->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShaderPostFx );
-    if ( FAILED( result ) ) {
+    vertexShaderPostFx = context->shaders->GetVertexShader( L"base_data/shaders/postfx_vs.cso" );
+    if ( vertexShaderPostFx == nullptr ) {
         return 1;
     }
 
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderTransmittance );
-    if ( FAILED( result ) ) {
+    pixelShaderTransmittance = context->shaders->GetPixelShader( L"base_data/shaders/transmittance_ps.cso" );
+    if ( pixelShaderTransmittance == nullptr ) {
         return 2;
     }
 
-    D3D11_INPUT_ELEMENT_DESC layoutDesc[1] = {};
-    layoutDesc[0].SemanticName = "POSITION";
-    layoutDesc[0].SemanticIndex = 0;
-    layoutDesc[0].Format = DXGI_FORMAT_R32G32_FLOAT;
-    layoutDesc[0].InputSlot = 0;
-    layoutDesc[0].AlignedByteOffset = 0;
-    layoutDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-    layoutDesc[0].InstanceDataStepRate = 0;
+    renderInputElementDesc_t layoutDesc[1] = {};
+    layoutDesc[0].semanticName = "POSITION";
+    layoutDesc[0].semanticIndex = 0;
+    layoutDesc[0].format = RENDER_FORMAT_R32G32_FLOAT;
+    layoutDesc[0].inputSlot = 0;
+    layoutDesc[0].alignedByteOffset = 0;
+    layoutDesc[0].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+    layoutDesc[0].instanceDataStepRate = 0;
 
-    result = dev->CreateInputLayout( layoutDesc, 1, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &shaderLayoutPostFx );
-    if ( FAILED( result ) ) {
+    shaderLayoutPostFx = pipelineStates->GetInputLayout( layoutDesc, 1, L"base_data/shaders/postfx_vs.cso" );
+    if ( shaderLayoutPostFx == nullptr ) {
         return 3;
     }
 
-	pixelShaderBuffer->Release();
-
-    devContext->RSSetViewports( 1, &viewport );
-    devContext->OMSetRenderTargets( 1, &transmittanceTex.view, NULL );
-    devContext->ClearRenderTargetView( transmittanceTex.view, color );
+    backend->SetViewport( viewport );
+    backend->SetRenderTargets( 1, &transmittanceTex.view, NULL );
+    backend->ClearRenderTarget( transmittanceTex.view, color );
 
-    devContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
+    backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
 
-    devContext->IASetInputLayout( shaderLayoutPostFx );
+    backend->SetInputLayout( shaderLayoutPostFx );
 
-    devContext->VSSetShader( vertexShaderPostFx, NULL, 0 );
-    devContext->PSSetShader( pixelShaderTransmittance, NULL, 0 );
+    backend->SetVertexShader( vertexShaderPostFx );
+    backend->SetPixelShader( pixelShaderTransmittance );
 
-    devContext->Draw( 6, 0 );
+    backend->Draw( 6, 0 );
 
 	
 
     //-----------------------------------------------------------------------------------------------------------------
 
-	D3DReadFileToBlob( L"base_data/shaders/irradiance_ps.cso", &pixelShaderBuffer );
-
-	ID3D11PixelShader* pixelShaderIrradiance = nullptr;
-	result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderIrradiance );
-	if ( FAILED( result ) ) {
+	renderPixelShader_t* pixelShaderIrradiance = context->shaders->GetPixelShader( L"base_data/shaders/irradiance_ps.cso" );
+	if ( pixelShaderIrradiance == nullptr ) {
 		return 2;
 	}
-
-	pixelShaderBuffer->Release();
 	
-	viewport.Width = SKY_W;
-	viewport.Height = SKY_H;
+	viewport.width = SKY_W;
+	viewport.height = SKY_H;
 
-	devContext->RSSetViewports( 1, &viewport );
-	devContext->OMSetRenderTargets( 1, &deltaETex.view, NULL );
-	devContext->ClearRenderTargetView( deltaETex.view, color );
+	backend->SetViewport( viewport );
+	backend->SetRenderTargets( 1, &deltaETex.view, NULL );
+	backend->ClearRenderTarget( deltaETex.view, color );
 
-	devContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
+	backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
 
-	devContext->PSSetShader( pixelShaderIrradiance, NULL, 0 );
-	devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-	devContext->PSSetShaderResources( 0, 1, &transmittanceTex.ressource );
+	backend->SetPixelShader( pixelShaderIrradiance );
+	backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+	backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &transmittanceTex.ressource );
 
-	devContext->Draw( 6, 0 );
+	backend->Draw( 6, 0 );
 
 	
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/inscatter1_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderInscatter = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderInscatter );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderInscatter = context->shaders->GetPixelShader( L"base_data/shaders/inscatter1_ps.cso" );
+    if ( pixelShaderInscatter == nullptr ) {
         return 2;
     }
 
-	pixelShaderBuffer->Release();
+    viewport.width = RES_MU_S * RES_NU;
+    viewport.height = RES_MU;
 
-    viewport.Width = RES_MU_S * RES_NU;
-    viewport.Height = RES_MU;
-
-    devContext->RSSetViewports( 1, &viewport );
-    devContext->PSSetShader( pixelShaderInscatter, NULL, 0 );
-    devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-    devContext->PSSetShaderResources( 0, 1, &transmittanceTex.ressource );
+    backend->SetViewport( viewport );
+    backend->SetPixelShader( pixelShaderInscatter );
+    backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &transmittanceTex.ressource );
 
     for ( int i = 0; i < RES_R; ++i ) {
-        ID3D11RenderTargetView* rt[2] = { deltaSRRtV[i], deltaSMRtV[i] };
+        renderTargetView_t* rt[2] = { deltaSRRtV[i], deltaSMRtV[i] };
 
-        devContext->OMSetRenderTargets( 2, rt, NULL );
+        backend->SetRenderTargets( 2, rt, NULL );
 
-        devContext->ClearRenderTargetView( deltaSRRtV[i], color );
-        devContext->ClearRenderTargetView( deltaSMRtV[i], color );
+        backend->ClearRenderTarget( deltaSRRtV[i], color );
+        backend->ClearRenderTarget( deltaSMRtV[i], color );
 
         float r = i / ( RES_R - 1.0f );
         r = r * r;
@@ -260,66 +235,56 @@ int Atmosphere::Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContext )
         dhdH = DirectX::XMFLOAT4( float( dmin ), float( dmax ), float( dminp ), float( dmaxp ) );
         precomputeData.layer = i;
 
-        UpdatePrecomputeCBuffer( devContext );
+        UpdatePrecomputeCBuffer( backend );
 
-        devContext->Draw( 6, 0 );
+        backend->Draw( 6, 0 );
         
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/copyirradiance_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderCopyIrradiance = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderCopyIrradiance );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderCopyIrradiance = context->shaders->GetPixelShader( L"base_data/shaders/copyirradiance_ps.cso" );
+    if ( pixelShaderCopyIrradiance == nullptr ) {
         return 2;
     }
-
-	pixelShaderBuffer->Release();
 	
-    viewport.Width = SKY_W;
-    viewport.Height = SKY_H;
+    viewport.width = SKY_W;
+    viewport.height = SKY_H;
 
-    devContext->RSSetViewports( 1, &viewport );
-    devContext->PSSetShader( pixelShaderCopyIrradiance, NULL, 0 );
-    devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-    devContext->PSSetShaderResources( 0, 1, &deltaETex.ressource );
+    backend->SetViewport( viewport );
+    backend->SetPixelShader( pixelShaderCopyIrradiance );
+    backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+    backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &deltaETex.ressource );
 
-    devContext->OMSetRenderTargets( 1, &irradianceTex.view, NULL );
-    devContext->ClearRenderTargetView( irradianceTex.view, color );
+    backend->SetRenderTargets( 1, &irradianceTex.view, NULL );
+    backend->ClearRenderTarget( irradianceTex.view, color );
 
     precomputeData.k = 0.0f;
-    UpdatePrecomputeCBuffer( devContext );
+    UpdatePrecomputeCBuffer( backend );
 
-    devContext->Draw( 6, 0 );
+    backend->Draw( 6, 0 );
     
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/copyinscatter_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderCopyInscatter = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderCopyInscatter );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderCopyInscatter = context->shaders->GetPixelShader( L"base_data/shaders/copyinscatter_ps.cso" );
+    if ( pixelShaderCopyInscatter == nullptr ) {
         return 2;
     }
 
-	pixelShaderBuffer->Release();
-
-    viewport.Width = RES_MU_S * RES_NU;
-    viewport.Height = RES_MU;
+    viewport.width = RES_MU_S * RES_NU;
+    viewport.height = RES_MU;
 
-    devContext->RSSetViewports( 1, &viewport );
-    devContext->PSSetShader( pixelShaderCopyInscatter, NULL, 0 );
-    devContext->PSSetSamplers( 0, 1, &samplerStateFx );
+    backend->SetViewport( viewport );
+    backend->SetPixelShader( pixelShaderCopyInscatter );
+    backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
 
     for ( int i = 0; i < RES_R; ++i ) {
-        devContext->OMSetRenderTargets( 1, &inscatterRtV[i], NULL );
-        devContext->ClearRenderTargetView( inscatterRtV[i], color );
+        backend->SetRenderTargets( 1, &inscatterRtV[i], NULL );
+        backend->ClearRenderTarget( inscatterRtV[i], color );
 
-        devContext->PSSetShaderResources( 0, 1, &deltaSRTex.ressource );
-        devContext->PSSetShaderResources( 1, 1, &deltaSMTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &deltaSRTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 1, 1, &deltaSMTex.ressource );
         double r = i / ( RES_R - 1.0 );
         r = r * r;
         r = sqrt( Rg * Rg + r * ( Rt * Rt - Rg * Rg ) ) + ( i == 0 ? 0.01 : ( i == RES_R - 1 ? -0.001 : 0.0 ) );
@@ -332,97 +297,77 @@ int Atmosphere::Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContext )
         dhdH = DirectX::XMFLOAT4( float( dmin ), float( dmax ), float( dminp ), float( dmaxp ) );
         precomputeData.layer = i;
 
-        UpdatePrecomputeCBuffer( devContext );
+        UpdatePrecomputeCBuffer( backend );
 
-        devContext->Draw( 6, 0 );
+        backend->Draw( 6, 0 );
         
     }
 
     //-----------------------------------------------------------------------------------------------------------------
    
-    D3DReadFileToBlob( L"base_data/shaders/inscatterS_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderCopyInscatterS = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderCopyInscatterS );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderCopyInscatterS = context->shaders->GetPixelShader( L"base_data/shaders/inscatterS_ps.cso" );
+    if ( pixelShaderCopyInscatterS == nullptr ) {
         return 2;
     }
 
-	pixelShaderBuffer->Release();
-
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/irradianceN_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderirradianceN = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderirradianceN );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderirradianceN = context->shaders->GetPixelShader( L"base_data/shaders/irradianceN_ps.cso" );
+    if ( pixelShaderirradianceN == nullptr ) {
         return 2;
     }
 
-    pixelShaderBuffer->Release();
-
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/inscatterN_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderinscatterN = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderinscatterN );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderinscatterN = context->shaders->GetPixelShader( L"base_data/shaders/inscatterN_ps.cso" );
+    if ( pixelShaderinscatterN == nullptr ) {
         return 2;
     }
 
-    pixelShaderBuffer->Release();
-
     //-----------------------------------------------------------------------------------------------------------------
 
-    D3DReadFileToBlob( L"base_data/shaders/copyinscatterN_ps.cso", &pixelShaderBuffer );
-
-    ID3D11PixelShader* pixelShaderCopyInscatterN = nullptr;
-    result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShaderCopyInscatterN );
-    if ( FAILED( result ) ) {
+    renderPixelShader_t* pixelShaderCopyInscatterN = context->shaders->GetPixelShader( L"base_data/shaders/copyinscatterN_ps.cso" );
+    if ( pixelShaderCopyInscatterN == nullptr ) {
         return 2;
     }
-
-    pixelShaderBuffer->Release();
         
-    D3D11_BLEND_DESC omDesc;
-    ZeroMemory( &omDesc, sizeof( D3D11_BLEND_DESC ) );
-    omDesc.RenderTarget[0].BlendEnable = true;
-    omDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
-    omDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
-    omDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-    omDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
-    omDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
-    omDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-    omDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+    renderBlendDesc_t omDesc = {};
+    omDesc.renderTarget[0].blendEnable = 1;
+    omDesc.renderTarget[0].srcBlend = RENDER_BLEND_ONE;
+    omDesc.renderTarget[0].destBlend = RENDER_BLEND_ONE;
+    omDesc.renderTarget[0].blendOp = RENDER_BLEND_OP_ADD;
+    omDesc.renderTarget[0].srcBlendAlpha = RENDER_BLEND_ONE;
+    omDesc.renderTarget[0].destBlendAlpha = RENDER_BLEND_ONE;
+    omDesc.renderTarget[0].blendOpAlpha = RENDER_BLEND_OP_ADD;
+    omDesc.renderTarget[0].writeMask = RENDER_COLOR_WRITE_ENABLE_ALL;
 
 
-    if ( FAILED( dev->CreateBlendState( &omDesc, &d3dBlendState ) ) ) return -2;
+    d3dBlendState = pipelineStates->GetBlendState( omDesc );
+    if ( d3dBlendState == nullptr ) return -2;
 
     // loop for each scattering order (line 6 in algorithm 4.1)
     for ( int order = 2; order <= 4; ++order ) {
         // computes deltaJ (line 7 in algorithm 4.1)
         //-----------------------------------------------------------------------------------------------------------------
    
-        viewport.Width = RES_MU_S * RES_NU;
-        viewport.Height = RES_MU;
+        viewport.width = RES_MU_S * RES_NU;
+        viewport.height = RES_MU;
 
-        devContext->RSSetViewports( 1, &viewport );
-        devContext->PSSetShader( pixelShaderCopyInscatterS, NULL, 0 );
+        backend->SetViewport( viewport );
+        backend->SetPixelShader( pixelShaderCopyInscatterS );
 
-        devContext->PSSetShaderResources( 0, 1, &deltaETex.ressource );
-        devContext->PSSetShaderResources( 1, 1, &deltaSRTex.ressource );
-        devContext->PSSetShaderResources( 2, 1, &deltaSMTex.ressource );
-        devContext->PSSetShaderResources( 3, 1, &transmittanceTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &deltaETex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 1, 1, &deltaSRTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 2, 1, &deltaSMTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 3, 1, &transmittanceTex.ressource );
 
-		devContext->PSSetSamplers( 0, 1, &samplerStateFx );
+		backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
 
         precomputeData.first = order == 2 ? 1.0f : 0.0f;   
-        UpdatePrecomputeCBuffer( devContext );
+        UpdatePrecomputeCBuffer( backend );
 
         for ( int i = 0; i < RES_R; ++i ) {
-            devContext->OMSetRenderTargets( 1, &deltaJRtV[i], NULL );
+            backend->SetRenderTargets( 1, &deltaJRtV[i], NULL );
 
             double r = i / ( RES_R - 1.0 );
             r = r * r;
@@ -436,44 +381,44 @@ int Atmosphere::Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContext )
             dhdH = DirectX::XMFLOAT4( float( dmin ), float( dmax ), float( dminp ), float( dmaxp ) );
             precomputeData.layer = i;
 
-            UpdatePrecomputeCBuffer( devContext );
+            UpdatePrecomputeCBuffer( backend );
 
-            devContext->Draw( 6, 0 );
+            backend->Draw( 6, 0 );
             
         }
 
         // computes deltaE (line 8 in algorithm 4.1)
         //-----------------------------------------------------------------------------------------------------------------
-        viewport.Width = SKY_W;
-        viewport.Height = SKY_H;
+        viewport.width = SKY_W;
+        viewport.height = SKY_H;
 
-        devContext->RSSetViewports( 1, &viewport );
-        devContext->PSSetShader( pixelShaderirradianceN, NULL, 0 );
+        backend->SetViewport( viewport );
+        backend->SetPixelShader( pixelShaderirradianceN );
 
-		devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-        devContext->PSSetShaderResources( 0, 1, &deltaSRTex.ressource );
-        devContext->PSSetShaderResources( 1, 1, &deltaSMTex.ressource );
-        devContext->PSSetShaderResources( 2, 1, &transmittanceTex.ressource );
+		backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &deltaSRTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 1, 1, &deltaSMTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 2, 1, &transmittanceTex.ressource );
 
-        devContext->OMSetRenderTargets( 1, &deltaETex.view, NULL );
+        backend->SetRenderTargets( 1, &deltaETex.view, NULL );
 
-        devContext->Draw( 6, 0 );
+        backend->Draw( 6, 0 );
         
 
         // computes deltaS (line 9 in algorithm 4.1)
         //-----------------------------------------------------------------------------------------------------------------
-        viewport.Width = RES_MU_S * RES_NU;
-        viewport.Height = RES_MU;
+        viewport.width = RES_MU_S * RES_NU;
+        viewport.height = RES_MU;
 
-        devContext->RSSetViewports( 1, &viewport );
-        devContext->PSSetShader( pixelShaderinscatterN, NULL, 0 );
+        backend->SetViewport( viewport );
+        backend->SetPixelShader( pixelShaderinscatterN );
 
-		devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-        devContext->PSSetShaderResources( 0, 1, &transmittanceTex.ressource );
-        devContext->PSSetShaderResources( 1, 1, &deltaJTex.ressource );
+		backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &transmittanceTex.ressource );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 1, 1, &deltaJTex.ressource );
 
         for ( int i = 0; i < RES_R; ++i ) {
-            devContext->OMSetRenderTargets( 1, &deltaSRRtV[i], NULL );
+            backend->SetRenderTargets( 1, &deltaSRRtV[i], NULL );
 
             double r = i / ( RES_R - 1.0 );
             r = r * r;
@@ -487,46 +432,46 @@ int Atmosphere::Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContext )
             dhdH = DirectX::XMFLOAT4( float( dmin ), float( dmax ), float( dminp ), float( dmaxp ) );
             precomputeData.layer = i;
 
-            UpdatePrecomputeCBuffer( devContext );
+            UpdatePrecomputeCBuffer( backend );
 
-            devContext->Draw( 6, 0 );
+            backend->Draw( 6, 0 );
             
         }
 
-        devContext->OMSetBlendState( d3dBlendState, 0, 0xffffffff );
+        backend->SetBlendState( d3dBlendState );
 
         // adds deltaE into irradiance texture E (line 10 in algorithm 4.1)
         //-----------------------------------------------------------------------------------------------------------------
-        viewport.Width = SKY_W;
-        viewport.Height = SKY_H;
+        viewport.width = SKY_W;
+        viewport.height = SKY_H;
 
-        devContext->RSSetViewports( 1, &viewport );
-        devContext->PSSetShader( pixelShaderCopyIrradiance, NULL, 0 );
+        backend->SetViewport( viewport );
+        backend->SetPixelShader( pixelShaderCopyIrradiance );
 
-		devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-        devContext->PSSetShaderResources( 0, 1, &deltaETex.ressource );
-        devContext->OMSetRenderTargets( 1, &irradianceTex.view, NULL );
+		backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &deltaETex.ressource );
+        backend->SetRenderTargets( 1, &irradianceTex.view, NULL );
 
         precomputeData.k = 1.0f;
 
-        UpdatePrecomputeCBuffer( devContext );
+        UpdatePrecomputeCBuffer( backend );
 
-        devContext->Draw( 6, 0 );
+        backend->Draw( 6, 0 );
         
 
         // adds deltaS into inscatter texture S (line 11 in algorithm 4.1)
         //-----------------------------------------------------------------------------------------------------------------
-        viewport.Width = RES_MU_S * RES_NU;
-        viewport.Height = RES_MU;
+        viewport.width = RES_MU_S * RES_NU;
+        viewport.height = RES_MU;
 
-        devContext->RSSetViewports( 1, &viewport );
-        devContext->PSSetShader( pixelShaderCopyInscatterN, NULL, 0 );
+        backend->SetViewport( viewport );
+        backend->SetPixelShader( pixelShaderCopyInscatterN );
 
-		devContext->PSSetSamplers( 0, 1, &samplerStateFx );
-        devContext->PSSetShaderResources( 0, 1, &deltaSRTex.ressource );
+		backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerStateFx );
+        backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &deltaSRTex.ressource );
 
         for ( int i = 0; i < RES_R; ++i ) {
-            devContext->OMSetRenderTargets( 1, &inscatterRtV[i], NULL );
+            backend->SetRenderTargets( 1, &inscatterRtV[i], NULL );
 
             double r = i / ( RES_R - 1.0 );
             r = r * r;
@@ -540,341 +485,339 @@ int Atmosphere::Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContext )
             dhdH = DirectX::XMFLOAT4( float( dmin ), float( dmax ), float( dminp ), float( dmaxp ) );
             precomputeData.layer = i;
 
-            UpdatePrecomputeCBuffer( devContext );
+            UpdatePrecomputeCBuffer( backend );
 
-            devContext->Draw( 6, 0 );
+            backend->Draw( 6, 0 );
             
         }
 
-        devContext->OMSetBlendState( nullptr, 0, 0xffffffff );
+        backend->SetBlendState( nullptr );
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-	pixelShaderCopyIrradiance->Release();
-	pixelShaderInscatter->Release();
-    pixelShaderTransmittance->Release();
-    pixelShaderIrradiance->Release();
-	vertexShaderBuffer->Release();
-    shaderLayoutPostFx->Release();
-
-	devContext->RSSetViewports( 1, &backupViewport );
+	backend->SetViewport( backupViewport );
 	
 	return 0;
 }
 
-int Atmosphere::Prepare( ID3D11Device* dev )
+int Atmosphere::Prepare( RenderBackend* backend )
 {
-    D3D11_RENDER_TARGET_VIEW_DESC   renderTargetViewDesc;
-    renderTargetViewDesc.ViewDimension      = D3D11_RTV_DIMENSION_TEXTURE2D;
-    renderTargetViewDesc.Texture2D.MipSlice = 0;
-    renderTargetViewDesc.Texture3D.MipSlice = 0;
-
-    D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
-    shaderResourceViewDesc.ViewDimension                = D3D11_SRV_DIMENSION_TEXTURE2D;
-    shaderResourceViewDesc.Texture2D.MostDetailedMip    = 0;
-    shaderResourceViewDesc.Texture2D.MipLevels          = -1;
-    shaderResourceViewDesc.Texture3D.MostDetailedMip    = 0;
-    shaderResourceViewDesc.Texture3D.MipLevels          = -1;
+    renderViewDesc_t                renderTargetViewDesc = {};
+    renderTargetViewDesc.dimension  = RENDER_VIEW_DIMENSION_TEXTURE2D;
+    renderTargetViewDesc.mipSlice   = 0;
+
+    renderViewDesc_t shaderResourceViewDesc = {};
+    shaderResourceViewDesc.dimension                    = RENDER_VIEW_DIMENSION_TEXTURE2D;
+    shaderResourceViewDesc.mostDetailedMip              = 0;
+    shaderResourceViewDesc.mipLevels                    = ~0u;
 
     // precompute ressources required by Bruneton's skymodel
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE2D_DESC transmittanceDesc = {
+    const renderTextureDesc_t transmittanceDesc = {
+        RENDER_TEXTURE_DIMENSION_2D,
         TRANSMITTANCE_W,
         TRANSMITTANCE_H,
         1,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        {																					// DXGI_SAMPLE_DESC SampleDesc
-            1,																				//		UINT Count
-            0,																				//		UINT Quality
-        },
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
 
-    renderTargetViewDesc.Format = transmittanceDesc.Format;
-    shaderResourceViewDesc.Format = transmittanceDesc.Format;
+    renderTargetViewDesc.format = transmittanceDesc.format;
+    shaderResourceViewDesc.format = transmittanceDesc.format;
 
-    HRESULT result = dev->CreateTexture2D( &transmittanceDesc, nullptr, &transmittanceTex.tex2D );
-    if ( FAILED( result ) ) {
+    transmittanceTex.texture = backend->CreateTexture( transmittanceDesc );
+    if ( transmittanceTex.texture == nullptr ) {
         return 1;
     }
 
-    if ( FAILED( dev->CreateRenderTargetView( transmittanceTex.tex2D, &renderTargetViewDesc, &transmittanceTex.view ) ) ) {
+    transmittanceTex.view = backend->CreateRenderTargetView( transmittanceTex.texture, &renderTargetViewDesc );
+    if ( transmittanceTex.view == nullptr ) {
         return 2;
     }
 
-    if ( FAILED( dev->CreateShaderResourceView( transmittanceTex.tex2D, &shaderResourceViewDesc, &transmittanceTex.ressource ) ) ) {
+    transmittanceTex.ressource = backend->CreateShaderResourceView( transmittanceTex.texture, &shaderResourceViewDesc );
+    if ( transmittanceTex.ressource == nullptr ) {
         return 3;
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE2D_DESC irradianceDesc = {
+    const renderTextureDesc_t irradianceDesc = {
+        RENDER_TEXTURE_DIMENSION_2D,
         SKY_W,
         SKY_H,
         1,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        {																					// DXGI_SAMPLE_DESC SampleDesc
-            1,																				//		UINT Count
-            0,																				//		UINT Quality
-        },
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
 
-    renderTargetViewDesc.Format = irradianceDesc.Format;
-    shaderResourceViewDesc.Format = irradianceDesc.Format;
+    renderTargetViewDesc.format = irradianceDesc.format;
+    shaderResourceViewDesc.format = irradianceDesc.format;
 
-    if ( FAILED( dev->CreateTexture2D( &irradianceDesc, nullptr, &irradianceTex.tex2D ) ) ) {
+    irradianceTex.texture = backend->CreateTexture( irradianceDesc );
+    if ( irradianceTex.texture == nullptr ) {
         return 4;
     }
 
-    if ( FAILED( dev->CreateRenderTargetView( irradianceTex.tex2D, &renderTargetViewDesc, &irradianceTex.view ) ) ) {
+    irradianceTex.view = backend->CreateRenderTargetView( irradianceTex.texture, &renderTargetViewDesc );
+    if ( irradianceTex.view == nullptr ) {
         return 5;
     }
 
-    if ( FAILED( dev->CreateShaderResourceView( irradianceTex.tex2D, &shaderResourceViewDesc, &irradianceTex.ressource ) ) ) {
+    irradianceTex.ressource = backend->CreateShaderResourceView( irradianceTex.texture, &shaderResourceViewDesc );
+    if ( irradianceTex.ressource == nullptr ) {
         return 6;
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE3D_DESC inscatterDesc = {
+    const renderTextureDesc_t inscatterDesc = {
+        RENDER_TEXTURE_DIMENSION_3D,
         RES_MU_S * RES_NU,
         RES_MU,
         RES_R,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
 
-    shaderResourceViewDesc.Format = inscatterDesc.Format;
-    shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE3D;
+    shaderResourceViewDesc.format = inscatterDesc.format;
+    shaderResourceViewDesc.dimension = RENDER_VIEW_DIMENSION_TEXTURE3D;
 
-    if ( FAILED( dev->CreateTexture3D( &inscatterDesc, nullptr, &inscatterTex.tex3D ) ) ) {
+    inscatterTex.texture = backend->CreateTexture( inscatterDesc );
+    if ( inscatterTex.texture == nullptr ) {
         return 7;
     }
 
-    if ( FAILED( dev->CreateShaderResourceView( inscatterTex.tex3D, &shaderResourceViewDesc, &inscatterTex.ressource ) ) ) {
+    inscatterTex.ressource = backend->CreateShaderResourceView( inscatterTex.texture, &shaderResourceViewDesc );
+    if ( inscatterTex.ressource == nullptr ) {
         return 9;
     }
 
-    D3D11_RENDER_TARGET_VIEW_DESC inscatterRt[RES_R] = {};
+    renderViewDesc_t inscatterRt[RES_R] = {};
     for ( int i = 0; i < RES_R; ++i ) {
-        inscatterRt[i].ViewDimension            = D3D11_RTV_DIMENSION_TEXTURE3D;
-        inscatterRt[i].Format                   = inscatterDesc.Format;
-        inscatterRt[i].Texture3D.MipSlice       = 0;
-        inscatterRt[i].Texture3D.FirstWSlice    = i;
-        inscatterRt[i].Texture3D.WSize          = 1;
-
-        result = dev->CreateRenderTargetView( inscatterTex.tex3D, &inscatterRt[i], &inscatterRtV[i] );
-        if ( FAILED( result ) ) {
+        inscatterRt[i].dimension                = RENDER_VIEW_DIMENSION_TEXTURE3D;
+        inscatterRt[i].format                   = inscatterDesc.format;
+        inscatterRt[i].mipSlice                 = 0;
+        inscatterRt[i].firstSlice               = i;
+        inscatterRt[i].sliceCount               = 1;
+
+        inscatterRtV[i] = backend->CreateRenderTargetView( inscatterTex.texture, &inscatterRt[i] );
+        if ( inscatterRtV[i] == nullptr ) {
             return 8;
         }
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE2D_DESC deltaEDesc = {
+    const renderTextureDesc_t deltaEDesc = {
+        RENDER_TEXTURE_DIMENSION_2D,
         SKY_W,
         SKY_H,
         1,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        {																					// DXGI_SAMPLE_DESC SampleDesc
-            1,																				//		UINT Count
-            0,																				//		UINT Quality
-        },
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
 
-    renderTargetViewDesc.Format = irradianceDesc.Format;
-    renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+    renderTargetViewDesc.format = irradianceDesc.format;
+    renderTargetViewDesc.dimension = RENDER_VIEW_DIMENSION_TEXTURE2D;
 
-    shaderResourceViewDesc.Format = irradianceDesc.Format;
-    shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    shaderResourceViewDesc.format = irradianceDesc.format;
+    shaderResourceViewDesc.dimension = RENDER_VIEW_DIMENSION_TEXTURE2D;
 
-    if ( FAILED( dev->CreateTexture2D( &deltaEDesc, nullptr, &deltaETex.tex2D ) ) ) {
+    deltaETex.texture = backend->CreateTexture( deltaEDesc );
+    if ( deltaETex.texture == nullptr ) {
         return 10;
     }
 
-    if ( FAILED( dev->CreateRenderTargetView( deltaETex.tex2D, &renderTargetViewDesc, &deltaETex.view ) ) ) {
+    deltaETex.view = backend->CreateRenderTargetView( deltaETex.texture, &renderTargetViewDesc );
+    if ( deltaETex.view == nullptr ) {
         return 11;
     }
 
-    if ( FAILED( dev->CreateShaderResourceView( deltaETex.tex2D, &shaderResourceViewDesc, &deltaETex.ressource ) ) ) {
+    deltaETex.ressource = backend->CreateShaderResourceView( deltaETex.texture, &shaderResourceViewDesc );
+    if ( deltaETex.ressource == nullptr ) {
         return 12;
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE3D_DESC deltaSRDesc = {
-        RES_MU_S * RES_NU, 
-        RES_MU, 
+    const renderTextureDesc_t deltaSRDesc = {
+        RENDER_TEXTURE_DIMENSION_3D,
+        RES_MU_S * RES_NU,
+        RES_MU,
         RES_R,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
 
-    renderTargetViewDesc.Format = deltaSRDesc.Format;
-    renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
+    renderTargetViewDesc.format = deltaSRDesc.format;
+    renderTargetViewDesc.dimension = RENDER_VIEW_DIMENSION_TEXTURE3D;
 
-    shaderResourceViewDesc.Format = deltaSRDesc.Format;
-    shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE3D;
+    shaderResourceViewDesc.format = deltaSRDesc.format;
+    shaderResourceViewDesc.dimension = RENDER_VIEW_DIMENSION_TEXTURE3D;
 
-    if ( FAILED( dev->CreateTexture3D( &deltaSRDesc, nullptr, &deltaSRTex.tex3D ) ) ) {
+    deltaSRTex.texture = backend->CreateTexture( deltaSRDesc );
+    if ( deltaSRTex.texture == nullptr ) {
         return 13;
     }
 
-    D3D11_RENDER_TARGET_VIEW_DESC deltaSRRtDesc[RES_R] = {};
+    renderViewDesc_t deltaSRRtDesc[RES_R] = {};
     for ( int i = 0; i < RES_R; ++i ) {
-        deltaSRRtDesc[i].ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
-        deltaSRRtDesc[i].Format = deltaSRDesc.Format;
-        deltaSRRtDesc[i].Texture3D.MipSlice = 0;
-        deltaSRRtDesc[i].Texture3D.FirstWSlice = i;
-        deltaSRRtDesc[i].Texture3D.WSize = 1;
-
-        result = dev->CreateRenderTargetView( deltaSRTex.tex3D, &deltaSRRtDesc[i], &deltaSRRtV[i] );
-        if ( FAILED( result ) ) {
+        deltaSRRtDesc[i].dimension = RENDER_VIEW_DIMENSION_TEXTURE3D;
+        deltaSRRtDesc[i].format = deltaSRDesc.format;
+        deltaSRRtDesc[i].mipSlice = 0;
+        deltaSRRtDesc[i].firstSlice = i;
+        deltaSRRtDesc[i].sliceCount = 1;
+
+        deltaSRRtV[i] = backend->CreateRenderTargetView( deltaSRTex.texture, &deltaSRRtDesc[i] );
+        if ( deltaSRRtV[i] == nullptr ) {
             return 8;
         }
     }
 
-    if ( FAILED( dev->CreateShaderResourceView( deltaSRTex.tex3D, &shaderResourceViewDesc, &deltaSRTex.ressource ) ) ) {
+    deltaSRTex.ressource = backend->CreateShaderResourceView( deltaSRTex.texture, &shaderResourceViewDesc );
+    if ( deltaSRTex.ressource == nullptr ) {
         return 15;
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE3D_DESC deltaSMDesc = {
-        RES_MU_S * RES_NU, 
-        RES_MU, 
+    const renderTextureDesc_t deltaSMDesc = {
+        RENDER_TEXTURE_DIMENSION_3D,
+        RES_MU_S * RES_NU,
+        RES_MU,
         RES_R,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
 
-    renderTargetViewDesc.Format = deltaSMDesc.Format;
-    shaderResourceViewDesc.Format = deltaSMDesc.Format;
+    renderTargetViewDesc.format = deltaSMDesc.format;
+    shaderResourceViewDesc.format = deltaSMDesc.format;
 
-    if ( FAILED( dev->CreateTexture3D( &deltaSMDesc, nullptr, &deltaSMTex.tex3D ) ) ) {
+    deltaSMTex.texture = backend->CreateTexture( deltaSMDesc );
+    if ( deltaSMTex.texture == nullptr ) {
         return 13;
     }
 
-    D3D11_RENDER_TARGET_VIEW_DESC deltaSMRtDesc[RES_R] = {};
+    renderViewDesc_t deltaSMRtDesc[RES_R] = {};
     for ( int i = 0; i < RES_R; ++i ) {
-        deltaSMRtDesc[i].ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
-        deltaSMRtDesc[i].Format = deltaSMDesc.Format;
-        deltaSMRtDesc[i].Texture3D.MipSlice = 0;
-        deltaSMRtDesc[i].Texture3D.FirstWSlice = i;
-        deltaSMRtDesc[i].Texture3D.WSize = 1;
-
-        result = dev->CreateRenderTargetView( deltaSMTex.tex3D, &deltaSMRtDesc[i], &deltaSMRtV[i] );
-        if ( FAILED( result ) ) {
+        deltaSMRtDesc[i].dimension = RENDER_VIEW_DIMENSION_TEXTURE3D;
+        deltaSMRtDesc[i].format = deltaSMDesc.format;
+        deltaSMRtDesc[i].mipSlice = 0;
+        deltaSMRtDesc[i].firstSlice = i;
+        deltaSMRtDesc[i].sliceCount = 1;
+
+        deltaSMRtV[i] = backend->CreateRenderTargetView( deltaSMTex.texture, &deltaSMRtDesc[i] );
+        if ( deltaSMRtV[i] == nullptr ) {
             return 8;
         }
     }
 
-    if ( FAILED( dev->CreateShaderResourceView( deltaSMTex.tex3D, &shaderResourceViewDesc, &deltaSMTex.ressource ) ) ) {
+    deltaSMTex.ressource = backend->CreateShaderResourceView( deltaSMTex.texture, &shaderResourceViewDesc );
+    if ( deltaSMTex.ressource == nullptr ) {
         return 15;
     }
 
     //-----------------------------------------------------------------------------------------------------------------
 
-    const D3D11_TEXTURE3D_DESC deltaJDesc = {
-        RES_MU_S * RES_NU, 
-        RES_MU, 
+    const renderTextureDesc_t deltaJDesc = {
+        RENDER_TEXTURE_DIMENSION_3D,
+        RES_MU_S * RES_NU,
+        RES_MU,
         RES_R,
         1,
-        DXGI_FORMAT_R16G16B16A16_FLOAT,
-        D3D11_USAGE_DEFAULT,
-        D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE,
+        1,
+        RENDER_FORMAT_R16G16B16A16_FLOAT,
+        1,
+        RENDER_USAGE_DEFAULT,
+        RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE,
         0,
         0,
     };
     
-    renderTargetViewDesc.Format = deltaJDesc.Format;
-    shaderResourceViewDesc.Format = deltaJDesc.Format;
+    renderTargetViewDesc.format = deltaJDesc.format;
+    shaderResourceViewDesc.format = deltaJDesc.format;
 
-    if ( FAILED( dev->CreateTexture3D( &deltaJDesc, nullptr, &deltaJTex.tex3D ) ) ) {
+    deltaJTex.texture = backend->CreateTexture( deltaJDesc );
+    if ( deltaJTex.texture == nullptr ) {
         return 16;
     }
 
-    D3D11_RENDER_TARGET_VIEW_DESC deltaJRtDesc[RES_R] = {};
+    renderViewDesc_t deltaJRtDesc[RES_R] = {};
     for ( int i = 0; i < RES_R; ++i ) {
-        deltaJRtDesc[i].ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
-        deltaJRtDesc[i].Format = deltaJDesc.Format;
-        deltaJRtDesc[i].Texture3D.MipSlice = 0;
-        deltaJRtDesc[i].Texture3D.FirstWSlice = i;
-        deltaJRtDesc[i].Texture3D.WSize = 1;
-
-        result = dev->CreateRenderTargetView( deltaJTex.tex3D, &deltaJRtDesc[i], &deltaJRtV[i] );
-        if ( FAILED( result ) ) {
+        deltaJRtDesc[i].dimension = RENDER_VIEW_DIMENSION_TEXTURE3D;
+        deltaJRtDesc[i].format = deltaJDesc.format;
+        deltaJRtDesc[i].mipSlice = 0;
+        deltaJRtDesc[i].firstSlice = i;
+        deltaJRtDesc[i].sliceCount = 1;
+
+        deltaJRtV[i] = backend->CreateRenderTargetView( deltaJTex.texture, &deltaJRtDesc[i] );
+        if ( deltaJRtV[i] == nullptr ) {
             return 8;
         }
     }
 
 
-    if ( FAILED( dev->CreateShaderResourceView( deltaJTex.tex3D, &shaderResourceViewDesc, &deltaJTex.ressource ) ) ) {
+    deltaJTex.ressource = backend->CreateShaderResourceView( deltaJTex.texture, &shaderResourceViewDesc );
+    if ( deltaJTex.ressource == nullptr ) {
         return 18;
     }
 
-    //-----------------------------------------------------------------------------------------------------------------
-
-	#ifdef _DEBUG
-		transmittanceTex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "Transmittance" ), "Transmittance" );
-		irradianceTex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "irradiance" ), "irradiance" );
-		inscatterTex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "inscatter" ), "inscatter" );
-		deltaETex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "deltaE" ), "deltaE" );
-		deltaSRTex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "deltaSR" ), "deltaSR" );
-		deltaSMTex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "deltaSM" ), "deltaSM" );
-		deltaJTex.tex2D->SetPrivateData( WKPDID_D3DDebugObjectName, sizeof( "deltaJ" ), "deltaJ" );
-	#endif
-
     return 0;
 }
 
-void Atmosphere::UpdatePrecomputeCBuffer( ID3D11DeviceContext* devContext )
+void Atmosphere::UpdatePrecomputeCBuffer( RenderBackend* backend )
 {
-    D3D11_MAPPED_SUBRESOURCE mappedResource = {};
-    atmospherePrecomputeCbuffer_t* dataPtr = nullptr;
-
-    HRESULT result = devContext->Map( cbuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
-    if ( FAILED( result ) ) {
+    atmospherePrecomputeCbuffer_t* dataPtr = static_cast<atmospherePrecomputeCbuffer_t*>( backend->MapBuffer( cbuffer, RENDER_MAP_WRITE_DISCARD ) );
+    if ( dataPtr == nullptr ) {
         return;
     }
 
-    dataPtr = ( atmospherePrecomputeCbuffer_t* )mappedResource.pData;
-
     dataPtr->r = precomputeData.r;
     dataPtr->k = precomputeData.k;
     dataPtr->first = precomputeData.first;
     dataPtr->layer = precomputeData.layer;
     dataPtr->dhdH = DirectX::XMLoadFloat4( &dhdH );
 
-    devContext->PSSetConstantBuffers( 0, 1, &cbuffer );
+    backend->SetConstantBuffers( RENDER_STAGE_PIXEL, 0, 1, &cbuffer );
 
-    devContext->Unmap( cbuffer, 0 );
+    backend->UnmapBuffer( cbuffer );
 }
\ No newline at end of file
@@ -7,6 +7,9 @@
 #include <Engine/Graphics/CBuffer.h>
 #include <Engine/Graphics/Texture.h>
 
+struct renderContext_t;
+class RenderBackend;
+
 struct atmospherePrecomputeCbuffer_t
 {
     DirectX::XMVECTOR dhdH;
@@ -23,23 +26,23 @@ public:
     Atmosphere( Atmosphere& ) = delete;
     ~Atmosphere();
 
-    int							Create( ID3D11Device* dev );
-    void						Render( ID3D11DeviceContext* devContex );
+    int							Create( const renderContext_t* context );
+    void						Render( RenderBackend* backend );
 
-    int                         Precompute( ID3D11Device* dev, ID3D11DeviceContext* devContex );
+    int                         Precompute( const renderContext_t* context );
 
 private:
-    ID3D11VertexShader*			vertexShader;
-    ID3D11PixelShader*			pixelShader;
-    ID3D11InputLayout*			shaderLayout;
-    ID3D11SamplerState*			samplerState;
+    renderVertexShader_t*		vertexShader;
+    renderPixelShader_t*		pixelShader;
+    renderInputLayout_t*		shaderLayout;
+    renderSamplerState_t*		samplerState;
 
     //=========================================================================
 
     // each 3d rt should be split in an array of 2d rt (to avoid gs usage)
     // this should probably be included properly into the rendertarget struct
     // !!TODO!!
-    ID3D11RenderTargetView*     inscatterRtV[RES_R];
+    renderTargetView_t*         inscatterRtV[RES_R];
 
     renderTarget_t              irradianceTex;
     renderTarget_t              inscatterTex;
@@ -48,20 +51,20 @@ private:
 
     renderTarget_t              deltaETex;
 
-    ID3D11RenderTargetView*     deltaSRRtV[RES_R];
+    renderTargetView_t*         deltaSRRtV[RES_R];
     renderTarget_t              deltaSRTex;
 
-    ID3D11RenderTargetView*     deltaSMRtV[RES_R];
+    renderTargetView_t*         deltaSMRtV[RES_R];
     renderTarget_t              deltaSMTex;
 
-    ID3D11RenderTargetView*     deltaJRtV[RES_R];
+    renderTargetView_t*         deltaJRtV[RES_R];
     renderTarget_t              deltaJTex;
 
     DirectX::XMFLOAT4				dhdH;
     atmospherePrecomputeCbuffer_t   precomputeData;
-    ID3D11Buffer*		            cbuffer;
+    renderBuffer_t*                 cbuffer;
 
 private:
-    int                         Prepare( ID3D11Device* dev );
-    void                        UpdatePrecomputeCBuffer( ID3D11DeviceContext* devContext );
+    int                         Prepare( RenderBackend* backend );
+    void                        UpdatePrecomputeCBuffer( RenderBackend* backend );
 };
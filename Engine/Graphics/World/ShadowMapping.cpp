@@ -1,107 +1,67 @@
 #include "Shared.h"
-#include <d3d11.h>
-#include <d3dcompiler.h>
 #include "ShadowMapping.h"
 
 #include <Engine/Graphics/Texture.h>
 #include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackend.h>
+#include <Engine/Graphics/PipelineStateCache.h>
+#include <Engine/Graphics/ShaderLibrary.h>
 
 ShadowMapping::ShadowMapping()
 	: vertexShader( nullptr )
 	, pixelShader( nullptr )
 	, shaderLayout( nullptr )
+	, samplerState( nullptr )
 {
 
 }
 
 void ShadowMapping::Destroy()
 {
-	#define RELEASE( obj ) if ( obj != nullptr ) { obj->Release(); obj = nullptr; }
-
-	RELEASE( vertexShader )
-	RELEASE( pixelShader )
-	RELEASE( shaderLayout )
+	// owned by the shader library and the pipeline state cache
+	vertexShader = nullptr;
+	pixelShader	 = nullptr;
+	shaderLayout = nullptr;
+	samplerState = nullptr;
 }
 
 const int ShadowMapping::Create( const renderContext_t* context )
 {
-	HRESULT result = 0;
-
-	ID3D10Blob*		vertexShaderBuffer = nullptr;
-	ID3D10Blob*		pixelShaderBuffer = nullptr;
-
-	D3DReadFileToBlob( L"base_data/shaders/shadow_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/shadow_ps.cso", &pixelShaderBuffer );
-
-	result = context->device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader );
-	if ( FAILED( result ) ) {
+	vertexShader = context->shaders->GetVertexShader( L"base_data/shaders/shadow_vs.cso" );
+	if ( vertexShader == nullptr ) {
 		return 1;
 	}
 
-	result = context->device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader );
-	if ( FAILED( result ) ) {
+	pixelShader = context->shaders->GetPixelShader( L"base_data/shaders/shadow_ps.cso" );
+	if ( pixelShader == nullptr ) {
 		return 2;
 	}
-	D3D11_INPUT_ELEMENT_DESC layoutDesc[5] = {};
-	layoutDesc[0].SemanticName = "POSITION";
-	layoutDesc[0].SemanticIndex = 0;
-	layoutDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[0].InputSlot = 0;
-	layoutDesc[0].AlignedByteOffset = 0;
-	layoutDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[0].InstanceDataStepRate = 0;
-
-	layoutDesc[1].SemanticName = "NORMAL";
-	layoutDesc[1].SemanticIndex = 0;
-	layoutDesc[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[1].InputSlot = 0;
-	layoutDesc[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[1].InstanceDataStepRate = 0;
-
-	layoutDesc[2].SemanticName = "TEXCOORD";
-	layoutDesc[2].SemanticIndex = 0;
-	layoutDesc[2].Format = DXGI_FORMAT_R32G32_FLOAT;
-	layoutDesc[2].InputSlot = 0;
-	layoutDesc[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[2].InstanceDataStepRate = 0;
-
-	layoutDesc[3].SemanticName = "TANGENT";
-	layoutDesc[3].SemanticIndex = 0;
-	layoutDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[3].InputSlot = 0;
-	layoutDesc[3].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[3].InstanceDataStepRate = 0;
-
-	layoutDesc[4].SemanticName = "BINORMAL";
-	layoutDesc[4].SemanticIndex = 0;
-	layoutDesc[4].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[4].InputSlot = 0;
-	layoutDesc[4].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[4].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[4].InstanceDataStepRate = 0;
-
-
-	result = context->device->CreateInputLayout( layoutDesc, 5, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &shaderLayout );
-	if ( FAILED( result ) ) {
+	// position stream only (see mesh_t)
+	renderInputElementDesc_t layoutDesc[1] = {};
+	layoutDesc[0].semanticName = "POSITION";
+	layoutDesc[0].semanticIndex = 0;
+	layoutDesc[0].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[0].inputSlot = 0;
+	layoutDesc[0].alignedByteOffset = 0;
+	layoutDesc[0].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[0].instanceDataStepRate = 0;
+
+	shaderLayout = context->pipelineStates->GetInputLayout( layoutDesc, 1, L"base_data/shaders/shadow_vs.cso" );
+	if ( shaderLayout == nullptr ) {
 		return 3;
 	}
 
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
-
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	samplerDesc.MaxAnisotropy = 8;
-
-	if ( FAILED( context->device->CreateSamplerState( &samplerDesc, &samplerState ) ) ) {
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+	samplerDesc.maxAnisotropy = 8;
+
+	samplerState = context->pipelineStates->GetSamplerState( samplerDesc );
+	if ( samplerState == nullptr ) {
 		return 4;
 	}
 
@@ -112,14 +72,14 @@ const int ShadowMapping::Create( const renderContext_t* context )
 
 void ShadowMapping::RenderDiskAreaLight( const renderContext_t* context, const mesh_t* mesh, const diskAreaLight_t& light )
 {
-	context->deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+	context->backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
 
-	context->deviceContext->IASetInputLayout( shaderLayout );
+	context->backend->SetInputLayout( shaderLayout );
 
-	context->deviceContext->VSSetShader( vertexShader, NULL, 0 );
-	context->deviceContext->PSSetShader( pixelShader, NULL, 0 );
+	context->backend->SetVertexShader( vertexShader );
+	context->backend->SetPixelShader( pixelShader );
 
-	context->deviceContext->PSSetSamplers( 0, 1, &samplerState );
+	context->backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerState );
 
 	DirectX::XMMATRIX lightProj = DirectX::XMMatrixPerspectiveFovLH( 180.0f, 1.0f, 0.01f, 128.0f * light.worldPositionRadius.w );
 
@@ -139,6 +99,8 @@ void ShadowMapping::RenderDiskAreaLight( const renderContext_t* context, const m
 
 	matricesData.lightMatrix = DirectX::XMMatrixTranspose( lightView * lightProj );
 
+	Render_BindMeshPositions( context, mesh );
+
 	for ( const submesh_t& subMesh : mesh->subMeshes ) {
 		if ( subMesh.material->colorData.flags & MAT_FLAG_IS_SHADELESS ) { // do not include light emitters in the shadow mapping
 			continue;
@@ -148,23 +110,21 @@ void ShadowMapping::RenderDiskAreaLight( const renderContext_t* context, const m
 
 		Render_UploadCBuffer( context, matricesCbuffer, &matricesData, sizeof( matricesData ) );
 
-		context->deviceContext->VSSetConstantBuffers( 4, 1, &matricesCbuffer );
+		context->backend->SetConstantBuffers( RENDER_STAGE_VERTEX, 4, 1, &matricesCbuffer );
 
-		context->deviceContext->DrawIndexed( subMesh.indiceCount, subMesh.iboOffset, 0 );
+		context->backend->DrawIndexed( subMesh.indiceCount, Render_GetMeshFirstIndex( mesh ) + subMesh.iboOffset, Render_GetMeshBaseVertex( mesh ) );
 	}
 }
 
 void ShadowMapping::RenderSun( const renderContext_t* context, sunLight_t& sun )
 {
-	ID3D11RenderTargetView* nullRenderTargets[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = { NULL };
-	context->deviceContext->OMSetRenderTargets( D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, nullRenderTargets, sun.cascadeAtlas.depthView );
+	renderTargetView_t* nullRenderTargets[RENDER_SIMULTANEOUS_RENDER_TARGET_COUNT] = { NULL };
+	context->backend->SetRenderTargets( RENDER_SIMULTANEOUS_RENDER_TARGET_COUNT, nullRenderTargets, sun.cascadeAtlas.depthView );
 
-	D3D11_VIEWPORT backupViewport = {};
-	UINT viewportCount = 1;
-	context->deviceContext->RSGetViewports( &viewportCount, &backupViewport );
+	const renderViewport_t backupViewport = context->backend->GetViewport();
 
 	// set shadow viewport
-	D3D11_VIEWPORT viewport =
+	renderViewport_t viewport =
 	{
 		0.0f,
 		0.0f,
@@ -174,8 +134,8 @@ void ShadowMapping::RenderSun( const renderContext_t* context, sunLight_t& sun )
 		1.0f,
 	};
 
-	context->deviceContext->RSSetViewports( 1, &viewport );
+	context->backend->SetViewport( viewport );
 
 	// restore previous viewport
-	context->deviceContext->RSSetViewports( 1, &backupViewport );
+	context->backend->SetViewport( backupViewport );
 }
@@ -22,10 +22,10 @@ public:
 	void						RenderSun( const renderContext_t* context, sunLight_t& sun );
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
-	ID3D11InputLayout*			shaderLayout;
-	ID3D11SamplerState*			samplerState;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShader;
+	renderInputLayout_t*		shaderLayout;
+	renderSamplerState_t*		samplerState;
 
 	struct
 	{
@@ -1,11 +1,10 @@
 #include "Shared.h"
-#include <d3d11.h>
-#include <d3dcompiler.h>
 #include "Skybox.h"
 
 #include <Engine/Graphics/Texture.h>
 #include <Engine/Graphics/Material.h>
 #include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/RenderBackend.h>
 
 Skybox::Skybox()
 	: vertexShader( nullptr )
@@ -25,86 +24,88 @@ void Skybox::Destroy()
 	RELEASE( shaderLayout )
 }
 
-const int Skybox::Create( const renderContext_t* context, MaterialManager* matMan, ID3D11Device* dev )
+const int Skybox::Create( const renderContext_t* context, MaterialManager* matMan )
 {
-	HRESULT result = 0;
+	RenderBackend* backend = context->backend;
 
-	ID3D10Blob*		vertexShaderBuffer = nullptr;
-	ID3D10Blob*		pixelShaderBuffer = nullptr;
+	std::vector<uint8_t> vertexShaderBytecode, pixelShaderBytecode;
 
-	D3DReadFileToBlob( L"base_data/shaders/skybox_vs.cso", &vertexShaderBuffer );
-	D3DReadFileToBlob( L"base_data/shaders/skybox_ps.cso", &pixelShaderBuffer );
-
-	result = dev->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader );
-	if ( FAILED( result ) ) {
+	if ( !backend->LoadShaderBytecode( L"base_data/shaders/skybox_vs.cso", vertexShaderBytecode ) ) {
 		return 1;
 	}
 
-	result = dev->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader );
-	if ( FAILED( result ) ) {
+	if ( !backend->LoadShaderBytecode( L"base_data/shaders/skybox_ps.cso", pixelShaderBytecode ) ) {
 		return 2;
 	}
 
-	D3D11_INPUT_ELEMENT_DESC layoutDesc[5] = {};
-	layoutDesc[0].SemanticName = "POSITION";
-	layoutDesc[0].SemanticIndex = 0;
-	layoutDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[0].InputSlot = 0;
-	layoutDesc[0].AlignedByteOffset = 0;
-	layoutDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[0].InstanceDataStepRate = 0;
-
-	layoutDesc[1].SemanticName = "NORMAL";
-	layoutDesc[1].SemanticIndex = 0;
-	layoutDesc[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[1].InputSlot = 0;
-	layoutDesc[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[1].InstanceDataStepRate = 0;
-
-	layoutDesc[2].SemanticName = "TEXCOORD";
-	layoutDesc[2].SemanticIndex = 0;
-	layoutDesc[2].Format = DXGI_FORMAT_R32G32_FLOAT;
-	layoutDesc[2].InputSlot = 0;
-	layoutDesc[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[2].InstanceDataStepRate = 0;
-
-	layoutDesc[3].SemanticName = "TANGENT";
-	layoutDesc[3].SemanticIndex = 0;
-	layoutDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[3].InputSlot = 0;
-	layoutDesc[3].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[3].InstanceDataStepRate = 0;
-
-	layoutDesc[4].SemanticName = "BINORMAL";
-	layoutDesc[4].SemanticIndex = 0;
-	layoutDesc[4].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	layoutDesc[4].InputSlot = 0;
-	layoutDesc[4].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	layoutDesc[4].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	layoutDesc[4].InstanceDataStepRate = 0;
-
-
-	result = dev->CreateInputLayout( layoutDesc, 5, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &shaderLayout );
-	if ( FAILED( result ) ) {
-		return 3;
+	vertexShader = backend->CreateVertexShader( vertexShaderBytecode.data(), vertexShaderBytecode.size() );
+	if ( vertexShader == nullptr ) {
+		return 1;
 	}
 
-	vertexShaderBuffer->Release();
-	pixelShaderBuffer->Release();
+	pixelShader = backend->CreatePixelShader( pixelShaderBytecode.data(), pixelShaderBytecode.size() );
+	if ( pixelShader == nullptr ) {
+		return 2;
+	}
 
-	D3D11_SAMPLER_DESC samplerDesc = {};
-	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-	samplerDesc.MinLOD = 0;
-	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	samplerDesc.MaxAnisotropy = 8;
+	renderInputElementDesc_t layoutDesc[5] = {};
+	layoutDesc[0].semanticName = "POSITION";
+	layoutDesc[0].semanticIndex = 0;
+	layoutDesc[0].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[0].inputSlot = 0;
+	layoutDesc[0].alignedByteOffset = 0;
+	layoutDesc[0].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[0].instanceDataStepRate = 0;
+
+	layoutDesc[1].semanticName = "NORMAL";
+	layoutDesc[1].semanticIndex = 0;
+	layoutDesc[1].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[1].inputSlot = 1;
+	layoutDesc[1].alignedByteOffset = 0;
+	layoutDesc[1].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[1].instanceDataStepRate = 0;
+
+	layoutDesc[2].semanticName = "TEXCOORD";
+	layoutDesc[2].semanticIndex = 0;
+	layoutDesc[2].format = RENDER_FORMAT_R32G32_FLOAT;
+	layoutDesc[2].inputSlot = 1;
+	layoutDesc[2].alignedByteOffset = RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[2].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[2].instanceDataStepRate = 0;
+
+	layoutDesc[3].semanticName = "TANGENT";
+	layoutDesc[3].semanticIndex = 0;
+	layoutDesc[3].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[3].inputSlot = 1;
+	layoutDesc[3].alignedByteOffset = RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[3].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[3].instanceDataStepRate = 0;
+
+	layoutDesc[4].semanticName = "BINORMAL";
+	layoutDesc[4].semanticIndex = 0;
+	layoutDesc[4].format = RENDER_FORMAT_R32G32B32_FLOAT;
+	layoutDesc[4].inputSlot = 1;
+	layoutDesc[4].alignedByteOffset = RENDER_APPEND_ALIGNED_ELEMENT;
+	layoutDesc[4].inputSlotClass = RENDER_INPUT_PER_VERTEX_DATA;
+	layoutDesc[4].instanceDataStepRate = 0;
+
+
+	shaderLayout = backend->CreateInputLayout( layoutDesc, 5, vertexShaderBytecode.data(), vertexShaderBytecode.size() );
+	if ( shaderLayout == nullptr ) {
+		return 3;
+	}
 
-	if ( FAILED( dev->CreateSamplerState( &samplerDesc, &samplerState ) ) ) {
+	renderSamplerDesc_t samplerDesc = {};
+	samplerDesc.filter = RENDER_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.addressU = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressV = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.addressW = RENDER_TEXTURE_ADDRESS_WRAP;
+	samplerDesc.minLOD = 0;
+	samplerDesc.maxLOD = RENDER_FLOAT32_MAX;
+	samplerDesc.maxAnisotropy = 8;
+
+	samplerState = backend->CreateSamplerState( samplerDesc );
+	if ( samplerState == nullptr ) {
 		return 4;
 	}
 
@@ -122,18 +123,18 @@ const bool Skybox::LoadEnvMap( const renderContext_t* context, TextureManager* t
 
 void Skybox::Render( const renderContext_t* context )
 {
-	context->deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+	context->backend->SetPrimitiveTopology( RENDER_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
 
-	context->deviceContext->IASetInputLayout( shaderLayout );
+	context->backend->SetInputLayout( shaderLayout );
 
-	context->deviceContext->VSSetShader( vertexShader, NULL, 0 );
-	context->deviceContext->PSSetShader( pixelShader, NULL, 0 );
+	context->backend->SetVertexShader( vertexShader );
+	context->backend->SetPixelShader( pixelShader );
 
-	context->deviceContext->PSSetSamplers( 0, 1, &samplerState );
+	context->backend->SetSamplers( RENDER_STAGE_PIXEL, 0, 1, &samplerState );
 
 	Render_BindMesh( context, &skyboxGeometry );
 	for ( const submesh_t& subMesh :skyboxGeometry.subMeshes ) {
-		context->deviceContext->PSSetShaderResources( 0, 1, &envMap->view );
-		context->deviceContext->DrawIndexed( subMesh.indiceCount, subMesh.iboOffset, 0 );
+		context->backend->SetShaderResources( RENDER_STAGE_PIXEL, 0, 1, &envMap->view );
+		context->backend->DrawIndexed( subMesh.indiceCount, Render_GetMeshFirstIndex( &skyboxGeometry ) + subMesh.iboOffset, Render_GetMeshBaseVertex( &skyboxGeometry ) );
 	}
 }
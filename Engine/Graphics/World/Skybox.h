@@ -14,15 +14,15 @@ public:
 	~Skybox()			= default;
 
 	void						Destroy();
-	const int					Create( const renderContext_t* context, MaterialManager* matMan, ID3D11Device* dev );
+	const int					Create( const renderContext_t* context, MaterialManager* matMan );
 	const bool					LoadEnvMap( const renderContext_t* context, TextureManager* texMan, MaterialManager* matMan, const char* resFilePath );
 	void						Render( const renderContext_t* context );
 
 private:
-	ID3D11VertexShader*			vertexShader;
-	ID3D11PixelShader*			pixelShader;
-	ID3D11InputLayout*			shaderLayout;
-	ID3D11SamplerState*			samplerState;
+	renderVertexShader_t*		vertexShader;
+	renderPixelShader_t*		pixelShader;
+	renderInputLayout_t*		shaderLayout;
+	renderSamplerState_t*		samplerState;
 
 	texture_t*					envMap;
 	mesh_t						skyboxGeometry;
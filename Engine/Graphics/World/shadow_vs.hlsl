@@ -1,10 +1,7 @@
+// position stream only; the attributes are never fetched
 struct vsData_t
 {
 	float3 position     : POSITION;
-	float3 normal       : NORMAL;
-	float2 uvCoord      : TEXCOORD0;
-	float3 tangent      : TANGENT;
-	float3 bitangent    : BINORMAL;
 };
 
 cbuffer LightMatrixModelBuffer : register( b4 )
@@ -2,34 +2,245 @@
 #include "AreaFileReaderWriter.h"
 
 #include <Engine/Game/World.h>
+#include <Engine/Graphics/Mesh.h>
+#include <Engine/Graphics/LightManager.h>
 
 #include <fstream>
+#include <cstddef>
+#include <cstdio>
+
+namespace
+{
+	constexpr uint64_t NODE_FLAG_CONTENT_MASK = NODE_FLAG_CONTENT_SPHERE_LIGHT | NODE_FLAG_CONTENT_DISK_LIGHT | NODE_FLAG_CONTENT_RECTANGLE_LIGHT
+												| NODE_FLAG_CONTENT_TUBE_LIGHT | NODE_FLAG_CONTENT_SUN_LIGHT | NODE_FLAG_CONTENT_MESH | NODE_FLAG_CONTENT_ACTOR;
+
+	// the sun cascade atlas is a gpu resource; only its parameters are saved
+	constexpr unsigned int SUN_LIGHT_PARAMETERS_SIZE = offsetof( sunLight_t, cascadeAtlas );
+
+	uint32_t CountNodes( const areaNode_t* node )
+	{
+		uint32_t nodeCount = static_cast<uint32_t>( node->children.size() );
+
+		for ( const areaNode_t* child : node->children ) {
+			nodeCount += CountNodes( child );
+		}
+
+		return nodeCount;
+	}
+
+	// raw bytes of the saved content; null (and contentFlag = 0) if the content is not saved
+	const void* GetSavedContent( const areaNode_t* node, uint64_t& contentFlag, unsigned int& contentSize )
+	{
+		contentFlag = 0;
+		contentSize = 0;
+
+		if ( node->content == nullptr ) {
+			return nullptr;
+		}
+
+		if ( node->flags & NODE_FLAG_CONTENT_MESH ) {
+			contentFlag = NODE_FLAG_CONTENT_MESH;
+			contentSize = static_cast<unsigned int>( sizeof( DirectX::BoundingSphere ) + static_cast<const mesh_t*>( node->content )->fileName.size() );
+		} else if ( node->flags & NODE_FLAG_CONTENT_SPHERE_LIGHT ) {
+			contentFlag = NODE_FLAG_CONTENT_SPHERE_LIGHT;
+			contentSize = sizeof( sphereAreaLight_t );
+		} else if ( node->flags & NODE_FLAG_CONTENT_DISK_LIGHT ) {
+			contentFlag = NODE_FLAG_CONTENT_DISK_LIGHT;
+			contentSize = sizeof( diskAreaLight_t );
+		} else if ( node->flags & NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) {
+			contentFlag = NODE_FLAG_CONTENT_RECTANGLE_LIGHT;
+			contentSize = sizeof( rectangleAreaLight_t );
+		} else if ( node->flags & NODE_FLAG_CONTENT_SUN_LIGHT ) {
+			contentFlag = NODE_FLAG_CONTENT_SUN_LIGHT;
+			contentSize = SUN_LIGHT_PARAMETERS_SIZE;
+		} else {
+			// actors belong to the gameplay code; tube lights have no content yet
+			return nullptr;
+		}
+
+		return node->content;
+	}
+
+	void WriteNode( std::ofstream& fileStream, const worldArea_t* area, const areaNode_t* node )
+	{
+		uint64_t		contentFlag = 0;
+		unsigned int	contentSize = 0;
+		const void*		content = GetSavedContent( node, contentFlag, contentSize );
+
+		areaNodeHeader_t nodeHeader = {};
+		nodeHeader.hash			= node->hash;
+		nodeHeader.flags		= ( node->flags & ~NODE_FLAG_CONTENT_MASK ) | ( ( contentFlag != 0 ) ? contentFlag : static_cast<uint64_t>( NODE_FLAG_EMPTY_NODE ) );
+		nodeHeader.childCount	= static_cast<unsigned int>( node->children.size() );
+		nodeHeader.contentSize	= contentSize;
+
+		snprintf( nodeHeader.name, sizeof( nodeHeader.name ), "%s", node->name );
+
+		// root children have no parent transform
+		DirectX::XMMATRIX localMatrix = area->transforms.GetWorldMatrix( node->transform );
+
+		if ( node->parent != nullptr && node->parent->transform != TRANSFORM_HANDLE_INVALID ) {
+			const DirectX::XMMATRIX& parentMatrix = area->transforms.GetWorldMatrix( node->parent->transform );
+			localMatrix = DirectX::XMMatrixMultiply( localMatrix, DirectX::XMMatrixInverse( nullptr, parentMatrix ) );
+		}
+
+		DirectX::XMStoreFloat4x4( reinterpret_cast<DirectX::XMFLOAT4X4*>( nodeHeader.localMatrix ), localMatrix );
+
+		fileStream.write( ( const char* )&nodeHeader, sizeof( areaNodeHeader_t ) );
+
+		if ( contentFlag == NODE_FLAG_CONTENT_MESH ) {
+			const mesh_t* mesh = static_cast<const mesh_t*>( content );
+
+			fileStream.write( ( const char* )&mesh->transformation->boundingSphere, sizeof( DirectX::BoundingSphere ) );
+			fileStream.write( mesh->fileName.c_str(), mesh->fileName.size() );
+		} else if ( content != nullptr ) {
+			fileStream.write( ( const char* )content, contentSize );
+		}
+
+		for ( const areaNode_t* child : node->children ) {
+			WriteNode( fileStream, area, child );
+		}
+	}
+
+	// returns 0 on success, 3 if the node (or one of its children) could not be read, 4 if cancelled
+	int ReadNode( std::ifstream& fileStream, worldArea_t* area, areaNode_t* parent, uint32_t& remainingNodeCount, const std::atomic<bool>* cancelRequest )
+	{
+		if ( cancelRequest != nullptr && cancelRequest->load( std::memory_order_relaxed ) ) {
+			return 4;
+		}
+
+		areaNodeHeader_t nodeHeader = {};
+		fileStream.read( ( char* )&nodeHeader, sizeof( areaNodeHeader_t ) );
+
+		if ( !fileStream.good() || remainingNodeCount == 0 ) {
+			return 3;
+		}
+
+		--remainingNodeCount;
+
+		areaNode_t* node	= World::AllocateNode( area, parent );
+		node->hash			= nodeHeader.hash;
+		node->flags			= nodeHeader.flags;
+
+		memcpy( node->name, nodeHeader.name, sizeof( node->name ) );
+		node->name[sizeof( node->name ) - 1] = '\0';
+
+		area->transforms.SetLocalMatrix( node->transform, DirectX::XMLoadFloat4x4( reinterpret_cast<const DirectX::XMFLOAT4X4*>( nodeHeader.localMatrix ) ) );
+
+		const uint64_t contentFlag = nodeHeader.flags & NODE_FLAG_CONTENT_MASK;
+
+		if ( contentFlag == NODE_FLAG_CONTENT_MESH ) {
+			if ( nodeHeader.contentSize < sizeof( DirectX::BoundingSphere ) ) {
+				return 3;
+			}
+
+			mesh_t* mesh = static_cast<mesh_t*>( World::AllocateAreaContent( area, NODE_FLAG_CONTENT_MESH ) );
+			node->content = mesh;
+
+			fileStream.read( ( char* )&mesh->transformation->boundingSphere, sizeof( DirectX::BoundingSphere ) );
+
+			mesh->fileName.resize( nodeHeader.contentSize - sizeof( DirectX::BoundingSphere ) );
+			fileStream.read( &mesh->fileName[0], mesh->fileName.size() );
+
+			area->transforms.SetLocalBounds( node->transform, mesh->transformation->boundingSphere );
+			area->transforms.BindWorldMatrixOutput( node->transform, &mesh->transformation->modelMatrix );
+		} else if ( contentFlag != 0 ) {
+			const unsigned int expectedSize = ( contentFlag == NODE_FLAG_CONTENT_SPHERE_LIGHT ) ? sizeof( sphereAreaLight_t )
+											: ( contentFlag == NODE_FLAG_CONTENT_DISK_LIGHT ) ? sizeof( diskAreaLight_t )
+											: ( contentFlag == NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) ? sizeof( rectangleAreaLight_t )
+											: ( contentFlag == NODE_FLAG_CONTENT_SUN_LIGHT ) ? SUN_LIGHT_PARAMETERS_SIZE
+											: 0;
+
+			// a single (supported) content bit, whose size matches the one of this version
+			if ( expectedSize == 0 || nodeHeader.contentSize != expectedSize ) {
+				return 3;
+			}
+
+			node->content = World::AllocateAreaContent( area, contentFlag );
+			fileStream.read( ( char* )node->content, nodeHeader.contentSize );
+		} else if ( nodeHeader.contentSize != 0 ) {
+			return 3;
+		}
+
+		if ( !fileStream.good() ) {
+			return 3;
+		}
+
+		node->children.reserve( nodeHeader.childCount );
+
+		for ( unsigned int i = 0; i < nodeHeader.childCount; ++i ) {
+			const int childResult = ReadNode( fileStream, area, node, remainingNodeCount, cancelRequest );
+
+			if ( childResult != 0 ) {
+				return childResult;
+			}
+		}
+
+		return 0;
+	}
+}
 
 const int Io_WriteAreaFile( const char* fileName, const worldArea_t* area )
 {
 	std::ofstream fileStream( fileName, std::ios::binary | std::ios::out );
 
-	if ( fileStream.good() ) {
-		areaHeader_t header = {
-			0,
-			0,
-			0xFFFF,
-			0x0,
-			0,
-			0xFFFFFFFF,
-		};
+	if ( !fileStream.good() ) {
+		return 1;
+	}
 
-		fileStream.write( ( const char* )&header, sizeof( areaHeader_t ) );
+	areaHeader_t header = {
+		area->xIndice,
+		area->yIndice,
+		AREA_FILE_VERSION,
+		0x0,
+		CountNodes( area->nodes ),
+		0xFFFFFFFF,
+	};
 
-		constexpr unsigned int pad = 0xFFFFFFFF;
-		for ( const areaNode_t* node : area->nodes->children ) {
-			fileStream.write( ( const char* )&node->hash, sizeof( unsigned int ) );
-			fileStream.write( ( const char* )&node->flags, sizeof( uint64_t ) );
-			fileStream.write( ( const char* )&pad, sizeof( unsigned int ) );
-		}
+	fileStream.write( ( const char* )&header, sizeof( areaHeader_t ) );
 
-		fileStream.close();
+	for ( const areaNode_t* node : area->nodes->children ) {
+		WriteNode( fileStream, area, node );
 	}
 
+	fileStream.close();
+
+	return ( fileStream.fail() ) ? 2 : 0;
+}
+
+const int Io_ReadAreaFile( const char* fileName, worldArea_t* area, const std::atomic<bool>* cancelRequest )
+{
+	std::ifstream fileStream( fileName, std::ios::binary | std::ios::in );
+
+	if ( !fileStream.is_open() ) {
+		return 1;
+	}
+
+	areaHeader_t header = {};
+	fileStream.read( ( char* )&header, sizeof( areaHeader_t ) );
+
+	if ( !fileStream.good() ) {
+		return 2;
+	}
+
+	if ( header.version != AREA_FILE_VERSION ) {
+		return 5;
+	}
+
+	area->xIndice = header.indexX;
+	area->yIndice = header.indexY;
+
+	// root children until the node count is exhausted
+	uint32_t remainingNodeCount = header.nodeCount;
+
+	while ( remainingNodeCount > 0 ) {
+		const int nodeResult = ReadNode( fileStream, area, area->nodes, remainingNodeCount, cancelRequest );
+
+		if ( nodeResult != 0 ) {
+			return nodeResult;
+		}
+	}
+
+	fileStream.close();
+
 	return 0;
 }
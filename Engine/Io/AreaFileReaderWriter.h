@@ -2,17 +2,36 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+
+// bumped each time the layout below changes; files of another version are rejected
+static constexpr unsigned short AREA_FILE_VERSION = 2;
 
 struct areaHeader_t
 {
 	unsigned char indexX;
 	unsigned char indexY;
-	unsigned short __PADDING__;
+	unsigned short version;
 	unsigned int  areaFlags;
-	unsigned int  nodeCount;
+	unsigned int  nodeCount;	// every node but the area root
 	unsigned int  hashcode;
 };
 
+// nodes are stored depth first: each node header is followed by its content, then by its children
+struct areaNodeHeader_t
+{
+	uint64_t		hash;
+	uint64_t		flags;			// content bits are cleared for content which is not saved (actors, tube lights)
+	char			name[128];
+	float			localMatrix[16];	// relative to the parent node (as of the last transform update)
+	unsigned int	childCount;
+	unsigned int	contentSize;	// bytes following the header (mesh: local bounds + file name; lights: parameters)
+};
+
 struct worldArea_t;
 
 const int Io_WriteAreaFile( const char* fileName, const worldArea_t* area );
+
+// cancelRequest is polled between node reads (might be null); returns 4 if the read has been cancelled, 5 if the version does not match
+// meshes only get their file name and bounds: their geometry has to be created on the main thread (see AreaStreamer)
+const int Io_ReadAreaFile( const char* fileName, worldArea_t* area, const std::atomic<bool>* cancelRequest = nullptr );
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 
 using dictionary_t = std::map<std::string, std::string>;
 
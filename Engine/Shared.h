@@ -1,6 +1,13 @@
 #pragma once
 
+#if defined( _WIN32 )
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#else
+#include <cstring>
+#include <cstdlib>
+
+#define _countof( array ) ( sizeof( array ) / sizeof( array[0] ) )
+#endif
 
 #include "System/MurmurHash2_64.h"
@@ -1,14 +1,29 @@
 #include "Shared.h"
 #include "Environment.h"
 
+#if defined( _WIN32 )
 #include <Shlobj.h>
 #include <intrin.h>
 #include <VersionHelpers.h>
 
 #define CPU_ID( x, y ) __cpuid( x, static_cast<int>( y ) )
+#else
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#if defined( __i386__ ) || defined( __x86_64__ )
+#include <cpuid.h>
+
+#define CPU_ID( x, y ) __cpuid( y, x[0], x[1], x[2], x[3] )
+#endif
+#endif
 
 const unsigned short Env_GetCacheLineSizeL2()
 {
+#if defined( _WIN32 )
 	DWORD buffLength = 0;
 	GetLogicalProcessorInformationEx( RelationCache, nullptr, &buffLength );
 
@@ -24,18 +39,31 @@ const unsigned short Env_GetCacheLineSizeL2()
 	delete sysInfos;
 
 	return cacheSize;
+#elif defined( _SC_LEVEL2_CACHE_LINESIZE )
+	const long lineSize = sysconf( _SC_LEVEL2_CACHE_LINESIZE );
+
+	return ( lineSize > 0 ) ? static_cast<unsigned short>( lineSize ) : 0;
+#else
+	return 0;
+#endif
 }
 
 const int Env_GetCPUCoreCount()
 {
+#if defined( _WIN32 )
 	SYSTEM_INFO systemInfo = {};
 	GetSystemInfo( &systemInfo );
 
 	return systemInfo.dwNumberOfProcessors;
+#else
+	// 0 if unknown: callers treat it as a single core
+	return std::max( 1, static_cast<int>( std::thread::hardware_concurrency() ) );
+#endif
 }
 
 const unsigned long long Env_GetRAMTotalSize()
 {
+#if defined( _WIN32 )
 	MEMORYSTATUSEX memStatusEx = {};
 	memStatusEx.dwLength = sizeof( memStatusEx );
 
@@ -46,11 +74,23 @@ const unsigned long long Env_GetRAMTotalSize()
 	}
 
 	return static_cast< const unsigned long long >( memStatusEx.ullTotalPhys >> 20 );
+#else
+	const long pageCount = sysconf( _SC_PHYS_PAGES );
+	const long pageSize = sysconf( _SC_PAGE_SIZE );
+
+	if ( pageCount <= 0 || pageSize <= 0 ) {
+		return 0;
+	}
+
+	return ( static_cast<unsigned long long>( pageCount ) * static_cast<unsigned long long>( pageSize ) ) >> 20;
+#endif
 }
 
 const char* Env_GetCPUName()
 {
 	static char cpuName[128] = {};
+
+#if defined( CPU_ID )
 	int cpuInfos[4] = {};
 	int cpuLetter = -1;
 
@@ -68,6 +108,9 @@ const char* Env_GetCPUName()
 			}
 		}
 	}
+#else
+	strcpy( cpuName, "Unknown CPU" );
+#endif
 
 	return cpuName;
 }
@@ -76,6 +119,7 @@ const char* Env_GetOSName()
 {
 	static char osName[64] = {};
 
+#if defined( _WIN32 )
 	if ( IsWindows10OrGreater() ) {
 		strcpy_s( osName, "Windows 10" );
 	} else if ( IsWindows8Point1OrGreater() ) {
@@ -103,6 +147,14 @@ const char* Env_GetOSName()
 	} else {
 		strcpy_s( osName, "Windows ???" );
 	}
+#else
+	utsname systemName = {};
+
+	// long release names are cut to the buffer
+	if ( uname( &systemName ) != 0 || snprintf( osName, sizeof( osName ), "%s %s", systemName.sysname, systemName.release ) < 0 ) {
+		strcpy( osName, "Unknown OS" );
+	}
+#endif
 
 	return osName;
 }
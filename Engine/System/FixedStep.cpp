@@ -0,0 +1,111 @@
+#include "Shared.h"
+#include "FixedStep.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr double	METRICS_SMOOTHING	= 0.05;
+	constexpr uint32_t	METRICS_WINDOW		= 128; // ticks
+
+	inline double SmoothMetric( const double average, const double value )
+	{
+		return average + ( value - average ) * METRICS_SMOOTHING;
+	}
+
+	void EndTick( fixedStep_t* step )
+	{
+		fixedStepMetrics_t& metrics = step->metrics;
+
+		metrics.tickCost		= Timer_GetDelta( &step->tickTimer );
+		metrics.tickCostAverage	= ( metrics.totalTickCount == 1 ) ? metrics.tickCost : SmoothMetric( metrics.tickCostAverage, metrics.tickCost );
+
+		if ( step->metricsTickIndex++ % METRICS_WINDOW == 0 ) {
+			metrics.tickCostMax = 0.0;
+		}
+
+		metrics.tickCostMax = std::max( metrics.tickCostMax, metrics.tickCost );
+
+		step->isTicking = false;
+	}
+}
+
+void FixedStep_Start( fixedStep_t* step, const double tickDuration, const uint32_t maxTicksPerFrame, const double maxFrameDuration )
+{
+	step->tickDuration		= tickDuration;
+	step->maxFrameDuration	= maxFrameDuration;
+	step->maxTicksPerFrame	= std::max( 1u, maxTicksPerFrame );
+
+	step->accumulator		= 0.0;
+	step->remainingTicks	= 0;
+	step->isTicking			= false;
+	step->metricsTickIndex	= 0;
+
+	step->metrics = {};
+	step->metrics.frameTimeAverage = tickDuration;
+
+	Timer_Start( &step->frameTimer );
+	Timer_Start( &step->tickTimer );
+}
+
+const double FixedStep_BeginFrame( fixedStep_t* step )
+{
+	return FixedStep_BeginFrame( step, Timer_GetDelta( &step->frameTimer ) );
+}
+
+const double FixedStep_BeginFrame( fixedStep_t* step, const double elapsedTime )
+{
+	fixedStepMetrics_t& metrics = step->metrics;
+
+	metrics.frameTime			= elapsedTime;
+	metrics.frameTimeJitter		= SmoothMetric( metrics.frameTimeJitter, std::abs( metrics.frameTime - metrics.frameTimeAverage ) );
+	metrics.frameTimeAverage	= SmoothMetric( metrics.frameTimeAverage, metrics.frameTime );
+
+	const double frameTime = std::min( metrics.frameTime, step->maxFrameDuration );
+
+	step->accumulator += frameTime;
+
+	uint32_t tickCount = static_cast<uint32_t>( step->accumulator / step->tickDuration );
+
+	// spiral of death: ticking slower than real time makes the next frame longer, which requires more ticks, ...
+	if ( tickCount > step->maxTicksPerFrame ) {
+		metrics.droppedTickCount += tickCount - step->maxTicksPerFrame;
+		step->accumulator -= ( tickCount - step->maxTicksPerFrame ) * step->tickDuration;
+
+		tickCount = step->maxTicksPerFrame;
+	}
+
+	step->remainingTicks	= tickCount;
+	metrics.tickCount		= 0;
+
+	return frameTime;
+}
+
+const bool FixedStep_Tick( fixedStep_t* step )
+{
+	if ( step->isTicking ) {
+		EndTick( step );
+	}
+
+	if ( step->remainingTicks == 0 ) {
+		step->metrics.alpha = FixedStep_GetAlpha( step );
+		return false;
+	}
+
+	step->remainingTicks--;
+	step->accumulator -= step->tickDuration;
+
+	step->metrics.tickCount++;
+	step->metrics.totalTickCount++;
+
+	step->isTicking = true;
+	Timer_GetDelta( &step->tickTimer );
+
+	return true;
+}
+
+const double FixedStep_GetAlpha( const fixedStep_t* step )
+{
+	return std::min( std::max( step->accumulator / step->tickDuration, 0.0 ), 1.0 );
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Timer.h"
+
+// frame pacing and simulation cost (every time is in ms)
+struct fixedStepMetrics_t
+{
+	double		frameTime;			// last frame (unclamped)
+	double		frameTimeAverage;	// exponential moving average
+	double		frameTimeJitter;	// moving average of the deviation from frameTimeAverage
+	double		tickCost;			// cpu time of the last tick
+	double		tickCostAverage;
+	double		tickCostMax;		// over the last METRICS_WINDOW ticks
+	double		alpha;				// interpolation factor between the last two simulation states
+	uint32_t	tickCount;			// ticks run during the last frame
+	uint64_t	totalTickCount;
+	uint64_t	droppedTickCount;	// ticks skipped to avoid the spiral of death
+};
+
+// fixed timestep simulation clock
+// usage:
+//	FixedStep_BeginFrame( &step );
+//	while ( FixedStep_Tick( &step ) ) { simulate( step.tickDuration ); }
+//	render( FixedStep_GetAlpha( &step ) );
+struct fixedStep_t
+{
+	double				tickDuration;
+	double				maxFrameDuration;	// longer frames (breakpoints, window drag, ...) are clamped
+	uint32_t			maxTicksPerFrame;	// if the simulation can't keep up, the remaining time is dropped
+
+	double				accumulator;
+	uint32_t			remainingTicks;
+	bool				isTicking;
+	uint32_t			metricsTickIndex;
+
+	highResTimer_t		frameTimer;
+	highResTimer_t		tickTimer;
+
+	fixedStepMetrics_t	metrics;
+};
+
+void			FixedStep_Start( fixedStep_t* step, const double tickDuration, const uint32_t maxTicksPerFrame = 5, const double maxFrameDuration = 250.0 );
+const double	FixedStep_BeginFrame( fixedStep_t* step ); // returns the (clamped) frame time
+const double	FixedStep_BeginFrame( fixedStep_t* step, const double elapsedTime ); // given frame time instead of the measured one (replays, headless runs)
+const bool		FixedStep_Tick( fixedStep_t* step ); // returns false once every tick of the frame has been consumed
+const double	FixedStep_GetAlpha( const fixedStep_t* step );
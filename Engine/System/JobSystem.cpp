@@ -0,0 +1,458 @@
+#include "Shared.h"
+#include "JobSystem.h"
+#include "Environment.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <new>
+
+namespace
+{
+	struct job_t
+	{
+		jobFunction_t		function;
+		void*				data;
+		jobCounter_t*		counter;
+	};
+
+	constexpr int64_t	QUEUE_CAPACITY	= 4096; // must be a power of two
+
+	// Chase-Lev deque; Push/Pop from the owner thread only, Steal from any thread
+	// jobs are stored by value: a thief reads its copy before the CAS on top, and a slot can only be
+	// overwritten once top went past it (i.e. once that CAS is bound to fail)
+	class JobQueue
+	{
+	public:
+		JobQueue()
+			: top( 0 )
+			, bottom( 0 )
+		{
+			for ( jobSlot_t& entry : entries ) {
+				entry.function.store( nullptr, std::memory_order_relaxed );
+				entry.data.store( nullptr, std::memory_order_relaxed );
+				entry.counter.store( nullptr, std::memory_order_relaxed );
+			}
+		}
+
+		bool Push( const job_t& job )
+		{
+			const int64_t b = bottom.load( std::memory_order_relaxed );
+			const int64_t t = top.load( std::memory_order_acquire );
+
+			if ( b - t >= QUEUE_CAPACITY ) {
+				return false;
+			}
+
+			Store( entries[b & ( QUEUE_CAPACITY - 1 )], job );
+			bottom.store( b + 1, std::memory_order_release );
+
+			return true;
+		}
+
+		bool Pop( job_t& job )
+		{
+			// bottom store and top load must not be reordered (seq_cst)
+			const int64_t b = bottom.load( std::memory_order_relaxed ) - 1;
+			bottom.store( b, std::memory_order_seq_cst );
+			int64_t t = top.load( std::memory_order_seq_cst );
+
+			if ( t > b ) {
+				// empty
+				bottom.store( b + 1, std::memory_order_relaxed );
+				return false;
+			}
+
+			job = Load( entries[b & ( QUEUE_CAPACITY - 1 )] );
+
+			if ( t == b ) {
+				// last job; race against thieves
+				const bool isWon = top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed );
+				bottom.store( b + 1, std::memory_order_relaxed );
+
+				return isWon;
+			}
+
+			return true;
+		}
+
+		bool Steal( job_t& job )
+		{
+			int64_t t = top.load( std::memory_order_seq_cst );
+			const int64_t b = bottom.load( std::memory_order_seq_cst );
+
+			if ( t >= b ) {
+				return false;
+			}
+
+			const job_t stolenJob = Load( entries[t & ( QUEUE_CAPACITY - 1 )] );
+
+			if ( !top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+				return false; // lost the race (the copy might be torn; it is dropped)
+			}
+
+			job = stolenJob;
+
+			return true;
+		}
+
+	private:
+		struct jobSlot_t
+		{
+			std::atomic<jobFunction_t>	function;
+			std::atomic<void*>			data;
+			std::atomic<jobCounter_t*>	counter;
+		};
+
+		static void Store( jobSlot_t& slot, const job_t& job )
+		{
+			slot.function.store( job.function, std::memory_order_relaxed );
+			slot.data.store( job.data, std::memory_order_relaxed );
+			slot.counter.store( job.counter, std::memory_order_relaxed );
+		}
+
+		static job_t Load( const jobSlot_t& slot )
+		{
+			return { slot.function.load( std::memory_order_relaxed ), slot.data.load( std::memory_order_relaxed ), slot.counter.load( std::memory_order_relaxed ) };
+		}
+
+	private:
+		alignas( 64 ) std::atomic<int64_t>	top;
+		alignas( 64 ) std::atomic<int64_t>	bottom;
+		jobSlot_t						entries[QUEUE_CAPACITY];
+	};
+
+	struct worker_t
+	{
+		JobQueue		queue;
+		std::thread		thread;
+	};
+
+	// jobs waiting for a counter to reach zero
+	struct deferredJob_t
+	{
+		const jobCounter_t*	dependency;
+		job_t				job;
+	};
+
+	std::vector<worker_t*>		g_Workers;		// 0: thread which initialized the system
+	std::atomic<bool>			g_IsShuttingDown( false );
+	std::atomic<int>			g_PendingJobCount( 0 );
+	std::atomic<int>			g_SleepingWorkerCount( 0 );
+	std::mutex					g_SleepLock;
+	std::condition_variable		g_WakeCondition;
+
+	// jobs submitted by threads which don't own a queue
+	std::mutex					g_SharedQueueLock;
+	std::deque<job_t>			g_SharedQueue;
+	std::atomic<int>			g_SharedQueueSize( 0 );
+
+	std::mutex					g_DeferredJobLock;
+	std::vector<deferredJob_t>	g_DeferredJobs;
+	std::atomic<int>			g_DeferredJobCount( 0 ); // lets completing jobs skip the lock when nothing waits
+
+	thread_local int			t_WorkerIndex = -1;
+
+	template<typename GetJob>
+	void EnqueueJobs( const uint32_t jobCount, const GetJob& getJob );
+
+	// schedules the jobs waiting for 'counter' once it reached zero
+	void ReleaseDeferredJobs( const jobCounter_t* counter )
+	{
+		// seq_cst: pairs with the deferring thread (count increment, then counter load)
+		if ( g_DeferredJobCount.load( std::memory_order_seq_cst ) == 0 ) {
+			return;
+		}
+
+		std::vector<job_t> readyJobs;
+
+		{
+			std::lock_guard<std::mutex> lock( g_DeferredJobLock );
+
+			for ( size_t i = 0; i < g_DeferredJobs.size(); ) {
+				// the address of a finished counter can be reused by a new one; its dependents keep waiting
+				if ( g_DeferredJobs[i].dependency == counter && counter->value.load( std::memory_order_seq_cst ) == 0 ) {
+					readyJobs.push_back( g_DeferredJobs[i].job );
+
+					g_DeferredJobs[i] = g_DeferredJobs.back();
+					g_DeferredJobs.pop_back();
+				} else {
+					++i;
+				}
+			}
+
+			g_DeferredJobCount.fetch_sub( static_cast<int>( readyJobs.size() ), std::memory_order_relaxed );
+		}
+
+		// outside of the lock: a full queue runs them inline, and they can release others
+		if ( !readyJobs.empty() ) {
+			EnqueueJobs( static_cast<uint32_t>( readyJobs.size() ), [&readyJobs]( const uint32_t i ) { return readyJobs[i]; } );
+		}
+	}
+
+	void ExecuteJob( const job_t& job )
+	{
+		job.function( job.data );
+
+		// the last job of a batch schedules what depends on it
+		if ( job.counter != nullptr && job.counter->value.fetch_sub( 1, std::memory_order_seq_cst ) == 1 ) {
+			ReleaseDeferredJobs( job.counter );
+		}
+	}
+
+	bool TakeJob( const int workerIndex, job_t& job )
+	{
+		if ( workerIndex >= 0 && g_Workers[workerIndex]->queue.Pop( job ) ) {
+			g_PendingJobCount.fetch_sub( 1, std::memory_order_relaxed );
+			return true;
+		}
+
+		if ( g_SharedQueueSize.load( std::memory_order_relaxed ) > 0 ) {
+			std::lock_guard<std::mutex> lock( g_SharedQueueLock );
+
+			if ( !g_SharedQueue.empty() ) {
+				job = g_SharedQueue.front();
+				g_SharedQueue.pop_front();
+
+				g_SharedQueueSize.fetch_sub( 1, std::memory_order_relaxed );
+				g_PendingJobCount.fetch_sub( 1, std::memory_order_relaxed );
+				return true;
+			}
+		}
+
+		// steal from the others (start right after ourself to spread thieves)
+		const int workerCount = static_cast<int>( g_Workers.size() );
+		const int firstVictim = ( workerIndex >= 0 ) ? workerIndex + 1 : 0;
+
+		for ( int i = 0; i < workerCount; ++i ) {
+			const int victim = ( firstVictim + i ) % workerCount;
+
+			if ( victim == workerIndex ) {
+				continue;
+			}
+
+			if ( g_Workers[victim]->queue.Steal( job ) ) {
+				g_PendingJobCount.fetch_sub( 1, std::memory_order_relaxed );
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void WakeWorkers()
+	{
+		// seq_cst: pairs with the sleeper (sleeping count increment, then pending count load)
+		// with weaker orders both sides can miss each other's store, and the jobs wait for the next submit
+		if ( g_SleepingWorkerCount.load( std::memory_order_seq_cst ) > 0 ) {
+			std::lock_guard<std::mutex> lock( g_SleepLock );
+			g_WakeCondition.notify_all();
+		}
+	}
+
+	// getJob( i ): i-th job_t of the batch
+	template<typename GetJob>
+	void EnqueueJobs( const uint32_t jobCount, const GetJob& getJob )
+	{
+		if ( g_Workers.empty() ) {
+			for ( uint32_t i = 0; i < jobCount; ++i ) {
+				ExecuteJob( getJob( i ) );
+			}
+
+			return;
+		}
+
+		const int workerIndex = t_WorkerIndex;
+
+		if ( workerIndex < 0 ) {
+			std::lock_guard<std::mutex> lock( g_SharedQueueLock );
+
+			for ( uint32_t i = 0; i < jobCount; ++i ) {
+				g_SharedQueue.push_back( getJob( i ) );
+			}
+
+			g_SharedQueueSize.fetch_add( static_cast<int>( jobCount ), std::memory_order_relaxed );
+			g_PendingJobCount.fetch_add( static_cast<int>( jobCount ), std::memory_order_seq_cst );
+		} else {
+			worker_t* worker = g_Workers[workerIndex];
+
+			for ( uint32_t i = 0; i < jobCount; ++i ) {
+				const job_t job = getJob( i );
+
+				g_PendingJobCount.fetch_add( 1, std::memory_order_seq_cst );
+
+				if ( !worker->queue.Push( job ) ) {
+					// queue is full; run it right away
+					g_PendingJobCount.fetch_sub( 1, std::memory_order_relaxed );
+					ExecuteJob( job );
+				}
+			}
+		}
+
+		WakeWorkers();
+	}
+
+	void WorkerThreadLoop( const int workerIndex )
+	{
+		t_WorkerIndex = workerIndex;
+
+		constexpr int SPIN_COUNT = 64;
+		int spinCount = 0;
+
+		while ( !g_IsShuttingDown.load( std::memory_order_acquire ) ) {
+			job_t job = {};
+
+			if ( TakeJob( workerIndex, job ) ) {
+				ExecuteJob( job );
+				spinCount = 0;
+				continue;
+			}
+
+			if ( ++spinCount < SPIN_COUNT ) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock( g_SleepLock );
+			g_SleepingWorkerCount.fetch_add( 1, std::memory_order_seq_cst );
+
+			g_WakeCondition.wait( lock, []() {
+				return g_PendingJobCount.load( std::memory_order_seq_cst ) > 0 || g_IsShuttingDown.load( std::memory_order_acquire );
+			} );
+
+			g_SleepingWorkerCount.fetch_sub( 1, std::memory_order_seq_cst );
+			spinCount = 0;
+		}
+	}
+}
+
+const int Job_Initialize( const int workerCount )
+{
+	if ( !g_Workers.empty() ) {
+		return 1;
+	}
+
+	const int threadCount = ( workerCount < 0 ) ? std::max( 0, Env_GetCPUCoreCount() - 1 ) : workerCount;
+
+	g_IsShuttingDown = false;
+	g_PendingJobCount = 0;
+
+	// the queue indices are cache line aligned, which plain new doesn't honor before c++17
+	for ( int i = 0; i <= threadCount; ++i ) {
+		void* memory = Sys_AlignedAlloc( sizeof( worker_t ), alignof( worker_t ) );
+
+		if ( memory == nullptr ) {
+			Job_Shutdown();
+			return 1;
+		}
+
+		g_Workers.push_back( new ( memory ) worker_t() );
+	}
+
+	// the calling thread owns the first queue
+	t_WorkerIndex = 0;
+
+	for ( int i = 1; i <= threadCount; ++i ) {
+		g_Workers[i]->thread = std::thread( WorkerThreadLoop, i );
+	}
+
+	return 0;
+}
+
+void Job_Shutdown()
+{
+	if ( g_Workers.empty() ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( g_SleepLock );
+		g_IsShuttingDown = true;
+		g_WakeCondition.notify_all();
+	}
+
+	// workers might still be stealing from each other; join everyone first
+	for ( worker_t* worker : g_Workers ) {
+		if ( worker->thread.joinable() ) {
+			worker->thread.join();
+		}
+	}
+
+	for ( worker_t* worker : g_Workers ) {
+		worker->~worker_t();
+		Sys_AlignedFree( worker );
+	}
+
+	g_Workers.clear();
+	g_SharedQueue.clear();
+	g_SharedQueueSize = 0;
+	g_DeferredJobs.clear();
+	g_DeferredJobCount = 0;
+
+	t_WorkerIndex = -1;
+}
+
+const bool Job_IsInitialized()
+{
+	return !g_Workers.empty();
+}
+
+const int Job_GetWorkerCount()
+{
+	return g_Workers.empty() ? 1 : static_cast<int>( g_Workers.size() );
+}
+
+void Job_Submit( const jobDesc_t* jobs, const uint32_t jobCount, jobCounter_t* counter, const jobCounter_t* dependency )
+{
+	if ( jobCount == 0 ) {
+		return;
+	}
+
+	if ( counter != nullptr ) {
+		counter->value.fetch_add( static_cast<int>( jobCount ), std::memory_order_relaxed );
+	}
+
+	const auto getJob = [jobs, counter]( const uint32_t i ) {
+		return job_t{ jobs[i].function, jobs[i].data, counter };
+	};
+
+	// parked until the last job of the dependency completes (no thread blocks on it)
+	if ( dependency != nullptr && !g_Workers.empty() ) {
+		std::lock_guard<std::mutex> lock( g_DeferredJobLock );
+
+		// seq_cst: the completing job either sees this count or we see its decrement
+		g_DeferredJobCount.fetch_add( static_cast<int>( jobCount ), std::memory_order_seq_cst );
+
+		if ( dependency->value.load( std::memory_order_seq_cst ) > 0 ) {
+			for ( uint32_t i = 0; i < jobCount; ++i ) {
+				g_DeferredJobs.push_back( { dependency, getJob( i ) } );
+			}
+
+			return;
+		}
+
+		g_DeferredJobCount.fetch_sub( static_cast<int>( jobCount ), std::memory_order_relaxed );
+	}
+
+	EnqueueJobs( jobCount, getJob );
+}
+
+void Job_Wait( const jobCounter_t* counter )
+{
+	if ( counter == nullptr ) {
+		return;
+	}
+
+	while ( counter->value.load( std::memory_order_acquire ) > 0 ) {
+		job_t job = {};
+
+		if ( !g_Workers.empty() && TakeJob( t_WorkerIndex, job ) ) {
+			ExecuteJob( job );
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+using jobFunction_t = void ( * )( void* data );
+
+// number of unfinished jobs of a batch; jobs can be held back until a counter reaches zero
+struct jobCounter_t
+{
+	jobCounter_t()
+		: value( 0 )
+	{
+
+	}
+
+	std::atomic<int>	value;
+};
+
+struct jobDesc_t
+{
+	jobFunction_t		function;
+	void*				data;		// must stay valid until the job completes
+};
+
+// work stealing job system
+// each worker (and the thread calling Job_Initialize) owns a lock-free deque; idle workers steal from the others
+// threads outside of the system can submit jobs too (slower shared queue)
+// when the system is not initialized, jobs run inline on the submitting thread
+const int	Job_Initialize( const int workerCount = -1 ); // -1: one worker per core (minus the calling thread)
+void		Job_Shutdown();
+const bool	Job_IsInitialized();
+const int	Job_GetWorkerCount(); // including the thread that initialized the system
+
+// jobs with a dependency are queued by the job completing it (no thread waits on it); it must outlive them
+void		Job_Submit( const jobDesc_t* jobs, const uint32_t jobCount, jobCounter_t* counter, const jobCounter_t* dependency = nullptr );
+void		Job_Wait( const jobCounter_t* counter ); // runs pending jobs while waiting
+
+// splits [begin, end) in batches of 'batchSize' elements and waits for completion; func( batchBegin, batchEnd )
+template<typename Func>
+void Job_ParallelFor( const uint32_t begin, const uint32_t end, const uint32_t batchSize, const Func& func )
+{
+	if ( end <= begin ) {
+		return;
+	}
+
+	const uint32_t elementCount	= end - begin,
+				   batchCount	= ( batchSize == 0 ) ? 1 : ( elementCount + batchSize - 1 ) / batchSize;
+
+	if ( batchCount <= 1 || !Job_IsInitialized() ) {
+		func( begin, end );
+		return;
+	}
+
+	struct rangeJob_t
+	{
+		const Func*	function;
+		uint32_t	begin;
+		uint32_t	end;
+	};
+
+	std::vector<rangeJob_t>	ranges( batchCount );
+	std::vector<jobDesc_t>	jobs( batchCount );
+
+	for ( uint32_t i = 0; i < batchCount; ++i ) {
+		ranges[i].function	= &func;
+		ranges[i].begin		= begin + i * batchSize;
+		ranges[i].end		= ( i == batchCount - 1 ) ? end : ranges[i].begin + batchSize;
+
+		jobs[i].function	= []( void* data ) {
+			const rangeJob_t* range = static_cast<const rangeJob_t*>( data );
+			( *range->function )( range->begin, range->end );
+		};
+		jobs[i].data		= &ranges[i];
+	}
+
+	jobCounter_t counter;
+	Job_Submit( jobs.data(), batchCount, &counter );
+	Job_Wait( &counter );
+}
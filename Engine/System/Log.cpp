@@ -0,0 +1,21 @@
+#include "Shared.h"
+#include "Log.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+void Log_Printf( const char* format, ... )
+{
+	char message[1024];
+
+	va_list arguments;
+	va_start( arguments, format );
+	vsnprintf( message, sizeof( message ), format, arguments );
+	va_end( arguments );
+
+#if defined( _WIN32 )
+	OutputDebugStringA( message );
+#else
+	fputs( message, stderr );
+#endif
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// printf style; the debugger output on windows, stderr elsewhere
+// thread safe; messages longer than 1KB are truncated
+void	Log_Printf( const char* format, ... );
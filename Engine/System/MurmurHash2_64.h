@@ -1,6 +1,6 @@
 #pragma once
 
-typedef unsigned __int64 uint64_t;
+#include <cstdint>
 
 // 64-bit hash for 64-bit platforms
 uint64_t MurmurHash64A( const void * key, int len, unsigned int seed );
@@ -0,0 +1,176 @@
+#include "Shared.h"
+#include "Platform.h"
+
+#include <stdint.h>
+
+#if defined( _WIN32 )
+#include <malloc.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if !defined( _WIN32 )
+	// wchar_t holds utf-32 code points here
+	std::string GetUtf8Path( const std::wstring& path )
+	{
+		std::string utf8Path;
+		utf8Path.reserve( path.size() );
+
+		for ( const wchar_t character : path ) {
+			const uint32_t codePoint = static_cast<uint32_t>( character );
+
+			if ( codePoint < 0x80 ) {
+				utf8Path.push_back( static_cast<char>( codePoint ) );
+			} else if ( codePoint < 0x800 ) {
+				utf8Path.push_back( static_cast<char>( 0xC0 | ( codePoint >> 6 ) ) );
+				utf8Path.push_back( static_cast<char>( 0x80 | ( codePoint & 0x3F ) ) );
+			} else if ( codePoint < 0x10000 ) {
+				utf8Path.push_back( static_cast<char>( 0xE0 | ( codePoint >> 12 ) ) );
+				utf8Path.push_back( static_cast<char>( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+				utf8Path.push_back( static_cast<char>( 0x80 | ( codePoint & 0x3F ) ) );
+			} else {
+				utf8Path.push_back( static_cast<char>( 0xF0 | ( codePoint >> 18 ) ) );
+				utf8Path.push_back( static_cast<char>( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) ) );
+				utf8Path.push_back( static_cast<char>( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+				utf8Path.push_back( static_cast<char>( 0x80 | ( codePoint & 0x3F ) ) );
+			}
+		}
+
+		return utf8Path;
+	}
+
+	std::wstring GetWidePath( const char* utf8Path )
+	{
+		std::wstring widePath;
+
+		for ( const unsigned char* character = reinterpret_cast<const unsigned char*>( utf8Path ); *character != '\0'; ) {
+			uint32_t codePoint = *character++;
+			int continuationCount = 0;
+
+			if ( codePoint >= 0xF0 ) {
+				codePoint &= 0x07;
+				continuationCount = 3;
+			} else if ( codePoint >= 0xE0 ) {
+				codePoint &= 0x0F;
+				continuationCount = 2;
+			} else if ( codePoint >= 0xC0 ) {
+				codePoint &= 0x1F;
+				continuationCount = 1;
+			}
+
+			// a truncated sequence keeps the bits read so far
+			for ( ; continuationCount > 0 && ( *character & 0xC0 ) == 0x80; --continuationCount ) {
+				codePoint = ( codePoint << 6 ) | ( *character++ & 0x3F );
+			}
+
+			widePath.push_back( static_cast<wchar_t>( codePoint ) );
+		}
+
+		return widePath;
+	}
+#endif
+}
+
+void* Sys_AlignedAlloc( const std::size_t size, const std::size_t alignment )
+{
+#if defined( _WIN32 )
+	return _aligned_malloc( size, alignment );
+#else
+	void* memory = nullptr;
+
+	// posix_memalign wants at least the alignment of a pointer
+	if ( posix_memalign( &memory, ( alignment < sizeof( void* ) ) ? sizeof( void* ) : alignment, size ) != 0 ) {
+		return nullptr;
+	}
+
+	return memory;
+#endif
+}
+
+void Sys_AlignedFree( void* memory )
+{
+#if defined( _WIN32 )
+	_aligned_free( memory );
+#else
+	free( memory );
+#endif
+}
+
+FILE* Sys_OpenFile( const wchar_t* path, const char* mode )
+{
+#if defined( _WIN32 )
+	wchar_t wideMode[8] = {};
+
+	for ( int i = 0; i < 7 && mode[i] != '\0'; ++i ) {
+		wideMode[i] = static_cast<wchar_t>( mode[i] );
+	}
+
+	return _wfopen( path, wideMode );
+#else
+	return fopen( GetUtf8Path( path ).c_str(), mode );
+#endif
+}
+
+const bool Sys_CreateDirectory( const wchar_t* path )
+{
+#if defined( _WIN32 )
+	return CreateDirectoryW( path, NULL ) != FALSE;
+#else
+	return mkdir( GetUtf8Path( path ).c_str(), 0755 ) == 0;
+#endif
+}
+
+const bool Sys_DeleteFile( const wchar_t* path )
+{
+#if defined( _WIN32 )
+	return DeleteFileW( path ) != FALSE;
+#else
+	return unlink( GetUtf8Path( path ).c_str() ) == 0;
+#endif
+}
+
+void Sys_ListDirectory( const std::wstring& directory, const std::wstring& prefix, std::vector<std::wstring>& fileNames )
+{
+#if defined( _WIN32 )
+	const std::wstring filter = directory + prefix + L"*";
+
+	WIN32_FIND_DATAW findData;
+	HANDLE findHandle = FindFirstFileW( filter.c_str(), &findData );
+
+	if ( findHandle == INVALID_HANDLE_VALUE ) {
+		return;
+	}
+
+	do {
+		if ( ( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) == 0 ) {
+			fileNames.push_back( findData.cFileName );
+		}
+	} while ( FindNextFileW( findHandle, &findData ) );
+
+	FindClose( findHandle );
+#else
+	DIR* directoryHandle = opendir( GetUtf8Path( directory ).c_str() );
+
+	if ( directoryHandle == nullptr ) {
+		return;
+	}
+
+	while ( const dirent* entry = readdir( directoryHandle ) ) {
+		if ( entry->d_type == DT_DIR ) {
+			continue;
+		}
+
+		std::wstring fileName = GetWidePath( entry->d_name );
+
+		if ( fileName.compare( 0, prefix.size(), prefix ) == 0 ) {
+			fileNames.push_back( std::move( fileName ) );
+		}
+	}
+
+	closedir( directoryHandle );
+#endif
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// os specific services of the portable modules (everything but the window, the inputs and the d3d11 backend)
+// paths are wide strings; they are converted to utf-8 on systems whose file api takes bytes
+
+void*			Sys_AlignedAlloc( const std::size_t size, const std::size_t alignment ); // alignment: power of two; null on failure
+void			Sys_AlignedFree( void* memory ); // memory from Sys_AlignedAlloc (or null)
+
+FILE*			Sys_OpenFile( const wchar_t* path, const char* mode ); // fopen modes
+const bool		Sys_CreateDirectory( const wchar_t* path ); // false if it already exists
+const bool		Sys_DeleteFile( const wchar_t* path );
+
+// names (not paths) of the files of 'directory' starting with 'prefix'; directory ends with a separator
+void			Sys_ListDirectory( const std::wstring& directory, const std::wstring& prefix, std::vector<std::wstring>& fileNames );
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// fixed size object pool
+// objects live in contiguous chunks of 'ChunkSize' slots and are recycled through an intrusive free list (O(1) alloc/free)
+// Clear (or the destructor) releases every live object and every chunk at once
+template<typename T, std::size_t ChunkSize = 64>
+class PoolAllocator
+{
+public:
+	inline std::size_t	GetAllocatedCount() const	{ return allocatedCount; }
+	inline std::size_t	GetCapacity() const			{ return chunks.size() * ChunkSize; }
+	inline std::size_t	GetMemoryUsage() const		{ return chunks.size() * sizeof( chunk_t ); }
+
+public:
+	PoolAllocator()
+		: freeList( nullptr )
+		, allocatedCount( 0 )
+	{
+
+	}
+
+	PoolAllocator( PoolAllocator& ) = delete;
+
+	~PoolAllocator()
+	{
+		Clear();
+	}
+
+	template<typename... Args>
+	T* Allocate( Args&&... args )
+	{
+		if ( freeList == nullptr ) {
+			AllocateChunk();
+		}
+
+		slot_t* slot = freeList;
+		freeList = slot->nextFree;
+
+		T* object = new ( &slot->storage ) T( std::forward<Args>( args )... );
+
+		slot->nextFree		= nullptr;
+		slot->isAllocated	= true;
+
+		allocatedCount++;
+
+		return object;
+	}
+
+	void Free( T* object )
+	{
+		if ( object == nullptr ) {
+			return;
+		}
+
+		// storage is the first member of a slot
+		slot_t* slot = reinterpret_cast<slot_t*>( object );
+
+		if ( !slot->isAllocated ) {
+			return; // double free
+		}
+
+		object->~T();
+
+		slot->isAllocated	= false;
+		slot->nextFree		= freeList;
+		freeList			= slot;
+
+		allocatedCount--;
+	}
+
+	// visit live objects in memory order
+	template<typename Func>
+	void ForEach( Func func )
+	{
+		for ( chunk_t* chunk : chunks ) {
+			for ( slot_t& slot : chunk->slots ) {
+				if ( slot.isAllocated ) {
+					func( reinterpret_cast<T*>( &slot.storage ) );
+				}
+			}
+		}
+	}
+
+	void Clear()
+	{
+		for ( chunk_t* chunk : chunks ) {
+			for ( slot_t& slot : chunk->slots ) {
+				if ( slot.isAllocated ) {
+					reinterpret_cast<T*>( &slot.storage )->~T();
+				}
+			}
+
+			delete chunk;
+		}
+
+		chunks.clear();
+
+		freeList		= nullptr;
+		allocatedCount	= 0;
+	}
+
+private:
+	struct slot_t
+	{
+		typename std::aligned_storage<sizeof( T ), alignof( T )>::type storage;
+		slot_t*		nextFree;
+		bool		isAllocated;
+	};
+
+	struct chunk_t
+	{
+		slot_t		slots[ChunkSize];
+	};
+
+	std::vector<chunk_t*>	chunks;
+	slot_t*					freeList;
+	std::size_t				allocatedCount;
+
+private:
+	void AllocateChunk()
+	{
+		chunk_t* chunk = new chunk_t();
+		chunks.push_back( chunk );
+
+		// push slots backward so that they get allocated in memory order
+		for ( std::size_t i = ChunkSize; i-- > 0; ) {
+			chunk->slots[i].isAllocated	= false;
+			chunk->slots[i].nextFree	= freeList;
+			freeList					= &chunk->slots[i];
+		}
+	}
+};
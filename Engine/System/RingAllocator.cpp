@@ -0,0 +1,113 @@
+#include "Shared.h"
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator()
+	: capacity( 0 )
+	, alignment( 1 )
+	, head( 0 )
+	, tail( 0 )
+	, usedSize( 0 )
+	, frameSize( 0 )
+{
+
+}
+
+void RingAllocator::Initialize( const std::size_t ringCapacity, const std::size_t ringAlignment )
+{
+	alignment	= ( ringAlignment == 0 ) ? 1 : ringAlignment;
+	capacity	= ringCapacity - ( ringCapacity % alignment );
+
+	Reset();
+}
+
+void RingAllocator::Reset()
+{
+	head		= 0;
+	tail		= 0;
+	usedSize	= 0;
+	frameSize	= 0;
+
+	frames.clear();
+}
+
+std::size_t RingAllocator::Allocate( const std::size_t size )
+{
+	const std::size_t alignedSize = ( size + alignment - 1 ) / alignment * alignment;
+
+	std::size_t skippedSize = 0;
+	const std::size_t offset = FindOffset( alignedSize, skippedSize );
+
+	if ( offset == INVALID_OFFSET ) {
+		return INVALID_OFFSET;
+	}
+
+	if ( usedSize == 0 ) {
+		tail = 0;
+	}
+
+	head		= offset + alignedSize;
+	usedSize	+= skippedSize + alignedSize;
+	frameSize	+= skippedSize + alignedSize;
+
+	return offset;
+}
+
+const bool RingAllocator::CanAllocate( const std::size_t size ) const
+{
+	const std::size_t alignedSize = ( size + alignment - 1 ) / alignment * alignment;
+
+	std::size_t skippedSize = 0;
+	return FindOffset( alignedSize, skippedSize ) != INVALID_OFFSET;
+}
+
+void RingAllocator::EndFrame( const uint64_t fence )
+{
+	frames.push_back( { fence, head, frameSize } );
+	frameSize = 0;
+}
+
+void RingAllocator::Retire( const uint64_t completedFence )
+{
+	while ( !frames.empty() && frames.front().fence <= completedFence ) {
+		// empty frames might predate a restart from the beginning of the range (see FindOffset)
+		if ( frames.front().size != 0 ) {
+			tail = frames.front().head;
+		}
+
+		usedSize -= frames.front().size;
+
+		frames.pop_front();
+	}
+}
+
+std::size_t RingAllocator::FindOffset( const std::size_t alignedSize, std::size_t& skippedSize ) const
+{
+	skippedSize = 0;
+
+	if ( alignedSize == 0 || alignedSize > capacity - usedSize ) {
+		return INVALID_OFFSET;
+	}
+
+	// nothing in use; restart from the beginning to get the largest block possible
+	if ( usedSize == 0 ) {
+		return 0;
+	}
+
+	// free space is [head, capacity) + [0, tail) when the head is ahead of the tail
+	if ( head > tail ) {
+		if ( head + alignedSize <= capacity ) {
+			return head;
+		}
+
+		// wrap around; the end of the range is wasted until this frame retires
+		if ( alignedSize <= tail ) {
+			skippedSize = capacity - head;
+			return 0;
+		}
+
+		return INVALID_OFFSET;
+	}
+
+	// free space is [head, tail); head == tail means the ring is full (caught above)
+	return ( head + alignedSize <= tail ) ? head : INVALID_OFFSET;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <deque>
+
+// offset allocator over a circular range [0, capacity); memory is handed out linearly and reclaimed in order
+// allocations made between two EndFrame calls belong to that frame; a frame is reclaimed once its fence is retired
+// blocks never straddle the end of the range (the tail is skipped and counted as used until the frame retires)
+// pure bookkeeping; the caller owns the memory the offsets refer to
+class RingAllocator
+{
+public:
+	static constexpr std::size_t	INVALID_OFFSET = static_cast<std::size_t>( -1 );
+
+public:
+	inline std::size_t	GetCapacity() const			{ return capacity; }
+	inline std::size_t	GetUsedSize() const			{ return usedSize; }
+	inline std::size_t	GetPendingFrameCount() const	{ return frames.size(); }
+
+public:
+						RingAllocator();
+						RingAllocator( RingAllocator& ) = delete;
+						~RingAllocator() = default;
+
+	void				Initialize( const std::size_t capacity, const std::size_t alignment ); // capacity must be a multiple of the alignment
+	void				Reset(); // everything is free again; pending frames are forgotten
+
+	std::size_t			Allocate( const std::size_t size ); // aligned offset or INVALID_OFFSET if there is not enough contiguous space
+	const bool			CanAllocate( const std::size_t size ) const;
+
+	void				EndFrame( const uint64_t fence ); // closes the current frame; fences must be increasing
+	void				Retire( const uint64_t completedFence ); // frees every frame whose fence is <= completedFence
+
+private:
+	struct frame_t
+	{
+		uint64_t		fence;
+		std::size_t		head;	// head at the end of the frame; becomes the tail once retired
+		std::size_t		size;	// allocated during the frame (skipped tail included)
+	};
+
+private:
+	std::size_t			capacity;
+	std::size_t			alignment;
+
+	std::size_t			head;
+	std::size_t			tail;
+	std::size_t			usedSize;
+	std::size_t			frameSize;
+
+	std::deque<frame_t>	frames;
+
+private:
+	std::size_t			FindOffset( const std::size_t alignedSize, std::size_t& skippedSize ) const;
+};
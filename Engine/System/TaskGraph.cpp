@@ -0,0 +1,289 @@
+#include "Shared.h"
+#include "TaskGraph.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <set>
+
+using taskClock_t = std::chrono::high_resolution_clock;
+
+struct TaskGraph::execution_t
+{
+	struct job_t
+	{
+		TaskGraph*			graph;
+		execution_t*		execution;
+		uint32_t			task;
+	};
+
+	taskClock_t::time_point	startTime;
+	std::vector<job_t>		jobs;				// by task
+
+	std::mutex				readyLock;
+	std::set<uint32_t>		readyMainTasks;		// by declaration order
+	uint32_t				finishedCount;
+	jobCounter_t			wakeCounter;		// 1 while the main thread has nothing to run
+};
+
+TaskGraph::TaskGraph()
+	: totalTime( 0.0 )
+{
+
+}
+
+void TaskGraph::Reset()
+{
+	tasks.clear();
+	totalTime = 0.0;
+}
+
+uint32_t TaskGraph::AddTask( const char* name, execute_t execute, const bool isMainThread )
+{
+	std::unique_ptr<task_t> task( new task_t() );
+	task->execute				= std::move( execute );
+	task->dependencyCount		= 0;
+	task->pendingCount			= 0;
+	task->hasFailedDependency	= false;
+	task->timing				= { name, 0.0, 0.0, 0, isMainThread };
+
+	tasks.push_back( std::move( task ) );
+
+	return static_cast<uint32_t>( tasks.size() - 1 );
+}
+
+void TaskGraph::DependsOn( const uint32_t task, const uint32_t dependency )
+{
+	tasks[dependency]->dependents.push_back( task );
+	tasks[task]->dependencyCount++;
+}
+
+int TaskGraph::Execute()
+{
+	if ( HasCycle() ) {
+		return -1;
+	}
+
+	const uint32_t taskCount = GetTaskCount();
+
+	execution_t execution;
+	execution.startTime			= taskClock_t::now();
+	execution.finishedCount		= 0;
+	execution.wakeCounter.value	= 1;
+
+	for ( uint32_t i = 0; i < taskCount; ++i ) {
+		task_t* task = tasks[i].get();
+		task->pendingCount			= task->dependencyCount;
+		task->hasFailedDependency	= false;
+		task->timing.start			= 0.0;
+		task->timing.duration		= 0.0;
+		task->timing.status			= 0;
+
+		execution.jobs.push_back( { this, &execution, i } );
+	}
+
+	for ( uint32_t i = 0; i < taskCount; ++i ) {
+		if ( tasks[i]->dependencyCount == 0 ) {
+			Ready( execution, i );
+		}
+	}
+
+	for ( ;; ) {
+		uint32_t mainTask = ~0u;
+
+		{
+			std::lock_guard<std::mutex> lock( execution.readyLock );
+
+			if ( !execution.readyMainTasks.empty() ) {
+				mainTask = *execution.readyMainTasks.begin();
+				execution.readyMainTasks.erase( execution.readyMainTasks.begin() );
+			} else if ( execution.finishedCount == taskCount ) {
+				break;
+			} else {
+				execution.wakeCounter.value.store( 1, std::memory_order_relaxed );
+			}
+		}
+
+		if ( mainTask != ~0u ) {
+			Run( execution, mainTask );
+			continue;
+		}
+
+		// runs worker tasks until a main thread task is ready (or everything is done)
+		Job_Wait( &execution.wakeCounter );
+	}
+
+	totalTime = std::chrono::duration<double, std::milli>( taskClock_t::now() - execution.startTime ).count();
+
+	for ( const std::unique_ptr<task_t>& task : tasks ) {
+		if ( task->timing.status != 0 && task->timing.status != TASK_GRAPH_SKIPPED ) {
+			return task->timing.status;
+		}
+	}
+
+	return 0;
+}
+
+double TaskGraph::GetCriticalPathTime() const
+{
+	const uint32_t taskCount = GetTaskCount();
+
+	// tasks in dependency order; a task starts once its slowest dependency is done
+	std::vector<uint32_t> pendingCounts( taskCount );
+	std::vector<double> startTimes( taskCount, 0.0 );
+	std::vector<uint32_t> readyTasks;
+
+	for ( uint32_t i = 0; i < taskCount; ++i ) {
+		pendingCounts[i] = tasks[i]->dependencyCount;
+
+		if ( pendingCounts[i] == 0 ) {
+			readyTasks.push_back( i );
+		}
+	}
+
+	double criticalPathTime = 0.0;
+
+	while ( !readyTasks.empty() ) {
+		const uint32_t task = readyTasks.back();
+		readyTasks.pop_back();
+
+		const double endTime = startTimes[task] + tasks[task]->timing.duration;
+		criticalPathTime = std::max( criticalPathTime, endTime );
+
+		for ( const uint32_t dependent : tasks[task]->dependents ) {
+			startTimes[dependent] = std::max( startTimes[dependent], endTime );
+
+			if ( --pendingCounts[dependent] == 0 ) {
+				readyTasks.push_back( dependent );
+			}
+		}
+	}
+
+	return criticalPathTime;
+}
+
+void TaskGraph::WriteReport( std::string& report ) const
+{
+	char line[256];
+	double serialTime = 0.0;
+
+	for ( const std::unique_ptr<task_t>& task : tasks ) {
+		const taskTiming_t& timing = task->timing;
+		serialTime += timing.duration;
+
+		snprintf( line, sizeof( line ), "\t%-24s %-6s start %9.3f ms | %9.3f ms", timing.name, ( timing.isMainThread ? "main" : "worker" ), timing.start, timing.duration );
+		report += line;
+
+		if ( timing.status == TASK_GRAPH_SKIPPED ) {
+			report += " | skipped";
+		} else if ( timing.status != 0 ) {
+			snprintf( line, sizeof( line ), " | failed (%i)", timing.status );
+			report += line;
+		}
+
+		report += '\n';
+	}
+
+	snprintf( line, sizeof( line ), "\ttotal %.3f ms | critical path %.3f ms | serial %.3f ms\n", totalTime, GetCriticalPathTime(), serialTime );
+	report += line;
+}
+
+void TaskGraph::RunJob( void* data )
+{
+	const execution_t::job_t* job = static_cast<const execution_t::job_t*>( data );
+	job->graph->Run( *job->execution, job->task );
+}
+
+const bool TaskGraph::HasCycle() const
+{
+	const uint32_t taskCount = GetTaskCount();
+
+	std::vector<uint32_t> pendingCounts( taskCount );
+	std::vector<uint32_t> readyTasks;
+
+	for ( uint32_t i = 0; i < taskCount; ++i ) {
+		pendingCounts[i] = tasks[i]->dependencyCount;
+
+		if ( pendingCounts[i] == 0 ) {
+			readyTasks.push_back( i );
+		}
+	}
+
+	uint32_t visitedCount = 0;
+
+	while ( !readyTasks.empty() ) {
+		const uint32_t task = readyTasks.back();
+		readyTasks.pop_back();
+		visitedCount++;
+
+		for ( const uint32_t dependent : tasks[task]->dependents ) {
+			if ( --pendingCounts[dependent] == 0 ) {
+				readyTasks.push_back( dependent );
+			}
+		}
+	}
+
+	return visitedCount != taskCount;
+}
+
+void TaskGraph::Ready( execution_t& execution, const uint32_t task )
+{
+	task_t* readyTask = tasks[task].get();
+
+	if ( readyTask->hasFailedDependency.load( std::memory_order_acquire ) ) {
+		readyTask->timing.status = TASK_GRAPH_SKIPPED;
+		Finish( execution, task );
+		return;
+	}
+
+	if ( readyTask->timing.isMainThread ) {
+		std::lock_guard<std::mutex> lock( execution.readyLock );
+
+		execution.readyMainTasks.insert( task );
+		execution.wakeCounter.value.store( 0, std::memory_order_release );
+		return;
+	}
+
+	const jobDesc_t job = { &TaskGraph::RunJob, &execution.jobs[task] };
+	Job_Submit( &job, 1, nullptr );
+}
+
+void TaskGraph::Run( execution_t& execution, const uint32_t task )
+{
+	task_t* runningTask = tasks[task].get();
+
+	const taskClock_t::time_point startTime = taskClock_t::now();
+	runningTask->timing.status		= runningTask->execute();
+
+	const taskClock_t::time_point endTime = taskClock_t::now();
+	runningTask->timing.start		= std::chrono::duration<double, std::milli>( startTime - execution.startTime ).count();
+	runningTask->timing.duration	= std::chrono::duration<double, std::milli>( endTime - startTime ).count();
+
+	Finish( execution, task );
+}
+
+void TaskGraph::Finish( execution_t& execution, const uint32_t task )
+{
+	const task_t* finishedTask = tasks[task].get();
+
+	for ( const uint32_t dependent : finishedTask->dependents ) {
+		task_t* dependentTask = tasks[dependent].get();
+
+		if ( finishedTask->timing.status != 0 ) {
+			dependentTask->hasFailedDependency.store( true, std::memory_order_relaxed );
+		}
+
+		// the last dependency to finish readies the task
+		if ( dependentTask->pendingCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) {
+			Ready( execution, dependent );
+		}
+	}
+
+	// the execution is gone once the main thread sees every task finished: nothing touches it past this point
+	std::lock_guard<std::mutex> lock( execution.readyLock );
+
+	if ( ++execution.finishedCount == GetTaskCount() ) {
+		execution.wakeCounter.value.store( 0, std::memory_order_release );
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr int	TASK_GRAPH_SKIPPED	= -1; // status of a task whose dependency failed
+
+struct taskTiming_t
+{
+	const char*		name;
+	double			start;			// ms since Execute
+	double			duration;		// ms
+	int				status;			// returned by the task (0: success) or TASK_GRAPH_SKIPPED
+	bool			isMainThread;
+};
+
+// one-shot tasks with explicit dependencies (e.g. engine startup); a task runs once every task it depends on succeeded
+// worker tasks go to the job system: file reads, shader blobs and resource creation (the d3d11 device is free threaded)
+// main thread tasks run on the thread calling Execute (anything using the immediate context), in declaration order
+// when several are ready; the calling thread helps with the worker tasks meanwhile
+// a failing task (non zero status) skips everything depending on it; independent tasks still run
+class TaskGraph
+{
+public:
+	using execute_t = std::function<int()>;
+
+public:
+	inline uint32_t				GetTaskCount() const					{ return static_cast<uint32_t>( tasks.size() ); }
+	inline const taskTiming_t&	GetTiming( const uint32_t task ) const	{ return tasks[task]->timing; }
+	inline double				GetTotalTime() const					{ return totalTime; } // ms, previous Execute
+
+public:
+								TaskGraph();
+								TaskGraph( TaskGraph& ) = delete;
+								~TaskGraph() = default;
+
+	void						Reset();
+
+	uint32_t					AddTask( const char* name, execute_t execute, const bool isMainThread = false );
+	void						DependsOn( const uint32_t task, const uint32_t dependency );
+
+	// 0 or the status of the first failed task (declaration order); -1 if the dependencies have a cycle
+	int							Execute();
+
+	double						GetCriticalPathTime() const; // ms; the longest chain of dependent tasks, previous Execute
+	void						WriteReport( std::string& report ) const; // a line per task, in declaration order
+
+private:
+	struct task_t
+	{
+		execute_t				execute;
+		std::vector<uint32_t>	dependents;
+		uint32_t				dependencyCount;
+		std::atomic<uint32_t>	pendingCount;			// dependencies left
+		std::atomic<bool>		hasFailedDependency;
+		taskTiming_t			timing;
+	};
+
+	struct execution_t;
+
+private:
+	std::vector<std::unique_ptr<task_t>>	tasks;		// stable addresses: jobs point to them
+	double									totalTime;
+
+private:
+	static void					RunJob( void* data );
+
+	const bool					HasCycle() const;
+	void						Ready( execution_t& execution, const uint32_t task );
+	void						Run( execution_t& execution, const uint32_t task );
+	void						Finish( execution_t& execution, const uint32_t task );
+};
@@ -1,12 +1,12 @@
 #include "Shared.h"
 #include "Timer.h"
 
-void Timer_Start( timer_t* timer )
+void Timer_Start( highResTimer_t* timer )
 {
 	Timer_Reset( timer );
 }
 
-double Timer_GetDelta( timer_t* timer )
+double Timer_GetDelta( highResTimer_t* timer )
 {
 	std::chrono::high_resolution_clock::time_point currTime = std::chrono::high_resolution_clock::now();
 
@@ -17,13 +17,13 @@ double Timer_GetDelta( timer_t* timer )
 	return timer->deltaTime;
 }
 
-uint64_t Timer_GetElapsed( timer_t* timer )
+uint64_t Timer_GetElapsed( highResTimer_t* timer )
 {
 	std::chrono::duration<double> addTime = std::chrono::high_resolution_clock::now() - timer->startTime;
 	return static_cast<uint64_t>( timer->totalTime + addTime.count() );
 }
 
-void Timer_Reset( timer_t* timer )
+void Timer_Reset( highResTimer_t* timer )
 {
 	timer->startTime = std::chrono::high_resolution_clock::now();
 	timer->prevTime = timer->startTime;
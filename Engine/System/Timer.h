@@ -1,8 +1,9 @@
 #pragma once
 
 #include <chrono>
+#include <stdint.h>
 
-struct timer_t
+struct highResTimer_t
 {
 	std::chrono::high_resolution_clock::time_point	startTime;
 	std::chrono::high_resolution_clock::time_point	prevTime;
@@ -10,9 +11,9 @@ struct timer_t
 	double											deltaTime;
 };
 
-static_assert( sizeof( timer_t ) == 32, "timer_t is NOT cache friendly" );
+static_assert( sizeof( highResTimer_t ) == 32, "highResTimer_t is NOT cache friendly" );
 
-void		Timer_Start( timer_t* timer );
-double		Timer_GetDelta( timer_t* timer );
-uint64_t	Timer_GetElapsed( timer_t* timer );
-void		Timer_Reset( timer_t* timer );
+void		Timer_Start( highResTimer_t* timer );
+double		Timer_GetDelta( highResTimer_t* timer );
+uint64_t	Timer_GetElapsed( highResTimer_t* timer );
+void		Timer_Reset( highResTimer_t* timer );
@@ -0,0 +1,459 @@
+#include "Shared.h"
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+namespace
+{
+	// index of the highest/lowest set bit; value must not be 0
+	uint32_t FindLastSet( const uint32_t value )
+	{
+#if defined( _MSC_VER )
+		unsigned long index = 0;
+		_BitScanReverse( &index, value );
+		return static_cast<uint32_t>( index );
+#else
+		return 31 - static_cast<uint32_t>( __builtin_clz( value ) );
+#endif
+	}
+
+	uint32_t FindFirstSet( const uint32_t value )
+	{
+#if defined( _MSC_VER )
+		unsigned long index = 0;
+		_BitScanForward( &index, value );
+		return static_cast<uint32_t>( index );
+#else
+		return static_cast<uint32_t>( __builtin_ctz( value ) );
+#endif
+	}
+}
+
+TlsfAllocator::TlsfAllocator()
+	: capacity( 0 )
+	, usedSize( 0 )
+	, firstLevelBitmap( 0 )
+	, secondLevelBitmaps{}
+	, bins{}
+{
+
+}
+
+void TlsfAllocator::Initialize( const uint32_t allocatorCapacity )
+{
+	capacity = allocatorCapacity;
+
+	Reset();
+}
+
+void TlsfAllocator::Reset()
+{
+	ClearBlocks();
+
+	if ( capacity != 0 ) {
+		InsertFreeBlock( CreateBlock( 0, capacity ) );
+	}
+}
+
+void TlsfAllocator::ClearBlocks()
+{
+	usedSize			= 0;
+	firstLevelBitmap	= 0;
+
+	for ( uint32_t firstLevel = 0; firstLevel < FIRST_LEVEL_COUNT; ++firstLevel ) {
+		secondLevelBitmaps[firstLevel] = 0;
+
+		for ( uint32_t secondLevel = 0; secondLevel < SECOND_LEVEL_COUNT; ++secondLevel ) {
+			bins[firstLevel][secondLevel] = INVALID_BLOCK;
+		}
+	}
+
+	blocks.clear();
+	unusedBlocks.clear();
+	allocations.clear();
+}
+
+uint32_t TlsfAllocator::Allocate( const uint32_t size )
+{
+	if ( size == 0 || size > capacity - usedSize ) {
+		return INVALID_OFFSET;
+	}
+
+	const uint32_t block = FindFreeBlock( size );
+
+	if ( block == INVALID_BLOCK ) {
+		return INVALID_OFFSET;
+	}
+
+	RemoveFreeBlock( block );
+
+	// the remainder goes back to the bins as a block of its own
+	if ( blocks[block].size > size ) {
+		const uint32_t remainder = CreateBlock( blocks[block].offset + size, blocks[block].size - size );
+
+		blocks[remainder].prevPhysical = block;
+		blocks[remainder].nextPhysical = blocks[block].nextPhysical;
+
+		if ( blocks[block].nextPhysical != INVALID_BLOCK ) {
+			blocks[blocks[block].nextPhysical].prevPhysical = remainder;
+		}
+
+		blocks[block].nextPhysical	= remainder;
+		blocks[block].size			= size;
+
+		InsertFreeBlock( remainder );
+	}
+
+	blocks[block].isFree = false;
+	usedSize += size;
+
+	allocations[blocks[block].offset] = block;
+
+	return blocks[block].offset;
+}
+
+void TlsfAllocator::Free( const uint32_t offset )
+{
+	const auto allocation = allocations.find( offset );
+
+	if ( allocation == allocations.end() ) {
+		return;
+	}
+
+	uint32_t block = allocation->second;
+	allocations.erase( allocation );
+
+	usedSize -= blocks[block].size;
+
+	// merge with the free neighbours; the merged block keeps the lowest offset
+	const uint32_t next = blocks[block].nextPhysical;
+
+	if ( next != INVALID_BLOCK && blocks[next].isFree ) {
+		RemoveFreeBlock( next );
+
+		blocks[block].size			+= blocks[next].size;
+		blocks[block].nextPhysical	= blocks[next].nextPhysical;
+
+		if ( blocks[next].nextPhysical != INVALID_BLOCK ) {
+			blocks[blocks[next].nextPhysical].prevPhysical = block;
+		}
+
+		unusedBlocks.push_back( next );
+	}
+
+	const uint32_t prev = blocks[block].prevPhysical;
+
+	if ( prev != INVALID_BLOCK && blocks[prev].isFree ) {
+		RemoveFreeBlock( prev );
+
+		blocks[prev].size			+= blocks[block].size;
+		blocks[prev].nextPhysical	= blocks[block].nextPhysical;
+
+		if ( blocks[block].nextPhysical != INVALID_BLOCK ) {
+			blocks[blocks[block].nextPhysical].prevPhysical = prev;
+		}
+
+		unusedBlocks.push_back( block );
+		block = prev;
+	}
+
+	InsertFreeBlock( block );
+}
+
+uint32_t TlsfAllocator::GetSize( const uint32_t offset ) const
+{
+	const auto allocation = allocations.find( offset );
+	return ( allocation != allocations.end() ) ? blocks[allocation->second].size : 0;
+}
+
+uint32_t TlsfAllocator::GetLargestFreeBlock() const
+{
+	if ( firstLevelBitmap == 0 ) {
+		return 0;
+	}
+
+	// the largest block is in the highest non empty bin, but not necessarily first in it
+	const uint32_t firstLevel	= FindLastSet( firstLevelBitmap );
+	const uint32_t secondLevel	= FindLastSet( secondLevelBitmaps[firstLevel] );
+
+	uint32_t largestSize = 0;
+
+	for ( uint32_t block = bins[firstLevel][secondLevel]; block != INVALID_BLOCK; block = blocks[block].nextFree ) {
+		largestSize = ( blocks[block].size > largestSize ) ? blocks[block].size : largestSize;
+	}
+
+	return largestSize;
+}
+
+float TlsfAllocator::GetFragmentation() const
+{
+	const uint32_t freeSize = GetFreeSize();
+	return ( freeSize == 0 ) ? 0.0f : 1.0f - static_cast<float>( GetLargestFreeBlock() ) / static_cast<float>( freeSize );
+}
+
+void TlsfAllocator::Defragment( std::vector<tlsfMove_t>& moves )
+{
+	moves.clear();
+
+	if ( allocations.empty() ) {
+		Reset();
+		return;
+	}
+
+	// walk the range from its first block and slide every allocation down
+	std::vector<tlsfMove_t> packed;
+	packed.reserve( allocations.size() );
+
+	uint32_t block = allocations.begin()->second;
+	while ( block != INVALID_BLOCK && blocks[block].prevPhysical != INVALID_BLOCK ) {
+		block = blocks[block].prevPhysical;
+	}
+
+	uint32_t packedOffset = 0;
+
+	for ( ; block != INVALID_BLOCK; block = blocks[block].nextPhysical ) {
+		if ( blocks[block].isFree ) {
+			continue;
+		}
+
+		packed.push_back( { blocks[block].offset, packedOffset, blocks[block].size } );
+
+		if ( blocks[block].offset != packedOffset ) {
+			moves.push_back( packed.back() );
+		}
+
+		packedOffset += blocks[block].size;
+	}
+
+	// rebuild the blocks: one per allocation, then the free tail
+	ClearBlocks();
+
+	uint32_t prevBlock = INVALID_BLOCK;
+
+	for ( const tlsfMove_t& allocation : packed ) {
+		const uint32_t packedBlock = CreateBlock( allocation.to, allocation.size );
+
+		blocks[packedBlock].prevPhysical	= prevBlock;
+		blocks[packedBlock].isFree			= false;
+
+		if ( prevBlock != INVALID_BLOCK ) {
+			blocks[prevBlock].nextPhysical = packedBlock;
+		}
+
+		allocations[allocation.to] = packedBlock;
+		prevBlock = packedBlock;
+	}
+
+	usedSize = packedOffset;
+
+	if ( packedOffset < capacity ) {
+		const uint32_t freeBlock = CreateBlock( packedOffset, capacity - packedOffset );
+
+		blocks[freeBlock].prevPhysical	= prevBlock;
+		blocks[prevBlock].nextPhysical	= freeBlock;
+
+		InsertFreeBlock( freeBlock );
+	}
+}
+
+const bool TlsfAllocator::Validate() const
+{
+	// find the first block of the range from any live one
+	uint32_t block = INVALID_BLOCK;
+
+	for ( uint32_t i = 0; i < blocks.size() && block == INVALID_BLOCK; ++i ) {
+		if ( std::find( unusedBlocks.begin(), unusedBlocks.end(), i ) == unusedBlocks.end() ) {
+			block = i;
+		}
+	}
+
+	while ( block != INVALID_BLOCK && blocks[block].prevPhysical != INVALID_BLOCK ) {
+		block = blocks[block].prevPhysical;
+	}
+
+	uint32_t offset = 0, freeCount = 0, allocatedCount = 0, allocatedSize = 0;
+	bool isPrevFree = false;
+
+	for ( ; block != INVALID_BLOCK; block = blocks[block].nextPhysical ) {
+		const block_t& current = blocks[block];
+
+		if ( current.offset != offset || current.size == 0 || ( current.isFree && isPrevFree ) ) {
+			return false;
+		}
+
+		if ( current.nextPhysical != INVALID_BLOCK && blocks[current.nextPhysical].prevPhysical != block ) {
+			return false;
+		}
+
+		if ( current.isFree ) {
+			++freeCount;
+		} else {
+			const auto allocation = allocations.find( current.offset );
+
+			if ( allocation == allocations.end() || allocation->second != block ) {
+				return false;
+			}
+
+			++allocatedCount;
+			allocatedSize += current.size;
+		}
+
+		isPrevFree	= current.isFree;
+		offset		+= current.size;
+	}
+
+	if ( offset != capacity || allocatedSize != usedSize || allocatedCount != allocations.size() ) {
+		return false;
+	}
+
+	// every binned block is free, in the bin of its size, and the bitmaps flag exactly the non empty bins
+	uint32_t binnedCount = 0;
+
+	for ( uint32_t firstLevel = 0; firstLevel < FIRST_LEVEL_COUNT; ++firstLevel ) {
+		for ( uint32_t secondLevel = 0; secondLevel < SECOND_LEVEL_COUNT; ++secondLevel ) {
+			const bool isFlagged = ( secondLevelBitmaps[firstLevel] & ( 1u << secondLevel ) ) != 0;
+
+			if ( isFlagged != ( bins[firstLevel][secondLevel] != INVALID_BLOCK ) ) {
+				return false;
+			}
+
+			for ( uint32_t binned = bins[firstLevel][secondLevel]; binned != INVALID_BLOCK; binned = blocks[binned].nextFree ) {
+				uint32_t blockFirstLevel = 0, blockSecondLevel = 0;
+				GetBin( blocks[binned].size, blockFirstLevel, blockSecondLevel );
+
+				if ( !blocks[binned].isFree || blockFirstLevel != firstLevel || blockSecondLevel != secondLevel ) {
+					return false;
+				}
+
+				++binnedCount;
+			}
+		}
+
+		if ( ( ( firstLevelBitmap & ( 1u << firstLevel ) ) != 0 ) != ( secondLevelBitmaps[firstLevel] != 0 ) ) {
+			return false;
+		}
+	}
+
+	return binnedCount == freeCount;
+}
+
+void TlsfAllocator::GetBin( const uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel )
+{
+	if ( size < SECOND_LEVEL_COUNT ) {
+		firstLevel	= 0;
+		secondLevel	= size;
+		return;
+	}
+
+	const uint32_t lastSet = FindLastSet( size );
+
+	firstLevel	= lastSet - SECOND_LEVEL_LOG2 + 1;
+	secondLevel	= ( size >> ( lastSet - SECOND_LEVEL_LOG2 ) ) - SECOND_LEVEL_COUNT;
+}
+
+uint32_t TlsfAllocator::CreateBlock( const uint32_t offset, const uint32_t size )
+{
+	const block_t block = { offset, size, INVALID_BLOCK, INVALID_BLOCK, INVALID_BLOCK, INVALID_BLOCK, true };
+
+	if ( !unusedBlocks.empty() ) {
+		const uint32_t index = unusedBlocks.back();
+		unusedBlocks.pop_back();
+
+		blocks[index] = block;
+		return index;
+	}
+
+	blocks.push_back( block );
+	return static_cast<uint32_t>( blocks.size() - 1 );
+}
+
+void TlsfAllocator::InsertFreeBlock( const uint32_t block )
+{
+	uint32_t firstLevel = 0, secondLevel = 0;
+	GetBin( blocks[block].size, firstLevel, secondLevel );
+
+	const uint32_t head = bins[firstLevel][secondLevel];
+
+	blocks[block].isFree	= true;
+	blocks[block].prevFree	= INVALID_BLOCK;
+	blocks[block].nextFree	= head;
+
+	if ( head != INVALID_BLOCK ) {
+		blocks[head].prevFree = block;
+	}
+
+	bins[firstLevel][secondLevel] = block;
+
+	firstLevelBitmap				|= 1u << firstLevel;
+	secondLevelBitmaps[firstLevel]	|= 1u << secondLevel;
+}
+
+void TlsfAllocator::RemoveFreeBlock( const uint32_t block )
+{
+	uint32_t firstLevel = 0, secondLevel = 0;
+	GetBin( blocks[block].size, firstLevel, secondLevel );
+
+	const uint32_t prev = blocks[block].prevFree, next = blocks[block].nextFree;
+
+	if ( prev != INVALID_BLOCK ) {
+		blocks[prev].nextFree = next;
+	} else {
+		bins[firstLevel][secondLevel] = next;
+	}
+
+	if ( next != INVALID_BLOCK ) {
+		blocks[next].prevFree = prev;
+	}
+
+	if ( bins[firstLevel][secondLevel] == INVALID_BLOCK ) {
+		secondLevelBitmaps[firstLevel] &= ~( 1u << secondLevel );
+
+		if ( secondLevelBitmaps[firstLevel] == 0 ) {
+			firstLevelBitmap &= ~( 1u << firstLevel );
+		}
+	}
+
+	blocks[block].isFree = false;
+}
+
+uint32_t TlsfAllocator::FindFreeBlock( const uint32_t size ) const
+{
+	uint32_t firstLevel = 0, secondLevel = 0;
+
+	// round the size up to the next bin: any block of that bin (or above) fits without walking the bin
+	const uint64_t roundedSize = ( size < SECOND_LEVEL_COUNT ) ? size : size + ( 1ull << ( FindLastSet( size ) - SECOND_LEVEL_LOG2 ) ) - 1;
+
+	if ( roundedSize <= 0xffffffffull ) {
+		GetBin( static_cast<uint32_t>( roundedSize ), firstLevel, secondLevel );
+
+		uint32_t secondLevelMap = secondLevelBitmaps[firstLevel] & ( ~0u << secondLevel );
+
+		if ( secondLevelMap == 0 ) {
+			const uint32_t firstLevelMap = ( firstLevel + 1 < 32 ) ? firstLevelBitmap & ( ~0u << ( firstLevel + 1 ) ) : 0;
+
+			if ( firstLevelMap != 0 ) {
+				firstLevel		= FindFirstSet( firstLevelMap );
+				secondLevelMap	= secondLevelBitmaps[firstLevel];
+			}
+		}
+
+		if ( secondLevelMap != 0 ) {
+			return bins[firstLevel][FindFirstSet( secondLevelMap )];
+		}
+	}
+
+	// nothing in the bins above; the bin of the size itself might still hold a block large enough
+	GetBin( size, firstLevel, secondLevel );
+
+	for ( uint32_t block = bins[firstLevel][secondLevel]; block != INVALID_BLOCK; block = blocks[block].nextFree ) {
+		if ( blocks[block].size >= size ) {
+			return block;
+		}
+	}
+
+	return INVALID_BLOCK;
+}
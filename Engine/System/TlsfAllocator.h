@@ -0,0 +1,88 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+struct tlsfMove_t
+{
+	uint32_t	from;
+	uint32_t	to;
+	uint32_t	size;
+};
+
+// two level segregated fit offset allocator over [0, capacity); allocations and frees are O(1)
+// free blocks are binned by size (power of two levels split in linear sub levels); a request is served by the first
+// bin whose smallest block is large enough, then the remainder goes back to its own bin
+// freed blocks are merged with their free neighbours, so fragmentation only comes from interleaved lifetimes (see Defragment)
+// sizes and offsets are in caller defined units (e.g. vertices); pure bookkeeping, the caller owns the memory
+class TlsfAllocator
+{
+public:
+	static constexpr uint32_t	INVALID_OFFSET = ~0u;
+
+public:
+	inline uint32_t		GetCapacity() const			{ return capacity; }
+	inline uint32_t		GetUsedSize() const			{ return usedSize; }
+	inline uint32_t		GetFreeSize() const			{ return capacity - usedSize; }
+	inline uint32_t		GetAllocationCount() const	{ return static_cast<uint32_t>( allocations.size() ); }
+
+public:
+						TlsfAllocator();
+						TlsfAllocator( TlsfAllocator& ) = delete;
+						~TlsfAllocator() = default;
+
+	void				Initialize( const uint32_t capacity );
+	void				Reset(); // everything is free again
+
+	uint32_t			Allocate( const uint32_t size ); // offset or INVALID_OFFSET if no free block is large enough
+	void				Free( const uint32_t offset );
+	uint32_t			GetSize( const uint32_t offset ) const; // 0 if nothing is allocated at offset
+
+	uint32_t			GetLargestFreeBlock() const;
+	float				GetFragmentation() const; // 0: the free space is contiguous, 1: scattered in tiny blocks
+
+	// packs every allocation at the beginning of the range, in offset order; the free space becomes a single block
+	// moves are sorted by offset and never move an allocation up, so applying them front to back never overwrites live content
+	void				Defragment( std::vector<tlsfMove_t>& moves );
+
+	const bool			Validate() const; // the blocks tile the range, no free neighbours, bins match the free blocks
+
+private:
+	static constexpr uint32_t	SECOND_LEVEL_LOG2	= 4;
+	static constexpr uint32_t	SECOND_LEVEL_COUNT	= 1u << SECOND_LEVEL_LOG2;
+	static constexpr uint32_t	FIRST_LEVEL_COUNT	= 32 - SECOND_LEVEL_LOG2 + 1; // level 0 holds the sizes below SECOND_LEVEL_COUNT
+	static constexpr uint32_t	INVALID_BLOCK		= ~0u;
+
+	struct block_t
+	{
+		uint32_t	offset;
+		uint32_t	size;
+		uint32_t	prevPhysical;	// neighbours in the range
+		uint32_t	nextPhysical;
+		uint32_t	prevFree;		// neighbours in the bin; unused while allocated
+		uint32_t	nextFree;
+		bool		isFree;
+	};
+
+private:
+	uint32_t							capacity;
+	uint32_t							usedSize;
+
+	uint32_t							firstLevelBitmap;
+	uint32_t							secondLevelBitmaps[FIRST_LEVEL_COUNT];
+	uint32_t							bins[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];	// first free block
+
+	std::vector<block_t>				blocks;
+	std::vector<uint32_t>				unusedBlocks;
+	std::unordered_map<uint32_t, uint32_t>	allocations;	// block by offset
+
+private:
+	static void			GetBin( const uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel );
+
+	void				ClearBlocks();
+
+	uint32_t			CreateBlock( const uint32_t offset, const uint32_t size );
+	void				InsertFreeBlock( const uint32_t block );
+	void				RemoveFreeBlock( const uint32_t block );
+	uint32_t			FindFreeBlock( const uint32_t size ) const;
+};
@@ -3,7 +3,12 @@
 #include <Engine/System/Window.h>
 #include <Engine/System/InputManager.h>
 #include <Engine/Graphics/RenderManager.h>
-#include <Engine/System/Timer.h>
+#include <Engine/System/FixedStep.h>
+#include <Engine/System/JobSystem.h>
+#include <Engine/Game/World.h>
+#include <Engine/Game/AreaStreamer.h>
+#include <Engine/Game/StateManager.h>
+#include <Engine/Game/Actor.h>
 
 extern LRESULT ImGui_ImplDX11_WndProcHandler( HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam );
 
@@ -20,6 +25,13 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 
 	InputManager inputMan = {};
 	RenderManager renderMan = {};
+	World world = {};
+	AreaStreamer areaStreamer = {};
+	StateManager stateMan = {};
+	SystemScheduler actorSystems = {};
+	ActorTransformHistorySystem actorTransformHistorySystem;
+	ActorTransformSystem actorTransformSystem;
+	FreeCamera freeCam = {};
 	window_t window =
 	{
 		nullptr,					// HINSTANCE		instance
@@ -38,44 +50,80 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 		return 2;
 	}
 
+	// before the renderer: shaders are loaded on the workers
+	Job_Initialize();
+
 	if ( renderMan.Initialize( &window ) != 0 ) {
 		return 3;
 	}
 
-#ifdef _DEBUG
-	// TEMPORARY; TO REMOVE LATER
-	inputMan.RegisterCallback( KEY_COMBINAISON( VK_Z, VK_NONE, VK_NONE, VK_NONE ),
-		std::bind( &Camera::MoveForward, &renderMan.freeCam, std::placeholders::_1 ) );
+	// time to first frame is mostly the renderer startup; per step timings go to the debugger output
+	std::string startupReport = "renderer startup\n";
+	renderMan.GetStartupTasks().WriteReport( startupReport );
+	OutputDebugStringA( startupReport.c_str() );
+
+	const float aspectRatio = static_cast<float>( window.width ) / static_cast<float>( window.height );
+
+	if ( !freeCam.Create( renderMan.GetContext(), aspectRatio, DirectX::XMConvertToRadians( 75.0f ), 0.01f, 1000.0f ) ) {
+		return 4;
+	}
+
+	freeCam.SetActive( renderMan.GetContext() );
+
+	// areas are 64x64 units; keep the 3x3 areas around the camera resident
+	const streamingSettings_t streamingSettings =
+	{
+		64.0f,						// float			areaSize
+		96.0f,						// float			loadRadius
+		128.0f,						// float			unloadRadius
+		256ull << 20,				// uint64_t			memoryBudget
+	};
 
-	inputMan.RegisterCallback( KEY_COMBINAISON( VK_S, VK_NONE, VK_NONE, VK_NONE ),
-		std::bind( &Camera::MoveBackward, &renderMan.freeCam, std::placeholders::_1 ) );
+	world.CreateGrid( 64, 64 );
 
-	inputMan.RegisterCallback( KEY_COMBINAISON( VK_Q, VK_NONE, VK_NONE, VK_NONE ),
-		std::bind( &Camera::MoveLeft, &renderMan.freeCam, std::placeholders::_1 ) );
+	// area meshes are created (and released) through the renderer
+	if ( areaStreamer.Initialize( &world, streamingSettings, "base_data/areas", renderMan.GetContext(), renderMan.GetMaterialManager() ) != 0 ) {
+		return 5;
+	}
+
+	// states are preloaded in the background; textures go through the render manager cache
+	if ( stateMan.Initialize( &world, &areaStreamer, renderMan.GetContext(), renderMan.GetTextureManager() ) != 0 ) {
+		return 6;
+	}
+
+	// first system of the tick: saves the state gameplay systems are about to update
+	actorSystems.AddSystem( &actorTransformHistorySystem );
+
+	// from now on, the render thread is the only one allowed to use the immediate context
+	renderMan.StartRenderThread();
 
-	inputMan.RegisterCallback( KEY_COMBINAISON( VK_D, VK_NONE, VK_NONE, VK_NONE ),
-		std::bind( &Camera::MoveRight, &renderMan.freeCam, std::placeholders::_1 ) );
+#ifdef _DEBUG
+	// TEMPORARY; TO REMOVE LATER
+	inputMan.RegisterCallback( VK_Z, false, KEY_MOD_NONE, std::bind( &Camera::MoveForward, &freeCam, std::placeholders::_1 ) );
+	inputMan.RegisterCallback( VK_S, false, KEY_MOD_NONE, std::bind( &Camera::MoveBackward, &freeCam, std::placeholders::_1 ) );
+	inputMan.RegisterCallback( VK_Q, false, KEY_MOD_NONE, std::bind( &Camera::MoveLeft, &freeCam, std::placeholders::_1 ) );
+	inputMan.RegisterCallback( VK_D, false, KEY_MOD_NONE, std::bind( &Camera::MoveRight, &freeCam, std::placeholders::_1 ) );
 
-	inputMan.RegisterCallback( KEY_COMBINAISON( VK_ESCAPE, VK_NONE, VK_NONE, VK_NONE ),
-		std::bind( [&]( const float dt ) { PostThreadMessage( GetCurrentThreadId(), WM_QUIT, 0, 0 ); }, std::placeholders::_1 ) );
+	inputMan.RegisterCallback( VK_ESCAPE, true, KEY_MOD_NONE, std::bind( [&]( const float dt ) { PostThreadMessage( GetCurrentThreadId(), WM_QUIT, 0, 0 ); }, std::placeholders::_1 ) );
 #endif
 
 	::SetCursor( defaultCursor ); // restore default cursor
 
 	MSG msg = {};
 
-	timer_t gameLogicTimer = {};
-	Timer_Start( &gameLogicTimer );
+	constexpr double SIMULATION_TICK = 10.0; // 10ms / 100Hz simulation
 
-	constexpr double ref_dt = 10.0;	// 10ms / 100FPS cap (for now)
-	double dt = 0.00;
-	double accumulator = 0.00;
+	fixedStep_t simulationStep = {};
+	FixedStep_Start( &simulationStep, SIMULATION_TICK );
 
 	while ( 1 ) {
 		while ( PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
 			ImGui_ImplDX11_WndProcHandler( msg.hwnd, msg.message, msg.wParam, msg.lParam );
 
 			if ( msg.message == WM_QUIT ) {
+				stateMan.Shutdown();
+				areaStreamer.Shutdown();
+				Job_Shutdown();
 				inputMan.Shutdown();
 				renderMan.Shutdown();
 				Sys_DestroyWindow( &window );
@@ -90,27 +138,33 @@ int WINAPI CALLBACK WinMain( _In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevI
 		}
 
 		if ( window.flags & WIN_FLAG_HAS_FOCUS ) {
-			dt = Timer_GetDelta( &gameLogicTimer ); // get delta in ms
+			const double frameTime = FixedStep_BeginFrame( &simulationStep );
+
+			inputMan.Poll( static_cast<float>( frameTime ) );
+			freeCam.Update( inputMan.mouseInfos.positionX, inputMan.mouseInfos.positionY, static_cast<float>( frameTime ) );
+			inputMan.Acknowledge( &window );
 
-			if ( dt > 250.0 ) {
-				dt = 250.0;
+			areaStreamer.Update( freeCam.GetPosition() );
+			stateMan.Frame();
+
+			while ( FixedStep_Tick( &simulationStep ) ) {
+				stateMan.Update( static_cast<float>( simulationStep.tickDuration ) );
+				actorSystems.Update( world.GetEntityManager(), static_cast<float>( simulationStep.tickDuration ) );
 			}
 
-			accumulator += dt;
+			// render between the last two simulation states
+			actorTransformSystem.SetInterpolationFactor( static_cast<float>( FixedStep_GetAlpha( &simulationStep ) ) );
+			actorTransformSystem.Update( world.GetEntityManager(), static_cast<float>( frameTime ) );
 
-			inputMan.Poll( static_cast<float>( dt ) );
-			renderMan.freeCam.Update( inputMan.mouseInfos.positionX, inputMan.mouseInfos.positionY, static_cast<float>( dt ) );
-			inputMan.ResetRelativeMouse( &window );
+			world.UpdateTransforms();
 
-			while ( accumulator >= ref_dt ) {
-				/* active state -> Update(); */
-				accumulator -= dt;
-			}
+			// hand the frame over to the render thread; blocks if it is too far behind
+			renderSnapshot_t* snapshot = renderMan.AcquireSnapshot();
 
-			const double alpha = accumulator / dt;
+			const std::vector<worldArea_t*>& residentAreas = world.GetResidentAreas();
+			Render_BuildSnapshot( snapshot, &freeCam, residentAreas.data(), residentAreas.size(), static_cast<float>( frameTime * 0.001 ) );
 
-	//		renderMan.Frame( static_cast< float >( alpha + ( 1.0 - alpha ) ) );
-			renderMan.Swap();
+			renderMan.SubmitSnapshot( snapshot );
 		}
 	}
 
@@ -0,0 +1,332 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/Game/World.h>
+#include <Engine/Game/AreaStreamer.h>
+#include <Engine/Graphics/Mesh.h>
+#include <Engine/Graphics/RenderSnapshot.h>
+#include <Engine/Io/AreaFileReaderWriter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr float AREA_SIZE = 64.0f;
+
+	const bool IsMatrixEqual( const DirectX::XMMATRIX& a, const DirectX::XMMATRIX& b )
+	{
+		// local matrices are saved (world * inverse parent world) and multiplied back on load
+		const DirectX::XMVECTOR epsilon = DirectX::XMVectorReplicate( 1e-3f );
+
+		for ( int row = 0; row < 4; ++row ) {
+			if ( !DirectX::XMVector4NearEqual( a.r[row], b.r[row], epsilon ) ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void SetName( areaNode_t* node, const char* kind, const uint32_t areaIndex )
+	{
+		snprintf( node->name, sizeof( node->name ), "%s (area %u)", kind, areaIndex );
+	}
+
+	mesh_t* AllocateMesh( World* world, const std::string& fileName, const DirectX::XMMATRIX& matrix )
+	{
+		mesh_t* mesh = static_cast<mesh_t*>( world->AllocateContent( NODE_FLAG_CONTENT_MESH ) );
+		mesh->fileName						= fileName;
+		mesh->transformation->modelMatrix	= matrix; // relative to the parent (see World::InsertNode)
+		mesh->transformation->boundingSphere = DirectX::BoundingSphere( DirectX::XMFLOAT3( 0.0f, 0.5f, 0.0f ), 1.5f );
+
+		return mesh;
+	}
+
+	// a piece of everything an area can hold: lights of every kind, nested meshes (with and without a file), an actor
+	// with a mesh child (actors are not saved: the actor node comes back empty, with its child) and the sun (first area)
+	void PopulateArea( World* world, const uint32_t areaIndex )
+	{
+		const float originX = static_cast<float>( areaIndex ) * AREA_SIZE;
+		const std::string meshFolder = "base_data/meshes/area_" + std::to_string( areaIndex ) + "/";
+
+		if ( areaIndex == 0 ) {
+			sunLight_t* sun = static_cast<sunLight_t*>( world->AllocateContent( NODE_FLAG_CONTENT_SUN_LIGHT ) );
+			sun->worldPositionRadius			= DirectX::XMFLOAT4( 0.0f, 100.0f, 0.0f, 1.0f );
+			sun->colorAndIntensityLux			= DirectX::XMFLOAT4( 1.0f, 0.9f, 0.8f, 100000.0f );
+			sun->sphericalThetaGammaAndPADDING	= DirectX::XMFLOAT4( 0.6f, 1.2f, 0.0f, 0.0f );
+
+			SetName( world->InsertNode( sun, NODE_FLAG_CONTENT_SUN_LIGHT ), "sun", areaIndex );
+		}
+
+		sphereAreaLight_t* sphereLight = static_cast<sphereAreaLight_t*>( world->AllocateContent( NODE_FLAG_CONTENT_SPHERE_LIGHT ) );
+		sphereLight->worldPositionRadius	= DirectX::XMFLOAT4( originX + 4.0f, 4.0f, 4.0f, 0.5f );
+		sphereLight->color					= DirectX::XMFLOAT4( 1.0f, 0.5f, 0.25f, 800.0f );
+
+		diskAreaLight_t* diskLight = static_cast<diskAreaLight_t*>( world->AllocateContent( NODE_FLAG_CONTENT_DISK_LIGHT ) );
+		diskLight->worldPositionRadius	= DirectX::XMFLOAT4( originX + 16.0f, 6.0f, 8.0f, 1.0f );
+		diskLight->color				= DirectX::XMFLOAT4( 0.25f, 0.5f, 1.0f, 1200.0f );
+		diskLight->planeNormal			= DirectX::XMFLOAT4( 0.0f, -1.0f, 0.0f, 0.0f );
+
+		rectangleAreaLight_t* rectangleLight = static_cast<rectangleAreaLight_t*>( world->AllocateContent( NODE_FLAG_CONTENT_RECTANGLE_LIGHT ) );
+		rectangleLight->worldPositionRadius	= DirectX::XMFLOAT4( originX + 32.0f, 3.0f, 32.0f, 2.0f );
+		rectangleLight->color				= DirectX::XMFLOAT4( 1.0f, 1.0f, 1.0f, 600.0f );
+		rectangleLight->planeNormal			= DirectX::XMFLOAT4( 0.0f, 0.0f, 1.0f, 0.0f );
+		rectangleLight->up					= DirectX::XMFLOAT4( 0.0f, 1.0f, 0.0f, 0.0f );
+		rectangleLight->left				= DirectX::XMFLOAT4( -1.0f, 0.0f, 0.0f, 0.0f );
+		rectangleLight->widthHeight			= DirectX::XMFLOAT4( 2.0f, 1.0f, 0.0f, 0.0f );
+
+		SetName( world->InsertNode( sphereLight, NODE_FLAG_CONTENT_SPHERE_LIGHT ), "sphere light", areaIndex );
+		SetName( world->InsertNode( diskLight, NODE_FLAG_CONTENT_DISK_LIGHT ), "disk light", areaIndex );
+		SetName( world->InsertNode( rectangleLight, NODE_FLAG_CONTENT_RECTANGLE_LIGHT ), "rectangle light", areaIndex );
+
+		const DirectX::XMMATRIX rockMatrix = DirectX::XMMatrixScaling( 2.0f, 2.0f, 2.0f ) * DirectX::XMMatrixRotationY( 0.7f ) * DirectX::XMMatrixTranslation( originX + 20.0f, 0.0f, 40.0f );
+		areaNode_t* rockNode = world->InsertNode( AllocateMesh( world, meshFolder + "rock.sge", rockMatrix ), NODE_FLAG_CONTENT_MESH );
+		SetName( rockNode, "rock", areaIndex );
+
+		// generated geometry (e.g. a static batch) has no file to come back from
+		areaNode_t* batchNode = world->InsertNode( AllocateMesh( world, "", DirectX::XMMatrixTranslation( originX + 48.0f, 0.0f, 16.0f ) ), NODE_FLAG_CONTENT_MESH );
+		SetName( batchNode, "static batch", areaIndex );
+
+		actor_t* actor = static_cast<actor_t*>( world->AllocateContent( NODE_FLAG_CONTENT_ACTOR ) );
+		areaNode_t* actorNode = world->InsertNode( actor, NODE_FLAG_CONTENT_ACTOR );
+		world->SetNodeWorldMatrix( actorNode, DirectX::XMMatrixRotationY( 1.5f ) * DirectX::XMMatrixTranslation( originX + 8.0f, 0.0f, 56.0f ) );
+		SetName( actorNode, "actor", areaIndex );
+
+		// children are placed relative to their parent world matrix (as of the last update)
+		world->UpdateTransforms();
+
+		areaNode_t* mossNode = world->InsertNode( AllocateMesh( world, meshFolder + "moss.sge", DirectX::XMMatrixTranslation( 0.0f, 1.0f, 0.0f ) ), NODE_FLAG_CONTENT_MESH, rockNode );
+		SetName( mossNode, "moss", areaIndex );
+
+		areaNode_t* weaponNode = world->InsertNode( AllocateMesh( world, meshFolder + "weapon.sge", DirectX::XMMatrixRotationZ( 0.3f ) * DirectX::XMMatrixTranslation( 0.5f, 1.0f, 0.0f ) ), NODE_FLAG_CONTENT_MESH, actorNode );
+		SetName( weaponNode, "weapon", areaIndex );
+
+		world->UpdateTransforms();
+
+		sphereAreaLight_t* glowLight = static_cast<sphereAreaLight_t*>( world->AllocateContent( NODE_FLAG_CONTENT_SPHERE_LIGHT ) );
+		glowLight->worldPositionRadius	= DirectX::XMFLOAT4( originX + 20.0f, 3.0f, 40.0f, 0.1f );
+		glowLight->color				= DirectX::XMFLOAT4( 0.2f, 1.0f, 0.2f, 50.0f );
+
+		areaNode_t* glowNode = world->InsertNode( glowLight, NODE_FLAG_CONTENT_SPHERE_LIGHT, mossNode );
+		world->SetNodeWorldMatrix( glowNode, DirectX::XMMatrixTranslation( 0.0f, 0.5f, 0.0f ) );
+		SetName( glowNode, "glow", areaIndex );
+
+		world->UpdateTransforms();
+	}
+
+	// the streamed node must match the saved one, but for actors (saved as empty nodes)
+	uint32_t CompareNodes( const worldArea_t* savedArea, const areaNode_t* saved, const worldArea_t* streamedArea, const areaNode_t* streamed )
+	{
+		uint32_t failureCount = 0;
+
+		const bool isActor = ( saved->flags & NODE_FLAG_CONTENT_ACTOR ) != 0;
+		const uint64_t expectedFlags = isActor ? ( ( saved->flags & ~static_cast<uint64_t>( NODE_FLAG_CONTENT_ACTOR ) ) | NODE_FLAG_EMPTY_NODE ) : saved->flags;
+
+		if ( streamed->hash != saved->hash || streamed->flags != expectedFlags || strcmp( streamed->name, saved->name ) != 0
+			|| streamed->children.size() != saved->children.size() ) {
+			printf( "\t'%s': node mismatch\n", saved->name );
+			return 1;
+		}
+
+		if ( !IsMatrixEqual( streamedArea->transforms.GetWorldMatrix( streamed->transform ), savedArea->transforms.GetWorldMatrix( saved->transform ) ) ) {
+			printf( "\t'%s': world matrix mismatch\n", saved->name );
+			++failureCount;
+		}
+
+		if ( isActor ) {
+			failureCount += ( streamed->content != nullptr ) ? 1 : 0;
+		} else if ( saved->flags & NODE_FLAG_CONTENT_MESH ) {
+			const mesh_t* savedMesh		= static_cast<const mesh_t*>( saved->content );
+			const mesh_t* streamedMesh	= static_cast<const mesh_t*>( streamed->content );
+
+			if ( streamedMesh->fileName != savedMesh->fileName || streamedMesh->transformation->boundingSphere.Radius != savedMesh->transformation->boundingSphere.Radius ) {
+				printf( "\t'%s': mesh mismatch\n", saved->name );
+				++failureCount;
+			}
+
+			// no render context: the geometry is never created
+			if ( Render_GetMeshGeometry( streamedMesh ) != nullptr || !streamedMesh->subMeshes.empty() ) {
+				printf( "\t'%s': unexpected mesh geometry\n", saved->name );
+				++failureCount;
+			}
+		}
+
+		for ( std::size_t i = 0; i < saved->children.size(); ++i ) {
+			failureCount += CompareNodes( savedArea, saved->children[i], streamedArea, streamed->children[i] );
+		}
+
+		return failureCount;
+	}
+
+	uint32_t CompareSnapshots( const renderSnapshot_t& saved, const renderSnapshot_t& streamed )
+	{
+		uint32_t failureCount = 0;
+
+		if ( streamed.draws.size() != saved.draws.size() || streamed.sphereLights.size() != saved.sphereLights.size()
+			|| streamed.diskLights.size() != saved.diskLights.size() || streamed.rectangleLights.size() != saved.rectangleLights.size()
+			|| streamed.hasSun != saved.hasSun ) {
+			printf( "\tsnapshot mismatch: %zu/%zu draws, %zu/%zu sphere lights, %zu/%zu disk lights, %zu/%zu rectangle lights\n",
+				streamed.draws.size(), saved.draws.size(), streamed.sphereLights.size(), saved.sphereLights.size(),
+				streamed.diskLights.size(), saved.diskLights.size(), streamed.rectangleLights.size(), saved.rectangleLights.size() );
+			return 1;
+		}
+
+		for ( std::size_t i = 0; i < saved.draws.size(); ++i ) {
+			if ( streamed.draws[i].mesh->fileName != saved.draws[i].mesh->fileName || !IsMatrixEqual( streamed.draws[i].modelMatrix, saved.draws[i].modelMatrix ) ) {
+				++failureCount;
+			}
+		}
+
+		// light parameters are saved as is
+		const bool areLightsEqual = memcmp( streamed.sphereLights.data(), saved.sphereLights.data(), saved.sphereLights.size() * sizeof( sphereAreaLight_t ) ) == 0
+			&& memcmp( streamed.diskLights.data(), saved.diskLights.data(), saved.diskLights.size() * sizeof( diskAreaLight_t ) ) == 0
+			&& memcmp( streamed.rectangleLights.data(), saved.rectangleLights.data(), saved.rectangleLights.size() * sizeof( rectangleAreaLight_t ) ) == 0
+			&& ( !saved.hasSun || memcmp( &streamed.sun, &saved.sun, sizeof( renderSun_t ) ) == 0 );
+
+		return failureCount + ( areLightsEqual ? 0 : 1 );
+	}
+}
+
+// areaCount areas (a row of the world grid) are populated through the world interface (as the editor does), saved
+// to the working directory, and streamed back in (see AreaStreamer) around a camera covering the whole row; the
+// streamed node trees (hashes, names, flags, world matrices, mesh files and bounds) and the snapshot built from them
+// (draws, lights) must match the saved ones
+const bool Headless_CheckAreaStreaming( const uint32_t areaCount )
+{
+	const uint32_t rowLength = std::min( areaCount, 255u );
+
+	std::vector<std::unique_ptr<World>> savedWorlds;
+	std::vector<std::string> fileNames;
+
+	uint32_t failureCount = 0;
+	uint64_t fileSize = 0;
+
+	const benchClock_t::time_point writeStart = benchClock_t::now();
+
+	for ( uint32_t i = 0; i < rowLength; ++i ) {
+		savedWorlds.emplace_back( new World() );
+
+		World* savedWorld = savedWorlds.back().get();
+		savedWorld->CreateEmptyArea();
+		PopulateArea( savedWorld, i );
+
+		// see AreaStreamer::GetAreaFileName
+		fileNames.push_back( "./area_" + std::to_string( i ) + "_0.area" );
+
+		if ( Io_WriteAreaFile( fileNames.back().c_str(), savedWorld->GetActiveArea() ) != 0 ) {
+			printf( "area streaming: failed to write '%s'\n", fileNames.back().c_str() );
+			++failureCount;
+		}
+	}
+
+	const benchClock_t::time_point writeEnd = benchClock_t::now();
+
+	// the load radius covers the whole row
+	const streamingSettings_t streamingSettings =
+	{
+		AREA_SIZE,										// float			areaSize
+		AREA_SIZE * static_cast<float>( rowLength ),	// float			loadRadius
+		AREA_SIZE * static_cast<float>( rowLength + 1 ),// float			unloadRadius
+		256ull << 20,									// uint64_t			memoryBudget
+	};
+
+	const float cameraPosition[3] = { AREA_SIZE * static_cast<float>( rowLength ) * 0.5f, 16.0f, AREA_SIZE * 0.5f };
+
+	World streamedWorld = {};
+	streamedWorld.CreateGrid( static_cast<unsigned char>( rowLength ), 1 );
+
+	AreaStreamer streamer = {};
+	if ( failureCount == 0 && streamer.Initialize( &streamedWorld, streamingSettings, "." ) != 0 ) {
+		printf( "area streaming: failed to initialize the streamer\n" );
+		++failureCount;
+	}
+
+	const benchClock_t::time_point streamStart = benchClock_t::now();
+
+	// the streaming thread reads the files; areas are published by Update
+	while ( failureCount == 0 && streamedWorld.GetResidentAreas().size() < rowLength ) {
+		streamer.Update( cameraPosition );
+
+		bool isAnyUnavailable = false;
+		for ( uint32_t i = 0; i < rowLength; ++i ) {
+			isAnyUnavailable |= streamer.IsAreaUnavailable( static_cast<unsigned char>( i ), 0 );
+		}
+
+		if ( isAnyUnavailable || benchClock_t::now() - streamStart > std::chrono::seconds( 10 ) ) {
+			printf( "area streaming: %zu of %u areas streamed in\n", streamedWorld.GetResidentAreas().size(), rowLength );
+			++failureCount;
+			break;
+		}
+
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	const benchClock_t::time_point streamEnd = benchClock_t::now();
+
+	streamedWorld.UpdateTransforms();
+
+	// never created on the gpu; only used for its matrices
+	FreeCamera camera;
+	camera.SetPosition( cameraPosition[0], cameraPosition[1], cameraPosition[2] );
+	camera.LookAt( DirectX::XMFLOAT3( cameraPosition[0], 0.0f, AREA_SIZE ) );
+	camera.SetProjection( 16.0f / 9.0f, DirectX::XMConvertToRadians( 75.0f ), 0.01f, 1000.0f );
+
+	std::vector<const worldArea_t*> savedAreas, streamedAreas;
+	renderSnapshot_t savedSnapshot = {}, streamedSnapshot = {};
+
+	if ( failureCount == 0 ) {
+		for ( uint32_t i = 0; i < rowLength; ++i ) {
+			const worldArea_t* savedArea	= savedWorlds[i]->GetActiveArea();
+			const worldArea_t* streamedArea	= streamedWorld.GetArea( static_cast<unsigned char>( i ), 0 );
+
+			if ( streamedArea->nodes->children.size() != savedArea->nodes->children.size() ) {
+				printf( "\tarea %u: %zu root nodes instead of %zu\n", i, streamedArea->nodes->children.size(), savedArea->nodes->children.size() );
+				++failureCount;
+				continue;
+			}
+
+			for ( std::size_t j = 0; j < savedArea->nodes->children.size(); ++j ) {
+				failureCount += CompareNodes( savedArea, savedArea->nodes->children[j], streamedArea, streamedArea->nodes->children[j] );
+			}
+
+			savedAreas.push_back( savedArea );
+			streamedAreas.push_back( streamedArea );
+		}
+
+		// same area order on both sides (the resident list is in load order)
+		Render_BuildSnapshot( &savedSnapshot, &camera, savedAreas.data(), savedAreas.size(), 0.0f );
+		Render_BuildSnapshot( &streamedSnapshot, &camera, streamedAreas.data(), streamedAreas.size(), 0.0f );
+
+		failureCount += CompareSnapshots( savedSnapshot, streamedSnapshot );
+	}
+
+	printf( "area streaming (%u areas, %zu draws, %zu lights)\n", rowLength, streamedSnapshot.draws.size(),
+		streamedSnapshot.sphereLights.size() + streamedSnapshot.diskLights.size() + streamedSnapshot.rectangleLights.size() );
+
+	Render_ClearSnapshot( &savedSnapshot );
+	Render_ClearSnapshot( &streamedSnapshot );
+	streamer.Shutdown();
+
+	for ( const std::string& fileName : fileNames ) {
+		{
+			std::ifstream fileStream( fileName, std::ios::binary | std::ios::ate );
+			fileSize += fileStream.is_open() ? static_cast<uint64_t>( fileStream.tellg() ) : 0;
+		}
+
+		remove( fileName.c_str() );
+	}
+
+	printf( "\twrite %.3f ms | stream %.3f ms | %llu bytes\n", std::chrono::duration<double, std::milli>( writeEnd - writeStart ).count(),
+		std::chrono::duration<double, std::milli>( streamEnd - streamStart ).count(), static_cast<unsigned long long>( fileSize ) );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+
+// headless checks and benchmarks (one per engine component, see EntryPoint.cpp for their options)
+// each check reports what it measured and returns false if what it checks is invalid
+using benchClock_t = std::chrono::high_resolution_clock;
+
+void		Headless_BenchmarkRenderQueueSort( const uint32_t itemCount );
+
+const bool	Headless_CheckFrameGraphs( const uint32_t graphCount );
+const bool	Headless_CheckGeometryAllocator( const uint32_t areaCount );
+const bool	Headless_CheckStartupGraph( const uint32_t runCount );
+const bool	Headless_CheckDynamicResolution( const uint32_t phaseLength );
+const bool	Headless_CheckJobSystem( const uint32_t roundCount );
+const bool	Headless_CheckEntityThroughput( const uint32_t entityCount );
+const bool	Headless_CheckRingAllocator( const uint32_t frameCount );
+const bool	Headless_CheckReleaseOrder( const uint32_t frameCount );
+const bool	Headless_CheckAreaStreaming( const uint32_t areaCount );
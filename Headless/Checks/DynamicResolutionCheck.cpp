@@ -0,0 +1,154 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/Graphics/DynamicResolution.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// gpu cost of the synthetic frames: a fixed part plus a part proportional to the pixel count (scale squared)
+	struct dynresPhase_t
+	{
+		const char*		name;
+		float			sceneCost;		// ms at full scale
+		bool			isReachable;	// the budget can be met within the scale bounds
+	};
+
+	const dynresPhase_t DYNRES_PHASES[] =
+	{
+		{ "light",		6.0f,	true },
+		{ "heavy",		22.0f,	true },
+		{ "overload",	60.0f,	false },
+		{ "light",		6.0f,	true },
+	};
+}
+
+// frame times are measured on the scale applied a few frames earlier (gpu readback) with +-5% noise
+// once settled (second half of a phase): a reachable budget is met on average within 10% (or the scale is at its
+// max), an unreachable one leaves the scale at its min; the scale stays quantized within the bounds, and the same
+// trace must give the same scales
+const bool Headless_CheckDynamicResolution( const uint32_t phaseLength )
+{
+	constexpr float		FIXED_COST		= 2.0f;
+	constexpr uint32_t	READBACK_DELAY	= 2;
+
+	const dynamicResolutionSettings_t settings =
+	{
+		15.5f,						// float		targetFrameTime
+		0.5f,						// float		minScale
+		1.0f,						// float		maxScale
+		0.025f,						// float		scaleStep
+		0.25f,						// float		smoothing
+		0.1f,						// float		proportionalGain
+		0.05f,						// float		integralGain
+		0.0f,						// float		derivativeGain
+	};
+
+	struct phaseResult_t
+	{
+		double		frameTime;		// settled averages
+		double		scale;
+		uint32_t	settleFrame;	// first frame of the phase from which the scale stays within a step of its final value
+		uint32_t	scaleChanges;	// while settled
+	};
+
+	uint32_t failureCount = 0;
+	uint64_t traceHashes[2] = {};
+	phaseResult_t results[_countof( DYNRES_PHASES )] = {};
+
+	for ( int run = 0; run < 2; ++run ) {
+		DynamicResolution controller;
+		controller.Initialize( settings );
+
+		std::mt19937 generator( 0xD7E5 );
+		std::uniform_real_distribution<float> noiseDistribution( 0.95f, 1.05f );
+
+		std::deque<float> appliedScales( READBACK_DELAY, settings.maxScale );
+		uint64_t traceHash = 0xCBF29CE484222325ull;
+
+		for ( uint32_t phaseIndex = 0; phaseIndex < _countof( DYNRES_PHASES ); ++phaseIndex ) {
+			const dynresPhase_t& phase = DYNRES_PHASES[phaseIndex];
+			std::vector<float> phaseScales;
+
+			double frameTimeSum = 0.0, scaleSum = 0.0;
+
+			for ( uint32_t frame = 0; frame < phaseLength; ++frame ) {
+				const float measuredScale = appliedScales.front();
+				appliedScales.pop_front();
+
+				const float frameTime = ( FIXED_COST + phase.sceneCost * measuredScale * measuredScale ) * noiseDistribution( generator );
+				const float scale = controller.Update( frameTime );
+
+				appliedScales.push_back( scale );
+				phaseScales.push_back( scale );
+
+				const float quantizedScale = std::floor( scale / settings.scaleStep + 0.5f ) * settings.scaleStep;
+				if ( scale < settings.minScale || scale > settings.maxScale || std::fabs( scale - quantizedScale ) > 1e-4f ) {
+					++failureCount;
+				}
+
+				uint32_t scaleBits = 0;
+				memcpy( &scaleBits, &scale, sizeof( uint32_t ) );
+				traceHash = ( traceHash ^ scaleBits ) * 0x100000001B3ull;
+
+				if ( frame >= phaseLength / 2 ) {
+					frameTimeSum	+= frameTime;
+					scaleSum		+= scale;
+				}
+			}
+
+			const uint32_t settledCount = phaseLength - phaseLength / 2;
+			phaseResult_t& result = results[phaseIndex];
+			result.frameTime	= frameTimeSum / settledCount;
+			result.scale		= scaleSum / settledCount;
+			result.settleFrame	= phaseLength;
+			result.scaleChanges	= 0;
+
+			for ( uint32_t frame = phaseLength; frame-- > 0; ) {
+				if ( std::fabs( phaseScales[frame] - phaseScales.back() ) > settings.scaleStep * 1.5f ) {
+					break;
+				}
+
+				result.settleFrame = frame;
+			}
+
+			for ( uint32_t frame = phaseLength / 2 + 1; frame < phaseLength; ++frame ) {
+				result.scaleChanges += ( phaseScales[frame] != phaseScales[frame - 1] ) ? 1 : 0;
+			}
+
+			if ( run == 0 ) {
+				const bool isAtMax = result.scale >= settings.maxScale - settings.scaleStep;
+				const bool isAtMin = result.scale <= settings.minScale + settings.scaleStep;
+				const bool isOnBudget = std::fabs( result.frameTime - settings.targetFrameTime ) <= settings.targetFrameTime * 0.1;
+
+				if ( phase.isReachable ? !( isOnBudget || ( isAtMax && result.frameTime < settings.targetFrameTime ) ) : !isAtMin ) {
+					++failureCount;
+				}
+			}
+		}
+
+		traceHashes[run] = traceHash;
+	}
+
+	if ( traceHashes[0] != traceHashes[1] ) {
+		++failureCount;
+	}
+
+	printf( "dynamic resolution (%u frames per phase, %.1f ms budget)\n", phaseLength, settings.targetFrameTime );
+
+	for ( uint32_t phaseIndex = 0; phaseIndex < _countof( DYNRES_PHASES ); ++phaseIndex ) {
+		const phaseResult_t& result = results[phaseIndex];
+		printf( "\t%-10s settled after %4u frames | scale %.3f | %7.3f ms | %u scale changes\n", DYNRES_PHASES[phaseIndex].name, result.settleFrame, result.scale, result.frameTime, result.scaleChanges );
+	}
+
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
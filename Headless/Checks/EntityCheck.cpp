@@ -0,0 +1,174 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/System/JobSystem.h>
+#include <Engine/Game/EntityManager.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	struct ecsPosition_t
+	{
+		float		x, y, z;
+	};
+
+	struct ecsVelocity_t
+	{
+		float		x, y, z;
+	};
+
+	struct ecsTag_t
+	{
+		uint32_t	value;
+	};
+
+	// larger than a chunk: its archetype gets chunks sized for one entity
+	struct ecsLargeBlob_t
+	{
+		uint8_t		bytes[EntityManager::CHUNK_SIZE + 4096];
+	};
+}
+
+// creation, a parallel update over the chunks, component additions and removals (archetype moves), then
+// destruction; timed per entity. the updated positions must be exact (small integer velocities, dyadic step),
+// oversized entities must not overlap, and every entity must be gone at the end
+const bool Headless_CheckEntityThroughput( const uint32_t entityCount )
+{
+	constexpr uint32_t	UPDATE_COUNT	= 16;
+	constexpr float		TIME_STEP		= 0.5f;
+	constexpr uint32_t	LARGE_COUNT		= 4;
+
+	EntityManager entityManager;
+
+	const componentMask_t movingMask	= Ecs_ComponentMask<ecsPosition_t, ecsVelocity_t>();
+	const componentMask_t tagMask		= Ecs_ComponentMask<ecsTag_t>();
+	const componentMask_t largeMask		= Ecs_ComponentMask<ecsLargeBlob_t, ecsTag_t>();
+
+	uint32_t failureCount = 0;
+	double times[4] = {}; // create, update, move, destroy (ms)
+
+	std::vector<entity_t> entities( entityCount );
+
+	benchClock_t::time_point start = benchClock_t::now();
+
+	for ( uint32_t i = 0; i < entityCount; ++i ) {
+		entities[i] = entityManager.CreateEntity( ( i % 4 == 0 ) ? movingMask | tagMask : movingMask );
+
+		ecsVelocity_t* velocity = entityManager.GetComponent<ecsVelocity_t>( entities[i] );
+		*velocity = { static_cast<float>( i % 7 ), 1.0f, -static_cast<float>( i % 3 ) };
+	}
+
+	times[0] = std::chrono::duration<double, std::milli>( benchClock_t::now() - start ).count();
+
+	std::vector<entityChunk_t*> chunks;
+	entityManager.CollectChunks( movingMask, 0, chunks );
+
+	start = benchClock_t::now();
+
+	for ( uint32_t update = 0; update < UPDATE_COUNT; ++update ) {
+		Job_ParallelFor( 0, static_cast<uint32_t>( chunks.size() ), 16, [&chunks]( const uint32_t first, const uint32_t last ) {
+			for ( uint32_t chunkIndex = first; chunkIndex < last; ++chunkIndex ) {
+				const entityChunk_t* chunk		= chunks[chunkIndex];
+				ecsPosition_t* positions		= Ecs_GetChunkComponents<ecsPosition_t>( chunk );
+				const ecsVelocity_t* velocities	= Ecs_GetChunkComponents<ecsVelocity_t>( chunk );
+
+				for ( uint32_t i = 0; i < chunk->count; ++i ) {
+					positions[i].x += velocities[i].x * TIME_STEP;
+					positions[i].y += velocities[i].y * TIME_STEP;
+					positions[i].z += velocities[i].z * TIME_STEP;
+				}
+			}
+		} );
+	}
+
+	times[1] = std::chrono::duration<double, std::milli>( benchClock_t::now() - start ).count();
+
+	for ( uint32_t i = 0; i < entityCount; ++i ) {
+		const ecsPosition_t* position = entityManager.GetComponent<ecsPosition_t>( entities[i] );
+		const float steps = UPDATE_COUNT * TIME_STEP;
+
+		if ( position->x != static_cast<float>( i % 7 ) * steps || position->y != steps || position->z != -static_cast<float>( i % 3 ) * steps ) {
+			++failureCount;
+		}
+	}
+
+	// every entity changes archetype twice; components must follow
+	start = benchClock_t::now();
+
+	for ( uint32_t i = 0; i < entityCount; ++i ) {
+		if ( i % 4 == 0 ) {
+			entityManager.RemoveComponents( entities[i], tagMask );
+		} else {
+			entityManager.AddComponents( entities[i], tagMask );
+			entityManager.GetComponent<ecsTag_t>( entities[i] )->value = i;
+		}
+	}
+
+	for ( uint32_t i = 0; i < entityCount; ++i ) {
+		if ( i % 4 == 0 ) {
+			entityManager.AddComponents( entities[i], tagMask );
+		} else {
+			entityManager.RemoveComponents( entities[i], tagMask );
+		}
+	}
+
+	times[2] = std::chrono::duration<double, std::milli>( benchClock_t::now() - start ).count();
+
+	for ( uint32_t i = 0; i < entityCount; ++i ) {
+		const ecsVelocity_t* velocity = entityManager.GetComponent<ecsVelocity_t>( entities[i] );
+		const bool hasTag = entityManager.GetComponent<ecsTag_t>( entities[i] ) != nullptr;
+
+		if ( velocity->x != static_cast<float>( i % 7 ) || velocity->z != -static_cast<float>( i % 3 ) || hasTag != ( i % 4 == 0 ) ) {
+			++failureCount;
+		}
+	}
+
+	entity_t largeEntities[LARGE_COUNT];
+
+	for ( uint32_t i = 0; i < LARGE_COUNT; ++i ) {
+		largeEntities[i] = entityManager.CreateEntity( largeMask );
+		memset( entityManager.GetComponent<ecsLargeBlob_t>( largeEntities[i] )->bytes, static_cast<int>( i + 1 ), sizeof( ecsLargeBlob_t ) );
+		entityManager.GetComponent<ecsTag_t>( largeEntities[i] )->value = i;
+	}
+
+	for ( uint32_t i = 0; i < LARGE_COUNT; ++i ) {
+		const ecsLargeBlob_t* blob = entityManager.GetComponent<ecsLargeBlob_t>( largeEntities[i] );
+		const bool isIntact = blob->bytes[0] == i + 1 && blob->bytes[sizeof( ecsLargeBlob_t ) - 1] == i + 1;
+
+		if ( !isIntact || entityManager.GetComponent<ecsTag_t>( largeEntities[i] )->value != i || !entityManager.IsAlive( largeEntities[i] ) ) {
+			++failureCount;
+		}
+
+		entityManager.DestroyEntity( largeEntities[i] );
+	}
+
+	start = benchClock_t::now();
+
+	for ( const entity_t entity : entities ) {
+		entityManager.DestroyEntity( entity );
+	}
+
+	times[3] = std::chrono::duration<double, std::milli>( benchClock_t::now() - start ).count();
+
+	if ( entityManager.GetEntityCount() != 0 ) {
+		++failureCount;
+	}
+
+	auto perSecond = []( const double count, const double time ) {
+		return ( time > 0.0 ) ? count / time / 1000.0 : 0.0;
+	};
+
+	printf( "entity throughput (%u entities, %zu archetypes)\n", entityCount, entityManager.GetArchetypeCount() );
+	printf( "\tcreate  %8.3f ms | %7.2f M entities/s\n", times[0], perSecond( entityCount, times[0] ) );
+	printf( "\tupdate  %8.3f ms | %7.2f M entities/s (%u updates, %zu chunks)\n", times[1], perSecond( static_cast<double>( entityCount ) * UPDATE_COUNT, times[1] ), UPDATE_COUNT, chunks.size() );
+	printf( "\tmove    %8.3f ms | %7.2f M moves/s\n", times[2], perSecond( entityCount * 2.0, times[2] ) );
+	printf( "\tdestroy %8.3f ms | %7.2f M entities/s\n", times[3], perSecond( entityCount, times[3] ) );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
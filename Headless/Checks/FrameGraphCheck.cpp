@@ -0,0 +1,89 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/Graphics/FrameGraph.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// random passes over a few target descs (full, half and quarter size; some persistent), compiled at two back buffer
+// sizes; the plan must be valid and never use more memory than one texture per target
+const bool Headless_CheckFrameGraphs( const uint32_t graphCount )
+{
+	const frameGraphTargetDesc_t TARGET_DESCS[] =
+	{
+		{ 0, 0, 0, RENDER_FORMAT_R16G16B16A16_FLOAT, 4, RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE },
+		{ 0, 0, 0, RENDER_FORMAT_R16G16B16A16_FLOAT, 1, RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE },
+		{ 0, 0, 1, RENDER_FORMAT_R16G16B16A16_FLOAT, 1, RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE },
+		{ 0, 0, 2, RENDER_FORMAT_R16G16B16A16_FLOAT, 1, RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE },
+		{ 0, 0, 0, RENDER_FORMAT_R8G8B8A8_UNORM, 1, RENDER_BIND_RENDER_TARGET | RENDER_BIND_SHADER_RESOURCE },
+		{ 2048, 2048, 0, RENDER_FORMAT_R24G8_TYPELESS, 1, RENDER_BIND_DEPTH_STENCIL | RENDER_BIND_SHADER_RESOURCE },
+	};
+
+	const uint32_t BACK_BUFFER_SIZES[][2] = { { 1920, 1080 }, { 1280, 720 } };
+
+	std::mt19937 generator( 0xF6A9 );
+
+	FrameGraph graph;
+	uint32_t failureCount = 0, physicalCount = 0, resourceCount = 0;
+	uint64_t unaliasedSize = 0, aliasedSize = 0;
+
+	for ( uint32_t graphIndex = 0; graphIndex < graphCount; ++graphIndex ) {
+		graph.Reset();
+
+		const uint32_t passCount = 4 + generator() % 12;
+		std::vector<frameGraphResource_t> writtenTargets;
+
+		for ( uint32_t pass = 0; pass < passCount; ++pass ) {
+			graph.AddPass( "random", nullptr );
+
+			const uint32_t readCount = ( writtenTargets.empty() ) ? 0 : generator() % 4;
+			for ( uint32_t i = 0; i < readCount; ++i ) {
+				graph.Read( pass, writtenTargets[generator() % writtenTargets.size()] );
+			}
+
+			const uint32_t writeCount = 1 + generator() % 3;
+			for ( uint32_t i = 0; i < writeCount; ++i ) {
+				const bool isPersistent = ( generator() % 16 ) == 0;
+				const frameGraphResource_t target = graph.CreateTarget( "random", TARGET_DESCS[generator() % _countof( TARGET_DESCS )], isPersistent );
+
+				// persistent targets are read before being written (previous frame content)
+				if ( isPersistent ) {
+					graph.Read( pass, target );
+				}
+
+				graph.Write( pass, target );
+				writtenTargets.push_back( target );
+			}
+		}
+
+		for ( const uint32_t* backBufferSize : BACK_BUFFER_SIZES ) {
+			if ( !graph.Compile( backBufferSize[0], backBufferSize[1] ) || !graph.Validate() || graph.GetAliasedSize() > graph.GetUnaliasedSize() ) {
+				++failureCount;
+				continue;
+			}
+
+			physicalCount	+= graph.GetPhysicalCount();
+			resourceCount	+= graph.GetResourceCount();
+			unaliasedSize	+= graph.GetUnaliasedSize();
+			aliasedSize		+= graph.GetAliasedSize();
+		}
+	}
+
+	// a transient target read before being written must be rejected
+	graph.Reset();
+	const frameGraphResource_t unwrittenTarget = graph.CreateTarget( "unwritten", TARGET_DESCS[1] );
+	graph.Read( graph.AddPass( "reader", nullptr ), unwrittenTarget );
+
+	if ( graph.Compile( 1920, 1080 ) ) {
+		++failureCount;
+	}
+
+	printf( "frame graph (%u random graphs)\n", graphCount );
+	printf( "\t%u targets on %u textures | %.1f MB unaliased, %.1f MB aliased\n", resourceCount, physicalCount, unaliasedSize / ( 1024.0 * 1024.0 ), aliasedSize / ( 1024.0 * 1024.0 ) );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
@@ -0,0 +1,145 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/System/TlsfAllocator.h>
+#include <Engine/Graphics/Mesh.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// areas of 16 to 64 meshes (24 to 16k vertices, log uniform) are loaded while at most 6 are resident (~60% of the capacity); the oldest one is
+// unloaded first, mostly, so that holes of every size pile up; compaction runs past half of the free space fragmented
+// checks the blocks after every area and the live ranges (no overlap, sizes kept) after every compaction
+const bool Headless_CheckGeometryAllocator( const uint32_t areaCount )
+{
+	constexpr uint32_t	VERTEX_CAPACITY		= 1 << 20; // same as the renderer
+	constexpr uint32_t	RESIDENT_AREAS		= 6;
+	constexpr float		MAX_FRAGMENTATION	= 0.5f;
+
+	struct allocation_t
+	{
+		uint32_t	offset;
+		uint32_t	size;
+	};
+
+	std::mt19937 generator( 0x7A5F );
+	std::uniform_real_distribution<float> sizeDistribution( logf( 24.0f ), logf( 16384.0f ) );
+
+	TlsfAllocator allocator;
+	allocator.Initialize( VERTEX_CAPACITY );
+
+	std::vector<std::vector<allocation_t>> residentAreas;
+	std::vector<tlsfMove_t> moves;
+
+	uint32_t failureCount = 0, allocationCount = 0, rejectedCount = 0, compactionCount = 0;
+	uint64_t movedSize = 0;
+	double allocationTime = 0.0, fragmentationSum = 0.0, peakFragmentation = 0.0;
+
+	auto checkRanges = [&]() {
+		std::vector<allocation_t> ranges;
+
+		for ( const std::vector<allocation_t>& area : residentAreas ) {
+			ranges.insert( ranges.end(), area.begin(), area.end() );
+		}
+
+		std::sort( ranges.begin(), ranges.end(), []( const allocation_t& a, const allocation_t& b ) { return a.offset < b.offset; } );
+
+		for ( std::size_t i = 0; i < ranges.size(); ++i ) {
+			if ( allocator.GetSize( ranges[i].offset ) != ranges[i].size || ( i > 0 && ranges[i - 1].offset + ranges[i - 1].size > ranges[i].offset ) ) {
+				return false;
+			}
+		}
+
+		return ranges.size() == allocator.GetAllocationCount();
+	};
+
+	for ( uint32_t areaIndex = 0; areaIndex < areaCount; ++areaIndex ) {
+		if ( residentAreas.size() == RESIDENT_AREAS ) {
+			const std::size_t evictedArea = ( generator() % 4 == 0 ) ? generator() % residentAreas.size() : 0;
+
+			for ( const allocation_t& allocation : residentAreas[evictedArea] ) {
+				allocator.Free( allocation.offset );
+			}
+
+			residentAreas.erase( residentAreas.begin() + evictedArea );
+		}
+
+		const double fragmentation = allocator.GetFragmentation();
+		fragmentationSum	+= fragmentation;
+		peakFragmentation	= std::max( peakFragmentation, fragmentation );
+
+		if ( fragmentation > MAX_FRAGMENTATION ) {
+			allocator.Defragment( moves );
+
+			for ( std::vector<allocation_t>& area : residentAreas ) {
+				for ( allocation_t& allocation : area ) {
+					const auto move = std::lower_bound( moves.begin(), moves.end(), allocation.offset, []( const tlsfMove_t& m, const uint32_t offset ) { return m.from < offset; } );
+
+					if ( move != moves.end() && move->from == allocation.offset ) {
+						allocation.offset = move->to;
+						movedSize += move->size;
+					}
+				}
+			}
+
+			++compactionCount;
+
+			if ( allocator.GetFragmentation() != 0.0f || !checkRanges() ) {
+				++failureCount;
+			}
+		}
+
+		residentAreas.emplace_back();
+
+		const uint32_t meshCount = 16 + generator() % 49;
+		for ( uint32_t i = 0; i < meshCount; ++i ) {
+			const uint32_t size = static_cast<uint32_t>( expf( sizeDistribution( generator ) ) );
+
+			const benchClock_t::time_point allocationStart = benchClock_t::now();
+			const uint32_t offset = allocator.Allocate( size );
+			allocationTime += std::chrono::duration<double, std::micro>( benchClock_t::now() - allocationStart ).count();
+
+			++allocationCount;
+
+			// the renderer gives such meshes buffers of their own
+			if ( offset == TlsfAllocator::INVALID_OFFSET ) {
+				++rejectedCount;
+				continue;
+			}
+
+			residentAreas.back().push_back( { offset, size } );
+		}
+
+		if ( !allocator.Validate() ) {
+			++failureCount;
+		}
+	}
+
+	if ( !checkRanges() ) {
+		++failureCount;
+	}
+
+	// everything freed must merge back into a single block
+	for ( const std::vector<allocation_t>& area : residentAreas ) {
+		for ( const allocation_t& allocation : area ) {
+			allocator.Free( allocation.offset );
+		}
+	}
+
+	if ( allocator.GetUsedSize() != 0 || allocator.GetLargestFreeBlock() != VERTEX_CAPACITY || !allocator.Validate() ) {
+		++failureCount;
+	}
+
+	printf( "geometry allocator (%u areas, %u allocations)\n", areaCount, allocationCount );
+	printf( "\tavg %.3f us per allocation | %u rejected\n", ( allocationCount > 0 ) ? allocationTime / allocationCount : 0.0, rejectedCount );
+	printf( "\tfragmentation avg %.1f%% | peak %.1f%%\n", 100.0 * fragmentationSum / areaCount, 100.0 * peakFragmentation );
+	printf( "\t%u compactions | %.1f MB moved (both vertex streams)\n", compactionCount, movedSize * ( sizeof( DirectX::XMFLOAT3 ) + sizeof( vertexAttributes_t ) ) / ( 1024.0 * 1024.0 ) );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
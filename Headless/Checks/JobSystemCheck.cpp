@@ -0,0 +1,138 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/System/JobSystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct jobStress_t
+	{
+		static constexpr uint32_t	NESTED_JOB_COUNT	= 64;
+
+		jobCounter_t			counters[3];		// main stage, dependent stage, external thread
+		std::atomic<uint32_t>	runCounts[3];
+		std::atomic<uint32_t>	parentCount;		// main stage jobs (without the nested ones)
+		std::atomic<uint32_t>	earlyRunCount;		// dependent jobs which ran before the main stage completed
+		uint32_t				expectedCount;		// main stage jobs, nested ones included
+		jobDesc_t				nestedJobs[NESTED_JOB_COUNT];
+	};
+}
+
+// more jobs than a worker queue holds (the overflow runs inline), jobs submitting jobs from the workers, a stage
+// depending on the first one, a thread outside of the system submitting to the shared queue; every job must run
+// once and no dependent job early; then workers put to sleep by an idle period must wake up for a single job
+const bool Headless_CheckJobSystem( const uint32_t roundCount )
+{
+	constexpr uint32_t JOB_COUNT			= 10000;
+	constexpr uint32_t DEPENDENT_JOB_COUNT	= 1000;
+	constexpr uint32_t EXTERNAL_JOB_COUNT	= 1000;
+	constexpr uint32_t NEST_INTERVAL		= 64;	// one main stage job in NEST_INTERVAL submits nested jobs
+
+	jobStress_t stress;
+	stress.expectedCount = JOB_COUNT + ( ( JOB_COUNT + NEST_INTERVAL - 1 ) / NEST_INTERVAL ) * jobStress_t::NESTED_JOB_COUNT;
+
+	for ( jobDesc_t& job : stress.nestedJobs ) {
+		job = { []( void* data ) { static_cast<jobStress_t*>( data )->runCounts[0].fetch_add( 1, std::memory_order_relaxed ); }, &stress };
+	}
+
+	const std::vector<jobDesc_t> mainJobs( JOB_COUNT, { []( void* data ) {
+		jobStress_t* stress = static_cast<jobStress_t*>( data );
+		stress->runCounts[0].fetch_add( 1, std::memory_order_relaxed );
+
+		if ( stress->parentCount.fetch_add( 1, std::memory_order_relaxed ) % NEST_INTERVAL == 0 ) {
+			Job_Submit( stress->nestedJobs, jobStress_t::NESTED_JOB_COUNT, &stress->counters[0] );
+		}
+	}, &stress } );
+
+	const std::vector<jobDesc_t> dependentJobs( DEPENDENT_JOB_COUNT, { []( void* data ) {
+		jobStress_t* stress = static_cast<jobStress_t*>( data );
+		stress->runCounts[1].fetch_add( 1, std::memory_order_relaxed );
+
+		if ( stress->runCounts[0].load( std::memory_order_relaxed ) != stress->expectedCount ) {
+			stress->earlyRunCount.fetch_add( 1, std::memory_order_relaxed );
+		}
+	}, &stress } );
+
+	const std::vector<jobDesc_t> externalJobs( EXTERNAL_JOB_COUNT, { []( void* data ) {
+		static_cast<jobStress_t*>( data )->runCounts[2].fetch_add( 1, std::memory_order_relaxed );
+	}, &stress } );
+
+	const uint32_t jobCountPerRound = stress.expectedCount + DEPENDENT_JOB_COUNT + EXTERNAL_JOB_COUNT;
+
+	uint32_t failureCount = 0;
+	double totalTime = 0.0, maxWakeLatency = 0.0;
+
+	for ( uint32_t roundIndex = 0; roundIndex < roundCount; ++roundIndex ) {
+		for ( uint32_t i = 0; i < 3; ++i ) {
+			stress.runCounts[i].store( 0, std::memory_order_relaxed );
+		}
+
+		stress.parentCount.store( 0, std::memory_order_relaxed );
+		stress.earlyRunCount.store( 0, std::memory_order_relaxed );
+
+		const benchClock_t::time_point start = benchClock_t::now();
+
+		std::thread externalThread( [&stress, &externalJobs]() {
+			Job_Submit( externalJobs.data(), EXTERNAL_JOB_COUNT, &stress.counters[2] );
+			Job_Wait( &stress.counters[2] );
+		} );
+
+		Job_Submit( mainJobs.data(), JOB_COUNT, &stress.counters[0] );
+		Job_Submit( dependentJobs.data(), DEPENDENT_JOB_COUNT, &stress.counters[1], &stress.counters[0] );
+		Job_Wait( &stress.counters[1] );
+
+		externalThread.join();
+
+		totalTime += std::chrono::duration<double, std::milli>( benchClock_t::now() - start ).count();
+
+		if ( stress.runCounts[0].load() != stress.expectedCount || stress.runCounts[1].load() != DEPENDENT_JOB_COUNT
+		  || stress.runCounts[2].load() != EXTERNAL_JOB_COUNT || stress.earlyRunCount.load() != 0 ) {
+			++failureCount;
+		}
+
+		if ( Job_GetWorkerCount() < 2 ) {
+			continue;
+		}
+
+		// long enough for every worker to go to sleep; the submitting thread does not help, a lost wakeup times out
+		std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+
+		std::atomic<int64_t> runTime( 0 );
+		const jobDesc_t wakeJob = { []( void* data ) {
+			static_cast<std::atomic<int64_t>*>( data )->store( benchClock_t::now().time_since_epoch().count(), std::memory_order_release );
+		}, &runTime };
+
+		jobCounter_t wakeCounter;
+		const benchClock_t::time_point submitTime = benchClock_t::now();
+		Job_Submit( &wakeJob, 1, &wakeCounter );
+
+		while ( runTime.load( std::memory_order_acquire ) == 0 && benchClock_t::now() - submitTime < std::chrono::seconds( 1 ) ) {
+			std::this_thread::yield();
+		}
+
+		if ( runTime.load( std::memory_order_acquire ) == 0 ) {
+			++failureCount;
+		} else {
+			const benchClock_t::time_point wakeTime( benchClock_t::duration( runTime.load( std::memory_order_relaxed ) ) );
+			maxWakeLatency = std::max( maxWakeLatency, std::chrono::duration<double, std::milli>( wakeTime - submitTime ).count() );
+		}
+
+		Job_Wait( &wakeCounter );
+	}
+
+	const double jobRate = ( totalTime > 0.0 ) ? static_cast<double>( jobCountPerRound ) * roundCount / totalTime / 1000.0 : 0.0;
+
+	printf( "job system (%u rounds, %u jobs each)\n", roundCount, jobCountPerRound );
+	printf( "\tavg %.3f ms per round | %.2f M jobs/s | max wake latency %.3f ms\n", totalTime / roundCount, jobRate, maxWakeLatency );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
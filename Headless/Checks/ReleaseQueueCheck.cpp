@@ -0,0 +1,214 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/Graphics/Mesh.h>
+#include <Engine/Graphics/RenderContext.h>
+#include <Engine/Graphics/GeometryBuffer.h>
+#include <Engine/Graphics/ReleaseQueue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+// meshes (8 to 4k vertices) are created in the shared geometry buffers of a null render context, copied up to three
+// times, and their copies released over the next frames; the renderer ends the frames 0 to 2 frames behind the one
+// being built, like the render thread. a range must stay allocated while a snapshot built before the drop of a
+// reference is not rendered, lose that reference at the first Collect after it, and be freed with the last one only;
+// once every copy is released and every frame rendered, the geometry buffers must be empty
+const bool Headless_CheckReleaseOrder( const uint32_t frameCount )
+{
+	constexpr uint32_t	MESHES_PER_FRAME	= 4;
+	constexpr uint32_t	MAX_COPY_COUNT		= 3;
+	constexpr uint64_t	MAX_FRAME_LAG		= 2;
+
+	struct trackedGeometry_t
+	{
+		mesh_t				mesh;			// copied for each release (copies share the range)
+		geometryRange_t*	range;
+		uint32_t			vertexCount;
+		uint32_t			copyCount;
+		uint32_t			releasedCount;	// Render_ReleaseMesh calls
+		uint32_t			retiredCount;	// references dropped by the release queue
+	};
+
+	struct trackedRelease_t
+	{
+		uint32_t	geometry;
+		uint64_t	frame;		// being built when released
+		bool		isRetired;
+	};
+
+	std::mt19937 generator( 0x48E1 );
+	std::uniform_real_distribution<float> sizeDistribution( logf( 8.0f ), logf( 4096.0f ) );
+
+	renderContext_t context = {};
+	if ( Sys_CreateNullRenderContext( &context, 64, 64 ) != 0 ) {
+		printf( "release order: failed to create the null render context\n" );
+		return false;
+	}
+
+	GeometryBuffer* geometry = context.geometry;
+
+	std::vector<trackedGeometry_t> geometries;
+	std::vector<uint32_t> liveGeometries;	// copies left to release
+	std::deque<trackedRelease_t> releases;
+	std::size_t firstPendingRelease = 0;	// older ones are retired
+
+	std::vector<DirectX::XMFLOAT3> positions;
+	std::vector<vertexAttributes_t> attributes;
+	std::vector<unsigned int> indices;
+
+	uint32_t failureCount = 0, copyCount = 0;
+	uint64_t renderedFrameCount = 0, currentFrame = 0, maxRetireDelay = 0;
+
+	// the renderer is done with frames in order
+	auto endFrames = [&]( const uint64_t maxFrameCount ) {
+		while ( renderedFrameCount < maxFrameCount ) {
+			context.releases->EndFrame( renderedFrameCount++ );
+		}
+	};
+
+	// queued right behind the release: run by the same Collect, once the mesh reference is dropped
+	auto retire = [&]( const std::size_t releaseIndex ) {
+		trackedRelease_t& release = releases[releaseIndex];
+		trackedGeometry_t& tracked = geometries[release.geometry];
+
+		release.isRetired = true;
+		++tracked.retiredCount;
+
+		// a snapshot built before the release might still draw the mesh
+		if ( renderedFrameCount <= release.frame ) {
+			++failureCount;
+		}
+
+		maxRetireDelay = std::max( maxRetireDelay, currentFrame - release.frame );
+
+		if ( tracked.retiredCount == tracked.copyCount ) {
+			failureCount += ( tracked.range->vertexCount != 0 ) ? 1 : 0;
+		} else if ( tracked.range->vertexCount != tracked.vertexCount || tracked.range->refCount != tracked.copyCount - tracked.retiredCount ) {
+			++failureCount;
+		}
+	};
+
+	auto releaseCopy = [&]( const uint32_t geometryIndex ) {
+		trackedGeometry_t& tracked = geometries[geometryIndex];
+
+		mesh_t copy = tracked.mesh;
+		Render_ReleaseMesh( &context, nullptr, &copy ); // no submeshes: no material manager
+
+		const std::size_t releaseIndex = releases.size();
+		releases.push_back( { geometryIndex, currentFrame, false } );
+		++tracked.releasedCount;
+
+		context.releases->Enqueue( [&retire, releaseIndex]() { retire( releaseIndex ); } );
+	};
+
+	auto collect = [&]() {
+		context.releases->Collect();
+
+		for ( std::size_t i = firstPendingRelease; i < releases.size(); ++i ) {
+			const trackedRelease_t& release = releases[i];
+			const trackedGeometry_t& tracked = geometries[release.geometry];
+
+			// every release whose frame has been rendered runs; the others keep their reference
+			if ( release.isRetired != ( release.frame < renderedFrameCount ) ) {
+				++failureCount;
+			}
+
+			if ( !release.isRetired && ( tracked.range->vertexCount != tracked.vertexCount || tracked.range->refCount != tracked.copyCount - tracked.retiredCount ) ) {
+				++failureCount;
+			}
+		}
+
+		while ( firstPendingRelease < releases.size() && releases[firstPendingRelease].isRetired ) {
+			++firstPendingRelease;
+		}
+	};
+
+	for ( uint32_t frame = 0; frame < frameCount + MAX_FRAME_LAG + 1; ++frame ) {
+		const bool isDraining = frame >= frameCount;
+
+		currentFrame = frame;
+		context.releases->BeginFrame( frame );
+		collect();
+
+		// render thread side, between frames
+		geometry->Upload( &context );
+		geometry->Compact( &context, 0.5f );
+
+		for ( uint32_t i = 0; i < MESHES_PER_FRAME && !isDraining; ++i ) {
+			const uint32_t vertexCount = static_cast<uint32_t>( expf( sizeDistribution( generator ) ) );
+			const uint32_t indiceCount = vertexCount * 3;
+
+			positions.assign( vertexCount, DirectX::XMFLOAT3( 0.0f, 0.0f, 0.0f ) );
+			attributes.assign( vertexCount, vertexAttributes_t() );
+			indices.resize( indiceCount );
+
+			for ( uint32_t j = 0; j < indiceCount; ++j ) {
+				indices[j] = generator() % vertexCount;
+			}
+
+			trackedGeometry_t tracked = {};
+
+			if ( Render_CreateMeshBuffers( &context, &tracked.mesh, positions.data(), attributes.data(), vertexCount, indices.data(), indiceCount ) != 0 || tracked.mesh.geometryRange == nullptr ) {
+				++failureCount;
+				continue;
+			}
+
+			tracked.range		= tracked.mesh.geometryRange;
+			tracked.vertexCount	= vertexCount;
+			tracked.copyCount	= 1 + generator() % MAX_COPY_COUNT;
+
+			for ( uint32_t j = 1; j < tracked.copyCount; ++j ) {
+				Render_AcquireMesh( &context, nullptr, &tracked.mesh );
+			}
+
+			copyCount += tracked.copyCount;
+
+			liveGeometries.push_back( static_cast<uint32_t>( geometries.size() ) );
+			geometries.push_back( std::move( tracked ) );
+		}
+
+		// a third of the copies go every frame; the rest once the run is over
+		for ( std::size_t i = 0; i < liveGeometries.size(); ) {
+			const uint32_t geometryIndex = liveGeometries[i];
+
+			if ( isDraining || generator() % 3 == 0 ) {
+				releaseCopy( geometryIndex );
+			}
+
+			if ( geometries[geometryIndex].releasedCount == geometries[geometryIndex].copyCount ) {
+				liveGeometries[i] = liveGeometries.back();
+				liveGeometries.pop_back();
+			} else {
+				++i;
+			}
+		}
+
+		// one snapshot queued and one being rendered at most
+		const uint64_t frameLag = isDraining ? 0 : generator() % ( MAX_FRAME_LAG + 1 );
+		endFrames( ( frame + 1 > frameLag ) ? frame + 1 - frameLag : 0 );
+	}
+
+	// everything is rendered: the last releases run
+	currentFrame = frameCount + MAX_FRAME_LAG + 1;
+	context.releases->BeginFrame( currentFrame );
+	collect();
+
+	if ( !liveGeometries.empty() || firstPendingRelease != releases.size() || context.releases->GetPendingCount() != 0
+		|| geometry->GetVertexAllocator().GetUsedSize() != 0 || geometry->GetIndiceAllocator().GetUsedSize() != 0 ) {
+		++failureCount;
+	}
+
+	Sys_DestroyRenderContext( &context );
+
+	printf( "release order (%u frames, %zu meshes, %u copies)\n", frameCount, geometries.size(), copyCount );
+	printf( "\t%zu releases | up to %llu frames from release to retirement\n", releases.size(), static_cast<unsigned long long>( maxRetireDelay ) );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
@@ -0,0 +1,59 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/Graphics/RenderQueue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// sorts a render queue filled with plausible keys (few passes/shaders, many materials, random depths)
+void Headless_BenchmarkRenderQueueSort( const uint32_t itemCount )
+{
+	constexpr int ITERATION_COUNT = 100;
+
+	std::mt19937 generator( 0x5EED );
+	std::uniform_int_distribution<uint32_t> materialDistribution( 1, 2048 );
+	std::uniform_real_distribution<float> depthDistribution( 0.01f, 1000.0f );
+
+	std::vector<sortKey_t> keys( itemCount );
+
+	for ( uint32_t i = 0; i < itemCount; ++i ) {
+		const bool isTransparent = ( generator() % 10 ) == 0;
+
+		keys[i] = Render_BuildSortKey( isTransparent ? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE,
+									   isTransparent ? SURF_TRANSPARENT : SURF_OPAQUE,
+									   generator() % 4,
+									   materialDistribution( generator ),
+									   depthDistribution( generator ) );
+	}
+
+	RenderQueue queue;
+	double totalTime = 0.0, minTime = 1e30, maxTime = 0.0; // ms
+
+	for ( int iteration = 0; iteration < ITERATION_COUNT; ++iteration ) {
+		queue.Clear();
+
+		for ( uint32_t i = 0; i < itemCount; ++i ) {
+			queue.Push( keys[i], i );
+		}
+
+		const benchClock_t::time_point sortStart = benchClock_t::now();
+		queue.Sort();
+
+		const double sortTime = std::chrono::duration<double, std::milli>( benchClock_t::now() - sortStart ).count();
+
+		totalTime += sortTime;
+		minTime = std::min( minTime, sortTime );
+		maxTime = std::max( maxTime, sortTime );
+	}
+
+	const double averageTime = totalTime / ITERATION_COUNT;
+
+	printf( "render queue sort (%u items)\n", itemCount );
+	printf( "\tavg %8.4f ms | min %8.4f ms | max %8.4f ms\n", averageTime, minTime, maxTime );
+	printf( "\t%.1f Mitems/s\n", ( averageTime > 0.0 ) ? itemCount / ( averageTime * 1000.0 ) : 0.0 );
+}
@@ -0,0 +1,129 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/System/RingAllocator.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+// frames of 1 to 8 blocks (up to 1/8 of the ring each) retired two frames later, like the gpu fences of the
+// constant ring; a failed allocation stalls on the oldest frame in flight. every block must be aligned, inside the
+// ring and clear of the blocks of unretired frames; an empty ring must satisfy any request that fits; the ring must
+// wrap and stall along the way, and retiring every fence must leave it empty
+const bool Headless_CheckRingAllocator( const uint32_t frameCount )
+{
+	constexpr std::size_t	CAPACITY		= 64 * 1024;
+	constexpr std::size_t	ALIGNMENT		= 256;
+	constexpr uint64_t		FRAME_LATENCY	= 2;
+
+	struct ringFrame_t
+	{
+		uint64_t									fence;
+		std::vector<std::pair<size_t, size_t>>		blocks; // offset, aligned size
+	};
+
+	std::mt19937 generator( 0x1216 );
+	std::uniform_int_distribution<uint32_t> blockCountDistribution( 1, 8 );
+	std::uniform_int_distribution<size_t> sizeDistribution( 1, CAPACITY / 8 );
+
+	RingAllocator allocator;
+	allocator.Initialize( CAPACITY, ALIGNMENT );
+
+	std::vector<uint8_t> unitOwners( CAPACITY / ALIGNMENT, 0 ); // 1: in a live block
+	std::deque<ringFrame_t> liveFrames;
+
+	uint32_t failureCount = 0, allocationCount = 0, wrapCount = 0, stallCount = 0;
+	size_t peakUsedSize = 0, previousOffset = 0;
+
+	auto retire = [&]( const uint64_t completedFence ) {
+		allocator.Retire( completedFence );
+
+		while ( !liveFrames.empty() && liveFrames.front().fence <= completedFence ) {
+			for ( const auto& block : liveFrames.front().blocks ) {
+				std::fill( unitOwners.begin() + block.first / ALIGNMENT, unitOwners.begin() + ( block.first + block.second ) / ALIGNMENT, 0 );
+			}
+
+			liveFrames.pop_front();
+		}
+
+		if ( allocator.GetPendingFrameCount() != liveFrames.size() ) {
+			++failureCount;
+		}
+	};
+
+	for ( uint64_t fence = 1; fence <= frameCount; ++fence ) {
+		if ( fence > FRAME_LATENCY ) {
+			retire( fence - FRAME_LATENCY );
+		}
+
+		ringFrame_t frame = { fence, {} };
+		const uint32_t blockCount = blockCountDistribution( generator );
+
+		for ( uint32_t i = 0; i < blockCount; ++i ) {
+			const size_t size = sizeDistribution( generator );
+			const size_t alignedSize = ( size + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT;
+
+			size_t offset = allocator.Allocate( size );
+
+			// stall: wait for the oldest frame in flight (the frame being built cannot be waited for)
+			while ( offset == RingAllocator::INVALID_OFFSET && !liveFrames.empty() ) {
+				if ( allocator.CanAllocate( size ) ) {
+					++failureCount;
+				}
+
+				++stallCount;
+				retire( liveFrames.front().fence );
+
+				offset = allocator.Allocate( size );
+			}
+
+			if ( offset == RingAllocator::INVALID_OFFSET ) {
+				// only the blocks of this frame are left; an empty ring must not refuse anything that fits
+				if ( frame.blocks.empty() ) {
+					++failureCount;
+				}
+
+				break;
+			}
+
+			if ( offset % ALIGNMENT != 0 || offset + alignedSize > CAPACITY ) {
+				++failureCount;
+				continue;
+			}
+
+			for ( size_t unit = offset / ALIGNMENT; unit < ( offset + alignedSize ) / ALIGNMENT; ++unit ) {
+				failureCount += unitOwners[unit];
+				unitOwners[unit] = 1;
+			}
+
+			if ( offset < previousOffset ) {
+				++wrapCount;
+			}
+
+			previousOffset = offset;
+			peakUsedSize = std::max( peakUsedSize, allocator.GetUsedSize() );
+
+			frame.blocks.emplace_back( offset, alignedSize );
+			++allocationCount;
+		}
+
+		allocator.EndFrame( fence );
+		liveFrames.push_back( std::move( frame ) );
+	}
+
+	retire( frameCount );
+
+	if ( allocator.GetUsedSize() != 0 || wrapCount == 0 || stallCount == 0 || allocator.Allocate( CAPACITY ) != 0 ) {
+		++failureCount;
+	}
+
+	printf( "ring allocator (%u frames, %zu KB ring)\n", frameCount, CAPACITY / 1024 );
+	printf( "\t%u allocations | %u wraps | %u stalls | peak usage %.1f%%\n", allocationCount, wrapCount, stallCount, 100.0 * peakUsedSize / CAPACITY );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
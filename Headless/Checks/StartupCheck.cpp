@@ -0,0 +1,157 @@
+#include <Engine/Shared.h>
+
+#include "Checks.h"
+
+#include <Engine/System/TaskGraph.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// the renderer startup steps (rough costs in ms) and their dependencies; main thread steps use the immediate context
+	struct startupStep_t
+	{
+		const char*		name;
+		int				cost;
+		bool			isMainThread;
+		int				dependency;		// index in the steps; -1: none
+	};
+
+	const startupStep_t STARTUP_STEPS[] =
+	{
+		{ "light manager",			0,	false,	-1 },
+		{ "cbuffer ring",			1,	false,	-1 },
+		{ "transform buffer",		1,	false,	-1 },
+		{ "command recorder",		2,	false,	-1 },
+		{ "shaders",				40,	false,	-1 },
+		{ "opaque surface",			3,	false,	4 },
+		{ "bloom",					3,	false,	4 },
+		{ "shadow mapping",			3,	false,	4 },
+		{ "gaussian blur",			3,	false,	4 },
+		{ "atmosphere",				3,	false,	4 },
+		{ "composition",			5,	true,	4 },
+		{ "atmosphere precompute",	60,	true,	9 },
+		{ "default surface",		4,	false,	-1 },
+		{ "skybox",					15,	true,	-1 },
+		{ "brdf lut",				10,	false,	-1 },
+		{ "bind brdf lut",			0,	true,	14 },
+		{ "env map",				30,	false,	-1 },
+		{ "bind env map",			0,	true,	16 },
+		{ "frame graph",			5,	false,	-1 },
+	};
+}
+
+// every step runs once, after its dependency, on the right thread; then the failure of the brdf lut must skip its
+// binding only, and a cycle must be rejected
+const bool Headless_CheckStartupGraph( const uint32_t runCount )
+{
+	constexpr uint32_t STEP_COUNT = _countof( STARTUP_STEPS );
+	constexpr uint32_t FAILING_STEP = 14;
+
+	struct stepRun_t
+	{
+		benchClock_t::time_point	start;
+		benchClock_t::time_point	end;
+		std::thread::id				thread;
+		uint32_t					runCount;
+	};
+
+	const std::thread::id mainThread = std::this_thread::get_id();
+
+	stepRun_t stepRuns[STEP_COUNT];
+	uint32_t failureCount = 0;
+	double totalTime = 0.0, serialTime = 0.0;
+
+	TaskGraph graph;
+
+	auto buildGraph = [&]( const uint32_t failingStep ) {
+		graph.Reset();
+
+		for ( uint32_t i = 0; i < STEP_COUNT; ++i ) {
+			graph.AddTask( STARTUP_STEPS[i].name, [&stepRuns, i, failingStep]() {
+				stepRun_t& run = stepRuns[i];
+				run.start	= benchClock_t::now();
+				run.thread	= std::this_thread::get_id();
+				run.runCount++;
+
+				std::this_thread::sleep_for( std::chrono::milliseconds( STARTUP_STEPS[i].cost ) );
+
+				run.end = benchClock_t::now();
+				return ( i == failingStep ) ? 2 : 0;
+			}, STARTUP_STEPS[i].isMainThread );
+		}
+
+		for ( uint32_t i = 0; i < STEP_COUNT; ++i ) {
+			if ( STARTUP_STEPS[i].dependency >= 0 ) {
+				graph.DependsOn( i, static_cast<uint32_t>( STARTUP_STEPS[i].dependency ) );
+			}
+		}
+
+		for ( stepRun_t& run : stepRuns ) {
+			run.runCount = 0;
+		}
+	};
+
+	for ( uint32_t runIndex = 0; runIndex < runCount; ++runIndex ) {
+		buildGraph( ~0u );
+
+		if ( graph.Execute() != 0 ) {
+			++failureCount;
+			continue;
+		}
+
+		for ( uint32_t i = 0; i < STEP_COUNT; ++i ) {
+			const startupStep_t& step = STARTUP_STEPS[i];
+			const stepRun_t& run = stepRuns[i];
+
+			const bool isOnRightThread = !step.isMainThread || run.thread == mainThread;
+			const bool isAfterDependency = step.dependency < 0 || run.start >= stepRuns[step.dependency].end;
+
+			if ( run.runCount != 1 || !isOnRightThread || !isAfterDependency ) {
+				++failureCount;
+			}
+
+			serialTime += graph.GetTiming( i ).duration;
+		}
+
+		totalTime += graph.GetTotalTime();
+	}
+
+	std::string report;
+	graph.WriteReport( report );
+
+	// a failure skips the dependents only
+	buildGraph( FAILING_STEP );
+
+	if ( graph.Execute() != 2 ) {
+		++failureCount;
+	}
+
+	for ( uint32_t i = 0; i < STEP_COUNT; ++i ) {
+		const bool isDependent = STARTUP_STEPS[i].dependency == static_cast<int>( FAILING_STEP );
+
+		if ( stepRuns[i].runCount != ( isDependent ? 0u : 1u ) || ( isDependent && graph.GetTiming( i ).status != TASK_GRAPH_SKIPPED ) ) {
+			++failureCount;
+		}
+	}
+
+	graph.Reset();
+	const uint32_t first = graph.AddTask( "first", []() { return 0; } );
+	const uint32_t second = graph.AddTask( "second", []() { return 0; } );
+	graph.DependsOn( first, second );
+	graph.DependsOn( second, first );
+
+	if ( graph.Execute() != -1 ) {
+		++failureCount;
+	}
+
+	printf( "startup task graph (%u runs)\n", runCount );
+	printf( "%s", report.c_str() );
+	printf( "\tavg %.3f ms | serial %.3f ms\n", totalTime / runCount, serialTime / runCount );
+	printf( "\t%u failures\n", failureCount );
+
+	return failureCount == 0;
+}
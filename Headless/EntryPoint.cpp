@@ -0,0 +1,657 @@
+#include <Engine/Shared.h>
+
+#include "Checks/Checks.h"
+
+#include <Engine/System/JobSystem.h>
+#include <Engine/System/FixedStep.h>
+#include <Engine/Game/World.h>
+#include <Engine/Game/Actor.h>
+#include <Engine/Game/AreaStreamer.h>
+#include <Engine/Game/StateManager.h>
+#include <Engine/Io/AreaFileReaderWriter.h>
+#include <Engine/Graphics/Mesh.h>
+#include <Engine/Graphics/RenderSnapshot.h>
+#include <Engine/Graphics/RenderBackendNull.h>
+#include <Engine/Graphics/RenderManager.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <thread>
+
+// headless run: world simulation and cpu side render preparation, without window, input nor gpu
+// meant for benchmarking and soak testing (e.g. on build machines)
+//	headless [-frames N] [-actors N] [-lights N] [-workers N] [-report N] [-sort N] [-record N] [-diff file] [-framegraph N] [-geometry N] [-startup N] [-dynres N] [-jobs N] [-ecs N] [-ring N] [-release N] [-area N] [-stream N]
+// the populated area (actors and lights) is followed by a row of N streamed areas (-stream, 8 by default); the streamer
+// follows a point travelling back and forth along the row, and the actors are ticked by a game state (see StateManager)
+// which pins the populated area
+// -record 1 renders every frame with the render manager on the null backend (see RenderManager::InitializeHeadless),
+// reports the draws and state changes and saves the last frame stream (headless_commands.bin); the stream hash must not
+// depend on -workers
+// -diff file compares the last frame stream with a saved one (e.g. from another build) instead of saving it; fails the
+// run if they differ
+// -framegraph N compiles N random frame graphs and checks their aliasing plans; fails the run if one is invalid
+// -geometry N streams N areas of random meshes through the geometry buffer allocator (see GeometryBuffer), reports the
+// fragmentation they leave and checks the allocator and its compaction; fails the run if one is invalid
+// -startup N executes N times a task graph shaped like the renderer startup (see RenderManager::Initialize), with
+// sleeps standing for the loads; reports the timings and checks the ordering; fails the run if one is invalid
+// -dynres N feeds the dynamic resolution controller a synthetic gpu frame time trace (phases of N frames each), reports
+// how it settles and checks its bounds, convergence and determinism; fails the run if one is invalid
+// -jobs N runs N rounds of job system stress (queue overflow, nested submissions, dependencies, outside submitter,
+// wakeups after idling), reports the throughput and checks that every job ran once and in order; fails the run if not
+// -ecs N creates, updates, moves between archetypes and destroys N entities (e.g. 100000), reports the throughput and
+// checks the components (including entities larger than a chunk); fails the run if one is invalid
+// -ring N allocates N frames of constants from a ring allocator with two frames in flight (see CBufferRing), and checks
+// the blocks against the frames not retired yet, the wraps, the stalls and the fence releases; fails the run if one is invalid
+// -release N runs N frames of mesh copies released on a null render context (see ReleaseQueue), and checks that each
+// geometry range loses a reference only once the frames built before the release are rendered, and is freed with the
+// last one; fails the run if one is invalid
+// -area N saves N areas holding every kind of node content, streams them back in (see AreaStreamer) and checks the node
+// trees and the snapshot built from them against the saved ones; fails the run if they differ
+
+namespace
+{
+	enum phase_t
+	{
+		PHASE_STREAMING = 0,	// area streaming + state transitions
+		PHASE_SIMULATION,		// fixed tick (actor systems)
+		PHASE_TRANSFORMS,		// actor transforms + hierarchy propagation
+		PHASE_RENDER_PREP,		// render snapshot (draws and lights gathering)
+		PHASE_SUBMISSION,		// frame rendered on the null backend (-record only)
+		PHASE_FRAME,
+
+		PHASE_COUNT
+	};
+
+	const char* PHASE_NAMES[PHASE_COUNT] =
+	{
+		"streaming",
+		"simulation",
+		"transforms",
+		"render prep",
+		"submission",
+		"frame",
+	};
+
+	struct phaseTiming_t
+	{
+		double		total;	// ms
+		double		min;
+		double		max;
+		uint64_t	count;
+	};
+
+	struct headlessSettings_t
+	{
+		uint32_t	frameCount;
+		uint32_t	actorCount;
+		uint32_t	lightCount;
+		int			workerCount;	// -1: one per core
+		uint32_t	reportInterval;	// frames; 0: only at the end
+		uint32_t	sortItemCount;	// render queue sort benchmark; 0: skipped
+		uint32_t	recordCommands;	// 0: no submission
+		const char*	diffFileName;		// saved stream the last frame is compared with; null: none
+		uint32_t	frameGraphCount;	// random frame graphs checked; 0: skipped
+		uint32_t	geometryAreaCount;	// areas streamed through the geometry allocator; 0: skipped
+		uint32_t	startupRunCount;	// startup task graph executions; 0: skipped
+		uint32_t	dynresPhaseLength;	// frames per phase of the dynamic resolution trace; 0: skipped
+		uint32_t	jobRoundCount;		// job system stress rounds; 0: skipped
+		uint32_t	ecsEntityCount;		// entity throughput benchmark; 0: skipped
+		uint32_t	ringFrameCount;		// frames run through the ring allocator; 0: skipped
+		uint32_t	releaseFrameCount;	// frames of deferred mesh releases; 0: skipped
+		uint32_t	savedAreaCount;		// areas saved and streamed back in; 0: skipped
+		uint32_t	streamedAreaCount;	// areas streamed in and out along the row; 0: only the populated one
+	};
+
+	// moves actors around so that every tick produces dirty transforms
+	struct headlessMotion_t
+	{
+		DirectX::XMFLOAT3	origin;
+		float				radius;
+		float				angularSpeed;	// radians per ms
+		float				angle;
+	};
+
+	class HeadlessMotionSystem : public EntitySystem
+	{
+	public:
+		HeadlessMotionSystem()
+			: EntitySystem( Ecs_ComponentMask<headlessMotion_t>(), Ecs_ComponentMask<actorTransform_t>() )
+		{
+
+		}
+
+		virtual void Update( EntityManager* entityManager, const float frameTime ) override
+		{
+			entityManager->ForEachChunk( GetReadMask() | GetWriteMask(), 0, [frameTime]( entityChunk_t* chunk ) {
+				actorTransform_t* transforms	= Ecs_GetChunkComponents<actorTransform_t>( chunk );
+				headlessMotion_t* motions		= Ecs_GetChunkComponents<headlessMotion_t>( chunk );
+
+				for ( uint32_t i = 0; i < chunk->count; ++i ) {
+					headlessMotion_t& motion = motions[i];
+					motion.angle += motion.angularSpeed * frameTime;
+
+					transforms[i].translation = DirectX::XMFLOAT3( motion.origin.x + cosf( motion.angle ) * motion.radius,
+																   motion.origin.y,
+																   motion.origin.z + sinf( motion.angle ) * motion.radius );
+					transforms[i].isDirty = 1;
+				}
+			} );
+		}
+	};
+
+	// the headless game state: ticks the actor systems once its areas are resident
+	class HeadlessState : public GameState
+	{
+	public:
+		HeadlessState( SystemScheduler* systems, EntityManager* entities )
+			: actorSystems( systems )
+			, entityManager( entities )
+		{
+
+		}
+
+		virtual void GetDependencies( stateDependencies_t& dependencies ) const override
+		{
+			// the populated area stays pinned wherever the streaming goes; the first streamed one is waited for
+			dependencies.areas.push_back( { 0, 0 } );
+			dependencies.areas.push_back( { 1, 0 } );
+		}
+
+		virtual void Update( const float tickDuration ) override
+		{
+			actorSystems->Update( entityManager, tickDuration );
+		}
+
+	private:
+		SystemScheduler*	actorSystems;
+		EntityManager*		entityManager;
+	};
+
+	void ParseSettings( const int argc, char** argv, headlessSettings_t& settings )
+	{
+		for ( int i = 1; i + 1 < argc; i += 2 ) {
+			const int value = atoi( argv[i + 1] );
+
+			if ( strcmp( argv[i], "-diff" ) == 0 ) {
+				settings.diffFileName = argv[i + 1];
+			} else if ( strcmp( argv[i], "-frames" ) == 0 ) {
+				settings.frameCount = static_cast<uint32_t>( std::max( value, 1 ) );
+			} else if ( strcmp( argv[i], "-actors" ) == 0 ) {
+				settings.actorCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-lights" ) == 0 ) {
+				settings.lightCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-workers" ) == 0 ) {
+				settings.workerCount = value;
+			} else if ( strcmp( argv[i], "-report" ) == 0 ) {
+				settings.reportInterval = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-sort" ) == 0 ) {
+				settings.sortItemCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-record" ) == 0 ) {
+				settings.recordCommands = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-framegraph" ) == 0 ) {
+				settings.frameGraphCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-geometry" ) == 0 ) {
+				settings.geometryAreaCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-startup" ) == 0 ) {
+				settings.startupRunCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-dynres" ) == 0 ) {
+				settings.dynresPhaseLength = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-jobs" ) == 0 ) {
+				settings.jobRoundCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-ecs" ) == 0 ) {
+				settings.ecsEntityCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-ring" ) == 0 ) {
+				settings.ringFrameCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-release" ) == 0 ) {
+				settings.releaseFrameCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-area" ) == 0 ) {
+				settings.savedAreaCount = static_cast<uint32_t>( std::max( value, 0 ) );
+			} else if ( strcmp( argv[i], "-stream" ) == 0 ) {
+				settings.streamedAreaCount = static_cast<uint32_t>( std::min( std::max( value, 0 ), 254 ) );
+			} else {
+				printf( "unknown option '%s'\n", argv[i] );
+			}
+		}
+	}
+
+	// every actor owns a mesh (without gpu resources) as a child node
+	// with materials, each mesh gets a submesh so that the snapshot has something to sort and batch
+	void PopulateWorld( World* world, const headlessSettings_t& settings, std::vector<material_t>& materials )
+	{
+		EntityManager* entityManager = world->GetEntityManager();
+
+		for ( uint32_t i = 0; i < settings.actorCount; ++i ) {
+			actor_t* actor = static_cast<actor_t*>( world->AllocateContent( NODE_FLAG_CONTENT_ACTOR ) );
+			areaNode_t* actorNode = world->InsertNode( actor, NODE_FLAG_CONTENT_ACTOR );
+
+			mesh_t* mesh = static_cast<mesh_t*>( world->AllocateContent( NODE_FLAG_CONTENT_MESH ) );
+			mesh->transformation->boundingSphere = DirectX::BoundingSphere( DirectX::XMFLOAT3( 0.0f, 0.0f, 0.0f ), 1.0f );
+
+			if ( !materials.empty() ) {
+				const unsigned int indiceCount = 36 * ( 1 + i % 3 );
+				mesh->subMeshes.push_back( { &materials[i % materials.size()], mesh->transformation, 0, 0, indiceCount, 0 } );
+			}
+
+			world->InsertNode( mesh, NODE_FLAG_CONTENT_MESH, actorNode );
+
+			entityManager->AddComponents( actor->entity, Ecs_ComponentMask<headlessMotion_t>() );
+
+			headlessMotion_t* motion = entityManager->GetComponent<headlessMotion_t>( actor->entity );
+			motion->origin			= DirectX::XMFLOAT3( static_cast<float>( i % 64 ) * 4.0f, 0.0f, static_cast<float>( i / 64 ) * 4.0f );
+			motion->radius			= 1.0f + static_cast<float>( i % 7 );
+			motion->angularSpeed	= 0.001f * static_cast<float>( 1 + i % 5 );
+			motion->angle			= static_cast<float>( i );
+		}
+
+		for ( uint32_t i = 0; i < settings.lightCount; ++i ) {
+			sphereAreaLight_t* light = static_cast<sphereAreaLight_t*>( world->AllocateContent( NODE_FLAG_CONTENT_SPHERE_LIGHT ) );
+			light->worldPositionRadius	= DirectX::XMFLOAT4( static_cast<float>( i ) * 8.0f, 4.0f, 0.0f, 1.0f );
+			light->color				= DirectX::XMFLOAT4( 1.0f, 1.0f, 1.0f, 1000.0f );
+
+			world->InsertNode( light, NODE_FLAG_CONTENT_SPHERE_LIGHT );
+		}
+	}
+
+	constexpr float	STREAMED_AREA_SIZE	= 64.0f;
+	constexpr float	STREAMING_SPEED		= 2.0f; // units per frame; whatever the frame cost, so that runs are reproducible
+
+	// see AreaStreamer::GetAreaFileName
+	std::string GetStreamedAreaFileName( const uint32_t areaIndex )
+	{
+		return "./area_" + std::to_string( areaIndex ) + "_0.area";
+	}
+
+	// 8x8 meshes (without gpu resources) and a couple of lights per area, in the areas 1 to areaCount of the row
+	const bool WriteStreamedAreas( const uint32_t areaCount )
+	{
+		for ( uint32_t i = 1; i <= areaCount; ++i ) {
+			World areaWorld = {};
+			areaWorld.CreateEmptyArea();
+
+			const float originX = static_cast<float>( i ) * STREAMED_AREA_SIZE;
+
+			for ( uint32_t j = 0; j < 64; ++j ) {
+				mesh_t* mesh = static_cast<mesh_t*>( areaWorld.AllocateContent( NODE_FLAG_CONTENT_MESH ) );
+				mesh->fileName							= "base_data/meshes/headless/crate.sge";
+				mesh->transformation->modelMatrix		= DirectX::XMMatrixTranslation( originX + 4.0f + static_cast<float>( j % 8 ) * 8.0f, 0.0f, 4.0f + static_cast<float>( j / 8 ) * 8.0f );
+				mesh->transformation->boundingSphere	= DirectX::BoundingSphere( DirectX::XMFLOAT3( 0.0f, 0.0f, 0.0f ), 1.0f );
+
+				areaWorld.InsertNode( mesh, NODE_FLAG_CONTENT_MESH );
+			}
+
+			for ( uint32_t j = 0; j < 2; ++j ) {
+				sphereAreaLight_t* light = static_cast<sphereAreaLight_t*>( areaWorld.AllocateContent( NODE_FLAG_CONTENT_SPHERE_LIGHT ) );
+				light->worldPositionRadius	= DirectX::XMFLOAT4( originX + 16.0f + static_cast<float>( j ) * 32.0f, 4.0f, 32.0f, 1.0f );
+				light->color				= DirectX::XMFLOAT4( 1.0f, 0.8f, 0.6f, 1000.0f );
+
+				areaWorld.InsertNode( light, NODE_FLAG_CONTENT_SPHERE_LIGHT );
+			}
+
+			areaWorld.UpdateTransforms();
+
+			if ( Io_WriteAreaFile( GetStreamedAreaFileName( i ).c_str(), areaWorld.GetActiveArea() ) != 0 ) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// back and forth along the row (populated area included)
+	void GetStreamingPosition( const uint32_t frame, const uint32_t streamedAreaCount, float* position )
+	{
+		const float rowLength	= static_cast<float>( streamedAreaCount + 1 ) * STREAMED_AREA_SIZE;
+		const float distance	= fmodf( static_cast<float>( frame ) * STREAMING_SPEED, rowLength * 2.0f );
+
+		position[0] = ( distance < rowLength ) ? distance : rowLength * 2.0f - distance;
+		position[1] = 0.0f;
+		position[2] = STREAMED_AREA_SIZE * 0.5f;
+	}
+
+	void ResetTimings( phaseTiming_t* timings )
+	{
+		for ( int i = 0; i < PHASE_COUNT; ++i ) {
+			timings[i] = { 0.0, 1e30, 0.0, 0 };
+		}
+	}
+
+	void AddTiming( phaseTiming_t& timing, const benchClock_t::time_point start, const benchClock_t::time_point end )
+	{
+		const double duration = std::chrono::duration<double, std::milli>( end - start ).count();
+
+		timing.total += duration;
+		timing.min = std::min( timing.min, duration );
+		timing.max = std::max( timing.max, duration );
+		timing.count++;
+	}
+
+	void PrintTimings( const char* title, const phaseTiming_t* timings )
+	{
+		printf( "%s\n", title );
+
+		for ( int i = 0; i < PHASE_COUNT; ++i ) {
+			const phaseTiming_t& timing = timings[i];
+
+			if ( timing.count == 0 ) {
+				continue;
+			}
+
+			printf( "\t%-12s avg %8.4f ms | min %8.4f ms | max %8.4f ms\n", PHASE_NAMES[i], timing.total / timing.count, timing.min, timing.max );
+		}
+
+		if ( timings[PHASE_FRAME].total > 0.0 ) {
+			printf( "\t%.1f frames/s\n", timings[PHASE_FRAME].count * 1000.0 / timings[PHASE_FRAME].total );
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	headlessSettings_t settings =
+	{
+		10000,						// uint32_t		frameCount
+		4096,						// uint32_t		actorCount
+		12,							// uint32_t		lightCount
+		-1,							// int			workerCount
+		1000,						// uint32_t		reportInterval
+		100000,						// uint32_t		sortItemCount
+		0,							// uint32_t		recordCommands
+		nullptr,					// const char*	diffFileName
+		0,							// uint32_t		frameGraphCount
+		0,							// uint32_t		geometryAreaCount
+		0,							// uint32_t		startupRunCount
+		0,							// uint32_t		dynresPhaseLength
+		0,							// uint32_t		jobRoundCount
+		0,							// uint32_t		ecsEntityCount
+		0,							// uint32_t		ringFrameCount
+		0,							// uint32_t		releaseFrameCount
+		0,							// uint32_t		savedAreaCount
+		8,							// uint32_t		streamedAreaCount
+	};
+
+	ParseSettings( argc, argv, settings );
+
+	if ( Job_Initialize( settings.workerCount ) != 0 ) {
+		printf( "failed to initialize the job system\n" );
+		return 1;
+	}
+
+	printf( "headless: %u frames, %u actors, %u lights, %d workers\n", settings.frameCount, settings.actorCount, settings.lightCount, Job_GetWorkerCount() );
+
+	if ( settings.sortItemCount > 0 ) {
+		Headless_BenchmarkRenderQueueSort( settings.sortItemCount );
+	}
+
+	if ( settings.jobRoundCount > 0 && !Headless_CheckJobSystem( settings.jobRoundCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.ecsEntityCount > 0 && !Headless_CheckEntityThroughput( settings.ecsEntityCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.ringFrameCount > 0 && !Headless_CheckRingAllocator( settings.ringFrameCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.releaseFrameCount > 0 && !Headless_CheckReleaseOrder( settings.releaseFrameCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.savedAreaCount > 0 && !Headless_CheckAreaStreaming( settings.savedAreaCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.frameGraphCount > 0 && !Headless_CheckFrameGraphs( settings.frameGraphCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.geometryAreaCount > 0 && !Headless_CheckGeometryAllocator( settings.geometryAreaCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.startupRunCount > 0 && !Headless_CheckStartupGraph( settings.startupRunCount ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	if ( settings.dynresPhaseLength > 0 && !Headless_CheckDynamicResolution( settings.dynresPhaseLength ) ) {
+		Job_Shutdown();
+		return 1;
+	}
+
+	// the populated area comes first in the row (see World::CreateEmptyArea)
+	World world = {};
+	world.CreateGrid( static_cast<unsigned char>( settings.streamedAreaCount + 1 ), 1 );
+	world.CreateEmptyArea();
+
+	if ( !WriteStreamedAreas( settings.streamedAreaCount ) ) {
+		printf( "failed to write the streamed areas\n" );
+		Job_Shutdown();
+		return 1;
+	}
+
+	// fake opaque materials (no textures nor cbuffer) for the submission
+	constexpr uint32_t HEADLESS_MATERIAL_COUNT = 16;
+	std::vector<material_t> materials( ( settings.recordCommands != 0 ) ? HEADLESS_MATERIAL_COUNT : 0 );
+
+	for ( uint32_t i = 0; i < materials.size(); ++i ) {
+		materials[i] = {};
+		materials[i].surfType	= SURF_OPAQUE;
+		materials[i].sortId		= i + 1;
+	}
+
+	PopulateWorld( &world, settings, materials );
+
+	SystemScheduler actorSystems = {};
+	ActorTransformHistorySystem actorTransformHistorySystem;
+	HeadlessMotionSystem motionSystem;
+	ActorTransformSystem actorTransformSystem;
+
+	actorSystems.AddSystem( &actorTransformHistorySystem );
+	actorSystems.AddSystem( &motionSystem );
+
+	// keep the 3 areas around the streaming position resident
+	const streamingSettings_t streamingSettings =
+	{
+		STREAMED_AREA_SIZE,			// float			areaSize
+		96.0f,						// float			loadRadius
+		128.0f,						// float			unloadRadius
+		256ull << 20,				// uint64_t			memoryBudget
+	};
+
+	AreaStreamer areaStreamer = {};
+	StateManager stateMan = {};
+	HeadlessState headlessState( &actorSystems, world.GetEntityManager() );
+
+	// no renderer: streamed meshes only have their file name, and states have no texture to load
+	if ( areaStreamer.Initialize( &world, streamingSettings, "." ) != 0 || stateMan.Initialize( &world, &areaStreamer, nullptr, nullptr ) != 0 ) {
+		printf( "failed to initialize the area streamer\n" );
+		Job_Shutdown();
+		return 1;
+	}
+
+	stateMan.PushState( &headlessState );
+
+	// never created on the gpu; only used for its matrices
+	FreeCamera camera;
+	camera.SetPosition( 128.0f, 32.0f, -64.0f );
+	camera.LookAt( DirectX::XMFLOAT3( 128.0f, 0.0f, 128.0f ) );
+	camera.SetProjection( 16.0f / 9.0f, DirectX::XMConvertToRadians( 75.0f ), 0.01f, 1000.0f );
+
+	renderSnapshot_t localSnapshot = {};
+
+	// the whole frame (constants, frame graph, passes, present) is recorded by the null backend; nothing reaches a gpu
+	RenderManager renderMan = {};
+	RenderBackendNull* commandBackend = nullptr;
+
+	if ( settings.recordCommands != 0 ) {
+		if ( renderMan.InitializeHeadless( 1280, 720 ) != 0 ) {
+			printf( "failed to initialize the render manager\n" );
+			Job_Shutdown();
+			return 1;
+		}
+
+		commandBackend = static_cast<RenderBackendNull*>( renderMan.GetContext()->backend );
+	}
+
+	uint64_t commandCount = 0, drawCallCount = 0, instanceCount = 0, stateChangeCount = 0, filteredCallCount = 0;
+
+	// the loop runs as fast as possible; each frame is simulated as lasting one tick, whatever its cost, so that runs are reproducible
+	constexpr double SIMULATION_TICK = 10.0;
+
+	fixedStep_t simulationStep = {};
+	FixedStep_Start( &simulationStep, SIMULATION_TICK );
+
+	phaseTiming_t timings[PHASE_COUNT], intervalTimings[PHASE_COUNT];
+	ResetTimings( timings );
+	ResetTimings( intervalTimings );
+
+	uint64_t residentAreaSum = 0;
+	float streamingPosition[3] = {};
+
+	for ( uint32_t frame = 0; frame < settings.frameCount; ++frame ) {
+		const benchClock_t::time_point frameStart = benchClock_t::now();
+
+		const double frameTime = FixedStep_BeginFrame( &simulationStep, SIMULATION_TICK );
+
+		GetStreamingPosition( frame, settings.streamedAreaCount, streamingPosition );
+		areaStreamer.Update( streamingPosition );
+
+		// recorded streams must not depend on the streaming thread pace: wait for the loads the frame asked for
+		while ( settings.recordCommands != 0 && areaStreamer.GetInFlightCount() > 0 ) {
+			std::this_thread::yield();
+			areaStreamer.Update( streamingPosition );
+		}
+
+		residentAreaSum += world.GetResidentAreas().size();
+
+		stateMan.Frame();
+
+		const benchClock_t::time_point streamingEnd = benchClock_t::now();
+
+		// the actor systems are ticked by the headless state (once its areas are resident)
+		while ( FixedStep_Tick( &simulationStep ) ) {
+			stateMan.Update( static_cast<float>( simulationStep.tickDuration ) );
+		}
+
+		const benchClock_t::time_point simulationEnd = benchClock_t::now();
+
+		actorTransformSystem.SetInterpolationFactor( static_cast<float>( FixedStep_GetAlpha( &simulationStep ) ) );
+		actorTransformSystem.Update( world.GetEntityManager(), static_cast<float>( frameTime ) );
+		world.UpdateTransforms();
+
+		const benchClock_t::time_point transformsEnd = benchClock_t::now();
+
+		// no render thread: the snapshot is rendered (and cleared) inline by SubmitSnapshot
+		renderSnapshot_t* snapshot = ( commandBackend != nullptr ) ? renderMan.AcquireSnapshot() : &localSnapshot;
+
+		const std::vector<worldArea_t*>& residentAreas = world.GetResidentAreas();
+		Render_BuildSnapshot( snapshot, &camera, residentAreas.data(), residentAreas.size(), static_cast<float>( frameTime * 0.001 ) );
+
+		const benchClock_t::time_point renderPrepEnd = benchClock_t::now();
+
+		if ( commandBackend != nullptr ) {
+			commandBackend->Clear();
+			renderMan.SubmitSnapshot( snapshot );
+
+			const renderStreamCounters_t& counters = commandBackend->GetCounters();
+			commandCount		+= counters.commandCount;
+			drawCallCount		+= counters.drawCalls;
+			instanceCount		+= counters.instanceCount;
+			stateChangeCount	+= counters.stateChanges;
+
+			// state cache of the previous frame
+			filteredCallCount	+= renderMan.GetStateCacheCounters().filteredCalls;
+		} else {
+			Render_ClearSnapshot( snapshot );
+		}
+
+		const benchClock_t::time_point frameEnd = benchClock_t::now();
+
+		const benchClock_t::time_point phaseBounds[PHASE_COUNT][2] =
+		{
+			{ frameStart, streamingEnd },
+			{ streamingEnd, simulationEnd },
+			{ simulationEnd, transformsEnd },
+			{ transformsEnd, renderPrepEnd },
+			{ renderPrepEnd, frameEnd },
+			{ frameStart, frameEnd },
+		};
+
+		for ( int i = 0; i < PHASE_COUNT; ++i ) {
+			if ( i == PHASE_SUBMISSION && settings.recordCommands == 0 ) {
+				continue;
+			}
+
+			AddTiming( timings[i], phaseBounds[i][0], phaseBounds[i][1] );
+			AddTiming( intervalTimings[i], phaseBounds[i][0], phaseBounds[i][1] );
+		}
+
+		if ( settings.reportInterval != 0 && ( frame + 1 ) % settings.reportInterval == 0 ) {
+			char title[64];
+			snprintf( title, sizeof( title ), "frames %u-%u", frame + 1 - settings.reportInterval, frame );
+
+			PrintTimings( title, intervalTimings );
+			ResetTimings( intervalTimings );
+		}
+	}
+
+	PrintTimings( "total", timings );
+
+	printf( "streaming\n" );
+	printf( "\tavg %.1f resident areas | %llu bytes resident at the end\n", residentAreaSum / static_cast<double>( settings.frameCount ),
+		static_cast<unsigned long long>( world.GetMemoryUsage() ) );
+
+	stateMan.Shutdown();
+	areaStreamer.Shutdown();
+
+	for ( uint32_t i = 1; i <= settings.streamedAreaCount; ++i ) {
+		remove( GetStreamedAreaFileName( i ).c_str() );
+	}
+
+	bool isStreamMatching = true;
+
+	if ( commandBackend != nullptr ) {
+		const double frameCount = static_cast<double>( settings.frameCount );
+
+		printf( "submission\n" );
+		printf( "\tavg %.1f commands | %.1f draws | %.1f instances per frame\n", commandCount / frameCount, drawCallCount / frameCount, instanceCount / frameCount );
+		printf( "\tavg %.1f state changes | %.1f filtered by the state cache per frame\n", stateChangeCount / frameCount, filteredCallCount / frameCount );
+		printf( "\tlast frame stream: %zu words, hash %016llx\n", commandBackend->GetStreamLength(), static_cast<unsigned long long>( commandBackend->GetStreamHash() ) );
+
+		if ( settings.diffFileName != nullptr ) {
+			int64_t firstDifference = -1;
+
+			if ( !commandBackend->Diff( settings.diffFileName, firstDifference ) ) {
+				printf( "\tfailed to read '%s'\n", settings.diffFileName );
+				isStreamMatching = false;
+			} else if ( firstDifference >= 0 ) {
+				printf( "\tdiffers from '%s' at command %lld\n", settings.diffFileName, static_cast<long long>( firstDifference ) );
+				isStreamMatching = false;
+			} else {
+				printf( "\tmatches '%s'\n", settings.diffFileName );
+			}
+		} else if ( !commandBackend->Save( "headless_commands.bin" ) ) {
+			printf( "\tfailed to save the command stream\n" );
+		}
+
+		renderMan.Shutdown();
+	}
+
+	Job_Shutdown();
+
+	return ( isStreamMatching ) ? 0 : 1;
+}